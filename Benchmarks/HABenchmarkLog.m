@@ -0,0 +1,56 @@
+#import "HALog.h"
+
+// HALog for the benchmark build. The app's HALog.m depends on UIKit and
+// HAPerfMonitor; here warnings and errors go to stderr and the rest is
+// dropped so logging never shows up in the numbers.
+
+static HALogLevel gMinLevel = HALogLevelWarning;
+
+static void HABenchmarkLogv(HALogLevel level, NSString *tag, NSString *fmt, va_list args) {
+    if (level < gMinLevel) return;
+    NSString *message = [[NSString alloc] initWithFormat:fmt arguments:args];
+    fprintf(stderr, "[%s] %s\n", tag.UTF8String, message.UTF8String);
+}
+
+@implementation HALog
+
++ (void)debug:(NSString *)tag format:(NSString *)fmt, ... {
+    va_list args;
+    va_start(args, fmt);
+    HABenchmarkLogv(HALogLevelDebug, tag, fmt, args);
+    va_end(args);
+}
+
++ (void)info:(NSString *)tag format:(NSString *)fmt, ... {
+    va_list args;
+    va_start(args, fmt);
+    HABenchmarkLogv(HALogLevelInfo, tag, fmt, args);
+    va_end(args);
+}
+
++ (void)warn:(NSString *)tag format:(NSString *)fmt, ... {
+    va_list args;
+    va_start(args, fmt);
+    HABenchmarkLogv(HALogLevelWarning, tag, fmt, args);
+    va_end(args);
+}
+
++ (void)error:(NSString *)tag format:(NSString *)fmt, ... {
+    va_list args;
+    va_start(args, fmt);
+    HABenchmarkLogv(HALogLevelError, tag, fmt, args);
+    va_end(args);
+}
+
++ (void)setMinLevel:(HALogLevel)level { gMinLevel = level; }
++ (HALogLevel)minLevel { return gMinLevel; }
++ (void)setFileLoggingEnabled:(BOOL)enabled {}
++ (void)setConsoleLoggingEnabled:(BOOL)enabled {}
++ (NSString *)currentLogFilePath { return nil; }
++ (NSString *)previousLogFilePath { return nil; }
++ (void)flush {}
++ (void)logStartup:(NSString *)message {}
++ (void)installCrashHandler {}
++ (void)logCrashMessage:(NSString *)message {}
+
+@end
@@ -0,0 +1,500 @@
+#import <Foundation/Foundation.h>
+#import "HAConditionEvaluator.h"
+#import "HADashboardConfig.h"
+#import "HADateUtils.h"
+#import "HAEntity.h"
+#import "HAHistoryParser.h"
+#import "HALovelaceParser.h"
+#import "HAMJPEGFrameScanner.h"
+#import "HAStrategyResolver.h"
+#include <time.h>
+
+// -----------------------------------------------------------------------
+// Micro-benchmarks for the Foundation-only core: Lovelace parsing,
+// strategy resolution, history parsing, MJPEG framing, ISO 8601 dates and
+// visibility conditions. Built and run by scripts/bench-core.sh on macOS or
+// on Linux (GNUstep), so hot paths can be measured without a device.
+//
+// Inputs are synthetic and deterministic (fixed seed), so runs on the same
+// machine are comparable. Each benchmark is calibrated to run for at least
+// --min-time seconds per sample; the median of --samples samples is
+// reported.
+//
+// Usage:
+//   bench-core [--filter substring] [--min-time 0.2] [--samples 5]
+//              [--json out.json] [--baseline base.json] [--tolerance 0.10]
+// With --baseline, exits 1 if any benchmark is slower than its baseline
+// ns/op by more than the tolerance.
+// -----------------------------------------------------------------------
+
+static const NSUInteger kEntityCount = 500;
+static const NSUInteger kViewCount = 4;
+static const NSUInteger kCardsPerView = 40;
+static const NSUInteger kHistoryStates = 2000;
+static const NSUInteger kHistoryMaxPoints = 500;
+static const NSUInteger kMJPEGFrameCount = 30;
+static const NSUInteger kMJPEGFrameBytes = 48 * 1024;
+static const NSUInteger kMJPEGPacketBytes = 16 * 1024;
+static const NSUInteger kDateCount = 1000;
+static const NSUInteger kConditionCount = 200;
+
+/// Results are folded in here so the optimizer can't drop the work.
+static volatile NSUInteger gSink;
+
+#pragma mark - Deterministic Input
+
+static uint32_t gSeed = 0x9E3779B9u;
+
+static uint32_t HABenchRandom(void) {
+    // xorshift32
+    gSeed ^= gSeed << 13;
+    gSeed ^= gSeed >> 17;
+    gSeed ^= gSeed << 5;
+    return gSeed;
+}
+
+static NSString *HABenchEntityId(NSUInteger i) {
+    static NSString *const domains[] = { @"sensor", @"light", @"switch", @"binary_sensor", @"climate" };
+    return [NSString stringWithFormat:@"%@.bench_%lu", domains[i % 5], (unsigned long)i];
+}
+
+static NSString *HABenchISODate(NSTimeInterval epoch, BOOL fractional) {
+    static NSDateFormatter *formatter;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        formatter = [[NSDateFormatter alloc] init];
+        formatter.locale = [[NSLocale alloc] initWithLocaleIdentifier:@"en_US_POSIX"];
+        formatter.timeZone = [NSTimeZone timeZoneForSecondsFromGMT:0];
+        formatter.dateFormat = @"yyyy-MM-dd'T'HH:mm:ss";
+    });
+    NSString *base = [formatter stringFromDate:[NSDate dateWithTimeIntervalSince1970:floor(epoch)]];
+    if (!fractional) return [base stringByAppendingString:@"+00:00"];
+    return [NSString stringWithFormat:@"%@.%06u+00:00", base, HABenchRandom() % 1000000];
+}
+
+static NSDictionary<NSString *, NSDictionary *> *HABenchStates(void) {
+    NSMutableDictionary *states = [NSMutableDictionary dictionaryWithCapacity:kEntityCount];
+    NSString *changed = HABenchISODate(1767225600, YES); // 2026-01-01
+    for (NSUInteger i = 0; i < kEntityCount; i++) {
+        NSString *entityId = HABenchEntityId(i);
+        NSString *state = nil;
+        NSMutableDictionary *attributes = [NSMutableDictionary dictionary];
+        attributes[@"friendly_name"] = [NSString stringWithFormat:@"Bench %lu", (unsigned long)i];
+        switch (i % 5) {
+            case 0:
+                state = [NSString stringWithFormat:@"%.1f", (HABenchRandom() % 4000) / 10.0];
+                attributes[@"unit_of_measurement"] = @"W";
+                attributes[@"device_class"] = @"power";
+                break;
+            case 1:
+                state = HABenchRandom() % 2 ? @"on" : @"off";
+                attributes[@"brightness"] = @(HABenchRandom() % 256);
+                attributes[@"supported_color_modes"] = @[ @"hs", @"color_temp" ];
+                break;
+            case 2:
+                state = HABenchRandom() % 2 ? @"on" : @"off";
+                break;
+            case 3:
+                state = HABenchRandom() % 2 ? @"on" : @"off";
+                attributes[@"device_class"] = @"motion";
+                break;
+            default:
+                state = @"heat";
+                attributes[@"current_temperature"] = @(18 + HABenchRandom() % 6);
+                attributes[@"temperature"] = @21;
+                break;
+        }
+        states[entityId] = @{
+            @"entity_id": entityId,
+            @"state": state,
+            @"attributes": attributes,
+            @"last_changed": changed,
+            @"last_updated": changed,
+        };
+    }
+    return states;
+}
+
+static NSDictionary<NSString *, HAEntity *> *HABenchEntities(NSDictionary<NSString *, NSDictionary *> *states) {
+    NSMutableDictionary *entities = [NSMutableDictionary dictionaryWithCapacity:states.count];
+    [states enumerateKeysAndObjectsUsingBlock:^(NSString *entityId, NSDictionary *state, BOOL *stop) {
+        entities[entityId] = [[HAEntity alloc] initWithDictionary:state];
+    }];
+    return entities;
+}
+
+/// Mixed classic and sections views, roughly the card mix of a real home.
+static NSDictionary *HABenchLovelaceConfig(void) {
+    NSUInteger cursor = 0;
+    NSMutableArray *views = [NSMutableArray arrayWithCapacity:kViewCount];
+    for (NSUInteger v = 0; v < kViewCount; v++) {
+        NSMutableArray *cards = [NSMutableArray arrayWithCapacity:kCardsPerView];
+        for (NSUInteger c = 0; c < kCardsPerView; c++) {
+            NSString *entityId = HABenchEntityId(cursor++ % kEntityCount);
+            NSMutableArray *rows = [NSMutableArray array];
+            for (NSUInteger r = 0; r < 5; r++) {
+                [rows addObject:@{@"entity": HABenchEntityId(cursor++ % kEntityCount)}];
+            }
+            switch (c % 6) {
+                case 0:
+                    [cards addObject:@{@"type": @"tile", @"entity": entityId}];
+                    break;
+                case 1:
+                    [cards addObject:@{@"type": @"entities", @"title": @"Group", @"entities": rows}];
+                    break;
+                case 2:
+                    [cards addObject:@{@"type": @"glance", @"entities": rows}];
+                    break;
+                case 3:
+                    [cards addObject:@{@"type": @"vertical-stack", @"cards": @[
+                        @{@"type": @"gauge", @"entity": entityId, @"min": @0, @"max": @400},
+                        @{@"type": @"sensor", @"entity": entityId, @"graph": @"line"},
+                    ]}];
+                    break;
+                case 4:
+                    [cards addObject:@{@"type": @"grid", @"columns": @3, @"cards": @[
+                        @{@"type": @"button", @"entity": rows[0][@"entity"]},
+                        @{@"type": @"button", @"entity": rows[1][@"entity"]},
+                        @{@"type": @"button", @"entity": rows[2][@"entity"]},
+                    ]}];
+                    break;
+                default:
+                    [cards addObject:@{@"type": @"conditional",
+                                       @"conditions": @[@{@"entity": entityId, @"state": @"on"}],
+                                       @"card": @{@"type": @"tile", @"entity": entityId}}];
+                    break;
+            }
+        }
+        NSString *path = [NSString stringWithFormat:@"view-%lu", (unsigned long)v];
+        if (v % 2) {
+            NSMutableArray *sections = [NSMutableArray array];
+            for (NSUInteger s = 0; s < cards.count; s += 8) {
+                NSRange range = NSMakeRange(s, MIN((NSUInteger)8, cards.count - s));
+                [sections addObject:@{@"type": @"grid", @"cards": [cards subarrayWithRange:range]}];
+            }
+            [views addObject:@{@"title": path, @"path": path, @"type": @"sections", @"sections": sections}];
+        } else {
+            [views addObject:@{@"title": path, @"path": path, @"cards": cards}];
+        }
+    }
+    return @{@"title": @"Bench", @"views": views};
+}
+
+/// /api/history/period body for one entity: kHistoryStates numeric (or
+/// on/off) states a minute apart, with the occasional unavailable.
+static NSData *HABenchHistoryData(BOOL numeric) {
+    NSMutableArray *states = [NSMutableArray arrayWithCapacity:kHistoryStates];
+    NSTimeInterval time = 1767225600;
+    for (NSUInteger i = 0; i < kHistoryStates; i++, time += 60) {
+        NSString *state = nil;
+        if (i % 97 == 0) {
+            state = @"unavailable";
+        } else if (numeric) {
+            state = [NSString stringWithFormat:@"%.2f", 20.0 + (HABenchRandom() % 1000) / 100.0];
+        } else {
+            state = HABenchRandom() % 4 ? @"off" : @"on";
+        }
+        [states addObject:@{@"state": state, @"last_changed": HABenchISODate(time, i % 2 == 0)}];
+    }
+    return [NSJSONSerialization dataWithJSONObject:@[ states ] options:0 error:nil];
+}
+
+/// A multipart/x-mixed-replace body of kMJPEGFrameCount fake JPEG parts.
+/// Payload bytes avoid 0xFF so the SOI scan has to walk the headers only.
+static NSData *HABenchMJPEGStream(NSData *delimiter) {
+    NSMutableData *stream = [NSMutableData data];
+    NSData *headers = [@"Content-Type: image/jpeg\r\nContent-Length: 49152\r\n\r\n"
+                       dataUsingEncoding:NSUTF8StringEncoding];
+    uint8_t *payload = malloc(kMJPEGFrameBytes);
+    for (NSUInteger f = 0; f < kMJPEGFrameCount; f++) {
+        for (NSUInteger i = 0; i < kMJPEGFrameBytes; i++) payload[i] = (uint8_t)(HABenchRandom() % 0xFF);
+        payload[0] = 0xFF;
+        payload[1] = 0xD8;
+        payload[kMJPEGFrameBytes - 2] = 0xFF;
+        payload[kMJPEGFrameBytes - 1] = 0xD9;
+        [stream appendData:headers];
+        [stream appendBytes:payload length:kMJPEGFrameBytes];
+        [stream appendData:delimiter];
+    }
+    free(payload);
+    return stream;
+}
+
+/// Condition trees in the shapes dashboards use: plain state, numeric
+/// ranges, and nested and/or/not with a screen query.
+static NSArray<NSDictionary *> *HABenchConditions(void) {
+    NSMutableArray *conditions = [NSMutableArray arrayWithCapacity:kConditionCount];
+    for (NSUInteger i = 0; i < kConditionCount; i++) {
+        NSString *sensor = HABenchEntityId((i * 5) % kEntityCount);
+        NSString *light = HABenchEntityId((i * 5 + 1) % kEntityCount);
+        switch (i % 4) {
+            case 0:
+                [conditions addObject:@{@"entity": light, @"state": @"on"}];
+                break;
+            case 1:
+                [conditions addObject:@{@"condition": @"numeric_state", @"entity": sensor,
+                                        @"above": @100, @"below": @300}];
+                break;
+            case 2:
+                [conditions addObject:@{@"condition": @"and", @"conditions": @[
+                    @{@"condition": @"state", @"entity": light, @"state_not": @[ @"unavailable", @"off" ]},
+                    @{@"condition": @"screen", @"media_query": @"(min-width: 768px)"},
+                ]}];
+                break;
+            default:
+                [conditions addObject:@{@"condition": @"or", @"conditions": @[
+                    @{@"condition": @"not", @"conditions": @[@{@"entity": light, @"state": @"off"}]},
+                    @{@"condition": @"numeric_state", @"entity": sensor, @"below": @50},
+                ]}];
+                break;
+        }
+    }
+    return conditions;
+}
+
+#pragma mark - Runner
+
+typedef void (^HABenchBody)(void);
+
+@interface HABenchCase : NSObject
+@property (nonatomic, copy) NSString *name;
+@property (nonatomic, copy) HABenchBody body;
+@end
+
+@implementation HABenchCase
+@end
+
+static HABenchCase *HABenchMake(NSString *name, HABenchBody body) {
+    HABenchCase *bench = [[HABenchCase alloc] init];
+    bench.name = name;
+    bench.body = body;
+    return bench;
+}
+
+static double HABenchNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/// Seconds for `iterations` runs of the body, each in its own pool so
+/// autoreleased temporaries are part of the cost, as they are in the app.
+static double HABenchTime(HABenchBody body, NSUInteger iterations) {
+    double start = HABenchNow();
+    for (NSUInteger i = 0; i < iterations; i++) {
+        @autoreleasepool {
+            body();
+        }
+    }
+    return HABenchNow() - start;
+}
+
+/// Median ns/op over `samples` samples of at least minTime seconds each.
+static double HABenchMeasure(HABenchCase *bench, double minTime, NSUInteger samples, NSUInteger *outIterations) {
+    // Warm up caches (formatters, class setup), then grow the iteration
+    // count until one sample is long enough to time reliably
+    HABenchTime(bench.body, 1);
+    NSUInteger iterations = 1;
+    double elapsed = HABenchTime(bench.body, iterations);
+    while (elapsed < minTime && iterations < (NSUIntegerMax >> 2)) {
+        double scale = elapsed > 0 ? MIN(10.0, MAX(2.0, 1.2 * minTime / elapsed)) : 10.0;
+        iterations = (NSUInteger)ceil(iterations * scale);
+        elapsed = HABenchTime(bench.body, iterations);
+    }
+
+    NSMutableArray<NSNumber *> *perOp = [NSMutableArray arrayWithCapacity:samples];
+    [perOp addObject:@(elapsed * 1e9 / iterations)];
+    for (NSUInteger s = 1; s < samples; s++) {
+        [perOp addObject:@(HABenchTime(bench.body, iterations) * 1e9 / iterations)];
+    }
+    [perOp sortUsingSelector:@selector(compare:)];
+    *outIterations = iterations;
+    return perOp[perOp.count / 2].doubleValue;
+}
+
+static NSArray<HABenchCase *> *HABenchCases(void) {
+    NSDictionary<NSString *, NSDictionary *> *states = HABenchStates();
+    NSDictionary<NSString *, HAEntity *> *entities = HABenchEntities(states);
+    NSDictionary *lovelace = HABenchLovelaceConfig();
+    HALovelaceDashboard *dashboard = [HALovelaceParser parseDashboardFromDictionary:lovelace];
+
+    NSMutableDictionary *areaNames = [NSMutableDictionary dictionary];
+    NSMutableDictionary *entityAreas = [NSMutableDictionary dictionary];
+    for (NSUInteger i = 0; i < kEntityCount; i++) {
+        NSString *areaId = [NSString stringWithFormat:@"area_%lu", (unsigned long)(i % 12)];
+        areaNames[areaId] = [NSString stringWithFormat:@"Room %lu", (unsigned long)(i % 12)];
+        if (i % 3) entityAreas[HABenchEntityId(i)] = areaId;
+    }
+
+    NSData *numericHistory = HABenchHistoryData(YES);
+    NSData *stateHistory = HABenchHistoryData(NO);
+    NSArray *numericPoints = [HAHistoryParser pointsFromHistoryData:numericHistory];
+
+    NSData *delimiter = [HAMJPEGFrameScanner delimiterForContentType:@"multipart/x-mixed-replace; boundary=frame"];
+    NSData *mjpeg = HABenchMJPEGStream(delimiter);
+
+    NSMutableArray<NSString *> *dates = [NSMutableArray arrayWithCapacity:kDateCount];
+    for (NSUInteger i = 0; i < kDateCount; i++) {
+        [dates addObject:HABenchISODate(1767225600 + i * 37, i % 3 != 0)];
+    }
+
+    NSArray<NSDictionary *> *conditions = HABenchConditions();
+
+    return @[
+        HABenchMake(@"lovelace.parse", ^{
+            HALovelaceDashboard *parsed = [HALovelaceParser parseDashboardFromDictionary:lovelace];
+            gSink += parsed.views.count;
+        }),
+        HABenchMake(@"lovelace.config", ^{
+            for (HALovelaceView *view in dashboard.views) {
+                HADashboardConfig *config = [HALovelaceParser dashboardConfigFromView:view columns:3];
+                gSink += config.items.count;
+            }
+        }),
+        HABenchMake(@"strategy.original_states", ^{
+            HALovelaceDashboard *resolved =
+                [HAStrategyResolver resolveDashboardWithStrategy:@{@"type": @"original-states"}
+                                                        entities:entities
+                                                       areaNames:areaNames
+                                                   entityAreaMap:entityAreas
+                                                   deviceAreaMap:@{}
+                                                          floors:nil
+                                                  entityRegistry:@[]];
+            gSink += resolved.views.count;
+        }),
+        HABenchMake(@"entity.init", ^{
+            gSink += HABenchEntities(states).count;
+        }),
+        HABenchMake(@"history.points", ^{
+            gSink += [HAHistoryParser pointsFromHistoryData:numericHistory].count;
+        }),
+        HABenchMake(@"history.downsample", ^{
+            gSink += [HAHistoryParser downsamplePoints:numericPoints maxPoints:kHistoryMaxPoints].count;
+        }),
+        HABenchMake(@"history.timeline", ^{
+            gSink += [HAHistoryParser timelineSegmentsFromHistoryData:stateHistory endTime:1767345600].count;
+        }),
+        HABenchMake(@"mjpeg.scan", ^{
+            // Feed the stream in network-sized packets, as NSURLSession does
+            NSMutableData *buffer = [NSMutableData data];
+            NSUInteger scanOffset = 0;
+            const uint8_t *bytes = mjpeg.bytes;
+            for (NSUInteger offset = 0; offset < mjpeg.length; offset += kMJPEGPacketBytes) {
+                [buffer appendBytes:bytes + offset length:MIN(kMJPEGPacketBytes, mjpeg.length - offset)];
+                NSArray<NSData *> *parts = [HAMJPEGFrameScanner consumePartsFromBuffer:buffer
+                                                                             delimiter:delimiter
+                                                                            scanOffset:&scanOffset];
+                for (NSData *part in parts) {
+                    gSink += [HAMJPEGFrameScanner JPEGDataFromPart:part].length;
+                }
+            }
+        }),
+        HABenchMake(@"date.iso8601", ^{
+            for (NSString *string in dates) {
+                gSink += (NSUInteger)[HADateUtils dateFromISO8601String:string].timeIntervalSince1970;
+            }
+        }),
+        HABenchMake(@"condition.evaluate", ^{
+            for (NSDictionary *condition in conditions) {
+                gSink += [HAConditionEvaluator evaluateCondition:condition entities:entities screenWidth:1024];
+            }
+        }),
+    ];
+}
+
+#pragma mark - Reporting
+
+static NSDictionary *HABenchLoadBaseline(NSString *path) {
+    NSData *data = [NSData dataWithContentsOfFile:path];
+    NSDictionary *json = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:nil] : nil;
+    NSDictionary *benchmarks = [json isKindOfClass:[NSDictionary class]] ? json[@"benchmarks"] : nil;
+    return [benchmarks isKindOfClass:[NSDictionary class]] ? benchmarks : nil;
+}
+
+static void HABenchUsage(void) {
+    fprintf(stderr, "usage: bench-core [--filter substring] [--min-time seconds] [--samples n]\n"
+                    "                  [--json out.json] [--baseline base.json] [--tolerance fraction]\n");
+}
+
+int main(int argc, const char *argv[]) {
+    @autoreleasepool {
+        NSString *filter = nil, *jsonPath = nil, *baselinePath = nil;
+        double minTime = 0.2, tolerance = 0.10;
+        NSUInteger samples = 5;
+
+        for (int i = 1; i < argc; i++) {
+            NSString *arg = @(argv[i]);
+            NSString *value = i + 1 < argc ? @(argv[i + 1]) : nil;
+            if ([arg isEqualToString:@"--help"] || [arg isEqualToString:@"-h"]) {
+                HABenchUsage();
+                return 0;
+            }
+            if (!value) {
+                HABenchUsage();
+                return 2;
+            }
+            if ([arg isEqualToString:@"--filter"]) filter = value;
+            else if ([arg isEqualToString:@"--json"]) jsonPath = value;
+            else if ([arg isEqualToString:@"--baseline"]) baselinePath = value;
+            else if ([arg isEqualToString:@"--min-time"]) minTime = MAX(0.01, value.doubleValue);
+            else if ([arg isEqualToString:@"--samples"]) samples = (NSUInteger)MAX(1, value.integerValue);
+            else if ([arg isEqualToString:@"--tolerance"]) tolerance = MAX(0.0, value.doubleValue);
+            else {
+                HABenchUsage();
+                return 2;
+            }
+            i++;
+        }
+
+        NSDictionary *baseline = nil;
+        if (baselinePath) {
+            baseline = HABenchLoadBaseline(baselinePath);
+            if (!baseline) {
+                fprintf(stderr, "bench-core: can't read baseline %s\n", baselinePath.UTF8String);
+                return 2;
+            }
+        }
+
+        printf("%-26s %14s %14s %12s %10s\n", "benchmark", "ns/op", "ops/s", "iterations", "vs base");
+        NSMutableDictionary *results = [NSMutableDictionary dictionary];
+        NSUInteger regressions = 0;
+        for (HABenchCase *bench in HABenchCases()) {
+            if (filter && [bench.name rangeOfString:filter].location == NSNotFound) continue;
+
+            NSUInteger iterations = 0;
+            double nsPerOp = HABenchMeasure(bench, minTime, samples, &iterations);
+            results[bench.name] = @{
+                @"ns_per_op": @(nsPerOp),
+                @"ops_per_sec": @(1e9 / nsPerOp),
+                @"iterations": @(iterations),
+            };
+
+            NSString *delta = @"";
+            NSNumber *baseNs = baseline[bench.name][@"ns_per_op"];
+            if ([baseNs isKindOfClass:[NSNumber class]] && baseNs.doubleValue > 0) {
+                double change = nsPerOp / baseNs.doubleValue - 1.0;
+                BOOL regressed = change > tolerance;
+                if (regressed) regressions++;
+                delta = [NSString stringWithFormat:@"%+.1f%%%@", change * 100.0, regressed ? @" !" : @""];
+            }
+            printf("%-26s %14.0f %14.1f %12lu %10s\n", bench.name.UTF8String, nsPerOp, 1e9 / nsPerOp,
+                   (unsigned long)iterations, delta.UTF8String);
+        }
+
+        if (jsonPath) {
+            NSDictionary *report = @{@"benchmarks": results, @"min_time": @(minTime), @"samples": @(samples)};
+            NSData *json = [NSJSONSerialization dataWithJSONObject:report options:NSJSONWritingPrettyPrinted error:nil];
+            if (![json writeToFile:jsonPath atomically:YES]) {
+                fprintf(stderr, "bench-core: can't write %s\n", jsonPath.UTF8String);
+                return 2;
+            }
+        }
+
+        if (regressions > 0) {
+            fprintf(stderr, "bench-core: %lu benchmark(s) slower than baseline by more than %.0f%%\n",
+                    (unsigned long)regressions, tolerance * 100.0);
+            return 1;
+        }
+    }
+    return 0;
+}
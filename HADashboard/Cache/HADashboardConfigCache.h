@@ -1,5 +1,7 @@
 #import <Foundation/Foundation.h>
 
+@class HALovelaceDashboard;
+
 /// Caches Lovelace dashboard configuration JSON with hash-based invalidation.
 /// Per-dashboard storage: each dashboard path gets its own cache file.
 @interface HADashboardConfigCache : NSObject
@@ -19,6 +21,21 @@
 /// Whether there is a cached config file for the given dashboard path.
 - (BOOL)hasCachedConfigForDashboard:(NSString *)dashboardPath;
 
+/// SHA256 of the config last cached for the given dashboard path, or nil.
+- (NSString *)configHashForDashboard:(NSString *)dashboardPath;
+
+#pragma mark - Parsed Dashboards
+
+/// The parsed dashboard archived for the given dashboard path, so a cold start
+/// can skip parsing the raw config and interpreting its cards. Returns nil if
+/// there is none, it was written with another HALovelaceArchiveVersion, or it
+/// was parsed from a config other than the one currently cached.
+- (HALovelaceDashboard *)loadParsedDashboardForDashboard:(NSString *)dashboardPath;
+
+/// Archive a parsed dashboard, including the views interpreted so far. Ignored
+/// unless dashboard.configHash matches the currently cached config.
+- (void)storeParsedDashboard:(HALovelaceDashboard *)dashboard forDashboard:(NSString *)dashboardPath;
+
 /// Delete cached config for a specific dashboard.
 - (void)clearCacheForDashboard:(NSString *)dashboardPath;
 
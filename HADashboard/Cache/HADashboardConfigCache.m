@@ -1,6 +1,7 @@
 #import "HADashboardConfigCache.h"
 #import "HALog.h"
 #import "HACacheManager.h"
+#import "HALovelaceParser.h"
 #import <CommonCrypto/CommonDigest.h>
 
 @interface HADashboardConfigCache ()
@@ -42,6 +43,12 @@
     return [NSString stringWithFormat:@"dashboard-hash-%@.txt", key];
 }
 
+- (NSString *)parsedFilenameForDashboard:(NSString *)dashboardPath {
+    NSString *key = dashboardPath.length > 0 ? dashboardPath : @"_default";
+    key = [key stringByReplacingOccurrencesOfString:@"/" withString:@"-"];
+    return [NSString stringWithFormat:@"dashboard-parsed-%@.json", key];
+}
+
 #pragma mark - Read
 
 - (NSDictionary *)loadCachedConfigForDashboard:(NSString *)dashboardPath {
@@ -60,6 +67,57 @@
     return [[NSFileManager defaultManager] fileExistsAtPath:path];
 }
 
+- (NSString *)configHashForDashboard:(NSString *)dashboardPath {
+    NSString *cacheKey = dashboardPath ?: @"_default";
+    NSString *hash = self.cachedHashes[cacheKey];
+    if (!hash) {
+        hash = [self readHashForDashboard:dashboardPath];
+        if (hash) self.cachedHashes[cacheKey] = hash;
+    }
+    return hash;
+}
+
+#pragma mark - Parsed Dashboards
+
+- (HALovelaceDashboard *)loadParsedDashboardForDashboard:(NSString *)dashboardPath {
+    NSString *configHash = [self configHashForDashboard:dashboardPath];
+    if (!configHash) return nil;
+
+    id archive = [[HACacheManager sharedManager] readJSONFromFile:[self parsedFilenameForDashboard:dashboardPath]];
+    if (![archive isKindOfClass:[NSDictionary class]]) return nil;
+    if ([archive[@"version"] integerValue] != HALovelaceArchiveVersion ||
+        ![archive[@"config_hash"] isEqual:configHash]) {
+        HALogD(@"cache", @"Parsed dashboard for '%@' is stale, ignoring", dashboardPath ?: @"default");
+        return nil;
+    }
+
+    // Raw cards are only needed again if a view is shown at a new column
+    // count; hand them out only while the config is still the archived one
+    HALovelaceDashboard *dashboard =
+        [[HALovelaceDashboard alloc] initWithArchiveDictionary:archive[@"dashboard"]
+                                               rawConfigLoader:^NSDictionary *{
+            if (![[self configHashForDashboard:dashboardPath] isEqualToString:configHash]) return nil;
+            return [self loadCachedConfigForDashboard:dashboardPath];
+        }];
+    if (!dashboard) return nil;
+    dashboard.configHash = configHash;
+    HALogI(@"cache", @"Loaded parsed dashboard for '%@'", dashboardPath ?: @"default");
+    return dashboard;
+}
+
+- (void)storeParsedDashboard:(HALovelaceDashboard *)dashboard forDashboard:(NSString *)dashboardPath {
+    if (!dashboard.configHash || ![dashboard.configHash isEqualToString:[self configHashForDashboard:dashboardPath]]) return;
+
+    NSDictionary *archive = @{@"version": @(HALovelaceArchiveVersion),
+                              @"config_hash": dashboard.configHash,
+                              @"dashboard": [dashboard archiveDictionary]};
+    if (![NSJSONSerialization isValidJSONObject:archive]) {
+        HALogW(@"cache", @"Parsed dashboard for '%@' is not archivable", dashboardPath ?: @"default");
+        return;
+    }
+    [[HACacheManager sharedManager] writeJSON:archive toFile:[self parsedFilenameForDashboard:dashboardPath] completion:nil];
+}
+
 #pragma mark - Write with Hash Comparison
 
 - (BOOL)cacheConfig:(NSDictionary *)config forDashboard:(NSString *)dashboardPath {
@@ -111,6 +169,7 @@
     NSString *hashFile = [self hashFilenameForDashboard:dashboardPath];
     [[HACacheManager sharedManager] deleteCacheFile:configFile];
     [[HACacheManager sharedManager] deleteCacheFile:hashFile];
+    [[HACacheManager sharedManager] deleteCacheFile:[self parsedFilenameForDashboard:dashboardPath]];
     NSString *cacheKey = dashboardPath ?: @"_default";
     [self.cachedHashes removeObjectForKey:cacheKey];
 }
@@ -0,0 +1,56 @@
+#import <UIKit/UIKit.h>
+
+@class HADashboardConfig;
+
+/// Everything HADashboardViewController derives from one Lovelace view before
+/// it can display it: the filtered and flattened config, the lookup maps built
+/// from it, item heights, and where the user had scrolled.
+@interface HADashboardViewState : NSObject
+
+@property (nonatomic, assign) NSUInteger viewIndex;
+/// Config after parsing, conditional filtering and masonry/sidebar/panel reshaping
+@property (nonatomic, strong) HADashboardConfig *dashboardConfig;
+@property (nonatomic, copy) NSDictionary<NSString *, NSArray<NSIndexPath *> *> *entityToIndexPaths;
+@property (nonatomic, copy) NSSet<NSString *> *conditionEntityIds;
+/// Collection view width the config was built for (column count depends on it)
+@property (nonatomic, assign) CGFloat width;
+@property (nonatomic, assign) CGPoint contentOffset;
+/// A visibility condition entity changed: the filtered config is stale
+@property (nonatomic, assign, getter=isDirty) BOOL dirty;
+
+/// Memoized item height for indexPath at itemWidth, or 0 if not computed yet.
+- (CGFloat)heightForItemAtIndexPath:(NSIndexPath *)indexPath itemWidth:(CGFloat)itemWidth;
+- (void)setHeight:(CGFloat)height forItemAtIndexPath:(NSIndexPath *)indexPath itemWidth:(CGFloat)itemWidth;
+- (void)removeHeightsForItemsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths;
+- (void)removeAllHeights;
+
+/// Apply an entity update: marks the state dirty if entityId feeds a
+/// visibility condition, and forgets the heights of the items showing it.
+- (void)entityDidUpdate:(NSString *)entityId;
+
+@end
+
+
+/// Bounded LRU of prepared view states, so switching back to a recently shown
+/// view swaps its data source in instead of rebuilding it. Main thread only.
+@interface HADashboardViewStateCache : NSObject
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity;
+
+@property (nonatomic, readonly) NSUInteger capacity;
+@property (nonatomic, readonly) NSUInteger count;
+
+/// The cached state for viewIndex, or nil. A hit becomes most recently used;
+/// a dirty state or one built for another width is dropped and returns nil.
+- (HADashboardViewState *)stateForViewIndex:(NSUInteger)viewIndex width:(CGFloat)width;
+
+/// Cache state under its viewIndex, evicting the least recently used state
+/// beyond capacity.
+- (void)storeState:(HADashboardViewState *)state;
+
+/// Forward an entity update to every cached state.
+- (void)entityDidUpdate:(NSString *)entityId;
+
+- (void)removeAllStates;
+
+@end
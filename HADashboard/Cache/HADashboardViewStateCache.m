@@ -0,0 +1,129 @@
+#import "HADashboardViewStateCache.h"
+#import "HADashboardConfig.h"
+
+#pragma mark - HADashboardViewState
+
+static NSString *HAViewStateHeightKey(NSIndexPath *indexPath, CGFloat itemWidth) {
+    return [NSString stringWithFormat:@"%ld:%ld:%.1f", (long)indexPath.section, (long)indexPath.item, itemWidth];
+}
+
+@interface HADashboardViewState ()
+/// "section:item:width" -> height
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSNumber *> *itemHeights;
+@end
+
+@implementation HADashboardViewState
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _itemHeights = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (CGFloat)heightForItemAtIndexPath:(NSIndexPath *)indexPath itemWidth:(CGFloat)itemWidth {
+    return [self.itemHeights[HAViewStateHeightKey(indexPath, itemWidth)] doubleValue];
+}
+
+- (void)setHeight:(CGFloat)height forItemAtIndexPath:(NSIndexPath *)indexPath itemWidth:(CGFloat)itemWidth {
+    self.itemHeights[HAViewStateHeightKey(indexPath, itemWidth)] = @(height);
+}
+
+- (void)removeHeightsForItemsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths {
+    if (indexPaths.count == 0 || self.itemHeights.count == 0) return;
+    NSMutableSet<NSString *> *prefixes = [NSMutableSet setWithCapacity:indexPaths.count];
+    for (NSIndexPath *indexPath in indexPaths) {
+        [prefixes addObject:[NSString stringWithFormat:@"%ld:%ld:", (long)indexPath.section, (long)indexPath.item]];
+    }
+    for (NSString *key in self.itemHeights.allKeys) {
+        NSRange lastColon = [key rangeOfString:@":" options:NSBackwardsSearch];
+        if ([prefixes containsObject:[key substringToIndex:NSMaxRange(lastColon)]]) {
+            [self.itemHeights removeObjectForKey:key];
+        }
+    }
+}
+
+- (void)removeAllHeights {
+    [self.itemHeights removeAllObjects];
+}
+
+- (void)entityDidUpdate:(NSString *)entityId {
+    if (!entityId) return;
+    if ([self.conditionEntityIds containsObject:entityId]) {
+        self.dirty = YES;
+    }
+    [self removeHeightsForItemsAtIndexPaths:self.entityToIndexPaths[entityId]];
+}
+
+@end
+
+
+#pragma mark - HADashboardViewStateCache
+
+@interface HADashboardViewStateCache ()
+@property (nonatomic, strong) NSMutableDictionary<NSNumber *, HADashboardViewState *> *states;
+/// View indexes, least recently used first
+@property (nonatomic, strong) NSMutableArray<NSNumber *> *order;
+@end
+
+@implementation HADashboardViewStateCache
+
+- (instancetype)init {
+    return [self initWithCapacity:3];
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity {
+    self = [super init];
+    if (self) {
+        _capacity = MAX(capacity, (NSUInteger)1);
+        _states = [NSMutableDictionary dictionary];
+        _order = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (NSUInteger)count {
+    return self.states.count;
+}
+
+- (HADashboardViewState *)stateForViewIndex:(NSUInteger)viewIndex width:(CGFloat)width {
+    NSNumber *key = @(viewIndex);
+    HADashboardViewState *state = self.states[key];
+    if (!state) return nil;
+
+    [self.order removeObject:key];
+    if (state.dirty || fabs(state.width - width) > 0.5) {
+        [self.states removeObjectForKey:key];
+        return nil;
+    }
+    [self.order addObject:key];
+    return state;
+}
+
+- (void)storeState:(HADashboardViewState *)state {
+    if (!state) return;
+    NSNumber *key = @(state.viewIndex);
+    [self.order removeObject:key];
+    [self.order addObject:key];
+    self.states[key] = state;
+
+    while (self.order.count > self.capacity) {
+        NSNumber *evicted = self.order.firstObject;
+        [self.order removeObjectAtIndex:0];
+        [self.states removeObjectForKey:evicted];
+    }
+}
+
+- (void)entityDidUpdate:(NSString *)entityId {
+    for (HADashboardViewState *state in self.states.allValues) {
+        [state entityDidUpdate:entityId];
+    }
+}
+
+- (void)removeAllStates {
+    [self.states removeAllObjects];
+    [self.order removeAllObjects];
+}
+
+@end
@@ -0,0 +1,41 @@
+#import <Foundation/Foundation.h>
+
+/// Registry keys used for change detection and in the cached snapshot.
+extern NSString *const HARegistryKeyArea;
+extern NSString *const HARegistryKeyDevice;
+extern NSString *const HARegistryKeyEntity;
+extern NSString *const HARegistryKeyFloor;
+
+/// Caches the area/device/entity/floor registries to disk so area-grouped
+/// and strategy dashboards can render from cache on the first frame.
+///
+/// Only what the app actually uses is stored: the raw area and floor
+/// registries (small), a compact device_id → area_id map, the entity registry
+/// trimmed to the fields applied to HAEntity, and the precomputed
+/// entity_id → area_id map. Each raw registry's SHA-256 is stored alongside,
+/// so a refetch can tell whether anything changed without keeping the full
+/// previous response around.
+@interface HARegistryCache : NSObject
+
++ (instancetype)sharedCache;
+
+/// Load the cached snapshot for the current server. Keys: "areas" (NSArray),
+/// "device_areas" (NSDictionary), "entities" (NSArray of trimmed entries),
+/// "floors" (NSArray, optional), "entity_areas" (NSDictionary).
+/// Returns nil if no complete snapshot exists.
+- (NSDictionary *)loadCachedRegistries;
+
+/// Hash a freshly fetched registry and compare it with the one behind the
+/// last saved snapshot for this server. Returns YES if it changed. The new
+/// hash is kept pending until the next -saveRegistries:.
+- (BOOL)registryResult:(id)result changedForKey:(NSString *)key;
+
+/// Persist a snapshot (same keys as -loadCachedRegistries) together with the
+/// registry hashes seen since the last save. Skips the write if nothing
+/// changed since the last save.
+- (void)saveRegistries:(NSDictionary *)snapshot;
+
+/// Reduce a raw entity registry to the fields the app reads.
++ (NSArray *)trimmedEntityRegistry:(NSArray *)entries;
+
+@end
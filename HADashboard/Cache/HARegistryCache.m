@@ -0,0 +1,151 @@
+#import "HARegistryCache.h"
+#import "HACacheManager.h"
+#import "HALog.h"
+#import <CommonCrypto/CommonDigest.h>
+
+NSString *const HARegistryKeyArea   = @"area";
+NSString *const HARegistryKeyDevice = @"device";
+NSString *const HARegistryKeyEntity = @"entity";
+NSString *const HARegistryKeyFloor  = @"floor";
+
+static NSString *const kRegistryCacheFile = @"registries.json";
+
+@interface HARegistryCache ()
+/// Registry key -> SHA-256 of the raw result behind the saved snapshot, for
+/// the loaded server.
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSString *> *hashes;
+/// Hashes of results seen since the last save. They become the saved hashes
+/// only with the snapshot built from them, so a refresh cut short by a
+/// dropped connection still reports its changes on the next fetch.
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSString *> *pendingHashes;
+@property (nonatomic, copy) NSString *loadedServerURL;
+/// The last snapshot written (or read), to skip identical writes.
+@property (nonatomic, strong) NSDictionary *lastSavedSnapshot;
+@end
+
+@implementation HARegistryCache
+
++ (instancetype)sharedCache {
+    static HARegistryCache *instance = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        instance = [[HARegistryCache alloc] init];
+    });
+    return instance;
+}
+
+#pragma mark - Read
+
+- (NSDictionary *)readFileForCurrentServer {
+    NSString *serverURL = [HACacheManager sharedManager].serverURL;
+    if (self.hashes && (serverURL == self.loadedServerURL || [serverURL isEqualToString:self.loadedServerURL])) {
+        return nil;
+    }
+    self.loadedServerURL = serverURL;
+    self.hashes = [NSMutableDictionary dictionary];
+    self.pendingHashes = [NSMutableDictionary dictionary];
+    self.lastSavedSnapshot = nil;
+
+    NSDictionary *json = serverURL ? [[HACacheManager sharedManager] readJSONFromFile:kRegistryCacheFile] : nil;
+    if (![json isKindOfClass:[NSDictionary class]]) return nil;
+    NSDictionary *hashes = json[@"hashes"];
+    if ([hashes isKindOfClass:[NSDictionary class]]) {
+        [self.hashes addEntriesFromDictionary:hashes];
+    }
+    return json;
+}
+
+- (NSDictionary *)loadCachedRegistries {
+    // Force a re-read so the snapshot is returned even if hashes are already loaded
+    self.hashes = nil;
+    NSDictionary *json = [self readFileForCurrentServer];
+    NSDictionary *snapshot = json[@"snapshot"];
+    if (![snapshot isKindOfClass:[NSDictionary class]]) return nil;
+
+    if (![snapshot[@"areas"] isKindOfClass:[NSArray class]] ||
+        ![snapshot[@"device_areas"] isKindOfClass:[NSDictionary class]] ||
+        ![snapshot[@"entities"] isKindOfClass:[NSArray class]] ||
+        ![snapshot[@"entity_areas"] isKindOfClass:[NSDictionary class]]) {
+        HALogW(@"cache", @"Ignoring incomplete registry cache");
+        return nil;
+    }
+    self.lastSavedSnapshot = snapshot;
+    HALogI(@"cache", @"Loaded cached registries: %lu areas, %lu entity->area mappings",
+           (unsigned long)[snapshot[@"areas"] count], (unsigned long)[snapshot[@"entity_areas"] count]);
+    return snapshot;
+}
+
+#pragma mark - Change Detection
+
+- (BOOL)registryResult:(id)result changedForKey:(NSString *)key {
+    if (!key || !result) return YES;
+    [self readFileForCurrentServer];
+
+    NSData *data = [NSJSONSerialization dataWithJSONObject:result options:NSJSONWritingSortedKeys error:nil];
+    if (!data) return YES;
+    NSString *hash = [self sha256OfData:data];
+    self.pendingHashes[key] = hash;
+    return ![self.hashes[key] isEqualToString:hash];
+}
+
+#pragma mark - Write
+
+- (void)saveRegistries:(NSDictionary *)snapshot {
+    if (!snapshot) return;
+    [self readFileForCurrentServer];
+    BOOL hashesChanged = NO;
+    for (NSString *key in self.pendingHashes) {
+        if (![self.hashes[key] isEqualToString:self.pendingHashes[key]]) hashesChanged = YES;
+    }
+    [self.hashes addEntriesFromDictionary:self.pendingHashes];
+    [self.pendingHashes removeAllObjects];
+    if (!hashesChanged && [snapshot isEqual:self.lastSavedSnapshot]) {
+        HALogD(@"cache", @"Registries unchanged, skipping write");
+        return;
+    }
+    self.lastSavedSnapshot = snapshot;
+
+    // Hashes are written together with the snapshot they describe, so an
+    // interrupted save can never leave "unchanged" hashes over stale data.
+    NSDictionary *json = @{@"hashes": [self.hashes copy], @"snapshot": snapshot};
+    [[HACacheManager sharedManager] writeJSON:json toFile:kRegistryCacheFile completion:^(BOOL success) {
+        if (success) {
+            HALogD(@"cache", @"Cached registries to disk");
+        }
+    }];
+}
+
++ (NSArray *)trimmedEntityRegistry:(NSArray *)entries {
+    static NSArray<NSString *> *keptKeys;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        keptKeys = @[@"entity_id", @"area_id", @"device_id", @"entity_category",
+                     @"hidden_by", @"disabled_by", @"platform"];
+    });
+
+    NSMutableArray *trimmed = [NSMutableArray arrayWithCapacity:entries.count];
+    for (NSDictionary *entry in entries) {
+        if (![entry isKindOfClass:[NSDictionary class]]) continue;
+        NSMutableDictionary *compact = [NSMutableDictionary dictionaryWithCapacity:keptKeys.count];
+        for (NSString *key in keptKeys) {
+            id value = entry[key];
+            if (value && value != [NSNull null]) compact[key] = value;
+        }
+        if (compact[@"entity_id"]) [trimmed addObject:compact];
+    }
+    return trimmed;
+}
+
+#pragma mark - Private
+
+- (NSString *)sha256OfData:(NSData *)data {
+    unsigned char hash[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256(data.bytes, (CC_LONG)data.length, hash);
+    NSMutableString *output = [NSMutableString stringWithCapacity:CC_SHA256_DIGEST_LENGTH * 2];
+    for (int i = 0; i < CC_SHA256_DIGEST_LENGTH; i++) {
+        [output appendFormat:@"%02x", hash[i]];
+    }
+    return output;
+}
+
+@end
@@ -9,6 +9,7 @@
 #import "HABaseEntityCell.h"
 #import "HASettingsViewController.h"
 #import "HALovelaceParser.h"
+#import "HAConditionEvaluator.h"
 #import "HATheme.h"
 #import "HAIconMapper.h"
 #import "HAHaptics.h"
@@ -40,11 +41,15 @@
 #import "HATileEntityCell.h"
 #import "HACalendarCardCell.h"
 #import "HALogbookCardCell.h"
+#import "HAMapCardCell.h"
 #import "HATopAlignedFlowLayout.h"
 #import "HAHistoryManager.h"
+#import "HAStatisticsManager.h"
 #import "HASunBasedTheme.h"
 #import "HAToastView.h"
 #import "HAProximityWakeController.h"
+#import "HADashboardViewStateCache.h"
+#import "HADashboardConfigCache.h"
 #import <QuartzCore/QuartzCore.h>
 
 static NSString * const kSectionHeaderReuseId = @"HASectionHeader";
@@ -64,6 +69,7 @@ static NSString * const kSectionHeaderReuseId = @"HASectionHeader";
 @property (nonatomic, strong) HADashboardConfig *dashboardConfig;
 @property (nonatomic, strong) NSSet<NSString *> *conditionEntityIds; // entity IDs used in visibility conditions
 @property (nonatomic, strong) HALovelaceDashboard *lovelaceDashboard;
+@property (nonatomic, copy)   NSString *lovelaceDashboardPath; // selected path lovelaceDashboard was delivered for
 @property (nonatomic, assign) NSUInteger selectedViewIndex;
 @property (nonatomic, assign) BOOL statesLoaded;
 @property (nonatomic, assign) BOOL lovelaceLoaded;
@@ -90,6 +96,11 @@ static NSString * const kSectionHeaderReuseId = @"HASectionHeader";
 @property (nonatomic, strong) NSMutableSet<NSString *> *pendingMarkdownTemplateStrings;
 @property (nonatomic, assign) BOOL screenshotScheduled;
 @property (nonatomic, strong) HAToastView *kioskToast;
+@property (nonatomic, assign) BOOL deepIdle;                              // screen dimmed, rendering paused
+@property (nonatomic, strong) NSMutableSet<NSString *> *idleDirtyEntityIds; // updates buffered while idle
+@property (nonatomic, assign) BOOL rebuildDeferredByIdle;
+@property (nonatomic, strong) HADashboardViewState *viewState;           // prepared state of the visible Lovelace view
+@property (nonatomic, strong) HADashboardViewStateCache *viewStateCache; // recently shown views, for instant switching
 @end
 
 @implementation HADashboardViewController
@@ -97,6 +108,7 @@ static NSString * const kSectionHeaderReuseId = @"HASectionHeader";
 - (void)viewDidLoad {
     [super viewDidLoad];
     self.view.backgroundColor = [HATheme backgroundColor];
+    self.viewStateCache = [[HADashboardViewStateCache alloc] initWithCapacity:3];
 
     // Gradient background layer (behind everything, shown only in Gradient mode)
     self.backgroundGradient = [CAGradientLayer layer];
@@ -243,6 +255,12 @@ static NSString * const kSectionHeaderReuseId = @"HASectionHeader";
     [[NSNotificationCenter defaultCenter] addObserver:self
         selector:@selector(actionNavigateRequested:)
         name:HAActionNavigateNotification object:nil];
+    [[NSNotificationCenter defaultCenter] addObserver:self
+        selector:@selector(screenDidDim:)
+        name:HAProximityWakeControllerDidDimNotification object:nil];
+    [[NSNotificationCenter defaultCenter] addObserver:self
+        selector:@selector(screenWillWake:)
+        name:HAProximityWakeControllerWillWakeNotification object:nil];
 
     // Connect if not already
     HAConnectionManager *conn = [HAConnectionManager sharedManager];
@@ -260,6 +278,7 @@ static NSString * const kSectionHeaderReuseId = @"HASectionHeader";
             self.lovelaceLoaded = YES;
             self.lovelaceFetchDone = YES;
             self.lovelaceDashboard = conn.lovelaceDashboard;
+            self.lovelaceDashboardPath = [[HAAuthManager sharedManager] selectedDashboardPath];
             [[HASunBasedTheme sharedInstance] start];
             [self rebuildDashboard];
             [self showLoading:NO message:nil];
@@ -317,6 +336,10 @@ static NSString * const kSectionHeaderReuseId = @"HASectionHeader";
     self.kioskHideTimer = nil;
     [self.proximityWakeController stop];
     self.proximityWakeController = nil;
+    // Observers are gone, so the stop above didn't reach screenWillWake:
+    [self exitDeepIdle];
+    // Nor will entity updates reach the cached views
+    [self.viewStateCache removeAllStates];
 
     // Restore idle timer and nav bar when leaving dashboard
 #if !TARGET_OS_MACCATALYST
@@ -333,6 +356,8 @@ static NSString * const kSectionHeaderReuseId = @"HASectionHeader";
 - (void)didReceiveMemoryWarning {
     [super didReceiveMemoryWarning];
     [[HAHistoryManager sharedManager] clearCache];
+    [[HAStatisticsManager sharedManager] clearMemoryCache];
+    [self.viewStateCache removeAllStates];
     HALogW(@"dash", @"Memory warning received, caches cleared");
 }
 
@@ -387,6 +412,8 @@ static NSString * const kSectionHeaderReuseId = @"HASectionHeader";
 
 - (void)themeDidChange:(NSNotification *)notification {
     [self applyTheme];
+    [self.viewStateCache removeAllStates];
+    [self.viewState removeAllHeights];
     [self.collectionView.collectionViewLayout invalidateLayout];
     [self.collectionView reloadData];
 }
@@ -759,6 +786,16 @@ static NSString * const kSectionHeaderReuseId = @"HASectionHeader";
 static const CGFloat kRowUnitHeight = 56.0;
 
 - (CGFloat)heightForItemAtIndexPath:(NSIndexPath *)indexPath itemWidth:(CGFloat)itemWidth {
+    // Memoized per view; entity updates forget the heights of their items
+    HADashboardViewState *state = self.viewState;
+    CGFloat height = [state heightForItemAtIndexPath:indexPath itemWidth:itemWidth];
+    if (height > 0) return height;
+    height = [self preferredHeightForItemAtIndexPath:indexPath itemWidth:itemWidth];
+    [state setHeight:height forItemAtIndexPath:indexPath itemWidth:itemWidth];
+    return height;
+}
+
+- (CGFloat)preferredHeightForItemAtIndexPath:(NSIndexPath *)indexPath itemWidth:(CGFloat)itemWidth {
     HADashboardConfigItem *item = [self itemAtIndexPath:indexPath];
     HADashboardConfigSection *section = [self sectionAtIndex:indexPath.section];
     HAEntity *entity = [[HAConnectionManager sharedManager] entityForId:item.entityId];
@@ -767,73 +804,93 @@ static const CGFloat kRowUnitHeight = 56.0;
     BOOL hasHeading = (item.customProperties[@"headingIcon"] != nil && item.displayName.length > 0);
     CGFloat headingExtra = hasHeading ? [HABaseEntityCell headingHeight] : 0;
 
-    // Compact button/tile cards (inside horizontal-stack) use a fixed small height
-    BOOL isCompact = [item.customProperties[@"compact"] boolValue];
-    if (isCompact) {
-        return [HATileEntityCell compactHeight] + headingExtra;
-    }
-
     // Compute per-card-type height
     CGFloat height;
-
-    if ([item.cardType isEqualToString:@"heading"]) {
-        return 36.0; // match section header height (HASectionHeaderView = 36pt)
-    } else if ([item.cardType isEqualToString:@"markdown"]) {
-        return [HAMarkdownCardCell preferredHeightForConfigItem:item width:itemWidth];
-    } else if ([item.cardType isEqualToString:@"badges"]) {
-        HADashboardConfigSection *entSection = item.entitiesSection ?: section;
-        NSDictionary *allEntities = [[HAConnectionManager sharedManager] allEntities];
-        return [HABadgeRowCell preferredHeightForSection:entSection entities:allEntities width:itemWidth];
-    } else if ([item.cardType isEqualToString:@"glance"]) {
-        HADashboardConfigSection *entSection = item.entitiesSection ?: section;
-        return [HAGlanceCardCell preferredHeightForSection:entSection width:itemWidth configItem:item] + headingExtra;
-    } else if ([item.cardType isEqualToString:@"entities"]) {
-        HADashboardConfigSection *entSection = item.entitiesSection ?: section;
-        if (entSection.entityIds.count > 0 || entSection.customProperties[@"sceneEntityIds"]) {
+    HACellDescriptor *descriptor = [HAEntityCellFactory descriptorForItem:item entity:entity];
+
+    switch (descriptor.heightStrategy) {
+        case HACellHeightStrategyCompact:
+            // Compact button/tile cards (inside horizontal-stack) use a fixed small height
+            return [HATileEntityCell compactHeight] + headingExtra;
+        case HACellHeightStrategyHeading:
+            return 36.0; // match section header height (HASectionHeaderView = 36pt)
+        case HACellHeightStrategyMarkdown:
+            return [HAMarkdownCardCell preferredHeightForConfigItem:item width:itemWidth];
+        case HACellHeightStrategyBadges: {
+            HADashboardConfigSection *entSection = item.entitiesSection ?: section;
             NSDictionary *allEntities = [[HAConnectionManager sharedManager] allEntities];
-            height = [HAEntitiesCardCell preferredHeightForSection:entSection entities:allEntities] + headingExtra;
-        } else {
-            height = 100.0 + headingExtra;
+            return [HABadgeRowCell preferredHeightForSection:entSection entities:allEntities width:itemWidth];
         }
-    } else if ([item.cardType isEqualToString:@"thermostat"]) {
-        height = [HAThermostatGaugeCell preferredHeightForWidth:itemWidth] + headingExtra;
-    } else if ([item.cardType isEqualToString:@"gauge"]) {
-        height = [HAGaugeCardCell preferredHeightForWidth:itemWidth] + headingExtra;
-    } else if ([item.cardType isEqualToString:@"graph"] || [item.cardType isEqualToString:@"mini-graph-card"] ||
-               [item.cardType isEqualToString:@"history-graph"]) {
-        height = [HAGraphCardCell preferredHeight] + headingExtra;
-    } else if ([item.cardType isEqualToString:@"calendar"]) {
-        NSString *initialView = item.customProperties[@"initial_view"];
-        HACalendarViewMode mode = ([initialView hasPrefix:@"list"]) ? HACalendarViewModeList : HACalendarViewModeMonth;
-        height = [HACalendarCardCell preferredHeightForMode:mode] + headingExtra;
-    } else if ([item.cardType containsString:@"clock-weather"]) {
-        NSNumber *rows = item.customProperties[@"forecast_rows"];
-        NSInteger forecastRows = rows ? [rows integerValue] : 5;
-        height = [HAClockWeatherCell preferredHeightForForecastRows:forecastRows] + headingExtra;
-    } else if ([[entity domain] isEqualToString:HAEntityDomainCamera]) {
-        NSNumber *customHeight = item.customProperties[@"height"];
-        height = customHeight ? [customHeight floatValue] + headingExtra : itemWidth * 0.75 + headingExtra;
-    } else if ([[entity domain] isEqualToString:HAEntityDomainVacuum]) {
-        height = 160.0 + headingExtra;
-    } else if ([[entity domain] isEqualToString:HAEntityDomainWeather]) {
-        height = [HAWeatherEntityCell preferredHeight] + headingExtra;
-    } else if ([[entity domain] isEqualToString:HAEntityDomainAlarmControlPanel]) {
-        BOOL hasKeypad = ([entity alarmCodeFormat] != nil);
-        height = (hasKeypad ? [HAAlarmEntityCell preferredHeightWithKeypad]
-                            : [HAAlarmEntityCell preferredHeightWithoutKeypad]) + headingExtra;
-    } else if ([[entity domain] isEqualToString:HAEntityDomainMediaPlayer]) {
-        height = [HAMediaPlayerEntityCell preferredHeight] + headingExtra;
-    } else if ([item.cardType isEqualToString:@"tile"]) {
-        BOOL isCompact = [item.customProperties[@"compact"] boolValue];
-        height = (isCompact ? [HATileEntityCell compactHeight] : [HATileEntityCell preferredHeightForConfigItem:item]) + headingExtra;
-    } else if ([item.cardType isEqualToString:@"logbook"]) {
-        NSInteger hours = 24;
-        if ([item.customProperties[@"hours_to_show"] isKindOfClass:[NSNumber class]]) {
-            hours = [item.customProperties[@"hours_to_show"] integerValue];
+        case HACellHeightStrategyGlance: {
+            HADashboardConfigSection *entSection = item.entitiesSection ?: section;
+            return [HAGlanceCardCell preferredHeightForSection:entSection width:itemWidth configItem:item] + headingExtra;
         }
-        height = [HALogbookCardCell preferredHeightForHours:hours] + headingExtra;
-    } else {
-        height = 100.0 + headingExtra;
+        case HACellHeightStrategyEntities: {
+            HADashboardConfigSection *entSection = item.entitiesSection ?: section;
+            if (entSection.entityIds.count > 0 || entSection.customProperties[@"sceneEntityIds"]) {
+                NSDictionary *allEntities = [[HAConnectionManager sharedManager] allEntities];
+                height = [HAEntitiesCardCell preferredHeightForSection:entSection entities:allEntities] + headingExtra;
+            } else {
+                height = 100.0 + headingExtra;
+            }
+            break;
+        }
+        case HACellHeightStrategyThermostat:
+            height = [HAThermostatGaugeCell preferredHeightForWidth:itemWidth] + headingExtra;
+            break;
+        case HACellHeightStrategyGauge:
+            height = [HAGaugeCardCell preferredHeightForWidth:itemWidth] + headingExtra;
+            break;
+        case HACellHeightStrategyGraph:
+            height = [HAGraphCardCell preferredHeight] + headingExtra;
+            break;
+        case HACellHeightStrategyCalendar: {
+            NSString *initialView = item.customProperties[@"initial_view"];
+            HACalendarViewMode mode = ([initialView hasPrefix:@"list"]) ? HACalendarViewModeList : HACalendarViewModeMonth;
+            height = [HACalendarCardCell preferredHeightForMode:mode] + headingExtra;
+            break;
+        }
+        case HACellHeightStrategyClockWeather: {
+            NSNumber *rows = item.customProperties[@"forecast_rows"];
+            NSInteger forecastRows = rows ? [rows integerValue] : 5;
+            height = [HAClockWeatherCell preferredHeightForForecastRows:forecastRows] + headingExtra;
+            break;
+        }
+        case HACellHeightStrategyCamera: {
+            NSNumber *customHeight = item.customProperties[@"height"];
+            height = customHeight ? [customHeight floatValue] + headingExtra : itemWidth * 0.75 + headingExtra;
+            break;
+        }
+        case HACellHeightStrategyVacuum:
+            height = 160.0 + headingExtra;
+            break;
+        case HACellHeightStrategyWeather:
+            height = [HAWeatherEntityCell preferredHeight] + headingExtra;
+            break;
+        case HACellHeightStrategyAlarm: {
+            BOOL hasKeypad = ([entity alarmCodeFormat] != nil);
+            height = (hasKeypad ? [HAAlarmEntityCell preferredHeightWithKeypad]
+                                : [HAAlarmEntityCell preferredHeightWithoutKeypad]) + headingExtra;
+            break;
+        }
+        case HACellHeightStrategyMediaPlayer:
+            height = [HAMediaPlayerEntityCell preferredHeight] + headingExtra;
+            break;
+        case HACellHeightStrategyTile:
+            height = [HATileEntityCell preferredHeightForConfigItem:item] + headingExtra;
+            break;
+        case HACellHeightStrategyLogbook: {
+            NSInteger hours = 24;
+            if ([item.customProperties[@"hours_to_show"] isKindOfClass:[NSNumber class]]) {
+                hours = [item.customProperties[@"hours_to_show"] integerValue];
+            }
+            height = [HALogbookCardCell preferredHeightForHours:hours] + headingExtra;
+            break;
+        }
+        case HACellHeightStrategyDefault:
+        default:
+            height = 100.0 + headingExtra;
+            break;
     }
 
     // If grid_options specifies explicit rows, use as minimum height
@@ -939,174 +996,14 @@ static const CGFloat kRowUnitHeight = 56.0;
     self.dashboardConfig.items = filteredItems;
 }
 
-static inline NSString *HANormalizeState(id val) {
-    if (!val) return @"";
-    NSString *str = [[val description] lowercaseString];
-    if ([str isEqualToString:@"1"] || [str isEqualToString:@"true"] || [str isEqualToString:@"on"]) {
-        return @"on";
-    }
-    if ([str isEqualToString:@"0"] || [str isEqualToString:@"false"] || [str isEqualToString:@"off"]) {
-        return @"off";
-    }
-    return str;
-}
-
-- (BOOL)meetsCondition:(NSDictionary *)condition
-              entities:(NSDictionary<NSString *, HAEntity *> *)entities {
-    if (![condition isKindOfClass:[NSDictionary class]]) return YES;
-
-    NSString *condType = condition[@"condition"];
-    // Default to "state" if type is omitted but entity is present
-    if (!condType && condition[@"entity"]) {
-        condType = @"state";
-    }
-
-    if ([condType isEqualToString:@"state"]) {
-        NSString *entityId = condition[@"entity"];
-        if (!entityId) return YES;
-
-        HAEntity *entity = entities[entityId];
-        NSString *currentState = entity.state;
-
-        id requiredStateRaw = condition[@"state"];
-        id requiredStateNotRaw = condition[@"state_not"];
-
-        if (requiredStateRaw) {
-            NSArray *requiredStates = [requiredStateRaw isKindOfClass:[NSArray class]]
-                                          ? (NSArray *)requiredStateRaw
-                                          : @[ [requiredStateRaw description] ];
-            BOOL matched = NO;
-            NSString *currNorm = HANormalizeState(currentState);
-            for (id req in requiredStates) {
-                if ([HANormalizeState(req) isEqualToString:currNorm]) {
-                    matched = YES;
-                    break;
-                }
-            }
-            if (!matched) return NO;
-        }
-
-        if (requiredStateNotRaw) {
-            NSArray *requiredStatesNot = [requiredStateNotRaw isKindOfClass:[NSArray class]]
-                                              ? (NSArray *)requiredStateNotRaw
-                                              : @[ [requiredStateNotRaw description] ];
-            NSString *currNorm = HANormalizeState(currentState);
-            for (id req in requiredStatesNot) {
-                if ([HANormalizeState(req) isEqualToString:currNorm]) {
-                    return NO;
-                }
-            }
-        }
-        return YES;
-    }
-
-    if ([condType isEqualToString:@"numeric_state"]) {
-        NSString *entityId = condition[@"entity"];
-        if (!entityId) return YES;
-
-        HAEntity *entity = entities[entityId];
-        NSString *currentState = entity.state;
-        if (!currentState) return NO;
-
-        double currentVal = [currentState doubleValue];
-        id aboveRaw = condition[@"above"];
-        id belowRaw = condition[@"below"];
-
-        if (aboveRaw) {
-            double aboveVal = [aboveRaw doubleValue];
-            if (currentVal <= aboveVal) return NO;
-        }
-        if (belowRaw) {
-            double belowVal = [belowRaw doubleValue];
-            if (currentVal >= belowVal) return NO;
-        }
-        return YES;
-    }
-
-    if ([condType isEqualToString:@"and"]) {
-        NSArray *subConditions = condition[@"conditions"];
-        if ([subConditions isKindOfClass:[NSArray class]]) {
-            for (NSDictionary *sub in subConditions) {
-                if (![self meetsCondition:sub entities:entities]) {
-                    return NO;
-                }
-            }
-        }
-        return YES;
-    }
-
-    if ([condType isEqualToString:@"or"]) {
-        NSArray *subConditions = condition[@"conditions"];
-        if ([subConditions isKindOfClass:[NSArray class]]) {
-            if (subConditions.count == 0) return YES;
-            for (NSDictionary *sub in subConditions) {
-                if ([self meetsCondition:sub entities:entities]) {
-                    return YES;
-                }
-            }
-            return NO;
-        }
-        return YES;
-    }
-
-    if ([condType isEqualToString:@"not"]) {
-        NSArray *subConditions = condition[@"conditions"];
-        if ([subConditions isKindOfClass:[NSArray class]]) {
-            for (NSDictionary *sub in subConditions) {
-                if ([self meetsCondition:sub entities:entities]) {
-                    return NO;
-                }
-            }
-        }
-        return YES;
-    }
-
-    if ([condType isEqualToString:@"user"]) {
-        return YES; // always pass local dashboard
-    }
-
-    if ([condType isEqualToString:@"screen"]) {
-        NSString *query = condition[@"media_query"];
-        if ([query isKindOfClass:[NSString class]]) {
-            CGFloat width = self.view.bounds.size.width;
-            if ([query containsString:@"min-width"]) {
-                NSScanner *scanner = [NSScanner scannerWithString:query];
-                [scanner scanUpToString:@"min-width" intoString:nil];
-                [scanner scanString:@"min-width" intoString:nil];
-                [scanner scanUpToCharactersFromSet:[NSCharacterSet decimalDigitCharacterSet] intoString:nil];
-                NSInteger minWidth = 0;
-                if ([scanner scanInteger:&minWidth] && width < minWidth) {
-                    return NO;
-                }
-            }
-            if ([query containsString:@"max-width"]) {
-                NSScanner *scanner = [NSScanner scannerWithString:query];
-                [scanner scanUpToString:@"max-width" intoString:nil];
-                [scanner scanString:@"max-width" intoString:nil];
-                [scanner scanUpToCharactersFromSet:[NSCharacterSet decimalDigitCharacterSet] intoString:nil];
-                NSInteger maxWidth = 0;
-                if ([scanner scanInteger:&maxWidth] && width > maxWidth) {
-                    return NO;
-                }
-            }
-        }
-        return YES;
-    }
-
-    return YES;
-}
-
 /// Check if item's visibilityConditions are all met. nil conditions = always visible.
 - (BOOL)item:(HADashboardConfigItem *)item meetsConditions:(NSDictionary<NSString *, HAEntity *> *)entities {
     NSArray<NSDictionary *> *conditions = item.visibilityConditions;
     if (!conditions || conditions.count == 0) return YES;
 
-    for (NSDictionary *condition in conditions) {
-        if (![self meetsCondition:condition entities:entities]) {
-            return NO;
-        }
-    }
-    return YES;
+    return [HAConditionEvaluator evaluateConditions:conditions
+                                           entities:entities
+                                        screenWidth:self.view.bounds.size.width];
 }
 
 /// Check if an entity ID is referenced in any visibility condition.
@@ -1116,6 +1013,10 @@ static inline NSString *HANormalizeState(id val) {
 }
 
 - (void)rebuildDashboard {
+    if (self.deepIdle) {
+        self.rebuildDeferredByIdle = YES;
+        return;
+    }
     if (!self.statesLoaded) {
         // The entity store may already have cached entities from loadCachedStateIfAvailable
         // even though statesLoaded is NO (set only by the REST fetchAllStates completion).
@@ -1150,6 +1051,7 @@ static inline NSString *HANormalizeState(id val) {
 
     // Build reverse lookup map: entityId -> [NSIndexPath, ...]
     [self buildEntityToIndexPathMap];
+    [self recordViewState];
 
     [self showLoading:NO message:nil];
     [self showConnectionBar:NO message:nil];
@@ -1173,8 +1075,11 @@ static inline NSString *HANormalizeState(id val) {
     }
 }
 
+/// Also resolves every item's cell descriptor, so dequeue and sizing in the
+/// data source are lookups on the item.
 - (void)buildEntityToIndexPathMap {
     NSMutableDictionary<NSString *, NSMutableArray<NSIndexPath *> *> *map = [NSMutableDictionary dictionary];
+    HAConnectionManager *conn = [HAConnectionManager sharedManager];
 
     for (NSUInteger s = 0; s < self.dashboardConfig.sections.count; s++) {
         HADashboardConfigSection *section = self.dashboardConfig.sections[s];
@@ -1183,22 +1088,14 @@ static inline NSString *HANormalizeState(id val) {
             HADashboardConfigItem *item = section.items[i];
             NSIndexPath *ip = [NSIndexPath indexPathForItem:i inSection:s];
 
-            // Map the item's own entityId
-            if (item.entityId) {
-                if (!map[item.entityId]) map[item.entityId] = [NSMutableArray array];
-                [map[item.entityId] addObject:ip];
-            }
-
-            // Map entity IDs from the item's nested entitiesSection
-            // (entities cards, badges, graphs store child IDs here)
-            HADashboardConfigSection *entSection = item.entitiesSection;
-            if (entSection.entityIds.count > 0) {
-                for (NSString *eid in entSection.entityIds) {
-                    if (!map[eid]) map[eid] = [NSMutableArray array];
-                    if (![map[eid] containsObject:ip]) {
-                        [map[eid] addObject:ip];
-                    }
-                }
+            // Map the item's own entityId and the IDs in its nested
+            // entitiesSection (entities cards, badges, graphs store child IDs there)
+            HACellDescriptor *descriptor = [HAEntityCellFactory descriptorForItem:item
+                                                                            entity:[conn entityForId:item.entityId]];
+            if (!descriptor.liveUpdating) continue;
+            for (NSString *eid in descriptor.entityIds) {
+                if (!map[eid]) map[eid] = [NSMutableArray array];
+                [map[eid] addObject:ip];
             }
         }
 
@@ -1233,13 +1130,6 @@ static inline NSString *HANormalizeState(id val) {
     if (!dashName) dashName = @"Dashboard";
     [self updateTitleButtonText:dashName];
 
-    // Route layout based on viewType
-    BOOL isSections = [view.viewType isEqualToString:@"sections"];
-    BOOL isMasonry = [view.viewType isEqualToString:@"masonry"];
-    BOOL isPanel = [view.viewType isEqualToString:@"panel"];
-    BOOL isSidebar = [view.viewType isEqualToString:@"sidebar"];
-    BOOL isIPad = (UI_USER_INTERFACE_IDIOM() == UIUserInterfaceIdiomPad);
-
     // Clear data source and sync the collection view before switching layouts.
     // UIKit's setCollectionViewLayout: reconciles its cached section/item counts
     // against the data source.  If the previous config had a different section
@@ -1248,6 +1138,41 @@ static inline NSString *HANormalizeState(id val) {
     // config AND call reloadData so UIKit's internal counts match (both zero).
     self.dashboardConfig = nil;
     [self.collectionView reloadData];
+    [self applyLayoutForView:view];
+
+    BOOL isMasonry = [view.viewType isEqualToString:@"masonry"];
+    BOOL isPanel = [view.viewType isEqualToString:@"panel"];
+    BOOL isSidebar = [view.viewType isEqualToString:@"sidebar"];
+    NSInteger columns = [self currentColumns];
+    BOOL interpreted = [view hasConfigForColumns:columns];
+    self.dashboardConfig = [HALovelaceParser dashboardConfigFromView:view columns:columns];
+    if (!interpreted) {
+        // Archive the new interpretation so the next cold start reuses it
+        [[HADashboardConfigCache sharedCache] storeParsedDashboard:self.lovelaceDashboard forDashboard:currentPath];
+    }
+
+    // For classic views, flatten all cards into a single section (section 0).
+    // The parser produces one section per card, but masonry/panel need all items in one section.
+    if (isMasonry) {
+        [self flattenConfigForMasonry];
+    } else if (isPanel) {
+        // Panel: flatten then trim to first card only
+        [self flattenConfigForMasonry];
+        [self trimConfigForPanel];
+    } else if (isSidebar) {
+        // Sidebar: split cards into main (section 0) and sidebar (section 1)
+        [self splitConfigForSidebar];
+    }
+}
+
+/// Install the collection view layout for view's type. The data source must
+/// be empty (see buildLovelaceDashboard:).
+- (void)applyLayoutForView:(HALovelaceView *)view {
+    // Route layout based on viewType
+    BOOL isMasonry = [view.viewType isEqualToString:@"masonry"];
+    BOOL isPanel = [view.viewType isEqualToString:@"panel"];
+    BOOL isSidebar = [view.viewType isEqualToString:@"sidebar"];
+    BOOL isIPad = (UI_USER_INTERFACE_IDIOM() == UIUserInterfaceIdiomPad);
 
     if (isMasonry) {
         // Masonry view: shortest-column-first layout with HA breakpoints
@@ -1267,21 +1192,6 @@ static inline NSString *HANormalizeState(id val) {
             columnar.maxColumns = view.maxColumns; // from HA config (0 = default 4)
         }
     }
-
-    self.dashboardConfig = [HALovelaceParser dashboardConfigFromView:view columns:[self currentColumns]];
-
-    // For classic views, flatten all cards into a single section (section 0).
-    // The parser produces one section per card, but masonry/panel need all items in one section.
-    if (isMasonry) {
-        [self flattenConfigForMasonry];
-    } else if (isPanel) {
-        // Panel: flatten then trim to first card only
-        [self flattenConfigForMasonry];
-        [self trimConfigForPanel];
-    } else if (isSidebar) {
-        // Sidebar: split cards into main (section 0) and sidebar (section 1)
-        [self splitConfigForSidebar];
-    }
 }
 
 - (void)buildDefaultDashboardFromEntities:(NSDictionary<NSString *, HAEntity *> *)entities {
@@ -1639,10 +1549,11 @@ static inline NSString *HANormalizeState(id val) {
     [[HAAuthManager sharedManager] saveSelectedDashboardPath:urlPath];
     [self updateTitleButtonText:title];
 
+    // Render the cached config now; the server's copy is only applied if it differs
     HAConnectionManager *conn = [HAConnectionManager sharedManager];
-    if (conn.isConnected) {
+    BOOL shown = [conn switchToLovelaceDashboard:urlPath];
+    if (!shown && conn.isConnected) {
         [self showLoading:YES message:@"Loading dashboard..."];
-        [conn fetchLovelaceConfig:urlPath];
     }
 }
 
@@ -1673,8 +1584,75 @@ static inline NSString *HANormalizeState(id val) {
 
 - (void)viewPickerChanged:(UISegmentedControl *)sender {
     [HAHaptics selectionChanged];
+    [self stashViewState];
     self.selectedViewIndex = (NSUInteger)sender.selectedSegmentIndex;
-    [self rebuildDashboard];
+    if (![self restoreCachedViewState]) {
+        [self rebuildDashboard];
+    }
+}
+
+#pragma mark - View State Cache
+
+/// Capture the visible Lovelace view after a rebuild.
+- (void)recordViewState {
+    if (!self.lovelaceDashboard || self.lovelaceDashboard.views.count == 0 || !self.dashboardConfig) {
+        self.viewState = nil;
+        return;
+    }
+    HADashboardViewState *state = [[HADashboardViewState alloc] init];
+    state.viewIndex = self.selectedViewIndex;
+    state.dashboardConfig = self.dashboardConfig;
+    state.entityToIndexPaths = self.entityToIndexPaths;
+    state.conditionEntityIds = self.conditionEntityIds;
+    state.width = self.collectionView.bounds.size.width;
+    self.viewState = state;
+}
+
+/// Keep the visible view's state (and scroll position) for a switch back.
+- (void)stashViewState {
+    if (!self.viewState || self.deepIdle) return;
+    self.viewState.contentOffset = self.collectionView.contentOffset;
+    [self.viewStateCache storeState:self.viewState];
+}
+
+/// Swap in the selected view's cached state: no parsing, filtering, reshaping
+/// or index maps, just a layout swap and one reloadData. NO if there is none.
+- (BOOL)restoreCachedViewState {
+    if (self.deepIdle || !self.statesLoaded || !self.lovelaceFetchDone) return NO;
+    HALovelaceView *view = [self.lovelaceDashboard viewAtIndex:self.selectedViewIndex];
+    if (!view) return NO;
+    HADashboardViewState *state = [self.viewStateCache stateForViewIndex:self.selectedViewIndex
+                                                                   width:self.collectionView.bounds.size.width];
+    if (!state) return NO;
+
+    [[HAPerfMonitor sharedMonitor] markRebuildStart];
+    // Pending reloads hold index paths of the view being left
+    [self.reloadCoalesceTimer invalidate];
+    self.reloadCoalesceTimer = nil;
+    [self.pendingReloadPaths removeAllObjects];
+
+    // Same empty-data-source dance as buildLovelaceDashboard: before the layout swap
+    self.dashboardConfig = nil;
+    [self.collectionView reloadData];
+    [self applyLayoutForView:view];
+
+    self.dashboardConfig = state.dashboardConfig;
+    self.entityToIndexPaths = state.entityToIndexPaths;
+    self.conditionEntityIds = state.conditionEntityIds;
+    self.viewState = state;
+    [self.collectionView reloadData];
+    [self.collectionView layoutIfNeeded];
+
+    CGFloat maxOffsetY = MAX(0, self.collectionView.contentSize.height - self.collectionView.bounds.size.height +
+                                self.collectionView.contentInset.bottom);
+    CGPoint offset = state.contentOffset;
+    offset.y = MAX(-self.collectionView.contentInset.top, MIN(offset.y, maxOffsetY));
+    [self.collectionView setContentOffset:offset animated:NO];
+
+    [self renderMarkdownTemplatesForEntityId:nil];
+    [[HAPerfMonitor sharedMonitor] markRebuildEnd];
+    HALogD(@"dash", @"View %lu restored from cache", (unsigned long)self.selectedViewIndex);
+    return YES;
 }
 
 #pragma mark - UICollectionViewDataSource
@@ -1697,9 +1675,10 @@ static inline NSString *HANormalizeState(id val) {
     HAEntity *entity = [conn entityForId:item.entityId];
     NSDictionary *allEntities = [conn allEntities];
 
-    NSString *reuseId = [HAEntityCellFactory reuseIdentifierForEntity:entity cardType:item.cardType];
-    UICollectionViewCell *cell = [collectionView dequeueReusableCellWithReuseIdentifier:reuseId forIndexPath:indexPath];
-    [[HAPerfMonitor sharedMonitor] markCellStart:reuseId];
+    HACellDescriptor *descriptor = [HAEntityCellFactory descriptorForItem:item entity:entity];
+    UICollectionViewCell *cell = [collectionView dequeueReusableCellWithReuseIdentifier:descriptor.reuseIdentifier
+                                                                           forIndexPath:indexPath];
+    [[HAPerfMonitor sharedMonitor] markCellStart:[cell class]];
 
     if ([cell isKindOfClass:[HAGaugeCardCell class]]) {
         [(HAGaugeCardCell *)cell configureWithEntity:entity configItem:item];
@@ -1742,6 +1721,9 @@ static inline NSString *HANormalizeState(id val) {
         HADashboardConfigSection *entSection = item.entitiesSection ?: section;
         NSArray *calEntityIds = entSection.entityIds.count > 0 ? entSection.entityIds : (item.entityId ? @[item.entityId] : @[]);
         [(HACalendarCardCell *)cell configureWithEntityIds:calEntityIds configItem:item];
+    } else if ([cell isKindOfClass:[HAMapCardCell class]]) {
+        HADashboardConfigSection *entSection = item.entitiesSection ?: section;
+        [(HAMapCardCell *)cell configureWithSection:entSection entities:allEntities configItem:item];
     } else if ([cell isKindOfClass:[HABaseEntityCell class]]) {
         [(HABaseEntityCell *)cell configureWithEntity:entity configItem:item];
     }
@@ -2272,6 +2254,7 @@ heightForHeaderInSection:(NSInteger)section {
 
 - (void)viewWillTransitionToSize:(CGSize)size withTransitionCoordinator:(id<UIViewControllerTransitionCoordinator>)coordinator {
     [super viewWillTransitionToSize:size withTransitionCoordinator:coordinator];
+    [self.viewStateCache removeAllStates];
 
     [coordinator animateAlongsideTransition:^(id<UIViewControllerTransitionCoordinatorContext> context) {
         if (self.dashboardConfig) {
@@ -2337,6 +2320,7 @@ heightForHeaderInSection:(NSInteger)section {
                 changed = YES;
             }
             if (changed) {
+                [strongSelf.viewState removeAllHeights];
                 [strongSelf.collectionView.collectionViewLayout invalidateLayout];
                 [strongSelf.collectionView reloadData];
             }
@@ -2344,6 +2328,113 @@ heightForHeaderInSection:(NSInteger)section {
     }
 }
 
+#pragma mark - Deep Idle
+
+- (void)screenDidDim:(NSNotification *)notification {
+    if (notification.object != self.proximityWakeController) return;
+    [self enterDeepIdle];
+}
+
+- (void)screenWillWake:(NSNotification *)notification {
+    if (notification.object != self.proximityWakeController) return;
+    [self exitDeepIdle];
+}
+
+/// Nothing on screen is visible: stop streams, timers and animations, and let
+/// the server send only the entities that should wake the screen.
+- (void)enterDeepIdle {
+    if (self.deepIdle) return;
+    self.deepIdle = YES;
+    self.idleDirtyEntityIds = [NSMutableSet set];
+    self.rebuildDeferredByIdle = NO;
+
+    // Reloads still waiting on the coalesce timer are applied on wake
+    [self.reloadCoalesceTimer invalidate];
+    self.reloadCoalesceTimer = nil;
+
+    for (UICollectionViewCell *cell in self.collectionView.visibleCells) {
+        if ([cell isKindOfClass:[HACameraEntityCell class]]) {
+            [(HACameraEntityCell *)cell cancelLoading];
+        } else if ([cell isKindOfClass:[HAClockWeatherCell class]]) {
+            [(HAClockWeatherCell *)cell pauseUpdates];
+        }
+    }
+
+    // Freeze every remaining Core Animation clock under the dashboard
+    CALayer *layer = self.view.layer;
+    CFTimeInterval pausedTime = [layer convertTime:CACurrentMediaTime() fromLayer:nil];
+    layer.speed = 0.0;
+    layer.timeOffset = pausedTime;
+
+    NSMutableSet<NSString *> *wakeIds = [NSMutableSet set];
+    HAConnectionManager *conn = [HAConnectionManager sharedManager];
+    for (NSString *entityId in self.entityToIndexPaths) {
+        HAEntity *entity = [conn entityForId:entityId];
+        if (entity && [HAProximityWakeController isWakeRelevantEntity:entity]) {
+            [wakeIds addObject:entityId];
+        }
+    }
+    HALogI(@"dash", @"Entering deep idle (%lu wake entities)", (unsigned long)wakeIds.count);
+    [conn enterDeepIdleWithWakeEntityIds:wakeIds];
+}
+
+/// Resume rendering and apply everything buffered while idle in one pass
+/// right away, so whatever woke the screen is on it as it lights up. The
+/// connection's catch-up then arrives as ordinary coalesced updates.
+- (void)exitDeepIdle {
+    if (!self.deepIdle) return;
+
+    CALayer *layer = self.view.layer;
+    CFTimeInterval pausedTime = layer.timeOffset;
+    layer.speed = 1.0;
+    layer.timeOffset = 0.0;
+    layer.beginTime = 0.0;
+    layer.beginTime = [layer convertTime:CACurrentMediaTime() fromLayer:nil] - pausedTime;
+
+    for (UICollectionViewCell *cell in self.collectionView.visibleCells) {
+        if ([cell isKindOfClass:[HACameraEntityCell class]]) {
+            [(HACameraEntityCell *)cell beginLoading];
+        } else if ([cell isKindOfClass:[HAClockWeatherCell class]]) {
+            [(HAClockWeatherCell *)cell resumeUpdates];
+        }
+    }
+
+    [self applyDeepIdleUpdates];
+    [[HAConnectionManager sharedManager] exitDeepIdleWithCompletion:nil];
+}
+
+- (void)applyDeepIdleUpdates {
+    if (!self.deepIdle) return;
+    self.deepIdle = NO;
+    NSSet<NSString *> *dirty = [self.idleDirtyEntityIds copy];
+    BOOL rebuild = self.rebuildDeferredByIdle || [dirty intersectsSet:self.conditionEntityIds];
+    self.idleDirtyEntityIds = nil;
+    self.rebuildDeferredByIdle = NO;
+    HALogI(@"dash", @"Leaving deep idle — %lu dirty entities%@",
+           (unsigned long)dirty.count, rebuild ? @", rebuilding" : @"");
+    for (NSString *entityId in dirty) {
+        [self.viewState entityDidUpdate:entityId];
+        [self.viewStateCache entityDidUpdate:entityId];
+    }
+
+    // One commit, no implicit animations: the dashboard snaps to current state
+    [CATransaction begin];
+    [CATransaction setDisableActions:YES];
+    if (rebuild) {
+        [self rebuildDashboard];
+    } else {
+        for (NSString *entityId in dirty) {
+            NSArray<NSIndexPath *> *indexPaths = self.entityToIndexPaths[entityId];
+            if (indexPaths.count > 0) [self scheduleReloadForIndexPaths:indexPaths];
+        }
+        [self.reloadCoalesceTimer invalidate];
+        self.reloadCoalesceTimer = nil;
+        [self flushPendingReloads];
+        if (dirty.count > 0) [self renderMarkdownTemplatesForEntityId:nil];
+    }
+    [CATransaction commit];
+}
+
 #pragma mark - Notification
 
 - (void)registriesDidLoad:(NSNotification *)notification {
@@ -2352,6 +2443,7 @@ heightForHeaderInSection:(NSInteger)section {
     // - Strategy dashboard: connection manager re-resolves with area data and sends
     //   updated lovelaceDashboard, so we rebuild to pick it up
     if (self.statesLoaded) {
+        [self.viewStateCache removeAllStates];
         [self rebuildDashboard];
     }
 }
@@ -2360,6 +2452,18 @@ heightForHeaderInSection:(NSInteger)section {
     HAEntity *entity = notification.userInfo[@"entity"];
     if (!entity || !self.dashboardConfig) return;
 
+    if (self.deepIdle) {
+        [self.idleDirtyEntityIds addObject:entity.entityId];
+        if ([HAProximityWakeController entityStateShouldWakeScreen:entity]) {
+            HALogI(@"dash", @"Waking screen for %@ -> %@", entity.entityId, entity.state);
+            [self.proximityWakeController wakeScreen];
+        }
+        return;
+    }
+
+    [self.viewState entityDidUpdate:entity.entityId];
+    [self.viewStateCache entityDidUpdate:entity.entityId];
+
     [self renderMarkdownTemplatesForEntityId:entity.entityId];
 
     // Camera cells manage their own 5s refresh timer. Reloading them via the
@@ -2459,6 +2563,10 @@ heightForHeaderInSection:(NSInteger)section {
         } else if ([cell isKindOfClass:[HAEntitiesCardCell class]]) {
             HADashboardConfigSection *entSection = item.entitiesSection ?: section;
             [(HAEntitiesCardCell *)cell configureWithSection:entSection entities:allEntities configItem:item];
+        } else if ([cell isKindOfClass:[HAMapCardCell class]]) {
+            // Moves only the trackers that changed
+            HADashboardConfigSection *entSection = item.entitiesSection ?: section;
+            [(HAMapCardCell *)cell configureWithSection:entSection entities:allEntities configItem:item];
         } else if ([cell isKindOfClass:[HAGaugeCardCell class]]) {
             HAEntity *entity = [conn entityForId:item.entityId];
             [(HAGaugeCardCell *)cell configureWithEntity:entity configItem:item];
@@ -2504,6 +2612,7 @@ heightForHeaderInSection:(NSInteger)section {
 
 - (void)connectionManager:(HAConnectionManager *)manager didReceiveAllStates:(NSDictionary<NSString *, HAEntity *> *)entities {
     self.statesLoaded = YES;
+    [self.viewStateCache removeAllStates];
     [[HASunBasedTheme sharedInstance] start];
     [self rebuildDashboard];
 }
@@ -2513,9 +2622,15 @@ heightForHeaderInSection:(NSInteger)section {
     // re-delivered (e.g. after a websocket reconnect while in Settings).
     // Only reset to view 0 on the very first load or when the dashboard changes.
     BOOL wasLoaded = self.lovelaceLoaded;
-    BOOL isRefresh = (wasLoaded && self.selectedViewIndex < dashboard.views.count);
+    NSString *dashboardPath = [[HAAuthManager sharedManager] selectedDashboardPath];
+    BOOL sameDashboard = wasLoaded && (dashboardPath == self.lovelaceDashboardPath ||
+                                       [dashboardPath isEqualToString:self.lovelaceDashboardPath]);
+    BOOL isRefresh = (sameDashboard && self.selectedViewIndex < dashboard.views.count);
+    HALovelaceDashboard *previous = self.lovelaceDashboard;
 
     self.lovelaceDashboard = dashboard;
+    self.lovelaceDashboardPath = dashboardPath;
+    [self.viewStateCache removeAllStates];
     self.lovelaceLoaded = YES;
     self.lovelaceFetchDone = YES;
 
@@ -2533,6 +2648,20 @@ heightForHeaderInSection:(NSInteger)section {
         HALogD(@"dash", @"  View %lu: %@ (%lu cards)", (unsigned long)i, view.title, (unsigned long)view.rawCards.count);
     }
 
+    // A revalidated config that leaves the visible view alone (edits to other
+    // views, a renamed tab) doesn't rebuild what's on screen
+    HALovelaceView *shownView = [previous viewAtIndex:self.selectedViewIndex];
+    if (isRefresh && shownView && [shownView isLayoutEqualToView:[dashboard viewAtIndex:self.selectedViewIndex]]) {
+        HALogI(@"dash", @"Visible view unchanged — keeping layout");
+        NSArray *oldTitles = [previous.views valueForKey:@"title"];
+        if (![oldTitles isEqualToArray:[dashboard.views valueForKey:@"title"]]) {
+            [self populateViewPicker];
+        }
+        [self showLoading:NO message:nil];
+        [self.refreshControl endRefreshing];
+        return;
+    }
+
     [self populateViewPicker];
     [self rebuildDashboard];
 }
@@ -6,6 +6,8 @@
 #import "HAConnectionManager.h"
 #import "HABottomSheetPresentationController.h"
 #import "HAHistoryManager.h"
+#import "HAHistoryPyramid.h"
+#import "HALog.h"
 #import "HAGraphView.h"
 #import "HAAttributeRowView.h"
 #import "HAEntityDetailSection.h"
@@ -15,6 +17,9 @@ static const CGFloat kGrabberHeight = 5.0;
 static const CGFloat kHeaderPadding = 16.0;
 static const CGFloat kIconSize = 28.0;
 static const CGFloat kGraphHeight = 160.0;
+/// Attribute lists longer than this start collapsed to kCollapsedAttributeRows
+static const NSUInteger kAttributeCollapseThreshold = 30;
+static const NSUInteger kCollapsedAttributeRows = 20;
 
 @interface HAEntityDetailViewController () <HAGraphViewDelegate>
 @property (nonatomic, strong, readwrite) UIScrollView *scrollView;
@@ -37,13 +42,31 @@ static const CGFloat kGraphHeight = 160.0;
 @property (nonatomic, strong) id<HAEntityDetailSection> domainSection;
 @property (nonatomic, strong) UIView *domainSectionView;
 
-// Attributes section
+// Attributes section: rows are diffed by key on each update
 @property (nonatomic, strong) UIStackView *attributesStack;
-
-// Zoom re-fetch
+/// Shown attribute keys in display order, re-sorted only when keys come or go
+@property (nonatomic, copy) NSArray<NSString *> *attributeKeys;
+/// Attributes the rows were last built from
+@property (nonatomic, copy) NSDictionary *shownAttributes;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, HAAttributeRowView *> *attributeRows;
+/// Rows taken out of the stack, reused for keys that appear later
+@property (nonatomic, strong) NSMutableArray<HAAttributeRowView *> *spareAttributeRows;
+@property (nonatomic, strong) UIButton *showAllAttributesButton;
+@property (nonatomic, strong) UILabel *attributionLabel;
+@property (nonatomic, assign) BOOL showsAllAttributes;
+
+// Zoom: numeric graphs redraw from history pyramids, the timer only covers network fetches
 @property (nonatomic, strong) NSTimer *zoomFetchTimer;
 @property (nonatomic, assign) NSTimeInterval pendingZoomStart;
 @property (nonatomic, assign) NSTimeInterval pendingZoomEnd;
+// Full range of the loaded numeric history (epoch)
+@property (nonatomic, assign) NSTimeInterval historyRangeStart;
+@property (nonatomic, assign) NSTimeInterval historyRangeEnd;
+// Bumped per loadHistory so late responses for an old range are dropped
+@property (nonatomic, assign) NSUInteger historyLoadGeneration;
+// entity_id -> pyramid handed to the last load, held for the life of the
+// sheet; the manager's cache may evict a large one right after inserting it
+@property (nonatomic, strong) NSMutableDictionary<NSString *, HAHistoryPyramid *> *loadedPyramids;
 
 // Custom date range
 @property (nonatomic, strong) UIView *datePickerContainer;
@@ -305,62 +328,138 @@ static const CGFloat kGraphHeight = 160.0;
     self.attributesStack.translatesAutoresizingMaskIntoConstraints = NO;
     [self.contentStack addArrangedSubview:self.attributesStack];
 
-    [self rebuildAttributes];
+    self.attributeRows = [NSMutableDictionary dictionary];
+    self.spareAttributeRows = [NSMutableArray array];
+    [self updateAttributes];
 }
 
-- (void)rebuildAttributes {
-    // Remove old rows
-    for (UIView *sub in self.attributesStack.arrangedSubviews) {
-        [self.attributesStack removeArrangedSubview:sub];
-        [sub removeFromSuperview];
-    }
-
-    NSDictionary *attributes = self.entity.attributes;
-    if (!attributes || attributes.count == 0) return;
-
-    // Standard attributes to filter out
+/// Attribute keys to show as rows, sorted. Standard attributes shown
+/// elsewhere (name, icon, unit) and the attribution line are left out.
+- (NSArray<NSString *> *)sortedAttributeKeys:(NSDictionary *)attributes {
     static NSSet *filteredKeys = nil;
     static dispatch_once_t onceToken;
     dispatch_once(&onceToken, ^{
         filteredKeys = [NSSet setWithArray:@[
             HAAttrFriendlyName, HAAttrIcon, @"entity_picture", HAAttrUnitOfMeasurement,
-            @"assumed_state", HAAttrSupportedFeatures, HAAttrDeviceClass,
+            @"assumed_state", HAAttrSupportedFeatures, HAAttrDeviceClass, @"attribution",
         ]];
     });
 
-    NSString *attribution = nil;
+    NSMutableArray<NSString *> *keys = [NSMutableArray arrayWithCapacity:attributes.count];
+    for (NSString *key in attributes) {
+        if (![key isKindOfClass:[NSString class]] || [filteredKeys containsObject:key]) continue;
+        [keys addObject:key];
+    }
+    [keys sortUsingSelector:@selector(localizedCaseInsensitiveCompare:)];
+    return keys;
+}
 
-    NSArray *sortedKeys = [[attributes allKeys] sortedArrayUsingSelector:@selector(localizedCaseInsensitiveCompare:)];
-    for (NSString *key in sortedKeys) {
-        if ([filteredKeys containsObject:key]) continue;
+/// Bring the attribute rows in line with the entity's attributes. Rows whose
+/// value is unchanged are left alone, changed values are re-formatted in
+/// place, and rows for removed keys are kept for reuse. Long lists show their
+/// first kCollapsedAttributeRows rows until "Show all" is tapped, so rows
+/// further down are not built for a sheet that is never scrolled.
+- (void)updateAttributes {
+    NSDictionary *attributes = self.entity.attributes ?: @{};
+    NSDictionary *previous = self.shownAttributes;
+    if (previous && [attributes isEqualToDictionary:previous]) return;
+    self.shownAttributes = attributes;
+
+    BOOL keysChanged = (previous == nil || previous.count != attributes.count);
+    if (!keysChanged) {
+        for (id key in attributes) {
+            if (!previous[key]) { keysChanged = YES; break; }
+        }
+    }
+    if (keysChanged) {
+        self.attributeKeys = [self sortedAttributeKeys:attributes];
+    }
 
-        id value = attributes[key];
+    NSArray<NSString *> *keys = self.attributeKeys;
+    BOOL collapsed = !self.showsAllAttributes && keys.count > kAttributeCollapseThreshold;
+    NSArray<NSString *> *rowKeys = collapsed ? [keys subarrayWithRange:NSMakeRange(0, kCollapsedAttributeRows)] : keys;
 
-        if ([key isEqualToString:@"attribution"]) {
-            attribution = [self formatAttributeValue:value];
-            continue;
+    if (keysChanged) {
+        NSSet *rowKeySet = [NSSet setWithArray:rowKeys];
+        for (NSString *key in self.attributeRows.allKeys) {
+            if ([rowKeySet containsObject:key]) continue;
+            HAAttributeRowView *row = self.attributeRows[key];
+            [self.attributesStack removeArrangedSubview:row];
+            [row removeFromSuperview];
+            [self.spareAttributeRows addObject:row];
+            [self.attributeRows removeObjectForKey:key];
         }
+    }
 
-        NSString *displayKey = [self humanReadableKey:key];
-        NSString *displayValue = [self formatAttributeValue:value];
+    [rowKeys enumerateObjectsUsingBlock:^(NSString *key, NSUInteger index, BOOL *stop) {
+        id value = attributes[key];
+        HAAttributeRowView *row = self.attributeRows[key];
+        if (row) {
+            if (![value isEqual:previous[key]]) {
+                [row configureWithKey:[self humanReadableKey:key] value:[self formatAttributeValue:value]];
+            }
+            if (!keysChanged) return;
+        } else {
+            row = self.spareAttributeRows.lastObject ?: [[HAAttributeRowView alloc] init];
+            [self.spareAttributeRows removeLastObject];
+            [row configureWithKey:[self humanReadableKey:key] value:[self formatAttributeValue:value]];
+            self.attributeRows[key] = row;
+        }
+        // Moves the row if it is already arranged at another index
+        [self.attributesStack insertArrangedSubview:row atIndex:index];
+    }];
 
-        HAAttributeRowView *row = [[HAAttributeRowView alloc] init];
-        [row configureWithKey:displayKey value:displayValue];
-        [self.attributesStack addArrangedSubview:row];
-    }
+    [self updateShowAllAttributesButtonWithHiddenCount:keys.count - rowKeys.count atIndex:rowKeys.count];
 
     // Attribution line at the bottom
+    id attributionValue = attributes[@"attribution"];
+    NSString *attribution = attributionValue ? [self formatAttributeValue:attributionValue] : nil;
     if (attribution.length > 0) {
-        UILabel *attrLabel = [[UILabel alloc] init];
-        attrLabel.text = attribution;
-        attrLabel.font = [UIFont systemFontOfSize:11];
-        attrLabel.textColor = [HATheme tertiaryTextColor];
-        attrLabel.numberOfLines = 0;
-        attrLabel.translatesAutoresizingMaskIntoConstraints = NO;
-        [self.attributesStack addArrangedSubview:attrLabel];
+        if (!self.attributionLabel) {
+            UILabel *attrLabel = [[UILabel alloc] init];
+            attrLabel.font = [UIFont systemFontOfSize:11];
+            attrLabel.textColor = [HATheme tertiaryTextColor];
+            attrLabel.numberOfLines = 0;
+            attrLabel.translatesAutoresizingMaskIntoConstraints = NO;
+            self.attributionLabel = attrLabel;
+        }
+        self.attributionLabel.text = attribution;
+        if (self.attributionLabel.superview != self.attributesStack) {
+            [self.attributesStack addArrangedSubview:self.attributionLabel];
+        }
+    } else if (self.attributionLabel.superview) {
+        [self.attributesStack removeArrangedSubview:self.attributionLabel];
+        [self.attributionLabel removeFromSuperview];
     }
 }
 
+- (void)updateShowAllAttributesButtonWithHiddenCount:(NSUInteger)hiddenCount atIndex:(NSUInteger)index {
+    if (hiddenCount == 0) {
+        if (self.showAllAttributesButton.superview) {
+            [self.attributesStack removeArrangedSubview:self.showAllAttributesButton];
+            [self.showAllAttributesButton removeFromSuperview];
+        }
+        return;
+    }
+    if (!self.showAllAttributesButton) {
+        UIButton *button = [UIButton buttonWithType:UIButtonTypeSystem];
+        button.titleLabel.font = [UIFont systemFontOfSize:13 weight:UIFontWeightMedium];
+        button.contentHorizontalAlignment = UIControlContentHorizontalAlignmentLeft;
+        [button setTitleColor:[HATheme accentColor] forState:UIControlStateNormal];
+        [button addTarget:self action:@selector(showAllAttributesTapped) forControlEvents:UIControlEventTouchUpInside];
+        self.showAllAttributesButton = button;
+    }
+    NSString *title = [NSString stringWithFormat:@"Show all attributes (%lu more)", (unsigned long)hiddenCount];
+    [self.showAllAttributesButton setTitle:title forState:UIControlStateNormal];
+    [self.attributesStack insertArrangedSubview:self.showAllAttributesButton atIndex:index];
+}
+
+- (void)showAllAttributesTapped {
+    self.showsAllAttributes = YES;
+    self.shownAttributes = nil; // place the remaining rows on the next pass
+    [self updateAttributes];
+}
+
 - (NSString *)humanReadableKey:(NSString *)key {
     // Replace underscores with spaces and capitalize first letter
     NSString *spaced = [key stringByReplacingOccurrencesOfString:@"_" withString:@" "];
@@ -439,90 +538,50 @@ static const CGFloat kGraphHeight = 160.0;
     self.graphView.dataPoints = nil;
     self.graphView.dataSeries = nil;
     self.graphView.timelineData = nil;
+    self.historyLoadGeneration++;
     [self.graphSpinner startAnimating];
 
-    // Multi-entity: parallel fetch all entities
-    if (self.graphEntities.count > 1) {
-        [self loadMultiEntityHistory];
+    BOOL isCustom = (self.historySegment.selectedSegmentIndex == 4 && self.customStartDate && self.customEndDate);
+    NSDate *startDate = isCustom ? self.customStartDate : [NSDate dateWithTimeIntervalSinceNow:-[self selectedHoursBack] * 3600];
+    NSDate *endDate = isCustom ? self.customEndDate : [NSDate date];
+
+    // Numeric graphs (single or multi-entity) are drawn from history pyramids
+    if (![self isStateBasedEntity]) {
+        [self loadNumericHistoryFromDate:startDate toDate:endDate];
         return;
     }
 
-    // Single-entity path (unchanged)
-    // Custom date range
-    if (self.historySegment.selectedSegmentIndex == 4 && self.customStartDate && self.customEndDate) {
-        NSTimeInterval duration = [self.customEndDate timeIntervalSinceDate:self.customStartDate];
-        NSUInteger maxPoints = (duration < 7200) ? 250 : 100;
-        NSUInteger deviceMax = [HAGraphView maxPointsForDevice];
-        if (maxPoints > deviceMax) maxPoints = deviceMax;
-        NSString *entityId = self.entity.entityId;
-        __weak typeof(self) weakSelf = self;
-
-        if ([self isStateBasedEntity]) {
-            [[HAHistoryManager sharedManager] fetchTimelineForEntityId:entityId
-                                                            startDate:self.customStartDate
-                                                              endDate:self.customEndDate
-                                                           completion:^(NSArray *segments, NSError *error) {
-                __strong typeof(weakSelf) strongSelf = weakSelf;
-                if (!strongSelf) return;
-                [strongSelf.graphSpinner stopAnimating];
-                if (segments.count > 0) {
-                    strongSelf.graphView.timelineData = @[@{@"segments": segments, @"label": [strongSelf.entity friendlyName] ?: entityId, @"entityId": entityId}];
-                }
-            }];
-        } else {
-            [[HAHistoryManager sharedManager] fetchHistoryForEntityId:entityId
-                                                           startDate:self.customStartDate
-                                                             endDate:self.customEndDate
-                                                           maxPoints:maxPoints
-                                                          completion:^(NSArray *points, NSError *error) {
-                __strong typeof(weakSelf) strongSelf = weakSelf;
-                if (!strongSelf) return;
-                [strongSelf.graphSpinner stopAnimating];
-                if (points.count > 0) strongSelf.graphView.dataPoints = points;
-            }];
-        }
+    // Multi-entity: parallel fetch all entities
+    if (self.graphEntities.count > 1) {
+        [self loadMultiEntityTimelineFromDate:startDate toDate:endDate];
         return;
     }
 
-    NSInteger hours = [self selectedHoursBack];
     NSString *entityId = self.entity.entityId;
+    NSUInteger generation = self.historyLoadGeneration;
     __weak typeof(self) weakSelf = self;
+    [[HAHistoryManager sharedManager] fetchTimelineForEntityId:entityId
+                                                    startDate:startDate
+                                                      endDate:endDate
+                                                   completion:^(NSArray *segments, NSError *error) {
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        if (!strongSelf || strongSelf.historyLoadGeneration != generation) return;
+        [strongSelf.graphSpinner stopAnimating];
 
-    if ([self isStateBasedEntity]) {
-        [[HAHistoryManager sharedManager] fetchTimelineForEntityId:entityId
-                                                        hoursBack:hours
-                                                       completion:^(NSArray *segments, NSError *error) {
-            __strong typeof(weakSelf) strongSelf = weakSelf;
-            if (!strongSelf) return;
-            [strongSelf.graphSpinner stopAnimating];
-
-            if (segments.count > 0) {
-                strongSelf.graphView.timelineData = @[@{
-                    @"segments": segments,
-                    @"label": [strongSelf.entity friendlyName] ?: entityId,
-                    @"entityId": entityId,
-                }];
-            }
-        }];
-    } else {
-        [[HAHistoryManager sharedManager] fetchHistoryForEntityId:entityId
-                                                       hoursBack:hours
-                                                      completion:^(NSArray *points, NSError *error) {
-            __strong typeof(weakSelf) strongSelf = weakSelf;
-            if (!strongSelf) return;
-            [strongSelf.graphSpinner stopAnimating];
-
-            if (points.count > 0) {
-                strongSelf.graphView.dataPoints = points;
-            }
-        }];
-    }
+        if (segments.count > 0) {
+            strongSelf.graphView.timelineData = @[@{
+                @"segments": segments,
+                @"label": [strongSelf.entity friendlyName] ?: entityId,
+                @"entityId": entityId,
+            }];
+        }
+    }];
 }
 
-- (void)loadMultiEntityHistory {
+- (void)loadMultiEntityTimelineFromDate:(NSDate *)startDate toDate:(NSDate *)endDate {
     NSArray *graphEntities = [self.graphEntities copy];
     HAHistoryManager *mgr = [HAHistoryManager sharedManager];
-    BOOL isTimeline = [self isStateBasedEntity];
+    NSUInteger generation = self.historyLoadGeneration;
     __weak typeof(self) weakSelf = self;
 
     NSMutableArray *results = [NSMutableArray arrayWithCapacity:graphEntities.count];
@@ -532,97 +591,154 @@ static const CGFloat kGraphHeight = 160.0;
 
     dispatch_group_t group = dispatch_group_create();
 
-    // Determine time range
-    NSDate *startDate = nil;
-    NSDate *endDate = nil;
-    if (self.historySegment.selectedSegmentIndex == 4 && self.customStartDate && self.customEndDate) {
-        startDate = self.customStartDate;
-        endDate = self.customEndDate;
-    }
-
-    NSInteger hours = [self selectedHoursBack];
-
     for (NSUInteger i = 0; i < graphEntities.count; i++) {
         NSDictionary *info = graphEntities[i];
         NSString *entityId = info[@"entityId"];
         NSUInteger capturedIndex = i;
 
         dispatch_group_enter(group);
-        if (isTimeline) {
-            if (startDate && endDate) {
-                [mgr fetchTimelineForEntityId:entityId startDate:startDate endDate:endDate completion:^(NSArray *segments, NSError *error) {
-                    if (segments.count > 0) {
-                        @synchronized(results) { results[capturedIndex] = segments; }
-                    }
-                    dispatch_group_leave(group);
-                }];
-            } else {
-                [mgr fetchTimelineForEntityId:entityId hoursBack:hours completion:^(NSArray *segments, NSError *error) {
-                    if (segments.count > 0) {
-                        @synchronized(results) { results[capturedIndex] = segments; }
-                    }
-                    dispatch_group_leave(group);
-                }];
-            }
-        } else {
-            if (startDate && endDate) {
-                [mgr fetchHistoryForEntityId:entityId startDate:startDate endDate:endDate maxPoints:200 completion:^(NSArray *points, NSError *error) {
-                    if (points.count > 0) {
-                        @synchronized(results) { results[capturedIndex] = points; }
-                    }
-                    dispatch_group_leave(group);
-                }];
-            } else {
-                [mgr fetchHistoryForEntityId:entityId hoursBack:hours completion:^(NSArray *points, NSError *error) {
-                    if (points.count > 0) {
-                        @synchronized(results) { results[capturedIndex] = points; }
-                    }
-                    dispatch_group_leave(group);
-                }];
+        [mgr fetchTimelineForEntityId:entityId startDate:startDate endDate:endDate completion:^(NSArray *segments, NSError *error) {
+            if (segments.count > 0) {
+                @synchronized(results) { results[capturedIndex] = segments; }
             }
-        }
+            dispatch_group_leave(group);
+        }];
     }
 
     dispatch_group_notify(group, dispatch_get_main_queue(), ^{
         __strong typeof(weakSelf) strongSelf = weakSelf;
-        if (!strongSelf) return;
+        if (!strongSelf || strongSelf.historyLoadGeneration != generation) return;
         [strongSelf.graphSpinner stopAnimating];
 
-        if (isTimeline) {
-            NSMutableArray *timelineEntries = [NSMutableArray array];
-            for (NSUInteger i = 0; i < graphEntities.count; i++) {
-                NSArray *segments = results[i];
-                if (![segments isKindOfClass:[NSArray class]] || segments.count == 0) continue;
-                NSDictionary *info = graphEntities[i];
-                [timelineEntries addObject:@{
-                    @"segments": segments,
-                    @"label": info[@"label"] ?: @"",
-                    @"entityId": info[@"entityId"] ?: @"",
-                }];
-            }
-            if (timelineEntries.count > 0) {
-                strongSelf.graphView.timelineData = timelineEntries;
-            }
-        } else {
-            NSMutableArray *dataSeries = [NSMutableArray array];
-            for (NSUInteger i = 0; i < graphEntities.count; i++) {
-                NSArray *points = results[i];
-                if (![points isKindOfClass:[NSArray class]] || points.count == 0) continue;
-                NSDictionary *info = graphEntities[i];
-                [dataSeries addObject:@{
-                    @"points": points,
-                    @"color": info[@"color"],
-                    @"label": info[@"label"],
-                    @"unit": info[@"unit"] ?: @"",
-                }];
-            }
-            if (dataSeries.count > 0) {
-                strongSelf.graphView.dataSeries = dataSeries;
-            }
+        NSMutableArray *timelineEntries = [NSMutableArray array];
+        for (NSUInteger i = 0; i < graphEntities.count; i++) {
+            NSArray *segments = results[i];
+            if (![segments isKindOfClass:[NSArray class]] || segments.count == 0) continue;
+            NSDictionary *info = graphEntities[i];
+            [timelineEntries addObject:@{
+                @"segments": segments,
+                @"label": info[@"label"] ?: @"",
+                @"entityId": info[@"entityId"] ?: @"",
+            }];
+        }
+        if (timelineEntries.count > 0) {
+            strongSelf.graphView.timelineData = timelineEntries;
+        }
+    });
+}
+
+#pragma mark - Numeric History (pyramid-backed)
+
+/// Entity IDs drawn as numeric series, in graph order.
+- (NSArray<NSString *> *)numericEntityIds {
+    if (self.graphEntities.count > 1) {
+        NSMutableArray *ids = [NSMutableArray arrayWithCapacity:self.graphEntities.count];
+        for (NSDictionary *info in self.graphEntities) {
+            if (info[@"entityId"]) [ids addObject:info[@"entityId"]];
         }
+        return ids;
+    }
+    return self.entity.entityId ? @[self.entity.entityId] : @[];
+}
+
+/// Point budget for the on-screen window; the graph decimates per pixel
+/// column, so this only bounds how much is boxed into NSDictionary points.
+- (NSUInteger)maxPointsForDuration:(NSTimeInterval)duration {
+    NSUInteger maxPoints;
+    if (duration < 1800)       maxPoints = 300;
+    else if (duration < 7200)  maxPoints = 250;
+    else if (duration < 21600) maxPoints = 200;
+    else                       maxPoints = 100;
+    NSUInteger deviceMax = [HAGraphView maxPointsForDevice];
+    return MIN(maxPoints, deviceMax);
+}
+
+/// Load raw history for the full range into each entity's pyramid (only the
+/// spans not already held go to the network), then draw.
+- (void)loadNumericHistoryFromDate:(NSDate *)startDate toDate:(NSDate *)endDate {
+    self.historyRangeStart = [startDate timeIntervalSince1970];
+    self.historyRangeEnd = [endDate timeIntervalSince1970];
+    [self ensureNumericHistoryFromTime:self.historyRangeStart toTime:self.historyRangeEnd];
+}
+
+- (void)ensureNumericHistoryFromTime:(NSTimeInterval)start toTime:(NSTimeInterval)end {
+    NSArray<NSString *> *entityIds = [self numericEntityIds];
+    HAHistoryManager *mgr = [HAHistoryManager sharedManager];
+    NSUInteger generation = self.historyLoadGeneration;
+    NSDate *startDate = [NSDate dateWithTimeIntervalSince1970:start];
+    NSDate *endDate = [NSDate dateWithTimeIntervalSince1970:end];
+    __weak typeof(self) weakSelf = self;
+
+    dispatch_group_t group = dispatch_group_create();
+    for (NSString *entityId in entityIds) {
+        dispatch_group_enter(group);
+        [mgr loadHistoryPyramidForEntityId:entityId startDate:startDate endDate:endDate
+                            reusingPyramid:self.loadedPyramids[entityId]
+                                completion:^(HAHistoryPyramid *pyramid, NSError *error) {
+            if (error) HALogW(@"history", @"%@: history load incomplete: %@", entityId, error.localizedDescription);
+            __strong typeof(weakSelf) strongSelf = weakSelf;
+            if (strongSelf && pyramid) {
+                if (!strongSelf.loadedPyramids) strongSelf.loadedPyramids = [NSMutableDictionary dictionary];
+                strongSelf.loadedPyramids[entityId] = pyramid;
+            }
+            dispatch_group_leave(group);
+        }];
+    }
+
+    dispatch_group_notify(group, dispatch_get_main_queue(), ^{
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        if (!strongSelf || strongSelf.historyLoadGeneration != generation) return;
+        [strongSelf.graphSpinner stopAnimating];
+        [strongSelf renderNumericHistory];
     });
 }
 
+/// Pyramid this sheet loaded for entityId, else whatever the shared cache holds
+- (HAHistoryPyramid *)pyramidForEntityId:(NSString *)entityId {
+    if (!entityId) return nil;
+    return self.loadedPyramids[entityId] ?: [[HAHistoryManager sharedManager] cachedPyramidForEntityId:entityId];
+}
+
+/// Draw every numeric series from memory. When zoomed, the visible window
+/// gets the full point budget and the rest of the range is filled in
+/// coarsely so panning and pinching out never show an empty graph.
+- (void)renderNumericHistory {
+    if (self.historyRangeEnd <= self.historyRangeStart) return;
+    NSTimeInterval start = self.historyRangeStart;
+    NSTimeInterval end = self.historyRangeEnd;
+    NSTimeInterval focusStart = start, focusEnd = end;
+    if (self.graphView.zoomScale > 1.01 && self.pendingZoomEnd > self.pendingZoomStart) {
+        focusStart = self.pendingZoomStart;
+        focusEnd = self.pendingZoomEnd;
+    }
+    NSUInteger maxPoints = [self maxPointsForDuration:focusEnd - focusStart];
+
+    if (self.graphEntities.count > 1) {
+        NSMutableArray *dataSeries = [NSMutableArray array];
+        for (NSDictionary *info in self.graphEntities) {
+            HAHistoryPyramid *pyramid = [self pyramidForEntityId:info[@"entityId"]];
+            NSArray *points = [pyramid pointsFromTime:start toTime:end focusStart:focusStart focusEnd:focusEnd maxPoints:maxPoints];
+            if (points.count == 0) continue;
+            [dataSeries addObject:@{
+                @"points": points,
+                @"color": info[@"color"],
+                @"label": info[@"label"],
+                @"unit": info[@"unit"] ?: @"",
+            }];
+        }
+        if (dataSeries.count > 0) {
+            self.graphView.dataSeries = dataSeries;
+        }
+        return;
+    }
+
+    HAHistoryPyramid *pyramid = [self pyramidForEntityId:self.entity.entityId];
+    NSArray *points = [pyramid pointsFromTime:start toTime:end focusStart:focusStart focusEnd:focusEnd maxPoints:maxPoints];
+    if (points.count > 0) {
+        self.graphView.dataPoints = points;
+    }
+}
+
 - (void)historySegmentChanged:(UISegmentedControl *)sender {
     if (sender.selectedSegmentIndex == 4) {
         [self showDateRangePicker];
@@ -802,103 +918,53 @@ static const CGFloat kGraphHeight = 160.0;
     [self loadHistory];
 }
 
-#pragma mark - Zoom Re-fetch (HAGraphViewDelegate)
+#pragma mark - Zoom (HAGraphViewDelegate)
 
 - (void)graphView:(HAGraphView *)graphView didZoomToStartTime:(NSTimeInterval)startTime endTime:(NSTimeInterval)endTime {
     [self.zoomFetchTimer invalidate];
     self.pendingZoomStart = startTime;
     self.pendingZoomEnd = endTime;
+
+    // Numeric: redraw at the new level of detail from memory right away;
+    // the network is only consulted for spans the pyramids don't hold.
+    if (![self isStateBasedEntity]) {
+        [self renderNumericHistory];
+    }
     self.zoomFetchTimer = [NSTimer scheduledTimerWithTimeInterval:0.3 target:self selector:@selector(fetchZoomedHistory) userInfo:nil repeats:NO];
 }
 
 - (void)fetchZoomedHistory {
-    NSTimeInterval duration = self.pendingZoomEnd - self.pendingZoomStart;
-    NSUInteger maxPoints;
-    if (duration < 1800)       maxPoints = 300;
-    else if (duration < 7200)  maxPoints = 250;
-    else if (duration < 21600) maxPoints = 200;
-    else                       maxPoints = 100;
-    NSUInteger deviceMax = [HAGraphView maxPointsForDevice];
-    if (maxPoints > deviceMax) maxPoints = deviceMax;
+    if (![self isStateBasedEntity]) {
+        NSTimeInterval start = MAX(self.pendingZoomStart, self.historyRangeStart);
+        NSTimeInterval end = MIN(self.pendingZoomEnd, self.historyRangeEnd);
+        if (end <= start) return;
+        for (NSString *entityId in [self numericEntityIds]) {
+            HAHistoryPyramid *pyramid = [self pyramidForEntityId:entityId];
+            if (!pyramid || ![pyramid coversFromTime:start toTime:end]) {
+                [self ensureNumericHistoryFromTime:start toTime:end];
+                return;
+            }
+        }
+        return;
+    }
 
+    // Timelines are still refetched for the zoomed range (single entity only;
+    // multi-entity timelines keep their full-range segments)
+    if (self.graphEntities.count > 1) return;
     NSDate *start = [NSDate dateWithTimeIntervalSince1970:self.pendingZoomStart];
     NSDate *end = [NSDate dateWithTimeIntervalSince1970:self.pendingZoomEnd];
     __weak typeof(self) weakSelf = self;
-
-    // Multi-entity zoom refetch
-    if (self.graphEntities.count > 1) {
-        NSArray *graphEntities = [self.graphEntities copy];
-        HAHistoryManager *mgr = [HAHistoryManager sharedManager];
-        NSMutableArray *results = [NSMutableArray arrayWithCapacity:graphEntities.count];
-        for (NSUInteger i = 0; i < graphEntities.count; i++) {
-            [results addObject:[NSNull null]];
-        }
-
-        dispatch_group_t group = dispatch_group_create();
-        for (NSUInteger i = 0; i < graphEntities.count; i++) {
-            NSString *entityId = graphEntities[i][@"entityId"];
-            NSUInteger capturedIndex = i;
-            dispatch_group_enter(group);
-            [mgr fetchHistoryForEntityId:entityId startDate:start endDate:end maxPoints:maxPoints completion:^(NSArray *points, NSError *error) {
-                if (points.count > 0) {
-                    @synchronized(results) { results[capturedIndex] = points; }
-                }
-                dispatch_group_leave(group);
-            }];
-        }
-
-        dispatch_group_notify(group, dispatch_get_main_queue(), ^{
+    [[HAHistoryManager sharedManager] fetchTimelineForEntityId:self.entity.entityId
+                                                    startDate:start
+                                                      endDate:end
+                                                   completion:^(NSArray *segments, NSError *error) {
+        dispatch_async(dispatch_get_main_queue(), ^{
             __strong typeof(weakSelf) strongSelf = weakSelf;
-            if (!strongSelf) return;
-            NSMutableArray *dataSeries = [NSMutableArray array];
-            for (NSUInteger i = 0; i < graphEntities.count; i++) {
-                NSArray *points = results[i];
-                if (![points isKindOfClass:[NSArray class]] || points.count == 0) continue;
-                NSDictionary *info = graphEntities[i];
-                [dataSeries addObject:@{
-                    @"points": points,
-                    @"color": info[@"color"],
-                    @"label": info[@"label"],
-                    @"unit": info[@"unit"] ?: @"",
-                }];
-            }
-            if (dataSeries.count > 0) {
-                strongSelf.graphView.dataSeries = dataSeries;
-                strongSelf.graphView.visibleStartTime = strongSelf.pendingZoomStart;
-                strongSelf.graphView.visibleEndTime = strongSelf.pendingZoomEnd;
-            }
+            if (!strongSelf || !segments.count) return;
+            NSArray *wrapped = @[@{@"segments": segments, @"label": strongSelf.entity.friendlyName ?: @"", @"entityId": strongSelf.entity.entityId}];
+            strongSelf.graphView.timelineData = wrapped;
         });
-        return;
-    }
-
-    // Single-entity zoom
-    if ([self isStateBasedEntity]) {
-        [[HAHistoryManager sharedManager] fetchTimelineForEntityId:self.entity.entityId
-                                                        startDate:start
-                                                          endDate:end
-                                                       completion:^(NSArray *segments, NSError *error) {
-            dispatch_async(dispatch_get_main_queue(), ^{
-                __strong typeof(weakSelf) strongSelf = weakSelf;
-                if (!strongSelf || !segments.count) return;
-                NSArray *wrapped = @[@{@"segments": segments, @"label": strongSelf.entity.friendlyName ?: @"", @"entityId": strongSelf.entity.entityId}];
-                strongSelf.graphView.timelineData = wrapped;
-            });
-        }];
-    } else {
-        [[HAHistoryManager sharedManager] fetchHistoryForEntityId:self.entity.entityId
-                                                       startDate:start
-                                                         endDate:end
-                                                       maxPoints:maxPoints
-                                                      completion:^(NSArray *points, NSError *error) {
-            dispatch_async(dispatch_get_main_queue(), ^{
-                __strong typeof(weakSelf) strongSelf = weakSelf;
-                if (!strongSelf || !points) return;
-                strongSelf.graphView.dataPoints = points;
-                strongSelf.graphView.visibleStartTime = strongSelf.pendingZoomStart;
-                strongSelf.graphView.visibleEndTime = strongSelf.pendingZoomEnd;
-            });
-        }];
-    }
+    }];
 }
 
 #pragma mark - Header Update
@@ -945,7 +1011,7 @@ static const CGFloat kGraphHeight = 160.0;
     if (self.domainSection) {
         [self.domainSection updateWithEntity:updated];
     }
-    [self rebuildAttributes];
+    [self updateAttributes];
 }
 
 @end
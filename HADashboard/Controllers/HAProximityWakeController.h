@@ -4,6 +4,16 @@
 /// HAProximityWakeController observes this to reset the idle timer.
 extern NSString *const HAWindowUserDidInteractNotification;
 
+/// Posted once the screen has finished dimming to black. Observers enter
+/// deep idle: pause streams, timers and animations, buffer updates.
+extern NSString *const HAProximityWakeControllerDidDimNotification;
+
+/// Posted when a dimmed screen starts waking (touch, wakeScreen, stop or app
+/// resign), before the overlay fades, so observers can refresh under it.
+extern NSString *const HAProximityWakeControllerWillWakeNotification;
+
+@class HAEntity;
+
 /// Implements fake-sleep/wake for kiosk mode.
 ///
 /// When started, a 60-second idle timer runs. If no touch occurs before it
@@ -21,4 +31,21 @@ extern NSString *const HAWindowUserDidInteractNotification;
 /// Stops the idle timer and immediately restores the screen if sleeping.
 - (void)stop;
 
+/// Wake a dimmed screen as a touch would. No-op if not dimmed.
+- (void)wakeScreen;
+
+@property (nonatomic, readonly, getter=isSleeping) BOOL sleeping;
+
+/// Entities worth keeping live while dimmed because a change to them should
+/// wake the screen: alarm panels, locks, event entities (doorbells, buttons)
+/// and presence / opening / safety binary sensors.
++ (BOOL)isWakeRelevantEntity:(HAEntity *)entity;
+
+/// YES if this (already applied) state of a wake-relevant entity should wake
+/// the screen. Binary sensors wake only when they turn on; locks and alarm
+/// panels only on states that need attention (unlocked, jammed, open,
+/// pending, arming, triggered), so locking or disarming stays dark. Every
+/// event entity state is a new firing and wakes.
++ (BOOL)entityStateShouldWakeScreen:(HAEntity *)entity;
+
 @end
@@ -1,6 +1,9 @@
 #import "HAProximityWakeController.h"
+#import "HAEntity.h"
 
 NSString *const HAWindowUserDidInteractNotification = @"HAWindowUserDidInteractNotification";
+NSString *const HAProximityWakeControllerDidDimNotification = @"HAProximityWakeControllerDidDimNotification";
+NSString *const HAProximityWakeControllerWillWakeNotification = @"HAProximityWakeControllerWillWakeNotification";
 
 /// Seconds of inactivity before the screen dims.
 static const NSTimeInterval kDimDelay = 60.0;
@@ -47,6 +50,48 @@ static const NSTimeInterval kWakeDuration = 0.35;
     [self wakeImmediately];
 }
 
+- (void)wakeScreen {
+    [self wake];
+}
+
+#pragma mark - Wake entities
+
++ (BOOL)isWakeRelevantEntity:(HAEntity *)entity {
+    NSString *domain = [entity domain];
+    if ([domain isEqualToString:HAEntityDomainAlarmControlPanel] ||
+        [domain isEqualToString:HAEntityDomainLock] ||
+        [domain isEqualToString:@"event"]) {
+        return YES;
+    }
+    if (![domain isEqualToString:HAEntityDomainBinarySensor]) return NO;
+
+    static NSSet<NSString *> *wakeClasses;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        wakeClasses = [NSSet setWithObjects:@"motion", @"occupancy", @"presence", @"door",
+                       @"garage_door", @"smoke", @"gas", @"carbon_monoxide", @"moisture", @"safety", nil];
+    });
+    NSString *deviceClass = [entity deviceClass];
+    return deviceClass && [wakeClasses containsObject:deviceClass];
+}
+
++ (BOOL)entityStateShouldWakeScreen:(HAEntity *)entity {
+    if (![self isWakeRelevantEntity:entity] || ![entity isAvailable]) return NO;
+    NSString *domain = [entity domain];
+    if ([domain isEqualToString:HAEntityDomainBinarySensor]) {
+        return [entity.state isEqualToString:@"on"];
+    }
+    if ([domain isEqualToString:@"event"]) return YES;
+
+    static NSSet<NSString *> *attentionStates;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        attentionStates = [NSSet setWithObjects:@"unlocked", @"jammed", @"open",
+                           @"pending", @"arming", @"triggered", nil];
+    });
+    return entity.state && [attentionStates containsObject:entity.state];
+}
+
 #pragma mark - Idle timer
 
 - (void)scheduleIdleTimer {
@@ -98,12 +143,19 @@ static const NSTimeInterval kWakeDuration = 0.35;
                      animations:^{
         overlay.alpha = 1.0;
         [UIScreen mainScreen].brightness = 0.0;
-    } completion:nil];
+    } completion:^(BOOL finished) {
+        // A touch during the fade cancels it; only a fully dark screen idles
+        if (!finished || !self.sleeping || self.sleepOverlay != overlay) return;
+        [[NSNotificationCenter defaultCenter]
+            postNotificationName:HAProximityWakeControllerDidDimNotification object:self];
+    }];
 }
 
 - (void)wake {
     if (!self.sleeping) return;
     self.sleeping = NO;
+    [[NSNotificationCenter defaultCenter]
+        postNotificationName:HAProximityWakeControllerWillWakeNotification object:self];
 
     // Restore brightness immediately so the first thing the user sees is the
     // screen coming back on, not a black frame while the overlay fades.
@@ -126,6 +178,8 @@ static const NSTimeInterval kWakeDuration = 0.35;
 - (void)wakeImmediately {
     if (!self.sleeping) return;
     self.sleeping = NO;
+    [[NSNotificationCenter defaultCenter]
+        postNotificationName:HAProximityWakeControllerWillWakeNotification object:self];
     [UIScreen mainScreen].brightness = self.savedBrightness;
     [self.sleepOverlay.layer removeAllAnimations];
     [self.sleepOverlay removeFromSuperview];
@@ -14,6 +14,8 @@
 #import "HACacheManager.h"
 #import "HAEntityStateCache.h"
 #import "HAHistoryManager.h"
+#import "HAStatisticsManager.h"
+#import "HAWeatherForecastStore.h"
 
 
 // NSUserDefaults keys for device integration
@@ -921,6 +923,18 @@ static NSString *const kDeviceNameOverride    = @"ha_device_name_override";
 }
 
 - (void)exportLogsTapped {
+    HAPerfMonitor *perf = [HAPerfMonitor sharedMonitor];
+    if (perf.isRunning) {
+        // Include a trace of the current session alongside the logs
+        [perf writeTraceWithCompletion:^(NSString *tracePath) {
+            [self presentLogExportIncludingTrace:tracePath];
+        }];
+    } else {
+        [self presentLogExportIncludingTrace:nil];
+    }
+}
+
+- (void)presentLogExportIncludingTrace:(NSString *)tracePath {
     [HALog flush];
 
     NSMutableArray *items = [NSMutableArray array];
@@ -932,6 +946,9 @@ static NSString *const kDeviceNameOverride    = @"ha_device_name_override";
     if (previous && [[NSFileManager defaultManager] fileExistsAtPath:previous]) {
         [items addObject:[NSURL fileURLWithPath:previous]];
     }
+    if (tracePath) {
+        [items addObject:[NSURL fileURLWithPath:tracePath]];
+    }
 
     if (items.count == 0) return;
 
@@ -967,6 +984,8 @@ static NSString *const kDeviceNameOverride    = @"ha_device_name_override";
 
         // Clear in-memory caches
         [[HAHistoryManager sharedManager] clearCache];
+        [[HAStatisticsManager sharedManager] clearCache];
+        [[HAWeatherForecastStore sharedStore] reset];
 
         // Disconnect and clear in-memory entity store
         HAConnectionManager *conn = [HAConnectionManager sharedManager];
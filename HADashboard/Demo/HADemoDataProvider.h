@@ -2,6 +2,8 @@
 
 @class HAEntity;
 @class HALovelaceDashboard;
+@class HADemoLoadGenerator;
+@class HADemoLoadProfile;
 
 /// Provides demo entities, dashboard config, and fake history data for Demo Mode.
 /// Used when app runs without a live Home Assistant connection to demonstrate
@@ -44,17 +46,30 @@
 
 /// Start periodically updating entities to simulate a live system.
 /// Sensors will fluctuate, binary sensors will occasionally toggle.
+/// In stress mode, starts the load generator's state_changed stream instead.
 - (void)startSimulation;
 
-/// Stop the simulation timer.
+/// Stop the simulation timer (or the load generator's stream).
 - (void)stopSimulation;
 
 /// Whether simulation is currently running.
 @property (nonatomic, readonly, getter=isSimulating) BOOL simulating;
 
+#pragma mark - Stress Mode
+
+/// Replace the demo entities and dashboards with a synthetic set built from
+/// profile (a single "demo-stress" dashboard). Once the connection manager
+/// has loaded the data, startSimulation streams state changes through
+/// -[HAConnectionManager injectWebSocketMessage:], the same path as real
+/// state_changed events.
+- (void)loadStressDataWithProfile:(HADemoLoadProfile *)profile;
+
+/// Generator for the current stress run, nil in normal demo mode.
+@property (nonatomic, strong, readonly) HADemoLoadGenerator *loadGenerator;
+
 #pragma mark - Data Reload
 
-/// Reload demo data (resets all entities to initial state).
+/// Reload demo data (resets all entities to initial state, leaves stress mode).
 - (void)reloadDemoData;
 
 @end
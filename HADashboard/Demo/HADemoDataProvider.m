@@ -3,6 +3,7 @@
 #import "HAEntity.h"
 #import "HALovelaceParser.h"
 #import "HAConnectionManager.h"
+#import "HADemoLoadGenerator.h"
 
 @interface HADemoDataProvider ()
 @property (nonatomic, strong) NSMutableDictionary<NSString *, HAEntity *> *entityStore;
@@ -11,6 +12,7 @@
 @property (nonatomic, strong) NSDictionary<NSString *, HALovelaceDashboard *> *dashboards;
 @property (nonatomic, strong) NSTimer *simulationTimer;
 @property (nonatomic, assign, getter=isSimulating) BOOL simulating;
+@property (nonatomic, strong, readwrite) HADemoLoadGenerator *loadGenerator;
 @end
 
 @implementation HADemoDataProvider
@@ -54,9 +56,32 @@
 
 - (void)reloadDemoData {
     [self stopSimulation];
+    self.loadGenerator = nil;
     [self loadDemoData];
 }
 
+#pragma mark - Stress Mode
+
+- (void)loadStressDataWithProfile:(HADemoLoadProfile *)profile {
+    [self stopSimulation];
+    HADemoLoadGenerator *generator = [[HADemoLoadGenerator alloc] initWithProfile:profile];
+    self.loadGenerator = generator;
+
+    NSDictionary<NSString *, NSDictionary *> *states = [generator initialStates];
+    NSMutableDictionary *store = [NSMutableDictionary dictionaryWithCapacity:states.count];
+    [states enumerateKeysAndObjectsUsingBlock:^(NSString *entityId, NSDictionary *state, BOOL *stop) {
+        store[entityId] = [[HAEntity alloc] initWithDictionary:state];
+    }];
+    _entityStore = store;
+
+    HALovelaceDashboard *dashboard = [[HALovelaceDashboard alloc] initWithDictionary:[generator lovelaceConfig]];
+    _dashboards = @{@"demo-stress": dashboard};
+    _demoDashboard = dashboard;
+    _availableDashboards = @[@{@"title": @"Stress", @"url_path": @"demo-stress"}];
+
+    HALogI(@"demo", @"Loaded stress data: %@", profile);
+}
+
 #pragma mark - Entity Creation Helper
 
 - (HAEntity *)addEntityWithId:(NSString *)entityId
@@ -1454,7 +1479,7 @@
 
 - (HALovelaceDashboard *)dashboardForPath:(NSString *)urlPath {
     HALovelaceDashboard *dash = _dashboards[urlPath];
-    return dash ?: _dashboards[@"demo-home"];
+    return dash ?: _demoDashboard;
 }
 
 #pragma mark - Dashboard Builders
@@ -2177,6 +2202,13 @@
 
     _simulating = YES;
 
+    if (self.loadGenerator) {
+        [self.loadGenerator startWithMessageHandler:^(NSDictionary *message) {
+            [[HAConnectionManager sharedManager] injectWebSocketMessage:message];
+        }];
+        return;
+    }
+
     // Update entities every 15 seconds (use target/selector API for iOS 9 compatibility)
     _simulationTimer = [NSTimer scheduledTimerWithTimeInterval:15.0
                                                         target:self
@@ -2192,6 +2224,7 @@
 
     [_simulationTimer invalidate];
     _simulationTimer = nil;
+    [self.loadGenerator stop];
     _simulating = NO;
 
     HALogI(@"demo", @"Stopped state simulation");
@@ -0,0 +1,70 @@
+#import <Foundation/Foundation.h>
+
+/// How the state-change rate varies over time.
+typedef NS_ENUM(NSInteger, HADemoLoadBurstProfile) {
+    HADemoLoadBurstProfileSteady = 0,   // constant updatesPerSecond
+    HADemoLoadBurstProfilePeriodic,     // burstMultiplier x rate for burstDuration every burstPeriod
+    HADemoLoadBurstProfileRandom,       // bursts start at random, on average once per burstPeriod
+};
+
+/// Shape of a synthetic load run: how big the dashboard and entity set are
+/// and how fast entities change.
+@interface HADemoLoadProfile : NSObject
+
+@property (nonatomic, assign) NSUInteger entityCount;      // K synthetic entities
+@property (nonatomic, assign) NSUInteger viewCount;        // N dashboard views
+@property (nonatomic, assign) NSUInteger cardsPerView;     // M cards per view, mixed types
+@property (nonatomic, assign) double updatesPerSecond;     // base state_changed rate
+@property (nonatomic, assign) HADemoLoadBurstProfile burstProfile;
+@property (nonatomic, assign) double burstMultiplier;      // rate factor while bursting
+@property (nonatomic, assign) NSTimeInterval burstPeriod;
+@property (nonatomic, assign) NSTimeInterval burstDuration;
+@property (nonatomic, assign) uint32_t seed;               // same seed, same run
+
+/// 500 entities, 3 views x 30 cards, 50 updates/s steady.
++ (instancetype)defaultProfile;
+
+/// Profile from NSUserDefaults (so launch arguments work), or nil unless
+/// HADemoStressEntities > 0. Keys: HADemoStressEntities, HADemoStressViews,
+/// HADemoStressCards, HADemoStressRate, HADemoStressBurst (steady/periodic/random),
+/// HADemoStressBurstMultiplier, HADemoStressBurstPeriod, HADemoStressBurstDuration,
+/// HADemoStressSeed. e.g. -HADemoStressEntities 2000 -HADemoStressRate 200
++ (instancetype)profileFromUserDefaults;
+
+@end
+
+/// Generates a synthetic Home Assistant: entity states, a Lovelace config,
+/// and a stream of state_changed WebSocket messages at the profile's rate.
+///
+/// Messages are built on a background queue and delivered one per main-queue
+/// block, the same way HAWebSocketClient delivers real ones, so everything
+/// downstream of the socket sees realistic load. Output is deterministic for
+/// a given profile seed.
+@interface HADemoLoadGenerator : NSObject
+
+- (instancetype)initWithProfile:(HADemoLoadProfile *)profile;
+
+@property (nonatomic, strong, readonly) HADemoLoadProfile *profile;
+
+/// Initial states in /api/states format, keyed by entity_id.
+- (NSDictionary<NSString *, NSDictionary *> *)initialStates;
+
+/// Raw Lovelace config (@"title", @"views") using the synthetic entities.
+- (NSDictionary *)lovelaceConfig;
+
+/// Start streaming. messageHandler is called on the main queue with each
+/// state_changed event message.
+- (void)startWithMessageHandler:(void (^)(NSDictionary *message))messageHandler;
+- (void)stop;
+
+@property (nonatomic, readonly, getter=isRunning) BOOL running;
+
+/// Messages delivered since start.
+@property (nonatomic, readonly) NSUInteger deliveredCount;
+
+/// Next state_changed message, advancing the generator's state. Exposed for
+/// tests and for callers driving their own clock. Not thread-safe against a
+/// running stream.
+- (NSDictionary *)nextStateChangedMessage;
+
+@end
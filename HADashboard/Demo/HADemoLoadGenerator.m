@@ -0,0 +1,496 @@
+#import "HADemoLoadGenerator.h"
+#import "HALog.h"
+#import "HAPerfMonitor.h"
+#include <stdatomic.h>
+
+// Generator tick; the per-tick message count carries its fractional part
+static const NSTimeInterval kLoadTickInterval = 0.05;
+
+// Stop generating when this many seconds of messages are queued on main
+static const double kLoadMaxBacklogSeconds = 5.0;
+
+typedef NS_ENUM(uint8_t, HADemoLoadKind) {
+    HADemoLoadKindSensor = 0,
+    HADemoLoadKindBinarySensor,
+    HADemoLoadKindLight,
+    HADemoLoadKindSwitch,
+    HADemoLoadKindClimate,
+};
+
+/// Domain mix, repeating every 20 entities: 10 sensors, 4 binary sensors,
+/// 3 lights, 2 switches, 1 climate.
+static HADemoLoadKind HADemoLoadKindForIndex(NSUInteger i) {
+    NSUInteger slot = i % 20;
+    if (slot < 10) return HADemoLoadKindSensor;
+    if (slot < 14) return HADemoLoadKindBinarySensor;
+    if (slot < 17) return HADemoLoadKindLight;
+    if (slot < 19) return HADemoLoadKindSwitch;
+    return HADemoLoadKindClimate;
+}
+
+#pragma mark - Profile
+
+@implementation HADemoLoadProfile
+
++ (instancetype)defaultProfile {
+    HADemoLoadProfile *profile = [[HADemoLoadProfile alloc] init];
+    profile.entityCount = 500;
+    profile.viewCount = 3;
+    profile.cardsPerView = 30;
+    profile.updatesPerSecond = 50;
+    profile.burstProfile = HADemoLoadBurstProfileSteady;
+    profile.burstMultiplier = 5;
+    profile.burstPeriod = 30;
+    profile.burstDuration = 3;
+    profile.seed = 1;
+    return profile;
+}
+
++ (instancetype)profileFromUserDefaults {
+    NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+    NSInteger entities = [defaults integerForKey:@"HADemoStressEntities"];
+    if (entities <= 0) return nil;
+
+    HADemoLoadProfile *profile = [self defaultProfile];
+    profile.entityCount = (NSUInteger)entities;
+    if ([defaults integerForKey:@"HADemoStressViews"] > 0) {
+        profile.viewCount = (NSUInteger)[defaults integerForKey:@"HADemoStressViews"];
+    }
+    if ([defaults integerForKey:@"HADemoStressCards"] > 0) {
+        profile.cardsPerView = (NSUInteger)[defaults integerForKey:@"HADemoStressCards"];
+    }
+    if ([defaults objectForKey:@"HADemoStressRate"]) {
+        profile.updatesPerSecond = MAX(0, [defaults doubleForKey:@"HADemoStressRate"]);
+    }
+    NSString *burst = [defaults stringForKey:@"HADemoStressBurst"];
+    if ([burst isEqualToString:@"periodic"]) profile.burstProfile = HADemoLoadBurstProfilePeriodic;
+    else if ([burst isEqualToString:@"random"]) profile.burstProfile = HADemoLoadBurstProfileRandom;
+    if ([defaults doubleForKey:@"HADemoStressBurstMultiplier"] > 0) {
+        profile.burstMultiplier = [defaults doubleForKey:@"HADemoStressBurstMultiplier"];
+    }
+    if ([defaults doubleForKey:@"HADemoStressBurstPeriod"] > 0) {
+        profile.burstPeriod = [defaults doubleForKey:@"HADemoStressBurstPeriod"];
+    }
+    if ([defaults doubleForKey:@"HADemoStressBurstDuration"] > 0) {
+        profile.burstDuration = [defaults doubleForKey:@"HADemoStressBurstDuration"];
+    }
+    if ([defaults objectForKey:@"HADemoStressSeed"]) {
+        profile.seed = (uint32_t)[defaults integerForKey:@"HADemoStressSeed"];
+    }
+    return profile;
+}
+
+- (NSString *)description {
+    static NSString *const burstNames[] = { @"steady", @"periodic", @"random" };
+    return [NSString stringWithFormat:@"%lu entities, %lu views x %lu cards, %.0f/s %@",
+        (unsigned long)self.entityCount, (unsigned long)self.viewCount, (unsigned long)self.cardsPerView,
+        self.updatesPerSecond, burstNames[MIN(MAX(self.burstProfile, 0), 2)]];
+}
+
+@end
+
+#pragma mark - Generator
+
+@interface HADemoLoadGenerator ()
+@property (nonatomic, strong, readwrite) HADemoLoadProfile *profile;
+@property (nonatomic, copy) NSArray<NSString *> *entityIds;
+@property (nonatomic, copy) NSArray<NSDictionary *> *attributes;        // per entity, immutable
+@property (nonatomic, strong) NSMutableArray<NSDictionary *> *lastStates; // generator queue only
+@property (nonatomic, strong) NSDateFormatter *timestampFormatter;     // generator queue only
+@property (nonatomic, strong) dispatch_queue_t queue;
+@property (nonatomic, strong) dispatch_source_t timer;
+@property (nonatomic, copy) void (^messageHandler)(NSDictionary *message);
+@property (nonatomic, readwrite, getter=isRunning) BOOL running;
+@property (nonatomic, readwrite) NSUInteger deliveredCount;
+@end
+
+@implementation HADemoLoadGenerator {
+    double *_values;        // sensor value / climate current temp / light brightness
+    uint8_t *_on;           // binary sensor / light / switch state
+    uint32_t _rng;
+
+    // Stream state (generator queue only)
+    CFAbsoluteTime _startTime;
+    CFAbsoluteTime _lastTick;
+    double _carry;
+    BOOL _bursting;
+    CFAbsoluteTime _burstEnd;
+    atomic_long _inFlight;
+    NSUInteger _skippedTicks;
+}
+
+- (instancetype)initWithProfile:(HADemoLoadProfile *)profile {
+    self = [super init];
+    if (self) {
+        _profile = profile;
+        _queue = dispatch_queue_create("com.hadashboard.demo.load", DISPATCH_QUEUE_SERIAL);
+        _rng = profile.seed ?: 1;
+        [self buildEntities];
+
+        _timestampFormatter = [[NSDateFormatter alloc] init];
+        _timestampFormatter.locale = [NSLocale localeWithLocaleIdentifier:@"en_US_POSIX"];
+        _timestampFormatter.timeZone = [NSTimeZone timeZoneWithAbbreviation:@"UTC"];
+        _timestampFormatter.dateFormat = @"yyyy-MM-dd'T'HH:mm:ss.SSSSSS'+00:00'";
+    }
+    return self;
+}
+
+- (void)dealloc {
+    if (_timer) dispatch_source_cancel(_timer);
+    free(_values);
+    free(_on);
+}
+
+/// xorshift32: cheap and reproducible from the profile seed.
+- (uint32_t)nextRandom {
+    uint32_t x = _rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    _rng = x;
+    return x;
+}
+
+/// Uniform in [0, 1).
+- (double)nextUnit {
+    return (double)[self nextRandom] / 4294967296.0;
+}
+
+#pragma mark - Entities
+
+- (void)buildEntities {
+    NSUInteger count = self.profile.entityCount;
+    _values = calloc(MAX(count, 1), sizeof(double));
+    _on = calloc(MAX(count, 1), sizeof(uint8_t));
+
+    static NSString *const sensorUnits[] = { @"°C", @"%", @"W", @"lx", @"ppm" };
+    static NSString *const sensorClasses[] = { @"temperature", @"humidity", @"power", @"illuminance", @"carbon_dioxide" };
+    static const double sensorBase[] = { 21, 45, 350, 300, 600 };
+    static NSString *const binaryClasses[] = { @"motion", @"door", @"window", @"occupancy" };
+
+    NSUInteger digits = MAX(4, (NSUInteger)floor(log10(MAX(count, 1))) + 1);
+    NSMutableArray *ids = [NSMutableArray arrayWithCapacity:count];
+    NSMutableArray *attrs = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        HADemoLoadKind kind = HADemoLoadKindForIndex(i);
+        NSString *suffix = [NSString stringWithFormat:@"stress_%0*lu", (int)digits, (unsigned long)i];
+        NSString *name = [NSString stringWithFormat:@"Stress %lu", (unsigned long)i];
+        switch (kind) {
+            case HADemoLoadKindSensor: {
+                NSUInteger v = i % 5;
+                [ids addObject:[@"sensor." stringByAppendingString:suffix]];
+                [attrs addObject:@{@"friendly_name": name,
+                                   @"unit_of_measurement": sensorUnits[v],
+                                   @"device_class": sensorClasses[v],
+                                   @"state_class": @"measurement"}];
+                _values[i] = sensorBase[v] * (0.8 + 0.4 * [self nextUnit]);
+                break;
+            }
+            case HADemoLoadKindBinarySensor:
+                [ids addObject:[@"binary_sensor." stringByAppendingString:suffix]];
+                [attrs addObject:@{@"friendly_name": name, @"device_class": binaryClasses[i % 4]}];
+                _on[i] = [self nextRandom] % 4 == 0;
+                break;
+            case HADemoLoadKindLight:
+                [ids addObject:[@"light." stringByAppendingString:suffix]];
+                [attrs addObject:@{@"friendly_name": name,
+                                   @"supported_color_modes": @[@"brightness"],
+                                   @"color_mode": @"brightness"}];
+                _on[i] = [self nextRandom] % 2;
+                _values[i] = 50 + [self nextRandom] % 200;
+                break;
+            case HADemoLoadKindSwitch:
+                [ids addObject:[@"switch." stringByAppendingString:suffix]];
+                [attrs addObject:@{@"friendly_name": name}];
+                _on[i] = [self nextRandom] % 2;
+                break;
+            case HADemoLoadKindClimate:
+                [ids addObject:[@"climate." stringByAppendingString:suffix]];
+                [attrs addObject:@{@"friendly_name": name,
+                                   @"hvac_modes": @[@"off", @"heat", @"cool", @"auto"],
+                                   @"min_temp": @7, @"max_temp": @35,
+                                   @"temperature": @21,
+                                   @"supported_features": @387}];
+                _values[i] = 19 + 4 * [self nextUnit];
+                break;
+        }
+    }
+    _entityIds = [ids copy];
+    _attributes = [attrs copy];
+}
+
+/// Current state dict for entity i in /api/states format.
+- (NSDictionary *)stateForIndex:(NSUInteger)i timestamp:(NSString *)timestamp {
+    NSString *state;
+    NSDictionary *attributes = self.attributes[i];
+    switch (HADemoLoadKindForIndex(i)) {
+        case HADemoLoadKindSensor:
+            state = [NSString stringWithFormat:@"%.1f", _values[i]];
+            break;
+        case HADemoLoadKindBinarySensor:
+        case HADemoLoadKindSwitch:
+            state = _on[i] ? @"on" : @"off";
+            break;
+        case HADemoLoadKindLight: {
+            state = _on[i] ? @"on" : @"off";
+            if (_on[i]) {
+                NSMutableDictionary *a = [attributes mutableCopy];
+                a[@"brightness"] = @((NSInteger)_values[i]);
+                attributes = a;
+            }
+            break;
+        }
+        case HADemoLoadKindClimate: {
+            state = @"heat";
+            NSMutableDictionary *a = [attributes mutableCopy];
+            a[@"current_temperature"] = @(round(_values[i] * 10) / 10);
+            attributes = a;
+            break;
+        }
+    }
+    return @{@"entity_id": self.entityIds[i],
+             @"state": state,
+             @"attributes": attributes,
+             @"last_changed": timestamp,
+             @"last_updated": timestamp};
+}
+
+- (NSDictionary<NSString *, NSDictionary *> *)initialStates {
+    __block NSDictionary *result = nil;
+    dispatch_sync(self.queue, ^{
+        NSString *now = [self.timestampFormatter stringFromDate:[NSDate date]];
+        NSMutableDictionary *states = [NSMutableDictionary dictionaryWithCapacity:self.entityIds.count];
+        self.lastStates = [NSMutableArray arrayWithCapacity:self.entityIds.count];
+        for (NSUInteger i = 0; i < self.entityIds.count; i++) {
+            NSDictionary *state = [self stateForIndex:i timestamp:now];
+            states[self.entityIds[i]] = state;
+            [self.lastStates addObject:state];
+        }
+        result = [states copy];
+    });
+    return result;
+}
+
+#pragma mark - Dashboard
+
+- (NSDictionary *)lovelaceConfig {
+    NSMutableArray<NSNumber *> *sensors = [NSMutableArray array];
+    NSMutableArray<NSNumber *> *toggles = [NSMutableArray array];
+    NSMutableArray<NSNumber *> *climates = [NSMutableArray array];
+    for (NSUInteger i = 0; i < self.entityIds.count; i++) {
+        switch (HADemoLoadKindForIndex(i)) {
+            case HADemoLoadKindSensor: [sensors addObject:@(i)]; break;
+            case HADemoLoadKindClimate: [climates addObject:@(i)]; break;
+            default: [toggles addObject:@(i)]; break;
+        }
+    }
+
+    // Cursors walk each pool so cards spread over the whole entity set
+    __block NSUInteger cursor = 0;
+    NSString *(^pick)(NSArray<NSNumber *> *) = ^NSString *(NSArray<NSNumber *> *pool) {
+        if (pool.count == 0) pool = sensors.count > 0 ? sensors : toggles;
+        if (pool.count == 0) return nil;
+        return self.entityIds[pool[cursor++ % pool.count].unsignedIntegerValue];
+    };
+    NSArray *(^pickRows)(NSUInteger) = ^NSArray *(NSUInteger n) {
+        NSMutableArray *rows = [NSMutableArray arrayWithCapacity:n];
+        for (NSUInteger k = 0; k < n; k++) {
+            NSString *eid = pick(k % 2 ? toggles : sensors);
+            if (eid) [rows addObject:@{@"entity": eid}];
+        }
+        return rows;
+    };
+
+    NSMutableArray *views = [NSMutableArray arrayWithCapacity:self.profile.viewCount];
+    for (NSUInteger v = 0; v < self.profile.viewCount; v++) {
+        NSMutableArray *cards = [NSMutableArray arrayWithCapacity:self.profile.cardsPerView];
+        for (NSUInteger c = 0; c < self.profile.cardsPerView; c++) {
+            NSDictionary *card = nil;
+            switch (c % 10) {
+                case 0: case 5: case 8:
+                    card = @{@"type": @"tile", @"entity": pick(toggles) ?: @""};
+                    break;
+                case 1:
+                    card = @{@"type": @"tile", @"entity": pick(sensors) ?: @""};
+                    break;
+                case 2: case 7:
+                    card = @{@"type": @"entities", @"title": [NSString stringWithFormat:@"Group %lu", (unsigned long)c],
+                             @"entities": pickRows(5)};
+                    break;
+                case 3:
+                    card = @{@"type": @"gauge", @"entity": pick(sensors) ?: @"", @"min": @0, @"max": @1000};
+                    break;
+                case 4:
+                    card = @{@"type": @"glance", @"entities": pickRows(6)};
+                    break;
+                case 6:
+                    card = @{@"type": @"sensor", @"entity": pick(sensors) ?: @"", @"graph": @"line", @"hours_to_show": @24};
+                    break;
+                case 9:
+                    card = climates.count > 0
+                        ? @{@"type": @"thermostat", @"entity": pick(climates)}
+                        : @{@"type": @"tile", @"entity": pick(toggles) ?: @""};
+                    break;
+            }
+            [cards addObject:card];
+        }
+        [views addObject:@{@"title": [NSString stringWithFormat:@"Stress %lu", (unsigned long)(v + 1)],
+                           @"path": [NSString stringWithFormat:@"stress-%lu", (unsigned long)(v + 1)],
+                           @"cards": cards}];
+    }
+    return @{@"title": @"Stress", @"views": views};
+}
+
+#pragma mark - Stream
+
+- (void)startWithMessageHandler:(void (^)(NSDictionary *message))messageHandler {
+    if (self.running) return;
+    self.running = YES;
+    self.messageHandler = messageHandler;
+    self.deliveredCount = 0;
+    if (!self.lastStates) [self initialStates];
+
+    dispatch_async(self.queue, ^{
+        self->_startTime = CFAbsoluteTimeGetCurrent();
+        self->_lastTick = self->_startTime;
+        self->_carry = 0;
+        self->_bursting = NO;
+        self->_skippedTicks = 0;
+    });
+
+    self.timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, self.queue);
+    uint64_t interval = (uint64_t)(kLoadTickInterval * NSEC_PER_SEC);
+    dispatch_source_set_timer(self.timer, dispatch_time(DISPATCH_TIME_NOW, (int64_t)interval), interval, interval / 10);
+    __weak typeof(self) weakSelf = self;
+    dispatch_source_set_event_handler(self.timer, ^{
+        [weakSelf tick];
+    });
+    dispatch_resume(self.timer);
+
+    HALogI(@"demo", @"Load generator started: %@", self.profile);
+}
+
+- (void)stop {
+    if (!self.running) return;
+    self.running = NO;
+    dispatch_source_cancel(self.timer);
+    self.timer = nil;
+    self.messageHandler = nil;
+    HALogI(@"demo", @"Load generator stopped after %lu messages", (unsigned long)self.deliveredCount);
+}
+
+/// Rate multiplier for the current tick, per the burst profile.
+- (double)burstFactorAt:(CFAbsoluteTime)now dt:(double)dt {
+    HADemoLoadProfile *p = self.profile;
+    BOOL bursting = NO;
+    switch (p.burstProfile) {
+        case HADemoLoadBurstProfileSteady:
+            break;
+        case HADemoLoadBurstProfilePeriodic:
+            bursting = p.burstPeriod > 0 && fmod(now - _startTime, p.burstPeriod) < p.burstDuration;
+            break;
+        case HADemoLoadBurstProfileRandom:
+            if (_bursting && now < _burstEnd) {
+                bursting = YES;
+            } else if (p.burstPeriod > 0 && [self nextUnit] < dt / p.burstPeriod) {
+                _burstEnd = now + p.burstDuration;
+                bursting = YES;
+            }
+            break;
+    }
+    if (bursting != _bursting) {
+        _bursting = bursting;
+        if (bursting) HAPerfInstant(HAPerfCategoryApp, "stress.burst", NULL);
+        HAPerfCounter("stress.rate", p.updatesPerSecond * (bursting ? p.burstMultiplier : 1));
+    }
+    return bursting ? p.burstMultiplier : 1;
+}
+
+- (void)tick {
+    if (!self.running) return;
+    CFAbsoluteTime now = CFAbsoluteTimeGetCurrent();
+    double dt = now - _lastTick;
+    _lastTick = now;
+
+    double rate = self.profile.updatesPerSecond * [self burstFactorAt:now dt:dt];
+    _carry += rate * dt;
+    NSUInteger count = (NSUInteger)_carry;
+    _carry -= count;
+    if (count == 0) return;
+
+    // Don't bury the main queue: if it is this far behind, the device is past
+    // capacity and more messages would only measure queue growth
+    long backlogLimit = (long)MAX(1000.0, self.profile.updatesPerSecond * kLoadMaxBacklogSeconds);
+    if (atomic_load(&_inFlight) > backlogLimit) {
+        if (_skippedTicks++ % 100 == 0) {
+            HALogW(@"demo", @"Main queue %ld messages behind, pausing load", atomic_load(&_inFlight));
+        }
+        return;
+    }
+
+    void (^handler)(NSDictionary *) = self.messageHandler;
+    if (!handler) return;
+    for (NSUInteger n = 0; n < count; n++) {
+        NSDictionary *message = [self nextStateChangedMessage];
+        if (!message) return;
+        atomic_fetch_add(&_inFlight, 1);
+        dispatch_async(dispatch_get_main_queue(), ^{
+            atomic_fetch_sub(&self->_inFlight, 1);
+            if (!self.running) return;
+            self.deliveredCount++;
+            handler(message);
+        });
+    }
+}
+
+- (NSDictionary *)nextStateChangedMessage {
+    NSUInteger count = self.entityIds.count;
+    if (count == 0) return nil;
+    if (!self.lastStates) [self initialStates];
+
+    NSUInteger i = [self nextRandom] % count;
+    switch (HADemoLoadKindForIndex(i)) {
+        case HADemoLoadKindSensor: {
+            // Random walk of up to ±1% per update
+            double step = ([self nextUnit] * 2 - 1) * 0.01 * MAX(fabs(_values[i]), 1);
+            _values[i] += step;
+            break;
+        }
+        case HADemoLoadKindBinarySensor:
+        case HADemoLoadKindSwitch:
+            _on[i] = !_on[i];
+            break;
+        case HADemoLoadKindLight:
+            if ([self nextRandom] % 3 == 0) {
+                _on[i] = !_on[i];
+            } else {
+                _values[i] = 1 + [self nextRandom] % 255;
+            }
+            break;
+        case HADemoLoadKindClimate:
+            _values[i] += ([self nextUnit] * 2 - 1) * 0.1;
+            break;
+    }
+
+    NSString *timestamp = [self.timestampFormatter stringFromDate:[NSDate date]];
+    NSDictionary *newState = [self stateForIndex:i timestamp:timestamp];
+    NSDictionary *oldState = self.lastStates[i];
+    self.lastStates[i] = newState;
+
+    return @{
+        @"id": @0,
+        @"type": @"event",
+        @"event": @{
+            @"event_type": @"state_changed",
+            @"data": @{
+                @"entity_id": self.entityIds[i],
+                @"old_state": oldState,
+                @"new_state": newState,
+            },
+            @"origin": @"LOCAL",
+            @"time_fired": timestamp,
+        },
+    };
+}
+
+@end
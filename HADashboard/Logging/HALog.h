@@ -8,10 +8,18 @@ typedef NS_ENUM(NSInteger, HALogLevel) {
     HALogLevelError,       // Failures: crashes, service errors, parse failures
 };
 
+/// Runs flush (the drain and file sync) inside whatever the caller measures.
+typedef void (^HALogFlushTracer)(dispatch_block_t flush);
+
 /// Unified file logger for HA Dashboard.
 ///
 /// Writes to Documents/ha-log.txt with 2-file rotation at 2MB.
 /// Thread-safe. iOS 9 compatible. No external dependencies.
+///
+/// Logging calls only format the message and enqueue it on a lock-free ring
+/// buffer; a low-priority writer queue timestamps, batches and writes lines.
+/// Error-level calls, +flush and the crash handler drain the queue and sync
+/// the file synchronously.
 @interface HALog : NSObject
 
 /// Log at specific levels with module tag.
@@ -29,8 +37,14 @@ typedef NS_ENUM(NSInteger, HALogLevel) {
 /// File management.
 + (NSString *)currentLogFilePath;
 + (NSString *)previousLogFilePath;
+/// Write everything queued so far and sync the file. Blocks the caller.
 + (void)flush;
 
+/// Wrap every +flush in tracer, which must call flush exactly once, so a
+/// profiler can time log I/O without the logger depending on it. Set once,
+/// before logging gets busy; nil removes it.
++ (void)setFlushTracer:(HALogFlushTracer)tracer;
+
 /// Startup profiling mode (replaces HAStartupLog).
 /// Uses mach_absolute_time offsets for the first 30 seconds, then wall clock.
 + (void)logStartup:(NSString *)message;
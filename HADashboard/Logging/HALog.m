@@ -3,14 +3,84 @@
 #include <mach/mach_time.h>
 #include <signal.h>
 #include <execinfo.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
 
 static NSString *const kHALogMinLevelKey = @"HALogMinLevel";
 static NSString *const kHALogFileName = @"ha-log.txt";
 static NSString *const kHALogPreviousFileName = @"ha-log-prev.txt";
 static const NSUInteger kHALogMaxFileSize = 2 * 1024 * 1024; // 2MB
 static const NSTimeInterval kHALogStartupWindow = 30.0; // seconds
+static const NSUInteger kHALogBatchBytes = 64 * 1024;   // write() granularity when draining
 
 static NSString *_logLevelNames[] = { @"DEBUG", @"INFO", @"WARN", @"ERROR" };
+static const char *_logLevelCNames[] = { "DEBUG", "INFO", "WARN", "ERROR" };
+
+#pragma mark - Ring buffer
+
+// Bounded MPSC queue (Vyukov): producers claim a slot with one CAS on
+// _enqueuePos and publish it by bumping the slot's sequence. The single
+// consumer is whoever holds _fileLock, normally the writer queue; crash and
+// error paths take the lock and drain on their own thread.
+
+#define HALOG_RING_CAPACITY 1024 // power of two
+
+typedef struct {
+    HALogLevel level;
+    BOOL startup;          // logStartup: line, tag unused
+    uint64_t machTime;
+    double wallTime;       // seconds since 1970
+    CFTypeRef tag;         // +1, released by the consumer
+    CFTypeRef message;     // +1, released by the consumer
+} HALogEntry;
+
+typedef struct {
+    atomic_uintptr_t sequence;
+    HALogEntry entry;
+} HALogSlot;
+
+static HALogSlot _ring[HALOG_RING_CAPACITY];
+static atomic_uintptr_t _enqueuePos;
+static uintptr_t _dequeuePos;            // guarded by _fileLock
+static atomic_uint _droppedCount;
+static pthread_mutex_t _fileLock = PTHREAD_MUTEX_INITIALIZER;
+
+static BOOL HALogEnqueue(const HALogEntry *entry) {
+    uintptr_t pos = atomic_load_explicit(&_enqueuePos, memory_order_relaxed);
+    HALogSlot *slot;
+    for (;;) {
+        slot = &_ring[pos & (HALOG_RING_CAPACITY - 1)];
+        uintptr_t seq = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&_enqueuePos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return NO; // Full: writer is HALOG_RING_CAPACITY lines behind
+        } else {
+            pos = atomic_load_explicit(&_enqueuePos, memory_order_relaxed);
+        }
+    }
+    slot->entry = *entry;
+    atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+    return YES;
+}
+
+/// Caller must hold _fileLock.
+static BOOL HALogDequeue(HALogEntry *entry) {
+    HALogSlot *slot = &_ring[_dequeuePos & (HALOG_RING_CAPACITY - 1)];
+    uintptr_t seq = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+    if ((intptr_t)seq - (intptr_t)(_dequeuePos + 1) < 0) return NO;
+    *entry = slot->entry;
+    slot->entry.tag = NULL;
+    slot->entry.message = NULL;
+    atomic_store_explicit(&slot->sequence, _dequeuePos + HALOG_RING_CAPACITY, memory_order_release);
+    _dequeuePos++;
+    return YES;
+}
 
 @implementation HALog {
 }
@@ -24,6 +94,16 @@ static HALogLevel _minLevel = HALogLevelInfo;
 static BOOL _fileLoggingEnabled = YES;
 static BOOL _consoleLoggingEnabled = YES;
 static BOOL _initialized = NO;
+static HALogFlushTracer _flushTracer = nil;
+
+// Background writer: producers poke the source, which coalesces pokes and
+// drains whatever has accumulated in one batch.
+static dispatch_queue_t _writerQueue = nil;
+static dispatch_source_t _writerSource = nil;
+
+// Wall-clock prefix cache, touched only while draining (under _fileLock)
+static time_t _cachedSecond = -1;
+static char _cachedClock[16];
 
 // Startup profiling state (absorbed from HAStartupLog)
 static uint64_t _processStartTime = 0;
@@ -54,7 +134,30 @@ static NSDate *_initDate = nil;
     _consoleLoggingEnabled = NO;
 #endif
 
+    for (NSUInteger i = 0; i < HALOG_RING_CAPACITY; i++) {
+        atomic_init(&_ring[i].sequence, i);
+    }
+
     [self _openLogFile];
+
+    _writerQueue = dispatch_queue_create("com.hadashboard.log.writer", DISPATCH_QUEUE_SERIAL);
+    dispatch_set_target_queue(_writerQueue, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0));
+    _writerSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_DATA_ADD, 0, 0, _writerQueue);
+    dispatch_source_set_event_handler(_writerSource, ^{
+        pthread_mutex_lock(&_fileLock);
+        [HALog _drainLocked];
+        pthread_mutex_unlock(&_fileLock);
+    });
+    dispatch_resume(_writerSource);
+
+    // Don't leave queued lines behind if the app is suspended or killed
+    NSNotificationCenter *nc = [NSNotificationCenter defaultCenter];
+    for (NSString *name in @[UIApplicationDidEnterBackgroundNotification, UIApplicationWillTerminateNotification]) {
+        [nc addObserverForName:name object:nil queue:nil usingBlock:^(NSNotification *note) {
+            [HALog flush];
+        }];
+    }
+
     _initialized = YES;
 }
 
@@ -129,19 +232,15 @@ static NSDate *_initDate = nil;
 + (void)logStartup:(NSString *)message {
     if (!_initialized) [self initialize];
 
-    uint64_t elapsed = mach_absolute_time() - _processStartTime;
-    double ms = (double)elapsed * (double)_timebase.numer
-                / (double)_timebase.denom / 1e6;
-
-    NSString *line = [NSString stringWithFormat:@"+%8.1fms  [startup] %@\n", ms, message];
-
-    @synchronized(self) {
-        [self _writeToFile:line];
-    }
-
-    if (_consoleLoggingEnabled) {
-        NSLog(@"[startup] +%.0fms %@", ms, message);
-    }
+    HALogEntry entry = {
+        .level = HALogLevelInfo,
+        .startup = YES,
+        .machTime = mach_absolute_time(),
+        .wallTime = 0,
+        .tag = NULL,
+        .message = CFBridgingRetain([message copy]),
+    };
+    [self _submit:&entry];
 }
 
 + (void)setMinLevel:(HALogLevel)level {
@@ -171,14 +270,30 @@ static NSDate *_initDate = nil;
     return _previousPath;
 }
 
++ (void)setFlushTracer:(HALogFlushTracer)tracer {
+    _flushTracer = [tracer copy];
+}
+
 + (void)flush {
-    @synchronized(self) {
-        @try {
-            [_fileHandle synchronizeFile];
-        } @catch (NSException *e) {
-            // Silently ignore — file may have been invalidated
-        }
+    if (!_initialized) [self initialize];
+    HALogFlushTracer tracer = _flushTracer;
+    if (tracer) {
+        tracer(^{ [self _flushNow]; });
+    } else {
+        [self _flushNow];
+    }
+}
+
+/// Drain and sync the file, taking _fileLock.
++ (void)_flushNow {
+    pthread_mutex_lock(&_fileLock);
+    [self _drainLocked];
+    @try {
+        [_fileHandle synchronizeFile];
+    } @catch (NSException *e) {
+        // Silently ignore — file may have been invalidated
     }
+    pthread_mutex_unlock(&_fileLock);
 }
 
 #pragma mark - Internal
@@ -188,64 +303,142 @@ static NSDate *_initDate = nil;
            format:(NSString *)fmt
              args:(va_list)args {
     if (!_initialized) [self initialize];
+    if (!_fileLoggingEnabled && !_consoleLoggingEnabled) return;
 
+    // The caller pays for formatting (varargs can't outlive this frame) and a
+    // clock read; timestamps, encoding, console echo and I/O happen on the writer.
     NSString *message = [[NSString alloc] initWithFormat:fmt arguments:args];
-
-    // Build timestamp
-    NSString *timestamp;
-    NSTimeInterval sinceInit = -[_initDate timeIntervalSinceNow];
-    if (sinceInit < kHALogStartupWindow) {
-        // Startup mode: mach_absolute_time offsets
-        uint64_t elapsed = mach_absolute_time() - _processStartTime;
-        double ms = (double)elapsed * (double)_timebase.numer
-                    / (double)_timebase.denom / 1e6;
-        timestamp = [NSString stringWithFormat:@"+%8.1fms", ms];
-    } else {
-        // Normal mode: wall clock HH:mm:ss.SSS
-        timestamp = [self _wallClockTimestamp];
+    HALogEntry entry = {
+        .level = level,
+        .startup = NO,
+        .machTime = mach_absolute_time(),
+        .wallTime = CFAbsoluteTimeGetCurrent() + kCFAbsoluteTimeIntervalSince1970,
+        .tag = CFBridgingRetain([tag copy] ?: @""),
+        .message = CFBridgingRetain(message),
+    };
+    [self _submit:&entry];
+
+    // Errors are written and synced before returning, so the line survives
+    // a crash that follows it.
+    if (level == HALogLevelError) {
+        [self flush];
     }
+}
 
-    NSString *line = [NSString stringWithFormat:@"%@ %5s [%@] %@\n",
-        timestamp,
-        _logLevelNames[level].UTF8String,
-        tag,
-        message];
+/// Queue an entry for the writer. If the ring is full the line is counted as
+/// dropped (reported in the log once there is room) unless it is an error,
+/// which is written synchronously instead.
++ (void)_submit:(HALogEntry *)entry {
+    if (HALogEnqueue(entry)) {
+        dispatch_source_merge_data(_writerSource, 1);
+        return;
+    }
+    if (entry->level == HALogLevelError) {
+        pthread_mutex_lock(&_fileLock);
+        [self _drainLocked];
+        if (!HALogEnqueue(entry)) {
+            // Producers refilled the ring between the drain and our enqueue
+            [self _writeEntry:entry into:nil];
+        }
+        [self _drainLocked];
+        pthread_mutex_unlock(&_fileLock);
+        return;
+    }
+    if (entry->message) CFRelease(entry->message);
+    if (entry->tag) CFRelease(entry->tag);
+    atomic_fetch_add_explicit(&_droppedCount, 1, memory_order_relaxed);
+}
 
-    @synchronized(self) {
-        if (_fileLoggingEnabled) {
-            [self _writeToFile:line];
+#pragma mark - Writer (caller holds _fileLock)
+
+/// Write every queued entry to the file in as few write() calls as possible.
++ (void)_drainLocked {
+    NSMutableData *batch = [NSMutableData data];
+    HALogEntry entry;
+    while (HALogDequeue(&entry)) {
+        [self _writeEntry:&entry into:batch];
+        if (batch.length >= kHALogBatchBytes) {
+            [self _writeToFile:batch];
+            batch.length = 0;
         }
     }
+    unsigned int dropped = atomic_exchange_explicit(&_droppedCount, 0, memory_order_relaxed);
+    if (dropped > 0) {
+        NSString *note = [NSString stringWithFormat:@"%s  WARN [log] Dropped %u lines (writer fell behind)\n",
+            [self _timestampForMachTime:mach_absolute_time()
+                               wallTime:CFAbsoluteTimeGetCurrent() + kCFAbsoluteTimeIntervalSince1970].UTF8String,
+            dropped];
+        [batch appendData:[note dataUsingEncoding:NSUTF8StringEncoding]];
+    }
+    if (batch.length > 0) {
+        [self _writeToFile:batch];
+    }
+}
 
-    // Auto-flush on error
-    if (level == HALogLevelError) {
-        [self flush];
+/// Consume entry (releasing its strings) and append its line to batch, or
+/// write it straight to the file when batch is nil.
++ (void)_writeEntry:(HALogEntry *)entry into:(NSMutableData *)batch {
+    NSString *tag = CFBridgingRelease(entry->tag);
+    NSString *message = CFBridgingRelease(entry->message);
+    entry->tag = NULL;
+    entry->message = NULL;
+
+    NSString *line;
+    if (entry->startup) {
+        double ms = [self _millisecondsSinceStartForMachTime:entry->machTime];
+        line = [NSString stringWithFormat:@"+%8.1fms  [startup] %@\n", ms, message];
+        if (_consoleLoggingEnabled) {
+            NSLog(@"[startup] +%.0fms %@", ms, message);
+        }
+    } else {
+        line = [NSString stringWithFormat:@"%@ %5s [%@] %@\n",
+            [self _timestampForMachTime:entry->machTime wallTime:entry->wallTime],
+            _logLevelCNames[entry->level],
+            tag,
+            message];
+        if (_consoleLoggingEnabled) {
+            NSLog(@"[%@] %@", tag, message);
+        }
     }
 
-    if (_consoleLoggingEnabled) {
-        NSLog(@"[%@] %@", tag, message);
+    if (!_fileLoggingEnabled) return;
+    NSData *data = [line dataUsingEncoding:NSUTF8StringEncoding];
+    if (batch) {
+        [batch appendData:data];
+    } else {
+        [self _writeToFile:data];
     }
 }
 
-+ (NSString *)_wallClockTimestamp {
-    // Manual formatting for iOS 9 perf (avoid NSDateFormatter allocation)
-    NSDate *now = [NSDate date];
-    NSCalendar *cal = [NSCalendar currentCalendar];
-    NSDateComponents *c = [cal components:(NSCalendarUnitHour |
-                                           NSCalendarUnitMinute |
-                                           NSCalendarUnitSecond)
-                                 fromDate:now];
-    NSTimeInterval frac = [now timeIntervalSince1970];
-    int millis = (int)((frac - floor(frac)) * 1000);
-    return [NSString stringWithFormat:@"%02ld:%02ld:%02ld.%03d",
-        (long)c.hour, (long)c.minute, (long)c.second, millis];
++ (double)_millisecondsSinceStartForMachTime:(uint64_t)machTime {
+    uint64_t elapsed = machTime - _processStartTime;
+    return (double)elapsed * (double)_timebase.numer / (double)_timebase.denom / 1e6;
+}
+
++ (NSString *)_timestampForMachTime:(uint64_t)machTime wallTime:(double)wallTime {
+    double ms = [self _millisecondsSinceStartForMachTime:machTime];
+    if (ms < kHALogStartupWindow * 1000.0) {
+        // Startup mode: mach_absolute_time offsets
+        return [NSString stringWithFormat:@"+%8.1fms", ms];
+    }
+    // Normal mode: wall clock HH:mm:ss.SSS. The HH:mm:ss part only changes
+    // once a second, so it is cached rather than recomputed per line.
+    time_t second = (time_t)floor(wallTime);
+    if (second != _cachedSecond) {
+        struct tm local;
+        localtime_r(&second, &local);
+        strftime(_cachedClock, sizeof(_cachedClock), "%H:%M:%S", &local);
+        _cachedSecond = second;
+    }
+    int millis = (int)((wallTime - floor(wallTime)) * 1000);
+    return [NSString stringWithFormat:@"%s.%03d", _cachedClock, millis];
 }
 
-+ (void)_writeToFile:(NSString *)line {
++ (void)_writeToFile:(NSData *)data {
     if (!_fileHandle) return;
 
     @try {
-        [_fileHandle writeData:[line dataUsingEncoding:NSUTF8StringEncoding]];
+        [_fileHandle writeData:data];
 
         // Check rotation
         unsigned long long size = [_fileHandle offsetInFile];
@@ -328,18 +521,25 @@ static void _HACrashSignalHandler(int sig) {
 }
 
 + (void)logCrashMessage:(NSString *)message {
-    // Best-effort write directly to the file handle.
-    // We're in a crash context so keep it minimal.
-    @synchronized(self) {
-        @try {
-            if (_fileHandle) {
-                [_fileHandle writeData:[message dataUsingEncoding:NSUTF8StringEncoding]];
-                [_fileHandle synchronizeFile];
-            }
-        } @catch (NSException *e) {
-            // Nothing we can do
+    // Best-effort write directly to the file handle, after whatever is still
+    // queued. We're in a crash context so keep it minimal: if the writer
+    // can't give up the lock promptly (e.g. it is the thread that crashed),
+    // skip the queue and write anyway.
+    BOOL locked = NO;
+    for (int attempt = 0; attempt < 50 && !locked; attempt++) {
+        locked = (pthread_mutex_trylock(&_fileLock) == 0);
+        if (!locked) usleep(1000);
+    }
+    @try {
+        if (locked) [self _drainLocked];
+        if (_fileHandle) {
+            [_fileHandle writeData:[message dataUsingEncoding:NSUTF8StringEncoding]];
+            [_fileHandle synchronizeFile];
         }
+    } @catch (NSException *e) {
+        // Nothing we can do
     }
+    if (locked) pthread_mutex_unlock(&_fileLock);
     // Also try NSLog in case the file is gone
     NSLog(@"[HALog CRASH] %@", message);
 }
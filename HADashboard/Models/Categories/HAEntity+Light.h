@@ -1,5 +1,4 @@
 #import "HAEntity.h"
-#import <UIKit/UIKit.h>
 
 @interface HAEntity (Light)
 
@@ -26,8 +25,4 @@
 - (BOOL)supportsHSColor;
 - (BOOL)supportsEffects;
 
-/// Returns the current color as a UIColor, derived from hs_color or rgb_color.
-/// Returns nil if the light has no color information.
-- (UIColor *)currentColor;
-
 @end
@@ -133,33 +133,4 @@
     return [self effectList].count > 0;
 }
 
-#pragma mark - Current Color
-
-- (UIColor *)currentColor {
-    // Try hs_color first (most common)
-    NSArray<NSNumber *> *hs = [self hsColor];
-    if (hs.count >= 2) {
-        CGFloat hue = [hs[0] doubleValue] / 360.0;
-        CGFloat sat = [hs[1] doubleValue] / 100.0;
-        return [UIColor colorWithHue:hue saturation:sat brightness:1.0 alpha:1.0];
-    }
-    // Fallback: rgb_color
-    NSArray<NSNumber *> *rgb = [self rgbColor];
-    if (rgb.count >= 3) {
-        return [UIColor colorWithRed:[rgb[0] doubleValue] / 255.0
-                               green:[rgb[1] doubleValue] / 255.0
-                                blue:[rgb[2] doubleValue] / 255.0
-                               alpha:1.0];
-    }
-    // Fallback: rgbw_color (ignore white channel for display)
-    NSArray<NSNumber *> *rgbw = [self rgbwColor];
-    if (rgbw.count >= 3) {
-        return [UIColor colorWithRed:[rgbw[0] doubleValue] / 255.0
-                               green:[rgbw[1] doubleValue] / 255.0
-                                blue:[rgbw[2] doubleValue] / 255.0
-                               alpha:1.0];
-    }
-    return nil;
-}
-
 @end
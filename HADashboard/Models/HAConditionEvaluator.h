@@ -0,0 +1,28 @@
+#import <Foundation/Foundation.h>
+
+@class HAEntity;
+
+/// Evaluates Lovelace visibility / conditional-row conditions against the
+/// entity store. Supports state, state_not, numeric_state, and/or/not, user
+/// (always passes) and screen media queries (min-width / max-width).
+///
+/// Foundation-only so it can be built and benchmarked outside the app
+/// (see scripts/bench-core.sh). Callers supply the width screen queries
+/// are measured against.
+@interface HAConditionEvaluator : NSObject
+
+/// YES if the single condition dict holds. Malformed or unknown conditions pass.
++ (BOOL)evaluateCondition:(NSDictionary *)condition
+                 entities:(NSDictionary<NSString *, HAEntity *> *)entities
+              screenWidth:(CGFloat)screenWidth;
+
+/// YES if every condition holds. nil or empty conditions = always visible.
++ (BOOL)evaluateConditions:(NSArray<NSDictionary *> *)conditions
+                  entities:(NSDictionary<NSString *, HAEntity *> *)entities
+               screenWidth:(CGFloat)screenWidth;
+
+/// Lowercased state with boolean spellings folded: 1/true/on → "on",
+/// 0/false/off → "off". nil → "".
++ (NSString *)normalizedState:(id)value;
+
+@end
@@ -0,0 +1,147 @@
+#import "HAConditionEvaluator.h"
+#import "HAEntity.h"
+
+@implementation HAConditionEvaluator
+
++ (NSString *)normalizedState:(id)value {
+    if (!value) return @"";
+    NSString *str = [[value description] lowercaseString];
+    if ([str isEqualToString:@"1"] || [str isEqualToString:@"true"] || [str isEqualToString:@"on"]) {
+        return @"on";
+    }
+    if ([str isEqualToString:@"0"] || [str isEqualToString:@"false"] || [str isEqualToString:@"off"]) {
+        return @"off";
+    }
+    return str;
+}
+
++ (BOOL)evaluateConditions:(NSArray<NSDictionary *> *)conditions
+                  entities:(NSDictionary<NSString *, HAEntity *> *)entities
+               screenWidth:(CGFloat)screenWidth {
+    if (![conditions isKindOfClass:[NSArray class]]) return YES;
+    for (NSDictionary *condition in conditions) {
+        if (![self evaluateCondition:condition entities:entities screenWidth:screenWidth]) return NO;
+    }
+    return YES;
+}
+
++ (BOOL)evaluateCondition:(NSDictionary *)condition
+                 entities:(NSDictionary<NSString *, HAEntity *> *)entities
+              screenWidth:(CGFloat)screenWidth {
+    if (![condition isKindOfClass:[NSDictionary class]]) return YES;
+
+    NSString *condType = condition[@"condition"];
+    // Default to "state" if type is omitted but entity is present
+    if (!condType && condition[@"entity"]) {
+        condType = @"state";
+    }
+
+    if ([condType isEqualToString:@"state"]) {
+        NSString *entityId = condition[@"entity"];
+        if (!entityId) return YES;
+
+        id requiredStateRaw = condition[@"state"];
+        id requiredStateNotRaw = condition[@"state_not"];
+        if (!requiredStateRaw && !requiredStateNotRaw) return YES;
+
+        NSString *currNorm = [self normalizedState:entities[entityId].state];
+
+        if (requiredStateRaw) {
+            NSArray *requiredStates = [requiredStateRaw isKindOfClass:[NSArray class]]
+                                          ? (NSArray *)requiredStateRaw
+                                          : @[ requiredStateRaw ];
+            BOOL matched = NO;
+            for (id req in requiredStates) {
+                if ([[self normalizedState:req] isEqualToString:currNorm]) {
+                    matched = YES;
+                    break;
+                }
+            }
+            if (!matched) return NO;
+        }
+
+        if (requiredStateNotRaw) {
+            NSArray *requiredStatesNot = [requiredStateNotRaw isKindOfClass:[NSArray class]]
+                                             ? (NSArray *)requiredStateNotRaw
+                                             : @[ requiredStateNotRaw ];
+            for (id req in requiredStatesNot) {
+                if ([[self normalizedState:req] isEqualToString:currNorm]) return NO;
+            }
+        }
+        return YES;
+    }
+
+    if ([condType isEqualToString:@"numeric_state"]) {
+        NSString *entityId = condition[@"entity"];
+        if (!entityId) return YES;
+
+        NSString *currentState = entities[entityId].state;
+        if (!currentState) return NO;
+
+        double currentVal = [currentState doubleValue];
+        id aboveRaw = condition[@"above"];
+        id belowRaw = condition[@"below"];
+
+        if (aboveRaw && currentVal <= [aboveRaw doubleValue]) return NO;
+        if (belowRaw && currentVal >= [belowRaw doubleValue]) return NO;
+        return YES;
+    }
+
+    if ([condType isEqualToString:@"and"]) {
+        return [self evaluateConditions:condition[@"conditions"] entities:entities screenWidth:screenWidth];
+    }
+
+    if ([condType isEqualToString:@"or"]) {
+        NSArray *subConditions = condition[@"conditions"];
+        if ([subConditions isKindOfClass:[NSArray class]]) {
+            if (subConditions.count == 0) return YES;
+            for (NSDictionary *sub in subConditions) {
+                if ([self evaluateCondition:sub entities:entities screenWidth:screenWidth]) return YES;
+            }
+            return NO;
+        }
+        return YES;
+    }
+
+    if ([condType isEqualToString:@"not"]) {
+        NSArray *subConditions = condition[@"conditions"];
+        if ([subConditions isKindOfClass:[NSArray class]]) {
+            for (NSDictionary *sub in subConditions) {
+                if ([self evaluateCondition:sub entities:entities screenWidth:screenWidth]) return NO;
+            }
+        }
+        return YES;
+    }
+
+    if ([condType isEqualToString:@"user"]) {
+        return YES; // always pass local dashboard
+    }
+
+    if ([condType isEqualToString:@"screen"]) {
+        NSString *query = condition[@"media_query"];
+        if ([query isKindOfClass:[NSString class]]) {
+            NSInteger minWidth = 0, maxWidth = 0;
+            if ([self scanWidth:@"min-width" inQuery:query value:&minWidth] && screenWidth < minWidth) {
+                return NO;
+            }
+            if ([self scanWidth:@"max-width" inQuery:query value:&maxWidth] && screenWidth > maxWidth) {
+                return NO;
+            }
+        }
+        return YES;
+    }
+
+    return YES;
+}
+
+/// First integer after `feature` in a media query, e.g. "(min-width: 768px)" → 768.
++ (BOOL)scanWidth:(NSString *)feature inQuery:(NSString *)query value:(NSInteger *)value {
+    NSRange range = [query rangeOfString:feature];
+    if (range.location == NSNotFound) return NO;
+    NSScanner *scanner = [NSScanner scannerWithString:query];
+    scanner.scanLocation = NSMaxRange(range);
+    [scanner scanUpToCharactersFromSet:[NSCharacterSet decimalDigitCharacterSet] intoString:nil];
+    return [scanner scanInteger:value];
+}
+
+@end
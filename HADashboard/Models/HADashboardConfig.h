@@ -1,6 +1,7 @@
 #import <Foundation/Foundation.h>
 
 @class HADashboardConfigSection;
+@class HACellDescriptor;
 
 @interface HADashboardConfigItem : NSObject
 
@@ -18,6 +19,9 @@
 /// Conditional visibility: array of @{@"entity": entityId, @"state": requiredState}
 /// Item is shown only when ALL conditions are met. nil = always show.
 @property (nonatomic, copy) NSArray<NSDictionary *> *visibilityConditions;
+/// Cell class, reuse ID and sizing resolved by HAEntityCellFactory. Cleared
+/// when entityId, cardType, entitiesSection or customProperties is set.
+@property (nonatomic, strong) HACellDescriptor *cellDescriptor;
 
 - (instancetype)initWithDictionary:(NSDictionary *)dict;
 
@@ -59,4 +63,13 @@
 /// All entity IDs referenced in this config (across all sections)
 - (NSArray<NSString *> *)allEntityIds;
 
+/// JSON-compatible form of the config for the parsed dashboard cache. Items
+/// and sections are stored once and referenced by index, so objects shared
+/// between lists (a composite item's entitiesSection) stay shared on decode.
+- (NSDictionary *)archiveDictionary;
+
+/// Rebuild a config from archiveDictionary. Each call returns a new object
+/// graph. Returns nil if the archive is malformed.
++ (instancetype)configFromArchiveDictionary:(NSDictionary *)dict;
+
 @end
@@ -18,6 +18,28 @@
     return self;
 }
 
+// Setters for everything HAEntityCellFactory resolves a descriptor from
+
+- (void)setEntityId:(NSString *)entityId {
+    _entityId = [entityId copy];
+    _cellDescriptor = nil;
+}
+
+- (void)setCardType:(NSString *)cardType {
+    _cardType = [cardType copy];
+    _cellDescriptor = nil;
+}
+
+- (void)setEntitiesSection:(HADashboardConfigSection *)entitiesSection {
+    _entitiesSection = entitiesSection;
+    _cellDescriptor = nil;
+}
+
+- (void)setCustomProperties:(NSDictionary *)customProperties {
+    _customProperties = [customProperties copy];
+    _cellDescriptor = nil;
+}
+
 @end
 
 
@@ -27,6 +49,93 @@
 @end
 
 
+#pragma mark - Archive Tables
+
+/// Object tables built by -[HADashboardConfig archiveDictionary]. Objects are
+/// keyed by identity, not isEqual:, so each one is written exactly once.
+@interface HADashboardConfigArchiver : NSObject
+@property (nonatomic, strong) NSMutableArray<NSDictionary *> *itemTable;
+@property (nonatomic, strong) NSMutableArray<NSDictionary *> *sectionTable;
+@property (nonatomic, strong) NSMapTable *itemIndexes;
+@property (nonatomic, strong) NSMapTable *sectionIndexes;
+@end
+
+@implementation HADashboardConfigArchiver
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        NSPointerFunctionsOptions identity = NSPointerFunctionsObjectPointerPersonality | NSPointerFunctionsStrongMemory;
+        _itemTable = [NSMutableArray array];
+        _sectionTable = [NSMutableArray array];
+        _itemIndexes = [NSMapTable mapTableWithKeyOptions:identity valueOptions:NSPointerFunctionsStrongMemory];
+        _sectionIndexes = [NSMapTable mapTableWithKeyOptions:identity valueOptions:NSPointerFunctionsStrongMemory];
+    }
+    return self;
+}
+
+- (NSArray<NSNumber *> *)indexesOfItems:(NSArray<HADashboardConfigItem *> *)items {
+    NSMutableArray *indexes = [NSMutableArray arrayWithCapacity:items.count];
+    for (HADashboardConfigItem *item in items) [indexes addObject:[self indexOfItem:item]];
+    return indexes;
+}
+
+- (NSNumber *)indexOfItem:(HADashboardConfigItem *)item {
+    NSNumber *index = [self.itemIndexes objectForKey:item];
+    if (index) return index;
+    index = @(self.itemTable.count);
+    [self.itemIndexes setObject:index forKey:item];
+    [self.itemTable addObject:@{}]; // reserve the slot before recursing
+
+    NSMutableDictionary *dict = [NSMutableDictionary dictionary];
+    if (item.entityId) dict[@"entity_id"] = item.entityId;
+    if (item.displayName) dict[@"display_name"] = item.displayName;
+    dict[@"column"] = @(item.column);
+    dict[@"row"] = @(item.row);
+    dict[@"column_span"] = @(item.columnSpan);
+    dict[@"row_span"] = @(item.rowSpan);
+    if (item.cardType) dict[@"card_type"] = item.cardType;
+    if (item.entitiesSection) dict[@"entities_section"] = [self indexOfSection:item.entitiesSection];
+    if (item.customProperties) dict[@"custom_properties"] = item.customProperties;
+    if (item.visibilityConditions) dict[@"visibility_conditions"] = item.visibilityConditions;
+    self.itemTable[index.unsignedIntegerValue] = dict;
+    return index;
+}
+
+- (NSNumber *)indexOfSection:(HADashboardConfigSection *)section {
+    NSNumber *index = [self.sectionIndexes objectForKey:section];
+    if (index) return index;
+    index = @(self.sectionTable.count);
+    [self.sectionIndexes setObject:index forKey:section];
+    [self.sectionTable addObject:@{}];
+
+    NSMutableDictionary *dict = [NSMutableDictionary dictionary];
+    if (section.title) dict[@"title"] = section.title;
+    if (section.cardType) dict[@"card_type"] = section.cardType;
+    if (section.icon) dict[@"icon"] = section.icon;
+    if (section.items) dict[@"items"] = [self indexesOfItems:section.items];
+    if (section.entityIds) dict[@"entity_ids"] = section.entityIds;
+    if (section.nameOverrides) dict[@"name_overrides"] = section.nameOverrides;
+    if (section.customProperties) dict[@"custom_properties"] = section.customProperties;
+    self.sectionTable[index.unsignedIntegerValue] = dict;
+    return index;
+}
+
+@end
+
+/// Objects of table at the given indexes, or nil if any index is out of range.
+static NSArray *HAArchiveObjectsAtIndexes(id indexes, NSArray *table) {
+    if (![indexes isKindOfClass:[NSArray class]]) return nil;
+    NSMutableArray *objects = [NSMutableArray arrayWithCapacity:[indexes count]];
+    for (id index in indexes) {
+        if (![index isKindOfClass:[NSNumber class]] || [index integerValue] < 0 ||
+            [index unsignedIntegerValue] >= table.count) return nil;
+        [objects addObject:table[[index unsignedIntegerValue]]];
+    }
+    return [objects copy];
+}
+
+
 #pragma mark - HADashboardConfig
 
 @implementation HADashboardConfig
@@ -116,4 +225,82 @@
     return [ids copy];
 }
 
+#pragma mark - Archive
+
+- (NSDictionary *)archiveDictionary {
+    HADashboardConfigArchiver *archiver = [[HADashboardConfigArchiver alloc] init];
+    NSMutableDictionary *dict = [NSMutableDictionary dictionary];
+    if (self.title) dict[@"title"] = self.title;
+    dict[@"columns"] = @(self.columns);
+    if (self.strategyType) dict[@"strategy_type"] = self.strategyType;
+    if (self.strategyConfig) dict[@"strategy_config"] = self.strategyConfig;
+    NSMutableArray *sectionIndexes = [NSMutableArray arrayWithCapacity:self.sections.count];
+    for (HADashboardConfigSection *section in self.sections) {
+        [sectionIndexes addObject:[archiver indexOfSection:section]];
+    }
+    dict[@"sections"] = sectionIndexes;
+    dict[@"items"] = [archiver indexesOfItems:self.items ?: @[]];
+    dict[@"section_table"] = archiver.sectionTable;
+    dict[@"item_table"] = archiver.itemTable;
+    return [dict copy];
+}
+
++ (instancetype)configFromArchiveDictionary:(NSDictionary *)dict {
+    if (![dict isKindOfClass:[NSDictionary class]]) return nil;
+    NSArray *itemTable = HASafeDictArrayOrNil(dict, @"item_table") ?: @[];
+    NSArray *sectionTable = HASafeDictArrayOrNil(dict, @"section_table") ?: @[];
+
+    // Create every object first so references can point at any table slot
+    NSMutableArray<HADashboardConfigItem *> *items = [NSMutableArray arrayWithCapacity:itemTable.count];
+    for (NSUInteger i = 0; i < itemTable.count; i++) [items addObject:[[HADashboardConfigItem alloc] init]];
+    NSMutableArray<HADashboardConfigSection *> *sections = [NSMutableArray arrayWithCapacity:sectionTable.count];
+    for (NSUInteger i = 0; i < sectionTable.count; i++) [sections addObject:[[HADashboardConfigSection alloc] init]];
+
+    for (NSUInteger i = 0; i < itemTable.count; i++) {
+        NSDictionary *entry = itemTable[i];
+        if (![entry isKindOfClass:[NSDictionary class]]) return nil;
+        HADashboardConfigItem *item = items[i];
+        item.entityId = HASafeDictStringOrNil(entry, @"entity_id");
+        item.displayName = HASafeDictStringOrNil(entry, @"display_name");
+        item.column = HASafeDictInteger(entry, @"column", 0);
+        item.row = HASafeDictInteger(entry, @"row", 0);
+        item.columnSpan = HASafeDictInteger(entry, @"column_span", 1);
+        item.rowSpan = HASafeDictInteger(entry, @"row_span", 1);
+        item.cardType = HASafeDictStringOrNil(entry, @"card_type");
+        item.customProperties = HASafeDictDictOrNil(entry, @"custom_properties");
+        item.visibilityConditions = HASafeDictArrayOrNil(entry, @"visibility_conditions");
+        if (entry[@"entities_section"]) {
+            NSArray *linked = HAArchiveObjectsAtIndexes(@[entry[@"entities_section"]], sections);
+            if (!linked) return nil;
+            item.entitiesSection = linked.firstObject;
+        }
+    }
+
+    for (NSUInteger i = 0; i < sectionTable.count; i++) {
+        NSDictionary *entry = sectionTable[i];
+        if (![entry isKindOfClass:[NSDictionary class]]) return nil;
+        HADashboardConfigSection *section = sections[i];
+        section.title = HASafeDictStringOrNil(entry, @"title");
+        section.cardType = HASafeDictStringOrNil(entry, @"card_type");
+        section.icon = HASafeDictStringOrNil(entry, @"icon");
+        section.entityIds = HASafeDictArrayOrNil(entry, @"entity_ids");
+        section.nameOverrides = HASafeDictDictOrNil(entry, @"name_overrides");
+        section.customProperties = HASafeDictDictOrNil(entry, @"custom_properties");
+        if (entry[@"items"]) {
+            section.items = HAArchiveObjectsAtIndexes(entry[@"items"], items);
+            if (!section.items) return nil;
+        }
+    }
+
+    HADashboardConfig *config = [[HADashboardConfig alloc] init];
+    config.title = HASafeDictStringOrNil(dict, @"title");
+    config.columns = HASafeDictInteger(dict, @"columns", 3);
+    config.strategyType = HASafeDictStringOrNil(dict, @"strategy_type");
+    config.strategyConfig = HASafeDictDictOrNil(dict, @"strategy_config");
+    config.sections = HAArchiveObjectsAtIndexes(dict[@"sections"], sections);
+    config.items = HAArchiveObjectsAtIndexes(dict[@"items"], items);
+    if (!config.sections || !config.items) return nil;
+    return config;
+}
+
 @end
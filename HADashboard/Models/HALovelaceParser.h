@@ -2,6 +2,11 @@
 
 @class HADashboardConfig;
 
+/// Version of the archived parsed-dashboard form. Bump it whenever the archive
+/// layout or card interpretation changes, so archives written by an older
+/// build are parsed again from the raw config.
+extern const NSInteger HALovelaceArchiveVersion;
+
 /// Represents a single Lovelace view (tab) in a HA dashboard
 @interface HALovelaceView : NSObject
 @property (nonatomic, copy) NSString *title;
@@ -15,6 +20,16 @@
 @property (nonatomic, assign) NSInteger maxColumns;
 /// View layout type: "masonry" (default classic), "panel", "sidebar", or "sections".
 @property (nonatomic, copy) NSString *viewType;
+
+/// YES if both views build the same layout: same cards, sections, type and
+/// column limit. Title, path and icon are ignored. An archived view whose
+/// raw cards are no longer available is compared by its interpreted config.
+- (BOOL)isLayoutEqualToView:(HALovelaceView *)other;
+
+/// YES once dashboardConfigFromView:columns: has interpreted this view at
+/// columns. Later calls rebuild the config from the stored result instead of
+/// walking the cards again.
+- (BOOL)hasConfigForColumns:(NSInteger)columns;
 @end
 
 
@@ -22,9 +37,23 @@
 @interface HALovelaceDashboard : NSObject
 @property (nonatomic, copy) NSString *title;
 @property (nonatomic, copy) NSArray<HALovelaceView *> *views;
+/// SHA-256 of the raw config this dashboard was parsed from, as recorded by
+/// HADashboardConfigCache. nil for strategy dashboards, which are not archived.
+@property (nonatomic, copy) NSString *configHash;
 
 - (instancetype)initWithDictionary:(NSDictionary *)dict;
 
+/// JSON-compatible form: each view's metadata and the configs it has been
+/// interpreted into so far. Raw cards are not included.
+- (NSDictionary *)archiveDictionary;
+
+/// Restore a dashboard from archiveDictionary. rawConfigLoader supplies the
+/// raw config the first time any view's rawCards or rawSections are read
+/// (a new column count, a layout comparison); it is called at most once.
+/// Returns nil if the archive is malformed.
+- (instancetype)initWithArchiveDictionary:(NSDictionary *)dict
+                          rawConfigLoader:(NSDictionary *(^)(void))rawConfigLoader;
+
 /// Get a view by index
 - (HALovelaceView *)viewAtIndex:(NSUInteger)index;
 @end
@@ -2,9 +2,106 @@
 #import "HADashboardConfig.h"
 #import "HASafeDict.h"
 
+const NSInteger HALovelaceArchiveVersion = 1;
+
+#pragma mark - HALovelaceRawConfig
+
+/// Raw config shared by the views of an archived dashboard. Parsed on first
+/// use only, so a cold start from the archive never touches the raw JSON.
+@interface HALovelaceRawConfig : NSObject
+@property (nonatomic, copy) NSDictionary *(^loader)(void);
+@property (nonatomic, strong) HALovelaceDashboard *dashboard;
+@end
+
+@implementation HALovelaceRawConfig
+
+- (HALovelaceView *)viewAtIndex:(NSUInteger)index {
+    if (!self.dashboard) {
+        NSDictionary *config = self.loader ? self.loader() : nil;
+        self.loader = nil;
+        self.dashboard = [[HALovelaceDashboard alloc] initWithDictionary:
+                          [config isKindOfClass:[NSDictionary class]] ? config : @{}];
+    }
+    return [self.dashboard viewAtIndex:index];
+}
+
+@end
+
+
 #pragma mark - HALovelaceView
 
+@interface HALovelaceView ()
+/// Interpreted configs by column count, in HADashboardConfig archive form
+@property (nonatomic, strong) NSMutableDictionary<NSNumber *, NSDictionary *> *archivedConfigs;
+/// Set on views restored from an archive until their raw cards are read
+@property (nonatomic, strong) HALovelaceRawConfig *rawConfig;
+@property (nonatomic, assign) NSUInteger rawConfigIndex;
+/// The archived view's raw config could not be loaded (the cached config has
+/// moved on), so rawCards/rawSections are empty rather than the real cards
+@property (nonatomic, assign) BOOL rawConfigMissing;
+@end
+
 @implementation HALovelaceView
+
+- (NSArray<NSDictionary *> *)rawCards {
+    [self loadRawConfigIfNeeded];
+    return _rawCards;
+}
+
+- (NSArray<NSDictionary *> *)rawSections {
+    [self loadRawConfigIfNeeded];
+    return _rawSections;
+}
+
+- (void)loadRawConfigIfNeeded {
+    if (!self.rawConfig) return;
+    HALovelaceView *source = [self.rawConfig viewAtIndex:self.rawConfigIndex];
+    self.rawConfig = nil;
+    self.rawConfigMissing = (source == nil);
+    _rawCards = source.rawCards ?: @[];
+    _rawSections = source.rawSections;
+}
+
+- (BOOL)hasConfigForColumns:(NSInteger)columns {
+    return self.archivedConfigs[@(columns)] != nil;
+}
+
+- (BOOL)isLayoutEqualToView:(HALovelaceView *)other {
+    if (!other) return NO;
+    if (other == self) return YES;
+    if (self.maxColumns != other.maxColumns ||
+        !(self.viewType == other.viewType || [self.viewType isEqualToString:other.viewType])) return NO;
+
+    [self loadRawConfigIfNeeded];
+    [other loadRawConfigIfNeeded];
+    if (self.rawConfigMissing || other.rawConfigMissing) {
+        return [self isInterpretedLayoutEqualToView:other];
+    }
+    return (self.rawCards == other.rawCards || [self.rawCards isEqualToArray:other.rawCards]) &&
+           (self.rawSections == other.rawSections || [self.rawSections isEqualToArray:other.rawSections]);
+}
+
+/// Compare the stored interpretations at a column count one side already
+/// has, interpreting the other side if it still has its cards. Unknown
+/// means different.
+- (BOOL)isInterpretedLayoutEqualToView:(HALovelaceView *)other {
+    for (NSNumber *columns in self.archivedConfigs ?: other.archivedConfigs) {
+        HALovelaceView *missing = self.archivedConfigs[columns] ? other : self;
+        if (!missing.archivedConfigs[columns]) {
+            if (missing.rawConfigMissing) continue;
+            [HALovelaceParser dashboardConfigFromView:missing columns:columns.integerValue];
+        }
+        NSMutableDictionary *mine = [self.archivedConfigs[columns] mutableCopy];
+        NSMutableDictionary *theirs = [other.archivedConfigs[columns] mutableCopy];
+        if (!mine || !theirs) continue;
+        // Titles are not layout
+        [mine removeObjectForKey:@"title"];
+        [theirs removeObjectForKey:@"title"];
+        return [mine isEqualToDictionary:theirs];
+    }
+    return NO;
+}
+
 @end
 
 
@@ -82,13 +179,132 @@
     return self.views[index];
 }
 
+#pragma mark - Archive
+
+- (NSDictionary *)archiveDictionary {
+    NSMutableArray *views = [NSMutableArray arrayWithCapacity:self.views.count];
+    for (HALovelaceView *view in self.views) {
+        NSMutableDictionary *configs = [NSMutableDictionary dictionaryWithCapacity:view.archivedConfigs.count];
+        [view.archivedConfigs enumerateKeysAndObjectsUsingBlock:^(NSNumber *columns, NSDictionary *config, BOOL *stop) {
+            configs[columns.stringValue] = config;
+        }];
+        NSMutableDictionary *dict = [NSMutableDictionary dictionary];
+        if (view.title) dict[@"title"] = view.title;
+        if (view.path) dict[@"path"] = view.path;
+        if (view.icon) dict[@"icon"] = view.icon;
+        if (view.viewType) dict[@"view_type"] = view.viewType;
+        dict[@"max_columns"] = @(view.maxColumns);
+        dict[@"configs"] = configs;
+        [views addObject:dict];
+    }
+    NSMutableDictionary *dict = [NSMutableDictionary dictionary];
+    if (self.title) dict[@"title"] = self.title;
+    dict[@"views"] = views;
+    return [dict copy];
+}
+
+- (instancetype)initWithArchiveDictionary:(NSDictionary *)dict
+                          rawConfigLoader:(NSDictionary *(^)(void))rawConfigLoader {
+    NSArray *viewDicts = HASafeDictArrayOrNil(dict, @"views");
+    if (!viewDicts) return nil;
+
+    self = [super init];
+    if (self) {
+        _title = HASafeDictStringOrNil(dict, @"title");
+        HALovelaceRawConfig *rawConfig = [[HALovelaceRawConfig alloc] init];
+        rawConfig.loader = rawConfigLoader;
+
+        NSMutableArray *views = [NSMutableArray arrayWithCapacity:viewDicts.count];
+        for (NSDictionary *vd in viewDicts) {
+            if (![vd isKindOfClass:[NSDictionary class]]) return nil;
+            HALovelaceView *view = [[HALovelaceView alloc] init];
+            view.title = HASafeDictStringOrNil(vd, @"title");
+            view.path = HASafeDictStringOrNil(vd, @"path");
+            view.icon = HASafeDictStringOrNil(vd, @"icon");
+            view.viewType = HASafeDictStringOrNil(vd, @"view_type");
+            view.maxColumns = HASafeDictInteger(vd, @"max_columns", 0);
+            view.archivedConfigs = [NSMutableDictionary dictionary];
+            NSDictionary *configs = HASafeDictDictOrNil(vd, @"configs");
+            for (NSString *columns in configs) {
+                if (![configs[columns] isKindOfClass:[NSDictionary class]]) continue;
+                view.archivedConfigs[@(columns.integerValue)] = configs[columns];
+            }
+            view.rawConfig = rawConfig;
+            view.rawConfigIndex = views.count;
+            [views addObject:view];
+        }
+        _views = [views copy];
+    }
+    return self;
+}
+
 @end
 
 
 #pragma mark - HALovelaceParser
 
+/// How _processCard: treats a card type. Resolved once per card by
+/// cardKindForType: instead of comparing the type against every handler.
+typedef NS_ENUM(NSInteger, HALovelaceCardKind) {
+    HALovelaceCardKindOther = 0,    // single-entity cards (tile, button, gauge, custom:*)
+    HALovelaceCardKindHeading,
+    HALovelaceCardKindMarkdown,
+    HALovelaceCardKindConditional,
+    HALovelaceCardKindStack,        // grid, horizontal-stack, vertical-stack
+    HALovelaceCardKindEntities,
+    HALovelaceCardKindEntityFilter,
+    HALovelaceCardKindBadges,       // any type containing "badge"
+    HALovelaceCardKindGlance,
+    HALovelaceCardKindMiniGraph,    // custom:mini-graph-card and forks
+    HALovelaceCardKindHistoryGraph, // history-graph, statistics-graph
+    HALovelaceCardKindMushroomChips,
+    HALovelaceCardKindArea,
+    HALovelaceCardKindPictureGlance,
+    HALovelaceCardKindMap,
+};
+
 @implementation HALovelaceParser
 
+/// Card kind for a Lovelace card type. Built-in types are one hash lookup;
+/// custom cards fall back to substring rules, checked in order.
++ (HALovelaceCardKind)cardKindForType:(NSString *)type {
+    if (![type isKindOfClass:[NSString class]]) return HALovelaceCardKindOther;
+
+    static NSDictionary<NSString *, NSNumber *> *kinds = nil;
+    static NSArray<NSArray *> *substringRules = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        kinds = @{
+            @"heading":          @(HALovelaceCardKindHeading),
+            @"markdown":         @(HALovelaceCardKindMarkdown),
+            @"conditional":      @(HALovelaceCardKindConditional),
+            @"grid":             @(HALovelaceCardKindStack),
+            @"horizontal-stack": @(HALovelaceCardKindStack),
+            @"vertical-stack":   @(HALovelaceCardKindStack),
+            @"entities":         @(HALovelaceCardKindEntities),
+            @"entity-filter":    @(HALovelaceCardKindEntityFilter),
+            @"glance":           @(HALovelaceCardKindGlance),
+            @"history-graph":    @(HALovelaceCardKindHistoryGraph),
+            @"statistics-graph": @(HALovelaceCardKindHistoryGraph),
+            @"area":             @(HALovelaceCardKindArea),
+            @"picture-glance":   @(HALovelaceCardKindPictureGlance),
+            @"map":              @(HALovelaceCardKindMap),
+        };
+        substringRules = @[
+            @[@"badge",          @(HALovelaceCardKindBadges)],
+            @[@"mini-graph",     @(HALovelaceCardKindMiniGraph)],
+            @[@"mushroom-chips", @(HALovelaceCardKindMushroomChips)],
+        ];
+    });
+
+    NSNumber *kind = kinds[type];
+    if (kind) return kind.integerValue;
+    for (NSArray *rule in substringRules) {
+        if ([type containsString:rule[0]]) return [rule[1] integerValue];
+    }
+    return HALovelaceCardKindOther;
+}
+
 + (HALovelaceDashboard *)parseDashboardFromDictionary:(NSDictionary *)dict {
     if (!dict || ![dict isKindOfClass:[NSDictionary class]]) return nil;
     return [[HALovelaceDashboard alloc] initWithDictionary:dict];
@@ -97,6 +313,25 @@
 + (HADashboardConfig *)dashboardConfigFromView:(HALovelaceView *)view columns:(NSInteger)columns {
     if (!view) return nil;
 
+    // Callers rearrange the config they get, so every call hands out a fresh
+    // object graph decoded from the stored interpretation
+    NSNumber *key = @(columns);
+    NSDictionary *archived = view.archivedConfigs[key];
+    if (archived) {
+        HADashboardConfig *config = [HADashboardConfig configFromArchiveDictionary:archived];
+        if (config) return config;
+        [view.archivedConfigs removeObjectForKey:key];
+    }
+
+    HADashboardConfig *config = [self interpretView:view columns:columns];
+    if (!view.archivedConfigs) view.archivedConfigs = [NSMutableDictionary dictionary];
+    view.archivedConfigs[key] = [config archiveDictionary];
+    return config;
+}
+
+/// Walk the view's cards into a config. Only dashboardConfigFromView:columns:
+/// calls this; everything else reuses its stored result.
++ (HADashboardConfig *)interpretView:(HALovelaceView *)view columns:(NSInteger)columns {
     HADashboardConfig *config = [[HADashboardConfig alloc] init];
     config.title   = view.title;
     config.columns = columns > 0 ? columns : 3;
@@ -338,16 +573,17 @@
             allItems:(NSMutableArray<HADashboardConfigItem *> *)allItems {
 
     NSString *cardType = card[@"type"];
+    HALovelaceCardKind kind = [self cardKindForType:cardType];
 
     // Heading cards have no entity — skip them here. They are handled by the
     // grid unwrapping logic below which merges heading info into the first
     // content card. Headings cannot be standalone items because they break
     // sub-grid packing (e.g., thermostat(9) + vacuum(3) need to be on the
     // same row, which requires their headings to be merged into the same items).
-    if ([cardType isEqualToString:@"heading"]) return;
+    if (kind == HALovelaceCardKindHeading) return;
 
     // Markdown card: no entity, just content text
-    if ([cardType isEqualToString:@"markdown"]) {
+    if (kind == HALovelaceCardKindMarkdown) {
         HADashboardConfigSection *section = [[HADashboardConfigSection alloc] init];
         section.cardType = @"markdown";
         HADashboardConfigItem *item = [[HADashboardConfigItem alloc] init];
@@ -377,7 +613,7 @@
 
     // Conditional cards: unwrap the inner card and attach conditions.
     // The inner card is shown only when all conditions are met (checked at display time).
-    if ([cardType isEqualToString:@"conditional"]) {
+    if (kind == HALovelaceCardKindConditional) {
         NSDictionary *innerCard = card[@"card"];
         NSArray *conditions = card[@"conditions"];
         if ([innerCard isKindOfClass:[NSDictionary class]]) {
@@ -412,9 +648,7 @@
     // Grid cards often wrap [heading, content] pairs — extract heading as title
     // and recursively process the content sub-cards.
     // The grid card's own grid_options.columns determines the sub-grid span of its children.
-    if ([cardType isEqualToString:@"grid"] ||
-        [cardType isEqualToString:@"horizontal-stack"] ||
-        [cardType isEqualToString:@"vertical-stack"]) {
+    if (kind == HALovelaceCardKindStack) {
         NSArray *subCards = card[@"cards"];
         if ([subCards isKindOfClass:[NSArray class]] && subCards.count > 0) {
             // Read this grid card's column configuration to determine child spans.
@@ -668,169 +902,207 @@
     // - "entities": standard entities card
     // - "custom:badge-card": compact badge row
     // - "custom:mini-graph-card": graph card with optional secondary entity values
-    BOOL isComposite = [cardType isEqualToString:@"entities"] || [cardType isEqualToString:@"entity-filter"];
+    BOOL isComposite = NO;
     NSString *compositeType = @"entities";
-    if ([cardType isEqualToString:@"entity-filter"]) {
-        // Entity-filter card: store state_filter conditions for runtime filtering
-        NSMutableDictionary *filterProps = section.customProperties
-            ? [section.customProperties mutableCopy]
-            : [NSMutableDictionary dictionary];
-        NSArray *stateFilter = card[@"state_filter"];
-        if ([stateFilter isKindOfClass:[NSArray class]]) {
-            filterProps[@"state_filter"] = stateFilter;
-        }
-        NSDictionary *cardConfig = card[@"card"];
-        if ([cardConfig isKindOfClass:[NSDictionary class]]) {
-            if ([cardConfig[@"type"] isKindOfClass:[NSString class]]) {
-                filterProps[@"inner_card_type"] = cardConfig[@"type"];
+    switch (kind) {
+        case HALovelaceCardKindEntities:
+            isComposite = YES;
+            break;
+        case HALovelaceCardKindEntityFilter: {
+            isComposite = YES;
+            // Entity-filter card: store state_filter conditions for runtime filtering
+            NSMutableDictionary *filterProps = section.customProperties
+                ? [section.customProperties mutableCopy]
+                : [NSMutableDictionary dictionary];
+            NSArray *stateFilter = card[@"state_filter"];
+            if ([stateFilter isKindOfClass:[NSArray class]]) {
+                filterProps[@"state_filter"] = stateFilter;
             }
-        }
-        section.customProperties = [filterProps copy];
-    } else if ([cardType containsString:@"badge"]) {
-        isComposite = YES;
-        compositeType = @"badges";
-    } else if ([cardType isEqualToString:@"glance"]) {
-        isComposite = YES;
-        compositeType = @"glance";
-        // Store per-entity configs (name, icon, show_state, tap_action, etc.)
-        NSArray *rawEntities = card[@"entities"];
-        if ([rawEntities isKindOfClass:[NSArray class]]) {
-            NSMutableArray *entityConfigs = [NSMutableArray arrayWithCapacity:rawEntities.count];
-            for (id entry in rawEntities) {
-                if ([entry isKindOfClass:[NSDictionary class]]) {
-                    [entityConfigs addObject:entry];
-                } else if ([entry isKindOfClass:[NSString class]]) {
-                    [entityConfigs addObject:@{@"entity": entry}];
+            NSDictionary *cardConfig = card[@"card"];
+            if ([cardConfig isKindOfClass:[NSDictionary class]]) {
+                if ([cardConfig[@"type"] isKindOfClass:[NSString class]]) {
+                    filterProps[@"inner_card_type"] = cardConfig[@"type"];
                 }
             }
-            NSMutableDictionary *props = section.customProperties
-                ? [section.customProperties mutableCopy]
-                : [NSMutableDictionary dictionary];
-            props[@"entityConfigs"] = [entityConfigs copy];
-            section.customProperties = [props copy];
-        }
-    } else if ([cardType containsString:@"mini-graph"]) {
-        // Render as a single composite graph card with all entities
-        isComposite = YES;
-        compositeType = @"graph";
-        if (!section.title && [card[@"name"] isKindOfClass:[NSString class]]) {
-            section.title = card[@"name"];
-        }
-        // Pass mini-graph-card config to section customProperties for rendering
-        NSMutableDictionary *graphProps = [NSMutableDictionary dictionary];
-        if ([card[@"show"] isKindOfClass:[NSDictionary class]]) {
-            graphProps[@"show"] = card[@"show"];
+            section.customProperties = [filterProps copy];
+            break;
         }
-        if ([card[@"color_thresholds"] isKindOfClass:[NSArray class]]) {
-            graphProps[@"color_thresholds"] = card[@"color_thresholds"];
+        case HALovelaceCardKindBadges: {
+            isComposite = YES;
+            compositeType = @"badges";
+            break;
         }
-        if ([card[@"icon"] isKindOfClass:[NSString class]]) {
-            graphProps[@"graphIcon"] = card[@"icon"];
-        }
-        if ([card[@"line_width"] isKindOfClass:[NSNumber class]]) {
-            graphProps[@"line_width"] = card[@"line_width"];
-        }
-        if ([card[@"lower_bound"] isKindOfClass:[NSNumber class]]) {
-            graphProps[@"lower_bound"] = card[@"lower_bound"];
+        case HALovelaceCardKindGlance: {
+            isComposite = YES;
+            compositeType = @"glance";
+            // Store per-entity configs (name, icon, show_state, tap_action, etc.)
+            NSArray *rawEntities = card[@"entities"];
+            if ([rawEntities isKindOfClass:[NSArray class]]) {
+                NSMutableArray *entityConfigs = [NSMutableArray arrayWithCapacity:rawEntities.count];
+                for (id entry in rawEntities) {
+                    if ([entry isKindOfClass:[NSDictionary class]]) {
+                        [entityConfigs addObject:entry];
+                    } else if ([entry isKindOfClass:[NSString class]]) {
+                        [entityConfigs addObject:@{@"entity": entry}];
+                    }
+                }
+                NSMutableDictionary *props = section.customProperties
+                    ? [section.customProperties mutableCopy]
+                    : [NSMutableDictionary dictionary];
+                props[@"entityConfigs"] = [entityConfigs copy];
+                section.customProperties = [props copy];
+            }
+            break;
         }
-        // Store per-entity display flags (show_state, show_graph, name, color)
-        NSArray *rawEntities = card[@"entities"];
-        if ([rawEntities isKindOfClass:[NSArray class]]) {
-            NSMutableArray *entityConfigs = [NSMutableArray arrayWithCapacity:rawEntities.count];
-            for (id entry in rawEntities) {
-                if ([entry isKindOfClass:[NSDictionary class]]) {
-                    NSMutableDictionary *cfg = [NSMutableDictionary dictionary];
-                    NSDictionary *dict = (NSDictionary *)entry;
-                    if (dict[@"entity"]) cfg[@"entity"] = dict[@"entity"];
-                    if (dict[@"show_state"]) cfg[@"show_state"] = dict[@"show_state"];
-                    if (dict[@"show_graph"]) cfg[@"show_graph"] = dict[@"show_graph"];
-                    if (dict[@"name"]) cfg[@"name"] = dict[@"name"];
-                    if (dict[@"color"]) cfg[@"color"] = dict[@"color"];
-                    [entityConfigs addObject:[cfg copy]];
-                } else if ([entry isKindOfClass:[NSString class]]) {
-                    [entityConfigs addObject:@{@"entity": entry}];
+        case HALovelaceCardKindMiniGraph: {
+            // Render as a single composite graph card with all entities
+            isComposite = YES;
+            compositeType = @"graph";
+            if (!section.title && [card[@"name"] isKindOfClass:[NSString class]]) {
+                section.title = card[@"name"];
+            }
+            // Pass mini-graph-card config to section customProperties for rendering
+            NSMutableDictionary *graphProps = [NSMutableDictionary dictionary];
+            if ([card[@"show"] isKindOfClass:[NSDictionary class]]) {
+                graphProps[@"show"] = card[@"show"];
+            }
+            if ([card[@"color_thresholds"] isKindOfClass:[NSArray class]]) {
+                graphProps[@"color_thresholds"] = card[@"color_thresholds"];
+            }
+            if ([card[@"icon"] isKindOfClass:[NSString class]]) {
+                graphProps[@"graphIcon"] = card[@"icon"];
+            }
+            if ([card[@"line_width"] isKindOfClass:[NSNumber class]]) {
+                graphProps[@"line_width"] = card[@"line_width"];
+            }
+            if ([card[@"lower_bound"] isKindOfClass:[NSNumber class]]) {
+                graphProps[@"lower_bound"] = card[@"lower_bound"];
+            }
+            // Store per-entity display flags (show_state, show_graph, name, color)
+            NSArray *rawEntities = card[@"entities"];
+            if ([rawEntities isKindOfClass:[NSArray class]]) {
+                NSMutableArray *entityConfigs = [NSMutableArray arrayWithCapacity:rawEntities.count];
+                for (id entry in rawEntities) {
+                    if ([entry isKindOfClass:[NSDictionary class]]) {
+                        NSMutableDictionary *cfg = [NSMutableDictionary dictionary];
+                        NSDictionary *dict = (NSDictionary *)entry;
+                        if (dict[@"entity"]) cfg[@"entity"] = dict[@"entity"];
+                        if (dict[@"show_state"]) cfg[@"show_state"] = dict[@"show_state"];
+                        if (dict[@"show_graph"]) cfg[@"show_graph"] = dict[@"show_graph"];
+                        if (dict[@"name"]) cfg[@"name"] = dict[@"name"];
+                        if (dict[@"color"]) cfg[@"color"] = dict[@"color"];
+                        [entityConfigs addObject:[cfg copy]];
+                    } else if ([entry isKindOfClass:[NSString class]]) {
+                        [entityConfigs addObject:@{@"entity": entry}];
+                    }
                 }
+                graphProps[@"entityConfigs"] = [entityConfigs copy];
+            }
+            if (graphProps.count > 0) {
+                section.customProperties = [graphProps copy];
             }
-            graphProps[@"entityConfigs"] = [entityConfigs copy];
+            break;
         }
-        if (graphProps.count > 0) {
-            section.customProperties = [graphProps copy];
+        case HALovelaceCardKindHistoryGraph: {
+            // HA built-in history-graph / statistics-graph: multi-entity graph
+            isComposite = YES;
+            compositeType = @"graph";
+            // history-graph uses "title" (already captured in sectionTitle/section.title)
+            NSMutableDictionary *graphProps = [NSMutableDictionary dictionary];
+            // hours_to_show determines the time window (default 24)
+            NSNumber *hours = card[@"hours_to_show"];
+            if ([hours isKindOfClass:[NSNumber class]]) {
+                graphProps[@"hours_to_show"] = hours;
+            }
+            if ([cardType isEqualToString:@"statistics-graph"]) {
+                // Drawn from recorder long-term statistics, not raw history
+                graphProps[@"statistics"] = @YES;
+                NSNumber *days = card[@"days_to_show"];
+                if (!graphProps[@"hours_to_show"]) {
+                    graphProps[@"hours_to_show"] = @([days isKindOfClass:[NSNumber class]] ? [days integerValue] * 24 : 30 * 24);
+                }
+                if ([card[@"period"] isKindOfClass:[NSString class]]) graphProps[@"period"] = card[@"period"];
+                id statTypes = card[@"stat_types"];
+                if ([statTypes isKindOfClass:[NSString class]]) statTypes = @[statTypes];
+                if ([statTypes isKindOfClass:[NSArray class]]) graphProps[@"stat_types"] = statTypes;
+            }
+            // Store per-entity name overrides
+            NSArray *rawEntities = card[@"entities"];
+            if ([rawEntities isKindOfClass:[NSArray class]]) {
+                NSMutableArray *entityConfigs = [NSMutableArray arrayWithCapacity:rawEntities.count];
+                for (id entry in rawEntities) {
+                    if ([entry isKindOfClass:[NSDictionary class]]) {
+                        NSMutableDictionary *cfg = [NSMutableDictionary dictionary];
+                        NSDictionary *dict = (NSDictionary *)entry;
+                        if (dict[@"entity"]) cfg[@"entity"] = dict[@"entity"];
+                        if (dict[@"name"]) cfg[@"name"] = dict[@"name"];
+                        [entityConfigs addObject:[cfg copy]];
+                    } else if ([entry isKindOfClass:[NSString class]]) {
+                        [entityConfigs addObject:@{@"entity": entry}];
+                    }
+                }
+                graphProps[@"entityConfigs"] = [entityConfigs copy];
+            }
+            if (graphProps.count > 0) {
+                section.customProperties = [graphProps copy];
+            }
+            break;
         }
-    } else if ([cardType isEqualToString:@"history-graph"] ||
-               [cardType isEqualToString:@"statistics-graph"]) {
-        // HA built-in history-graph / statistics-graph: multi-entity graph
-        isComposite = YES;
-        compositeType = @"graph";
-        // history-graph uses "title" (already captured in sectionTitle/section.title)
-        NSMutableDictionary *graphProps = [NSMutableDictionary dictionary];
-        // hours_to_show determines the time window (default 24)
-        NSNumber *hours = card[@"hours_to_show"];
-        if ([hours isKindOfClass:[NSNumber class]]) {
-            graphProps[@"hours_to_show"] = hours;
+        case HALovelaceCardKindMushroomChips: {
+            // Render chips as a compact badge row (no name labels, smaller sizing)
+            isComposite = YES;
+            compositeType = @"badges";
+            section.customProperties = @{@"chipStyle": @YES};
+            break;
         }
-        // Store per-entity name overrides
-        NSArray *rawEntities = card[@"entities"];
-        if ([rawEntities isKindOfClass:[NSArray class]]) {
-            NSMutableArray *entityConfigs = [NSMutableArray arrayWithCapacity:rawEntities.count];
-            for (id entry in rawEntities) {
-                if ([entry isKindOfClass:[NSDictionary class]]) {
-                    NSMutableDictionary *cfg = [NSMutableDictionary dictionary];
-                    NSDictionary *dict = (NSDictionary *)entry;
-                    if (dict[@"entity"]) cfg[@"entity"] = dict[@"entity"];
-                    if (dict[@"name"]) cfg[@"name"] = dict[@"name"];
-                    [entityConfigs addObject:[cfg copy]];
-                } else if ([entry isKindOfClass:[NSString class]]) {
-                    [entityConfigs addObject:@{@"entity": entry}];
-                }
+        case HALovelaceCardKindArea: {
+            // Area card: composite card showing area summary with toggles
+            isComposite = YES;
+            compositeType = @"area";
+            NSMutableDictionary *areaProps = [NSMutableDictionary dictionary];
+            if ([card[@"area"] isKindOfClass:[NSString class]]) areaProps[@"area_id"] = card[@"area"];
+            if ([card[@"image"] isKindOfClass:[NSString class]]) areaProps[@"image"] = card[@"image"];
+            if ([card[@"camera_image"] isKindOfClass:[NSString class]]) areaProps[@"camera_image"] = card[@"camera_image"];
+            if ([card[@"display_type"] isKindOfClass:[NSString class]]) areaProps[@"display_type"] = card[@"display_type"];
+            if (!section.title && areaProps[@"area_id"]) {
+                section.title = [[areaProps[@"area_id"] stringByReplacingOccurrencesOfString:@"_" withString:@" "] capitalizedString];
             }
-            graphProps[@"entityConfigs"] = [entityConfigs copy];
+            if (areaProps.count > 0) section.customProperties = [areaProps copy];
+            break;
         }
-        if (graphProps.count > 0) {
-            section.customProperties = [graphProps copy];
+        case HALovelaceCardKindPictureGlance: {
+            // Picture-glance card: image background with entity state overlays
+            isComposite = YES;
+            compositeType = @"picture-glance";
+            NSMutableDictionary *pgProps = [NSMutableDictionary dictionary];
+            if ([card[@"image"] isKindOfClass:[NSString class]]) pgProps[@"image"] = card[@"image"];
+            if ([card[@"camera_image"] isKindOfClass:[NSString class]]) pgProps[@"camera_image"] = card[@"camera_image"];
+            if ([card[@"camera_view"] isKindOfClass:[NSString class]]) pgProps[@"camera_view"] = card[@"camera_view"];
+            if ([card[@"state_image"] isKindOfClass:[NSDictionary class]]) pgProps[@"state_image"] = card[@"state_image"];
+            if ([card[@"title"] isKindOfClass:[NSString class]]) section.title = card[@"title"];
+            if (pgProps.count > 0) section.customProperties = [pgProps copy];
+            break;
         }
-    } else if ([cardType containsString:@"mushroom-chips"]) {
-        // Render chips as a compact badge row (no name labels, smaller sizing)
-        isComposite = YES;
-        compositeType = @"badges";
-        section.customProperties = @{@"chipStyle": @YES};
-    } else if ([cardType isEqualToString:@"area"]) {
-        // Area card: composite card showing area summary with toggles
-        isComposite = YES;
-        compositeType = @"area";
-        NSMutableDictionary *areaProps = [NSMutableDictionary dictionary];
-        if ([card[@"area"] isKindOfClass:[NSString class]]) areaProps[@"area_id"] = card[@"area"];
-        if ([card[@"image"] isKindOfClass:[NSString class]]) areaProps[@"image"] = card[@"image"];
-        if ([card[@"camera_image"] isKindOfClass:[NSString class]]) areaProps[@"camera_image"] = card[@"camera_image"];
-        if ([card[@"display_type"] isKindOfClass:[NSString class]]) areaProps[@"display_type"] = card[@"display_type"];
-        if (!section.title && areaProps[@"area_id"]) {
-            section.title = [[areaProps[@"area_id"] stringByReplacingOccurrencesOfString:@"_" withString:@" "] capitalizedString];
+        case HALovelaceCardKindMap: {
+            // Map card: shows entity locations
+            isComposite = YES;
+            compositeType = @"map";
+            NSMutableDictionary *mapProps = [NSMutableDictionary dictionary];
+            if ([card[@"default_zoom"] isKindOfClass:[NSNumber class]]) mapProps[@"default_zoom"] = card[@"default_zoom"];
+            if ([card[@"dark_mode"] isKindOfClass:[NSNumber class]]) mapProps[@"dark_mode"] = card[@"dark_mode"];
+            if ([card[@"aspect_ratio"] isKindOfClass:[NSString class]]) mapProps[@"aspect_ratio"] = card[@"aspect_ratio"];
+            // Not an HA option: render a cached static snapshot instead of a live map
+            if ([card[@"snapshot_mode"] isKindOfClass:[NSNumber class]]) mapProps[@"snapshot_mode"] = card[@"snapshot_mode"];
+            if ([card[@"title"] isKindOfClass:[NSString class]]) section.title = card[@"title"];
+            if (mapProps.count > 0) section.customProperties = [mapProps copy];
+            break;
         }
-        if (areaProps.count > 0) section.customProperties = [areaProps copy];
-    } else if ([cardType isEqualToString:@"picture-glance"]) {
-        // Picture-glance card: image background with entity state overlays
-        isComposite = YES;
-        compositeType = @"picture-glance";
-        NSMutableDictionary *pgProps = [NSMutableDictionary dictionary];
-        if ([card[@"image"] isKindOfClass:[NSString class]]) pgProps[@"image"] = card[@"image"];
-        if ([card[@"camera_image"] isKindOfClass:[NSString class]]) pgProps[@"camera_image"] = card[@"camera_image"];
-        if ([card[@"camera_view"] isKindOfClass:[NSString class]]) pgProps[@"camera_view"] = card[@"camera_view"];
-        if ([card[@"state_image"] isKindOfClass:[NSDictionary class]]) pgProps[@"state_image"] = card[@"state_image"];
-        if ([card[@"title"] isKindOfClass:[NSString class]]) section.title = card[@"title"];
-        if (pgProps.count > 0) section.customProperties = [pgProps copy];
-    } else if ([cardType isEqualToString:@"map"]) {
-        // Map card: shows entity locations
-        isComposite = YES;
-        compositeType = @"map";
-        NSMutableDictionary *mapProps = [NSMutableDictionary dictionary];
-        if ([card[@"default_zoom"] isKindOfClass:[NSNumber class]]) mapProps[@"default_zoom"] = card[@"default_zoom"];
-        if ([card[@"dark_mode"] isKindOfClass:[NSNumber class]]) mapProps[@"dark_mode"] = card[@"dark_mode"];
-        if ([card[@"aspect_ratio"] isKindOfClass:[NSString class]]) mapProps[@"aspect_ratio"] = card[@"aspect_ratio"];
-        if ([card[@"title"] isKindOfClass:[NSString class]]) section.title = card[@"title"];
-        if (mapProps.count > 0) section.customProperties = [mapProps copy];
+        default:
+            break;
     }
 
     // Entities card: parse per-entity action configs, special rows, show_header_toggle, scene chips
-    if ([cardType isEqualToString:@"entities"]) {
+    if (kind == HALovelaceCardKindEntities) {
         // Store raw entities array for special row type rendering (divider, section, weblink)
         NSArray *rawEntities = card[@"entities"];
         if ([rawEntities isKindOfClass:[NSArray class]]) {
@@ -1060,6 +1332,8 @@
             if ([card[@"state_color"] isKindOfClass:[NSNumber class]]) props[@"state_color"] = card[@"state_color"];
             if ([card[@"unit"] isKindOfClass:[NSString class]]) props[@"unit"] = card[@"unit"];
             if ([card[@"stat_type"] isKindOfClass:[NSString class]]) props[@"stat_type"] = card[@"stat_type"];
+            // Statistic card: calendar / fixed_period / rolling_window
+            if ([card[@"period"] isKindOfClass:[NSDictionary class]]) props[@"period"] = card[@"period"];
 
             // Clock-weather card: extract sensor overrides and display config
             if ([cardType containsString:@"clock-weather"]) {
@@ -1203,11 +1477,10 @@
 
     NSMutableArray<NSDictionary *> *results = [NSMutableArray array];
     NSString *type = card[@"type"];
+    HALovelaceCardKind kind = [self cardKindForType:type];
 
     // Recursive: horizontal-stack, vertical-stack, grid
-    if ([type isEqualToString:@"horizontal-stack"] ||
-        [type isEqualToString:@"vertical-stack"] ||
-        [type isEqualToString:@"grid"]) {
+    if (kind == HALovelaceCardKindStack) {
         NSArray *subCards = card[@"cards"];
         if ([subCards isKindOfClass:[NSArray class]]) {
             for (NSDictionary *subCard in subCards) {
@@ -1218,7 +1491,7 @@
     }
 
     // Conditional card
-    if ([type isEqualToString:@"conditional"]) {
+    if (kind == HALovelaceCardKindConditional) {
         NSDictionary *innerCard = card[@"card"];
         if ([innerCard isKindOfClass:[NSDictionary class]]) {
             [results addObjectsFromArray:[self extractEntitiesFromCard:innerCard]];
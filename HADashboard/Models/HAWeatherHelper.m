@@ -1,7 +1,4 @@
 #import "HAWeatherHelper.h"
-#import "HALog.h"
-#import "HAEntity.h"
-#import "HAConnectionManager.h"
 
 @implementation HAWeatherHelper
 
@@ -34,67 +31,4 @@
     return iconName ?: @"weather-cloudy";
 }
 
-#pragma mark - Forecast Fetch
-
-+ (void)fetchForecastForEntity:(HAEntity *)entity
-                    completion:(void(^)(NSArray *forecast, NSError *error))completion {
-    if (!entity || !completion) return;
-
-    // First try legacy entity attributes path (pre-2023.9 HA)
-    NSArray *legacyForecast = [entity weatherForecast];
-    if (legacyForecast.count > 0) {
-        if ([NSThread isMainThread]) {
-            completion(legacyForecast, nil);
-        } else {
-            dispatch_async(dispatch_get_main_queue(), ^{
-                completion(legacyForecast, nil);
-            });
-        }
-        return;
-    }
-
-    // Modern HA: call weather.get_forecasts service with return_response
-    NSDictionary *command = @{
-        @"type": @"call_service",
-        @"domain": @"weather",
-        @"service": @"get_forecasts",
-        @"target": @{@"entity_id": entity.entityId},
-        @"service_data": @{@"type": @"daily"},
-        @"return_response": @YES
-    };
-
-    NSString *currentEntityId = entity.entityId;
-
-    [[HAConnectionManager sharedManager] sendCommand:command completion:^(id result, NSError *error) {
-        if (error) {
-            HALogE(@"weather", @"Forecast fetch failed: %@", error.localizedDescription);
-            if (completion) completion(nil, error);
-            return;
-        }
-
-        // Response format: { "response": { "weather.entity_id": { "forecast": [...] } } }
-        NSArray *forecast = nil;
-        if ([result isKindOfClass:[NSDictionary class]]) {
-            NSDictionary *response = result[@"response"];
-            if ([response isKindOfClass:[NSDictionary class]]) {
-                for (NSString *key in response) {
-                    NSDictionary *entityForecast = response[key];
-                    if ([entityForecast isKindOfClass:[NSDictionary class]]) {
-                        forecast = entityForecast[@"forecast"];
-                        if ([forecast isKindOfClass:[NSArray class]]) break;
-                    }
-                }
-            }
-            if (!forecast) forecast = result[@"forecast"];
-        }
-
-        if ([forecast isKindOfClass:[NSArray class]] && forecast.count > 0) {
-            if (completion) completion(forecast, nil);
-        } else {
-            HALogW(@"weather", @"No forecast data in response: %@", result);
-            if (completion) completion(nil, nil);
-        }
-    }];
-}
-
 @end
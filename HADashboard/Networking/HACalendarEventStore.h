@@ -0,0 +1,69 @@
+#import <Foundation/Foundation.h>
+
+/// One event of a calendar entity.
+@interface HACalendarEvent : NSObject
+/// Calendar entity the event belongs to
+@property (nonatomic, copy) NSString *entityId;
+@property (nonatomic, copy) NSString *summary;
+@property (nonatomic, strong) NSDate *startDate;
+@property (nonatomic, strong) NSDate *endDate;
+@property (nonatomic, assign) BOOL allDay;
+@property (nonatomic, copy) NSString *location;
+@end
+
+/// Posted on main when a scheduled refresh changes a calendar's events.
+/// userInfo: @{@"entity_id": NSString}
+extern NSString *const HACalendarEventStoreDidUpdateNotification;
+
+/// Calendar events shared by every calendar card, cached per calendar and
+/// date range. A range that was fetched also answers every range inside it,
+/// so a week is served from its month. Calendars are fetched concurrently
+/// (GET /api/calendars/<entity_id>) and merged. Ranges in use (read or shown
+/// by a registered card) are refreshed every few minutes and on reconnect,
+/// not on every cell reconfigure.
+/// Main thread only.
+@interface HACalendarEventStore : NSObject
+
++ (instancetype)sharedStore;
+
+/// Cached events of all calendars in [startDate, endDate), sorted by start,
+/// or nil unless every calendar has the range cached. Never fetches; stale
+/// ranges are returned too.
+- (NSArray<HACalendarEvent *> *)cachedEventsForCalendars:(NSArray<NSString *> *)entityIds
+                                               startDate:(NSDate *)startDate
+                                                 endDate:(NSDate *)endDate;
+
+/// Fetch the calendars whose range is missing or stale, then call completion
+/// on main with the merged events. Cards showing the same range share one
+/// request per calendar. While offline the cached events are returned;
+/// error is set only if there are none.
+- (void)loadEventsForCalendars:(NSArray<NSString *> *)entityIds
+                     startDate:(NSDate *)startDate
+                       endDate:(NSDate *)endDate
+                    completion:(void (^)(NSArray<HACalendarEvent *> *events, NSError *error))completion;
+
+/// Warm the cache for a range the user is likely to navigate to next.
+- (void)prefetchEventsForCalendars:(NSArray<NSString *> *)entityIds
+                         startDate:(NSDate *)startDate
+                           endDate:(NSDate *)endDate;
+
+/// Mark [startDate, endDate) of the calendars as shown by owner (a card),
+/// replacing what owner showed before. Shown ranges keep refreshing while
+/// their events are unchanged. Held weakly; ends with unregister or dealloc.
+- (void)registerInterestInCalendars:(NSArray<NSString *> *)entityIds
+                           startDate:(NSDate *)startDate
+                             endDate:(NSDate *)endDate
+                            forOwner:(id)owner;
+- (void)unregisterInterestForOwner:(id)owner;
+
+/// Drop every cached range.
+- (void)clearCache;
+
+#pragma mark - Parsing
+
+/// Events of a /api/calendars response, sorted by start. start/end are
+/// {dateTime} or {date} (all day) objects, or plain strings of either form.
+/// Events without a parseable start are dropped.
++ (NSArray<HACalendarEvent *> *)eventsFromResponse:(NSArray *)rawEvents entityId:(NSString *)entityId;
+
+@end
@@ -0,0 +1,415 @@
+#import "HACalendarEventStore.h"
+#import "HACacheManager.h"
+#import "HAConnectionManager.h"
+#import "HADateUtils.h"
+#import "HALog.h"
+
+NSString *const HACalendarEventStoreDidUpdateNotification = @"HACalendarEventStoreDidUpdate";
+
+/// A range older than this is refetched, on the next load or refresh tick.
+static const NSTimeInterval kRefreshInterval = 300.0;
+/// Ranges no card has asked for or shown in this long are dropped instead of refreshed.
+static const NSTimeInterval kIdleExpiry = 900.0;
+static const NSUInteger kMaxRanges = 64;
+
+@implementation HACalendarEvent
+@end
+
+/// Events of one calendar over [start, end).
+@interface HACalendarRange : NSObject
+@property (nonatomic, copy) NSString *entityId;
+@property (nonatomic, assign) NSTimeInterval start;
+@property (nonatomic, assign) NSTimeInterval end;
+/// The response as received, to tell whether a refresh changed anything
+@property (nonatomic, copy) NSArray *rawEvents;
+@property (nonatomic, copy) NSArray<HACalendarEvent *> *events;
+@property (nonatomic, assign) NSTimeInterval fetchedAt;
+@property (nonatomic, assign) NSTimeInterval usedAt;
+@end
+
+@implementation HACalendarRange
+@end
+
+@interface HACalendarEventStore ()
+/// "entity_id|start|end" -> range
+@property (nonatomic, strong) NSMutableDictionary<NSString *, HACalendarRange *> *ranges;
+/// server|range key -> blocks waiting on the same in-flight fetch
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSMutableArray *> *inFlight;
+/// Card (weak) -> @{@"calendars", @"start", @"end"} it is showing; their
+/// ranges count as used on every refresh tick
+@property (nonatomic, strong) NSMapTable<id, NSDictionary *> *interests;
+@property (nonatomic, strong) NSTimer *refreshTimer;
+/// Server the cached ranges belong to
+@property (nonatomic, copy) NSString *serverURL;
+@end
+
+@implementation HACalendarEventStore
+
++ (instancetype)sharedStore {
+    static HACalendarEventStore *instance = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        instance = [[HACalendarEventStore alloc] init];
+    });
+    return instance;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _ranges = [NSMutableDictionary dictionary];
+        _inFlight = [NSMutableDictionary dictionary];
+        _interests = [NSMapTable weakToStrongObjectsMapTable];
+
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(connectionDidConnect:)
+                                                     name:HAConnectionManagerDidConnectNotification
+                                                   object:nil];
+    }
+    return self;
+}
+
+#pragma mark - Public API
+
+- (NSArray<HACalendarEvent *> *)cachedEventsForCalendars:(NSArray<NSString *> *)entityIds
+                                               startDate:(NSDate *)startDate
+                                                 endDate:(NSDate *)endDate {
+    if (entityIds.count == 0 || !startDate || !endDate) return nil;
+    [self checkServer];
+    return [self mergedEventsForCalendars:entityIds
+                                    start:[startDate timeIntervalSince1970]
+                                      end:[endDate timeIntervalSince1970]
+                               requireAll:YES];
+}
+
+- (void)loadEventsForCalendars:(NSArray<NSString *> *)entityIds
+                     startDate:(NSDate *)startDate
+                       endDate:(NSDate *)endDate
+                    completion:(void (^)(NSArray<HACalendarEvent *> *, NSError *))completion {
+    if (entityIds.count == 0 || !startDate || !endDate) {
+        if (completion) dispatch_async(dispatch_get_main_queue(), ^{ completion(@[], nil); });
+        return;
+    }
+    [self checkServer];
+    NSArray<NSString *> *calendars = [[NSOrderedSet orderedSetWithArray:entityIds] array];
+    NSTimeInterval start = [startDate timeIntervalSince1970];
+    NSTimeInterval end = [endDate timeIntervalSince1970];
+    NSTimeInterval now = [[NSDate date] timeIntervalSince1970];
+
+    __block NSError *firstError = nil;
+    dispatch_group_t group = dispatch_group_create();
+    for (NSString *entityId in calendars) {
+        HACalendarRange *range = [self rangeCoveringCalendar:entityId start:start end:end];
+        if (range && now - range.fetchedAt < kRefreshInterval) continue;
+
+        dispatch_group_enter(group);
+        [self fetchCalendar:entityId start:start end:end completion:^(NSError *error) {
+            if (error && !firstError) firstError = error;
+            dispatch_group_leave(group);
+        }];
+    }
+
+    dispatch_group_notify(group, dispatch_get_main_queue(), ^{
+        if (!completion) return;
+        NSArray *events = [self mergedEventsForCalendars:calendars start:start end:end requireAll:NO];
+        completion(events ?: @[], events ? nil : firstError);
+    });
+}
+
+- (void)prefetchEventsForCalendars:(NSArray<NSString *> *)entityIds
+                         startDate:(NSDate *)startDate
+                           endDate:(NSDate *)endDate {
+    [self loadEventsForCalendars:entityIds startDate:startDate endDate:endDate completion:nil];
+}
+
+- (void)registerInterestInCalendars:(NSArray<NSString *> *)entityIds
+                           startDate:(NSDate *)startDate
+                             endDate:(NSDate *)endDate
+                            forOwner:(id)owner {
+    if (!owner) return;
+    if (entityIds.count == 0 || !startDate || !endDate) {
+        [self.interests removeObjectForKey:owner];
+        return;
+    }
+    [self.interests setObject:@{@"calendars": [entityIds copy],
+                                @"start": @([startDate timeIntervalSince1970]),
+                                @"end": @([endDate timeIntervalSince1970])}
+                       forKey:owner];
+}
+
+- (void)unregisterInterestForOwner:(id)owner {
+    if (owner) [self.interests removeObjectForKey:owner];
+}
+
+- (void)clearCache {
+    [self.ranges removeAllObjects];
+    [self.refreshTimer invalidate];
+    self.refreshTimer = nil;
+}
+
+#pragma mark - Cache
+
+- (NSString *)keyForCalendar:(NSString *)entityId start:(NSTimeInterval)start end:(NSTimeInterval)end {
+    return [NSString stringWithFormat:@"%@|%.0f|%.0f", entityId, start, end];
+}
+
+/// Ranges are cached per server; a server switch starts over.
+- (void)checkServer {
+    NSString *serverURL = [HACacheManager sharedManager].serverURL;
+    if (!serverURL || [serverURL isEqualToString:self.serverURL]) return;
+    if (self.serverURL) [self clearCache];
+    self.serverURL = serverURL;
+}
+
+/// The freshest cached range of entityId containing [start, end), or nil.
+- (HACalendarRange *)rangeCoveringCalendar:(NSString *)entityId start:(NSTimeInterval)start end:(NSTimeInterval)end {
+    HACalendarRange *best = nil;
+    for (HACalendarRange *range in self.ranges.allValues) {
+        if (![range.entityId isEqualToString:entityId]) continue;
+        if (range.start > start || range.end < end) continue;
+        if (!best || range.fetchedAt > best.fetchedAt) best = range;
+    }
+    return best;
+}
+
+- (NSArray<HACalendarEvent *> *)mergedEventsForCalendars:(NSArray<NSString *> *)entityIds
+                                                   start:(NSTimeInterval)start
+                                                     end:(NSTimeInterval)end
+                                              requireAll:(BOOL)requireAll {
+    NSTimeInterval now = [[NSDate date] timeIntervalSince1970];
+    NSMutableArray<HACalendarEvent *> *merged = [NSMutableArray array];
+    BOOL anyCached = NO;
+    for (NSString *entityId in [NSOrderedSet orderedSetWithArray:entityIds]) {
+        HACalendarRange *range = [self rangeCoveringCalendar:entityId start:start end:end];
+        if (!range) {
+            if (requireAll) return nil;
+            continue;
+        }
+        anyCached = YES;
+        range.usedAt = now;
+        BOOL exact = (range.start == start && range.end == end);
+        for (HACalendarEvent *event in range.events) {
+            if (!exact) {
+                NSTimeInterval eventStart = [event.startDate timeIntervalSince1970];
+                NSTimeInterval eventEnd = event.endDate ? [event.endDate timeIntervalSince1970] : eventStart;
+                if (eventStart >= end || (eventEnd <= start && eventStart < start)) continue;
+            }
+            [merged addObject:event];
+        }
+    }
+    if (!anyCached) return nil;
+
+    if (entityIds.count > 1) {
+        [merged sortWithOptions:NSSortStable usingComparator:^NSComparisonResult(HACalendarEvent *a, HACalendarEvent *b) {
+            return [a.startDate compare:b.startDate];
+        }];
+    }
+    return [merged copy];
+}
+
+/// Store a response. Returns YES if it replaced a range whose events differed.
+- (BOOL)storeRawEvents:(NSArray *)rawEvents forCalendar:(NSString *)entityId
+                 start:(NSTimeInterval)start end:(NSTimeInterval)end {
+    NSString *key = [self keyForCalendar:entityId start:start end:end];
+    HACalendarRange *old = self.ranges[key];
+    NSTimeInterval now = [[NSDate date] timeIntervalSince1970];
+
+    HACalendarRange *range = [[HACalendarRange alloc] init];
+    range.entityId = entityId;
+    range.start = start;
+    range.end = end;
+    range.rawEvents = rawEvents ?: @[];
+    range.fetchedAt = now;
+    range.usedAt = old ? old.usedAt : now;
+    // Unchanged: keep the parsed events, so cells can tell nothing moved
+    BOOL changed = old && ![old.rawEvents isEqualToArray:range.rawEvents];
+    range.events = (old && !changed) ? old.events
+                                     : [HACalendarEventStore eventsFromResponse:range.rawEvents entityId:entityId];
+    self.ranges[key] = range;
+
+    if (self.ranges.count > kMaxRanges) {
+        NSArray *byUse = [self.ranges.allValues sortedArrayUsingComparator:^NSComparisonResult(HACalendarRange *a, HACalendarRange *b) {
+            return a.usedAt < b.usedAt ? NSOrderedAscending : (a.usedAt > b.usedAt ? NSOrderedDescending : NSOrderedSame);
+        }];
+        for (NSUInteger i = 0; i < byUse.count - kMaxRanges; i++) {
+            HACalendarRange *evicted = byUse[i];
+            [self.ranges removeObjectForKey:[self keyForCalendar:evicted.entityId start:evicted.start end:evicted.end]];
+        }
+    }
+    [self scheduleRefresh];
+    return changed;
+}
+
+#pragma mark - Fetching
+
+- (void)fetchCalendar:(NSString *)entityId
+                start:(NSTimeInterval)start
+                  end:(NSTimeInterval)end
+           completion:(void (^)(NSError *error))completion {
+    // Keyed by server too: after a switch, a card must not wait on (and get
+    // nothing from) the previous server's fetch
+    NSString *serverURL = self.serverURL;
+    NSString *key = [NSString stringWithFormat:@"%@|%@", serverURL ?: @"",
+                     [self keyForCalendar:entityId start:start end:end]];
+    NSMutableArray *waiting = self.inFlight[key];
+    if (waiting) {
+        [waiting addObject:[completion copy]];
+        return;
+    }
+    self.inFlight[key] = [NSMutableArray arrayWithObject:[completion copy]];
+
+    HALogD(@"calendar", @"Fetching %@ for %.0f days", entityId, (end - start) / 86400.0);
+    [[HAConnectionManager sharedManager] fetchCalendarEventsForEntityId:entityId
+                                                                  start:[HACalendarEventStore isoStringForTime:start]
+                                                                    end:[HACalendarEventStore isoStringForTime:end]
+                                                             completion:^(NSArray *events, NSError *error) {
+        if (error) {
+            HALogW(@"calendar", @"Fetching %@ failed: %@", entityId, error.localizedDescription);
+        } else if (!serverURL || [serverURL isEqualToString:self.serverURL]) {
+            if ([self storeRawEvents:events forCalendar:entityId start:start end:end]) {
+                [[NSNotificationCenter defaultCenter] postNotificationName:HACalendarEventStoreDidUpdateNotification
+                                                                    object:self
+                                                                  userInfo:@{@"entity_id": entityId}];
+            }
+        } else {
+            error = [NSError errorWithDomain:@"HACalendarEventStore" code:-1
+                                    userInfo:@{NSLocalizedDescriptionKey: @"Server changed"}];
+        }
+
+        NSArray *blocks = self.inFlight[key];
+        [self.inFlight removeObjectForKey:key];
+        for (void (^block)(NSError *) in blocks) {
+            block(error);
+        }
+    }];
+}
+
+#pragma mark - Refresh
+
+- (void)scheduleRefresh {
+    if (self.refreshTimer) return;
+    self.refreshTimer = [NSTimer scheduledTimerWithTimeInterval:kRefreshInterval
+                                                         target:self
+                                                       selector:@selector(refreshTimerFired:)
+                                                       userInfo:nil
+                                                        repeats:YES];
+    self.refreshTimer.tolerance = 30.0;
+}
+
+- (void)refreshTimerFired:(NSTimer *)timer {
+    [self refreshStaleRanges];
+}
+
+- (void)connectionDidConnect:(NSNotification *)note {
+    // Events may have changed while the socket was down
+    [self refreshStaleRanges];
+}
+
+/// Drop ranges no card has used lately and refetch the stale rest. Ranges
+/// on screen count as used, so a wall panel keeps refreshing them.
+- (void)refreshStaleRanges {
+    [self checkServer];
+    NSTimeInterval now = [[NSDate date] timeIntervalSince1970];
+    for (NSDictionary *interest in self.interests.objectEnumerator) {
+        NSTimeInterval start = [interest[@"start"] doubleValue];
+        NSTimeInterval end = [interest[@"end"] doubleValue];
+        for (NSString *entityId in interest[@"calendars"]) {
+            [self rangeCoveringCalendar:entityId start:start end:end].usedAt = now;
+        }
+    }
+    for (NSString *key in self.ranges.allKeys) {
+        if (now - self.ranges[key].usedAt > kIdleExpiry) {
+            [self.ranges removeObjectForKey:key];
+        }
+    }
+    if (self.ranges.count == 0) {
+        [self.refreshTimer invalidate];
+        self.refreshTimer = nil;
+        return;
+    }
+    if (![HAConnectionManager sharedManager].isConnected) return;
+
+    for (HACalendarRange *range in self.ranges.allValues) {
+        // Tolerance lets the timer fire slightly before a range goes stale
+        if (now - range.fetchedAt < kRefreshInterval - 60.0) continue;
+        [self fetchCalendar:range.entityId start:range.start end:range.end completion:^(NSError *error) {}];
+    }
+}
+
+#pragma mark - Parsing
+
++ (NSString *)isoStringForTime:(NSTimeInterval)time {
+    static NSDateFormatter *fmt;
+    static dispatch_once_t fmtOnce;
+    dispatch_once(&fmtOnce, ^{
+        fmt = [[NSDateFormatter alloc] init];
+        fmt.dateFormat = @"yyyy-MM-dd'T'HH:mm:ss.000'Z'";
+        fmt.timeZone = [NSTimeZone timeZoneWithAbbreviation:@"UTC"];
+        fmt.locale = [[NSLocale alloc] initWithLocaleIdentifier:@"en_US_POSIX"];
+    });
+    return [fmt stringFromDate:[NSDate dateWithTimeIntervalSince1970:time]];
+}
+
+/// Parse a {dateTime} / {date} object or a plain string; sets *allDay for dates.
++ (NSDate *)dateFromEventTime:(id)value allDay:(BOOL *)allDay {
+    static NSDateFormatter *dateFmt;
+    static dispatch_once_t parseOnce;
+    dispatch_once(&parseOnce, ^{
+        dateFmt = [[NSDateFormatter alloc] init];
+        dateFmt.dateFormat = @"yyyy-MM-dd";
+        dateFmt.locale = [[NSLocale alloc] initWithLocaleIdentifier:@"en_US_POSIX"];
+    });
+
+    if ([value isKindOfClass:[NSDictionary class]]) {
+        NSDictionary *dict = value;
+        if ([dict[@"dateTime"] isKindOfClass:[NSString class]]) {
+            if (allDay) *allDay = NO;
+            return [HADateUtils dateFromISO8601String:dict[@"dateTime"]];
+        }
+        if ([dict[@"date"] isKindOfClass:[NSString class]]) {
+            if (allDay) *allDay = YES;
+            return [dateFmt dateFromString:dict[@"date"]];
+        }
+        return nil;
+    }
+    if ([value isKindOfClass:[NSString class]]) {
+        NSDate *date = [HADateUtils dateFromISO8601String:value];
+        if (date) {
+            if (allDay) *allDay = NO;
+            return date;
+        }
+        date = [dateFmt dateFromString:value];
+        if (date && allDay) *allDay = YES;
+        return date;
+    }
+    return nil;
+}
+
++ (NSArray<HACalendarEvent *> *)eventsFromResponse:(NSArray *)rawEvents entityId:(NSString *)entityId {
+    if (![rawEvents isKindOfClass:[NSArray class]]) return @[];
+
+    NSMutableArray<HACalendarEvent *> *events = [NSMutableArray arrayWithCapacity:rawEvents.count];
+    for (NSDictionary *raw in rawEvents) {
+        if (![raw isKindOfClass:[NSDictionary class]]) continue;
+
+        BOOL allDay = NO;
+        NSDate *startDate = [self dateFromEventTime:raw[@"start"] allDay:&allDay];
+        if (!startDate) continue;
+
+        HACalendarEvent *event = [[HACalendarEvent alloc] init];
+        event.entityId = entityId;
+        event.summary = [raw[@"summary"] isKindOfClass:[NSString class]] ? raw[@"summary"] : @"(No title)";
+        event.location = [raw[@"location"] isKindOfClass:[NSString class]] ? raw[@"location"] : nil;
+        event.startDate = startDate;
+        event.allDay = allDay;
+        event.endDate = [self dateFromEventTime:raw[@"end"] allDay:NULL];
+        [events addObject:event];
+    }
+
+    [events sortWithOptions:NSSortStable usingComparator:^NSComparisonResult(HACalendarEvent *a, HACalendarEvent *b) {
+        return [a.startDate compare:b.startDate];
+    }];
+    return events;
+}
+
+@end
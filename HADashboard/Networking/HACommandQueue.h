@@ -0,0 +1,67 @@
+#import <Foundation/Foundation.h>
+
+/// Ordering for queued WebSocket commands. Lower values are sent first.
+typedef NS_ENUM(NSInteger, HACommandPriority) {
+    HACommandPriorityUserAction = 0, // Service calls from taps/sliders — never wait for a slot
+    HACommandPriorityNormal,         // Camera stream requests, forecasts, confirmations
+    HACommandPriorityBulk,           // Logbook/history/statistics fetches
+};
+
+/// Error codes reported in the HAConnectionManager error domain.
+/// -1…-4 are used directly by HAConnectionManager.
+typedef NS_ENUM(NSInteger, HACommandErrorCode) {
+    HACommandErrorNotConnected = -1,
+    HACommandErrorServer       = -2,
+    HACommandErrorDisconnected = -3,
+    HACommandErrorTimedOut     = -5,
+};
+
+/// Default deadline for commands sent without an explicit timeout.
+extern const NSTimeInterval HACommandDefaultTimeout;
+
+/// Handle returned for each queued command. Cancelling drops the completion
+/// (it will never be called); a command already on the wire keeps its
+/// in-flight slot until the server answers or its deadline passes.
+@interface HACommandToken : NSObject
+@property (nonatomic, readonly, getter=isCancelled) BOOL cancelled;
+- (void)cancel;
+@end
+
+/// Bounded, prioritized in-flight tracking for WebSocket request/response
+/// commands. Every command carries a deadline measured from when it was
+/// enqueued, and all outstanding commands fail when the socket goes away, so
+/// completions can never leak or hang.
+///
+/// Main thread only (the connection manager delivers socket messages on main).
+@interface HACommandQueue : NSObject
+
+/// Sends a command on the wire and returns its message ID (<= 0 on failure).
+@property (nonatomic, copy) NSInteger (^sendBlock)(NSDictionary *command);
+
+/// Maximum commands awaiting a result at once (user actions excepted). Default 8.
+@property (nonatomic, assign) NSUInteger maxInFlight;
+
+/// Maximum bulk-priority commands awaiting a result at once. Default 3, so
+/// history/logbook fetches can never starve normal traffic.
+@property (nonatomic, assign) NSUInteger maxBulkInFlight;
+
+@property (nonatomic, readonly) NSUInteger inFlightCount;
+@property (nonatomic, readonly) NSUInteger queuedCount;
+
+/// Queue a command. The completion runs on the main queue exactly once with
+/// the result or an error (timeout, server error, disconnect) unless the
+/// token is cancelled first. timeout <= 0 uses HACommandDefaultTimeout.
+- (HACommandToken *)enqueueCommand:(NSDictionary *)command
+                          priority:(HACommandPriority)priority
+                           timeout:(NSTimeInterval)timeout
+                        completion:(void (^)(id result, NSError *error))completion;
+
+/// Route a "result" message to its command. Returns NO if the message ID is
+/// not one of ours (so the caller can handle it).
+- (BOOL)handleResultMessage:(NSDictionary *)message;
+
+/// Fail every queued and in-flight command (socket closed or replaced —
+/// message IDs restart on the next connection so nothing can carry over).
+- (void)failAllWithError:(NSError *)error;
+
+@end
@@ -0,0 +1,212 @@
+#import "HACommandQueue.h"
+#import "HALog.h"
+
+const NSTimeInterval HACommandDefaultTimeout = 30.0;
+
+static NSString *const kCommandErrorDomain = @"HAConnectionManager";
+
+@interface HACommandToken ()
+@property (nonatomic, readwrite, getter=isCancelled) BOOL cancelled;
+@property (nonatomic, copy) dispatch_block_t cancelHandler;
+@end
+
+@implementation HACommandToken
+
+- (void)cancel {
+    if (self.cancelled) return;
+    self.cancelled = YES;
+    dispatch_block_t handler = self.cancelHandler;
+    self.cancelHandler = nil;
+    if (handler) handler();
+}
+
+@end
+
+#pragma mark -
+
+/// One queued or in-flight command.
+@interface HACommandEntry : NSObject
+@property (nonatomic, copy) NSDictionary *command;
+@property (nonatomic, assign) HACommandPriority priority;
+@property (nonatomic, assign) NSTimeInterval timeout;
+@property (nonatomic, copy) void (^completion)(id result, NSError *error);
+@property (nonatomic, strong) HACommandToken *token;
+@property (nonatomic, assign) NSInteger messageId; // 0 while queued
+@property (nonatomic, assign) BOOL finished;
+@end
+
+@implementation HACommandEntry
+@end
+
+#pragma mark -
+
+@interface HACommandQueue ()
+/// One FIFO per priority level, indexed by HACommandPriority.
+@property (nonatomic, strong) NSArray<NSMutableArray<HACommandEntry *> *> *queues;
+@property (nonatomic, strong) NSMutableDictionary<NSNumber *, HACommandEntry *> *inFlight;
+@end
+
+@implementation HACommandQueue
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _queues = @[[NSMutableArray array], [NSMutableArray array], [NSMutableArray array]];
+        _inFlight = [NSMutableDictionary dictionary];
+        _maxInFlight = 8;
+        _maxBulkInFlight = 3;
+    }
+    return self;
+}
+
+- (NSUInteger)inFlightCount {
+    return self.inFlight.count;
+}
+
+- (NSUInteger)queuedCount {
+    NSUInteger count = 0;
+    for (NSArray *queue in self.queues) count += queue.count;
+    return count;
+}
+
+#pragma mark - Enqueue
+
+- (HACommandToken *)enqueueCommand:(NSDictionary *)command
+                          priority:(HACommandPriority)priority
+                           timeout:(NSTimeInterval)timeout
+                        completion:(void (^)(id, NSError *))completion {
+    if (priority < HACommandPriorityUserAction || priority > HACommandPriorityBulk) {
+        priority = HACommandPriorityNormal;
+    }
+
+    HACommandEntry *entry = [[HACommandEntry alloc] init];
+    entry.command = command;
+    entry.priority = priority;
+    entry.timeout = (timeout > 0) ? timeout : HACommandDefaultTimeout;
+    entry.completion = completion;
+    entry.token = [[HACommandToken alloc] init];
+
+    // Release the caller's completion (and whatever it captured) as soon as it's cancelled
+    __weak HACommandEntry *weakEntry = entry;
+    entry.token.cancelHandler = ^{
+        weakEntry.completion = nil;
+    };
+
+    // Deadline covers time spent waiting in the queue as well as on the wire
+    __weak typeof(self) weakSelf = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(entry.timeout * NSEC_PER_SEC)),
+                   dispatch_get_main_queue(), ^{
+        HACommandEntry *strongEntry = weakEntry;
+        if (!strongEntry || strongEntry.finished) return;
+        [weakSelf timeOutEntry:strongEntry];
+    });
+
+    [self.queues[priority] addObject:entry];
+    [self pump];
+    return entry.token;
+}
+
+#pragma mark - Dispatch
+
+- (NSUInteger)bulkInFlightCount {
+    NSUInteger count = 0;
+    for (HACommandEntry *entry in self.inFlight.allValues) {
+        if (entry.priority == HACommandPriorityBulk) count++;
+    }
+    return count;
+}
+
+/// Send as many queued commands as the in-flight limits allow, highest priority first.
+- (void)pump {
+    for (NSUInteger p = HACommandPriorityUserAction; p <= HACommandPriorityBulk; p++) {
+        NSMutableArray<HACommandEntry *> *queue = self.queues[p];
+        while (queue.count > 0) {
+            HACommandEntry *entry = queue.firstObject;
+            if (entry.finished || entry.token.isCancelled) {
+                entry.finished = YES;
+                [queue removeObjectAtIndex:0];
+                continue;
+            }
+
+            // User actions always go straight out; everything else respects the limits
+            if (p != HACommandPriorityUserAction) {
+                if (self.inFlight.count >= self.maxInFlight) return;
+                if (p == HACommandPriorityBulk && [self bulkInFlightCount] >= self.maxBulkInFlight) return;
+            }
+
+            [queue removeObjectAtIndex:0];
+            [self sendEntry:entry];
+        }
+    }
+}
+
+- (void)sendEntry:(HACommandEntry *)entry {
+    NSInteger msgId = self.sendBlock ? self.sendBlock(entry.command) : -1;
+    if (msgId <= 0) {
+        [self finishEntry:entry result:nil error:[NSError errorWithDomain:kCommandErrorDomain
+            code:HACommandErrorNotConnected userInfo:@{NSLocalizedDescriptionKey: @"WebSocket not connected"}]];
+        return;
+    }
+    entry.messageId = msgId;
+    self.inFlight[@(msgId)] = entry;
+}
+
+#pragma mark - Completion
+
+- (BOOL)handleResultMessage:(NSDictionary *)message {
+    NSNumber *key = @([message[@"id"] integerValue]);
+    HACommandEntry *entry = self.inFlight[key];
+    if (!entry) return NO;
+    [self.inFlight removeObjectForKey:key];
+
+    if ([message[@"success"] boolValue]) {
+        [self finishEntry:entry result:message[@"result"] error:nil];
+    } else {
+        NSDictionary *errDict = message[@"error"];
+        NSString *errMsg = [errDict isKindOfClass:[NSDictionary class]] ? errDict[@"message"] : @"Unknown error";
+        NSError *err = [NSError errorWithDomain:kCommandErrorDomain code:HACommandErrorServer
+            userInfo:@{NSLocalizedDescriptionKey: errMsg ?: @"Unknown error"}];
+        [self finishEntry:entry result:nil error:err];
+    }
+    [self pump];
+    return YES;
+}
+
+- (void)timeOutEntry:(HACommandEntry *)entry {
+    if (entry.messageId > 0) {
+        [self.inFlight removeObjectForKey:@(entry.messageId)];
+    } else {
+        [self.queues[entry.priority] removeObjectIdenticalTo:entry];
+    }
+    HALogW(@"conn", @"Command %@ timed out after %.0fs", entry.command[@"type"], entry.timeout);
+    [self finishEntry:entry result:nil error:[NSError errorWithDomain:kCommandErrorDomain
+        code:HACommandErrorTimedOut userInfo:@{NSLocalizedDescriptionKey: @"Request timed out"}]];
+    [self pump];
+}
+
+- (void)failAllWithError:(NSError *)error {
+    NSMutableArray<HACommandEntry *> *entries = [NSMutableArray arrayWithArray:self.inFlight.allValues];
+    [self.inFlight removeAllObjects];
+    for (NSMutableArray *queue in self.queues) {
+        [entries addObjectsFromArray:queue];
+        [queue removeAllObjects];
+    }
+    if (entries.count > 0) {
+        HALogD(@"conn", @"Failing %lu pending commands: %@", (unsigned long)entries.count, error.localizedDescription);
+    }
+    for (HACommandEntry *entry in entries) {
+        [self finishEntry:entry result:nil error:error];
+    }
+}
+
+- (void)finishEntry:(HACommandEntry *)entry result:(id)result error:(NSError *)error {
+    if (entry.finished) return;
+    entry.finished = YES;
+    void (^completion)(id, NSError *) = entry.completion;
+    entry.completion = nil;
+    if (completion && !entry.token.isCancelled) {
+        completion(result, error);
+    }
+}
+
+@end
@@ -1,4 +1,5 @@
 #import <Foundation/Foundation.h>
+#import "HACommandQueue.h"
 
 @class HAEntity;
 @class HAConnectionManager;
@@ -54,6 +55,13 @@ extern NSString *const HAConnectionManagerHADidStartNotification;              /
 /// Fetch Lovelace dashboard config. Pass nil for default dashboard.
 - (void)fetchLovelaceConfig:(NSString *)urlPath;
 
+/// Switch dashboards stale-while-revalidate: urlPath's cached config (if
+/// any) is delivered through the normal Lovelace callbacks before this
+/// returns, then fetched. The fetch delivers again only if the server's
+/// config differs from the cached one. Returns YES if a dashboard was
+/// delivered synchronously. Pass nil for the default dashboard.
+- (BOOL)switchToLovelaceDashboard:(NSString *)urlPath;
+
 /// Last fetched Lovelace dashboard
 @property (nonatomic, strong, readonly) HALovelaceDashboard *lovelaceDashboard;
 
@@ -72,14 +80,34 @@ extern NSString *const HAConnectionManagerHADidStartNotification;              /
 
 /// Send a WebSocket command and receive the result via completion handler.
 /// The completion block is called on the main queue with (result, error).
-- (void)sendCommand:(NSDictionary *)command
-         completion:(void (^)(id result, NSError *error))completion;
+/// Uses normal priority and HACommandDefaultTimeout. Returns nil if the
+/// WebSocket isn't authenticated (the completion has already been called).
+- (HACommandToken *)sendCommand:(NSDictionary *)command
+                     completion:(void (^)(id result, NSError *error))completion;
+
+/// Send a WebSocket command with an explicit priority and deadline. The
+/// completion fails with HACommandErrorTimedOut if no result arrives in time
+/// and with HACommandErrorDisconnected if the socket goes away first.
+/// Cancelling the returned token drops the completion.
+- (HACommandToken *)sendCommand:(NSDictionary *)command
+                       priority:(HACommandPriority)priority
+                        timeout:(NSTimeInterval)timeout
+                     completion:(void (^)(id result, NSError *error))completion;
 
 /// Render a Jinja template through the authenticated Home Assistant API.
 /// The completion is called on the main queue with rendered plain text.
 - (void)renderTemplate:(NSString *)templateString
             completion:(void (^)(NSString *rendered, NSError *error))completion;
 
+/// Events of one calendar entity in [startISO, endISO) through
+/// GET /api/calendars/<entity_id>. The completion is called on the main
+/// queue with the raw event array. Returns nil if not connected (the
+/// completion has then already been called with an error).
+- (NSURLSessionDataTask *)fetchCalendarEventsForEntityId:(NSString *)entityId
+                                                   start:(NSString *)startISO
+                                                     end:(NSString *)endISO
+                                              completion:(void (^)(NSArray *events, NSError *error))completion;
+
 /// Get a cached entity by ID
 - (HAEntity *)entityForId:(NSString *)entityId;
 
@@ -124,4 +152,23 @@ extern NSString *const HAConnectionManagerHADidStartNotification;              /
 /// Unsubscribe from a previously registered event subscription.
 - (void)unsubscribeFromEventWithId:(NSInteger)subscriptionId;
 
+/// Deep idle, for a dimmed kiosk screen: the state_changed subscription is
+/// replaced by a state trigger on wakeEntityIds only, so the server stops
+/// pushing every change. Updates that do arrive are applied and announced as
+/// usual. Calling again while idle retargets the trigger. Main thread only.
+- (void)enterDeepIdleWithWakeEntityIds:(NSSet<NSString *> *)wakeEntityIds;
+
+/// Leave deep idle: resubscribe to state_changed and catch up with one
+/// /api/states reconcile, which announces each entity that moved (or all
+/// states if much changed). completion runs on main once that has been
+/// applied, or right away if idle was not active or the socket is down.
+- (void)exitDeepIdleWithCompletion:(void (^)(void))completion;
+
+@property (nonatomic, readonly, getter=isDeepIdle) BOOL deepIdle;
+
+/// Handle a message exactly as if it had arrived on the WebSocket. Main
+/// thread only. Used by the demo load generator to drive the real
+/// state_changed pipeline without a server.
+- (void)injectWebSocketMessage:(NSDictionary *)message;
+
 @end
@@ -7,10 +7,16 @@
 #import "HALovelaceParser.h"
 #import "HAStrategyResolver.h"
 #import "HADemoDataProvider.h"
+#import "HADemoLoadGenerator.h"
 #import "HACacheManager.h"
 #import "HAEntityStateCache.h"
 #import "HADashboardConfigCache.h"
+#import "HARegistryCache.h"
+#import "HAServiceCallQueue.h"
+#import "HAOptimisticStateLedger.h"
+#import "HAWeatherForecastStore.h"
 #import "HALog.h"
+#import "HAPerfMonitor.h"
 
 NSString *const HAConnectionManagerDidConnectNotification           = @"HAConnectionManagerDidConnect";
 NSString *const HAConnectionManagerDidDisconnectNotification        = @"HAConnectionManagerDidDisconnect";
@@ -23,6 +29,14 @@ NSString *const HAConnectionManagerHADidStartNotification             = @"HAConn
 
 static const NSTimeInterval kReconnectBaseInterval = 2.0;
 static const NSTimeInterval kReconnectMaxInterval  = 60.0;
+static const NSTimeInterval kServiceCallTimeout    = 10.0;
+// Registries fetched this recently are reused on reconnect (registry-updated
+// events mark them stale sooner). Edits made while the socket was down can
+// go unnoticed for at most this long.
+static const NSTimeInterval kRegistryReuseInterval = 15 * 60.0;
+// Above this many changed entities a reconnect rebuilds the whole dashboard
+// instead of reloading cells one by one.
+static const NSUInteger kResumeMaxIncrementalUpdates = 50;
 
 @interface HAConnectionManager () <HAWebSocketClientDelegate>
 @property (nonatomic, strong) HAAPIClient *apiClient;
@@ -54,10 +68,22 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
 @property (nonatomic, assign, readwrite) BOOL registriesLoaded;
 @property (nonatomic, strong) id rawEntityRegistry; // stored for reprocessing after device registry
 @property (nonatomic, strong) id rawAreaRegistry;   // stored for floor-area mapping
-@property (nonatomic, strong) NSMutableDictionary<NSNumber *, void (^)(id, NSError *)> *pendingCompletions;
+@property (nonatomic, strong) id rawFloorRegistry;  // stored for the registry cache
+@property (nonatomic, assign) BOOL registriesChanged;    // a refresh returned something different
+@property (nonatomic, assign) BOOL registriesRefreshing; // refetching while the previous registries stay in use
+@property (nonatomic, assign) BOOL registriesStale;      // a *_registry_updated event arrived
+@property (nonatomic, strong) NSDate *registriesFetchedAt;
+@property (nonatomic, copy) NSString *parsedLovelaceKey; // dashboard path (@"" = default) whose plain config built lovelaceDashboard
+@property (nonatomic, assign) BOOL deliveredAllStates;   // full state snapshot delivered since the last intentional disconnect
+@property (nonatomic, strong) HACommandQueue *commandQueue;
+@property (nonatomic, strong) HAOptimisticStateLedger *optimisticLedger;
 @property (nonatomic, strong) NSMutableDictionary<NSNumber *, void (^)(NSDictionary *)> *eventHandlers; // subscriptionId -> handler
 @property (nonatomic, assign, readwrite) BOOL showingCachedData;
 @property (nonatomic, copy) NSString *lastConnectedServerURL; // detect server URL change
+@property (nonatomic, assign, readwrite, getter=isDeepIdle) BOOL deepIdle;
+@property (nonatomic, copy) NSArray<NSString *> *deepIdleWakeEntityIds;
+@property (nonatomic, assign) NSInteger stateSubscriptionId;     // state_changed subscribe_events
+@property (nonatomic, assign) NSInteger wakeTriggerSubscriptionId; // deep idle subscribe_trigger
 @end
 
 @implementation HAConnectionManager
@@ -75,8 +101,16 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
     self = [super init];
     if (self) {
         _entityStore = [NSMutableDictionary dictionary];
-        _pendingCompletions = [NSMutableDictionary dictionary];
         _eventHandlers = [NSMutableDictionary dictionary];
+        _commandQueue = [[HACommandQueue alloc] init];
+        __weak typeof(self) weakSelf = self;
+        _commandQueue.sendBlock = ^NSInteger(NSDictionary *command) {
+            return [weakSelf.wsClient sendCommand:command];
+        };
+        _optimisticLedger = [[HAOptimisticStateLedger alloc] init];
+        _optimisticLedger.revertHandler = ^(NSString *entityId, NSString *state, NSDictionary *attributes) {
+            [weakSelf revertEntityId:entityId toState:state attributes:attributes];
+        };
     }
     return self;
 }
@@ -107,6 +141,11 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
                 [self.entityStore removeAllObjects];
             }
             self.lovelaceDashboard = nil;
+            self.parsedLovelaceKey = nil;
+            self.deliveredAllStates = NO;
+            [self resetRegistries];
+            // Before the cache is rekeyed, so it drops the old server's file
+            [[HAWeatherForecastStore sharedStore] reset];
         }
         self.lastConnectedServerURL = serverURL;
         [HACacheManager sharedManager].serverURL = serverURL;
@@ -118,6 +157,9 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
     // Set up REST client
     self.apiClient = [[HAAPIClient alloc] initWithBaseURL:auth.restBaseURL token:auth.accessToken];
 
+    // Message IDs restart with the new socket, so nothing pending can carry over
+    [self.commandQueue failAllWithError:[self disconnectedError]];
+
     // Set up WebSocket client
     self.wsClient = [[HAWebSocketClient alloc] initWithURL:auth.webSocketURL token:auth.accessToken];
     self.wsClient.delegate = self;
@@ -130,6 +172,10 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
 
     NSString *serverURL = auth.serverURL;
     if (!serverURL) return NO;
+    if (self.lastConnectedServerURL && ![self.lastConnectedServerURL isEqualToString:serverURL]) {
+        [self resetRegistries];
+        [[HAWeatherForecastStore sharedStore] reset];
+    }
     [HACacheManager sharedManager].serverURL = serverURL;
     self.lastConnectedServerURL = serverURL;
 
@@ -148,15 +194,18 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
         loaded = YES;
     }
 
+    // Load cached registries (after states, which they annotate) so area
+    // grouping and strategy dashboards are complete on the first frame
+    if (!self.registriesLoaded) {
+        [self loadCachedRegistries];
+    }
+
     // Load cached dashboard config
-    NSString *dashboardPath = auth.selectedDashboardPath;
-    NSDictionary *cachedConfig = [[HADashboardConfigCache sharedCache] loadCachedConfigForDashboard:dashboardPath];
-    if (cachedConfig) {
-        self.lovelaceDashboard = [HALovelaceParser parseDashboardFromDictionary:cachedConfig];
-        if (self.lovelaceDashboard) {
-            HALogI(@"conn", @"Loaded cached dashboard config for instant launch");
-            loaded = YES;
-        }
+    HALovelaceDashboard *dashboard = [self cachedLovelaceDashboardForPath:auth.selectedDashboardPath];
+    if (dashboard) {
+        self.lovelaceDashboard = dashboard;
+        HALogI(@"conn", @"Loaded cached dashboard config for instant launch");
+        loaded = YES;
     }
 
     if (loaded) {
@@ -165,11 +214,58 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
     return loaded;
 }
 
+/// Parse dashboardPath's cached config, or nil if there is none. Sets
+/// parsedLovelaceKey so a revalidating fetch that returns the same config
+/// keeps the parsed dashboard. Strategy dashboards are resolved against the
+/// current entities and registries (cached ones before connect). Regular
+/// dashboards come from the parsed archive when it matches the config.
+- (HALovelaceDashboard *)cachedLovelaceDashboardForPath:(NSString *)dashboardPath {
+    HADashboardConfigCache *configCache = [HADashboardConfigCache sharedCache];
+    HALovelaceDashboard *parsed = [configCache loadParsedDashboardForDashboard:dashboardPath];
+    if (parsed) {
+        self.parsedLovelaceKey = dashboardPath ?: @"";
+        return parsed;
+    }
+
+    NSDictionary *cachedConfig = [configCache loadCachedConfigForDashboard:dashboardPath];
+    self.parsedLovelaceKey = nil;
+    if (!cachedConfig) return nil;
+
+    NSDictionary *strategy = cachedConfig[@"strategy"];
+    BOOL isStrategy = [strategy isKindOfClass:[NSDictionary class]];
+    HALovelaceDashboard *dashboard = nil;
+    if (isStrategy && self.registriesLoaded && [self allEntities].count > 0) {
+        dashboard = [HAStrategyResolver resolveDashboardWithStrategy:strategy
+                                                           entities:[self allEntities]
+                                                          areaNames:self.areaNames ?: @{}
+                                                      entityAreaMap:self.entityAreaMap ?: @{}
+                                                     deviceAreaMap:self.deviceAreaMap ?: @{}
+                                                             floors:self.floors
+                                                     entityRegistry:self.entityRegistryEntries];
+    }
+    if (!dashboard) {
+        dashboard = [HALovelaceParser parseDashboardFromDictionary:cachedConfig];
+    }
+    if (dashboard && !isStrategy) {
+        self.parsedLovelaceKey = dashboardPath ?: @"";
+        dashboard.configHash = [configCache configHashForDashboard:dashboardPath];
+        [configCache storeParsedDashboard:dashboard forDashboard:dashboardPath];
+    }
+    return dashboard;
+}
+
 - (void)loadDemoData {
     HALogI(@"conn", @"Loading demo data");
 
     HADemoDataProvider *demo = [HADemoDataProvider sharedProvider];
 
+    // Stress mode (launch arguments, see HADemoLoadProfile): swap in the
+    // synthetic entities and dashboard before they are copied below
+    HADemoLoadProfile *stressProfile = [HADemoLoadProfile profileFromUserDefaults];
+    if (stressProfile && !demo.loadGenerator) {
+        [demo loadStressDataWithProfile:stressProfile];
+    }
+
     // Populate entity store with demo entities
     @synchronized(self.entityStore) {
         [self.entityStore removeAllObjects];
@@ -239,16 +335,11 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
 
     // Clear event subscription handlers (subscriptions invalidated on disconnect)
     [self.eventHandlers removeAllObjects];
+    self.stateSubscriptionId = 0;
+    self.wakeTriggerSubscriptionId = 0;
 
     // Fail all pending completion handlers so callers don't hang indefinitely
-    NSDictionary<NSNumber *, void (^)(id, NSError *)> *pending = [self.pendingCompletions copy];
-    [self.pendingCompletions removeAllObjects];
-    NSError *disconnectError = [NSError errorWithDomain:@"HAConnectionManager" code:-3
-        userInfo:@{NSLocalizedDescriptionKey: @"Disconnected"}];
-    for (NSNumber *key in pending) {
-        void (^completion)(id, NSError *) = pending[key];
-        completion(nil, disconnectError);
-    }
+    [self.commandQueue failAllWithError:[self disconnectedError]];
     self.wsClient = nil;
     self.apiClient = nil;
     self.connected = NO;
@@ -256,16 +347,13 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
     // Keep entityStore and lovelaceDashboard in memory for cache-first launch.
     // They'll be replaced by fresh data on next connect. If the server URL
     // changes, connect() clears them.
+    // Registries are kept (they belong to the server, not the socket) and
+    // reused on the next connect while fresh; connect() drops them if the
+    // server URL changes.
     self.pendingStrategyConfig = nil;
     self.availableDashboards = nil;
-    self.areaNames = nil;
-    self.entityAreaMap = nil;
-    self.deviceAreaMap = nil;
-    self.floors = nil;
-    self.floorByAreaId = nil;
-    self.rawEntityRegistry = nil;
-    self.rawAreaRegistry = nil;
-    self.registriesLoaded = NO;
+    self.deliveredAllStates = NO;
+    self.registriesRefreshing = NO;
     self.areasLoaded = NO;
     self.entitiesRegistryLoaded = NO;
     self.devicesLoaded = NO;
@@ -279,17 +367,39 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
     self.floorRegistryMessageId = 0;
 }
 
+- (void)resetRegistries {
+    self.areaNames = nil;
+    self.entityAreaMap = nil;
+    self.deviceAreaMap = nil;
+    self.floors = nil;
+    self.floorByAreaId = nil;
+    self.rawEntityRegistry = nil;
+    self.rawAreaRegistry = nil;
+    self.rawFloorRegistry = nil;
+    self.registriesFetchedAt = nil;
+    self.registriesStale = NO;
+    self.registriesRefreshing = NO;
+    self.registriesLoaded = NO;
+}
+
 - (void)clearEntityStore {
     @synchronized(self.entityStore) {
         [self.entityStore removeAllObjects];
     }
     self.lovelaceDashboard = nil;
+    self.parsedLovelaceKey = nil;
     HALogI(@"conn", @"Entity store and dashboard cleared");
 }
 
 #pragma mark - Data
 
 - (void)fetchAllStates {
+    [self fetchAllStatesWithCompletion:nil];
+}
+
+/// completion runs on main once the result has been applied and announced,
+/// or after a failure.
+- (void)fetchAllStatesWithCompletion:(void (^)(void))completion {
     // Demo mode: entities are already in-memory, just re-deliver them
     if ([[HAAuthManager sharedManager] isDemoMode]) {
         NSDictionary *entities = [self allEntities];
@@ -298,36 +408,86 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
             postNotificationName:HAConnectionManagerDidReceiveAllStatesNotification
                           object:self
                         userInfo:@{@"entities": entities}];
+        if (completion) completion();
+        return;
+    }
+    if (!self.apiClient) {
+        if (completion) completion();
         return;
     }
-    if (!self.apiClient) return;
 
     [self.apiClient getStatesWithCompletion:^(id response, NSError *error) {
         if (error) {
             HALogE(@"conn", @"Failed to fetch states: %@", error);
+            if (completion) completion();
             return;
         }
 
-        if (![response isKindOfClass:[NSArray class]]) return;
+        if (![response isKindOfClass:[NSArray class]]) {
+            if (completion) completion();
+            return;
+        }
 
+        // Reconcile rather than replace: only entities whose state actually
+        // moved are touched, and entities gone from the server are dropped.
         NSArray *stateArray = (NSArray *)response;
+        NSMutableArray<HAEntity *> *changed = [NSMutableArray array];
+        BOOL membershipChanged = NO;
         @synchronized(self.entityStore) {
+            NSMutableSet<NSString *> *missing = [NSMutableSet setWithArray:self.entityStore.allKeys];
             for (NSDictionary *stateDict in stateArray) {
                 if (![stateDict isKindOfClass:[NSDictionary class]]) continue;
                 NSString *entityId = stateDict[@"entity_id"];
                 if (!entityId) continue;
+                [missing removeObject:entityId];
 
                 HAEntity *existing = self.entityStore[entityId];
                 if (existing) {
-                    [existing updateWithDictionary:stateDict];
+                    if ([self stateDict:stateDict differsFromEntity:existing]) {
+                        [existing updateWithDictionary:stateDict];
+                        [changed addObject:existing];
+                    }
                 } else {
                     HAEntity *entity = [[HAEntity alloc] initWithDictionary:stateDict];
                     self.entityStore[entityId] = entity;
+                    membershipChanged = YES;
                 }
             }
+            if (missing.count > 0) {
+                [self.entityStore removeObjectsForKeys:missing.allObjects];
+                membershipChanged = YES;
+            }
+        }
+        [self.optimisticLedger confirmAll];
+
+        // New entities need their registry fields and area; registries
+        // restored from cache may not be refetched if unchanged
+        if (membershipChanged && self.registriesLoaded) {
+            [self buildEntityAreaMap];
         }
 
         NSDictionary *snapshot = [self allEntities];
+        self.showingCachedData = NO;
+
+        // Resume after a dropped connection: the dashboard already shows
+        // this data, so reload just the cells that changed
+        if (self.deliveredAllStates && !membershipChanged && !self.pendingStrategyConfig &&
+            changed.count <= kResumeMaxIncrementalUpdates) {
+            HALogI(@"conn", @"REST /api/states resume — %lu of %lu entities changed",
+                   (unsigned long)changed.count, (unsigned long)snapshot.count);
+            if (changed.count > 0) {
+                [[HAEntityStateCache sharedCache] entitiesDidUpdate:snapshot];
+            }
+            for (HAEntity *entity in changed) {
+                [self.delegate connectionManager:self didUpdateEntity:entity];
+                [[NSNotificationCenter defaultCenter]
+                    postNotificationName:HAConnectionManagerEntityDidUpdateNotification
+                                  object:self
+                                userInfo:@{@"entity": entity}];
+            }
+            if (completion) completion();
+            return;
+        }
 
         // Re-resolve pending strategy dashboard now that entities are available
         if (self.pendingStrategyConfig && snapshot.count > 0) {
@@ -353,18 +513,35 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
         }
 
         // Cache entity states to disk (debounced)
-        self.showingCachedData = NO;
         [[HAEntityStateCache sharedCache] entitiesDidUpdate:snapshot];
 
         HALogI(@"conn", @"REST /api/states complete — %lu entities", (unsigned long)snapshot.count);
+        self.deliveredAllStates = YES;
         [self.delegate connectionManager:self didReceiveAllStates:snapshot];
         [[NSNotificationCenter defaultCenter]
             postNotificationName:HAConnectionManagerDidReceiveAllStatesNotification
                           object:self
                         userInfo:@{@"entities": snapshot}];
+        if (completion) completion();
     }];
 }
 
+/// Whether a freshly fetched state differs from what the store already holds.
+/// last_updated moves on any state or attribute change; entities with an
+/// outstanding optimistic update also get a full attribute comparison, since
+/// optimistic overrides don't touch last_updated.
+- (BOOL)stateDict:(NSDictionary *)stateDict differsFromEntity:(HAEntity *)entity {
+    NSString *state = stateDict[@"state"];
+    NSString *lastUpdated = stateDict[@"last_updated"];
+    if (!lastUpdated || ![lastUpdated isEqual:entity.lastUpdated]) return YES;
+    if (![state isEqual:entity.state]) return YES;
+    if ([self.optimisticLedger hasPendingEntityId:entity.entityId]) {
+        NSDictionary *attributes = stateDict[@"attributes"];
+        return !(attributes == entity.attributes || [attributes isEqual:entity.attributes]);
+    }
+    return NO;
+}
+
 - (void)fetchDashboardList {
     // Demo mode: re-deliver the demo dashboard list
     if ([[HAAuthManager sharedManager] isDemoMode]) {
@@ -381,6 +558,30 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
     }
 }
 
+- (BOOL)switchToLovelaceDashboard:(NSString *)urlPath {
+    // Demo dashboards are in memory: the fetch below delivers synchronously
+    if ([[HAAuthManager sharedManager] isDemoMode]) {
+        [self fetchLovelaceConfig:urlPath];
+        return YES;
+    }
+
+    HALovelaceDashboard *cached = [self cachedLovelaceDashboardForPath:urlPath];
+    if (cached) {
+        HALogI(@"conn", @"Showing cached config for '%@' while revalidating", urlPath ?: @"(default)");
+        self.lovelaceDashboard = cached;
+        if ([self.delegate respondsToSelector:@selector(connectionManager:didReceiveLovelaceDashboard:)]) {
+            [self.delegate connectionManager:self didReceiveLovelaceDashboard:cached];
+        }
+        [[NSNotificationCenter defaultCenter]
+            postNotificationName:HAConnectionManagerDidReceiveLovelaceNotification
+                          object:self
+                        userInfo:@{@"dashboard": cached}];
+    }
+    // Offline this only logs; the fetch on reconnect revalidates instead
+    [self fetchLovelaceConfig:urlPath];
+    return cached != nil;
+}
+
 - (void)fetchLovelaceConfig:(NSString *)urlPath {
     // Demo mode: look up dashboard from demo provider and deliver via standard pipeline
     if ([[HAAuthManager sharedManager] isDemoMode]) {
@@ -432,15 +633,73 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
         return;
     }
 
-    // Prefer WebSocket if connected
+    HAServiceCall *call = [[HAServiceCall alloc] initWithDomain:domain
+                                                        service:service
+                                                    serviceData:serviceData
+                                                       entityId:entityId];
+    [self sendServiceCall:call];
+}
+
+/// Send over WebSocket if connected, REST otherwise, and park the call in
+/// the offline queue when neither can reach the server.
+- (void)sendServiceCall:(HAServiceCall *)call {
+    // Service calls jump ahead of any queued fetches so a tap is never stuck
+    // behind history/logbook traffic.
     if (self.wsClient.isAuthenticated) {
-        [self.wsClient callService:service inDomain:domain withData:serviceData];
+        NSDictionary *command = @{
+            @"type": @"call_service",
+            @"domain": call.domain,
+            @"service": call.service,
+            @"service_data": call.serviceData,
+        };
+        [self.optimisticLedger armEntityId:call.entityId];
+        __weak typeof(self) weakSelf = self;
+        [self.commandQueue enqueueCommand:command
+                                 priority:HACommandPriorityUserAction
+                                  timeout:kServiceCallTimeout
+                               completion:^(id result, NSError *error) {
+            if (!error) return;
+            HALogE(@"conn", @"Service call %@.%@ failed: %@", call.domain, call.service, error.localizedDescription);
+            // The socket dropped before a result. HA may or may not have run
+            // it, so only calls that are safe to repeat go back in the queue.
+            BOOL lostConnection = (error.code == HACommandErrorDisconnected ||
+                                   error.code == HACommandErrorNotConnected);
+            if (lostConnection && call.isIdempotent) {
+                [weakSelf queueServiceCallForReplay:call];
+            } else if (error.code != HACommandErrorTimedOut) {
+                // A timeout leaves the deadline running — a late state_changed still confirms
+                [weakSelf.optimisticLedger rollbackEntityId:call.entityId];
+            }
+        }];
     } else if (self.apiClient) {
-        [self.apiClient callService:service inDomain:domain withData:serviceData completion:^(id response, NSError *error) {
-            if (error) {
-                HALogE(@"conn", @"Service call failed: %@", error);
+        [self.optimisticLedger armEntityId:call.entityId];
+        __weak typeof(self) weakSelf = self;
+        [self.apiClient callService:call.service inDomain:call.domain withData:call.serviceData completion:^(id response, NSError *error) {
+            if (!error) return;
+            HALogE(@"conn", @"Service call failed: %@", error);
+            if ([error.domain isEqualToString:NSURLErrorDomain] && call.isIdempotent) {
+                [weakSelf queueServiceCallForReplay:call];
+            } else {
+                [weakSelf.optimisticLedger rollbackEntityId:call.entityId];
             }
         }];
+    } else {
+        [self queueServiceCallForReplay:call];
+    }
+}
+
+- (void)queueServiceCallForReplay:(HAServiceCall *)call {
+    // Keep the optimistic state on screen while the call waits for a connection
+    [self.optimisticLedger disarmEntityId:call.entityId];
+    [[HAServiceCallQueue sharedQueue] enqueueCall:call];
+}
+
+- (void)replayQueuedServiceCalls {
+    NSArray<HAServiceCall *> *calls = [[HAServiceCallQueue sharedQueue] dequeueAllCalls];
+    if (calls.count == 0) return;
+    HALogI(@"conn", @"Replaying %lu queued service calls", (unsigned long)calls.count);
+    for (HAServiceCall *call in calls) {
+        [self sendServiceCall:call];
     }
 }
 
@@ -567,6 +826,11 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
 
     if (!optimisticState && !attrOverrides) return;
 
+    // Demo mode has no server to confirm against
+    if (![[HAAuthManager sharedManager] isDemoMode]) {
+        [self.optimisticLedger recordEntity:entity];
+    }
+
     @synchronized(self.entityStore) {
         [entity applyOptimisticState:optimisticState attributeOverrides:attrOverrides];
     }
@@ -579,20 +843,48 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
                     userInfo:@{@"entity": entity}];
 }
 
-- (void)sendCommand:(NSDictionary *)command
-         completion:(void (^)(id result, NSError *error))completion {
+/// Undo an optimistic update the server never confirmed (or rejected).
+- (void)revertEntityId:(NSString *)entityId toState:(NSString *)state attributes:(NSDictionary *)attributes {
+    HAEntity *entity;
+    @synchronized(self.entityStore) {
+        entity = self.entityStore[entityId];
+        if (!entity) return;
+        entity.state = state;
+        entity.attributes = attributes;
+    }
+
+    [[HAEntityStateCache sharedCache] entitiesDidUpdate:[self allEntities]];
+
+    [self.delegate connectionManager:self didUpdateEntity:entity];
+    [[NSNotificationCenter defaultCenter]
+        postNotificationName:HAConnectionManagerEntityDidUpdateNotification
+                      object:self
+                    userInfo:@{@"entity": entity}];
+}
+
+- (HACommandToken *)sendCommand:(NSDictionary *)command
+                     completion:(void (^)(id result, NSError *error))completion {
+    return [self sendCommand:command priority:HACommandPriorityNormal timeout:HACommandDefaultTimeout completion:completion];
+}
+
+- (HACommandToken *)sendCommand:(NSDictionary *)command
+                       priority:(HACommandPriority)priority
+                        timeout:(NSTimeInterval)timeout
+                     completion:(void (^)(id result, NSError *error))completion {
     if (!self.wsClient.isAuthenticated) {
         if (completion) {
-            NSError *err = [NSError errorWithDomain:@"HAConnectionManager" code:-1
+            NSError *err = [NSError errorWithDomain:@"HAConnectionManager" code:HACommandErrorNotConnected
                 userInfo:@{NSLocalizedDescriptionKey: @"WebSocket not connected"}];
             completion(nil, err);
         }
-        return;
-    }
-    NSInteger msgId = [self.wsClient sendCommand:command];
-    if (completion) {
-        self.pendingCompletions[@(msgId)] = [completion copy];
+        return nil;
     }
+    return [self.commandQueue enqueueCommand:command priority:priority timeout:timeout completion:completion];
+}
+
+- (NSError *)disconnectedError {
+    return [NSError errorWithDomain:@"HAConnectionManager" code:HACommandErrorDisconnected
+        userInfo:@{NSLocalizedDescriptionKey: @"Disconnected"}];
 }
 
 - (void)renderTemplate:(NSString *)templateString
@@ -610,6 +902,23 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
     }];
 }
 
+- (NSURLSessionDataTask *)fetchCalendarEventsForEntityId:(NSString *)entityId
+                                                   start:(NSString *)startISO
+                                                     end:(NSString *)endISO
+                                              completion:(void (^)(NSArray *events, NSError *error))completion {
+    if (!self.apiClient) {
+        NSError *error = [NSError errorWithDomain:@"HAConnectionManager" code:-4
+            userInfo:@{NSLocalizedDescriptionKey: @"Home Assistant is not connected"}];
+        if (completion) completion(nil, error);
+        return nil;
+    }
+    return [self.apiClient getCalendarEventsForEntityId:entityId start:startISO end:endISO completion:^(id response, NSError *error) {
+        if (completion) {
+            completion([response isKindOfClass:[NSArray class]] ? response : nil, error);
+        }
+    }];
+}
+
 - (NSInteger)subscribeToEventType:(NSString *)eventType
                           handler:(void (^)(NSDictionary *eventData))handler {
     return [self subscribeWithCommand:@{
@@ -648,6 +957,78 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
     }
 }
 
+#pragma mark - Deep Idle
+
+- (void)enterDeepIdleWithWakeEntityIds:(NSSet<NSString *> *)wakeEntityIds {
+    self.deepIdleWakeEntityIds = [wakeEntityIds.allObjects sortedArrayUsingSelector:@selector(compare:)];
+    if (self.deepIdle) {
+        // Already idle: just retarget the trigger
+        [self unsubscribeFromEventWithId:self.wakeTriggerSubscriptionId];
+        self.wakeTriggerSubscriptionId = 0;
+        [self subscribeToEntityUpdates];
+        return;
+    }
+    self.deepIdle = YES;
+    HALogI(@"conn", @"Deep idle — narrowing updates to %lu wake entities",
+           (unsigned long)self.deepIdleWakeEntityIds.count);
+
+    if (self.stateSubscriptionId > 0 && self.wsClient.isAuthenticated) {
+        [self.wsClient sendCommand:@{
+            @"type": @"unsubscribe_events",
+            @"subscription": @(self.stateSubscriptionId),
+        }];
+    }
+    self.stateSubscriptionId = 0;
+    [self subscribeToEntityUpdates];
+}
+
+- (void)exitDeepIdleWithCompletion:(void (^)(void))completion {
+    if (!self.deepIdle) {
+        if (completion) dispatch_async(dispatch_get_main_queue(), completion);
+        return;
+    }
+    self.deepIdle = NO;
+    self.deepIdleWakeEntityIds = nil;
+    [self unsubscribeFromEventWithId:self.wakeTriggerSubscriptionId];
+    self.wakeTriggerSubscriptionId = 0;
+
+    // Not authenticated: the reconnect subscribes and fetches states itself
+    if (!self.wsClient.isAuthenticated) {
+        HALogI(@"conn", @"Deep idle ended while disconnected");
+        if (completion) dispatch_async(dispatch_get_main_queue(), completion);
+        return;
+    }
+
+    // Subscribe before fetching so nothing between the snapshot and the
+    // first event is lost; the reconcile touches only what moved
+    HALogI(@"conn", @"Deep idle ended — resubscribing and reconciling states");
+    [self subscribeToEntityUpdates];
+    [self fetchAllStatesWithCompletion:completion];
+}
+
+/// Full state_changed normally; in deep idle a state trigger limited to the
+/// wake entities (none if there are none).
+- (void)subscribeToEntityUpdates {
+    if (!self.wsClient.isAuthenticated) return;
+
+    if (!self.deepIdle) {
+        self.stateSubscriptionId = [self.wsClient subscribeToStateChanges];
+        return;
+    }
+    if (self.deepIdleWakeEntityIds.count == 0) return;
+
+    __weak typeof(self) weakSelf = self;
+    self.wakeTriggerSubscriptionId = [self subscribeWithCommand:@{
+        @"type": @"subscribe_trigger",
+        @"trigger": @{@"platform": @"state", @"entity_id": self.deepIdleWakeEntityIds},
+    } handler:^(NSDictionary *eventData) {
+        NSDictionary *variables = eventData[@"variables"];
+        NSDictionary *trigger = [variables isKindOfClass:[NSDictionary class]] ? variables[@"trigger"] : nil;
+        if (![trigger isKindOfClass:[NSDictionary class]]) return;
+        [weakSelf applyNewState:trigger[@"to_state"]];
+    }];
+}
+
 #pragma mark - Registry Processing
 
 - (void)processAreaRegistry:(id)result {
@@ -687,6 +1068,39 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
     [self buildEntityAreaMap];
 }
 
+- (void)applyRegistryEntry:(NSDictionary *)entry toEntityId:(NSString *)entityId {
+    HAEntity *entity;
+    @synchronized(self.entityStore) {
+        entity = self.entityStore[entityId];
+    }
+    if (!entity) return;
+
+    id entityCategory = entry[@"entity_category"];
+    if ([entityCategory isKindOfClass:[NSString class]] && [entityCategory length] > 0) {
+        entity.entityCategory = entityCategory;
+    } else {
+        entity.entityCategory = nil;
+    }
+    id hiddenBy = entry[@"hidden_by"];
+    if ([hiddenBy isKindOfClass:[NSString class]] && [hiddenBy length] > 0) {
+        entity.hiddenBy = hiddenBy;
+    } else {
+        entity.hiddenBy = nil;
+    }
+    id disabledBy = entry[@"disabled_by"];
+    if ([disabledBy isKindOfClass:[NSString class]] && [disabledBy length] > 0) {
+        entity.disabledBy = disabledBy;
+    } else {
+        entity.disabledBy = nil;
+    }
+    id platform = entry[@"platform"];
+    if ([platform isKindOfClass:[NSString class]] && [platform length] > 0) {
+        entity.platform = platform;
+    } else {
+        entity.platform = nil;
+    }
+}
+
 - (void)buildEntityAreaMap {
     id result = self.rawEntityRegistry;
     if (![result isKindOfClass:[NSArray class]]) return;
@@ -697,36 +1111,7 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
         if (!entityId) continue;
 
         // Enrich the entity with registry fields
-        HAEntity *entity;
-        @synchronized(self.entityStore) {
-            entity = self.entityStore[entityId];
-        }
-        if (entity) {
-            id entityCategory = entry[@"entity_category"];
-            if ([entityCategory isKindOfClass:[NSString class]] && [entityCategory length] > 0) {
-                entity.entityCategory = entityCategory;
-            } else {
-                entity.entityCategory = nil;
-            }
-            id hiddenBy = entry[@"hidden_by"];
-            if ([hiddenBy isKindOfClass:[NSString class]] && [hiddenBy length] > 0) {
-                entity.hiddenBy = hiddenBy;
-            } else {
-                entity.hiddenBy = nil;
-            }
-            id disabledBy = entry[@"disabled_by"];
-            if ([disabledBy isKindOfClass:[NSString class]] && [disabledBy length] > 0) {
-                entity.disabledBy = disabledBy;
-            } else {
-                entity.disabledBy = nil;
-            }
-            id platform = entry[@"platform"];
-            if ([platform isKindOfClass:[NSString class]] && [platform length] > 0) {
-                entity.platform = platform;
-            } else {
-                entity.platform = nil;
-            }
-        }
+        [self applyRegistryEntry:entry toEntityId:entityId];
 
         // Direct area assignment takes priority
         NSString *areaId = entry[@"area_id"];
@@ -780,11 +1165,62 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
     HALogD(@"conn", @"Built %lu entity->area mappings", (unsigned long)map.count);
 }
 
+#pragma mark - Registry Cache
+
+/// Restore registries from disk. The precomputed entity -> area map is used
+/// as-is; only the per-entity registry fields are re-applied to the store.
+- (BOOL)loadCachedRegistries {
+    NSDictionary *snapshot = [[HARegistryCache sharedCache] loadCachedRegistries];
+    if (!snapshot) return NO;
+
+    [self processAreaRegistry:snapshot[@"areas"]];
+    self.deviceAreaMap = snapshot[@"device_areas"];
+    self.rawEntityRegistry = snapshot[@"entities"];
+    for (NSDictionary *entry in (NSArray *)self.rawEntityRegistry) {
+        NSString *entityId = entry[@"entity_id"];
+        if ([entityId isKindOfClass:[NSString class]]) {
+            [self applyRegistryEntry:entry toEntityId:entityId];
+        }
+    }
+    self.entityAreaMap = snapshot[@"entity_areas"];
+    if ([snapshot[@"floors"] isKindOfClass:[NSArray class]]) {
+        [self processFloorRegistry:snapshot[@"floors"]];
+    }
+    // registriesFetchedAt stays nil, so the first connect still refreshes them
+    self.registriesLoaded = YES;
+    return YES;
+}
+
+- (void)saveRegistriesToCache {
+    if (![self.rawAreaRegistry isKindOfClass:[NSArray class]] ||
+        ![self.rawEntityRegistry isKindOfClass:[NSArray class]]) return;
+
+    NSMutableDictionary *snapshot = [NSMutableDictionary dictionary];
+    snapshot[@"areas"] = self.rawAreaRegistry;
+    snapshot[@"device_areas"] = self.deviceAreaMap ?: @{};
+    snapshot[@"entities"] = [HARegistryCache trimmedEntityRegistry:self.rawEntityRegistry];
+    snapshot[@"entity_areas"] = self.entityAreaMap ?: @{};
+    if ([self.rawFloorRegistry isKindOfClass:[NSArray class]]) {
+        snapshot[@"floors"] = self.rawFloorRegistry;
+    }
+    [[HARegistryCache sharedCache] saveRegistries:snapshot];
+}
+
 - (void)checkRegistriesComplete {
     if (!self.areasLoaded || !self.devicesLoaded || !self.entitiesRegistryLoaded) return;
 
+    self.registriesFetchedAt = [NSDate date];
+    self.registriesStale = NO;
+    BOOL wasRefresh = self.registriesRefreshing;
+    self.registriesRefreshing = NO;
+    if (wasRefresh && !self.registriesChanged) {
+        HALogI(@"conn", @"Registries unchanged — keeping current area mapping");
+        return;
+    }
+
     // Rebuild entity area map now that device registry is available for fallback
     [self buildEntityAreaMap];
+    [self saveRegistriesToCache];
 
     self.registriesLoaded = YES;
     HALogI(@"conn", @"All registries loaded (floors: %@)", self.floorsLoaded ? @"yes" : @"pending");
@@ -827,6 +1263,8 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
         return;
     }
 
+    self.rawFloorRegistry = result;
+
     // Build floor objects from registry response
     NSMutableDictionary<NSString *, HAFloor *> *floorById = [NSMutableDictionary dictionary];
     for (NSDictionary *floorDict in (NSArray *)result) {
@@ -936,6 +1374,50 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
 
 #pragma mark - HAWebSocketClientDelegate
 
+- (void)fetchRegistries {
+    // While refreshing, keep serving the previous registries; the rebuild is
+    // skipped if the new results are identical.
+    self.registriesRefreshing = self.registriesLoaded;
+    self.registriesChanged = NO;
+    self.areasLoaded = NO;
+    self.entitiesRegistryLoaded = NO;
+    self.devicesLoaded = NO;
+    self.floorsLoaded = NO;
+    self.areaRegistryMessageId = [self.wsClient fetchAreaRegistry];
+    self.entityRegistryMessageId = [self.wsClient fetchEntityRegistry];
+    self.deviceRegistryMessageId = [self.wsClient fetchDeviceRegistry];
+
+    // Fetch floor registry (optional — older HA versions may not support it)
+    self.floorRegistryMessageId = [self.wsClient sendCommand:@{@"type": @"config/floor_registry/list"}];
+}
+
+- (void)subscribeToRegistryUpdates {
+    __weak typeof(self) weakSelf = self;
+    for (NSString *eventType in @[@"area_registry_updated", @"device_registry_updated",
+                                  @"entity_registry_updated", @"floor_registry_updated"]) {
+        [self subscribeToEventType:eventType handler:^(NSDictionary *eventData) {
+            weakSelf.registriesStale = YES;
+        }];
+    }
+}
+
+/// Registries in memory can be kept across a reconnect when no
+/// *_registry_updated event arrived and they are less than
+/// kRegistryReuseInterval old.
+- (BOOL)canReuseRegistries {
+    if (!self.registriesLoaded || self.registriesStale || !self.registriesFetchedAt) return NO;
+    return -[self.registriesFetchedAt timeIntervalSinceNow] < kRegistryReuseInterval;
+}
+
+/// Records a registry result's hash and reports whether it needs processing.
+/// Unchanged registries are skipped only while the previous ones are still
+/// in memory (a refresh); otherwise there is nothing to fall back on.
+- (BOOL)registryResult:(id)result changedForKey:(NSString *)key {
+    BOOL changed = [[HARegistryCache sharedCache] registryResult:result changedForKey:key];
+    if (changed) self.registriesChanged = YES;
+    return changed || !self.registriesRefreshing;
+}
+
 - (void)webSocketClientDidConnect:(HAWebSocketClient *)client {
     HALogI(@"conn", @"WebSocket connected, awaiting auth...");
 }
@@ -946,12 +1428,16 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
     self.connected = YES;
     self.reconnectAttempt = 0;
 
-    // Subscribe to state changes
-    [client subscribeToStateChanges];
+    // Subscribe to state changes (only the wake entities while in deep idle)
+    [self subscribeToEntityUpdates];
 
     // Subscribe to dashboard config changes (for auto-reload)
     [client subscribeToLovelaceUpdates];
 
+    // Send taps made while offline before the state fetch, so the states
+    // response already reflects them
+    [self replayQueuedServiceCalls];
+
     // Subscribe to HA lifecycle — homeassistant_started fires after all
     // integrations are loaded, signalling that camera entities are ready.
     __weak typeof(self) weakSelf = self;
@@ -962,28 +1448,26 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
                           object:weakSelf];
     }];
 
-    // Fetch available dashboards list
-    [self fetchDashboardList];
+    // Fetch available dashboards list (kept across a dropped connection)
+    if (!self.availableDashboards) {
+        [self fetchDashboardList];
+    }
 
-    // Fetch Lovelace dashboard config for selected dashboard
+    // Fetch Lovelace dashboard config for selected dashboard. An unchanged
+    // config (same hash as the cache) is not re-parsed.
     NSString *selectedDashboard = [[HAAuthManager sharedManager] selectedDashboardPath];
     [self fetchLovelaceConfig:selectedDashboard];
 
-    // Fetch full state via REST to populate entity store
+    // Fetch full state via REST; reconciled against the store on resume
     [self fetchAllStates];
 
-    // Fetch registries for area-based grouping
-    self.registriesLoaded = NO;
-    self.areasLoaded = NO;
-    self.entitiesRegistryLoaded = NO;
-    self.devicesLoaded = NO;
-    self.floorsLoaded = NO;
-    self.areaRegistryMessageId = [self.wsClient fetchAreaRegistry];
-    self.entityRegistryMessageId = [self.wsClient fetchEntityRegistry];
-    self.deviceRegistryMessageId = [self.wsClient fetchDeviceRegistry];
-
-    // Fetch floor registry (optional — older HA versions may not support it)
-    self.floorRegistryMessageId = [self.wsClient sendCommand:@{@"type": @"config/floor_registry/list"}];
+    // Fetch registries for area-based grouping, unless the ones we have are fresh
+    [self subscribeToRegistryUpdates];
+    if ([self canReuseRegistries]) {
+        HALogI(@"conn", @"Reusing registries fetched %.0fs ago", -[self.registriesFetchedAt timeIntervalSinceNow]);
+    } else {
+        [self fetchRegistries];
+    }
 
     [self.delegate connectionManagerDidConnect:self];
     [[NSNotificationCenter defaultCenter]
@@ -999,21 +1483,8 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
         NSInteger msgId = [message[@"id"] integerValue];
         BOOL success = [message[@"success"] boolValue];
 
-        // Check for pending completion handlers first
-        void (^completion)(id, NSError *) = self.pendingCompletions[@(msgId)];
-        if (completion) {
-            [self.pendingCompletions removeObjectForKey:@(msgId)];
-            if (success) {
-                completion(message[@"result"], nil);
-            } else {
-                NSDictionary *errDict = message[@"error"];
-                NSString *errMsg = [errDict isKindOfClass:[NSDictionary class]] ? errDict[@"message"] : @"Unknown error";
-                NSError *err = [NSError errorWithDomain:@"HAConnectionManager" code:-2
-                    userInfo:@{NSLocalizedDescriptionKey: errMsg ?: @"Unknown error"}];
-                completion(nil, err);
-            }
-            return;
-        }
+        // Check for queued command completions first
+        if ([self.commandQueue handleResultMessage:message]) return;
 
         if (msgId == self.dashboardListMessageId && success) {
             // get_panels returns a dictionary of panels keyed by name
@@ -1092,7 +1563,7 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
                 // changed if the user switched dashboards while the request
                 // was in flight).
                 NSString *dashPath = self.lovelaceRequestedPath;
-                [[HADashboardConfigCache sharedCache] cacheConfig:result forDashboard:dashPath];
+                BOOL configChanged = [[HADashboardConfigCache sharedCache] cacheConfig:result forDashboard:dashPath];
 
                 // If the user switched to a different dashboard while this
                 // response was in flight, discard it — the new dashboard's
@@ -1106,6 +1577,17 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
                     return;
                 }
 
+                // Same config as the one already on screen — nothing to re-parse
+                // or rebuild. Strategy dashboards still re-resolve below since
+                // their output depends on entities and registries.
+                NSString *dashKey = dashPath ?: @"";
+                if (!configChanged && self.lovelaceDashboard && [self.parsedLovelaceKey isEqualToString:dashKey]) {
+                    HALogI(@"conn", @"Lovelace config unchanged — keeping parsed dashboard");
+                    self.lovelaceMessageId = 0;
+                    return;
+                }
+                self.parsedLovelaceKey = nil;
+
                 // Check if this is a strategy-based dashboard
                 NSDictionary *strategy = result[@"strategy"];
                 if ([strategy isKindOfClass:[NSDictionary class]]) {
@@ -1139,6 +1621,12 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
                     }
                 } else {
                     self.lovelaceDashboard = [HALovelaceParser parseDashboardFromDictionary:result];
+                    if (self.lovelaceDashboard) {
+                        self.parsedLovelaceKey = dashKey;
+                        HADashboardConfigCache *configCache = [HADashboardConfigCache sharedCache];
+                        self.lovelaceDashboard.configHash = [configCache configHashForDashboard:dashPath];
+                        [configCache storeParsedDashboard:self.lovelaceDashboard forDashboard:dashPath];
+                    }
                 }
 
                 if ([self.delegate respondsToSelector:@selector(connectionManager:didReceiveLovelaceDashboard:)]) {
@@ -1162,6 +1650,7 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
                 HALogI(@"conn", @"No Lovelace config — using original-states strategy");
                 NSDictionary *implicitStrategy = @{@"type": @"original-states"};
                 self.pendingStrategyConfig = implicitStrategy;
+                self.parsedLovelaceKey = nil;
 
                 NSDictionary *currentEntities = [self allEntities];
                 if (currentEntities.count == 0) {
@@ -1197,21 +1686,21 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
             }
         } else if (msgId == self.areaRegistryMessageId) {
             self.areaRegistryMessageId = 0;
-            if (success) {
+            if (success && [self registryResult:message[@"result"] changedForKey:HARegistryKeyArea]) {
                 [self processAreaRegistry:message[@"result"]];
             }
             self.areasLoaded = YES;
             [self checkRegistriesComplete];
         } else if (msgId == self.deviceRegistryMessageId) {
             self.deviceRegistryMessageId = 0;
-            if (success) {
+            if (success && [self registryResult:message[@"result"] changedForKey:HARegistryKeyDevice]) {
                 [self processDeviceRegistry:message[@"result"]];
             }
             self.devicesLoaded = YES;
             [self checkRegistriesComplete];
         } else if (msgId == self.entityRegistryMessageId) {
             self.entityRegistryMessageId = 0;
-            if (success) {
+            if (success && [self registryResult:message[@"result"] changedForKey:HARegistryKeyEntity]) {
                 [self processEntityRegistry:message[@"result"]];
             }
             self.entitiesRegistryLoaded = YES;
@@ -1219,7 +1708,11 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
         } else if (msgId == self.floorRegistryMessageId) {
             self.floorRegistryMessageId = 0;
             if (success) {
-                [self processFloorRegistry:message[@"result"]];
+                if ([self registryResult:message[@"result"] changedForKey:HARegistryKeyFloor]) {
+                    [self processFloorRegistry:message[@"result"]];
+                    // Floors don't gate completion; persist them once the rest is in
+                    if (self.registriesLoaded) [self saveRegistriesToCache];
+                }
             } else {
                 HALogW(@"conn", @"Floor registry fetch failed (may not be supported): %@", message[@"error"]);
             }
@@ -1244,31 +1737,7 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
 
         if ([eventType isEqualToString:@"state_changed"]) {
             NSDictionary *eventData = event[@"data"];
-            NSDictionary *newState = eventData[@"new_state"];
-            if (!newState || ![newState isKindOfClass:[NSDictionary class]]) return;
-
-            NSString *entityId = newState[@"entity_id"];
-            if (!entityId) return;
-
-            HAEntity *entity;
-            @synchronized(self.entityStore) {
-                entity = self.entityStore[entityId];
-                if (entity) {
-                    [entity updateWithDictionary:newState];
-                } else {
-                    entity = [[HAEntity alloc] initWithDictionary:newState];
-                    self.entityStore[entityId] = entity;
-                }
-            }
-
-            // Notify entity state cache (debounced disk write)
-            [[HAEntityStateCache sharedCache] entitiesDidUpdate:[self allEntities]];
-
-            [self.delegate connectionManager:self didUpdateEntity:entity];
-            [[NSNotificationCenter defaultCenter]
-                postNotificationName:HAConnectionManagerEntityDidUpdateNotification
-                              object:self
-                            userInfo:@{@"entity": entity}];
+            [self applyNewState:eventData[@"new_state"]];
         } else if ([eventType isEqualToString:@"lovelace_updated"]) {
             if (![[HAAuthManager sharedManager] autoReloadDashboard]) return;
 
@@ -1292,11 +1761,51 @@ static const NSTimeInterval kReconnectMaxInterval  = 60.0;
     }
 }
 
+/// Apply one entity's new state from state_changed (or a deep-idle state
+/// trigger) to the store and announce it.
+- (void)applyNewState:(NSDictionary *)newState {
+    HAPerfScopedSpan(HAPerfCategoryEntity, "entity.apply", NULL);
+    if (!newState || ![newState isKindOfClass:[NSDictionary class]]) return;
+
+    NSString *entityId = newState[@"entity_id"];
+    if (!entityId) return;
+
+    // Server-reported state supersedes any optimistic update
+    [self.optimisticLedger confirmEntityId:entityId];
+
+    HAEntity *entity;
+    @synchronized(self.entityStore) {
+        entity = self.entityStore[entityId];
+        if (entity) {
+            [entity updateWithDictionary:newState];
+        } else {
+            entity = [[HAEntity alloc] initWithDictionary:newState];
+            self.entityStore[entityId] = entity;
+        }
+    }
+
+    // Notify entity state cache (debounced disk write)
+    [[HAEntityStateCache sharedCache] entitiesDidUpdate:[self allEntities]];
+
+    [self.delegate connectionManager:self didUpdateEntity:entity];
+    [[NSNotificationCenter defaultCenter]
+        postNotificationName:HAConnectionManagerEntityDidUpdateNotification
+                      object:self
+                    userInfo:@{@"entity": entity}];
+}
+
+- (void)injectWebSocketMessage:(NSDictionary *)message {
+    [self webSocketClient:self.wsClient didReceiveMessage:message];
+}
+
 - (void)webSocketClient:(HAWebSocketClient *)client didDisconnectWithError:(NSError *)error {
     HALogW(@"conn", @"WebSocket disconnected: %@", error);
 
     self.connected = NO;
 
+    // Results can't arrive on a dead socket — fail now rather than at each deadline
+    [self.commandQueue failAllWithError:[self disconnectedError]];
+
     [self.delegate connectionManager:self didDisconnectWithError:error];
     [[NSNotificationCenter defaultCenter]
         postNotificationName:HAConnectionManagerDidDisconnectNotification
@@ -1,26 +1,40 @@
 #import <Foundation/Foundation.h>
 
 /**
- * Shared ISO 8601 date parsing with fallback for iOS versions
- * where ZZZZZ (colon-separated timezone, e.g. +00:00) is unsupported.
+ * Shared ISO 8601 date parsing.
  *
- * Falls back by stripping the colon from the timezone offset
- * (+00:00 → +0000) and retrying with ZZZ format.
+ * Timestamps in the RFC 3339 form Home Assistant emits
+ * (2026-10-19T08:15:42.123456+00:00) are parsed in a single pass without
+ * allocating. Anything else goes through an NSDateFormatter chain, with a
+ * fallback for iOS versions where ZZZZZ (colon-separated timezone, e.g.
+ * +00:00) is unsupported: the colon is stripped from the timezone offset
+ * (+00:00 → +0000) and the ZZZ formats are tried.
  */
 @interface HADateUtils : NSObject
 
 /**
  * Parse an ISO 8601 datetime string.
- * Tries formats in order:
+ * Fast path: yyyy-MM-dd'T'HH:mm:ss[.fraction](Z|±HH:MM|±HHMM), with 'T'
+ * or a space between date and time and any number of fraction digits.
+ * Otherwise tries formats in order:
  *   1. yyyy-MM-dd'T'HH:mm:ssZZZZZ
  *   2. yyyy-MM-dd'T'HH:mm:ss.SSSZZZZZ
  *   3. yyyy-MM-dd'T'HH:mm:ss.SSSSSSZZZZZ
  *   4. Colon-stripped timezone fallback for each (iOS ≤10)
- *   5. yyyy-MM-dd'T'HH:mm:ss (no timezone)
+ *   5. yyyy-MM-dd'T'HH:mm:ss (no timezone, local time)
  *
  * @param string ISO 8601 datetime string from Home Assistant
  * @return Parsed date, or nil if unparseable
  */
 + (NSDate *)dateFromISO8601String:(NSString *)string;
 
+/**
+ * Same as dateFromISO8601String:, as seconds since 1970, without creating
+ * an NSDate. For bulk callers (history, statistics, logbook).
+ *
+ * @param outTime Receives the timestamp; untouched on failure
+ * @return NO if the string is unparseable
+ */
++ (BOOL)getTimeInterval:(NSTimeInterval *)outTime fromISO8601String:(NSString *)string;
+
 @end
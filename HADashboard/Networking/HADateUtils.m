@@ -1,10 +1,139 @@
 #import "HADateUtils.h"
 
+/// Longest string the fast path reads: date, time, nanoseconds and offset
+/// ("2026-10-19T08:15:42.123456789+00:00" is 35)
+static const NSUInteger kFastPathMaxLength = 40;
+
+static inline BOOL HAReadDigits(const unichar *s, NSUInteger pos, NSUInteger count, int *outValue) {
+    int value = 0;
+    for (NSUInteger i = 0; i < count; i++) {
+        unichar c = s[pos + i];
+        if (c < '0' || c > '9') return NO;
+        value = value * 10 + (c - '0');
+    }
+    *outValue = value;
+    return YES;
+}
+
+/// Days from 1970-01-01 to a proleptic Gregorian date (Hinnant's
+/// days_from_civil).
+static inline long HADaysFromCivil(long year, long month, long day) {
+    year -= month <= 2;
+    long era = (year >= 0 ? year : year - 399) / 400;
+    long yearOfEra = year - era * 400;
+    long dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    long dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+/// Single pass over yyyy-MM-dd'T'HH:mm:ss[.fraction](Z|±HH:MM|±HHMM).
+/// Strings without a timezone are left to the formatters (local time).
+static BOOL HAParseRFC3339(const unichar *s, NSUInteger len, NSTimeInterval *outTime) {
+    // "yyyy-MM-ddTHH:mm:ssZ" is the shortest accepted form
+    if (len < 20) return NO;
+
+    int year, month, day, hour, minute, second;
+    if (!HAReadDigits(s, 0, 4, &year) || s[4] != '-' ||
+        !HAReadDigits(s, 5, 2, &month) || s[7] != '-' ||
+        !HAReadDigits(s, 8, 2, &day) ||
+        (s[10] != 'T' && s[10] != 't' && s[10] != ' ') ||
+        !HAReadDigits(s, 11, 2, &hour) || s[13] != ':' ||
+        !HAReadDigits(s, 14, 2, &minute) || s[16] != ':' ||
+        !HAReadDigits(s, 17, 2, &second)) {
+        return NO;
+    }
+
+    static const int kDaysInMonth[12] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    BOOL leapYear = (year % 4 == 0 && (year % 100 != 0 || year % 400 == 0));
+    if (month < 1 || month > 12 || day < 1 || day > kDaysInMonth[month - 1] ||
+        (month == 2 && day == 29 && !leapYear) ||
+        hour > 23 || minute > 59 || second > 60) {
+        return NO;
+    }
+
+    // Fraction: any number of digits, nanoseconds kept
+    NSUInteger pos = 19;
+    double fraction = 0;
+    if (s[pos] == '.') {
+        pos++;
+        NSUInteger start = pos;
+        long long digits = 0;
+        double scale = 1.0;
+        while (pos < len && s[pos] >= '0' && s[pos] <= '9') {
+            if (pos - start < 9) {
+                digits = digits * 10 + (s[pos] - '0');
+                scale *= 10.0;
+            }
+            pos++;
+        }
+        if (pos == start) return NO;
+        fraction = digits / scale;
+    }
+    if (pos >= len) return NO;
+
+    long offset = 0;
+    unichar sign = s[pos];
+    if (sign == 'Z' || sign == 'z') {
+        pos++;
+    } else if (sign == '+' || sign == '-') {
+        int offsetHour, offsetMinute;
+        if (len - pos == 6 && s[pos + 3] == ':') {
+            if (!HAReadDigits(s, pos + 1, 2, &offsetHour) || !HAReadDigits(s, pos + 4, 2, &offsetMinute)) return NO;
+        } else if (len - pos == 5) {
+            if (!HAReadDigits(s, pos + 1, 2, &offsetHour) || !HAReadDigits(s, pos + 3, 2, &offsetMinute)) return NO;
+        } else {
+            return NO;
+        }
+        if (offsetHour > 23 || offsetMinute > 59) return NO;
+        offset = (offsetHour * 3600L + offsetMinute * 60L) * (sign == '-' ? -1 : 1);
+        pos = len;
+    } else {
+        return NO;
+    }
+    if (pos != len) return NO;
+
+    long seconds = HADaysFromCivil(year, month, day) * 86400L + hour * 3600L + minute * 60L + second - offset;
+    *outTime = (NSTimeInterval)seconds + fraction;
+    return YES;
+}
+
+/// Fast path for an NSString: copies at most kFastPathMaxLength characters
+/// to the stack, no allocation.
+static BOOL HAFastParseISO8601(NSString *string, NSTimeInterval *outTime) {
+    NSUInteger len = string.length;
+    if (len < 20 || len > kFastPathMaxLength) return NO;
+    unichar buffer[kFastPathMaxLength];
+    [string getCharacters:buffer range:NSMakeRange(0, len)];
+    return HAParseRFC3339(buffer, len, outTime);
+}
+
 @implementation HADateUtils
 
 + (NSDate *)dateFromISO8601String:(NSString *)string {
     if (!string || ![string isKindOfClass:[NSString class]]) return nil;
 
+    NSTimeInterval time;
+    if (HAFastParseISO8601(string, &time)) {
+        return [NSDate dateWithTimeIntervalSince1970:time];
+    }
+    return [self dateFromISO8601StringWithFormatters:string];
+}
+
++ (BOOL)getTimeInterval:(NSTimeInterval *)outTime fromISO8601String:(NSString *)string {
+    if (!string || ![string isKindOfClass:[NSString class]]) return NO;
+
+    NSTimeInterval time;
+    if (!HAFastParseISO8601(string, &time)) {
+        NSDate *date = [self dateFromISO8601StringWithFormatters:string];
+        if (!date) return NO;
+        time = [date timeIntervalSince1970];
+    }
+    if (outTime) *outTime = time;
+    return YES;
+}
+
+/// Fallback for input the fast path rejects
++ (NSDate *)dateFromISO8601StringWithFormatters:(NSString *)string {
     static NSDateFormatter *fmtNoFrac, *fmtFrac3, *fmtFrac6, *fmtNoTZ;
     static NSDateFormatter *fmtNoFracCompat, *fmtFrac3Compat, *fmtFrac6Compat;
     static dispatch_once_t onceToken;
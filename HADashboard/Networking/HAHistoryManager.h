@@ -1,5 +1,7 @@
 #import <Foundation/Foundation.h>
 
+@class HAHistoryPyramid;
+
 /// Shared history data manager, extracted from HAGraphCardCell.
 /// Fetches entity history via the HA REST API, parses responses,
 /// downsamples to 100 points, and caches results.
@@ -34,6 +36,28 @@
                          endDate:(NSDate *)endDate
                       completion:(void (^)(NSArray *segments, NSError *error))completion;
 
+/// Multi-resolution history already held in memory for an entity, or nil.
+/// Lets a zoom or pan redraw immediately before any fetch. Main thread only.
+- (HAHistoryPyramid *)cachedPyramidForEntityId:(NSString *)entityId;
+
+/// Make sure the entity's pyramid holds raw history for the whole date range,
+/// fetching only the sub-ranges it doesn't have yet (in parallel).
+/// Completion runs on main with the pyramid; error is the first fetch error,
+/// in which case the pyramid still holds whatever did arrive.
+- (void)loadHistoryPyramidForEntityId:(NSString *)entityId
+                            startDate:(NSDate *)startDate
+                              endDate:(NSDate *)endDate
+                           completion:(void (^)(HAHistoryPyramid *pyramid, NSError *error))completion;
+
+/// Same, continuing from a pyramid the caller holds when the cache has
+/// evicted (or never had) the entity's. The cache only shares pyramids
+/// between callers; whoever draws from one should keep it.
+- (void)loadHistoryPyramidForEntityId:(NSString *)entityId
+                            startDate:(NSDate *)startDate
+                              endDate:(NSDate *)endDate
+                       reusingPyramid:(HAHistoryPyramid *)heldPyramid
+                           completion:(void (^)(HAHistoryPyramid *pyramid, NSError *error))completion;
+
 /// Clear all cached history data.
 - (void)clearCache;
 
@@ -1,5 +1,6 @@
 #import "HAHistoryManager.h"
-#import "HADateUtils.h"
+#import "HAHistoryPyramid.h"
+#import "HAHistoryParser.h"
 #import "HALog.h"
 #import "HAAuthManager.h"
 #import "HADemoDataProvider.h"
@@ -7,6 +8,8 @@
 
 @interface HAHistoryManager ()
 @property (nonatomic, strong) NSCache *cache;
+/// entityId -> HAHistoryPyramid (cost = raw + bucket bytes)
+@property (nonatomic, strong) NSCache *pyramids;
 @end
 
 @implementation HAHistoryManager
@@ -26,6 +29,9 @@
         _cache = [[NSCache alloc] init];
         _cache.countLimit = 30;
         _cache.totalCostLimit = 2 * 1024 * 1024; // 2MB limit
+        _pyramids = [[NSCache alloc] init];
+        _pyramids.countLimit = 20;
+        _pyramids.totalCostLimit = 8 * 1024 * 1024; // 8MB limit
     }
     return self;
 }
@@ -154,8 +160,93 @@
     [task resume];
 }
 
+#pragma mark - History Pyramid
+
+- (HAHistoryPyramid *)cachedPyramidForEntityId:(NSString *)entityId {
+    return entityId ? [self.pyramids objectForKey:entityId] : nil;
+}
+
+- (void)loadHistoryPyramidForEntityId:(NSString *)entityId
+                            startDate:(NSDate *)startDate
+                              endDate:(NSDate *)endDate
+                           completion:(void (^)(HAHistoryPyramid *, NSError *))completion {
+    [self loadHistoryPyramidForEntityId:entityId startDate:startDate endDate:endDate
+                         reusingPyramid:nil completion:completion];
+}
+
+- (void)loadHistoryPyramidForEntityId:(NSString *)entityId
+                            startDate:(NSDate *)startDate
+                              endDate:(NSDate *)endDate
+                       reusingPyramid:(HAHistoryPyramid *)heldPyramid
+                           completion:(void (^)(HAHistoryPyramid *, NSError *))completion {
+    if (!entityId || !completion) return;
+
+    HAHistoryPyramid *pyramid = [self.pyramids objectForKey:entityId] ?: heldPyramid;
+    if (!pyramid) {
+        pyramid = [[HAHistoryPyramid alloc] initWithEntityId:entityId];
+    }
+    NSTimeInterval start = [startDate timeIntervalSince1970];
+    NSTimeInterval end = [endDate timeIntervalSince1970];
+    NSArray<NSArray<NSNumber *> *> *missing = [pyramid missingRangesFromTime:start toTime:end];
+    if (missing.count == 0) {
+        [self.pyramids setObject:pyramid forKey:entityId cost:pyramid.byteCost];
+        completion(pyramid, nil);
+        return;
+    }
+
+    // Demo data is generated per call; treat it as the full raw history for the range
+    if ([[HAAuthManager sharedManager] isDemoMode]) {
+        NSInteger hours = (NSInteger)((end - start) / 3600.0);
+        if (hours < 1) hours = 24;
+        NSArray *fakePoints = [[HADemoDataProvider sharedProvider] historyPointsForEntityId:entityId hoursBack:hours];
+        [pyramid addRawPoints:fakePoints fromTime:start toTime:end];
+        [self.pyramids setObject:pyramid forKey:entityId cost:pyramid.byteCost];
+        completion(pyramid, nil);
+        return;
+    }
+
+    HALogD(@"history", @"%@: fetching %lu missing raw range(s)", entityId, (unsigned long)missing.count);
+    dispatch_group_t group = dispatch_group_create();
+    __block NSError *firstError = nil;
+    for (NSArray<NSNumber *> *range in missing) {
+        NSTimeInterval rangeStart = [range[0] doubleValue];
+        NSTimeInterval rangeEnd = [range[1] doubleValue];
+        NSURLRequest *request = [self requestForEntityId:entityId
+                                               startDate:[NSDate dateWithTimeIntervalSince1970:rangeStart]
+                                                 endDate:[NSDate dateWithTimeIntervalSince1970:rangeEnd]
+                                                 minimal:YES];
+        if (!request) {
+            if (!firstError) firstError = [self errorWithMessage:@"Not configured"];
+            continue;
+        }
+
+        dispatch_group_enter(group);
+        NSURLSessionDataTask *task = [[NSURLSession sharedSession] dataTaskWithRequest:request completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+            // An error status must not be recorded as "no history in this range"
+            NSInteger status = [response isKindOfClass:[NSHTTPURLResponse class]] ? [(NSHTTPURLResponse *)response statusCode] : 200;
+            // Parse off-main at full resolution; the pyramid does the reduction
+            NSArray *points = (error || !data || status >= 400) ? nil : [HAHistoryManager parseHistoryData:data maxPoints:NSUIntegerMax];
+            dispatch_async(dispatch_get_main_queue(), ^{
+                if (points) {
+                    [pyramid addRawPoints:points fromTime:rangeStart toTime:rangeEnd];
+                } else if (!firstError) {
+                    firstError = error ?: [self errorWithMessage:@"History request failed"];
+                }
+                dispatch_group_leave(group);
+            });
+        }];
+        [task resume];
+    }
+
+    dispatch_group_notify(group, dispatch_get_main_queue(), ^{
+        [self.pyramids setObject:pyramid forKey:entityId cost:pyramid.byteCost];
+        completion(pyramid, firstError);
+    });
+}
+
 - (void)clearCache {
     [self.cache removeAllObjects];
+    [self.pyramids removeAllObjects];
 }
 
 #pragma mark - Request Building
@@ -198,126 +289,16 @@
                            userInfo:@{NSLocalizedDescriptionKey: message}];
 }
 
-#pragma mark - Parsing (extracted from HAGraphCardCell)
-
-+ (NSArray *)parseHistoryData:(NSData *)data {
-    return [self parseHistoryData:data maxPoints:100];
-}
+#pragma mark - Parsing
 
 + (NSArray *)parseHistoryData:(NSData *)data maxPoints:(NSUInteger)maxPoints {
-    if (maxPoints == 0) maxPoints = 100;
-    if (!data || data.length == 0) return @[];
-
-    NSError *jsonError = nil;
-    NSArray *result = nil;
-    @try {
-        result = [NSJSONSerialization JSONObjectWithData:data options:0 error:&jsonError];
-    } @catch (NSException *e) {
-        HALogE(@"history", @"JSON parse exception: %@", e.reason);
-        return @[];
-    }
-    if (jsonError || ![result isKindOfClass:[NSArray class]] || result.count == 0) return @[];
-
-    NSArray *states = result.firstObject;
-    if (![states isKindOfClass:[NSArray class]]) return @[];
-
-    NSMutableArray *points = [NSMutableArray arrayWithCapacity:states.count];
-
-    for (NSDictionary *entry in states) {
-        if (![entry isKindOfClass:[NSDictionary class]]) continue;
-        NSString *stateStr = entry[@"state"];
-        if (!stateStr || [stateStr isEqualToString:@"unknown"] || [stateStr isEqualToString:@"unavailable"]) continue;
-
-        double value = [stateStr doubleValue];
-        if (value == 0 && ![stateStr isEqualToString:@"0"] && ![stateStr hasPrefix:@"0."]) continue;
-
-        id rawTime = entry[@"last_changed"];
-        if (![rawTime isKindOfClass:[NSString class]]) rawTime = entry[@"last_updated"];
-        NSString *timeStr = [rawTime isKindOfClass:[NSString class]] ? rawTime : nil;
-        if (!timeStr) continue;
-
-        NSDate *date = [HADateUtils dateFromISO8601String:timeStr];
-        if (!date) continue;
-
-        [points addObject:@{
-            @"value": @(value),
-            @"timestamp": @([date timeIntervalSince1970])
-        }];
-    }
-
-    // Downsample to maxPoints for performance on older devices
-    if (points.count > maxPoints) {
-        NSMutableArray *sampled = [NSMutableArray arrayWithCapacity:maxPoints];
-        double step = (double)points.count / (double)maxPoints;
-        for (NSUInteger i = 0; i < maxPoints; i++) {
-            NSUInteger idx = (NSUInteger)(i * step);
-            if (idx < points.count) {
-                [sampled addObject:points[idx]];
-            }
-        }
-        [sampled addObject:points.lastObject];
-        return [sampled copy];
-    }
-
-    return [points copy];
+    return [HAHistoryParser downsamplePoints:[HAHistoryParser pointsFromHistoryData:data]
+                                   maxPoints:maxPoints];
 }
 
 + (NSArray *)parseHistoryStateData:(NSData *)data {
-    if (!data || data.length == 0) return @[];
-
-    NSError *jsonError = nil;
-    NSArray *result = nil;
-    @try {
-        result = [NSJSONSerialization JSONObjectWithData:data options:0 error:&jsonError];
-    } @catch (NSException *e) {
-        HALogE(@"history", @"Timeline JSON parse exception: %@", e.reason);
-        return @[];
-    }
-    if (jsonError || ![result isKindOfClass:[NSArray class]] || result.count == 0) return @[];
-
-    NSArray *states = result.firstObject;
-    if (![states isKindOfClass:[NSArray class]] || states.count == 0) return @[];
-
-    NSMutableArray *segments = [NSMutableArray array];
-    NSString *prevState = nil;
-    NSTimeInterval prevTimestamp = 0;
-
-    for (NSDictionary *entry in states) {
-        if (![entry isKindOfClass:[NSDictionary class]]) continue;
-        NSString *stateStr = entry[@"state"];
-        if (!stateStr) continue;
-
-        id rawTime2 = entry[@"last_changed"];
-        if (![rawTime2 isKindOfClass:[NSString class]]) rawTime2 = entry[@"last_updated"];
-        NSString *timeStr = [rawTime2 isKindOfClass:[NSString class]] ? rawTime2 : nil;
-        if (!timeStr) continue;
-
-        NSDate *date = [HADateUtils dateFromISO8601String:timeStr];
-        if (!date) continue;
-
-        NSTimeInterval timestamp = [date timeIntervalSince1970];
-
-        if (prevState && prevTimestamp > 0) {
-            [segments addObject:@{
-                @"state": prevState,
-                @"start": @(prevTimestamp),
-                @"end": @(timestamp),
-            }];
-        }
-
-        prevState = stateStr;
-        prevTimestamp = timestamp;
-    }
-
-    if (prevState && prevTimestamp > 0) {
-        [segments addObject:@{
-            @"state": prevState,
-            @"start": @(prevTimestamp),
-            @"end": @([[NSDate date] timeIntervalSince1970]),
-        }];
-    }
-
-    return [segments copy];
+    return [HAHistoryParser timelineSegmentsFromHistoryData:data
+                                                    endTime:[[NSDate date] timeIntervalSince1970]];
 }
 
 @end
@@ -0,0 +1,25 @@
+#import <Foundation/Foundation.h>
+
+/// Parses /api/history/period responses. Foundation-only: the history
+/// manager runs it on its completion queue, and scripts/bench-core.sh
+/// benchmarks it in isolation.
+@interface HAHistoryParser : NSObject
+
+/// Numeric points from the first entity's history, oldest first:
+/// @{@"value": NSNumber, @"timestamp": NSNumber (epoch)}. Non-numeric,
+/// unknown and unavailable states are skipped. Returns @[] on bad input.
++ (NSArray<NSDictionary *> *)pointsFromHistoryData:(NSData *)data;
+
+/// Evenly strided subset of points of at most maxPoints + 1 entries; the
+/// last point is always kept so the graph reaches the present. Points at
+/// or under the limit are returned as-is. maxPoints 0 means 100.
++ (NSArray<NSDictionary *> *)downsamplePoints:(NSArray<NSDictionary *> *)points
+                                    maxPoints:(NSUInteger)maxPoints;
+
+/// State timeline from the first entity's history:
+/// @{@"state": NSString, @"start": NSNumber, @"end": NSNumber} (epoch). Each
+/// segment ends where the next begins; the last one ends at endTime.
++ (NSArray<NSDictionary *> *)timelineSegmentsFromHistoryData:(NSData *)data
+                                                     endTime:(NSTimeInterval)endTime;
+
+@end
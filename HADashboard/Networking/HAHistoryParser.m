@@ -0,0 +1,116 @@
+#import "HAHistoryParser.h"
+#import "HADateUtils.h"
+#import "HALog.h"
+
+@implementation HAHistoryParser
+
+/// First entity's state list from a history response, or nil.
++ (NSArray *)firstEntityStatesFromData:(NSData *)data {
+    if (!data || data.length == 0) return nil;
+
+    NSError *jsonError = nil;
+    NSArray *result = nil;
+    @try {
+        result = [NSJSONSerialization JSONObjectWithData:data options:0 error:&jsonError];
+    } @catch (NSException *e) {
+        HALogE(@"history", @"JSON parse exception: %@", e.reason);
+        return nil;
+    }
+    if (jsonError || ![result isKindOfClass:[NSArray class]] || result.count == 0) return nil;
+
+    NSArray *states = result.firstObject;
+    return [states isKindOfClass:[NSArray class]] ? states : nil;
+}
+
+/// Epoch of last_changed, falling back to last_updated. NO if neither parses.
+static BOOL HAHistoryEntryTimestamp(NSDictionary *entry, NSTimeInterval *outTimestamp) {
+    id rawTime = entry[@"last_changed"];
+    if (![rawTime isKindOfClass:[NSString class]]) rawTime = entry[@"last_updated"];
+    if (![rawTime isKindOfClass:[NSString class]]) return NO;
+
+    return [HADateUtils getTimeInterval:outTimestamp fromISO8601String:rawTime];
+}
+
++ (NSArray<NSDictionary *> *)pointsFromHistoryData:(NSData *)data {
+    NSArray *states = [self firstEntityStatesFromData:data];
+    if (!states) return @[];
+
+    NSMutableArray *points = [NSMutableArray arrayWithCapacity:states.count];
+    for (NSDictionary *entry in states) {
+        if (![entry isKindOfClass:[NSDictionary class]]) continue;
+        NSString *stateStr = entry[@"state"];
+        if (![stateStr isKindOfClass:[NSString class]] ||
+            [stateStr isEqualToString:@"unknown"] || [stateStr isEqualToString:@"unavailable"]) continue;
+
+        double value = [stateStr doubleValue];
+        if (value == 0 && ![stateStr isEqualToString:@"0"] && ![stateStr hasPrefix:@"0."]) continue;
+
+        NSTimeInterval timestamp = 0;
+        if (!HAHistoryEntryTimestamp(entry, &timestamp)) continue;
+
+        [points addObject:@{
+            @"value": @(value),
+            @"timestamp": @(timestamp)
+        }];
+    }
+    return [points copy];
+}
+
++ (NSArray<NSDictionary *> *)downsamplePoints:(NSArray<NSDictionary *> *)points
+                                    maxPoints:(NSUInteger)maxPoints {
+    if (maxPoints == 0) maxPoints = 100;
+    if (points.count <= maxPoints) return points;
+
+    NSMutableArray *sampled = [NSMutableArray arrayWithCapacity:maxPoints + 1];
+    double step = (double)points.count / (double)maxPoints;
+    for (NSUInteger i = 0; i < maxPoints; i++) {
+        NSUInteger idx = (NSUInteger)(i * step);
+        if (idx < points.count) {
+            [sampled addObject:points[idx]];
+        }
+    }
+    [sampled addObject:points.lastObject];
+    return [sampled copy];
+}
+
++ (NSArray<NSDictionary *> *)timelineSegmentsFromHistoryData:(NSData *)data
+                                                     endTime:(NSTimeInterval)endTime {
+    NSArray *states = [self firstEntityStatesFromData:data];
+    if (states.count == 0) return @[];
+
+    NSMutableArray *segments = [NSMutableArray array];
+    NSString *prevState = nil;
+    NSTimeInterval prevTimestamp = 0;
+
+    for (NSDictionary *entry in states) {
+        if (![entry isKindOfClass:[NSDictionary class]]) continue;
+        NSString *stateStr = entry[@"state"];
+        if (!stateStr) continue;
+
+        NSTimeInterval timestamp = 0;
+        if (!HAHistoryEntryTimestamp(entry, &timestamp)) continue;
+
+        if (prevState && prevTimestamp > 0) {
+            [segments addObject:@{
+                @"state": prevState,
+                @"start": @(prevTimestamp),
+                @"end": @(timestamp),
+            }];
+        }
+
+        prevState = stateStr;
+        prevTimestamp = timestamp;
+    }
+
+    if (prevState && prevTimestamp > 0) {
+        [segments addObject:@{
+            @"state": prevState,
+            @"start": @(prevTimestamp),
+            @"end": @(endTime),
+        }];
+    }
+
+    return [segments copy];
+}
+
+@end
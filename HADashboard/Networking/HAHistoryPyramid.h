@@ -0,0 +1,53 @@
+#import <Foundation/Foundation.h>
+
+/// Multi-resolution numeric history for one entity.
+///
+/// Raw points fetched from /api/history are merged in along with the time
+/// span they cover. From them two summary levels are derived: per-minute and
+/// per-hour buckets holding each bucket's min and max (with their timestamps)
+/// and mean. A query for any window picks the finest level that fits the point
+/// budget, so the detail view can redraw a zoom or pan from memory and only
+/// go to the network for spans never fetched at raw resolution.
+///
+/// Main thread only.
+@interface HAHistoryPyramid : NSObject
+
+- (instancetype)initWithEntityId:(NSString *)entityId;
+
+@property (nonatomic, copy, readonly) NSString *entityId;
+
+/// Number of raw points held.
+@property (nonatomic, assign, readonly) NSUInteger rawCount;
+
+/// Approximate memory held, for NSCache cost accounting.
+@property (nonatomic, assign, readonly) NSUInteger byteCost;
+
+/// Merge raw points (HAGraphView format: @"timestamp", @"value") that are
+/// the complete history for start...end. Points already held inside that
+/// span are replaced.
+- (void)addRawPoints:(NSArray<NSDictionary *> *)points fromTime:(NSTimeInterval)start toTime:(NSTimeInterval)end;
+
+/// YES if start...end is entirely covered by raw fetches.
+- (BOOL)coversFromTime:(NSTimeInterval)start toTime:(NSTimeInterval)end;
+
+/// Sub-spans of start...end not yet covered by raw data, as
+/// @[@(start), @(end)] pairs in time order.
+- (NSArray<NSArray<NSNumber *> *> *)missingRangesFromTime:(NSTimeInterval)start toTime:(NSTimeInterval)end;
+
+/// At most ~maxPoints points for start...end, from the finest level that fits.
+/// Includes the nearest point on each side of the window (if held) so lines
+/// reach the edges.
+- (NSArray<NSDictionary *> *)pointsFromTime:(NSTimeInterval)start
+                                     toTime:(NSTimeInterval)end
+                                  maxPoints:(NSUInteger)maxPoints;
+
+/// Points for the whole of start...end where focusStart...focusEnd gets the
+/// full maxPoints budget and the remainder is filled in coarsely, so a zoomed
+/// graph can still be panned or pinched out without waiting for data.
+- (NSArray<NSDictionary *> *)pointsFromTime:(NSTimeInterval)start
+                                     toTime:(NSTimeInterval)end
+                                 focusStart:(NSTimeInterval)focusStart
+                                   focusEnd:(NSTimeInterval)focusEnd
+                                  maxPoints:(NSUInteger)maxPoints;
+
+@end
@@ -0,0 +1,389 @@
+#import "HAHistoryPyramid.h"
+
+typedef struct {
+    double start;
+    double end;
+} HAHistorySpan;
+
+typedef struct {
+    double start;     // bucket start, aligned to a multiple of the level width
+    double min;
+    double max;
+    double minTime;   // timestamp of the raw point holding min
+    double maxTime;   // timestamp of the raw point holding max
+    double sum;
+    NSUInteger count;
+} HAHistoryBucket;
+
+/// Gaps shorter than this between fetched spans are not worth a request.
+static const NSTimeInterval kMinMissingSpan = 1.0;
+
+static const NSTimeInterval kMinuteWidth = 60.0;
+static const NSTimeInterval kHourWidth = 3600.0;
+
+@interface HAHistoryPyramid ()
+@property (nonatomic, copy, readwrite) NSString *entityId;
+@property (nonatomic, strong) NSMutableData *timestampData;
+@property (nonatomic, strong) NSMutableData *valueData;
+@property (nonatomic, strong) NSMutableData *coverageData;   // HAHistorySpan, sorted, disjoint
+@property (nonatomic, strong) NSMutableData *minuteBuckets;  // HAHistoryBucket
+@property (nonatomic, strong) NSMutableData *hourBuckets;    // HAHistoryBucket
+@property (nonatomic, assign) BOOL levelsDirty;
+@end
+
+@implementation HAHistoryPyramid
+
+- (instancetype)initWithEntityId:(NSString *)entityId {
+    self = [super init];
+    if (self) {
+        _entityId = [entityId copy];
+        _timestampData = [NSMutableData data];
+        _valueData = [NSMutableData data];
+        _coverageData = [NSMutableData data];
+        _minuteBuckets = [NSMutableData data];
+        _hourBuckets = [NSMutableData data];
+    }
+    return self;
+}
+
+- (NSUInteger)rawCount {
+    return self.timestampData.length / sizeof(double);
+}
+
+- (NSUInteger)byteCost {
+    return self.timestampData.length + self.valueData.length + self.coverageData.length +
+           self.minuteBuckets.length + self.hourBuckets.length;
+}
+
+#pragma mark - Merge
+
+- (void)addRawPoints:(NSArray<NSDictionary *> *)points fromTime:(NSTimeInterval)start toTime:(NSTimeInterval)end {
+    if (end <= start) return;
+
+    // Pack the incoming span. A point stamped before `start` is the state
+    // carried into the window, so it is pinned to the window start.
+    NSMutableData *newTs = [NSMutableData dataWithCapacity:points.count * sizeof(double)];
+    NSMutableData *newVs = [NSMutableData dataWithCapacity:points.count * sizeof(double)];
+    double lastT = -HUGE_VAL;
+    BOOL sorted = YES;
+    for (NSDictionary *pt in points) {
+        if (![pt isKindOfClass:[NSDictionary class]]) continue;
+        id tObj = pt[@"timestamp"];
+        id vObj = pt[@"value"];
+        if (![tObj isKindOfClass:[NSNumber class]] || ![vObj isKindOfClass:[NSNumber class]]) continue;
+        double t = MAX([tObj doubleValue], start);
+        double v = [vObj doubleValue];
+        if (t > end || !isfinite(v)) continue;
+        if (t < lastT) sorted = NO;
+        lastT = t;
+        [newTs appendBytes:&t length:sizeof(double)];
+        [newVs appendBytes:&v length:sizeof(double)];
+    }
+    if (!sorted) {
+        [self sortTimestamps:newTs values:newVs];
+    }
+
+    // Splice: held points before start, the new span, held points after end
+    const double *ts = self.timestampData.bytes;
+    const double *vs = self.valueData.bytes;
+    NSUInteger n = self.rawCount;
+    NSUInteger head = [self lowerBoundForTime:start];
+    NSUInteger tail = [self upperBoundForTime:end];
+
+    NSMutableData *mergedTs = [NSMutableData dataWithCapacity:(head + (n - tail)) * sizeof(double) + newTs.length];
+    NSMutableData *mergedVs = [NSMutableData dataWithCapacity:(head + (n - tail)) * sizeof(double) + newVs.length];
+    [mergedTs appendBytes:ts length:head * sizeof(double)];
+    [mergedVs appendBytes:vs length:head * sizeof(double)];
+    [mergedTs appendData:newTs];
+    [mergedVs appendData:newVs];
+    if (tail < n) {
+        [mergedTs appendBytes:ts + tail length:(n - tail) * sizeof(double)];
+        [mergedVs appendBytes:vs + tail length:(n - tail) * sizeof(double)];
+    }
+    self.timestampData = mergedTs;
+    self.valueData = mergedVs;
+
+    [self addCoverageFromTime:start toTime:end];
+    self.levelsDirty = YES;
+}
+
+- (void)sortTimestamps:(NSMutableData *)tsData values:(NSMutableData *)vsData {
+    NSUInteger n = tsData.length / sizeof(double);
+    double *ts = tsData.mutableBytes;
+    double *vs = vsData.mutableBytes;
+    // Insertion sort: out-of-order history is rare and nearly sorted
+    for (NSUInteger i = 1; i < n; i++) {
+        double t = ts[i], v = vs[i];
+        NSUInteger j = i;
+        while (j > 0 && ts[j - 1] > t) {
+            ts[j] = ts[j - 1];
+            vs[j] = vs[j - 1];
+            j--;
+        }
+        ts[j] = t;
+        vs[j] = v;
+    }
+}
+
+#pragma mark - Coverage
+
+- (void)addCoverageFromTime:(double)start toTime:(double)end {
+    NSUInteger count = self.coverageData.length / sizeof(HAHistorySpan);
+    const HAHistorySpan *spans = self.coverageData.bytes;
+    NSMutableData *merged = [NSMutableData dataWithCapacity:(count + 1) * sizeof(HAHistorySpan)];
+    HAHistorySpan incoming = { start, end };
+    BOOL inserted = NO;
+
+    for (NSUInteger i = 0; i < count; i++) {
+        HAHistorySpan span = spans[i];
+        if (span.end + kMinMissingSpan < incoming.start) {
+            [merged appendBytes:&span length:sizeof(span)];
+        } else if (incoming.end + kMinMissingSpan < span.start) {
+            if (!inserted) {
+                [merged appendBytes:&incoming length:sizeof(incoming)];
+                inserted = YES;
+            }
+            [merged appendBytes:&span length:sizeof(span)];
+        } else {
+            incoming.start = MIN(incoming.start, span.start);
+            incoming.end = MAX(incoming.end, span.end);
+        }
+    }
+    if (!inserted) {
+        [merged appendBytes:&incoming length:sizeof(incoming)];
+    }
+    self.coverageData = merged;
+}
+
+- (NSArray<NSArray<NSNumber *> *> *)missingRangesFromTime:(NSTimeInterval)start toTime:(NSTimeInterval)end {
+    NSMutableArray *missing = [NSMutableArray array];
+    if (end <= start) return missing;
+
+    NSUInteger count = self.coverageData.length / sizeof(HAHistorySpan);
+    const HAHistorySpan *spans = self.coverageData.bytes;
+    double cursor = start;
+    for (NSUInteger i = 0; i < count && cursor < end; i++) {
+        if (spans[i].end <= cursor) continue;
+        if (spans[i].start >= end) break;
+        if (spans[i].start - cursor >= kMinMissingSpan) {
+            [missing addObject:@[@(cursor), @(spans[i].start)]];
+        }
+        cursor = MAX(cursor, spans[i].end);
+    }
+    if (end - cursor >= kMinMissingSpan) {
+        [missing addObject:@[@(cursor), @(end)]];
+    }
+    return missing;
+}
+
+- (BOOL)coversFromTime:(NSTimeInterval)start toTime:(NSTimeInterval)end {
+    return [self missingRangesFromTime:start toTime:end].count == 0;
+}
+
+#pragma mark - Levels
+
+- (void)rebuildLevelsIfNeeded {
+    if (!self.levelsDirty) return;
+    self.levelsDirty = NO;
+    self.minuteBuckets = [self bucketsWithWidth:kMinuteWidth];
+    self.hourBuckets = [self bucketsWithWidth:kHourWidth];
+}
+
+- (NSMutableData *)bucketsWithWidth:(double)width {
+    NSMutableData *buckets = [NSMutableData data];
+    const double *ts = self.timestampData.bytes;
+    const double *vs = self.valueData.bytes;
+    NSUInteger n = self.rawCount;
+
+    HAHistoryBucket bucket = {0};
+    BOOL open = NO;
+    for (NSUInteger i = 0; i < n; i++) {
+        double bucketStart = floor(ts[i] / width) * width;
+        if (!open || bucketStart != bucket.start) {
+            if (open) [buckets appendBytes:&bucket length:sizeof(bucket)];
+            bucket = (HAHistoryBucket){ bucketStart, vs[i], vs[i], ts[i], ts[i], 0, 0 };
+            open = YES;
+        }
+        if (vs[i] < bucket.min) { bucket.min = vs[i]; bucket.minTime = ts[i]; }
+        if (vs[i] > bucket.max) { bucket.max = vs[i]; bucket.maxTime = ts[i]; }
+        bucket.sum += vs[i];
+        bucket.count++;
+    }
+    if (open) [buckets appendBytes:&bucket length:sizeof(bucket)];
+    return buckets;
+}
+
+/// Index range of buckets whose start lies in [start, end).
+static NSRange HAHistoryBucketRange(NSData *data, double start, double end) {
+    NSUInteger n = data.length / sizeof(HAHistoryBucket);
+    const HAHistoryBucket *b = data.bytes;
+    NSUInteger lo = 0, hi = n;
+    while (lo < hi) {
+        NSUInteger mid = lo + (hi - lo) / 2;
+        if (b[mid].start < start) lo = mid + 1; else hi = mid;
+    }
+    NSUInteger first = lo;
+    hi = n;
+    while (lo < hi) {
+        NSUInteger mid = lo + (hi - lo) / 2;
+        if (b[mid].start < end) lo = mid + 1; else hi = mid;
+    }
+    return NSMakeRange(first, lo - first);
+}
+
+#pragma mark - Queries
+
+- (NSUInteger)lowerBoundForTime:(double)time {
+    const double *ts = self.timestampData.bytes;
+    NSUInteger lo = 0, hi = self.rawCount;
+    while (lo < hi) {
+        NSUInteger mid = lo + (hi - lo) / 2;
+        if (ts[mid] < time) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+- (NSUInteger)upperBoundForTime:(double)time {
+    const double *ts = self.timestampData.bytes;
+    NSUInteger lo = 0, hi = self.rawCount;
+    while (lo < hi) {
+        NSUInteger mid = lo + (hi - lo) / 2;
+        if (ts[mid] <= time) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+static inline void HAHistoryAppendPoint(NSMutableArray *out, double t, double v) {
+    [out addObject:@{@"value": @(v), @"timestamp": @(t)}];
+}
+
+/// Append points with start <= timestamp < end (<= end if inclusiveEnd).
+- (void)appendPointsFromTime:(double)start
+                      toTime:(double)end
+                inclusiveEnd:(BOOL)inclusiveEnd
+                   maxPoints:(NSUInteger)maxPoints
+                          to:(NSMutableArray *)out {
+    if (end < start || maxPoints == 0) return;
+    const double *ts = self.timestampData.bytes;
+    const double *vs = self.valueData.bytes;
+
+    NSUInteger first = [self lowerBoundForTime:start];
+    NSUInteger last = inclusiveEnd ? [self upperBoundForTime:end] : [self lowerBoundForTime:end];
+    if (last <= first) return;
+
+    // Raw when it fits
+    if (last - first <= maxPoints) {
+        for (NSUInteger i = first; i < last; i++) HAHistoryAppendPoint(out, ts[i], vs[i]);
+        return;
+    }
+
+    [self rebuildLevelsIfNeeded];
+    // Query from the aligned bucket start so a bucket straddling `start`
+    // still contributes; emitted extremes are filtered to the window below.
+    NSRange minuteRange = HAHistoryBucketRange(self.minuteBuckets, floor(start / kMinuteWidth) * kMinuteWidth, inclusiveEnd ? end + 1e-6 : end);
+    NSData *levelData = self.minuteBuckets;
+    NSRange range = minuteRange;
+    NSUInteger groupSize = 1;
+    BOOL useMean = NO;
+
+    if (minuteRange.length * 2 > maxPoints) {
+        levelData = self.hourBuckets;
+        range = HAHistoryBucketRange(self.hourBuckets, floor(start / kHourWidth) * kHourWidth, inclusiveEnd ? end + 1e-6 : end);
+        if (range.length * 2 > maxPoints) {
+            if (range.length <= maxPoints) {
+                useMean = YES;
+            } else {
+                groupSize = (range.length * 2 + maxPoints - 1) / maxPoints;
+            }
+        }
+    }
+    const HAHistoryBucket *buckets = levelData.bytes;
+    for (NSUInteger g = range.location; g < NSMaxRange(range); g += groupSize) {
+        NSUInteger groupEnd = MIN(g + groupSize, NSMaxRange(range));
+        HAHistoryBucket agg = buckets[g];
+        for (NSUInteger k = g + 1; k < groupEnd; k++) {
+            const HAHistoryBucket b = buckets[k];
+            if (b.min < agg.min) { agg.min = b.min; agg.minTime = b.minTime; }
+            if (b.max > agg.max) { agg.max = b.max; agg.maxTime = b.maxTime; }
+            agg.sum += b.sum;
+            agg.count += b.count;
+        }
+
+        if (useMean) {
+            double t = (agg.minTime + agg.maxTime) / 2.0;
+            if (t >= start && (inclusiveEnd ? t <= end : t < end)) {
+                HAHistoryAppendPoint(out, t, agg.sum / (double)agg.count);
+            }
+            continue;
+        }
+
+        // Extremes in time order; a flat or single-sample bucket emits once
+        double t0 = agg.minTime, v0 = agg.min, t1 = agg.maxTime, v1 = agg.max;
+        if (t1 < t0) {
+            double tt = t0, tv = v0;
+            t0 = t1; v0 = v1;
+            t1 = tt; v1 = tv;
+        }
+        if (t0 >= start && (inclusiveEnd ? t0 <= end : t0 < end)) HAHistoryAppendPoint(out, t0, v0);
+        if (t1 != t0 && t1 >= start && (inclusiveEnd ? t1 <= end : t1 < end)) HAHistoryAppendPoint(out, t1, v1);
+    }
+}
+
+- (void)appendNeighbourBefore:(double)start to:(NSMutableArray *)out {
+    NSUInteger i = [self lowerBoundForTime:start];
+    if (i > 0) {
+        HAHistoryAppendPoint(out, ((const double *)self.timestampData.bytes)[i - 1],
+                             ((const double *)self.valueData.bytes)[i - 1]);
+    }
+}
+
+- (void)appendNeighbourAfter:(double)end to:(NSMutableArray *)out {
+    NSUInteger i = [self upperBoundForTime:end];
+    if (i < self.rawCount) {
+        HAHistoryAppendPoint(out, ((const double *)self.timestampData.bytes)[i],
+                             ((const double *)self.valueData.bytes)[i]);
+    }
+}
+
+- (NSArray<NSDictionary *> *)pointsFromTime:(NSTimeInterval)start
+                                     toTime:(NSTimeInterval)end
+                                  maxPoints:(NSUInteger)maxPoints {
+    NSMutableArray *out = [NSMutableArray array];
+    if (end < start || self.rawCount == 0) return out;
+    [self appendNeighbourBefore:start to:out];
+    [self appendPointsFromTime:start toTime:end inclusiveEnd:YES maxPoints:maxPoints to:out];
+    [self appendNeighbourAfter:end to:out];
+    return out;
+}
+
+- (NSArray<NSDictionary *> *)pointsFromTime:(NSTimeInterval)start
+                                     toTime:(NSTimeInterval)end
+                                 focusStart:(NSTimeInterval)focusStart
+                                   focusEnd:(NSTimeInterval)focusEnd
+                                  maxPoints:(NSUInteger)maxPoints {
+    focusStart = MAX(focusStart, start);
+    focusEnd = MIN(focusEnd, end);
+    if (focusEnd <= focusStart) {
+        return [self pointsFromTime:start toTime:end maxPoints:maxPoints];
+    }
+
+    NSMutableArray *out = [NSMutableArray array];
+    if (end < start || self.rawCount == 0) return out;
+    // Context outside the focus only needs to be good enough to pan into
+    NSUInteger contextPoints = MAX(maxPoints / 4, (NSUInteger)8);
+    [self appendNeighbourBefore:start to:out];
+    [self appendPointsFromTime:start toTime:focusStart inclusiveEnd:NO maxPoints:contextPoints to:out];
+    [self appendPointsFromTime:focusStart toTime:focusEnd inclusiveEnd:YES maxPoints:maxPoints to:out];
+    if (end > focusEnd) {
+        // (focusEnd, end]: skip points stamped exactly at focusEnd
+        NSUInteger before = out.count;
+        [self appendPointsFromTime:focusEnd toTime:end inclusiveEnd:YES maxPoints:contextPoints to:out];
+        if (out.count > before && [out[before][@"timestamp"] doubleValue] <= focusEnd) {
+            [out removeObjectAtIndex:before];
+        }
+    }
+    [self appendNeighbourAfter:end to:out];
+    return out;
+}
+
+@end
@@ -124,9 +124,10 @@
             command[@"entity_ids"] = entityIds;
         }
 
-        [cm sendCommand:command completion:^(id result, NSError *error) {
+        // Bulk priority: a long logbook query must not hold up taps or camera streams
+        [cm sendCommand:command priority:HACommandPriorityBulk timeout:20.0 completion:^(id result, NSError *error) {
             if (error || ![result isKindOfClass:[NSArray class]]) {
-                // WebSocket failed — fall back to REST
+                // WebSocket failed or timed out — fall back to REST
                 [self fetchEntriesForEntityIdsViaREST:entityIds hoursBack:hours completion:completion];
                 return;
             }
@@ -0,0 +1,30 @@
+#import <Foundation/Foundation.h>
+
+/// Byte-level framing for multipart/x-mixed-replace MJPEG streams.
+/// Foundation-only and stateless; HAMJPEGStreamParser owns the buffer and
+/// the decode. Split out so scripts/bench-core.sh can benchmark it.
+@interface HAMJPEGFrameScanner : NSObject
+
+/// Delimiter between parts, "\r\n--<boundary>\r\n", from a Content-Type
+/// header such as `multipart/x-mixed-replace; boundary=frame`. Quotes and a
+/// leading "--" are tolerated. Falls back to HA's "frame" boundary.
++ (NSData *)delimiterForContentType:(NSString *)contentType;
+
+/// Remove every complete part (the bytes before each delimiter) from the
+/// front of buffer and return them in order. The trailing partial part stays
+/// in buffer. The consumed prefix is removed with one move, however many
+/// parts it held.
+///
+/// scanOffset, if non-NULL, carries how far buffer has already been searched
+/// without finding a delimiter, so data arriving in small packets isn't
+/// rescanned from the start each time. Start it at 0; it's updated on return.
++ (NSArray<NSData *> *)consumePartsFromBuffer:(NSMutableData *)buffer
+                                    delimiter:(NSData *)delimiter
+                                   scanOffset:(NSUInteger *)scanOffset;
+
+/// JPEG bytes from one part: everything from the first SOI marker (FF D8),
+/// skipping the part's headers. nil if there is no SOI or the result is too
+/// small to be an image.
++ (NSData *)JPEGDataFromPart:(NSData *)part;
+
+@end
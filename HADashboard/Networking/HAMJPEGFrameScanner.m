@@ -0,0 +1,82 @@
+#import "HAMJPEGFrameScanner.h"
+#include <string.h>
+
+static const NSUInteger kMinimumJPEGLength = 100;
+
+@implementation HAMJPEGFrameScanner
+
++ (NSData *)delimiterForContentType:(NSString *)contentType {
+    // Content-Type: multipart/x-mixed-replace; boundary=--frameboundary
+    // or: multipart/x-mixed-replace;boundary=frameboundary
+    NSRange boundaryRange = contentType
+        ? [contentType rangeOfString:@"boundary=" options:NSCaseInsensitiveSearch]
+        : NSMakeRange(NSNotFound, 0);
+    if (boundaryRange.location == NSNotFound) {
+        // Fallback: common HA boundary
+        return [@"\r\n--frame\r\n" dataUsingEncoding:NSUTF8StringEncoding];
+    }
+    NSString *boundary = [contentType substringFromIndex:NSMaxRange(boundaryRange)];
+    // Trim quotes and whitespace
+    boundary = [boundary stringByTrimmingCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@"\" \t"]];
+    // The actual boundary in the body is prefixed with --
+    if (![boundary hasPrefix:@"--"]) {
+        boundary = [@"--" stringByAppendingString:boundary];
+    }
+    return [[NSString stringWithFormat:@"\r\n%@\r\n", boundary] dataUsingEncoding:NSUTF8StringEncoding];
+}
+
++ (NSArray<NSData *> *)consumePartsFromBuffer:(NSMutableData *)buffer
+                                    delimiter:(NSData *)delimiter
+                                   scanOffset:(NSUInteger *)scanOffset {
+    NSUInteger length = buffer.length;
+    NSUInteger delimiterLength = delimiter.length;
+    NSUInteger searchFrom = scanOffset ? MIN(*scanOffset, length) : 0;
+    if (delimiterLength == 0 || length < delimiterLength) return @[];
+
+    NSMutableArray<NSData *> *parts = nil;
+    NSUInteger partStart = 0;
+    while (searchFrom + delimiterLength <= length) {
+        NSRange found = [buffer rangeOfData:delimiter options:0
+                                      range:NSMakeRange(searchFrom, length - searchFrom)];
+        if (found.location == NSNotFound) break;
+
+        if (!parts) parts = [NSMutableArray array];
+        [parts addObject:[buffer subdataWithRange:NSMakeRange(partStart, found.location - partStart)]];
+        partStart = NSMaxRange(found);
+        searchFrom = partStart;
+    }
+
+    if (partStart > 0) {
+        [buffer replaceBytesInRange:NSMakeRange(0, partStart) withBytes:NULL length:0];
+        length -= partStart;
+    }
+    // A delimiter can straddle the end of what has arrived so far; the next
+    // search must start early enough to see all of it.
+    if (scanOffset) {
+        *scanOffset = length >= delimiterLength ? length - delimiterLength + 1 : 0;
+    }
+    return parts ?: @[];
+}
+
++ (NSData *)JPEGDataFromPart:(NSData *)part {
+    NSUInteger length = part.length;
+    if (length < 10) return nil;
+
+    // Find JPEG start marker (0xFF 0xD8) — skip any preceding HTTP headers
+    const uint8_t *bytes = part.bytes;
+    const uint8_t *cursor = bytes;
+    const uint8_t *end = bytes + length;
+    while (cursor + 1 < end) {
+        const uint8_t *marker = memchr(cursor, 0xFF, (size_t)(end - cursor - 1));
+        if (!marker) return nil;
+        if (marker[1] == 0xD8) {
+            NSUInteger jpegStart = (NSUInteger)(marker - bytes);
+            if (length - jpegStart < kMinimumJPEGLength) return nil; // Too small for a valid JPEG
+            return [part subdataWithRange:NSMakeRange(jpegStart, length - jpegStart)];
+        }
+        cursor = marker + 1;
+    }
+    return nil;
+}
+
+@end
@@ -1,5 +1,7 @@
 #import "HAMJPEGStreamParser.h"
+#import "HAMJPEGFrameScanner.h"
 #import "HALog.h"
+#import "HAPerfMonitor.h"
 
 /// Queue for JPEG decoding — avoid blocking main thread with image decompression.
 static dispatch_queue_t _decodeQueue;
@@ -11,6 +13,7 @@ static const NSTimeInterval kFirstFrameTimeout = 10.0;
 @property (nonatomic, strong) NSURLSessionDataTask *task;
 @property (nonatomic, strong) NSMutableData *buffer;
 @property (nonatomic, copy) NSData *boundaryData;
+@property (nonatomic, assign) NSUInteger scanOffset; // buffer bytes already searched for a boundary
 @property (nonatomic, assign) BOOL streaming;
 @property (nonatomic, assign) BOOL receivedFirstFrame;
 @property (nonatomic, strong) NSTimer *firstFrameTimer;
@@ -35,6 +38,7 @@ static const NSTimeInterval kFirstFrameTimeout = 10.0;
     [self stop]; // Cancel any existing stream
 
     self.buffer = [NSMutableData data];
+    self.scanOffset = 0;
     self.boundaryData = nil; // Will be extracted from Content-Type header
     self.streaming = YES;
 
@@ -62,6 +66,7 @@ static const NSTimeInterval kFirstFrameTimeout = 10.0;
     [self.session invalidateAndCancel];
     self.session = nil;
     self.buffer = nil;
+    self.scanOffset = 0;
     self.boundaryData = nil;
     self.receivedFirstFrame = NO;
     self.usePartAccumulation = NO;
@@ -154,26 +159,7 @@ static const NSTimeInterval kFirstFrameTimeout = 10.0;
 #pragma mark - Boundary Parsing
 
 - (void)extractBoundaryFromContentType:(NSString *)contentType {
-    // Content-Type: multipart/x-mixed-replace; boundary=--frameboundary
-    // or: multipart/x-mixed-replace;boundary=frameboundary
-    if (!contentType) {
-        // Fallback: common HA boundary
-        self.boundaryData = [@"\r\n--frame\r\n" dataUsingEncoding:NSUTF8StringEncoding];
-        return;
-    }
-    NSRange boundaryRange = [contentType rangeOfString:@"boundary=" options:NSCaseInsensitiveSearch];
-    if (boundaryRange.location == NSNotFound) {
-        self.boundaryData = [@"\r\n--frame\r\n" dataUsingEncoding:NSUTF8StringEncoding];
-        return;
-    }
-    NSString *boundary = [contentType substringFromIndex:NSMaxRange(boundaryRange)];
-    // Trim quotes and whitespace
-    boundary = [boundary stringByTrimmingCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@"\" \t"]];
-    // The actual boundary in the body is prefixed with --
-    if (![boundary hasPrefix:@"--"]) {
-        boundary = [@"--" stringByAppendingString:boundary];
-    }
-    self.boundaryData = [[NSString stringWithFormat:@"\r\n%@\r\n", boundary] dataUsingEncoding:NSUTF8StringEncoding];
+    self.boundaryData = [HAMJPEGFrameScanner delimiterForContentType:contentType];
 }
 
 #pragma mark - Frame Extraction
@@ -181,47 +167,23 @@ static const NSTimeInterval kFirstFrameTimeout = 10.0;
 - (void)extractFrames {
     if (!self.boundaryData || self.buffer.length == 0) return;
 
-    // Search for JPEG data between boundaries.
-    // JPEG frames start after headers (Content-Type + Content-Length + empty line)
-    // and end at the next boundary marker.
-
-    while (self.streaming) {
-        NSRange boundaryRange = [self rangeOfData:self.boundaryData inData:self.buffer];
-        if (boundaryRange.location == NSNotFound) break;
-
-        // Everything before the boundary is part of the current frame (headers + JPEG)
-        NSData *chunk = [self.buffer subdataWithRange:NSMakeRange(0, boundaryRange.location)];
-
-        // Remove processed data + boundary from buffer
-        NSUInteger consumed = NSMaxRange(boundaryRange);
-        if (consumed < self.buffer.length) {
-            NSData *remaining = [self.buffer subdataWithRange:NSMakeRange(consumed, self.buffer.length - consumed)];
-            self.buffer = [remaining mutableCopy];
-        } else {
-            [self.buffer setLength:0];
-        }
-
-        // Extract JPEG from chunk (skip HTTP headers to find JPEG data)
-        [self decodeJPEGFromChunk:chunk];
+    // Each part is headers + JPEG, ending at the next boundary marker. The
+    // trailing partial part stays in the buffer until its boundary arrives.
+    NSUInteger scanOffset = self.scanOffset;
+    NSArray<NSData *> *parts = [HAMJPEGFrameScanner consumePartsFromBuffer:self.buffer
+                                                                 delimiter:self.boundaryData
+                                                                scanOffset:&scanOffset];
+    self.scanOffset = scanOffset;
+
+    for (NSData *part in parts) {
+        if (!self.streaming) break;
+        [self decodeJPEGFromChunk:part];
     }
 }
 
 - (void)decodeJPEGFromChunk:(NSData *)chunk {
-    if (chunk.length < 10) return;
-
-    // Find JPEG start marker (0xFF 0xD8) — skip any preceding HTTP headers
-    const uint8_t *bytes = chunk.bytes;
-    NSUInteger jpegStart = NSNotFound;
-    for (NSUInteger i = 0; i + 1 < chunk.length; i++) {
-        if (bytes[i] == 0xFF && bytes[i + 1] == 0xD8) {
-            jpegStart = i;
-            break;
-        }
-    }
-    if (jpegStart == NSNotFound) return;
-
-    NSData *jpegData = [chunk subdataWithRange:NSMakeRange(jpegStart, chunk.length - jpegStart)];
-    if (jpegData.length < 100) return; // Too small for a valid JPEG
+    NSData *jpegData = [HAMJPEGFrameScanner JPEGDataFromPart:chunk];
+    if (!jpegData) return;
 
     // Decode on background thread to avoid main thread stalls.
     // Use weak/strong to prevent crash if parser is deallocated mid-decode (iPad 2 iOS 9).
@@ -232,13 +194,18 @@ static const NSTimeInterval kFirstFrameTimeout = 10.0;
 
         // Autoreleasepool per frame prevents memory accumulation on A5 (iPad 2)
         @autoreleasepool {
+            HAPerfSpan decodeSpan = HAPerfSpanBegin(HAPerfCategoryImage, "image.decode", "mjpeg");
             UIImage *lazyImage = [UIImage imageWithData:jpegData];
-            if (!lazyImage) return;
+            if (!lazyImage) {
+                HAPerfSpanEnd(decodeSpan);
+                return;
+            }
 
             UIGraphicsBeginImageContextWithOptions(lazyImage.size, YES, 1.0);
             [lazyImage drawAtPoint:CGPointZero];
             UIImage *decoded = UIGraphicsGetImageFromCurrentImageContext();
             UIGraphicsEndImageContext();
+            HAPerfSpanEnd(decodeSpan);
 
             if (!decoded || !strongSelf.streaming) return;
 
@@ -268,14 +235,6 @@ static const NSTimeInterval kFirstFrameTimeout = 10.0;
 
 #pragma mark - Helpers
 
-- (NSRange)rangeOfData:(NSData *)needle inData:(NSData *)haystack {
-    if (needle.length == 0 || haystack.length < needle.length) {
-        return NSMakeRange(NSNotFound, 0);
-    }
-    // Use NSData's rangeOfData if available (iOS 4+)
-    return [haystack rangeOfData:needle options:0 range:NSMakeRange(0, haystack.length)];
-}
-
 - (void)reportError:(NSError *)error {
     dispatch_async(dispatch_get_main_queue(), ^{
         if (self.errorHandler) {
@@ -0,0 +1,49 @@
+#import <Foundation/Foundation.h>
+
+@class HAEntity;
+
+/// Remembers the last server-confirmed state of every entity that has an
+/// optimistic update outstanding, so the UI can be reverted if Home Assistant
+/// never confirms it.
+///
+/// Flow: -recordEntity: right before an optimistic change is applied,
+/// -armEntityId: once the service call is actually on the wire, and
+/// -confirmEntityId: whenever the server reports a state for that entity.
+/// If an armed entity isn't confirmed before its deadline (or the call fails
+/// outright via -rollbackEntityId:), revertHandler is invoked with the saved
+/// state. Entities whose call is still waiting in the offline queue aren't
+/// armed, so their optimistic state holds until the replay.
+///
+/// Main thread only.
+@interface HAOptimisticStateLedger : NSObject
+
+/// Seconds after -armEntityId: before an unconfirmed entity is reverted. Default 10.
+@property (nonatomic, assign) NSTimeInterval confirmationTimeout;
+
+/// Called on main with the entity ID and the state/attributes to restore.
+@property (nonatomic, copy) void (^revertHandler)(NSString *entityId, NSString *state, NSDictionary *attributes);
+
+/// Snapshot the entity's current state unless a snapshot is already held
+/// (stacked optimistic updates revert to the last confirmed state, not to
+/// an earlier optimistic one).
+- (void)recordEntity:(HAEntity *)entity;
+
+/// Start (or restart) the confirmation deadline for a recorded entity.
+- (void)armEntityId:(NSString *)entityId;
+
+/// Stop the deadline without confirming (the call went back into the
+/// offline queue; it will be re-armed on replay).
+- (void)disarmEntityId:(NSString *)entityId;
+
+/// The server reported a state — drop the snapshot, no revert.
+- (void)confirmEntityId:(NSString *)entityId;
+
+/// Drop every snapshot (full state refresh from the server).
+- (void)confirmAll;
+
+/// The call was rejected — revert now.
+- (void)rollbackEntityId:(NSString *)entityId;
+
+- (BOOL)hasPendingEntityId:(NSString *)entityId;
+
+@end
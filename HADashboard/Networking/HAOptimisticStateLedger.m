@@ -0,0 +1,82 @@
+#import "HAOptimisticStateLedger.h"
+#import "HAEntity.h"
+#import "HALog.h"
+
+@interface HAOptimisticSnapshot : NSObject
+@property (nonatomic, copy) NSString *state;
+@property (nonatomic, copy) NSDictionary *attributes;
+@property (nonatomic, assign) NSUInteger generation; // bumped on each arm so stale timers no-op
+@end
+
+@implementation HAOptimisticSnapshot
+@end
+
+#pragma mark -
+
+@interface HAOptimisticStateLedger ()
+@property (nonatomic, strong) NSMutableDictionary<NSString *, HAOptimisticSnapshot *> *snapshots;
+@end
+
+@implementation HAOptimisticStateLedger
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _snapshots = [NSMutableDictionary dictionary];
+        _confirmationTimeout = 10.0;
+    }
+    return self;
+}
+
+- (void)recordEntity:(HAEntity *)entity {
+    if (!entity.entityId || self.snapshots[entity.entityId]) return;
+    HAOptimisticSnapshot *snapshot = [[HAOptimisticSnapshot alloc] init];
+    snapshot.state = entity.state;
+    snapshot.attributes = entity.attributes;
+    self.snapshots[entity.entityId] = snapshot;
+}
+
+- (void)armEntityId:(NSString *)entityId {
+    HAOptimisticSnapshot *snapshot = entityId ? self.snapshots[entityId] : nil;
+    if (!snapshot) return;
+    NSUInteger generation = ++snapshot.generation;
+
+    __weak typeof(self) weakSelf = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.confirmationTimeout * NSEC_PER_SEC)),
+                   dispatch_get_main_queue(), ^{
+        HAOptimisticStateLedger *strongSelf = weakSelf;
+        HAOptimisticSnapshot *current = strongSelf.snapshots[entityId];
+        if (current != snapshot || current.generation != generation) return;
+        HALogW(@"conn", @"No state_changed for %@ within %.0fs — reverting optimistic update",
+               entityId, strongSelf.confirmationTimeout);
+        [strongSelf rollbackEntityId:entityId];
+    });
+}
+
+- (void)disarmEntityId:(NSString *)entityId {
+    HAOptimisticSnapshot *snapshot = entityId ? self.snapshots[entityId] : nil;
+    snapshot.generation++;
+}
+
+- (void)confirmEntityId:(NSString *)entityId {
+    if (entityId) [self.snapshots removeObjectForKey:entityId];
+}
+
+- (void)confirmAll {
+    [self.snapshots removeAllObjects];
+}
+
+- (void)rollbackEntityId:(NSString *)entityId {
+    HAOptimisticSnapshot *snapshot = entityId ? self.snapshots[entityId] : nil;
+    if (!snapshot) return;
+    [self.snapshots removeObjectForKey:entityId];
+    if (self.revertHandler) {
+        self.revertHandler(entityId, snapshot.state, snapshot.attributes);
+    }
+}
+
+- (BOOL)hasPendingEntityId:(NSString *)entityId {
+    return entityId && self.snapshots[entityId] != nil;
+}
+
+@end
@@ -0,0 +1,51 @@
+#import <Foundation/Foundation.h>
+
+/// A service call waiting to be sent to Home Assistant.
+@interface HAServiceCall : NSObject
+
+@property (nonatomic, copy, readonly) NSString *domain;
+@property (nonatomic, copy, readonly) NSString *service;
+@property (nonatomic, copy, readonly) NSDictionary *serviceData; // includes entity_id when targeted
+@property (nonatomic, copy, readonly) NSString *entityId;
+@property (nonatomic, strong, readonly) NSDate *enqueuedAt;
+
+- (instancetype)initWithDomain:(NSString *)domain
+                       service:(NSString *)service
+                   serviceData:(NSDictionary *)serviceData
+                      entityId:(NSString *)entityId;
+
+/// Whether sending this call twice leaves the entity in the same state as
+/// sending it once (turn_on, set_temperature…). toggle, press, increment,
+/// script runs and relative payloads (brightness_step…) are not, so they are
+/// never coalesced or retried after a send.
+@property (nonatomic, readonly, getter=isIdempotent) BOOL idempotent;
+
+/// domain.service:entity_id[sorted service_data keys] for idempotent targeted
+/// calls, nil otherwise. A newer call with the same key supersedes the queued
+/// one (slider drags); calls setting different parameters are all kept.
+@property (nonatomic, copy, readonly) NSString *coalescingKey;
+
+@end
+
+/// Outbound service calls made while Home Assistant is unreachable.
+/// Persisted per server via HACacheManager so taps survive an app kill, and
+/// replayed in order on the next authenticated connection. Calls older than
+/// a few minutes are dropped at replay — unlocking a door an hour after the
+/// tap is worse than not doing it.
+///
+/// Main thread only.
+@interface HAServiceCallQueue : NSObject
+
++ (instancetype)sharedQueue;
+
+/// Number of calls waiting (for the current server).
+@property (nonatomic, readonly) NSUInteger count;
+
+/// Append a call, replacing any queued call with the same coalescing key.
+- (void)enqueueCall:(HAServiceCall *)call;
+
+/// Remove and return every pending call that's still fresh enough to send,
+/// oldest first.
+- (NSArray<HAServiceCall *> *)dequeueAllCalls;
+
+@end
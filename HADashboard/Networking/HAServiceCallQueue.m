@@ -0,0 +1,194 @@
+#import "HAServiceCallQueue.h"
+#import "HACacheManager.h"
+#import "HALog.h"
+
+static NSString *const kPendingCallsFile = @"pending-service-calls.json";
+static const NSTimeInterval kMaxCallAge = 5 * 60.0;
+static const NSUInteger kMaxQueuedCalls = 100;
+
+@implementation HAServiceCall
+
+- (instancetype)initWithDomain:(NSString *)domain
+                       service:(NSString *)service
+                   serviceData:(NSDictionary *)serviceData
+                      entityId:(NSString *)entityId {
+    return [self initWithDomain:domain service:service serviceData:serviceData
+                       entityId:entityId enqueuedAt:[NSDate date]];
+}
+
+- (instancetype)initWithDomain:(NSString *)domain
+                       service:(NSString *)service
+                   serviceData:(NSDictionary *)serviceData
+                      entityId:(NSString *)entityId
+                    enqueuedAt:(NSDate *)enqueuedAt {
+    self = [super init];
+    if (self) {
+        _domain = [domain copy];
+        _service = [service copy];
+        _serviceData = [serviceData copy] ?: @{};
+        _entityId = [entityId copy];
+        _enqueuedAt = enqueuedAt;
+    }
+    return self;
+}
+
++ (instancetype)callWithDictionary:(NSDictionary *)dict {
+    if (![dict isKindOfClass:[NSDictionary class]]) return nil;
+    NSString *domain = dict[@"domain"];
+    NSString *service = dict[@"service"];
+    if (![domain isKindOfClass:[NSString class]] || ![service isKindOfClass:[NSString class]]) return nil;
+    NSDictionary *data = [dict[@"service_data"] isKindOfClass:[NSDictionary class]] ? dict[@"service_data"] : nil;
+    NSString *entityId = [dict[@"entity_id"] isKindOfClass:[NSString class]] ? dict[@"entity_id"] : nil;
+    NSDate *enqueuedAt = [NSDate dateWithTimeIntervalSince1970:[dict[@"enqueued_at"] doubleValue]];
+    return [[self alloc] initWithDomain:domain service:service serviceData:data
+                               entityId:entityId enqueuedAt:enqueuedAt];
+}
+
+- (NSDictionary *)dictionaryRepresentation {
+    NSMutableDictionary *dict = [NSMutableDictionary dictionary];
+    dict[@"domain"] = self.domain;
+    dict[@"service"] = self.service;
+    dict[@"service_data"] = self.serviceData;
+    if (self.entityId) dict[@"entity_id"] = self.entityId;
+    dict[@"enqueued_at"] = @(self.enqueuedAt.timeIntervalSince1970);
+    return dict;
+}
+
+- (BOOL)isIdempotent {
+    static NSSet<NSString *> *relativeServices;
+    static NSSet<NSString *> *runDomains;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        relativeServices = [NSSet setWithArray:@[
+            @"toggle", @"press", @"trigger", @"increment", @"decrement",
+            @"media_play_pause", @"media_next_track", @"media_previous_track",
+            @"volume_up", @"volume_down",
+        ]];
+        // Every call starts a new run (script.turn_on, script.<name>)
+        runDomains = [NSSet setWithArray:@[@"script"]];
+    });
+    if ([relativeServices containsObject:self.service] || [runDomains containsObject:self.domain]) return NO;
+
+    // Relative payloads (brightness_step, brightness_step_pct) add up
+    for (NSString *key in self.serviceData) {
+        if ([key isKindOfClass:[NSString class]] &&
+            ([key hasSuffix:@"_step"] || [key hasSuffix:@"_step_pct"])) return NO;
+    }
+    return YES;
+}
+
+- (NSString *)coalescingKey {
+    if (!self.entityId || !self.isIdempotent) return nil;
+    // Include the parameters set so only repeats of the same adjustment
+    // collapse: brightness then colour must both reach the light.
+    NSMutableArray<NSString *> *dataKeys = [NSMutableArray arrayWithCapacity:self.serviceData.count];
+    for (id key in self.serviceData) {
+        if ([key isKindOfClass:[NSString class]] && ![key isEqualToString:@"entity_id"]) {
+            [dataKeys addObject:key];
+        }
+    }
+    [dataKeys sortUsingSelector:@selector(compare:)];
+    return [NSString stringWithFormat:@"%@.%@:%@[%@]", self.domain, self.service, self.entityId,
+            [dataKeys componentsJoinedByString:@","]];
+}
+
+@end
+
+#pragma mark -
+
+@interface HAServiceCallQueue ()
+@property (nonatomic, strong) NSMutableArray<HAServiceCall *> *calls;
+@property (nonatomic, copy) NSString *loadedServerURL;
+@end
+
+@implementation HAServiceCallQueue
+
++ (instancetype)sharedQueue {
+    static HAServiceCallQueue *instance = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        instance = [[HAServiceCallQueue alloc] init];
+    });
+    return instance;
+}
+
+/// Pending calls for the current server, loaded from disk on first use and
+/// whenever the cache manager switches servers.
+- (NSMutableArray<HAServiceCall *> *)currentCalls {
+    NSString *serverURL = [HACacheManager sharedManager].serverURL;
+    if (self.calls && (serverURL == self.loadedServerURL || [serverURL isEqualToString:self.loadedServerURL])) {
+        return self.calls;
+    }
+
+    self.loadedServerURL = serverURL;
+    self.calls = [NSMutableArray array];
+    NSArray *json = serverURL ? [[HACacheManager sharedManager] readJSONFromFile:kPendingCallsFile] : nil;
+    if ([json isKindOfClass:[NSArray class]]) {
+        for (NSDictionary *dict in json) {
+            HAServiceCall *call = [HAServiceCall callWithDictionary:dict];
+            if (call) [self.calls addObject:call];
+        }
+        if (self.calls.count > 0) {
+            HALogI(@"conn", @"Loaded %lu queued service calls", (unsigned long)self.calls.count);
+        }
+    }
+    return self.calls;
+}
+
+- (NSUInteger)count {
+    return [self currentCalls].count;
+}
+
+- (void)enqueueCall:(HAServiceCall *)call {
+    if (!call) return;
+    NSMutableArray<HAServiceCall *> *calls = [self currentCalls];
+
+    // Superseded calls are removed rather than updated in place so the newest
+    // call keeps its position relative to other services on the same entity
+    // (turn_on, turn_off, turn_on must end up on).
+    NSString *key = call.coalescingKey;
+    if (key) {
+        NSIndexSet *superseded = [calls indexesOfObjectsPassingTest:^BOOL(HAServiceCall *queued, NSUInteger idx, BOOL *stop) {
+            return [queued.coalescingKey isEqualToString:key];
+        }];
+        [calls removeObjectsAtIndexes:superseded];
+    }
+
+    [calls addObject:call];
+    if (calls.count > kMaxQueuedCalls) {
+        [calls removeObjectsInRange:NSMakeRange(0, calls.count - kMaxQueuedCalls)];
+    }
+    HALogD(@"conn", @"Queued %@.%@ for %@ (%lu pending)", call.domain, call.service,
+           call.entityId ?: @"-", (unsigned long)calls.count);
+    [self persist];
+}
+
+- (NSArray<HAServiceCall *> *)dequeueAllCalls {
+    NSMutableArray<HAServiceCall *> *calls = [self currentCalls];
+    if (calls.count == 0) return @[];
+
+    NSMutableArray<HAServiceCall *> *fresh = [NSMutableArray arrayWithCapacity:calls.count];
+    for (HAServiceCall *call in calls) {
+        if (-[call.enqueuedAt timeIntervalSinceNow] <= kMaxCallAge) {
+            [fresh addObject:call];
+        } else {
+            HALogW(@"conn", @"Dropping stale queued %@.%@ for %@", call.domain, call.service, call.entityId ?: @"-");
+        }
+    }
+    [calls removeAllObjects];
+    [self persist];
+    return fresh;
+}
+
+- (void)persist {
+    if (!self.loadedServerURL) return;
+    // Always go through the serial write queue (even when empty) so an older
+    // async write can't land after a synchronous delete and resurrect calls.
+    NSMutableArray *json = [NSMutableArray arrayWithCapacity:self.calls.count];
+    for (HAServiceCall *call in self.calls) {
+        [json addObject:[call dictionaryRepresentation]];
+    }
+    [[HACacheManager sharedManager] writeJSON:json toFile:kPendingCallsFile completion:nil];
+}
+
+@end
@@ -0,0 +1,89 @@
+#import <Foundation/Foundation.h>
+
+/// Aggregation period of recorder long-term statistics.
+typedef NS_ENUM(NSInteger, HAStatisticsPeriod) {
+    HAStatisticsPeriodFiveMinute = 0, // Short-term statistics (kept ~10 days)
+    HAStatisticsPeriodHour,
+    HAStatisticsPeriodDay,
+    HAStatisticsPeriodWeek,
+    HAStatisticsPeriodMonth,
+};
+
+/// Statistic types, as named by recorder/statistics_during_period. Also the
+/// value keys of a statistics row.
+extern NSString *const HAStatisticTypeMean;
+extern NSString *const HAStatisticTypeMin;
+extern NSString *const HAStatisticTypeMax;
+extern NSString *const HAStatisticTypeSum;
+extern NSString *const HAStatisticTypeState;
+extern NSString *const HAStatisticTypeChange;
+
+/// Pre-aggregated recorder statistics over the WebSocket
+/// (recorder/statistics_during_period). A month of hourly means is a few
+/// hundred rows instead of every raw state change.
+///
+/// Rows are cached per statistic, period and type set, in memory and on disk
+/// (Library/Caches). Buckets that have closed never change, so a repeat
+/// request only fetches from the last cached bucket on, and not at all while
+/// the cached tail is fresh.
+@interface HAStatisticsManager : NSObject
+
++ (instancetype)sharedManager;
+
+/// Statistics rows per statistic id, oldest first:
+/// @{@"start": NSNumber, @"end": NSNumber (epoch), @"mean": NSNumber, ...}
+/// with one value key per requested type the recorder has. Ids without
+/// long-term statistics (no state_class) are missing from the result.
+/// types nil requests all of them. Completion runs on main. While offline
+/// the cached rows are returned; error is set only if there are none.
+- (void)fetchStatisticsForIds:(NSArray<NSString *> *)statisticIds
+                    startDate:(NSDate *)startDate
+                      endDate:(NSDate *)endDate
+                       period:(HAStatisticsPeriod)period
+                        types:(NSArray<NSString *> *)types
+                   completion:(void (^)(NSDictionary<NSString *, NSArray<NSDictionary *> *> *statistics,
+                                        NSError *error))completion;
+
+/// Drop the memory and disk caches.
+- (void)clearCache;
+
+/// Drop the memory cache only (memory warnings); disk copies stay.
+- (void)clearMemoryCache;
+
+#pragma mark - Parsing
+
+/// "5minute", "hour", "day", "week" or "month"; anything else is fallback.
++ (HAStatisticsPeriod)periodFromString:(NSString *)string defaultPeriod:(HAStatisticsPeriod)fallback;
++ (NSString *)stringFromPeriod:(HAStatisticsPeriod)period;
+
+/// Finest period that covers duration in at most maxBuckets rows.
++ (HAStatisticsPeriod)periodForDuration:(NSTimeInterval)duration maxBuckets:(NSUInteger)maxBuckets;
+
+/// Normalize one statistic's rows from a statistics_during_period result.
+/// start/end arrive as epoch milliseconds (HA 2022.12+) or ISO 8601 strings
+/// and become epoch seconds; rows without a start are dropped.
++ (NSArray<NSDictionary *> *)rowsFromResultRows:(id)rows;
+
+/// Graph points @{@"value", @"timestamp"} (bucket start), taking from each
+/// row the first of types it has. nil types means mean, then state, then sum.
++ (NSArray<NSDictionary *> *)pointsFromRows:(NSArray<NSDictionary *> *)rows
+                                      types:(NSArray<NSString *> *)types;
+
+/// Combine rows into one value: mean of means, min of mins, max of maxes,
+/// total change, or the last state / sum. nil if no row has the type.
++ (NSNumber *)aggregateValueOfType:(NSString *)type rows:(NSArray<NSDictionary *> *)rows;
+
+/// Bucket raw history points into rows (mean/min/max/state/change). Used in
+/// demo mode, where there is no recorder. Months are 30 days.
++ (NSArray<NSDictionary *> *)rowsFromPoints:(NSArray<NSDictionary *> *)points
+                                     period:(HAStatisticsPeriod)period;
+
+/// Date range of a statistic card "period" config: calendar (day, week,
+/// month, year with offset), fixed_period (start, end) or rolling_window
+/// (duration, offset). nil or unknown config means the current day.
++ (void)getStartDate:(NSDate **)startDate
+             endDate:(NSDate **)endDate
+     forPeriodConfig:(NSDictionary *)config
+                 now:(NSDate *)now;
+
+@end
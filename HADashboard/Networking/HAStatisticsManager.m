@@ -0,0 +1,547 @@
+#import "HAStatisticsManager.h"
+#import "HAAuthManager.h"
+#import "HACacheManager.h"
+#import "HAConnectionManager.h"
+#import "HADateUtils.h"
+#import "HADemoDataProvider.h"
+#import "HALog.h"
+
+NSString *const HAStatisticTypeMean   = @"mean";
+NSString *const HAStatisticTypeMin    = @"min";
+NSString *const HAStatisticTypeMax    = @"max";
+NSString *const HAStatisticTypeSum    = @"sum";
+NSString *const HAStatisticTypeState  = @"state";
+NSString *const HAStatisticTypeChange = @"change";
+
+static const NSTimeInterval kStatisticsTimeout = 30.0;
+
+static NSTimeInterval HAStatisticsPeriodLength(HAStatisticsPeriod period) {
+    switch (period) {
+        case HAStatisticsPeriodFiveMinute: return 300.0;
+        case HAStatisticsPeriodHour:       return 3600.0;
+        case HAStatisticsPeriodDay:        return 86400.0;
+        case HAStatisticsPeriodWeek:       return 7 * 86400.0;
+        case HAStatisticsPeriodMonth:      return 30 * 86400.0;
+    }
+    return 3600.0;
+}
+
+/// A cached tail younger than this is served without asking the server.
+/// Short-term statistics compile every 5 minutes, long-term ones hourly.
+static NSTimeInterval HAStatisticsFreshness(HAStatisticsPeriod period) {
+    return period == HAStatisticsPeriodFiveMinute ? 60.0 : 300.0;
+}
+
+/// Row start/end: epoch milliseconds (HA 2022.12+) or an ISO 8601 string.
+static BOOL HAStatisticsTime(id value, NSTimeInterval *outTime) {
+    if ([value isKindOfClass:[NSNumber class]]) {
+        *outTime = [value doubleValue] / 1000.0;
+        return YES;
+    }
+    if ([value isKindOfClass:[NSString class]]) {
+        return [HADateUtils getTimeInterval:outTime fromISO8601String:value];
+    }
+    return NO;
+}
+
+static double HAStatisticsNumber(id value) {
+    return [value isKindOfClass:[NSNumber class]] || [value isKindOfClass:[NSString class]] ? [value doubleValue] : 0;
+}
+
+/// HA duration dictionary: {days, hours, minutes, seconds}, each optional.
+static NSTimeInterval HAStatisticsDuration(id duration) {
+    if (![duration isKindOfClass:[NSDictionary class]]) return 0;
+    NSDictionary *d = duration;
+    return HAStatisticsNumber(d[@"days"]) * 86400.0 + HAStatisticsNumber(d[@"hours"]) * 3600.0 +
+           HAStatisticsNumber(d[@"minutes"]) * 60.0 + HAStatisticsNumber(d[@"seconds"]);
+}
+
+@interface HAStatisticsManager ()
+/// cache key -> @{@"rows": NSArray, @"from": NSNumber, @"fetchedAt": NSNumber}.
+/// Rows are complete from "from" up to "fetchedAt".
+@property (nonatomic, strong) NSCache *series;
+/// request key -> blocks waiting on the same in-flight command
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSMutableArray *> *inFlight;
+@property (nonatomic, strong) dispatch_queue_t diskQueue;
+/// Server the memory cache belongs to (disk caches are already per server)
+@property (nonatomic, copy) NSString *serverURL;
+@end
+
+@implementation HAStatisticsManager
+
++ (instancetype)sharedManager {
+    static HAStatisticsManager *instance = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        instance = [[HAStatisticsManager alloc] init];
+    });
+    return instance;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _series = [[NSCache alloc] init];
+        _series.countLimit = 50;
+        _series.totalCostLimit = 2 * 1024 * 1024; // 2MB limit
+        _inFlight = [NSMutableDictionary dictionary];
+        _diskQueue = dispatch_queue_create("com.hadashboard.statistics.disk", DISPATCH_QUEUE_SERIAL);
+    }
+    return self;
+}
+
++ (NSArray<NSString *> *)allTypes {
+    return @[HAStatisticTypeChange, HAStatisticTypeMax, HAStatisticTypeMean,
+             HAStatisticTypeMin, HAStatisticTypeState, HAStatisticTypeSum];
+}
+
+#pragma mark - Public API
+
+- (void)fetchStatisticsForIds:(NSArray<NSString *> *)statisticIds
+                    startDate:(NSDate *)startDate
+                      endDate:(NSDate *)endDate
+                       period:(HAStatisticsPeriod)period
+                        types:(NSArray<NSString *> *)types
+                   completion:(void (^)(NSDictionary<NSString *, NSArray<NSDictionary *> *> *, NSError *))completion {
+    if (!completion) return;
+    if (statisticIds.count == 0 || !startDate || !endDate) {
+        dispatch_async(dispatch_get_main_queue(), ^{ completion(@{}, nil); });
+        return;
+    }
+    NSArray<NSString *> *sortedIds = [[NSSet setWithArray:statisticIds].allObjects sortedArrayUsingSelector:@selector(compare:)];
+    NSArray<NSString *> *sortedTypes = [[NSSet setWithArray:types ?: [HAStatisticsManager allTypes]].allObjects
+                                        sortedArrayUsingSelector:@selector(compare:)];
+    NSTimeInterval start = [startDate timeIntervalSince1970];
+    NSTimeInterval end = [endDate timeIntervalSince1970];
+    [self checkServer];
+    NSString *serverURL = self.serverURL;
+
+    // Demo mode has no recorder: bucket the generated history instead
+    if ([[HAAuthManager sharedManager] isDemoMode]) {
+        NSInteger hours = MAX(1, (NSInteger)ceil((end - start) / 3600.0));
+        NSMutableDictionary *result = [NSMutableDictionary dictionary];
+        for (NSString *statisticId in sortedIds) {
+            NSArray *points = [[HADemoDataProvider sharedProvider] historyPointsForEntityId:statisticId hoursBack:hours];
+            NSArray *rows = [HAStatisticsManager rowsFromPoints:points period:period];
+            if (rows.count > 0) result[statisticId] = rows;
+        }
+        dispatch_async(dispatch_get_main_queue(), ^{ completion(result, nil); });
+        return;
+    }
+
+    // Fetch once, from the earliest point any of the ids is missing
+    NSTimeInterval now = [[NSDate date] timeIntervalSince1970];
+    NSTimeInterval fetchStart = end;
+    BOOL needsFetch = NO;
+    for (NSString *statisticId in sortedIds) {
+        NSDictionary *series = [self seriesForKey:[self cacheKeyForId:statisticId period:period types:sortedTypes]];
+        NSTimeInterval needed = [self fetchStartForSeries:series start:start end:end now:now period:period];
+        if (needed < 0) continue;
+        needsFetch = YES;
+        fetchStart = MIN(fetchStart, needed);
+    }
+
+    void (^finish)(NSError *) = ^(NSError *error) {
+        NSDictionary *result = [self cachedResultForIds:sortedIds period:period types:sortedTypes start:start end:end];
+        completion(result, result.count == 0 ? error : nil);
+    };
+
+    if (!needsFetch) {
+        dispatch_async(dispatch_get_main_queue(), ^{ finish(nil); });
+        return;
+    }
+
+    HAConnectionManager *conn = [HAConnectionManager sharedManager];
+    if (!conn.isConnected) {
+        NSError *error = [self errorWithCode:-1 message:@"Not connected"];
+        dispatch_async(dispatch_get_main_queue(), ^{ finish(error); });
+        return;
+    }
+
+    // Cards showing the same statistics share one request
+    NSString *periodString = [HAStatisticsManager stringFromPeriod:period];
+    NSString *requestKey = [NSString stringWithFormat:@"%@|%@|%@|%@|%.0f", serverURL ?: @"",
+                            [sortedIds componentsJoinedByString:@","], periodString,
+                            [sortedTypes componentsJoinedByString:@","], fetchStart];
+    NSMutableArray *waiting = self.inFlight[requestKey];
+    if (waiting) {
+        [waiting addObject:[finish copy]];
+        return;
+    }
+    self.inFlight[requestKey] = [NSMutableArray arrayWithObject:[finish copy]];
+
+    NSDictionary *command = @{
+        @"type": @"recorder/statistics_during_period",
+        @"start_time": [HAStatisticsManager isoStringForTime:fetchStart],
+        @"end_time": [HAStatisticsManager isoStringForTime:end],
+        @"statistic_ids": sortedIds,
+        @"period": periodString,
+        @"types": sortedTypes,
+    };
+    HALogD(@"stats", @"Fetching %@ statistics for %lu id(s) from %.0f s ago",
+           periodString, (unsigned long)sortedIds.count, now - fetchStart);
+
+    [conn sendCommand:command priority:HACommandPriorityBulk timeout:kStatisticsTimeout completion:^(id result, NSError *error) {
+        // Rows from a server we have since switched away from are not merged
+        [self checkServer];
+        BOOL sameServer = (serverURL == self.serverURL) || [serverURL isEqualToString:self.serverURL];
+        if (!sameServer) {
+            HALogD(@"stats", @"Discarding statistics fetched from the previous server");
+            error = [self errorWithCode:-3 message:@"Server changed"];
+        } else if (!error && [result isKindOfClass:[NSDictionary class]]) {
+            NSTimeInterval fetchedAt = [[NSDate date] timeIntervalSince1970];
+            for (NSString *statisticId in sortedIds) {
+                NSArray *rows = [HAStatisticsManager rowsFromResultRows:result[statisticId]];
+                [self mergeRows:rows
+                 intoSeriesForKey:[self cacheKeyForId:statisticId period:period types:sortedTypes]
+                        fromTime:fetchStart
+                       fetchedAt:fetchedAt];
+            }
+        } else {
+            if (!error) error = [self errorWithCode:-2 message:@"Unexpected statistics response"];
+            HALogW(@"stats", @"statistics_during_period failed: %@", error.localizedDescription);
+        }
+
+        NSArray *blocks = self.inFlight[requestKey];
+        [self.inFlight removeObjectForKey:requestKey];
+        for (void (^block)(NSError *) in blocks) {
+            block(error);
+        }
+    }];
+}
+
+- (void)clearMemoryCache {
+    [self.series removeAllObjects];
+}
+
+- (void)clearCache {
+    [self clearMemoryCache];
+    NSString *dir = [self diskDirectory];
+    if (!dir) return;
+    dispatch_async(self.diskQueue, ^{
+        [[NSFileManager defaultManager] removeItemAtPath:dir error:nil];
+    });
+}
+
+#pragma mark - Cache
+
+/// Cache keys carry no server, so a server switch drops the memory cache.
+- (void)checkServer {
+    NSString *serverURL = [HACacheManager sharedManager].serverURL;
+    if (!serverURL || [serverURL isEqualToString:self.serverURL]) return;
+    if (self.serverURL) [self clearMemoryCache];
+    self.serverURL = serverURL;
+}
+
+- (NSString *)cacheKeyForId:(NSString *)statisticId period:(HAStatisticsPeriod)period types:(NSArray<NSString *> *)types {
+    return [NSString stringWithFormat:@"%@_%@_%@", statisticId,
+            [HAStatisticsManager stringFromPeriod:period], [types componentsJoinedByString:@"-"]];
+}
+
+/// Where a fetch for [start, end] has to begin given what is cached for one
+/// statistic, or -1 if the cache already answers it.
+- (NSTimeInterval)fetchStartForSeries:(NSDictionary *)series
+                                start:(NSTimeInterval)start
+                                  end:(NSTimeInterval)end
+                                  now:(NSTimeInterval)now
+                               period:(HAStatisticsPeriod)period {
+    if (!series || [series[@"from"] doubleValue] > start) return start;
+
+    NSTimeInterval fetchedAt = [series[@"fetchedAt"] doubleValue];
+    if (end <= fetchedAt || now - fetchedAt < HAStatisticsFreshness(period)) return -1;
+
+    // Closed buckets never change: refetch from the last one, which may
+    // still have been open when it was fetched
+    NSArray<NSDictionary *> *rows = series[@"rows"];
+    NSTimeInterval tail = rows.count > 0 ? [rows.lastObject[@"start"] doubleValue]
+                                         : fetchedAt - HAStatisticsPeriodLength(period);
+    return MAX(tail, start);
+}
+
+- (void)mergeRows:(NSArray<NSDictionary *> *)rows
+ intoSeriesForKey:(NSString *)key
+         fromTime:(NSTimeInterval)fetchStart
+        fetchedAt:(NSTimeInterval)fetchedAt {
+    NSDictionary *old = [self seriesForKey:key];
+    NSMutableArray<NSDictionary *> *merged = [NSMutableArray array];
+    NSTimeInterval from = fetchStart;
+    if (old && [old[@"from"] doubleValue] <= fetchStart) {
+        from = [old[@"from"] doubleValue];
+        for (NSDictionary *row in old[@"rows"]) {
+            if ([row[@"start"] doubleValue] >= fetchStart) break;
+            [merged addObject:row];
+        }
+    }
+    for (NSDictionary *row in rows) {
+        // A bucket straddling fetchStart comes back partial; keep the full one
+        if (merged.count > 0 && [row[@"start"] doubleValue] <= [merged.lastObject[@"start"] doubleValue]) continue;
+        [merged addObject:row];
+    }
+
+    NSDictionary *series = @{@"rows": [merged copy], @"from": @(from), @"fetchedAt": @(fetchedAt)};
+    [self.series setObject:series forKey:key cost:merged.count * 128];
+
+    NSString *path = [self diskPathForKey:key];
+    if (!path) return;
+    dispatch_async(self.diskQueue, ^{
+        NSData *data = [NSJSONSerialization dataWithJSONObject:series options:0 error:nil];
+        if (![data writeToFile:path atomically:YES]) {
+            HALogW(@"stats", @"Failed to write %@", path.lastPathComponent);
+        }
+    });
+}
+
+- (NSDictionary *)seriesForKey:(NSString *)key {
+    NSDictionary *series = [self.series objectForKey:key];
+    if (series) return series;
+
+    NSString *path = [self diskPathForKey:key];
+    NSData *data = path ? [NSData dataWithContentsOfFile:path] : nil;
+    if (!data) return nil;
+    series = [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
+    if (![series isKindOfClass:[NSDictionary class]] || ![series[@"rows"] isKindOfClass:[NSArray class]]) {
+        [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+        return nil;
+    }
+    [self.series setObject:series forKey:key cost:[series[@"rows"] count] * 128];
+    return series;
+}
+
+- (NSDictionary *)cachedResultForIds:(NSArray<NSString *> *)statisticIds
+                              period:(HAStatisticsPeriod)period
+                               types:(NSArray<NSString *> *)types
+                               start:(NSTimeInterval)start
+                                 end:(NSTimeInterval)end {
+    NSMutableDictionary *result = [NSMutableDictionary dictionary];
+    for (NSString *statisticId in statisticIds) {
+        NSDictionary *series = [self seriesForKey:[self cacheKeyForId:statisticId period:period types:types]];
+        NSMutableArray *rows = [NSMutableArray array];
+        for (NSDictionary *row in series[@"rows"]) {
+            if ([row[@"start"] doubleValue] >= end) break;
+            if ([row[@"end"] doubleValue] <= start) continue;
+            [rows addObject:row];
+        }
+        if (rows.count > 0) result[statisticId] = [rows copy];
+    }
+    return result;
+}
+
+- (NSString *)diskDirectory {
+    NSString *caches = [[HACacheManager sharedManager] expendableCacheDirectory];
+    return [caches stringByAppendingPathComponent:@"statistics"];
+}
+
+- (NSString *)diskPathForKey:(NSString *)key {
+    NSString *dir = [self diskDirectory];
+    if (!dir) return nil;
+    [[NSFileManager defaultManager] createDirectoryAtPath:dir withIntermediateDirectories:YES attributes:nil error:nil];
+    // Statistic ids can be external ("sensor:energy"); keep the name portable
+    NSCharacterSet *unsafe = [[NSCharacterSet characterSetWithCharactersInString:
+                               @"abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789._-"] invertedSet];
+    NSString *filename = [[key componentsSeparatedByCharactersInSet:unsafe] componentsJoinedByString:@"_"];
+    return [dir stringByAppendingPathComponent:[filename stringByAppendingPathExtension:@"json"]];
+}
+
+- (NSError *)errorWithCode:(NSInteger)code message:(NSString *)message {
+    return [NSError errorWithDomain:@"HAStatisticsManager" code:code
+                           userInfo:@{NSLocalizedDescriptionKey: message}];
+}
+
++ (NSString *)isoStringForTime:(NSTimeInterval)time {
+    static NSDateFormatter *fmt;
+    static dispatch_once_t fmtOnce;
+    dispatch_once(&fmtOnce, ^{
+        fmt = [[NSDateFormatter alloc] init];
+        fmt.dateFormat = @"yyyy-MM-dd'T'HH:mm:ss.SSS'Z'";
+        fmt.timeZone = [NSTimeZone timeZoneWithAbbreviation:@"UTC"];
+        fmt.locale = [[NSLocale alloc] initWithLocaleIdentifier:@"en_US_POSIX"];
+    });
+    return [fmt stringFromDate:[NSDate dateWithTimeIntervalSince1970:time]];
+}
+
+#pragma mark - Parsing
+
++ (HAStatisticsPeriod)periodFromString:(NSString *)string defaultPeriod:(HAStatisticsPeriod)fallback {
+    if (![string isKindOfClass:[NSString class]]) return fallback;
+    if ([string isEqualToString:@"5minute"]) return HAStatisticsPeriodFiveMinute;
+    if ([string isEqualToString:@"hour"])    return HAStatisticsPeriodHour;
+    if ([string isEqualToString:@"day"])     return HAStatisticsPeriodDay;
+    if ([string isEqualToString:@"week"])    return HAStatisticsPeriodWeek;
+    if ([string isEqualToString:@"month"])   return HAStatisticsPeriodMonth;
+    return fallback;
+}
+
++ (NSString *)stringFromPeriod:(HAStatisticsPeriod)period {
+    switch (period) {
+        case HAStatisticsPeriodFiveMinute: return @"5minute";
+        case HAStatisticsPeriodHour:       return @"hour";
+        case HAStatisticsPeriodDay:        return @"day";
+        case HAStatisticsPeriodWeek:       return @"week";
+        case HAStatisticsPeriodMonth:      return @"month";
+    }
+    return @"hour";
+}
+
++ (HAStatisticsPeriod)periodForDuration:(NSTimeInterval)duration maxBuckets:(NSUInteger)maxBuckets {
+    for (HAStatisticsPeriod period = HAStatisticsPeriodFiveMinute; period < HAStatisticsPeriodMonth; period++) {
+        if (duration / HAStatisticsPeriodLength(period) <= maxBuckets) return period;
+    }
+    return HAStatisticsPeriodMonth;
+}
+
++ (NSArray<NSDictionary *> *)rowsFromResultRows:(id)rows {
+    if (![rows isKindOfClass:[NSArray class]]) return @[];
+    NSArray<NSString *> *types = [self allTypes];
+    NSMutableArray *normalized = [NSMutableArray arrayWithCapacity:[rows count]];
+    for (NSDictionary *row in (NSArray *)rows) {
+        if (![row isKindOfClass:[NSDictionary class]]) continue;
+        NSTimeInterval start = 0;
+        if (!HAStatisticsTime(row[@"start"], &start)) continue;
+        NSTimeInterval end = start;
+        HAStatisticsTime(row[@"end"], &end);
+
+        NSMutableDictionary *entry = [NSMutableDictionary dictionaryWithCapacity:types.count + 2];
+        entry[@"start"] = @(start);
+        entry[@"end"] = @(end);
+        for (NSString *type in types) {
+            id value = row[type];
+            if ([value isKindOfClass:[NSNumber class]]) entry[type] = value;
+        }
+        [normalized addObject:entry];
+    }
+    return normalized;
+}
+
++ (NSArray<NSDictionary *> *)pointsFromRows:(NSArray<NSDictionary *> *)rows types:(NSArray<NSString *> *)types {
+    NSArray<NSString *> *preferred = types.count > 0 ? types
+        : @[HAStatisticTypeMean, HAStatisticTypeState, HAStatisticTypeSum];
+    NSMutableArray *points = [NSMutableArray arrayWithCapacity:rows.count];
+    for (NSDictionary *row in rows) {
+        for (NSString *type in preferred) {
+            NSNumber *value = row[type];
+            if (!value) continue;
+            [points addObject:@{@"value": value, @"timestamp": row[@"start"]}];
+            break;
+        }
+    }
+    return points;
+}
+
++ (NSNumber *)aggregateValueOfType:(NSString *)type rows:(NSArray<NSDictionary *> *)rows {
+    BOOL isMin = [type isEqualToString:HAStatisticTypeMin];
+    BOOL isMax = [type isEqualToString:HAStatisticTypeMax];
+    BOOL isTotal = [type isEqualToString:HAStatisticTypeMean] || [type isEqualToString:HAStatisticTypeChange];
+    double accumulated = 0;
+    NSUInteger count = 0;
+    NSNumber *last = nil;
+    for (NSDictionary *row in rows) {
+        NSNumber *value = row[type];
+        if (![value isKindOfClass:[NSNumber class]]) continue;
+        double v = value.doubleValue;
+        if (isTotal) {
+            accumulated += v;
+        } else if (isMin) {
+            accumulated = count == 0 ? v : MIN(accumulated, v);
+        } else if (isMax) {
+            accumulated = count == 0 ? v : MAX(accumulated, v);
+        }
+        last = value;
+        count++;
+    }
+    if (count == 0) return nil;
+    if ([type isEqualToString:HAStatisticTypeMean]) return @(accumulated / count);
+    if (isTotal || isMin || isMax) return @(accumulated);
+    return last;
+}
+
++ (NSArray<NSDictionary *> *)rowsFromPoints:(NSArray<NSDictionary *> *)points period:(HAStatisticsPeriod)period {
+    NSTimeInterval length = HAStatisticsPeriodLength(period);
+    NSMutableArray *rows = [NSMutableArray array];
+    __block NSTimeInterval bucketStart = -1;
+    __block double minValue = 0, maxValue = 0, sum = 0, first = 0, last = 0, previousLast = 0;
+    __block NSUInteger count = 0;
+    __block BOOL hasPrevious = NO;
+
+    void (^flush)(void) = ^{
+        if (count == 0) return;
+        // Change runs from the previous bucket's last value, as the recorder's does
+        double base = hasPrevious ? previousLast : first;
+        [rows addObject:@{
+            @"start": @(bucketStart), @"end": @(bucketStart + length),
+            HAStatisticTypeMean: @(sum / count), HAStatisticTypeMin: @(minValue), HAStatisticTypeMax: @(maxValue),
+            HAStatisticTypeState: @(last), HAStatisticTypeChange: @(last - base),
+        }];
+    };
+    for (NSDictionary *point in points) {
+        double t = [point[@"timestamp"] doubleValue];
+        double v = [point[@"value"] doubleValue];
+        NSTimeInterval bucket = floor(t / length) * length;
+        if (bucket != bucketStart) {
+            flush();
+            if (count > 0) {
+                previousLast = last;
+                hasPrevious = YES;
+            }
+            bucketStart = bucket;
+            minValue = maxValue = first = v;
+            sum = 0;
+            count = 0;
+        }
+        minValue = MIN(minValue, v);
+        maxValue = MAX(maxValue, v);
+        sum += v;
+        last = v;
+        count++;
+    }
+    flush();
+    return rows;
+}
+
++ (void)getStartDate:(NSDate **)startDate
+             endDate:(NSDate **)endDate
+     forPeriodConfig:(NSDictionary *)config
+                 now:(NSDate *)now {
+    if (![config isKindOfClass:[NSDictionary class]]) config = nil;
+    NSDate *start = nil;
+    NSDate *end = nil;
+    NSDictionary *fixed = config[@"fixed_period"];
+    NSDictionary *rolling = config[@"rolling_window"];
+    NSDictionary *calendarConfig = config[@"calendar"];
+
+    if ([fixed isKindOfClass:[NSDictionary class]]) {
+        if ([fixed[@"start"] isKindOfClass:[NSString class]]) start = [HADateUtils dateFromISO8601String:fixed[@"start"]];
+        if ([fixed[@"end"] isKindOfClass:[NSString class]]) end = [HADateUtils dateFromISO8601String:fixed[@"end"]];
+        if (!end) end = now;
+        if (!start) start = [end dateByAddingTimeInterval:-365 * 86400.0];
+    } else if ([rolling isKindOfClass:[NSDictionary class]]) {
+        NSTimeInterval duration = HAStatisticsDuration(rolling[@"duration"]);
+        if (duration <= 0) duration = 86400.0;
+        end = [now dateByAddingTimeInterval:HAStatisticsDuration(rolling[@"offset"])];
+        start = [end dateByAddingTimeInterval:-duration];
+    } else {
+        if (![calendarConfig isKindOfClass:[NSDictionary class]]) calendarConfig = nil;
+        NSString *unitName = calendarConfig[@"period"];
+        NSCalendarUnit unit = NSCalendarUnitDay;
+        if ([unitName isKindOfClass:[NSString class]]) {
+            if ([unitName isEqualToString:@"week"])       unit = NSCalendarUnitWeekOfYear;
+            else if ([unitName isEqualToString:@"month"]) unit = NSCalendarUnitMonth;
+            else if ([unitName isEqualToString:@"year"])  unit = NSCalendarUnitYear;
+        }
+        NSCalendar *calendar = [NSCalendar currentCalendar];
+        NSDate *anchor = now;
+        NSInteger offset = (NSInteger)HAStatisticsNumber(calendarConfig[@"offset"]);
+        if (offset != 0) {
+            NSDateComponents *delta = [[NSDateComponents alloc] init];
+            [delta setValue:offset forComponent:unit];
+            anchor = [calendar dateByAddingComponents:delta toDate:now options:0];
+        }
+        NSTimeInterval length = 0;
+        [calendar rangeOfUnit:unit startDate:&start interval:&length forDate:anchor];
+        end = [start dateByAddingTimeInterval:length];
+    }
+
+    if (startDate) *startDate = start;
+    if (endDate) *endDate = end;
+}
+
+@end
@@ -0,0 +1,39 @@
+#import <Foundation/Foundation.h>
+
+@class HAEntity;
+
+/// Posted on main when a forecast arrives.
+/// userInfo: @{@"entity_id": NSString, @"forecast_type": NSString}
+extern NSString *const HAWeatherForecastStoreDidUpdateNotification;
+
+/// Forecast types of weather/subscribe_forecast.
+extern NSString *const HAWeatherForecastTypeDaily;
+extern NSString *const HAWeatherForecastTypeHourly;
+extern NSString *const HAWeatherForecastTypeTwiceDaily;
+
+/// Weather forecasts shared by every weather cell, keyed by entity and
+/// forecast type. Each pair gets one weather/subscribe_forecast subscription
+/// (HA 2023.9+), renewed on reconnect; the server pushes a new forecast when
+/// the integration refreshes, so cells never poll. The last forecast of each
+/// pair is persisted, so a cold start renders before the socket is up.
+/// Main thread only.
+@interface HAWeatherForecastStore : NSObject
+
++ (instancetype)sharedStore;
+
+/// The last known forecast, or nil if none has arrived yet. Never blocks:
+/// the first lookup of a pair starts its subscription, and
+/// HAWeatherForecastStoreDidUpdateNotification follows once data arrives.
+/// Entities that still carry a forecast attribute (pre-2023.9) return it
+/// directly and are not subscribed.
+- (NSArray *)forecastForEntity:(HAEntity *)entity type:(NSString *)forecastType;
+
+/// Drop all subscriptions and forecasts, in memory and on disk.
+- (void)reset;
+
+#pragma mark - Parsing
+
+/// Forecast entries of a subscribe_forecast event, or nil if it has none.
++ (NSArray *)forecastFromEventData:(NSDictionary *)eventData;
+
+@end
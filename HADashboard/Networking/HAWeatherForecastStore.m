@@ -0,0 +1,192 @@
+#import "HAWeatherForecastStore.h"
+#import "HACacheManager.h"
+#import "HAConnectionManager.h"
+#import "HAEntity.h"
+#import "HALog.h"
+
+NSString *const HAWeatherForecastStoreDidUpdateNotification = @"HAWeatherForecastStoreDidUpdate";
+
+NSString *const HAWeatherForecastTypeDaily      = @"daily";
+NSString *const HAWeatherForecastTypeHourly     = @"hourly";
+NSString *const HAWeatherForecastTypeTwiceDaily = @"twice_daily";
+
+static NSString *const kForecastCacheFile = @"weather_forecasts.json";
+
+/// Disk writes are coalesced: weather integrations refresh all their
+/// entities at once.
+static const NSTimeInterval kPersistDelay = 5.0;
+
+@interface HAWeatherForecastStore ()
+/// "entity_id|forecast_type" -> forecast entries
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSArray *> *forecasts;
+/// Pairs looked up so far: key -> @{@"entity_id", @"forecast_type"}.
+/// Each is (re)subscribed whenever the connection comes up.
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSDictionary *> *pairs;
+/// key -> live subscription id
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSNumber *> *subscriptionIds;
+/// Server whose forecasts are loaded; nil until the disk cache is read
+@property (nonatomic, copy) NSString *loadedServerURL;
+@property (nonatomic, assign) BOOL persistScheduled;
+@end
+
+@implementation HAWeatherForecastStore
+
++ (instancetype)sharedStore {
+    static HAWeatherForecastStore *instance = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        instance = [[HAWeatherForecastStore alloc] init];
+    });
+    return instance;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _forecasts = [NSMutableDictionary dictionary];
+        _pairs = [NSMutableDictionary dictionary];
+        _subscriptionIds = [NSMutableDictionary dictionary];
+
+        NSNotificationCenter *nc = [NSNotificationCenter defaultCenter];
+        [nc addObserver:self selector:@selector(connectionDidConnect:)
+                   name:HAConnectionManagerDidConnectNotification object:nil];
+        [nc addObserver:self selector:@selector(connectionDidDisconnect:)
+                   name:HAConnectionManagerDidDisconnectNotification object:nil];
+    }
+    return self;
+}
+
+#pragma mark - Public API
+
+- (NSArray *)forecastForEntity:(HAEntity *)entity type:(NSString *)forecastType {
+    if (entity.entityId.length == 0) return nil;
+
+    NSArray *legacyForecast = [entity weatherForecast];
+    if (legacyForecast.count > 0) return legacyForecast;
+
+    [self loadIfNeeded];
+    NSString *type = forecastType ?: HAWeatherForecastTypeDaily;
+    NSString *key = [NSString stringWithFormat:@"%@|%@", entity.entityId, type];
+    if (!self.pairs[key]) {
+        self.pairs[key] = @{@"entity_id": entity.entityId, @"forecast_type": type};
+    }
+    [self subscribeKey:key];
+    return self.forecasts[key];
+}
+
+- (void)reset {
+    [self unsubscribeAll];
+    [self.pairs removeAllObjects];
+    [self.forecasts removeAllObjects];
+    self.loadedServerURL = nil;
+    [[HACacheManager sharedManager] deleteCacheFile:kForecastCacheFile];
+}
+
+#pragma mark - Subscriptions
+
+- (void)subscribeKey:(NSString *)key {
+    NSDictionary *pair = self.pairs[key];
+    if (!pair || self.subscriptionIds[key]) return;
+
+    __weak typeof(self) weakSelf = self;
+    NSInteger subscriptionId = [[HAConnectionManager sharedManager] subscribeWithCommand:@{
+        @"type": @"weather/subscribe_forecast",
+        @"entity_id": pair[@"entity_id"],
+        @"forecast_type": pair[@"forecast_type"],
+    } handler:^(NSDictionary *eventData) {
+        [weakSelf storeForecast:[HAWeatherForecastStore forecastFromEventData:eventData] forKey:key];
+    }];
+    // 0 = not authenticated yet; connectionDidConnect: picks it up
+    if (subscriptionId > 0) {
+        self.subscriptionIds[key] = @(subscriptionId);
+    }
+}
+
+- (void)unsubscribeAll {
+    HAConnectionManager *conn = [HAConnectionManager sharedManager];
+    for (NSNumber *subscriptionId in self.subscriptionIds.allValues) {
+        [conn unsubscribeFromEventWithId:subscriptionId.integerValue];
+    }
+    [self.subscriptionIds removeAllObjects];
+}
+
+- (void)connectionDidConnect:(NSNotification *)note {
+    [self loadIfNeeded];
+    for (NSString *key in self.pairs.allKeys) {
+        [self subscribeKey:key];
+    }
+}
+
+- (void)connectionDidDisconnect:(NSNotification *)note {
+    // Subscriptions die with the socket; also drop their handlers so a
+    // message id reused on the next socket can't reach them
+    [self unsubscribeAll];
+}
+
+- (void)storeForecast:(NSArray *)forecast forKey:(NSString *)key {
+    NSDictionary *pair = self.pairs[key];
+    // An unavailable entity sends no forecast: keep showing the last one
+    if (!pair || forecast.count == 0) return;
+    if ([self.forecasts[key] isEqualToArray:forecast]) return;
+
+    self.forecasts[key] = forecast;
+    [self schedulePersist];
+    [[NSNotificationCenter defaultCenter] postNotificationName:HAWeatherForecastStoreDidUpdateNotification
+                                                        object:self
+                                                      userInfo:pair];
+}
+
+#pragma mark - Persistence
+
+/// Load the current server's forecasts from disk. On a server switch the
+/// previous server's pairs and subscriptions are dropped first.
+- (void)loadIfNeeded {
+    NSString *serverURL = [HACacheManager sharedManager].serverURL;
+    if (!serverURL || [serverURL isEqualToString:self.loadedServerURL]) return;
+
+    if (self.loadedServerURL) {
+        [self unsubscribeAll];
+        [self.pairs removeAllObjects];
+        [self.forecasts removeAllObjects];
+    }
+    self.loadedServerURL = serverURL;
+
+    NSDictionary *cached = [[HACacheManager sharedManager] readJSONFromFile:kForecastCacheFile];
+    if (![cached isKindOfClass:[NSDictionary class]]) return;
+    for (NSString *key in cached) {
+        NSArray *forecast = cached[key];
+        if ([forecast isKindOfClass:[NSArray class]] && !self.forecasts[key]) {
+            self.forecasts[key] = forecast;
+        }
+    }
+    HALogD(@"weather", @"Loaded %lu cached forecasts", (unsigned long)self.forecasts.count);
+}
+
+- (void)schedulePersist {
+    if (self.persistScheduled) return;
+    self.persistScheduled = YES;
+    __weak typeof(self) weakSelf = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kPersistDelay * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        if (!strongSelf) return;
+        strongSelf.persistScheduled = NO;
+        if (!strongSelf.loadedServerURL) return;
+        [[HACacheManager sharedManager] writeJSON:[strongSelf.forecasts copy] toFile:kForecastCacheFile completion:nil];
+    });
+}
+
+#pragma mark - Parsing
+
++ (NSArray *)forecastFromEventData:(NSDictionary *)eventData {
+    if (![eventData isKindOfClass:[NSDictionary class]]) return nil;
+    NSArray *forecast = eventData[@"forecast"];
+    if (![forecast isKindOfClass:[NSArray class]]) return nil;
+
+    NSMutableArray *entries = [NSMutableArray arrayWithCapacity:forecast.count];
+    for (id entry in forecast) {
+        if ([entry isKindOfClass:[NSDictionary class]]) [entries addObject:entry];
+    }
+    return entries.count > 0 ? [entries copy] : nil;
+}
+
+@end
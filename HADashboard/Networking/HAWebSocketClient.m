@@ -1,5 +1,6 @@
 #import "HAWebSocketClient.h"
 #import "HALog.h"
+#import "HAPerfMonitor.h"
 #import "HAAuthManager.h"
 #import "SRWebSocket.h"
 
@@ -198,6 +199,7 @@
 }
 
 - (void)webSocket:(SRWebSocket *)webSocket didReceiveMessage:(id)message {
+    HAPerfScopedSpan(HAPerfCategoryNetwork, "ws.message", NULL);
     NSData *data = nil;
     if ([message isKindOfClass:[NSString class]]) {
         data = [(NSString *)message dataUsingEncoding:NSUTF8StringEncoding];
@@ -208,7 +210,10 @@
     if (!data) return;
 
     NSError *error = nil;
+    HAPerfSpan parseSpan = HAPerfSpanBegin(HAPerfCategoryParse, "json.parse", NULL);
     NSDictionary *dict = [NSJSONSerialization JSONObjectWithData:data options:0 error:&error];
+    HAPerfSpanEnd(parseSpan);
+    HAPerfCounter("ws.bytes", data.length);
     if (error || ![dict isKindOfClass:[NSDictionary class]]) {
         HALogE(@"conn", @"Failed to parse message: %@", error);
         return;
@@ -1,7 +1,6 @@
 #import "HACalendarCardCell.h"
 #import "HADashboardConfig.h"
-#import "HAAuthManager.h"
-#import "HADateUtils.h"
+#import "HACalendarEventStore.h"
 #import "HATheme.h"
 #import "HAIconMapper.h"
 
@@ -15,26 +14,12 @@ static const CGFloat kMonthGridRowHeight = 28.0;
 
 static UIColor *sDefaultEventColor;
 
-#pragma mark - HACalendarEvent (internal model)
-
-@interface HACalendarEvent : NSObject
-@property (nonatomic, copy) NSString *summary;
-@property (nonatomic, strong) NSDate *startDate;
-@property (nonatomic, strong) NSDate *endDate;
-@property (nonatomic, assign) BOOL allDay;
-@property (nonatomic, copy) NSString *location;
-@end
-
-@implementation HACalendarEvent
-@end
-
-#pragma mark - HACalendarCardCell
-
 @interface HACalendarCardCell ()
 @property (nonatomic, assign) HACalendarViewMode viewMode;
 @property (nonatomic, copy) NSArray<NSString *> *entityIds;
 @property (nonatomic, strong) NSArray<HACalendarEvent *> *events;
-@property (nonatomic, strong) NSURLSessionDataTask *fetchTask;
+/// Bumped per load; completions of an older load are dropped
+@property (nonatomic, assign) NSUInteger loadGeneration;
 @property (nonatomic, assign) BOOL needsEventsLoad;
 
 // Navigation state
@@ -81,10 +66,19 @@ static UIColor *sDefaultEventColor;
         _timeFormatter.timeStyle = NSDateFormatterShortStyle;
 
         [self setupSubviews];
+
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(calendarEventsDidUpdate:)
+                                                     name:HACalendarEventStoreDidUpdateNotification
+                                                   object:nil];
     }
     return self;
 }
 
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
 #pragma mark - Subview Setup
 
 - (void)setupSubviews {
@@ -258,25 +252,25 @@ static UIColor *sDefaultEventColor;
 }
 
 - (void)prevTapped {
-    if (self.viewMode == HACalendarViewModeMonth) {
-        self.displayStartDate = [self.calendar dateByAddingUnit:NSCalendarUnitMonth value:-1 toDate:self.displayStartDate options:0];
-    } else {
-        self.displayStartDate = [self.calendar dateByAddingUnit:NSCalendarUnitDay value:-7 toDate:self.displayStartDate options:0];
-    }
+    self.displayStartDate = [self displayStartDateSteppedBy:-1];
     [self updateDateRangeLabel];
     [self refetch];
 }
 
 - (void)nextTapped {
-    if (self.viewMode == HACalendarViewModeMonth) {
-        self.displayStartDate = [self.calendar dateByAddingUnit:NSCalendarUnitMonth value:1 toDate:self.displayStartDate options:0];
-    } else {
-        self.displayStartDate = [self.calendar dateByAddingUnit:NSCalendarUnitDay value:7 toDate:self.displayStartDate options:0];
-    }
+    self.displayStartDate = [self displayStartDateSteppedBy:1];
     [self updateDateRangeLabel];
     [self refetch];
 }
 
+/// displayStartDate moved by step months (month view) or weeks (list view)
+- (NSDate *)displayStartDateSteppedBy:(NSInteger)step {
+    if (self.viewMode == HACalendarViewModeMonth) {
+        return [self.calendar dateByAddingUnit:NSCalendarUnitMonth value:step toDate:self.displayStartDate options:0];
+    }
+    return [self.calendar dateByAddingUnit:NSCalendarUnitDay value:7 * step toDate:self.displayStartDate options:0];
+}
+
 - (void)switchToList {
     if (self.viewMode == HACalendarViewModeList) return;
     self.viewMode = HACalendarViewModeList;
@@ -296,7 +290,7 @@ static UIColor *sDefaultEventColor;
 - (void)refetch {
     self.events = nil;
     [self cancelLoading];
-    [self fetchEvents];
+    [self loadEvents];
 }
 
 - (void)updateDateRangeLabel {
@@ -340,154 +334,114 @@ static UIColor *sDefaultEventColor;
 - (void)beginLoading {
     if (self.needsEventsLoad && self.entityIds.count > 0) {
         self.needsEventsLoad = NO;
-        [self fetchEvents];
+        [self loadEvents];
+    } else {
+        [self registerShownRange];
     }
 }
 
 - (void)cancelLoading {
-    [self.fetchTask cancel];
-    self.fetchTask = nil;
+    // The fetch itself keeps going: it fills the shared store for next time
+    self.loadGeneration++;
+    [[HACalendarEventStore sharedStore] unregisterInterestForOwner:self];
 }
 
-#pragma mark - Event Fetching
-
-- (void)fetchEvents {
-    NSString *serverURL = [[HAAuthManager sharedManager] serverURL];
-    NSString *token = [[HAAuthManager sharedManager] accessToken];
-    if (!serverURL || !token || self.entityIds.count == 0) {
-        [self showPlaceholder:@"Not configured"];
-        return;
-    }
-
+/// Keep the shown range refreshing in the store while the card is on screen
+- (void)registerShownRange {
+    if (self.entityIds.count == 0) return;
     NSDate *startDate;
     NSDate *endDate;
+    [self getStartDate:&startDate endDate:&endDate forDisplayDate:self.displayStartDate];
+    [[HACalendarEventStore sharedStore] registerInterestInCalendars:self.entityIds
+                                                          startDate:startDate
+                                                            endDate:endDate
+                                                           forOwner:self];
+}
+
+#pragma mark - Event Loading
 
+/// Fetch window of the month or week starting at date
+- (void)getStartDate:(NSDate **)startDate endDate:(NSDate **)endDate forDisplayDate:(NSDate *)date {
     if (self.viewMode == HACalendarViewModeMonth) {
-        NSDateComponents *comp = [self.calendar components:(NSCalendarUnitYear | NSCalendarUnitMonth) fromDate:self.displayStartDate];
-        startDate = [self.calendar dateFromComponents:comp];
+        NSDateComponents *comp = [self.calendar components:(NSCalendarUnitYear | NSCalendarUnitMonth) fromDate:date];
+        *startDate = [self.calendar dateFromComponents:comp];
         comp.month += 1;
-        endDate = [self.calendar dateFromComponents:comp];
+        *endDate = [self.calendar dateFromComponents:comp];
     } else {
-        startDate = self.displayStartDate;
-        endDate = [self.calendar dateByAddingUnit:NSCalendarUnitDay value:7 toDate:startDate options:0];
+        *startDate = date;
+        *endDate = [self.calendar dateByAddingUnit:NSCalendarUnitDay value:7 toDate:date options:0];
     }
+}
 
-    static NSDateFormatter *isoFmt;
-    static dispatch_once_t fmtOnce;
-    dispatch_once(&fmtOnce, ^{
-        isoFmt = [[NSDateFormatter alloc] init];
-        isoFmt.dateFormat = @"yyyy-MM-dd'T'HH:mm:ss.000'Z'";
-        isoFmt.timeZone = [NSTimeZone timeZoneWithAbbreviation:@"UTC"];
-        isoFmt.locale = [[NSLocale alloc] initWithLocaleIdentifier:@"en_US_POSIX"];
-    });
-
-    NSString *startStr = [isoFmt stringFromDate:startDate];
-    NSString *endStr = [isoFmt stringFromDate:endDate];
-
-    NSString *entityId = self.entityIds.firstObject;
-    NSString *urlStr = [NSString stringWithFormat:@"%@/api/calendars/%@?start=%@&end=%@",
-                        serverURL, entityId, startStr, endStr];
-    NSURL *url = [NSURL URLWithString:urlStr];
-    if (!url) {
-        [self showPlaceholder:@"Invalid URL"];
+- (void)loadEvents {
+    if (self.entityIds.count == 0) {
+        [self showPlaceholder:@"Not configured"];
         return;
     }
 
-    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:url];
-    request.HTTPMethod = @"GET";
-    [request setValue:[NSString stringWithFormat:@"Bearer %@", token] forHTTPHeaderField:@"Authorization"];
-    [request setValue:@"application/json" forHTTPHeaderField:@"Content-Type"];
-    request.timeoutInterval = 15.0;
+    NSDate *startDate;
+    NSDate *endDate;
+    [self getStartDate:&startDate endDate:&endDate forDisplayDate:self.displayStartDate];
+
+    // Show what the store has right away; the load below only hits the
+    // network if a calendar's range is missing or stale
+    HACalendarEventStore *store = [HACalendarEventStore sharedStore];
+    [store registerInterestInCalendars:self.entityIds startDate:startDate endDate:endDate forOwner:self];
+    NSArray<HACalendarEvent *> *cached = [store cachedEventsForCalendars:self.entityIds startDate:startDate endDate:endDate];
+    if (cached) {
+        self.events = cached;
+        [self renderEvents];
+    }
 
+    NSUInteger generation = ++self.loadGeneration;
     __weak typeof(self) weakSelf = self;
-    self.fetchTask = [[NSURLSession sharedSession] dataTaskWithRequest:request completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+    [store loadEventsForCalendars:self.entityIds startDate:startDate endDate:endDate completion:^(NSArray<HACalendarEvent *> *events, NSError *error) {
+        __strong typeof(weakSelf) self = weakSelf;
+        if (!self || generation != self.loadGeneration) return;
         if (error) {
-            if ([error.domain isEqualToString:NSURLErrorDomain] && error.code == NSURLErrorCancelled) return;
-            dispatch_async(dispatch_get_main_queue(), ^{
-                [weakSelf showPlaceholder:@"Failed to load"];
-            });
+            if (!cached) [self showPlaceholder:@"Failed to load"];
             return;
         }
-
-        NSArray *parsed = nil;
-        if (data.length > 0) {
-            parsed = [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
-        }
-
-        NSArray<HACalendarEvent *> *events = [HACalendarCardCell parseEvents:parsed];
-
-        dispatch_async(dispatch_get_main_queue(), ^{
-            __strong typeof(weakSelf) self = weakSelf;
-            if (!self) return;
+        if (!cached || ![events isEqualToArray:cached]) {
             self.events = events;
-            if (self.viewMode == HACalendarViewModeMonth) {
-                [self renderMonthView];
-            } else {
-                [self renderListView];
-            }
-        });
+            [self renderEvents];
+        }
+        [self prefetchAdjacentRanges];
     }];
-    [self.fetchTask resume];
 }
 
-#pragma mark - Event Parsing
-
-+ (NSArray<HACalendarEvent *> *)parseEvents:(NSArray *)rawEvents {
-    if (![rawEvents isKindOfClass:[NSArray class]]) return @[];
-
-    static NSDateFormatter *dateFmt;
-    static dispatch_once_t parseOnce;
-    dispatch_once(&parseOnce, ^{
-        dateFmt = [[NSDateFormatter alloc] init];
-        dateFmt.dateFormat = @"yyyy-MM-dd";
-        dateFmt.locale = [[NSLocale alloc] initWithLocaleIdentifier:@"en_US_POSIX"];
-    });
-
-    NSMutableArray<HACalendarEvent *> *events = [NSMutableArray arrayWithCapacity:rawEvents.count];
-    for (NSDictionary *raw in rawEvents) {
-        if (![raw isKindOfClass:[NSDictionary class]]) continue;
-
-        HACalendarEvent *event = [[HACalendarEvent alloc] init];
-        event.summary = raw[@"summary"] ?: @"(No title)";
-        event.location = raw[@"location"];
-
-        id startObj = raw[@"start"];
-        if ([startObj isKindOfClass:[NSDictionary class]]) {
-            NSDictionary *startDict = startObj;
-            if (startDict[@"dateTime"]) {
-                event.startDate = [HADateUtils dateFromISO8601String:startDict[@"dateTime"]];
-                event.allDay = NO;
-            } else if (startDict[@"date"]) {
-                event.startDate = [dateFmt dateFromString:startDict[@"date"]];
-                event.allDay = YES;
-            }
-        } else if ([startObj isKindOfClass:[NSString class]]) {
-            event.startDate = [HADateUtils dateFromISO8601String:startObj] ?: [dateFmt dateFromString:startObj];
-            event.allDay = ([dateFmt dateFromString:startObj] != nil && [HADateUtils dateFromISO8601String:startObj] == nil);
-        }
-
-        id endObj = raw[@"end"];
-        if ([endObj isKindOfClass:[NSDictionary class]]) {
-            NSDictionary *endDict = endObj;
-            if (endDict[@"dateTime"]) {
-                event.endDate = [HADateUtils dateFromISO8601String:endDict[@"dateTime"]];
-            } else if (endDict[@"date"]) {
-                event.endDate = [dateFmt dateFromString:endDict[@"date"]];
-            }
-        } else if ([endObj isKindOfClass:[NSString class]]) {
-            event.endDate = [HADateUtils dateFromISO8601String:endObj] ?: [dateFmt dateFromString:endObj];
-        }
-
-        if (event.startDate) {
-            [events addObject:event];
-        }
+/// Warm the previous and next month / week so navigation renders from cache
+- (void)prefetchAdjacentRanges {
+    HACalendarEventStore *store = [HACalendarEventStore sharedStore];
+    for (NSNumber *step in @[@1, @-1]) {
+        NSDate *startDate;
+        NSDate *endDate;
+        [self getStartDate:&startDate endDate:&endDate forDisplayDate:[self displayStartDateSteppedBy:step.integerValue]];
+        [store prefetchEventsForCalendars:self.entityIds startDate:startDate endDate:endDate];
     }
+}
 
-    [events sortUsingComparator:^NSComparisonResult(HACalendarEvent *a, HACalendarEvent *b) {
-        return [a.startDate compare:b.startDate];
-    }];
+- (void)calendarEventsDidUpdate:(NSNotification *)note {
+    // Not on screen yet: beginLoading reads the store anyway
+    if (self.needsEventsLoad || ![self.entityIds containsObject:note.userInfo[@"entity_id"]]) return;
 
-    return events;
+    NSDate *startDate;
+    NSDate *endDate;
+    [self getStartDate:&startDate endDate:&endDate forDisplayDate:self.displayStartDate];
+    NSArray<HACalendarEvent *> *events = [[HACalendarEventStore sharedStore] cachedEventsForCalendars:self.entityIds
+                                                                                            startDate:startDate
+                                                                                              endDate:endDate];
+    if (!events || [events isEqualToArray:self.events]) return;
+    self.events = events;
+    [self renderEvents];
+}
+
+- (void)renderEvents {
+    if (self.viewMode == HACalendarViewModeMonth) {
+        [self renderMonthView];
+    } else {
+        [self renderListView];
+    }
 }
 
 #pragma mark - Multi-day Event Projection
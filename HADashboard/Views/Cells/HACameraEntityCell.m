@@ -7,6 +7,7 @@
 #import "HAIconMapper.h"
 #import "HAMJPEGStreamParser.h"
 #import "HALog.h"
+#import "HAPerfMonitor.h"
 #import <AVFoundation/AVFoundation.h>
 #import <objc/runtime.h>
 
@@ -64,6 +65,7 @@ static const NSInteger kSnapshotPromotionMaxIndex = 3;
 @property (nonatomic, strong) AVPlayerLayer *hlsPlayerLayer;
 @property (nonatomic, assign) BOOL hlsFailed;
 @property (nonatomic, assign) BOOL hlsRequestInFlight; // prevent duplicate WS requests
+@property (nonatomic, strong) HACommandToken *hlsRequestToken;
 @property (nonatomic, assign) BOOL hlsStatusKVORegistered;  // track KVO registration
 @property (nonatomic, assign) BOOL hlsReadyKVORegistered;   // track KVO registration
 
@@ -938,6 +940,7 @@ static HACameraStreamMode currentStreamMode(void) {
             // creates a lazily-decoded image — actual pixel decode happens on first
             // render (main thread). Drawing into a throwaway context forces immediate
             // decode here, so the main thread just blits pre-decoded pixels.
+            HAPerfSpan decodeSpan = HAPerfSpanBegin(HAPerfCategoryImage, "image.decode", "camera.snapshot");
             UIImage *lazyImage = [UIImage imageWithData:data];
             UIImage *image = nil;
             if (lazyImage) {
@@ -946,6 +949,7 @@ static HACameraStreamMode currentStreamMode(void) {
                 image = UIGraphicsGetImageFromCurrentImageContext();
                 UIGraphicsEndImageContext();
             }
+            HAPerfSpanEnd(decodeSpan);
 
             dispatch_async(dispatch_get_main_queue(), ^{
                 __strong typeof(weakSelf) strongSelf = weakSelf;
@@ -1098,10 +1102,14 @@ static HACameraStreamMode currentStreamMode(void) {
     };
     __weak typeof(self) weakSelf = self;
     NSString *expectedEntityId = [self.currentEntityId copy];
-    [[HAConnectionManager sharedManager] sendCommand:command completion:^(id result, NSError *error) {
+    self.hlsRequestToken = [[HAConnectionManager sharedManager] sendCommand:command
+                                                                  priority:HACommandPriorityNormal
+                                                                   timeout:15.0
+                                                                completion:^(id result, NSError *error) {
         __strong typeof(weakSelf) strongSelf = weakSelf;
         if (!strongSelf) return;
         strongSelf.hlsRequestInFlight = NO;
+        strongSelf.hlsRequestToken = nil;
         if (![strongSelf.currentEntityId isEqualToString:expectedEntityId]) return;
 
         if (error || ![result isKindOfClass:[NSDictionary class]]) {
@@ -1599,6 +1607,8 @@ static HACameraStreamMode currentStreamMode(void) {
     self.hlsLive = NO;
     self.lastFrameTime = nil;
     self.reconnectAttempts = 0;
+    [self.hlsRequestToken cancel];
+    self.hlsRequestToken = nil;
     self.hlsRequestInFlight = NO;
     self.recentFrameCount = 0;
     self.frameWindowStart = nil;
@@ -1670,6 +1680,8 @@ static HACameraStreamMode currentStreamMode(void) {
     self.receivingFrames = NO;
     self.hlsLive = NO;
     self.lastFrameTime = nil;
+    [self.hlsRequestToken cancel];
+    self.hlsRequestToken = nil;
     self.hlsRequestInFlight = NO;
     self.recentFrameCount = 0;
     self.frameWindowStart = nil;
@@ -12,4 +12,10 @@
 /// Used by snapshot tests to produce deterministic output.
 @property (nonatomic, strong) NSDate *overrideDate;
 
+/// Stop the 1 s clock timer and the weather icon animation (screen dimmed).
+- (void)pauseUpdates;
+
+/// Bring the clock up to date and restart the timer and icon animation.
+- (void)resumeUpdates;
+
 @end
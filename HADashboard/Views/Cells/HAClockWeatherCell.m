@@ -5,8 +5,10 @@
 #import "HATheme.h"
 #import "HAIconMapper.h"
 #import "HAConnectionManager.h"
-#import "LOTAnimationView.h"
+#import "HASpriteAnimationView.h"
+#import "HAWeatherIconAtlas.h"
 #import "HAWeatherHelper.h"
+#import "HAWeatherForecastStore.h"
 
 /// Top content height: padding(12) + max(icon 80, text chain ~96) = ~110pt
 static const CGFloat kTopContentHeight = 110.0;
@@ -16,9 +18,11 @@ static const CGFloat kForecastGap = 8.0;
 static const CGFloat kForecastRowHeight = 30.0;
 /// Bottom padding below forecast
 static const CGFloat kBottomPadding = 12.0;
+/// Animated weather icon edge length
+static const CGFloat kWeatherIconSize = 80.0;
 
 @interface HAClockWeatherCell ()
-@property (nonatomic, strong) LOTAnimationView *lottieView;      // animated weather icon
+@property (nonatomic, strong) HASpriteAnimationView *weatherIconView; // animated weather icon (atlas)
 @property (nonatomic, strong) UILabel *weatherIconLabel;          // MDI fallback
 @property (nonatomic, copy)   NSString *currentWeatherIcon;       // currently loaded icon name
 @property (nonatomic, strong) UILabel *conditionLabel;
@@ -55,13 +59,19 @@ static const CGFloat kBottomPadding = 12.0;
     self.nameLabel.hidden = YES;
     self.stateLabel.hidden = YES;
 
+    [[NSNotificationCenter defaultCenter] addObserver:self
+                                             selector:@selector(forecastDidUpdate:)
+                                                 name:HAWeatherForecastStoreDidUpdateNotification
+                                               object:nil];
+
     CGFloat padding = 12.0;
-    CGFloat iconSize = 80.0;
+    CGFloat iconSize = kWeatherIconSize;
 
-    // Lottie animated weather icon (from clock-weather-card)
-    // Placeholder view — actual LOTAnimationView is created in loadWeatherIconForCondition:
-    // since LOTAnimationView needs the animation name at init time
-    self.lottieView = nil; // created lazily
+    // Animated weather icon (clock-weather-card Lottie exports, pre-rasterized
+    // to a sprite atlas by HAWeatherIconAtlas). Hidden until an atlas is ready.
+    self.weatherIconView = [[HASpriteAnimationView alloc] initWithFrame:CGRectMake(padding, padding, iconSize, iconSize)];
+    self.weatherIconView.hidden = YES;
+    [self.contentView addSubview:self.weatherIconView];
 
     // MDI fallback label (shown if no Lottie JSON available)
     self.weatherIconLabel = [[UILabel alloc] init];
@@ -109,7 +119,7 @@ static const CGFloat kBottomPadding = 12.0;
 
     // --- Layout ---
 
-    // Weather icon (MDI fallback / Lottie placeholder position)
+    // Weather icon (MDI fallback / sprite atlas position)
     [self.contentView addConstraint:[NSLayoutConstraint constraintWithItem:self.weatherIconLabel attribute:NSLayoutAttributeLeading
         relatedBy:NSLayoutRelationEqual toItem:self.contentView attribute:NSLayoutAttributeLeading multiplier:1 constant:padding]];
     [self.contentView addConstraint:[NSLayoutConstraint constraintWithItem:self.weatherIconLabel attribute:NSLayoutAttributeTop
@@ -226,16 +236,14 @@ static const CGFloat kBottomPadding = 12.0;
     // Update clock and date immediately
     [self updateClockDisplay];
 
-    // Start timer
-    [self.clockTimer invalidate];
-    self.clockTimer = [NSTimer scheduledTimerWithTimeInterval:1.0
-                                                      target:self
-                                                    selector:@selector(clockTimerFired)
-                                                    userInfo:nil
-                                                     repeats:YES];
+    [self startClockTimer];
 
-    // Forecast bar — fetch via WebSocket (modern HA removed forecast from entity attributes)
-    [self fetchForecastForEntity:entity];
+    // Forecast bar from the shared store (modern HA removed forecast from entity
+    // attributes); forecastDidUpdate: re-renders when a new one is pushed
+    NSArray *forecast = [[HAWeatherForecastStore sharedStore] forecastForEntity:entity type:HAWeatherForecastTypeDaily];
+    if (forecast.count > 0) {
+        [self renderForecast:forecast entity:entity];
+    }
 }
 
 #pragma mark - Temperature / Humidity Resolution
@@ -300,6 +308,30 @@ static const CGFloat kBottomPadding = 12.0;
 
 #pragma mark - Clock Timer
 
+- (void)startClockTimer {
+    [self.clockTimer invalidate];
+    self.clockTimer = [NSTimer scheduledTimerWithTimeInterval:1.0
+                                                      target:self
+                                                    selector:@selector(clockTimerFired)
+                                                    userInfo:nil
+                                                     repeats:YES];
+}
+
+- (void)pauseUpdates {
+    [self.clockTimer invalidate];
+    self.clockTimer = nil;
+    [self.weatherIconView stopAnimating];
+}
+
+- (void)resumeUpdates {
+    if (!self.window) return;
+    [self updateClockDisplay];
+    [self startClockTimer];
+    if (self.weatherIconView.atlas && !self.weatherIconView.hidden) {
+        [self.weatherIconView startAnimating];
+    }
+}
+
 - (void)clockTimerFired {
     [self updateClockDisplay];
 }
@@ -348,26 +380,16 @@ static const CGFloat kBottomPadding = 12.0;
 
 #pragma mark - Forecast
 
-/// Fetch forecast via WebSocket call_service with return_response (HA 2023.7+).
-/// The subscribe_forecast API is subscription-based and doesn't return data in the
-/// initial result. Using call_service + return_response is a one-shot approach that
-/// works with the completion handler pattern.
-- (void)fetchForecastForEntity:(HAEntity *)entity {
-    __weak typeof(self) weakSelf = self;
-    NSString *currentEntityId = entity.entityId;
-
-    [HAWeatherHelper fetchForecastForEntity:entity completion:^(NSArray *forecast, NSError *error) {
-        __strong typeof(weakSelf) strongSelf = weakSelf;
-        if (!strongSelf) return;
-
-        // Verify cell still shows the same entity (not reused)
-        if (![strongSelf.entity.entityId isEqualToString:currentEntityId]) return;
+/// Re-render when the store receives a new forecast for this entity.
+- (void)forecastDidUpdate:(NSNotification *)note {
+    HAEntity *entity = self.entity;
+    if (!entity || ![note.userInfo[@"entity_id"] isEqualToString:entity.entityId]) return;
+    if (![note.userInfo[@"forecast_type"] isEqualToString:HAWeatherForecastTypeDaily]) return;
 
-        if (forecast.count > 0) {
-            HAEntity *currentEntity = [[HAConnectionManager sharedManager] entityForId:currentEntityId];
-            [strongSelf renderForecast:forecast entity:currentEntity ?: entity];
-        }
-    }];
+    NSArray *forecast = [[HAWeatherForecastStore sharedStore] forecastForEntity:entity type:HAWeatherForecastTypeDaily];
+    if (forecast.count > 0) {
+        [self renderForecast:forecast entity:entity];
+    }
 }
 
 /// Render forecast data as a visual bar: [Day] [Icon] [Low°] [==gradient==] [High°]
@@ -498,10 +520,8 @@ static const CGFloat kBottomPadding = 12.0;
 
 #pragma mark - Weather Icon
 
-/// Map HA weather condition to the animated icon filename (from clock-weather-card Lottie exports).
-/// Returns nil if no matching icon bundle is found — falls back to MDI glyph.
-+ (NSString *)iconFileNameForCondition:(NSString *)condition isDaytime:(BOOL)daytime {
-    if (!condition) return nil;
+/// HA weather condition → animated icon filename (from clock-weather-card Lottie exports).
++ (NSDictionary *)iconMapForDaytime:(BOOL)daytime {
     static NSDictionary *dayMap = nil;
     static NSDictionary *nightMap = nil;
     static dispatch_once_t onceToken;
@@ -541,12 +561,19 @@ static const CGFloat kBottomPadding = 12.0;
             @"exceptional":      @"dust-day",
         };
     });
-    NSDictionary *map = daytime ? dayMap : nightMap;
-    return map[condition] ?: dayMap[condition];
+    return daytime ? dayMap : nightMap;
 }
 
-/// Load animated weather icon using lottie-ios 2.x (LOTAnimationView).
-/// Falls back to MDI glyph + Core Animation if Lottie JSON not found.
+/// Map HA weather condition to the animated icon filename.
+/// Returns nil if no matching icon bundle is found — falls back to MDI glyph.
++ (NSString *)iconFileNameForCondition:(NSString *)condition isDaytime:(BOOL)daytime {
+    if (!condition) return nil;
+    return [self iconMapForDaytime:daytime][condition] ?: [self iconMapForDaytime:YES][condition];
+}
+
+/// Load the animated weather icon as a pre-rendered sprite atlas.
+/// Shows the MDI glyph fallback while the atlas loads (or renders on first use),
+/// and permanently if no Lottie JSON exists for the condition.
 - (void)loadWeatherIconForCondition:(NSString *)condition {
     // Determine day/night
     NSCalendar *cal = [NSCalendar currentCalendar];
@@ -555,37 +582,51 @@ static const CGFloat kBottomPadding = 12.0;
 
     NSString *iconName = [[self class] iconFileNameForCondition:condition isDaytime:isDaytime];
 
-    // Skip if same icon already playing
-    if ([iconName isEqualToString:self.currentWeatherIcon] && self.lottieView) return;
-
-    // Remove old Lottie view
-    [self.lottieView removeFromSuperview];
-    self.lottieView = nil;
-
-    CGFloat padding = 12.0;
-    CGFloat iconSize = 80.0;
+    // Skip if same icon already showing (or still loading)
+    if (iconName && [iconName isEqualToString:self.currentWeatherIcon]) return;
+    self.currentWeatherIcon = iconName;
 
-    // Try loading Lottie JSON from bundle
     if (iconName) {
-        NSString *path = [[NSBundle mainBundle] pathForResource:iconName ofType:@"json"];
-        if (path) {
-            LOTAnimationView *lottie = [LOTAnimationView animationWithFilePath:path];
-            lottie.frame = CGRectMake(padding, padding, iconSize, iconSize);
-            lottie.contentMode = UIViewContentModeScaleAspectFit;
-            lottie.loopAnimation = YES;
-            [self.contentView insertSubview:lottie belowSubview:self.weatherIconLabel];
-            [lottie play];
-
-            self.lottieView = lottie;
-            self.currentWeatherIcon = iconName;
-            self.weatherIconLabel.hidden = YES;
-            [self.weatherIconLabel.layer removeAllAnimations];
+        HAWeatherIconAtlas *cached = [HAWeatherIconAtlas cachedAtlasForIconName:iconName pointSize:kWeatherIconSize];
+        if (cached) {
+            [self showWeatherAtlas:cached];
             return;
         }
+
+        [self showFallbackIconForCondition:condition];
+        __weak typeof(self) weakSelf = self;
+        [HAWeatherIconAtlas loadAtlasForIconName:iconName pointSize:kWeatherIconSize completion:^(HAWeatherIconAtlas *atlas) {
+            __strong typeof(weakSelf) strongSelf = weakSelf;
+            if (!strongSelf) return;
+            // Cell may have been reused or moved to another condition meanwhile
+            if (![strongSelf.currentWeatherIcon isEqualToString:iconName]) return;
+            if (!atlas) {
+                strongSelf.currentWeatherIcon = nil;
+                return;
+            }
+            [strongSelf showWeatherAtlas:atlas];
+            [[strongSelf class] prewarmWeatherAtlases];
+        }];
+        return;
     }
 
-    // Fall back to MDI glyph with Core Animation
     self.currentWeatherIcon = nil;
+    [self showFallbackIconForCondition:condition];
+}
+
+- (void)showWeatherAtlas:(HAWeatherIconAtlas *)atlas {
+    self.weatherIconView.atlas = atlas;
+    self.weatherIconView.hidden = NO;
+    [self.weatherIconView startAnimating];
+    self.weatherIconLabel.hidden = YES;
+    [self.weatherIconLabel.layer removeAllAnimations];
+}
+
+/// MDI glyph with Core Animation
+- (void)showFallbackIconForCondition:(NSString *)condition {
+    [self.weatherIconView stopAnimating];
+    self.weatherIconView.atlas = nil;
+    self.weatherIconView.hidden = YES;
     self.weatherIconLabel.hidden = NO;
 
     NSString *mdiIconName = [HAWeatherHelper mdiIconNameForCondition:condition];
@@ -594,6 +635,22 @@ static const CGFloat kBottomPadding = 12.0;
     [self animateWeatherIconForCondition:condition];
 }
 
+/// Render atlases for every mapped condition (day and night) once per launch,
+/// so later condition changes load from disk instead of running Lottie.
++ (void)prewarmWeatherAtlases {
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSMutableArray *names = [NSMutableArray array];
+        for (NSString *condition in [self iconMapForDaytime:YES]) {
+            NSString *day = [self iconFileNameForCondition:condition isDaytime:YES];
+            NSString *night = [self iconFileNameForCondition:condition isDaytime:NO];
+            if (day) [names addObject:day];
+            if (night) [names addObject:night];
+        }
+        [HAWeatherIconAtlas prewarmIconNames:names pointSize:kWeatherIconSize];
+    });
+}
+
 /// Core Animation fallback for MDI glyph weather icon
 - (void)animateWeatherIconForCondition:(NSString *)condition {
     [self.weatherIconLabel.layer removeAllAnimations];
@@ -667,8 +724,9 @@ static const CGFloat kBottomPadding = 12.0;
     [super prepareForReuse];
     [self.clockTimer invalidate];
     self.clockTimer = nil;
-    [self.lottieView removeFromSuperview];
-    self.lottieView = nil;
+    [self.weatherIconView stopAnimating];
+    self.weatherIconView.atlas = nil;
+    self.weatherIconView.hidden = YES;
     self.currentWeatherIcon = nil;
     [self.weatherIconLabel.layer removeAllAnimations];
     self.weatherIconLabel.text = nil;
@@ -688,6 +746,7 @@ static const CGFloat kBottomPadding = 12.0;
 
 - (void)dealloc {
     [_clockTimer invalidate];
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
 }
 
 @end
@@ -2,6 +2,7 @@
 #import "HASwitch.h"
 #import "HADashboardConfig.h"
 #import "HAEntity.h"
+#import "HAConditionEvaluator.h"
 #import "HAEntityRowView.h"
 #import "HAIconMapper.h"
 #import "HATheme.h"
@@ -171,154 +172,11 @@ static const CGFloat kSceneChipRowHeight = 44.0; // chip height + padding
     }
 }
 
-static inline NSString *HANormalizeState(id val) {
-    if (!val) return @"";
-    NSString *str = [[val description] lowercaseString];
-    if ([str isEqualToString:@"1"] || [str isEqualToString:@"true"] || [str isEqualToString:@"on"]) {
-        return @"on";
-    }
-    if ([str isEqualToString:@"0"] || [str isEqualToString:@"false"] || [str isEqualToString:@"off"]) {
-        return @"off";
-    }
-    return str;
-}
-
 + (BOOL)meetsCondition:(NSDictionary *)condition
               entities:(NSDictionary *)entities {
-    if (![condition isKindOfClass:[NSDictionary class]]) return YES;
-
-    NSString *condType = condition[@"condition"];
-    if (!condType && condition[@"entity"]) {
-        condType = @"state";
-    }
-
-    if ([condType isEqualToString:@"state"]) {
-        NSString *entityId = condition[@"entity"];
-        if (!entityId) return YES;
-
-        HAEntity *entity = entities[entityId];
-        NSString *currentState = entity.state;
-
-        id requiredStateRaw = condition[@"state"];
-        id requiredStateNotRaw = condition[@"state_not"];
-
-        if (requiredStateRaw) {
-            NSArray *requiredStates = [requiredStateRaw isKindOfClass:[NSArray class]]
-                                          ? (NSArray *)requiredStateRaw
-                                          : @[ [requiredStateRaw description] ];
-            BOOL matched = NO;
-            NSString *currNorm = HANormalizeState(currentState);
-            for (id req in requiredStates) {
-                if ([HANormalizeState(req) isEqualToString:currNorm]) {
-                    matched = YES;
-                    break;
-                }
-            }
-            if (!matched) return NO;
-        }
-
-        if (requiredStateNotRaw) {
-            NSArray *requiredStatesNot = [requiredStateNotRaw isKindOfClass:[NSArray class]]
-                                              ? (NSArray *)requiredStateNotRaw
-                                              : @[ [requiredStateNotRaw description] ];
-            NSString *currNorm = HANormalizeState(currentState);
-            for (id req in requiredStatesNot) {
-                if ([HANormalizeState(req) isEqualToString:currNorm]) {
-                    return NO;
-                }
-            }
-        }
-        return YES;
-    }
-
-    if ([condType isEqualToString:@"numeric_state"]) {
-        NSString *entityId = condition[@"entity"];
-        if (!entityId) return YES;
-
-        HAEntity *entity = entities[entityId];
-        NSString *currentState = entity.state;
-        if (!currentState) return NO;
-
-        double currentVal = [currentState doubleValue];
-        id aboveRaw = condition[@"above"];
-        id belowRaw = condition[@"below"];
-
-        if (aboveRaw) {
-            double aboveVal = [aboveRaw doubleValue];
-            if (currentVal <= aboveVal) return NO;
-        }
-        if (belowRaw) {
-            double belowVal = [belowRaw doubleValue];
-            if (currentVal >= belowVal) return NO;
-        }
-        return YES;
-    }
-
-    if ([condType isEqualToString:@"and"]) {
-        NSArray *subConditions = condition[@"conditions"];
-        if ([subConditions isKindOfClass:[NSArray class]]) {
-            for (NSDictionary *sub in subConditions) {
-                if (![self meetsCondition:sub entities:entities]) return NO;
-            }
-        }
-        return YES;
-    }
-
-    if ([condType isEqualToString:@"or"]) {
-        NSArray *subConditions = condition[@"conditions"];
-        if ([subConditions isKindOfClass:[NSArray class]]) {
-            if (subConditions.count == 0) return YES;
-            for (NSDictionary *sub in subConditions) {
-                if ([self meetsCondition:sub entities:entities]) return YES;
-            }
-            return NO;
-        }
-        return YES;
-    }
-
-    if ([condType isEqualToString:@"not"]) {
-        NSArray *subConditions = condition[@"conditions"];
-        if ([subConditions isKindOfClass:[NSArray class]]) {
-            for (NSDictionary *sub in subConditions) {
-                if ([self meetsCondition:sub entities:entities]) return NO;
-            }
-        }
-        return YES;
-    }
-
-    if ([condType isEqualToString:@"user"]) {
-        return YES; // always pass local dashboard
-    }
-
-    if ([condType isEqualToString:@"screen"]) {
-        NSString *query = condition[@"media_query"];
-        if ([query isKindOfClass:[NSString class]]) {
-            CGFloat width = [UIScreen mainScreen].bounds.size.width;
-            if ([query containsString:@"min-width"]) {
-                NSScanner *scanner = [NSScanner scannerWithString:query];
-                [scanner scanUpToString:@"min-width" intoString:nil];
-                [scanner scanString:@"min-width" intoString:nil];
-                [scanner scanUpToCharactersFromSet:[NSCharacterSet decimalDigitCharacterSet] intoString:nil];
-                NSInteger minWidth = 0;
-                if ([scanner scanInteger:&minWidth] && width < minWidth) {
-                    return NO;
-                }
-            }
-            if ([query containsString:@"max-width"]) {
-                NSScanner *scanner = [NSScanner scannerWithString:query];
-                [scanner scanUpToString:@"max-width" intoString:nil];
-                [scanner scanString:@"max-width" intoString:nil];
-                [scanner scanUpToCharactersFromSet:[NSCharacterSet decimalDigitCharacterSet] intoString:nil];
-                NSInteger maxWidth = 0;
-                if ([scanner scanInteger:&maxWidth] && width > maxWidth) {
-                    return NO;
-                }
-            }
-        }
-        return YES;
-    }
-
-    return YES;
+    return [HAConditionEvaluator evaluateCondition:condition
+                                          entities:entities
+                                       screenWidth:[UIScreen mainScreen].bounds.size.width];
 }
 
 - (BOOL)meetsCondition:(NSDictionary *)condition
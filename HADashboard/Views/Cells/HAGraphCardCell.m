@@ -4,8 +4,10 @@
 #import "HADashboardConfig.h"
 #import "HATheme.h"
 #import "HAHistoryManager.h"
+#import "HAStatisticsManager.h"
 #import "HAEntityDisplayHelper.h"
 #import "HAIconMapper.h"
+#import "HAPerfMonitor.h"
 #import <objc/runtime.h>
 
 /// Default color palette for multi-entity graphs (matches HA web ordering)
@@ -32,6 +34,10 @@ static NSArray<UIColor *> *sColorPalette;
 @property (nonatomic, copy) NSArray<NSDictionary *> *graphEntities; // Array of @{@"entityId", @"color", @"label"}
 // State timeline support: YES when all entities are state-based (binary_sensor, switch, etc.)
 @property (nonatomic, assign) BOOL isTimelineMode;
+// statistics-graph: pre-aggregated recorder statistics instead of raw history
+@property (nonatomic, assign) BOOL usesStatistics;
+@property (nonatomic, copy) NSString *statisticsPeriod;       // nil = chosen from hoursToShow
+@property (nonatomic, copy) NSArray<NSString *> *statisticTypes;
 @end
 
 @implementation HAGraphCardCell
@@ -198,6 +204,9 @@ static NSArray<UIColor *> *sColorPalette;
     self.showExtrema = NO;
     self.showAverage = NO;
     self.hoursToShow = 0;
+    self.usesStatistics = NO;
+    self.statisticsPeriod = nil;
+    self.statisticTypes = nil;
 
     // Reset icon layout
     NSLayoutConstraint *toIcon = objc_getAssociatedObject(self, "nameLeadingToIcon");
@@ -387,6 +396,9 @@ static NSArray<UIColor *> *sColorPalette;
     if ([hours isKindOfClass:[NSNumber class]] && [hours integerValue] > 0) {
         self.hoursToShow = [hours integerValue];
     }
+    self.usesStatistics = [props[@"statistics"] boolValue];
+    self.statisticsPeriod = props[@"period"];
+    self.statisticTypes = props[@"stat_types"];
 
     // Show config: extrema, average
     NSDictionary *showConfig = props[@"show"];
@@ -500,7 +512,9 @@ static NSArray<UIColor *> *sColorPalette;
 - (void)beginLoading {
     if (self.needsHistoryLoad && self.currentEntityId) {
         self.needsHistoryLoad = NO;
-        if (self.graphEntities.count > 1 || self.isTimelineMode) {
+        if (self.usesStatistics && !self.isTimelineMode) {
+            [self loadStatisticsForGraphEntities];
+        } else if (self.graphEntities.count > 1 || self.isTimelineMode) {
             [self loadHistoryForMultipleEntities];
         } else {
             [self loadHistoryForEntityId:self.currentEntityId];
@@ -527,6 +541,7 @@ static NSArray<UIColor *> *sColorPalette;
                                                   completion:^(NSArray *points, NSError *error) {
         __strong typeof(weakSelf) strongSelf = weakSelf;
         if (!strongSelf || ![strongSelf.currentEntityId isEqualToString:capturedEntityId]) return;
+        HAPerfScopedSpan(HAPerfCategoryCell, "cell.history", "HAGraphCardCell");
         if (points.count > 0) {
             strongSelf.graphView.dataPoints = points;
             [strongSelf updateStatsFromPoints:points];
@@ -581,6 +596,7 @@ static NSArray<UIColor *> *sColorPalette;
     dispatch_group_notify(group, dispatch_get_main_queue(), ^{
         __strong typeof(weakSelf) strongSelf = weakSelf;
         if (!strongSelf || ![strongSelf.currentEntityId isEqualToString:capturedPrimaryId]) return;
+        HAPerfScopedSpan(HAPerfCategoryCell, "cell.history", "HAGraphCardCell");
 
         if (capturedTimelineMode) {
             NSMutableArray *timelineEntries = [NSMutableArray array];
@@ -626,6 +642,66 @@ static NSArray<UIColor *> *sColorPalette;
     });
 }
 
+#pragma mark - Statistics Fetch
+
+/// One recorder/statistics_during_period request for every graphed entity.
+/// Falls back to raw history if none of them has long-term statistics.
+- (void)loadStatisticsForGraphEntities {
+    NSInteger hours = self.hoursToShow > 0 ? self.hoursToShow : 24;
+    NSArray *graphEntities = [self.graphEntities copy];
+    NSString *capturedPrimaryId = [self.currentEntityId copy];
+    NSArray<NSString *> *types = [self.statisticTypes copy];
+    NSDate *endDate = [NSDate date];
+    NSDate *startDate = [endDate dateByAddingTimeInterval:-hours * 3600.0];
+    HAStatisticsPeriod period = [HAStatisticsManager periodFromString:self.statisticsPeriod
+        defaultPeriod:[HAStatisticsManager periodForDuration:hours * 3600.0 maxBuckets:800]];
+
+    NSMutableArray<NSString *> *entityIds = [NSMutableArray arrayWithCapacity:graphEntities.count];
+    for (NSDictionary *info in graphEntities) {
+        [entityIds addObject:info[@"entityId"]];
+    }
+    if (entityIds.count == 0) entityIds = [NSMutableArray arrayWithObject:capturedPrimaryId];
+
+    __weak typeof(self) weakSelf = self;
+    [[HAStatisticsManager sharedManager] fetchStatisticsForIds:entityIds
+                                                     startDate:startDate
+                                                       endDate:endDate
+                                                        period:period
+                                                         types:types
+                                                    completion:^(NSDictionary *statistics, NSError *error) {
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        if (!strongSelf || ![strongSelf.currentEntityId isEqualToString:capturedPrimaryId]) return;
+        if (statistics.count == 0) {
+            if (graphEntities.count > 1) {
+                [strongSelf loadHistoryForMultipleEntities];
+            } else {
+                [strongSelf loadHistoryForEntityId:capturedPrimaryId];
+            }
+            return;
+        }
+        HAPerfScopedSpan(HAPerfCategoryCell, "cell.statistics", "HAGraphCardCell");
+
+        NSArray *primaryPoints = [HAStatisticsManager pointsFromRows:statistics[capturedPrimaryId] types:types];
+        if (graphEntities.count <= 1) {
+            if (primaryPoints.count > 0) strongSelf.graphView.dataPoints = primaryPoints;
+        } else {
+            NSMutableArray *dataSeries = [NSMutableArray array];
+            for (NSDictionary *info in graphEntities) {
+                NSArray *points = [HAStatisticsManager pointsFromRows:statistics[info[@"entityId"]] types:types];
+                if (points.count == 0) continue;
+                [dataSeries addObject:@{
+                    @"points": points,
+                    @"color": info[@"color"],
+                    @"label": info[@"label"],
+                    @"unit": info[@"unit"] ?: @"",
+                }];
+            }
+            if (dataSeries.count > 0) strongSelf.graphView.dataSeries = dataSeries;
+        }
+        [strongSelf updateStatsFromPoints:primaryPoints];
+    }];
+}
+
 #pragma mark - Stats
 
 - (void)updateStatsFromPoints:(NSArray *)points {
@@ -4,10 +4,32 @@
 @class HADashboardConfigSection;
 
 /// Map card: shows entity locations as annotations on an MKMapView.
+///
+/// Reconfiguring diffs annotations by entity ID: a tracker that moved is
+/// moved in place, and the region only recenters once the entities drift
+/// noticeably. With many trackers, pins close together on screen are
+/// clustered. `snapshot_mode: true` in the card config renders the map once
+/// through MKMapSnapshotter instead of keeping a live MKMapView (wall
+/// panels); the base image is cached per region and pins are drawn over it.
 @interface HAMapCardCell : HABaseEntityCell
 
 - (void)configureWithSection:(HADashboardConfigSection *)section
                     entities:(NSDictionary<NSString *, HAEntity *> *)entities
                   configItem:(HADashboardConfigItem *)configItem;
 
+#pragma mark - Markers
+
+/// Group pins (@{@"key", @"latitude", @"longitude", @"title"}) into markers
+/// for a map of mapSize showing region. Below the clustering threshold each
+/// pin is its own marker; above it, pins sharing a 44pt grid cell merge into
+/// one marker at their mean, keyed by its first pin. Markers carry the pin
+/// keys plus @"count".
++ (NSArray<NSDictionary *> *)markersForPins:(NSArray<NSDictionary *> *)pins
+                                     region:(MKCoordinateRegion)region
+                                    mapSize:(CGSize)mapSize;
+
+/// Whether a map showing current should move to target: the span changed,
+/// or the center drifted more than a fifth of the span.
++ (BOOL)region:(MKCoordinateRegion)current needsUpdateForRegion:(MKCoordinateRegion)target;
+
 @end
@@ -1,55 +1,139 @@
 #import "HAMapCardCell.h"
 #import "HAEntity.h"
 #import "HADashboardConfig.h"
+#import "HALog.h"
 #import "HATheme.h"
 
-@interface HAMapCardCell ()
+/// Grid cell, in points, within which pins are clustered
+static const CGFloat kClusterCellSize = 44.0;
+/// Fewer pins than this are never clustered
+static const NSUInteger kClusterMinimumPins = 8;
+/// The map recenters once the entities' center drifts this fraction of the span
+static const double kRecenterFraction = 0.2;
+
+#pragma mark - HAMapMarker
+
+/// Annotation for one pin or cluster. Kept across reconfigures and moved in
+/// place; MKMapView observes coordinate and title.
+@interface HAMapMarker : NSObject <MKAnnotation>
+@property (nonatomic, copy) NSString *key;
+@property (nonatomic, assign) CLLocationCoordinate2D coordinate;
+@property (nonatomic, copy) NSString *title;
+@property (nonatomic, assign) NSUInteger count;
+@end
+
+@implementation HAMapMarker
+@end
+
+#pragma mark - HAMapCardCell
+
+@interface HAMapCardCell () <MKMapViewDelegate>
+/// Live map; created on first use, never in snapshot mode
 @property (nonatomic, strong) MKMapView *mapView;
+@property (nonatomic, strong) UIImageView *snapshotView;
+@property (nonatomic, assign) BOOL snapshotMode;
+@property (nonatomic, assign) BOOL darkMode;
+/// Pins of the last configure, re-clustered when the size changes
+@property (nonatomic, copy) NSArray<NSDictionary *> *pins;
+/// Map size the markers were clustered for
+@property (nonatomic, assign) CGSize markerSize;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, HAMapMarker *> *markersByKey;
+/// Snapshot mode: marker key -> view composited over the snapshot
+@property (nonatomic, strong) NSMutableDictionary<NSString *, UIView *> *markerViewsByKey;
+@property (nonatomic, assign) BOOL hasRegion;
+@property (nonatomic, assign) MKCoordinateRegion region;
+/// Region, size and style of the snapshot shown or being rendered
+@property (nonatomic, copy) NSString *snapshotKey;
+@property (nonatomic, strong) MKMapSnapshot *snapshot;
+@property (nonatomic, strong) MKMapSnapshotter *snapshotter;
 @end
 
 @implementation HAMapCardCell
 
+/// Rendered base maps, shared by all map cards
++ (NSCache *)snapshotCache {
+    static NSCache *cache;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        cache = [[NSCache alloc] init];
+        cache.countLimit = 8;
+    });
+    return cache;
+}
+
 - (void)setupSubviews {
     [super setupSubviews];
     self.nameLabel.hidden = YES;
     self.stateLabel.hidden = YES;
+    self.markersByKey = [NSMutableDictionary dictionary];
+    self.markerViewsByKey = [NSMutableDictionary dictionary];
 
-    self.mapView = [[MKMapView alloc] init];
-    self.mapView.translatesAutoresizingMaskIntoConstraints = NO;
-    self.mapView.layer.cornerRadius = 12;
-    self.mapView.clipsToBounds = YES;
-    self.mapView.userInteractionEnabled = NO; // static map in card view
-    [self.contentView addSubview:self.mapView];
+    self.snapshotView = [[UIImageView alloc] init];
+    self.snapshotView.translatesAutoresizingMaskIntoConstraints = NO;
+    self.snapshotView.layer.cornerRadius = 12;
+    self.snapshotView.clipsToBounds = YES;
+    self.snapshotView.hidden = YES;
+    [self.contentView addSubview:self.snapshotView];
+    [self pinToContentView:self.snapshotView];
+}
 
+- (void)pinToContentView:(UIView *)view {
     [NSLayoutConstraint activateConstraints:@[
-        [self.mapView.leadingAnchor constraintEqualToAnchor:self.contentView.leadingAnchor],
-        [self.mapView.trailingAnchor constraintEqualToAnchor:self.contentView.trailingAnchor],
-        [self.mapView.topAnchor constraintEqualToAnchor:self.contentView.topAnchor],
-        [self.mapView.bottomAnchor constraintEqualToAnchor:self.contentView.bottomAnchor],
+        [view.leadingAnchor constraintEqualToAnchor:self.contentView.leadingAnchor],
+        [view.trailingAnchor constraintEqualToAnchor:self.contentView.trailingAnchor],
+        [view.topAnchor constraintEqualToAnchor:self.contentView.topAnchor],
+        [view.bottomAnchor constraintEqualToAnchor:self.contentView.bottomAnchor],
     ]];
 }
 
+- (MKMapView *)liveMapView {
+    if (!self.mapView) {
+        self.mapView = [[MKMapView alloc] init];
+        self.mapView.translatesAutoresizingMaskIntoConstraints = NO;
+        self.mapView.layer.cornerRadius = 12;
+        self.mapView.clipsToBounds = YES;
+        self.mapView.userInteractionEnabled = NO; // static map in card view
+        self.mapView.delegate = self;
+        [self.contentView insertSubview:self.mapView belowSubview:self.snapshotView];
+        [self pinToContentView:self.mapView];
+    }
+    return self.mapView;
+}
+
+#pragma mark - Configuration
+
 - (void)configureWithSection:(HADashboardConfigSection *)section
                     entities:(NSDictionary<NSString *, HAEntity *> *)entities
                   configItem:(HADashboardConfigItem *)configItem {
     self.nameLabel.hidden = YES;
     self.stateLabel.hidden = YES;
-
-    [self.mapView removeAnnotations:self.mapView.annotations];
+    self.contentView.backgroundColor = [HATheme cellBackgroundColor];
 
     NSDictionary *props = section.customProperties;
     NSNumber *defaultZoom = props[@"default_zoom"];
     BOOL darkMode = [props[@"dark_mode"] boolValue];
+    BOOL snapshotMode = [props[@"snapshot_mode"] boolValue];
 
-    // Dark mode map appearance (iOS 13+)
-    if (@available(iOS 13.0, *)) {
-        self.mapView.overrideUserInterfaceStyle = darkMode ? UIUserInterfaceStyleDark : UIUserInterfaceStyleUnspecified;
+    if (snapshotMode != self.snapshotMode || darkMode != self.darkMode) {
+        [self resetMap];
+        self.snapshotMode = snapshotMode;
+        self.darkMode = darkMode;
+    }
+    self.snapshotView.hidden = !snapshotMode;
+    if (!snapshotMode) {
+        MKMapView *mapView = [self liveMapView];
+        mapView.hidden = NO;
+        // Dark mode map appearance (iOS 13+)
+        if (@available(iOS 13.0, *)) {
+            mapView.overrideUserInterfaceStyle = darkMode ? UIUserInterfaceStyleDark : UIUserInterfaceStyleUnspecified;
+        }
+    } else {
+        self.mapView.hidden = YES;
     }
 
-    // Add entity locations as annotations
+    // Entity locations
+    NSMutableArray<NSDictionary *> *pins = [NSMutableArray arrayWithCapacity:section.entityIds.count];
     CLLocationCoordinate2D sumCoord = {0, 0};
-    NSInteger count = 0;
-
     for (NSString *eid in section.entityIds) {
         HAEntity *entity = entities[eid];
         if (!entity) continue;
@@ -58,34 +142,330 @@
         NSNumber *lon = entity.attributes[@"longitude"];
         if (![lat isKindOfClass:[NSNumber class]] || ![lon isKindOfClass:[NSNumber class]]) continue;
 
-        CLLocationCoordinate2D coord = CLLocationCoordinate2DMake([lat doubleValue], [lon doubleValue]);
-        MKPointAnnotation *pin = [[MKPointAnnotation alloc] init];
-        pin.coordinate = coord;
-        pin.title = entity.attributes[@"friendly_name"] ?: eid;
-        [self.mapView addAnnotation:pin];
-
-        sumCoord.latitude += coord.latitude;
-        sumCoord.longitude += coord.longitude;
-        count++;
+        [pins addObject:@{@"key": eid, @"latitude": lat, @"longitude": lon,
+                          @"title": entity.attributes[@"friendly_name"] ?: eid}];
+        sumCoord.latitude += [lat doubleValue];
+        sumCoord.longitude += [lon doubleValue];
     }
+    self.pins = pins;
 
-    // Center map on entities
-    if (count > 0) {
-        CLLocationCoordinate2D center = CLLocationCoordinate2DMake(sumCoord.latitude / count,
-                                                                    sumCoord.longitude / count);
+    // Center map on entities, unless they only moved a little
+    if (pins.count > 0) {
+        CLLocationCoordinate2D center = CLLocationCoordinate2DMake(sumCoord.latitude / pins.count,
+                                                                    sumCoord.longitude / pins.count);
         double zoom = defaultZoom ? [defaultZoom doubleValue] : 14.0;
         // Convert zoom level to region span (approximate)
         double span = 360.0 / pow(2.0, zoom);
         MKCoordinateRegion region = MKCoordinateRegionMake(center, MKCoordinateSpanMake(span, span));
-        [self.mapView setRegion:region animated:NO];
+        if (!self.hasRegion || [HAMapCardCell region:self.region needsUpdateForRegion:region]) {
+            self.region = region;
+            self.hasRegion = YES;
+            if (!snapshotMode) [self.mapView setRegion:region animated:NO];
+        }
     }
 
-    self.contentView.backgroundColor = [HATheme cellBackgroundColor];
+    [self updateMarkers];
+}
+
+- (void)layoutSubviews {
+    [super layoutSubviews];
+    if (!CGSizeEqualToSize(self.contentView.bounds.size, self.markerSize)) {
+        [self updateMarkers];
+    }
+}
+
+/// Cluster the pins for the current size and apply them to the live map or
+/// the snapshot.
+- (void)updateMarkers {
+    CGSize size = self.contentView.bounds.size;
+    self.markerSize = size;
+    NSArray<NSDictionary *> *markers = self.hasRegion ? [HAMapCardCell markersForPins:self.pins region:self.region mapSize:size] : @[];
+
+    [self applyMarkers:markers];
+    if (self.snapshotMode) [self updateSnapshot];
+}
+
+/// Diff markers against the annotations shown: move or retitle the ones
+/// that stayed, and add or remove only what changed.
+- (void)applyMarkers:(NSArray<NSDictionary *> *)markers {
+    NSMutableDictionary<NSString *, HAMapMarker *> *stale = [self.markersByKey mutableCopy];
+    NSMutableArray<HAMapMarker *> *added = [NSMutableArray array];
+    NSMutableArray<HAMapMarker *> *removed = [NSMutableArray array];
+
+    for (NSDictionary *m in markers) {
+        NSString *key = m[@"key"];
+        NSUInteger count = [m[@"count"] unsignedIntegerValue];
+        CLLocationCoordinate2D coord = CLLocationCoordinate2DMake([m[@"latitude"] doubleValue], [m[@"longitude"] doubleValue]);
+        HAMapMarker *marker = stale[key];
+        [stale removeObjectForKey:key];
+
+        if (marker && marker.count == count) {
+            if (marker.coordinate.latitude != coord.latitude || marker.coordinate.longitude != coord.longitude) {
+                marker.coordinate = coord;
+            }
+            if (![marker.title isEqualToString:m[@"title"]]) {
+                marker.title = m[@"title"];
+            }
+            continue;
+        }
+
+        // New, or a cluster that gained or lost pins: its view changes
+        if (marker) [removed addObject:marker];
+        marker = [[HAMapMarker alloc] init];
+        marker.key = key;
+        marker.coordinate = coord;
+        marker.title = m[@"title"];
+        marker.count = count;
+        self.markersByKey[key] = marker;
+        [added addObject:marker];
+    }
+    for (HAMapMarker *marker in stale.allValues) {
+        [self.markersByKey removeObjectForKey:marker.key];
+        [removed addObject:marker];
+    }
+
+    if (self.snapshotMode) {
+        for (HAMapMarker *marker in removed) {
+            [self.markerViewsByKey[marker.key] removeFromSuperview];
+            [self.markerViewsByKey removeObjectForKey:marker.key];
+        }
+        [self layoutSnapshotMarkers];
+        return;
+    }
+    if (removed.count > 0) [self.mapView removeAnnotations:removed];
+    if (added.count > 0) [self.mapView addAnnotations:added];
+}
+
+- (void)resetMap {
+    [self.snapshotter cancel];
+    self.snapshotter = nil;
+    self.snapshot = nil;
+    self.snapshotKey = nil;
+    self.snapshotView.image = nil;
+    for (UIView *view in self.markerViewsByKey.allValues) [view removeFromSuperview];
+    [self.markerViewsByKey removeAllObjects];
+    if (self.mapView.annotations.count > 0) [self.mapView removeAnnotations:self.mapView.annotations];
+    [self.markersByKey removeAllObjects];
+    self.pins = nil;
+    self.hasRegion = NO;
+}
+
+#pragma mark - Snapshot Mode
+
+/// Render the base map for the current region and size, unless it is shown
+/// already or cached.
+- (void)updateSnapshot {
+    CGSize size = self.contentView.bounds.size;
+    if (!self.hasRegion || size.width < 1 || size.height < 1) return;
+
+    MKCoordinateRegion region = self.region;
+    NSString *key = [NSString stringWithFormat:@"%.5f,%.5f,%.5f,%.5f,%.0fx%.0f,%d",
+                     region.center.latitude, region.center.longitude,
+                     region.span.latitudeDelta, region.span.longitudeDelta,
+                     size.width, size.height, self.darkMode];
+    if ([key isEqualToString:self.snapshotKey]) return;
+    self.snapshotKey = key;
+    [self.snapshotter cancel];
+    self.snapshotter = nil;
+
+    MKMapSnapshot *cached = [[HAMapCardCell snapshotCache] objectForKey:key];
+    if (cached) {
+        [self showSnapshot:cached];
+        return;
+    }
+    self.snapshot = nil;
+    self.snapshotView.image = nil;
+    [self layoutSnapshotMarkers];
+
+    MKMapSnapshotOptions *options = [[MKMapSnapshotOptions alloc] init];
+    options.region = region;
+    options.size = size;
+    options.scale = [UIScreen mainScreen].scale;
+    if (@available(iOS 13.0, *)) {
+        if (self.darkMode) {
+            options.traitCollection = [UITraitCollection traitCollectionWithUserInterfaceStyle:UIUserInterfaceStyleDark];
+        }
+    }
+
+    MKMapSnapshotter *snapshotter = [[MKMapSnapshotter alloc] initWithOptions:options];
+    self.snapshotter = snapshotter;
+    __weak typeof(self) weakSelf = self;
+    [snapshotter startWithCompletionHandler:^(MKMapSnapshot *snapshot, NSError *error) {
+        if (!snapshot) {
+            if (error) HALogW(@"map", @"Snapshot failed: %@", error.localizedDescription);
+            return;
+        }
+        [[HAMapCardCell snapshotCache] setObject:snapshot forKey:key];
+        __strong typeof(weakSelf) self = weakSelf;
+        if (!self || ![key isEqualToString:self.snapshotKey]) return;
+        self.snapshotter = nil;
+        [self showSnapshot:snapshot];
+    }];
+}
+
+- (void)showSnapshot:(MKMapSnapshot *)snapshot {
+    self.snapshot = snapshot;
+    self.snapshotView.image = snapshot.image;
+    [self layoutSnapshotMarkers];
 }
 
+/// Position a view per marker over the snapshot; hidden until it arrives.
+- (void)layoutSnapshotMarkers {
+    for (HAMapMarker *marker in self.markersByKey.allValues) {
+        UIView *view = self.markerViewsByKey[marker.key];
+        if (!view) {
+            view = [HAMapCardCell markerViewForMarker:marker];
+            self.markerViewsByKey[marker.key] = view;
+            [self.snapshotView addSubview:view];
+        }
+        view.hidden = (self.snapshot == nil);
+        if (!self.snapshot) continue;
+
+        CGPoint point = [self.snapshot pointForCoordinate:marker.coordinate];
+        CGPoint offset = [view isKindOfClass:[MKAnnotationView class]] ? ((MKAnnotationView *)view).centerOffset : CGPointZero;
+        view.center = CGPointMake(point.x + offset.x, point.y + offset.y);
+    }
+}
+
+#pragma mark - Marker Views
+
++ (UIView *)markerViewForMarker:(HAMapMarker *)marker {
+    if (marker.count > 1) {
+        return [[UIImageView alloc] initWithImage:[self clusterImageForCount:marker.count]];
+    }
+    return [[MKPinAnnotationView alloc] initWithAnnotation:nil reuseIdentifier:nil];
+}
+
+/// Accent-colored disc with the pin count
++ (UIImage *)clusterImageForCount:(NSUInteger)count {
+    static NSCache *images;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        images = [[NSCache alloc] init];
+    });
+    UIColor *color = [HATheme accentColor];
+    NSString *key = [NSString stringWithFormat:@"%lu|%@", (unsigned long)count, color];
+    UIImage *image = [images objectForKey:key];
+    if (image) return image;
+
+    CGFloat diameter = count < 10 ? 28.0 : 34.0;
+    CGRect rect = CGRectMake(0, 0, diameter, diameter);
+    UIGraphicsBeginImageContextWithOptions(rect.size, NO, 0);
+    [[UIColor whiteColor] setFill];
+    [[UIBezierPath bezierPathWithOvalInRect:rect] fill];
+    [color setFill];
+    [[UIBezierPath bezierPathWithOvalInRect:CGRectInset(rect, 2, 2)] fill];
+
+    NSString *text = [NSString stringWithFormat:@"%lu", (unsigned long)count];
+    NSDictionary *attrs = @{NSFontAttributeName: [UIFont boldSystemFontOfSize:13],
+                            NSForegroundColorAttributeName: [UIColor whiteColor]};
+    CGSize textSize = [text sizeWithAttributes:attrs];
+    [text drawAtPoint:CGPointMake((diameter - textSize.width) / 2.0, (diameter - textSize.height) / 2.0)
+       withAttributes:attrs];
+    image = UIGraphicsGetImageFromCurrentImageContext();
+    UIGraphicsEndImageContext();
+
+    if (image) [images setObject:image forKey:key];
+    return image;
+}
+
+#pragma mark - MKMapViewDelegate
+
+- (MKAnnotationView *)mapView:(MKMapView *)mapView viewForAnnotation:(id<MKAnnotation>)annotation {
+    if (![annotation isKindOfClass:[HAMapMarker class]]) return nil;
+    HAMapMarker *marker = (HAMapMarker *)annotation;
+
+    if (marker.count > 1) {
+        static NSString *const clusterId = @"HAMapCluster";
+        MKAnnotationView *view = [mapView dequeueReusableAnnotationViewWithIdentifier:clusterId];
+        if (!view) {
+            view = [[MKAnnotationView alloc] initWithAnnotation:marker reuseIdentifier:clusterId];
+        }
+        view.annotation = marker;
+        view.image = [HAMapCardCell clusterImageForCount:marker.count];
+        return view;
+    }
+
+    static NSString *const pinId = @"HAMapPin";
+    MKAnnotationView *view = [mapView dequeueReusableAnnotationViewWithIdentifier:pinId];
+    if (!view) {
+        view = [[MKPinAnnotationView alloc] initWithAnnotation:marker reuseIdentifier:pinId];
+    }
+    view.annotation = marker;
+    return view;
+}
+
+#pragma mark - Markers
+
++ (NSArray<NSDictionary *> *)markersForPins:(NSArray<NSDictionary *> *)pins
+                                     region:(MKCoordinateRegion)region
+                                    mapSize:(CGSize)mapSize {
+    NSMutableArray<NSDictionary *> *markers = [NSMutableArray arrayWithCapacity:pins.count];
+    BOOL cluster = pins.count >= kClusterMinimumPins && mapSize.width >= 1 && mapSize.height >= 1 &&
+                   region.span.latitudeDelta > 0 && region.span.longitudeDelta > 0;
+    if (!cluster) {
+        for (NSDictionary *pin in pins) {
+            NSMutableDictionary *marker = [pin mutableCopy];
+            marker[@"count"] = @1;
+            [markers addObject:marker];
+        }
+        return markers;
+    }
+
+    // Grid in degrees matching kClusterCellSize points at this region and size
+    double cellLat = region.span.latitudeDelta * kClusterCellSize / mapSize.height;
+    double cellLon = region.span.longitudeDelta * kClusterCellSize / mapSize.width;
+    NSMutableDictionary<NSString *, NSMutableArray<NSDictionary *> *> *cells = [NSMutableDictionary dictionary];
+    NSMutableArray<NSString *> *cellOrder = [NSMutableArray array];
+    for (NSDictionary *pin in pins) {
+        long row = (long)floor([pin[@"latitude"] doubleValue] / cellLat);
+        long col = (long)floor([pin[@"longitude"] doubleValue] / cellLon);
+        NSString *cellKey = [NSString stringWithFormat:@"%ld:%ld", row, col];
+        if (!cells[cellKey]) {
+            cells[cellKey] = [NSMutableArray array];
+            [cellOrder addObject:cellKey];
+        }
+        [cells[cellKey] addObject:pin];
+    }
+
+    for (NSString *cellKey in cellOrder) {
+        NSArray<NSDictionary *> *members = cells[cellKey];
+        if (members.count == 1) {
+            NSMutableDictionary *marker = [members.firstObject mutableCopy];
+            marker[@"count"] = @1;
+            [markers addObject:marker];
+            continue;
+        }
+        double lat = 0, lon = 0;
+        for (NSDictionary *pin in members) {
+            lat += [pin[@"latitude"] doubleValue];
+            lon += [pin[@"longitude"] doubleValue];
+        }
+        [markers addObject:@{
+            @"key": [@"cluster:" stringByAppendingString:members.firstObject[@"key"]],
+            @"latitude": @(lat / members.count),
+            @"longitude": @(lon / members.count),
+            @"title": [[members valueForKey:@"title"] componentsJoinedByString:@", "],
+            @"count": @(members.count),
+        }];
+    }
+    return markers;
+}
+
++ (BOOL)region:(MKCoordinateRegion)current needsUpdateForRegion:(MKCoordinateRegion)target {
+    if (current.span.latitudeDelta != target.span.latitudeDelta ||
+        current.span.longitudeDelta != target.span.longitudeDelta) {
+        return YES;
+    }
+    return fabs(current.center.latitude - target.center.latitude) > current.span.latitudeDelta * kRecenterFraction ||
+           fabs(current.center.longitude - target.center.longitude) > current.span.longitudeDelta * kRecenterFraction;
+}
+
+#pragma mark - Reuse
+
 - (void)prepareForReuse {
     [super prepareForReuse];
-    [self.mapView removeAnnotations:self.mapView.annotations];
+    [self resetMap];
 }
 
 @end
@@ -1,8 +1,8 @@
 #import "HABaseEntityCell.h"
 
 /// Statistic card: displays a statistical aggregation (min/max/mean/change/state)
-/// for a sensor entity over a configurable period.
-/// Note: min/max/mean/change require the HA statistics API which is not yet
-/// implemented. Currently displays the entity's current state as a fallback.
+/// for a sensor entity over a configurable period. min/max/mean/change come
+/// from recorder long-term statistics (HAStatisticsManager); "state" is the
+/// entity's current state.
 @interface HAStatisticCardCell : HABaseEntityCell
 @end
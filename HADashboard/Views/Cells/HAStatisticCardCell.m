@@ -4,12 +4,16 @@
 #import "HATheme.h"
 #import "HAIconMapper.h"
 #import "HAEntityDisplayHelper.h"
+#import "HAStatisticsManager.h"
 
 @interface HAStatisticCardCell ()
 @property (nonatomic, strong) UILabel *statIconLabel;
 @property (nonatomic, strong) UILabel *statValueLabel;
 @property (nonatomic, strong) UILabel *statTypeLabel;
 @property (nonatomic, strong) UILabel *statNameLabel;
+/// entity + stat type + period of the value on screen, so a reconfigure for
+/// a state update keeps it while the (usually cached) refresh runs
+@property (nonatomic, copy) NSString *statisticKey;
 @end
 
 @implementation HAStatisticCardCell
@@ -99,26 +103,67 @@
     NSString *typeDisplay = [statType capitalizedString];
     self.statTypeLabel.text = typeDisplay;
 
-    // Value: for "state" type, show current state. For others, show current state
-    // as fallback since we don't have the statistics API yet.
-    NSString *stateText = [HAEntityDisplayHelper formattedStateForEntity:entity decimals:1];
     NSString *unit = props[@"unit"];
     if (![unit isKindOfClass:[NSString class]]) unit = entity.unitOfMeasurement;
-    if (unit.length > 0) {
-        stateText = [NSString stringWithFormat:@"%@ %@", stateText, unit];
+
+    // "state" is the current state; everything else is aggregated from
+    // recorder statistics over the card's period
+    if ([statType isEqualToString:@"state"]) {
+        self.statisticKey = nil;
+        NSString *stateText = [HAEntityDisplayHelper formattedStateForEntity:entity decimals:1];
+        self.statValueLabel.text = [self text:stateText withUnit:unit];
+    } else {
+        [self loadStatistic:statType forEntity:entity periodConfig:props[@"period"] unit:unit];
     }
-    self.statValueLabel.text = stateText;
 
     self.contentView.backgroundColor = [HATheme cellBackgroundColor];
     self.alpha = entity.isAvailable ? 1.0 : 0.5;
 }
 
+- (NSString *)text:(NSString *)text withUnit:(NSString *)unit {
+    return unit.length > 0 ? [NSString stringWithFormat:@"%@ %@", text, unit] : text;
+}
+
+- (void)loadStatistic:(NSString *)statType
+            forEntity:(HAEntity *)entity
+         periodConfig:(NSDictionary *)periodConfig
+                 unit:(NSString *)unit {
+    NSString *key = [NSString stringWithFormat:@"%@|%@|%@", entity.entityId, statType, periodConfig ?: @""];
+    if (![key isEqualToString:self.statisticKey]) {
+        self.statisticKey = key;
+        self.statValueLabel.text = @"\u2014";
+    }
+
+    NSDate *startDate = nil;
+    NSDate *endDate = nil;
+    [HAStatisticsManager getStartDate:&startDate endDate:&endDate forPeriodConfig:periodConfig now:[NSDate date]];
+    HAStatisticsPeriod period = [HAStatisticsManager periodForDuration:[endDate timeIntervalSinceDate:startDate]
+                                                            maxBuckets:400];
+    NSString *entityId = entity.entityId;
+
+    __weak typeof(self) weakSelf = self;
+    [[HAStatisticsManager sharedManager] fetchStatisticsForIds:@[entityId]
+                                                     startDate:startDate
+                                                       endDate:endDate
+                                                        period:period
+                                                         types:@[statType]
+                                                    completion:^(NSDictionary *statistics, NSError *error) {
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        if (!strongSelf || ![strongSelf.statisticKey isEqualToString:key]) return;
+        NSNumber *value = [HAStatisticsManager aggregateValueOfType:statType rows:statistics[entityId]];
+        if (!value) return;
+        NSString *text = [HAEntityDisplayHelper formattedNumberString:value.doubleValue decimals:1];
+        strongSelf.statValueLabel.text = [strongSelf text:text withUnit:unit];
+    }];
+}
+
 - (void)prepareForReuse {
     [super prepareForReuse];
     self.statIconLabel.text = nil;
     self.statValueLabel.text = nil;
     self.statTypeLabel.text = nil;
     self.statNameLabel.text = nil;
+    self.statisticKey = nil;
     self.alpha = 1.0;
 }
 
@@ -7,6 +7,7 @@
 #import "HAIconMapper.h"
 #import "HAEntityDisplayHelper.h"
 #import "UIView+HAUtilities.h"
+#import "HAPerfMonitor.h"
 
 // Gauge geometry -- proportions matched to HA web's ha-control-circular-slider:
 // SVG viewBox 320x320, center (160,160), RADIUS=145, stroke=24
@@ -558,6 +559,7 @@ typedef NS_ENUM(NSInteger, HAGaugeFillDirection) {
 #pragma mark - Layout
 
 - (void)layoutSubviews {
+    HAPerfScopedSpan(HAPerfCategoryCell, "cell.layout", "HAThermostatGaugeCell");
     [super layoutSubviews];
     [self updateGaugeArcs];
 }
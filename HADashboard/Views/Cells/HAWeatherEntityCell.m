@@ -4,8 +4,8 @@
 #import "HADashboardConfig.h"
 #import "HATheme.h"
 #import "HAIconMapper.h"
-#import "HAConnectionManager.h"
 #import "HAWeatherHelper.h"
+#import "HAWeatherForecastStore.h"
 
 /// Height for the top section: name + condition symbol + temp + details
 static const CGFloat kTopContentHeight = 90.0;
@@ -39,6 +39,11 @@ static const NSInteger kDefaultForecastRows = 5;
     [super setupSubviews];
     self.stateLabel.hidden = YES;
 
+    [[NSNotificationCenter defaultCenter] addObserver:self
+                                             selector:@selector(forecastDidUpdate:)
+                                                 name:HAWeatherForecastStoreDidUpdateNotification
+                                               object:nil];
+
     CGFloat padding = 10.0;
 
     // Large weather symbol
@@ -175,30 +180,24 @@ static const NSInteger kDefaultForecastRows = 5;
         self.contentView.backgroundColor = [HATheme cellBackgroundColor];
     }
 
-    // Fetch and render forecast
-    if (entity) {
-        [self fetchForecastForEntity:entity];
+    // Forecast from the shared store; forecastDidUpdate: re-renders when it changes
+    NSArray *forecast = [[HAWeatherForecastStore sharedStore] forecastForEntity:entity type:HAWeatherForecastTypeDaily];
+    if (forecast.count > 0) {
+        [self renderForecast:forecast entity:entity];
     }
 }
 
-#pragma mark - Forecast Fetch
-
-- (void)fetchForecastForEntity:(HAEntity *)entity {
-    __weak typeof(self) weakSelf = self;
-    NSString *currentEntityId = entity.entityId;
+#pragma mark - Forecast Updates
 
-    [HAWeatherHelper fetchForecastForEntity:entity completion:^(NSArray *forecast, NSError *error) {
-        __strong typeof(weakSelf) strongSelf = weakSelf;
-        if (!strongSelf) return;
+- (void)forecastDidUpdate:(NSNotification *)note {
+    HAEntity *entity = self.entity;
+    if (!entity || ![note.userInfo[@"entity_id"] isEqualToString:entity.entityId]) return;
+    if (![note.userInfo[@"forecast_type"] isEqualToString:HAWeatherForecastTypeDaily]) return;
 
-        // Verify cell still shows the same entity (not reused)
-        if (![strongSelf.entity.entityId isEqualToString:currentEntityId]) return;
-
-        if (forecast.count > 0) {
-            HAEntity *currentEntity = [[HAConnectionManager sharedManager] entityForId:currentEntityId];
-            [strongSelf renderForecast:forecast entity:currentEntity ?: entity];
-        }
-    }];
+    NSArray *forecast = [[HAWeatherForecastStore sharedStore] forecastForEntity:entity type:HAWeatherForecastTypeDaily];
+    if (forecast.count > 0) {
+        [self renderForecast:forecast entity:entity];
+    }
 }
 
 #pragma mark - Forecast Rendering
@@ -306,6 +305,10 @@ static const NSInteger kDefaultForecastRows = 5;
     for (UIView *v in self.forecastContainer.subviews) [v removeFromSuperview];
 }
 
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
 - (void)resetThemeColors {
     [super resetThemeColors];
     self.tempLabel.textColor = [HATheme primaryTextColor];
@@ -1,4 +1,5 @@
 #import "HAColumnarLayout.h"
+#import "HAPerfMonitor.h"
 
 @interface HAColumnarLayout ()
 @property (nonatomic, strong) NSMutableArray<UICollectionViewLayoutAttributes *> *itemAttributes;
@@ -25,6 +26,7 @@
 }
 
 - (void)prepareLayout {
+    HAPerfScopedSpan(HAPerfCategoryLayout, "layout.prepare", "HAColumnarLayout");
     [super prepareLayout];
 
     [self.itemAttributes removeAllObjects];
@@ -1,6 +1,48 @@
 #import <UIKit/UIKit.h>
 
 @class HAEntity;
+@class HADashboardConfigItem;
+
+/// How the dashboard sizes a cell; resolved from the card type and entity
+/// domain along with the reuse identifier.
+typedef NS_ENUM(NSInteger, HACellHeightStrategy) {
+    HACellHeightStrategyDefault = 0,   // fixed 100pt
+    HACellHeightStrategyCompact,       // compact tile inside a horizontal-stack
+    HACellHeightStrategyHeading,
+    HACellHeightStrategyMarkdown,
+    HACellHeightStrategyBadges,
+    HACellHeightStrategyGlance,
+    HACellHeightStrategyEntities,
+    HACellHeightStrategyThermostat,
+    HACellHeightStrategyGauge,
+    HACellHeightStrategyGraph,
+    HACellHeightStrategyCalendar,
+    HACellHeightStrategyClockWeather,
+    HACellHeightStrategyCamera,
+    HACellHeightStrategyVacuum,
+    HACellHeightStrategyWeather,
+    HACellHeightStrategyAlarm,
+    HACellHeightStrategyMediaPlayer,
+    HACellHeightStrategyTile,
+    HACellHeightStrategyLogbook,
+};
+
+/// Everything the dashboard needs to dequeue and size a config item's cell,
+/// resolved once per item. Stored on HADashboardConfigItem.cellDescriptor,
+/// which drops it when the item's card type, entity, entities section or
+/// custom properties change.
+@interface HACellDescriptor : NSObject
+@property (nonatomic, readonly) Class cellClass;
+@property (nonatomic, readonly, copy) NSString *reuseIdentifier;
+@property (nonatomic, readonly) HACellHeightStrategy heightStrategy;
+/// The item's entity followed by its entities section's, without duplicates
+@property (nonatomic, readonly, copy) NSArray<NSString *> *entityIds;
+/// NO for cells that never show entity state (headings, markdown)
+@property (nonatomic, readonly, getter=isLiveUpdating) BOOL liveUpdating;
+/// Whether the item's entity existed when this was resolved. Without an entity
+/// the domain is unknown, so the descriptor is resolved again once it arrives.
+@property (nonatomic, readonly) BOOL resolvedWithEntity;
+@end
 
 @interface HAEntityCellFactory : NSObject
 
@@ -14,4 +56,8 @@
 /// cardType overrides domain-based lookup for specific card types (entities, thermostat).
 + (NSString *)reuseIdentifierForEntity:(HAEntity *)entity cardType:(NSString *)cardType;
 
+/// The item's descriptor, resolved and stored on the item the first time and
+/// again only if it was invalidated or entity has appeared or disappeared since.
++ (HACellDescriptor *)descriptorForItem:(HADashboardConfigItem *)item entity:(HAEntity *)entity;
+
 @end
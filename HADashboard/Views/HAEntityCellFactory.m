@@ -1,5 +1,6 @@
 #import "HAEntityCellFactory.h"
 #import "HAEntity.h"
+#import "HADashboardConfig.h"
 #import "HABaseEntityCell.h"
 #import "HASwitchEntityCell.h"
 #import "HASensorEntityCell.h"
@@ -90,53 +91,80 @@ static NSString *const kPictureGlanceCellId = @"HAPictureGlanceCardCell";
 static NSString *const kMapCardCellId       = @"HAMapCardCell";
 static NSString *const kLogbookCardCellId   = @"HALogbookCardCell";
 
+@interface HACellDescriptor ()
+@property (nonatomic, readwrite) Class cellClass;
+@property (nonatomic, readwrite, copy) NSString *reuseIdentifier;
+@property (nonatomic, readwrite) HACellHeightStrategy heightStrategy;
+@property (nonatomic, readwrite, copy) NSArray<NSString *> *entityIds;
+@property (nonatomic, readwrite, getter=isLiveUpdating) BOOL liveUpdating;
+@property (nonatomic, readwrite) BOOL resolvedWithEntity;
+@end
+
+@implementation HACellDescriptor
+@end
+
+
 @implementation HAEntityCellFactory
 
+/// Reuse identifier -> cell class for every cell the factory hands out
++ (NSDictionary<NSString *, Class> *)cellClasses {
+    static NSDictionary<NSString *, Class> *classes = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        classes = @{
+            kBaseCellId:            [HABaseEntityCell class],
+            kSwitchCellId:          [HASwitchEntityCell class],
+            kSensorCellId:          [HASensorEntityCell class],
+            kLightCellId:           [HALightEntityCell class],
+            kClimateCellId:         [HAClimateEntityCell class],
+            kCoverCellId:           [HACoverEntityCell class],
+            kMediaPlayerCellId:     [HAMediaPlayerEntityCell class],
+            kSceneCellId:           [HASceneEntityCell class],
+            kInputNumberCellId:     [HAInputNumberEntityCell class],
+            kFanCellId:             [HAFanEntityCell class],
+            kInputSelectCellId:     [HAInputSelectEntityCell class],
+            kLockCellId:            [HALockEntityCell class],
+            kCameraCellId:          [HACameraEntityCell class],
+            kWeatherCellId:         [HAWeatherEntityCell class],
+            kInputDateTimeCellId:   [HAInputDateTimeEntityCell class],
+            kInputTextCellId:       [HAInputTextEntityCell class],
+            kButtonCellId:          [HAButtonEntityCell class],
+            kHumidifierCellId:      [HAHumidifierEntityCell class],
+            kVacuumCellId:          [HAVacuumEntityCell class],
+            kAlarmCellId:           [HAAlarmEntityCell class],
+            kTimerCellId:           [HATimerEntityCell class],
+            kCounterCellId:         [HACounterEntityCell class],
+            kPersonCellId:          [HAPersonEntityCell class],
+            kUpdateCellId:          [HAUpdateEntityCell class],
+            kEntitiesCardCellId:    [HAEntitiesCardCell class],
+            kThermostatGaugeCellId: [HAThermostatGaugeCell class],
+            kBadgeRowCellId:        [HABadgeRowCell class],
+            kGraphCardCellId:       [HAGraphCardCell class],
+            kHeadingCellId:         [HAHeadingCell class],
+            kClockWeatherCellId:    [HAClockWeatherCell class],
+            kTileCellId:            [HATileEntityCell class],
+            kGaugeCardCellId:       [HAGaugeCardCell class],
+            kCalendarCardCellId:    [HACalendarCardCell class],
+            kGlanceCardCellId:      [HAGlanceCardCell class],
+            kWaterHeaterCellId:     [HAWaterHeaterEntityCell class],
+            kEntityCardCellId:      [HAEntityCardCell class],
+            kStatisticCardCellId:   [HAStatisticCardCell class],
+            kMarkdownCardCellId:    [HAMarkdownCardCell class],
+            kRemoteCellId:          [HARemoteEntityCell class],
+            kImageCellId:           [HAImageEntityCell class],
+            kAreaCardCellId:        [HAAreaCardCell class],
+            kPictureGlanceCellId:   [HAPictureGlanceCardCell class],
+            kMapCardCellId:         [HAMapCardCell class],
+            kLogbookCardCellId:     [HALogbookCardCell class],
+        };
+    });
+    return classes;
+}
+
 + (void)registerCellClassesWithCollectionView:(UICollectionView *)collectionView {
-    [collectionView registerClass:[HABaseEntityCell class]    forCellWithReuseIdentifier:kBaseCellId];
-    [collectionView registerClass:[HASwitchEntityCell class]  forCellWithReuseIdentifier:kSwitchCellId];
-    [collectionView registerClass:[HASensorEntityCell class]  forCellWithReuseIdentifier:kSensorCellId];
-    [collectionView registerClass:[HALightEntityCell class]   forCellWithReuseIdentifier:kLightCellId];
-    [collectionView registerClass:[HAClimateEntityCell class] forCellWithReuseIdentifier:kClimateCellId];
-    [collectionView registerClass:[HACoverEntityCell class]       forCellWithReuseIdentifier:kCoverCellId];
-    [collectionView registerClass:[HAMediaPlayerEntityCell class] forCellWithReuseIdentifier:kMediaPlayerCellId];
-    [collectionView registerClass:[HASceneEntityCell class]       forCellWithReuseIdentifier:kSceneCellId];
-    [collectionView registerClass:[HAInputNumberEntityCell class] forCellWithReuseIdentifier:kInputNumberCellId];
-    [collectionView registerClass:[HAFanEntityCell class]         forCellWithReuseIdentifier:kFanCellId];
-    [collectionView registerClass:[HAInputSelectEntityCell class] forCellWithReuseIdentifier:kInputSelectCellId];
-    [collectionView registerClass:[HALockEntityCell class]        forCellWithReuseIdentifier:kLockCellId];
-    [collectionView registerClass:[HACameraEntityCell class]      forCellWithReuseIdentifier:kCameraCellId];
-    [collectionView registerClass:[HAWeatherEntityCell class]     forCellWithReuseIdentifier:kWeatherCellId];
-    [collectionView registerClass:[HAInputDateTimeEntityCell class] forCellWithReuseIdentifier:kInputDateTimeCellId];
-    [collectionView registerClass:[HAInputTextEntityCell class]     forCellWithReuseIdentifier:kInputTextCellId];
-    [collectionView registerClass:[HAButtonEntityCell class]        forCellWithReuseIdentifier:kButtonCellId];
-    [collectionView registerClass:[HAHumidifierEntityCell class]    forCellWithReuseIdentifier:kHumidifierCellId];
-    [collectionView registerClass:[HAVacuumEntityCell class]        forCellWithReuseIdentifier:kVacuumCellId];
-    [collectionView registerClass:[HAAlarmEntityCell class]         forCellWithReuseIdentifier:kAlarmCellId];
-    [collectionView registerClass:[HATimerEntityCell class]         forCellWithReuseIdentifier:kTimerCellId];
-    [collectionView registerClass:[HACounterEntityCell class]       forCellWithReuseIdentifier:kCounterCellId];
-    [collectionView registerClass:[HAPersonEntityCell class]        forCellWithReuseIdentifier:kPersonCellId];
-    [collectionView registerClass:[HAUpdateEntityCell class]        forCellWithReuseIdentifier:kUpdateCellId];
-    [collectionView registerClass:[HAEntitiesCardCell class]       forCellWithReuseIdentifier:kEntitiesCardCellId];
-    [collectionView registerClass:[HAThermostatGaugeCell class]    forCellWithReuseIdentifier:kThermostatGaugeCellId];
-    [collectionView registerClass:[HABadgeRowCell class]           forCellWithReuseIdentifier:kBadgeRowCellId];
-    [collectionView registerClass:[HAGraphCardCell class]         forCellWithReuseIdentifier:kGraphCardCellId];
-    [collectionView registerClass:[HAHeadingCell class]           forCellWithReuseIdentifier:kHeadingCellId];
-    [collectionView registerClass:[HAClockWeatherCell class]      forCellWithReuseIdentifier:kClockWeatherCellId];
-    [collectionView registerClass:[HATileEntityCell class]       forCellWithReuseIdentifier:kTileCellId];
-    [collectionView registerClass:[HAGaugeCardCell class]       forCellWithReuseIdentifier:kGaugeCardCellId];
-    [collectionView registerClass:[HACalendarCardCell class]   forCellWithReuseIdentifier:kCalendarCardCellId];
-    [collectionView registerClass:[HAGlanceCardCell class]    forCellWithReuseIdentifier:kGlanceCardCellId];
-    [collectionView registerClass:[HAWaterHeaterEntityCell class] forCellWithReuseIdentifier:kWaterHeaterCellId];
-    [collectionView registerClass:[HAEntityCardCell class]       forCellWithReuseIdentifier:kEntityCardCellId];
-    [collectionView registerClass:[HAStatisticCardCell class]   forCellWithReuseIdentifier:kStatisticCardCellId];
-    [collectionView registerClass:[HAMarkdownCardCell class]   forCellWithReuseIdentifier:kMarkdownCardCellId];
-    [collectionView registerClass:[HARemoteEntityCell class]     forCellWithReuseIdentifier:kRemoteCellId];
-    [collectionView registerClass:[HAImageEntityCell class]      forCellWithReuseIdentifier:kImageCellId];
-    [collectionView registerClass:[HAAreaCardCell class]          forCellWithReuseIdentifier:kAreaCardCellId];
-    [collectionView registerClass:[HAPictureGlanceCardCell class] forCellWithReuseIdentifier:kPictureGlanceCellId];
-    [collectionView registerClass:[HAMapCardCell class]           forCellWithReuseIdentifier:kMapCardCellId];
-    [collectionView registerClass:[HALogbookCardCell class]       forCellWithReuseIdentifier:kLogbookCardCellId];
+    [[self cellClasses] enumerateKeysAndObjectsUsingBlock:^(NSString *reuseId, Class cellClass, BOOL *stop) {
+        [collectionView registerClass:cellClass forCellWithReuseIdentifier:reuseId];
+    }];
 }
 
 + (NSString *)reuseIdentifierForEntity:(HAEntity *)entity {
@@ -308,4 +336,57 @@ static NSString *const kLogbookCardCellId   = @"HALogbookCardCell";
     return [self reuseIdentifierForEntity:entity];
 }
 
+#pragma mark - Descriptors
+
++ (HACellHeightStrategy)heightStrategyForItem:(HADashboardConfigItem *)item entity:(HAEntity *)entity {
+    NSString *cardType = item.cardType;
+    NSString *domain = [entity domain];
+
+    if ([item.customProperties[@"compact"] boolValue]) return HACellHeightStrategyCompact;
+    if ([cardType isEqualToString:@"heading"]) return HACellHeightStrategyHeading;
+    if ([cardType isEqualToString:@"markdown"]) return HACellHeightStrategyMarkdown;
+    if ([cardType isEqualToString:@"badges"]) return HACellHeightStrategyBadges;
+    if ([cardType isEqualToString:@"glance"]) return HACellHeightStrategyGlance;
+    if ([cardType isEqualToString:@"entities"]) return HACellHeightStrategyEntities;
+    if ([cardType isEqualToString:@"thermostat"]) return HACellHeightStrategyThermostat;
+    if ([cardType isEqualToString:@"gauge"]) return HACellHeightStrategyGauge;
+    if ([cardType isEqualToString:@"graph"] || [cardType isEqualToString:@"mini-graph-card"] ||
+        [cardType isEqualToString:@"history-graph"]) {
+        return HACellHeightStrategyGraph;
+    }
+    if ([cardType isEqualToString:@"calendar"]) return HACellHeightStrategyCalendar;
+    if ([cardType containsString:@"clock-weather"]) return HACellHeightStrategyClockWeather;
+    if ([domain isEqualToString:HAEntityDomainCamera]) return HACellHeightStrategyCamera;
+    if ([domain isEqualToString:HAEntityDomainVacuum]) return HACellHeightStrategyVacuum;
+    if ([domain isEqualToString:HAEntityDomainWeather]) return HACellHeightStrategyWeather;
+    if ([domain isEqualToString:HAEntityDomainAlarmControlPanel]) return HACellHeightStrategyAlarm;
+    if ([domain isEqualToString:HAEntityDomainMediaPlayer]) return HACellHeightStrategyMediaPlayer;
+    if ([cardType isEqualToString:@"tile"]) return HACellHeightStrategyTile;
+    if ([cardType isEqualToString:@"logbook"]) return HACellHeightStrategyLogbook;
+    return HACellHeightStrategyDefault;
+}
+
++ (HACellDescriptor *)descriptorForItem:(HADashboardConfigItem *)item entity:(HAEntity *)entity {
+    if (!item) return nil;
+    HACellDescriptor *descriptor = item.cellDescriptor;
+    if (descriptor && descriptor.resolvedWithEntity == (entity != nil)) return descriptor;
+
+    descriptor = [[HACellDescriptor alloc] init];
+    descriptor.reuseIdentifier = [self reuseIdentifierForEntity:entity cardType:item.cardType];
+    descriptor.cellClass = [self cellClasses][descriptor.reuseIdentifier];
+    descriptor.heightStrategy = [self heightStrategyForItem:item entity:entity];
+    descriptor.resolvedWithEntity = (entity != nil);
+
+    NSMutableOrderedSet<NSString *> *entityIds = [NSMutableOrderedSet orderedSet];
+    if (item.entityId.length > 0) [entityIds addObject:item.entityId];
+    if (item.entitiesSection.entityIds) [entityIds addObjectsFromArray:item.entitiesSection.entityIds];
+    descriptor.entityIds = entityIds.array;
+    descriptor.liveUpdating = entityIds.count > 0 &&
+                              descriptor.heightStrategy != HACellHeightStrategyHeading &&
+                              descriptor.heightStrategy != HACellHeightStrategyMarkdown;
+
+    item.cellDescriptor = descriptor;
+    return descriptor;
+}
+
 @end
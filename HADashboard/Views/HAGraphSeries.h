@@ -0,0 +1,75 @@
+#import <Foundation/Foundation.h>
+
+/// Immutable numeric series packed into two contiguous double arrays
+/// (timestamps ascending, values in the same order).
+///
+/// HAGraphView converts its NSArray<NSDictionary *> input into one of these
+/// once per data change, so layout, pinch and pan only touch plain doubles:
+/// the visible window is found by binary search and each pixel column is
+/// reduced to at most four points before a path is built.
+@interface HAGraphSeries : NSObject
+
+/// Pack points in the HAGraphView format (@"timestamp", @"value" NSNumbers).
+/// Entries that are not dictionaries or have non-finite values are dropped;
+/// input that is not sorted by timestamp is sorted.
+- (instancetype)initWithPoints:(NSArray<NSDictionary *> *)points;
+
+@property (nonatomic, assign, readonly) NSUInteger count;
+@property (nonatomic, assign, readonly) const double *timestamps;
+@property (nonatomic, assign, readonly) const double *values;
+
+/// Extents over all points. minTime > maxTime when the series is empty.
+@property (nonatomic, assign, readonly) double minTime;
+@property (nonatomic, assign, readonly) double maxTime;
+@property (nonatomic, assign, readonly) double minValue;
+@property (nonatomic, assign, readonly) double maxValue;
+
+/// Index of the first point with timestamp >= time (count if none). O(log n).
+- (NSUInteger)lowerBoundForTime:(double)time;
+
+/// Indices of the points with start <= timestamp <= end. O(log n).
+- (NSRange)indexRangeFromTime:(double)start toTime:(double)end;
+
+/// Linearly interpolated value at time, clamped to the first/last point.
+/// NAN if the series is empty. O(log n).
+- (double)valueAtTime:(double)time;
+
+/// Min/max/first/last decimation of range into `columns` equal-width time
+/// buckets spanning start...end. Writes the surviving indices, ascending and
+/// unique, to `indices` (which must hold +maxDecimatedCountForColumns:) and
+/// returns how many were written. Every bucket keeps its extremes, so the
+/// drawn envelope and the Y range match the undecimated data.
+- (NSUInteger)decimateRange:(NSRange)range
+                   fromTime:(double)start
+                     toTime:(double)end
+                    columns:(NSUInteger)columns
+                intoIndices:(NSUInteger *)indices;
+
++ (NSUInteger)maxDecimatedCountForColumns:(NSUInteger)columns;
+
+@end
+
+/// One entity's state timeline as an interval table: segment start/end
+/// times in contiguous arrays (ascending by start) plus the state of each.
+/// Built once per timelineData change so hit-testing the crosshair is a
+/// binary search instead of a scan over NSDictionary segments.
+@interface HAGraphTimelineTrack : NSObject
+
+/// Segments in the HAGraphView timeline format (@"state", @"start", @"end").
+/// Malformed entries are dropped; input not ordered by start is sorted.
+- (instancetype)initWithSegments:(NSArray<NSDictionary *> *)segments;
+
+@property (nonatomic, assign, readonly) NSUInteger count;
+@property (nonatomic, assign, readonly) const double *starts;
+@property (nonatomic, assign, readonly) const double *ends;
+@property (nonatomic, copy, readonly) NSArray<NSString *> *states;
+
+/// Earliest start / latest end. minTime > maxTime when empty.
+@property (nonatomic, assign, readonly) double minTime;
+@property (nonatomic, assign, readonly) double maxTime;
+
+/// Index of the segment containing time (start <= time <= end), or
+/// NSNotFound. When segments touch, the later one wins. O(log n).
+- (NSUInteger)indexOfSegmentAtTime:(double)time;
+
+@end
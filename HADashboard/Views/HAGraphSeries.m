@@ -0,0 +1,292 @@
+#import "HAGraphSeries.h"
+
+@interface HAGraphSeries ()
+@property (nonatomic, strong) NSData *timestampData;
+@property (nonatomic, strong) NSData *valueData;
+@end
+
+@implementation HAGraphSeries
+
+- (instancetype)initWithPoints:(NSArray<NSDictionary *> *)points {
+    self = [super init];
+    if (self) {
+        NSUInteger capacity = points.count;
+        NSMutableData *timestampData = [NSMutableData dataWithLength:capacity * sizeof(double)];
+        NSMutableData *valueData = [NSMutableData dataWithLength:capacity * sizeof(double)];
+        double *ts = timestampData.mutableBytes;
+        double *vs = valueData.mutableBytes;
+
+        NSUInteger n = 0;
+        BOOL sorted = YES;
+        for (NSDictionary *pt in points) {
+            if (![pt isKindOfClass:[NSDictionary class]]) continue;
+            id tObj = pt[@"timestamp"];
+            id vObj = pt[@"value"];
+            if (![tObj isKindOfClass:[NSNumber class]] || ![vObj isKindOfClass:[NSNumber class]]) continue;
+            double t = [tObj doubleValue];
+            double v = [vObj doubleValue];
+            if (!isfinite(t) || !isfinite(v)) continue;
+            if (n > 0 && t < ts[n - 1]) sorted = NO;
+            ts[n] = t;
+            vs[n] = v;
+            n++;
+        }
+
+        if (!sorted) {
+            [self sortTimestamps:ts values:vs count:n];
+        }
+
+        timestampData.length = n * sizeof(double);
+        valueData.length = n * sizeof(double);
+        _timestampData = timestampData;
+        _valueData = valueData;
+        _count = n;
+
+        _minTime = HUGE_VAL;
+        _maxTime = -HUGE_VAL;
+        _minValue = HUGE_VAL;
+        _maxValue = -HUGE_VAL;
+        if (n > 0) {
+            _minTime = ts[0];
+            _maxTime = ts[n - 1];
+            for (NSUInteger i = 0; i < n; i++) {
+                if (vs[i] < _minValue) _minValue = vs[i];
+                if (vs[i] > _maxValue) _maxValue = vs[i];
+            }
+        }
+    }
+    return self;
+}
+
+/// Stable sort of the parallel arrays by timestamp. Only hit for malformed
+/// input; history responses are already in time order.
+- (void)sortTimestamps:(double *)ts values:(double *)vs count:(NSUInteger)n {
+    NSMutableData *orderData = [NSMutableData dataWithLength:n * sizeof(NSUInteger)];
+    NSUInteger *order = orderData.mutableBytes;
+    for (NSUInteger i = 0; i < n; i++) order[i] = i;
+    // Insertion sort on indices: input is nearly sorted in practice
+    for (NSUInteger i = 1; i < n; i++) {
+        NSUInteger idx = order[i];
+        NSUInteger j = i;
+        while (j > 0 && ts[order[j - 1]] > ts[idx]) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = idx;
+    }
+    NSData *tsCopy = [NSData dataWithBytes:ts length:n * sizeof(double)];
+    NSData *vsCopy = [NSData dataWithBytes:vs length:n * sizeof(double)];
+    const double *tsOld = tsCopy.bytes;
+    const double *vsOld = vsCopy.bytes;
+    for (NSUInteger i = 0; i < n; i++) {
+        ts[i] = tsOld[order[i]];
+        vs[i] = vsOld[order[i]];
+    }
+}
+
+- (const double *)timestamps {
+    return self.timestampData.bytes;
+}
+
+- (const double *)values {
+    return self.valueData.bytes;
+}
+
+#pragma mark - Search
+
+- (NSUInteger)lowerBoundForTime:(double)time {
+    const double *ts = self.timestamps;
+    NSUInteger lo = 0, hi = self.count;
+    while (lo < hi) {
+        NSUInteger mid = lo + (hi - lo) / 2;
+        if (ts[mid] < time) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+/// Index of the first point with timestamp > time (count if none).
+- (NSUInteger)upperBoundForTime:(double)time {
+    const double *ts = self.timestamps;
+    NSUInteger lo = 0, hi = self.count;
+    while (lo < hi) {
+        NSUInteger mid = lo + (hi - lo) / 2;
+        if (ts[mid] <= time) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+- (NSRange)indexRangeFromTime:(double)start toTime:(double)end {
+    if (self.count == 0 || end < start) return NSMakeRange(0, 0);
+    NSUInteger first = [self lowerBoundForTime:start];
+    NSUInteger last = [self upperBoundForTime:end];
+    if (last <= first) return NSMakeRange(first, 0);
+    return NSMakeRange(first, last - first);
+}
+
+- (double)valueAtTime:(double)time {
+    NSUInteger n = self.count;
+    if (n == 0) return NAN;
+    const double *ts = self.timestamps;
+    const double *vs = self.values;
+    if (n == 1 || time <= ts[0]) return vs[0];
+    if (time >= ts[n - 1]) return vs[n - 1];
+
+    NSUInteger next = [self lowerBoundForTime:time]; // 1...n-1 given the checks above
+    NSUInteger prev = next - 1;
+    double t0 = ts[prev], t1 = ts[next];
+    if (t1 - t0 < 0.001) return vs[prev];
+    double frac = (time - t0) / (t1 - t0);
+    return vs[prev] + frac * (vs[next] - vs[prev]);
+}
+
+#pragma mark - Decimation
+
++ (NSUInteger)maxDecimatedCountForColumns:(NSUInteger)columns {
+    return MAX(columns, 1) * 4;
+}
+
+/// Append the bucket's first/min/max/last in index order, skipping repeats.
+static NSUInteger HAGraphSeriesEmitBucket(NSUInteger *out, NSUInteger n,
+                                          NSUInteger first, NSUInteger minI,
+                                          NSUInteger maxI, NSUInteger last) {
+    NSUInteger picks[4] = {first, minI, maxI, last};
+    // Sort the four (first <= min,max <= last already; only min/max may swap)
+    if (picks[1] > picks[2]) {
+        NSUInteger tmp = picks[1];
+        picks[1] = picks[2];
+        picks[2] = tmp;
+    }
+    for (NSUInteger k = 0; k < 4; k++) {
+        if (n > 0 && out[n - 1] == picks[k]) continue;
+        out[n++] = picks[k];
+    }
+    return n;
+}
+
+- (NSUInteger)decimateRange:(NSRange)range
+                   fromTime:(double)start
+                     toTime:(double)end
+                    columns:(NSUInteger)columns
+                intoIndices:(NSUInteger *)indices {
+    if (range.length == 0 || !indices) return 0;
+    if (NSMaxRange(range) > self.count) return 0;
+    columns = MAX(columns, 1);
+
+    const double *ts = self.timestamps;
+    const double *vs = self.values;
+    double span = end - start;
+    if (span <= 0) span = 1.0;
+    double colsPerSecond = (double)columns / span;
+
+    NSUInteger n = 0;
+    NSInteger bucket = -1;
+    NSUInteger first = 0, last = 0, minI = 0, maxI = 0;
+
+    for (NSUInteger i = range.location; i < NSMaxRange(range); i++) {
+        NSInteger col = (NSInteger)((ts[i] - start) * colsPerSecond);
+        if (col < 0) col = 0;
+        if (col >= (NSInteger)columns) col = (NSInteger)columns - 1;
+
+        if (col != bucket) {
+            if (bucket >= 0) {
+                n = HAGraphSeriesEmitBucket(indices, n, first, minI, maxI, last);
+            }
+            bucket = col;
+            first = last = minI = maxI = i;
+        } else {
+            last = i;
+            if (vs[i] < vs[minI]) minI = i;
+            if (vs[i] > vs[maxI]) maxI = i;
+        }
+    }
+    if (bucket >= 0) {
+        n = HAGraphSeriesEmitBucket(indices, n, first, minI, maxI, last);
+    }
+    return n;
+}
+
+@end
+
+#pragma mark -
+
+@interface HAGraphTimelineTrack ()
+@property (nonatomic, strong) NSData *startData;
+@property (nonatomic, strong) NSData *endData;
+@property (nonatomic, copy, readwrite) NSArray<NSString *> *states;
+@end
+
+@implementation HAGraphTimelineTrack
+
+- (instancetype)initWithSegments:(NSArray<NSDictionary *> *)segments {
+    self = [super init];
+    if (self) {
+        NSMutableArray<NSDictionary *> *valid = [NSMutableArray arrayWithCapacity:segments.count];
+        BOOL sorted = YES;
+        double lastStart = -HUGE_VAL;
+        for (NSDictionary *seg in segments) {
+            if (![seg isKindOfClass:[NSDictionary class]]) continue;
+            if (![seg[@"start"] isKindOfClass:[NSNumber class]] || ![seg[@"end"] isKindOfClass:[NSNumber class]]) continue;
+            double start = [seg[@"start"] doubleValue];
+            if (start < lastStart) sorted = NO;
+            lastStart = start;
+            [valid addObject:seg];
+        }
+        if (!sorted) {
+            [valid sortWithOptions:NSSortStable usingComparator:^NSComparisonResult(NSDictionary *a, NSDictionary *b) {
+                return [a[@"start"] compare:b[@"start"]];
+            }];
+        }
+
+        NSUInteger n = valid.count;
+        NSMutableData *startData = [NSMutableData dataWithLength:n * sizeof(double)];
+        NSMutableData *endData = [NSMutableData dataWithLength:n * sizeof(double)];
+        double *starts = startData.mutableBytes;
+        double *ends = endData.mutableBytes;
+        NSMutableArray<NSString *> *states = [NSMutableArray arrayWithCapacity:n];
+
+        _minTime = HUGE_VAL;
+        _maxTime = -HUGE_VAL;
+        for (NSUInteger i = 0; i < n; i++) {
+            NSDictionary *seg = valid[i];
+            starts[i] = [seg[@"start"] doubleValue];
+            ends[i] = MAX([seg[@"end"] doubleValue], starts[i]);
+            NSString *state = seg[@"state"];
+            [states addObject:[state isKindOfClass:[NSString class]] ? state : @""];
+            if (starts[i] < _minTime) _minTime = starts[i];
+            if (ends[i] > _maxTime) _maxTime = ends[i];
+        }
+
+        _startData = startData;
+        _endData = endData;
+        _states = [states copy];
+        _count = n;
+    }
+    return self;
+}
+
+- (const double *)starts {
+    return self.startData.bytes;
+}
+
+- (const double *)ends {
+    return self.endData.bytes;
+}
+
+- (NSUInteger)indexOfSegmentAtTime:(double)time {
+    const double *starts = self.starts;
+    const double *ends = self.ends;
+    // Last segment with start <= time
+    NSUInteger lo = 0, hi = self.count;
+    while (lo < hi) {
+        NSUInteger mid = lo + (hi - lo) / 2;
+        if (starts[mid] <= time) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo == 0) return NSNotFound;
+    NSUInteger idx = lo - 1;
+    return (time <= ends[idx]) ? idx : NSNotFound;
+}
+
+@end
@@ -1,4 +1,5 @@
 #import "HAGraphView.h"
+#import "HAGraphSeries.h"
 #import "HATheme.h"
 #import <sys/utsname.h>
 
@@ -26,6 +27,8 @@ static NSDateFormatter *sCachedTimeFmt(void) {
 // State timeline rendering
 @property (nonatomic, strong) NSMutableArray<CALayer *> *timelineLayers; // Bar segment layers
 @property (nonatomic, strong) NSMutableArray<UILabel *> *timelineLabels; // Entity name labels
+@property (nonatomic, copy) NSArray<HAGraphTimelineTrack *> *timelineTracks; // Interval tables, parallel to timelineData
+@property (nonatomic, assign) CGFloat timelineLabelWidth; // Widest entity label, measured once per data change
 // Axis labels
 @property (nonatomic, strong) NSMutableArray<UILabel *> *timeAxisLabels;
 @property (nonatomic, strong) NSMutableArray<UILabel *> *valueAxisLabels;
@@ -34,6 +37,13 @@ static NSDateFormatter *sCachedTimeFmt(void) {
 @property (nonatomic, assign) double currentMaxVal;
 @property (nonatomic, assign) NSTimeInterval currentMinTime;
 @property (nonatomic, assign) NSTimeInterval currentMaxTime;
+// Window actually drawn (zoom window clamped to the data, or the full extent)
+@property (nonatomic, assign) NSTimeInterval displayStartTime;
+@property (nonatomic, assign) NSTimeInterval displayEndTime;
+// Packed copies of dataPoints / dataSeries[i][@"points"], rebuilt on set
+@property (nonatomic, strong) HAGraphSeries *packedPoints;
+@property (nonatomic, copy) NSArray<HAGraphSeries *> *packedSeries;
+@property (nonatomic, strong) NSMutableData *decimationBuffer;
 // Multi-axis Y scaling by unit: groups[i] = @{@"unit":NSString, @"indices":NSIndexSet, @"yMin":NSNumber, @"yMax":NSNumber}
 @property (nonatomic, strong) NSArray<NSDictionary *> *axisGroups;
 @property (nonatomic, strong) NSMutableDictionary<NSNumber *, NSNumber *> *seriesIndexToGroupIndex; // series idx -> group idx
@@ -238,7 +248,10 @@ static NSDateFormatter *sCachedTimeFmt(void) {
 - (void)setDataPoints:(NSArray<NSDictionary *> *)points animated:(BOOL)animated {
     _dataPoints = [points copy];
     _dataSeries = nil;
+    self.packedPoints = [[HAGraphSeries alloc] initWithPoints:_dataPoints];
+    self.packedSeries = nil;
     _timelineData = nil;
+    self.timelineTracks = nil;
     [self clearTimelineLayers];
     self.gradientLayer.hidden = NO;
     [self rebuildLayers];
@@ -248,7 +261,10 @@ static NSDateFormatter *sCachedTimeFmt(void) {
 - (void)setDataPoints:(NSArray<NSDictionary *> *)dataPoints {
     _dataPoints = [dataPoints copy];
     _dataSeries = nil;
+    self.packedPoints = [[HAGraphSeries alloc] initWithPoints:_dataPoints];
+    self.packedSeries = nil;
     _timelineData = nil;
+    self.timelineTracks = nil;
     [self clearTimelineLayers];
     self.gradientLayer.hidden = NO;
     [self rebuildLayers];
@@ -260,7 +276,15 @@ static NSDateFormatter *sCachedTimeFmt(void) {
 - (void)setDataSeries:(NSArray<NSDictionary *> *)dataSeries {
     _dataSeries = [dataSeries copy];
     _dataPoints = nil;
+    NSMutableArray<HAGraphSeries *> *packed = [NSMutableArray arrayWithCapacity:_dataSeries.count];
+    for (NSDictionary *series in _dataSeries) {
+        NSArray *points = series[@"points"];
+        [packed addObject:[[HAGraphSeries alloc] initWithPoints:[points isKindOfClass:[NSArray class]] ? points : nil]];
+    }
+    self.packedSeries = packed;
+    self.packedPoints = nil;
     _timelineData = nil;
+    self.timelineTracks = nil;
     [self clearTimelineLayers];
     self.gradientLayer.hidden = NO;
     [self computeAxisGroups];
@@ -331,6 +355,21 @@ static NSDateFormatter *sCachedTimeFmt(void) {
     _timelineData = [timelineData copy];
     _dataPoints = nil;
     _dataSeries = nil;
+    self.packedPoints = nil;
+    self.packedSeries = nil;
+
+    NSMutableArray<HAGraphTimelineTrack *> *tracks = [NSMutableArray arrayWithCapacity:_timelineData.count];
+    UIFont *labelFont = [UIFont systemFontOfSize:11 weight:UIFontWeightMedium];
+    CGFloat labelWidth = 0;
+    for (NSDictionary *entity in _timelineData) {
+        NSArray *segments = entity[@"segments"];
+        [tracks addObject:[[HAGraphTimelineTrack alloc] initWithSegments:[segments isKindOfClass:[NSArray class]] ? segments : nil]];
+        NSString *label = entity[@"label"] ?: @"";
+        CGSize sz = [label sizeWithAttributes:@{NSFontAttributeName: labelFont}];
+        if (sz.width > labelWidth) labelWidth = sz.width;
+    }
+    self.timelineTracks = tracks;
+    self.timelineLabelWidth = labelWidth;
     // Only destroy line graph layers when switching TO timeline mode (not when clearing)
     if (timelineData.count > 0) {
         for (CAShapeLayer *layer in self.lineLayers) {
@@ -414,47 +453,46 @@ static NSDateFormatter *sCachedTimeFmt(void) {
     return [UIColor colorWithRed:0.50 green:0.50 blue:0.60 alpha:1.0];
 }
 
+/// Bar area for timeline rows: label column on the left, bars to the right.
+/// Shared by bar layout, time axis labels and inspection.
+- (void)getTimelineBarAreaX:(CGFloat *)barAreaX width:(CGFloat *)barAreaW {
+    CGFloat w = self.bounds.size.width;
+    CGFloat labelWidth = self.timelineLabelWidth;
+    // Clamp label width
+    if (labelWidth > w * 0.35) labelWidth = w * 0.35;
+    if (labelWidth < 30) labelWidth = 30;
+
+    CGFloat x = labelWidth + 6.0 + 8.0; // label pad + 8pt left margin for labels
+    CGFloat width = w - x - 4.0;        // 4pt right margin
+    if (width < 20) width = 20;
+    *barAreaX = x;
+    *barAreaW = width;
+}
+
 - (void)updateTimelineBars {
-    if (!self.timelineData || self.timelineData.count == 0) return;
+    if (self.timelineTracks.count == 0) return;
     if (CGRectIsEmpty(self.bounds)) return;
 
     CGFloat bottomPad = [self graphAreaBottomPadding];
-    CGFloat w = self.bounds.size.width;
     CGFloat h = self.bounds.size.height - bottomPad;
-    NSUInteger entityCount = self.timelineData.count;
+    NSUInteger entityCount = self.timelineTracks.count;
 
     // Layout: label area on left, bars on right
-    CGFloat labelWidth = 0; // Will compute from longest label
     CGFloat barHeight = 22.0;
     CGFloat verticalGap = 4.0;
     CGFloat topPad = 4.0;
-    CGFloat labelPad = 6.0; // Gap between label and bar
-
-    // Compute label width from longest entity name
     UIFont *labelFont = [UIFont systemFontOfSize:11 weight:UIFontWeightMedium];
-    for (NSDictionary *entity in self.timelineData) {
-        NSString *label = entity[@"label"] ?: @"";
-        CGSize sz = [label sizeWithAttributes:@{NSFontAttributeName: labelFont}];
-        if (sz.width > labelWidth) labelWidth = sz.width;
-    }
-    // Clamp label width
-    if (labelWidth > w * 0.35) labelWidth = w * 0.35;
-    if (labelWidth < 30) labelWidth = 30;
 
-    CGFloat barAreaX = labelWidth + labelPad + 8; // 8pt left margin for labels
-    CGFloat barAreaW = w - barAreaX - 4; // 4pt right margin
-    if (barAreaW < 20) barAreaW = 20;
+    CGFloat barAreaX, barAreaW;
+    [self getTimelineBarAreaX:&barAreaX width:&barAreaW];
+    CGFloat labelWidth = barAreaX - 6.0 - 8.0;
 
-    // Compute global time range across all entity timelines
+    // Global time range across all entity timelines (O(1) per track)
     double minTime = HUGE_VAL, maxTime = -HUGE_VAL;
-    for (NSDictionary *entity in self.timelineData) {
-        NSArray *segments = entity[@"segments"];
-        for (NSDictionary *seg in segments) {
-            double start = [seg[@"start"] doubleValue];
-            double end = [seg[@"end"] doubleValue];
-            if (start < minTime) minTime = start;
-            if (end > maxTime) maxTime = end;
-        }
+    for (HAGraphTimelineTrack *track in self.timelineTracks) {
+        if (track.count == 0) continue;
+        if (track.minTime < minTime) minTime = track.minTime;
+        if (track.maxTime > maxTime) maxTime = track.maxTime;
     }
     double timeRange = maxTime - minTime;
     if (timeRange < 1.0) timeRange = 1.0;
@@ -462,6 +500,8 @@ static NSDateFormatter *sCachedTimeFmt(void) {
     // Store for Phase 4 tooltip hit-testing and axis labels
     self.currentMinTime = minTime;
     self.currentMaxTime = maxTime;
+    self.displayStartTime = minTime;
+    self.displayEndTime = maxTime;
     self.currentMinVal = 0;
     self.currentMaxVal = 0;
 
@@ -474,9 +514,9 @@ static NSDateFormatter *sCachedTimeFmt(void) {
     // Draw each entity's timeline
     for (NSUInteger i = 0; i < entityCount; i++) {
         NSDictionary *entity = self.timelineData[i];
+        HAGraphTimelineTrack *track = self.timelineTracks[i];
         NSString *label = entity[@"label"] ?: @"";
         NSString *entityId = entity[@"entityId"] ?: @"";
-        NSArray *segments = entity[@"segments"];
 
         CGFloat y = topPad + i * (barHeight + verticalGap);
 
@@ -490,7 +530,8 @@ static NSDateFormatter *sCachedTimeFmt(void) {
         [self addSubview:lbl];
         [self.timelineLabels addObject:lbl];
 
-        // Background bar (full track, very dim)
+        // Background bar (full track, very dim). Its rounded mask also rounds
+        // the outer ends of the first and last segments.
         CALayer *bgBar = [CALayer layer];
         bgBar.frame = CGRectMake(barAreaX, y, barAreaW, barHeight);
         bgBar.backgroundColor = [UIColor colorWithWhite:0.18 alpha:1.0].CGColor;
@@ -499,34 +540,57 @@ static NSDateFormatter *sCachedTimeFmt(void) {
         [self.layer addSublayer:bgBar];
         [self.timelineLayers addObject:bgBar];
 
-        // Segment bars
-        for (NSDictionary *seg in segments) {
-            double start = [seg[@"start"] doubleValue];
-            double end = [seg[@"end"] doubleValue];
-            NSString *state = seg[@"state"];
-
-            CGFloat segX = (CGFloat)((start - minTime) / timeRange) * barAreaW;
-            CGFloat segEndX = (CGFloat)((end - minTime) / timeRange) * barAreaW;
-            CGFloat segW = segEndX - segX;
-            if (segW < 0.5) segW = 0.5; // Minimum visible width
-
-            UIColor *color = [HAGraphView colorForState:state entityId:entityId];
-
-            CALayer *segLayer = [CALayer layer];
-            segLayer.frame = CGRectMake(barAreaX + segX, y, segW, barHeight);
-            segLayer.backgroundColor = color.CGColor;
-            // Round corners only on first/last segments
-            if (segX <= 0.5) {
-                segLayer.cornerRadius = 3.0;
-                segLayer.maskedCorners = kCALayerMinXMinYCorner | kCALayerMinXMaxYCorner;
+        // Segment bars: one shape layer per distinct color instead of one
+        // layer per segment. Consecutive segments of the same color are
+        // drawn as a single rect.
+        NSMutableDictionary<NSString *, UIColor *> *stateColors = [NSMutableDictionary dictionary];
+        NSMutableArray<UIColor *> *colors = [NSMutableArray array];
+        NSMutableArray<UIBezierPath *> *paths = [NSMutableArray array];
+        const double *starts = track.starts;
+        const double *ends = track.ends;
+        NSArray<NSString *> *states = track.states;
+
+        NSUInteger runColorIndex = NSNotFound;
+        CGFloat runStartX = 0, runEndX = 0;
+        for (NSUInteger s = 0; s <= track.count; s++) {
+            NSUInteger colorIndex = NSNotFound;
+            CGFloat segX = 0, segEndX = 0;
+            if (s < track.count) {
+                NSString *state = states[s];
+                UIColor *color = stateColors[state];
+                if (!color) {
+                    color = [HAGraphView colorForState:state entityId:entityId];
+                    stateColors[state] = color;
+                }
+                colorIndex = [colors indexOfObject:color];
+                if (colorIndex == NSNotFound) {
+                    [colors addObject:color];
+                    [paths addObject:[UIBezierPath bezierPath]];
+                    colorIndex = colors.count - 1;
+                }
+                segX = (CGFloat)((starts[s] - minTime) / timeRange) * barAreaW;
+                segEndX = (CGFloat)((ends[s] - minTime) / timeRange) * barAreaW;
+                if (colorIndex == runColorIndex) {
+                    runEndX = MAX(runEndX, segEndX);
+                    continue;
+                }
             }
-            if (segEndX >= barAreaW - 0.5) {
-                segLayer.cornerRadius = 3.0;
-                segLayer.maskedCorners |= kCALayerMaxXMinYCorner | kCALayerMaxXMaxYCorner;
+            // Flush the finished run
+            if (runColorIndex != NSNotFound) {
+                CGFloat runW = MAX(runEndX - runStartX, 0.5); // Minimum visible width
+                [paths[runColorIndex] appendPath:[UIBezierPath bezierPathWithRect:CGRectMake(runStartX, 0, runW, barHeight)]];
             }
-            segLayer.masksToBounds = YES;
-            [self.layer addSublayer:segLayer];
-            [self.timelineLayers addObject:segLayer];
+            runColorIndex = colorIndex;
+            runStartX = segX;
+            runEndX = segEndX;
+        }
+
+        for (NSUInteger c = 0; c < colors.count; c++) {
+            CAShapeLayer *segLayer = [CAShapeLayer layer];
+            segLayer.frame = bgBar.bounds;
+            segLayer.fillColor = colors[c].CGColor;
+            segLayer.path = paths[c].CGPath;
+            [bgBar addSublayer:segLayer];
         }
     }
 
@@ -715,6 +779,58 @@ static NSDateFormatter *sCachedTimeFmt(void) {
 
 #pragma mark - Path rendering
 
+/// One series reduced to what is drawn in the displayed window: decimated
+/// point indices plus interpolated values where the line crosses the window
+/// edges (NAN when the data doesn't extend past that edge).
+typedef struct {
+    const NSUInteger *indices;
+    NSUInteger count;
+    double headValue;
+    double tailValue;
+    double minVal;
+    double maxVal;
+} HAGraphPlot;
+
+/// Data space -> view space for one axis group.
+typedef struct {
+    double minTime;
+    double timeRange;
+    double minVal;
+    double valRange;
+    CGFloat left;
+    CGFloat width;
+    CGFloat top;
+    CGFloat height;
+} HAGraphMapping;
+
+static inline CGPoint HAGraphMapPoint(HAGraphMapping m, double t, double v) {
+    return CGPointMake(m.left + (CGFloat)((t - m.minTime) / m.timeRange) * m.width,
+                       m.top + m.height - (CGFloat)((v - m.minVal) / m.valRange) * m.height);
+}
+
+typedef struct {
+    CGMutablePathRef line;
+    CGMutablePathRef fill; // NULL when no gradient fill is drawn
+    CGFloat fillBottom;
+    BOOL first;
+    CGPoint lastPoint;
+} HAGraphPathBuilder;
+
+static inline void HAGraphPathAddPoint(HAGraphPathBuilder *b, CGPoint p) {
+    if (b->first) {
+        CGPathMoveToPoint(b->line, NULL, p.x, p.y);
+        if (b->fill) {
+            CGPathMoveToPoint(b->fill, NULL, p.x, b->fillBottom);
+            CGPathAddLineToPoint(b->fill, NULL, p.x, p.y);
+        }
+        b->first = NO;
+    } else {
+        CGPathAddLineToPoint(b->line, NULL, p.x, p.y);
+        if (b->fill) CGPathAddLineToPoint(b->fill, NULL, p.x, p.y);
+    }
+    b->lastPoint = p;
+}
+
 - (void)updatePaths {
     if (CGRectIsEmpty(self.bounds)) return;
 
@@ -725,12 +841,122 @@ static NSDateFormatter *sCachedTimeFmt(void) {
     }
 }
 
+/// Redraw after a pinch/pan moved the visible window. Only the paths are
+/// rebuilt; layer geometry is unchanged, so implicit path animations are
+/// suppressed to keep the line glued to the finger.
+- (void)updatePathsForViewportChange {
+    [CATransaction begin];
+    [CATransaction setDisableActions:YES];
+    [self updatePaths];
+    [CATransaction commit];
+}
+
+/// The time window being drawn: the zoom window when one is set and overlaps
+/// the data, otherwise the full data extent.
+- (void)getDisplayedStartTime:(double *)start endTime:(double *)end dataMin:(double)dataMin dataMax:(double)dataMax {
+    double s = dataMin, e = dataMax;
+    if (self.visibleEndTime > self.visibleStartTime && self.visibleStartTime > 0) {
+        double vs = MAX(self.visibleStartTime, dataMin);
+        double ve = MIN(self.visibleEndTime, dataMax);
+        if (ve > vs) {
+            s = vs;
+            e = ve;
+        }
+    }
+    *start = s;
+    *end = e;
+}
+
+/// Pixel columns across the plot area; each keeps at most four points.
+- (NSUInteger)decimationColumnsForWidth:(CGFloat)width {
+    CGFloat scale = self.contentScaleFactor > 0 ? self.contentScaleFactor : 1.0;
+    return MAX((NSUInteger)1, (NSUInteger)ceil(width * scale));
+}
+
+/// Scratch index storage for `seriesCount` plots, reused across frames.
+- (NSUInteger *)decimationBufferForSeriesCount:(NSUInteger)seriesCount columns:(NSUInteger)columns {
+    NSUInteger needed = MAX(seriesCount, (NSUInteger)1) * [HAGraphSeries maxDecimatedCountForColumns:columns] * sizeof(NSUInteger);
+    if (!self.decimationBuffer) {
+        self.decimationBuffer = [NSMutableData dataWithLength:needed];
+    } else if (self.decimationBuffer.length < needed) {
+        self.decimationBuffer.length = needed;
+    }
+    return self.decimationBuffer.mutableBytes;
+}
+
+- (HAGraphPlot)plotForSeries:(HAGraphSeries *)series
+                    fromTime:(double)start
+                      toTime:(double)end
+                     columns:(NSUInteger)columns
+                      buffer:(NSUInteger *)buffer {
+    HAGraphPlot plot = { buffer, 0, NAN, NAN, HUGE_VAL, -HUGE_VAL };
+    if (series.count == 0) return plot;
+
+    NSRange range = [series indexRangeFromTime:start toTime:end];
+    plot.count = [series decimateRange:range fromTime:start toTime:end columns:columns intoIndices:buffer];
+
+    // Lines entering/leaving a zoomed window are cut exactly at the edge
+    if (series.minTime < start && series.maxTime > start) plot.headValue = [series valueAtTime:start];
+    if (series.maxTime > end && series.minTime < end) plot.tailValue = [series valueAtTime:end];
+
+    const double *vs = series.values;
+    for (NSUInteger k = 0; k < plot.count; k++) {
+        double v = vs[buffer[k]];
+        if (v < plot.minVal) plot.minVal = v;
+        if (v > plot.maxVal) plot.maxVal = v;
+    }
+    if (!isnan(plot.headValue)) {
+        plot.minVal = MIN(plot.minVal, plot.headValue);
+        plot.maxVal = MAX(plot.maxVal, plot.headValue);
+    }
+    if (!isnan(plot.tailValue)) {
+        plot.minVal = MIN(plot.minVal, plot.tailValue);
+        plot.maxVal = MAX(plot.maxVal, plot.tailValue);
+    }
+    return plot;
+}
+
+static inline NSUInteger HAGraphPlotPointCount(HAGraphPlot plot) {
+    return plot.count + (isnan(plot.headValue) ? 0 : 1) + (isnan(plot.tailValue) ? 0 : 1);
+}
+
+/// Build the stroke path (and, if fillPath is non-NULL, the closed fill area)
+/// for a plot. Returns NO if there are fewer than two points to draw.
+- (BOOL)appendPlot:(HAGraphPlot)plot
+            series:(HAGraphSeries *)series
+          fromTime:(double)start
+            toTime:(double)end
+           mapping:(HAGraphMapping)mapping
+        fillBottom:(CGFloat)fillBottom
+            toLine:(CGMutablePathRef)linePath
+              fill:(CGMutablePathRef)fillPath {
+    if (HAGraphPlotPointCount(plot) < 2) return NO;
+
+    const double *ts = series.timestamps;
+    const double *vs = series.values;
+    HAGraphPathBuilder builder = { linePath, fillPath, fillBottom, YES, CGPointZero };
+
+    if (!isnan(plot.headValue)) HAGraphPathAddPoint(&builder, HAGraphMapPoint(mapping, start, plot.headValue));
+    for (NSUInteger k = 0; k < plot.count; k++) {
+        NSUInteger i = plot.indices[k];
+        HAGraphPathAddPoint(&builder, HAGraphMapPoint(mapping, ts[i], vs[i]));
+    }
+    if (!isnan(plot.tailValue)) HAGraphPathAddPoint(&builder, HAGraphMapPoint(mapping, end, plot.tailValue));
+
+    if (fillPath) {
+        CGPathAddLineToPoint(fillPath, NULL, builder.lastPoint.x, fillBottom);
+        CGPathCloseSubpath(fillPath);
+    }
+    return YES;
+}
+
 - (void)updateSingleSeriesPath {
     // Ensure we have exactly one line layer
     if (self.lineLayers.count == 0) return;
     CAShapeLayer *lineLayer = self.lineLayers.firstObject;
+    HAGraphSeries *series = self.packedPoints;
 
-    if (self.dataPoints.count < 2) {
+    if (series.count < 2) {
         lineLayer.path = nil;
         self.fillMaskLayer.path = nil;
         return;
@@ -744,19 +970,35 @@ static NSDateFormatter *sCachedTimeFmt(void) {
         (id)[fill colorWithAlphaComponent:0.05].CGColor
     ];
 
-    // Compute min/max for Y scaling
-    double minVal = HUGE_VAL, maxVal = -HUGE_VAL;
-    double minTime = HUGE_VAL, maxTime = -HUGE_VAL;
-    for (NSDictionary *pt in self.dataPoints) {
-        double v = [pt[@"value"] doubleValue];
-        double t = [pt[@"timestamp"] doubleValue];
-        if (v < minVal) minVal = v;
-        if (v > maxVal) maxVal = v;
-        if (t < minTime) minTime = t;
-        if (t > maxTime) maxTime = t;
+    CGFloat leftPad = [self graphAreaLeftPadding];
+    CGFloat rightPad = [self graphAreaRightPadding];
+    CGFloat bottomPad = [self graphAreaBottomPadding];
+    CGFloat w = self.bounds.size.width - leftPad - rightPad;
+    CGFloat h = self.bounds.size.height;
+    CGFloat insetY = 2.0;
+    CGFloat drawH = h - insetY * 2 - bottomPad;
+    CGFloat fillBottom = h - bottomPad;
+
+    // Full extent drives gesture clamping; the displayed window drives drawing
+    self.currentMinTime = series.minTime;
+    self.currentMaxTime = series.maxTime;
+    double startTime, endTime;
+    [self getDisplayedStartTime:&startTime endTime:&endTime dataMin:series.minTime dataMax:series.maxTime];
+    self.displayStartTime = startTime;
+    self.displayEndTime = endTime;
+
+    NSUInteger columns = [self decimationColumnsForWidth:w];
+    NSUInteger *buffer = [self decimationBufferForSeriesCount:1 columns:columns];
+    HAGraphPlot plot = [self plotForSeries:series fromTime:startTime toTime:endTime columns:columns buffer:buffer];
+    if (HAGraphPlotPointCount(plot) < 2) {
+        lineLayer.path = nil;
+        self.fillMaskLayer.path = nil;
+        [self updateAxisLabels];
+        return;
     }
 
     // Add 10% padding to Y range
+    double minVal = plot.minVal, maxVal = plot.maxVal;
     double yRange = maxVal - minVal;
     if (yRange < 0.001) yRange = 1.0;
     double yPad = yRange * 0.1;
@@ -764,91 +1006,102 @@ static NSDateFormatter *sCachedTimeFmt(void) {
     maxVal += yPad;
     yRange = maxVal - minVal;
 
-    double xRange = maxTime - minTime;
+    double xRange = endTime - startTime;
     if (xRange < 1.0) xRange = 1.0;
 
     // Store for Phase 4 tooltip hit-testing and axis labels
     self.currentMinVal = minVal;
     self.currentMaxVal = maxVal;
+
+    HAGraphMapping mapping = { startTime, xRange, minVal, yRange, leftPad, w, insetY, drawH };
+    CGMutablePathRef linePath = CGPathCreateMutable();
+    CGMutablePathRef fillPath = self.lightweight ? NULL : CGPathCreateMutable();
+    [self appendPlot:plot series:series fromTime:startTime toTime:endTime mapping:mapping
+          fillBottom:fillBottom toLine:linePath fill:fillPath];
+
+    lineLayer.path = linePath;
+    CGPathRelease(linePath);
+
+    if (fillPath) {
+        self.fillMaskLayer.path = fillPath;
+        CGPathRelease(fillPath);
+    }
+
+    [self updateAxisLabels];
+}
+
+- (void)updateMultiSeriesPaths {
+    if (self.dataSeries.count == 0 || self.lineLayers.count == 0) return;
+    NSUInteger seriesCount = MIN(self.packedSeries.count, self.lineLayers.count);
+
+    // Time extent across visible series (O(1) per series from the packed extents)
+    double minTime = HUGE_VAL, maxTime = -HUGE_VAL;
+    for (NSUInteger i = 0; i < seriesCount; i++) {
+        if ([self.hiddenSeriesIndices containsIndex:i]) continue;
+        HAGraphSeries *series = self.packedSeries[i];
+        if (series.count == 0) continue;
+        if (series.minTime < minTime) minTime = series.minTime;
+        if (series.maxTime > maxTime) maxTime = series.maxTime;
+    }
+
+    if (minTime > maxTime) {
+        // No valid data
+        for (CAShapeLayer *layer in self.lineLayers) {
+            layer.path = nil;
+        }
+        self.fillMaskLayer.path = nil;
+        return;
+    }
+
     self.currentMinTime = minTime;
     self.currentMaxTime = maxTime;
+    double startTime, endTime;
+    [self getDisplayedStartTime:&startTime endTime:&endTime dataMin:minTime dataMax:maxTime];
+    self.displayStartTime = startTime;
+    self.displayEndTime = endTime;
+
+    double xRange = endTime - startTime;
+    if (xRange < 1.0) xRange = 1.0;
 
     CGFloat leftPad = [self graphAreaLeftPadding];
     CGFloat rightPad = [self graphAreaRightPadding];
     CGFloat bottomPad = [self graphAreaBottomPadding];
     CGFloat w = self.bounds.size.width - leftPad - rightPad;
     CGFloat h = self.bounds.size.height;
+    CGFloat legendH = [self currentLegendHeight];
     CGFloat insetY = 2.0;
-    CGFloat drawH = h - insetY * 2 - bottomPad;
-    CGFloat fillBottom = h - bottomPad;
-
-    // Build line path
-    UIBezierPath *linePath = [UIBezierPath bezierPath];
-    UIBezierPath *fillPath = self.lightweight ? nil : [UIBezierPath bezierPath];
-
-    BOOL first = YES;
-    CGPoint lastPoint = CGPointZero;
-    for (NSDictionary *pt in self.dataPoints) {
-        double v = [pt[@"value"] doubleValue];
-        double t = [pt[@"timestamp"] doubleValue];
-        CGFloat x = leftPad + (CGFloat)((t - minTime) / xRange) * w;
-        CGFloat y = insetY + drawH - (CGFloat)((v - minVal) / yRange) * drawH;
-        CGPoint p = CGPointMake(x, y);
-
-        if (first) {
-            [linePath moveToPoint:p];
-            [fillPath moveToPoint:CGPointMake(x, fillBottom)];
-            [fillPath addLineToPoint:p];
-            first = NO;
-        } else {
-            [linePath addLineToPoint:p];
-            [fillPath addLineToPoint:p];
-        }
-        lastPoint = p;
-    }
-
-    lineLayer.path = linePath.CGPath;
+    CGFloat drawH = h - insetY * 2 - legendH - bottomPad;
+    if (drawH < 10) drawH = 10;
+    CGFloat fillBottom = h - legendH - bottomPad;
 
-    if (!self.lightweight) {
-        [fillPath addLineToPoint:CGPointMake(lastPoint.x, fillBottom)];
-        [fillPath closePath];
-        self.fillMaskLayer.path = fillPath.CGPath;
+    // Cull + decimate every visible series once; Y ranges come from the result
+    NSUInteger columns = [self decimationColumnsForWidth:w];
+    NSUInteger *buffer = [self decimationBufferForSeriesCount:seriesCount columns:columns];
+    NSUInteger stride = [HAGraphSeries maxDecimatedCountForColumns:columns];
+    HAGraphPlot *plots = calloc(MAX(seriesCount, (NSUInteger)1), sizeof(HAGraphPlot));
+    for (NSUInteger i = 0; i < seriesCount; i++) {
+        plots[i] = (HAGraphPlot){ buffer + i * stride, 0, NAN, NAN, HUGE_VAL, -HUGE_VAL };
+        if ([self.hiddenSeriesIndices containsIndex:i]) continue;
+        plots[i] = [self plotForSeries:self.packedSeries[i] fromTime:startTime toTime:endTime
+                               columns:columns buffer:buffer + i * stride];
     }
 
-    [self updateAxisLabels];
-}
-
-- (void)updateMultiSeriesPaths {
-    if (self.dataSeries.count == 0 || self.lineLayers.count == 0) return;
-
     // Compute per-group min/max ranges (skipping hidden series)
     NSMutableArray<NSMutableDictionary *> *mutableGroups = [NSMutableArray array];
     for (NSDictionary *group in self.axisGroups) {
         [mutableGroups addObject:[group mutableCopy]];
     }
 
-    __block double minTime = HUGE_VAL, maxTime = -HUGE_VAL;
-
     for (NSUInteger gi = 0; gi < mutableGroups.count; gi++) {
         NSMutableDictionary *group = mutableGroups[gi];
         NSIndexSet *indices = group[@"indices"];
-        __block double gMin = HUGE_VAL, gMax = -HUGE_VAL;
+        double gMin = HUGE_VAL, gMax = -HUGE_VAL;
 
-        [indices enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
-            // Skip hidden series
-            if ([self.hiddenSeriesIndices containsIndex:idx]) return;
-
-            NSDictionary *series = self.dataSeries[idx];
-            NSArray *points = series[@"points"];
-            for (NSDictionary *pt in points) {
-                double v = [pt[@"value"] doubleValue];
-                double t = [pt[@"timestamp"] doubleValue];
-                if (v < gMin) gMin = v;
-                if (v > gMax) gMax = v;
-                if (t < minTime) minTime = t;
-                if (t > maxTime) maxTime = t;
-            }
-        }];
+        for (NSUInteger idx = indices.firstIndex; idx != NSNotFound; idx = [indices indexGreaterThanIndex:idx]) {
+            if (idx >= seriesCount) continue;
+            if (plots[idx].minVal < gMin) gMin = plots[idx].minVal;
+            if (plots[idx].maxVal > gMax) gMax = plots[idx].maxVal;
+        }
 
         // Add 10% padding to Y range for this group
         if (gMin <= gMax) {
@@ -879,50 +1132,21 @@ static NSDateFormatter *sCachedTimeFmt(void) {
         self.currentMaxVal = 1.0;
     }
 
-    if (minTime > maxTime) {
-        // No valid data
-        for (CAShapeLayer *layer in self.lineLayers) {
-            layer.path = nil;
-        }
-        self.fillMaskLayer.path = nil;
-        return;
-    }
-
-    double xRange = maxTime - minTime;
-    if (xRange < 1.0) xRange = 1.0;
-
-    self.currentMinTime = minTime;
-    self.currentMaxTime = maxTime;
-
-    CGFloat leftPad = [self graphAreaLeftPadding];
-    CGFloat rightPad = [self graphAreaRightPadding];
-    CGFloat bottomPad = [self graphAreaBottomPadding];
-    CGFloat w = self.bounds.size.width - leftPad - rightPad;
-    CGFloat h = self.bounds.size.height;
-    CGFloat legendH = [self currentLegendHeight];
-    CGFloat insetY = 2.0;
-    CGFloat drawH = h - insetY * 2 - legendH - bottomPad;
-    if (drawH < 10) drawH = 10;
-    CGFloat fillBottom = h - legendH - bottomPad;
-
     // Render each series
-    for (NSUInteger i = 0; i < self.dataSeries.count && i < self.lineLayers.count; i++) {
-        NSDictionary *series = self.dataSeries[i];
-        NSArray *points = series[@"points"];
-        UIColor *color = series[@"color"] ?: self.lineColor;
+    BOOL fillAssigned = NO;
+    for (NSUInteger i = 0; i < self.lineLayers.count; i++) {
         CAShapeLayer *lineLayer = self.lineLayers[i];
-        lineLayer.strokeColor = color.CGColor;
-
-        // Skip hidden series — clear their paths
-        if ([self.hiddenSeriesIndices containsIndex:i]) {
+        if (i >= seriesCount) {
             lineLayer.path = nil;
-            if (i == 0) self.fillMaskLayer.path = nil;
             continue;
         }
+        NSDictionary *series = self.dataSeries[i];
+        UIColor *color = series[@"color"] ?: self.lineColor;
+        lineLayer.strokeColor = color.CGColor;
 
-        if (points.count < 2) {
+        // Skip hidden series — clear their paths
+        if ([self.hiddenSeriesIndices containsIndex:i] || HAGraphPlotPointCount(plots[i]) < 2) {
             lineLayer.path = nil;
-            if (i == 0) self.fillMaskLayer.path = nil;
             continue;
         }
 
@@ -935,9 +1159,7 @@ static NSDateFormatter *sCachedTimeFmt(void) {
         double seriesYRange = seriesMaxVal - seriesMinVal;
         if (seriesYRange < 0.001) seriesYRange = 1.0;
 
-        UIBezierPath *linePath = [UIBezierPath bezierPath];
         // Gradient fill only for first VISIBLE series, non-lightweight
-        // Check if this is the first visible series (not just i == 0)
         BOOL isFirstVisible = YES;
         for (NSUInteger j = 0; j < i; j++) {
             if (![self.hiddenSeriesIndices containsIndex:j]) {
@@ -945,43 +1167,32 @@ static NSDateFormatter *sCachedTimeFmt(void) {
                 break;
             }
         }
-        UIBezierPath *fillPath = (isFirstVisible && !self.lightweight) ? [UIBezierPath bezierPath] : nil;
-
-        BOOL first = YES;
-        CGPoint lastPoint = CGPointZero;
-        for (NSDictionary *pt in points) {
-            double v = [pt[@"value"] doubleValue];
-            double t = [pt[@"timestamp"] doubleValue];
-            CGFloat x = leftPad + (CGFloat)((t - minTime) / xRange) * w;
-            CGFloat y = insetY + drawH - (CGFloat)((v - seriesMinVal) / seriesYRange) * drawH;
-            CGPoint p = CGPointMake(x, y);
-
-            if (first) {
-                [linePath moveToPoint:p];
-                [fillPath moveToPoint:CGPointMake(x, fillBottom)];
-                [fillPath addLineToPoint:p];
-                first = NO;
-            } else {
-                [linePath addLineToPoint:p];
-                [fillPath addLineToPoint:p];
-            }
-            lastPoint = p;
-        }
+        BOOL wantsFill = isFirstVisible && !self.lightweight;
 
-        lineLayer.path = linePath.CGPath;
+        HAGraphMapping mapping = { startTime, xRange, seriesMinVal, seriesYRange, leftPad, w, insetY, drawH };
+        CGMutablePathRef linePath = CGPathCreateMutable();
+        CGMutablePathRef fillPath = wantsFill ? CGPathCreateMutable() : NULL;
+        [self appendPlot:plots[i] series:self.packedSeries[i] fromTime:startTime toTime:endTime
+                 mapping:mapping fillBottom:fillBottom toLine:linePath fill:fillPath];
 
-        if (isFirstVisible && !self.lightweight) {
+        lineLayer.path = linePath;
+        CGPathRelease(linePath);
+
+        if (fillPath) {
             // Update gradient for first visible series color
             UIColor *fill = [color colorWithAlphaComponent:0.3];
             self.gradientLayer.colors = @[
                 (id)[fill colorWithAlphaComponent:0.5].CGColor,
                 (id)[fill colorWithAlphaComponent:0.05].CGColor
             ];
-            [fillPath addLineToPoint:CGPointMake(lastPoint.x, fillBottom)];
-            [fillPath closePath];
-            self.fillMaskLayer.path = fillPath.CGPath;
+            self.fillMaskLayer.path = fillPath;
+            CGPathRelease(fillPath);
+            fillAssigned = YES;
         }
     }
+    free(plots);
+
+    if (!fillAssigned) self.fillMaskLayer.path = nil;
 
     [self updateAxisLabels];
 }
@@ -1009,8 +1220,8 @@ static NSDateFormatter *sCachedTimeFmt(void) {
     UIColor *axisColor = [HATheme tertiaryTextColor];
     BOOL isTimeline = (self.timelineData.count > 0);
 
-    double minTime = self.currentMinTime;
-    double maxTime = self.currentMaxTime;
+    double minTime = self.displayStartTime;
+    double maxTime = self.displayEndTime;
     double timeRange = maxTime - minTime;
     if (timeRange < 1.0) return; // No meaningful range to label
 
@@ -1126,22 +1337,8 @@ static NSDateFormatter *sCachedTimeFmt(void) {
     CGFloat timeAreaX = leftPad;
     CGFloat timeAreaW = drawW;
     if (isTimeline) {
-        // Recompute barAreaX/W for timeline to align time labels with bars
-        CGFloat labelWidth = 0;
-        UIFont *labelFont = [UIFont systemFontOfSize:11 weight:UIFontWeightMedium];
-        for (NSDictionary *entity in self.timelineData) {
-            NSString *label = entity[@"label"] ?: @"";
-            CGSize sz = [label sizeWithAttributes:@{NSFontAttributeName: labelFont}];
-            if (sz.width > labelWidth) labelWidth = sz.width;
-        }
-        CGFloat w = self.bounds.size.width;
-        if (labelWidth > w * 0.35) labelWidth = w * 0.35;
-        if (labelWidth < 30) labelWidth = 30;
-        CGFloat barAreaX = labelWidth + 6.0 + 8.0;
-        CGFloat barAreaW = w - barAreaX - 4.0;
-        if (barAreaW < 20) barAreaW = 20;
-        timeAreaX = barAreaX;
-        timeAreaW = barAreaW;
+        // Align time labels with the bars
+        [self getTimelineBarAreaX:&timeAreaX width:&timeAreaW];
     }
 
     // Choose time format based on total range
@@ -1206,7 +1403,7 @@ static NSDateFormatter *sCachedTimeFmt(void) {
         CGFloat fraction = (drawW > 0) ? (x - leftPad) / drawW : 0;
         fraction = MAX(0.0, MIN(1.0, fraction));
 
-        NSTimeInterval timestamp = self.currentMinTime + fraction * (self.currentMaxTime - self.currentMinTime);
+        NSTimeInterval timestamp = self.displayStartTime + fraction * (self.displayEndTime - self.displayStartTime);
 
         // Position crosshair
         self.crosshairLine.hidden = NO;
@@ -1223,16 +1420,11 @@ static NSDateFormatter *sCachedTimeFmt(void) {
 
         if (self.timelineData.count > 0) {
             // Timeline mode: find segment at timestamp
-            NSDictionary *firstEntity = self.timelineData.firstObject;
-            NSArray *segments = firstEntity[@"segments"];
-            for (NSDictionary *seg in segments) {
-                NSTimeInterval segStart = [seg[@"start"] doubleValue];
-                NSTimeInterval segEnd = [seg[@"end"] doubleValue];
-                if (timestamp >= segStart && timestamp <= segEnd) {
-                    stateText = seg[@"state"];
-                    duration = segEnd - segStart;
-                    break;
-                }
+            HAGraphTimelineTrack *track = self.timelineTracks.firstObject;
+            NSUInteger segIndex = [track indexOfSegmentAtTime:timestamp];
+            if (segIndex != NSNotFound) {
+                stateText = track.states[segIndex];
+                duration = track.ends[segIndex] - track.starts[segIndex];
             }
             if (stateText) {
                 // Format duration
@@ -1257,14 +1449,14 @@ static NSDateFormatter *sCachedTimeFmt(void) {
                 if ([self.hiddenSeriesIndices containsIndex:i]) continue;
 
                 NSDictionary *series = self.dataSeries[i];
-                NSArray *points = series[@"points"];
+                HAGraphSeries *packed = (i < self.packedSeries.count) ? self.packedSeries[i] : nil;
                 UIColor *color = series[@"color"] ?: [UIColor whiteColor];
                 NSString *label = series[@"label"] ?: @"";
                 NSString *unit = series[@"unit"] ?: @"";
 
-                if (points.count == 0) continue;
+                if (packed.count == 0) continue;
 
-                double val = [self interpolateValueAtTimestamp:timestamp fromPoints:points];
+                double val = [packed valueAtTime:timestamp];
                 NSString *valStr = [NSString stringWithFormat:@"%.1f", val];
                 if (unit.length > 0) {
                     valStr = [NSString stringWithFormat:@"%@ %@", valStr, unit];
@@ -1315,24 +1507,9 @@ static NSDateFormatter *sCachedTimeFmt(void) {
             self.tooltipView.frame = CGRectMake(tooltipX, tooltipY, tooltipW, tooltipH);
         } else {
             // Single-series: backward compatible display
-            NSArray *points = self.dataPoints;
-            if (self.dataSeries.count > 0) {
-                // Use first VISIBLE series
-                NSUInteger visibleIndex = NSNotFound;
-                for (NSUInteger i = 0; i < self.dataSeries.count; i++) {
-                    if (![self.hiddenSeriesIndices containsIndex:i]) {
-                        visibleIndex = i;
-                        break;
-                    }
-                }
-                if (visibleIndex != NSNotFound) {
-                    points = self.dataSeries[visibleIndex][@"points"];
-                } else {
-                    points = nil; // All series hidden (shouldn't happen, but defensive)
-                }
-            }
-            if (points.count > 0) {
-                value = [self interpolateValueAtTimestamp:timestamp fromPoints:points];
+            HAGraphSeries *packed = [self inspectedSeries];
+            if (packed.count > 0) {
+                value = [packed valueAtTime:timestamp];
                 valueText = [NSString stringWithFormat:@"%.1f", value];
             } else {
                 valueText = @"\u2014";
@@ -1353,7 +1530,7 @@ static NSDateFormatter *sCachedTimeFmt(void) {
 
         // Format time
         NSDateFormatter *timeFmt = sCachedTimeFmt();
-        NSTimeInterval totalRange = self.currentMaxTime - self.currentMinTime;
+        NSTimeInterval totalRange = self.displayEndTime - self.displayStartTime;
         if (totalRange < 86400) {
             timeFmt.dateFormat = @"HH:mm:ss";
         } else {
@@ -1385,33 +1562,14 @@ static NSDateFormatter *sCachedTimeFmt(void) {
     }
 }
 
-- (double)interpolateValueAtTimestamp:(NSTimeInterval)timestamp fromPoints:(NSArray<NSDictionary *> *)points {
-    if (points.count == 0) return NAN;
-    if (points.count == 1) return [points[0][@"value"] doubleValue];
-
-    // Binary search for bracketing points
-    NSDictionary *prev = points.firstObject;
-    NSDictionary *next = points.lastObject;
-
-    for (NSUInteger i = 0; i < points.count - 1; i++) {
-        NSTimeInterval t0 = [points[i][@"timestamp"] doubleValue];
-        NSTimeInterval t1 = [points[i + 1][@"timestamp"] doubleValue];
-        if (timestamp >= t0 && timestamp <= t1) {
-            prev = points[i];
-            next = points[i + 1];
-            break;
-        }
+/// Series shown in the single-value tooltip: the first visible series, or
+/// the plain data points when no series are set.
+- (HAGraphSeries *)inspectedSeries {
+    if (self.dataSeries.count == 0) return self.packedPoints;
+    for (NSUInteger i = 0; i < self.packedSeries.count; i++) {
+        if (![self.hiddenSeriesIndices containsIndex:i]) return self.packedSeries[i];
     }
-
-    double t0 = [prev[@"timestamp"] doubleValue];
-    double t1 = [next[@"timestamp"] doubleValue];
-    double v0 = [prev[@"value"] doubleValue];
-    double v1 = [next[@"value"] doubleValue];
-
-    if (fabs(t1 - t0) < 0.001) return v0;
-    double frac = (timestamp - t0) / (t1 - t0);
-    frac = MAX(0.0, MIN(1.0, frac));
-    return v0 + frac * (v1 - v0);
+    return nil; // All series hidden (shouldn't happen, but defensive)
 }
 
 #pragma mark - Pinch-to-Zoom
@@ -1438,8 +1596,7 @@ static NSDateFormatter *sCachedTimeFmt(void) {
         self.visibleEndTime = newEnd;
         NSTimeInterval fullRange = self.currentMaxTime - self.currentMinTime;
         _zoomScale = (fullRange > 0) ? (CGFloat)(fullRange / (newEnd - newStart)) : 1.0;
-        [self setNeedsLayout];
-        [self layoutIfNeeded];
+        [self updatePathsForViewportChange];
     } else if (gesture.state == UIGestureRecognizerStateEnded) {
         NSTimeInterval fullRange = self.currentMaxTime - self.currentMinTime;
         NSTimeInterval visRange = self.visibleEndTime - self.visibleStartTime;
@@ -1467,7 +1624,7 @@ static NSDateFormatter *sCachedTimeFmt(void) {
             CGFloat x = MAX(leftPad, MIN(point.x, w - rightPad));
             CGFloat fraction = (drawW > 0) ? (x - leftPad) / drawW : 0;
             fraction = MAX(0.0, MIN(1.0, fraction));
-            NSTimeInterval timestamp = self.currentMinTime + fraction * (self.currentMaxTime - self.currentMinTime);
+            NSTimeInterval timestamp = self.displayStartTime + fraction * (self.displayEndTime - self.displayStartTime);
 
             self.crosshairLine.hidden = NO;
             [CATransaction begin];
@@ -1485,14 +1642,14 @@ static NSDateFormatter *sCachedTimeFmt(void) {
                     if ([self.hiddenSeriesIndices containsIndex:i]) continue;
 
                     NSDictionary *series = self.dataSeries[i];
-                    NSArray *points = series[@"points"];
+                    HAGraphSeries *packed = (i < self.packedSeries.count) ? self.packedSeries[i] : nil;
                     UIColor *color = series[@"color"] ?: [UIColor whiteColor];
                     NSString *label = series[@"label"] ?: @"";
                     NSString *unit = series[@"unit"] ?: @"";
 
-                    if (points.count == 0) continue;
+                    if (packed.count == 0) continue;
 
-                    double val = [self interpolateValueAtTimestamp:timestamp fromPoints:points];
+                    double val = [packed valueAtTime:timestamp];
                     NSString *valStr = [NSString stringWithFormat:@"%.1f", val];
                     if (unit.length > 0) {
                         valStr = [NSString stringWithFormat:@"%@ %@", valStr, unit];
@@ -1537,25 +1694,10 @@ static NSDateFormatter *sCachedTimeFmt(void) {
                 self.tooltipView.frame = CGRectMake(tooltipX, MAX(2, point.y - tooltipH - 10), tooltipW, tooltipH);
             } else {
                 // Single-series: backward compatible display
-                NSArray *points = self.dataPoints;
-                if (self.dataSeries.count > 0) {
-                    // Use first VISIBLE series
-                    NSUInteger visibleIndex = NSNotFound;
-                    for (NSUInteger i = 0; i < self.dataSeries.count; i++) {
-                        if (![self.hiddenSeriesIndices containsIndex:i]) {
-                            visibleIndex = i;
-                            break;
-                        }
-                    }
-                    if (visibleIndex != NSNotFound) {
-                        points = self.dataSeries[visibleIndex][@"points"];
-                    } else {
-                        points = nil;
-                    }
-                }
+                HAGraphSeries *packed = [self inspectedSeries];
                 NSString *valueText = @"\u2014";
-                if (points.count > 0) {
-                    double val = [self interpolateValueAtTimestamp:timestamp fromPoints:points];
+                if (packed.count > 0) {
+                    double val = [packed valueAtTime:timestamp];
                     valueText = [NSString stringWithFormat:@"%.1f", val];
                 }
 
@@ -1567,7 +1709,7 @@ static NSDateFormatter *sCachedTimeFmt(void) {
             }
 
             NSDateFormatter *timeFmt = sCachedTimeFmt();
-            timeFmt.dateFormat = (self.currentMaxTime - self.currentMinTime < 86400) ? @"HH:mm:ss" : @"MMM d, HH:mm";
+            timeFmt.dateFormat = (self.displayEndTime - self.displayStartTime < 86400) ? @"HH:mm:ss" : @"MMM d, HH:mm";
             self.tooltipTimeLabel.text = [timeFmt stringFromDate:[NSDate dateWithTimeIntervalSince1970:timestamp]];
             self.tooltipView.hidden = NO;
         } else if (gesture.state == UIGestureRecognizerStateEnded || gesture.state == UIGestureRecognizerStateCancelled) {
@@ -1597,8 +1739,7 @@ static NSDateFormatter *sCachedTimeFmt(void) {
             newEnd = MIN(newEnd, self.currentMaxTime);
             self.visibleStartTime = newStart;
             self.visibleEndTime = newEnd;
-            [self setNeedsLayout];
-            [self layoutIfNeeded];
+            [self updatePathsForViewportChange];
         } else if (gesture.state == UIGestureRecognizerStateEnded) {
             if ([self.delegate respondsToSelector:@selector(graphView:didZoomToStartTime:endTime:)]) {
                 [self.delegate graphView:self didZoomToStartTime:self.visibleStartTime endTime:self.visibleEndTime];
@@ -1615,8 +1756,7 @@ static NSDateFormatter *sCachedTimeFmt(void) {
     self.visibleStartTime = 0;
     self.visibleEndTime = 0;
     _zoomScale = 1.0;
-    [self setNeedsLayout];
-    [self layoutIfNeeded];
+    [self updatePathsForViewportChange];
     if ([self.delegate respondsToSelector:@selector(graphView:didZoomToStartTime:endTime:)]) {
         [self.delegate graphView:self didZoomToStartTime:self.currentMinTime endTime:self.currentMaxTime];
     }
@@ -1,4 +1,5 @@
 #import "HAMasonryLayout.h"
+#import "HAPerfMonitor.h"
 
 /// HA masonry spacing constants (matching hui-masonry-view.ts)
 static const CGFloat kContainerPaddingTop = 4.0;
@@ -69,6 +70,7 @@ static const CGFloat kMaxColumnWidth = 500.0;
 #pragma mark - Layout
 
 - (void)prepareLayout {
+    HAPerfScopedSpan(HAPerfCategoryLayout, "layout.prepare", "HAMasonryLayout");
     [super prepareLayout];
 
     [self.itemAttributes removeAllObjects];
@@ -1,4 +1,5 @@
 #import "HAPanelLayout.h"
+#import "HAPerfMonitor.h"
 
 @interface HAPanelLayout ()
 @property (nonatomic, strong) UICollectionViewLayoutAttributes *panelAttributes;
@@ -8,6 +9,7 @@
 @implementation HAPanelLayout
 
 - (void)prepareLayout {
+    HAPerfScopedSpan(HAPerfCategoryLayout, "layout.prepare", "HAPanelLayout");
     [super prepareLayout];
 
     self.panelAttributes = nil;
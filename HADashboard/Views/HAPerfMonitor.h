@@ -1,9 +1,57 @@
 #import <Foundation/Foundation.h>
 
+#pragma mark - Tracing
+
+/// Trace event categories (the "cat" field in the exported trace).
+typedef NS_ENUM(uint8_t, HAPerfCategory) {
+    HAPerfCategoryNetwork = 0,  // WebSocket message ingest
+    HAPerfCategoryParse,        // JSON decode
+    HAPerfCategoryEntity,       // entity state apply
+    HAPerfCategoryRebuild,      // dashboard rebuild / visible cell refresh
+    HAPerfCategoryLayout,       // collection view layout passes
+    HAPerfCategoryCell,         // cell configure
+    HAPerfCategoryImage,        // image decode
+    HAPerfCategoryLog,          // synchronous log writes
+    HAPerfCategoryApp,          // everything else
+};
+
+/// Open span returned by HAPerfSpanBegin. A plain value, so spans can nest,
+/// overlap, and end on a different thread than they began on.
+typedef struct {
+    uint64_t spanId;        // 0 if tracing was off at begin; End is then a no-op
+    uint64_t startTime;     // mach_absolute_time
+    const char *name;
+    const char *detail;
+    uint32_t threadId;
+    HAPerfCategory category;
+} HAPerfSpan;
+
+/// Span, instant and counter events are recorded into a per-thread ring
+/// buffer while the monitor is running and cost a single flag check while it
+/// is not. Names and details are stored by pointer, so they must live for the
+/// whole process: string literals, class_getName(), sel_getName().
+FOUNDATION_EXPORT HAPerfSpan HAPerfSpanBegin(HAPerfCategory category, const char *name, const char *detail);
+
+/// Close a span. Returns its duration in ms (0 if it was not recorded).
+FOUNDATION_EXPORT double HAPerfSpanEnd(HAPerfSpan span);
+
+FOUNDATION_EXPORT void HAPerfInstant(HAPerfCategory category, const char *name, const char *detail);
+FOUNDATION_EXPORT void HAPerfCounter(const char *name, double value);
+
+static inline void HAPerfSpanEndScoped(HAPerfSpan *span) { HAPerfSpanEnd(*span); }
+
+/// Span covering the rest of the enclosing scope, early returns included.
+/// One per scope.
+#define HAPerfScopedSpan(category, name, detail) \
+    __attribute__((cleanup(HAPerfSpanEndScoped), unused)) HAPerfSpan _perfScopedSpan = HAPerfSpanBegin(category, name, detail)
+
+#pragma mark -
+
 /// Lightweight performance monitor that logs FPS, memory, and timing data to a CSV file.
 /// Designed for minimal overhead on iPad 2 (A5, 512MB).
 ///
 /// Log file: /tmp/perf.log (jailbroken) or Documents/perf.log (sandboxed).
+/// Trace file: trace.json in the same directory (see -writeTraceWithCompletion:).
 /// Pull via SCP or Xcode organizer.
 @interface HAPerfMonitor : NSObject
 
@@ -15,12 +63,24 @@
 /// Stop collecting and write final flush.
 - (void)stop;
 
-/// Bracket rebuildDashboard calls.
+/// While running, frames longer than 1.5x the refresh interval are counted
+/// as hitches and attributed to the main-thread spans that overlapped them;
+/// each CSV line carries the hitch count and the top causes.
+@property (nonatomic, assign, readonly, getter=isRunning) BOOL running;
+
+/// Bracket rebuildDashboard calls. Recorded as "rebuild" spans; may nest.
 - (void)markRebuildStart;
 - (void)markRebuildEnd;
 
-/// Bracket cell configuration calls. Pass the cell class name.
-- (void)markCellStart:(NSString *)cellType;
+/// Bracket cell configuration calls. Recorded as "cell.configure" spans
+/// with the class name as detail; may nest.
+- (void)markCellStart:(Class)cellClass;
 - (void)markCellEnd;
 
+/// Write the events recorded since -start as Chrome trace-event JSON
+/// (load in chrome://tracing or Perfetto) next to the CSV log. The snapshot
+/// is taken immediately; formatting and I/O happen off the main thread.
+/// Completion runs on the main queue with the file path, or nil on failure.
+- (void)writeTraceWithCompletion:(void (^)(NSString *path))completion;
+
 @end
@@ -2,8 +2,12 @@
 #import "HALog.h"
 #import <QuartzCore/QuartzCore.h>
 #import <mach/mach.h>
+#import <mach/mach_time.h>
 #import <sys/utsname.h>
 #import <UIKit/UIKit.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <objc/runtime.h>
 
 // Ring buffer size — 120 frames ≈ 2s at 60fps or 4s at 30fps
 #define kFrameRingSize 120
@@ -11,6 +15,248 @@
 // Flush interval in seconds
 static const NSTimeInterval kFlushInterval = 10.0;
 
+// Max nesting tracked by the markRebuild/markCell brackets
+#define kSpanStackDepth 8
+
+// A frame counts as a hitch when it takes this many refresh intervals
+static const double kHitchThreshold = 1.5;
+
+// Distinct causes tracked per flush window; later ones fold into "other"
+#define kHitchCauseSlots 32
+
+// Causes listed per CSV line
+static const NSUInteger kHitchCausesReported = 5;
+
+/// Histogram bucket: one (name, detail) span kind and the hitches it overlapped.
+typedef struct {
+    const char *name;
+    const char *detail;
+    NSUInteger hitches;
+    double overlapMs;       // summed overlap with hitched frames
+    NSUInteger lastHitch;   // hitch serial that last credited this cause
+} HAHitchCause;
+
+#pragma mark - Trace Buffers
+
+// Events per thread buffer: ~56 bytes each, so 2048 ≈ 112KB per thread
+// (1024 on iPad 2 class devices). Oldest events are overwritten.
+static uint32_t _traceBufferCapacity = 2048;
+
+static const char *_categoryNames[] = {
+    "network", "parse", "entity", "rebuild", "layout", "cell", "image", "log", "app",
+};
+
+typedef struct {
+    uint64_t start;          // mach_absolute_time
+    uint64_t duration;       // mach units; 0 for instant / counter
+    const char *name;
+    const char *detail;
+    double value;            // counter value
+    uint64_t spanId;
+    uint32_t threadId;       // thread the span began on
+    uint32_t endThreadId;    // differs from threadId for cross-thread spans
+    char phase;              // 'X' span, 'i' instant, 'C' counter
+    uint8_t category;
+} HAPerfEvent;
+
+// One per thread, created on first event and recycled when its thread
+// exits. Only the owning thread writes; the exporter copies concurrently
+// and discards anything the writer may have lapped during the copy.
+typedef struct HAPerfThreadBuffer {
+    struct HAPerfThreadBuffer *next;
+    atomic_uint_fast64_t writeIndex;
+    atomic_bool inUse;
+    uint32_t capacity;
+    uint32_t threadId;
+    BOOL isMain;
+    HAPerfEvent events[];
+} HAPerfThreadBuffer;
+
+static atomic_bool _tracingEnabled;
+static atomic_uint_fast64_t _nextSpanId = 1;
+static uint64_t _traceEpoch = 0;     // mach time of -start; earlier events aren't exported
+static mach_timebase_info_data_t _traceTimebase;
+static pthread_mutex_t _traceBuffersLock = PTHREAD_MUTEX_INITIALIZER;
+static HAPerfThreadBuffer *_traceBuffers = NULL;   // guarded by _traceBuffersLock
+static pthread_key_t _traceBufferKey;
+
+static void HAPerfThreadBufferRelease(void *ptr) {
+    HAPerfThreadBuffer *buffer = ptr;
+    atomic_store_explicit(&buffer->inUse, false, memory_order_release);
+}
+
+static HAPerfThreadBuffer *HAPerfCurrentThreadBuffer(void) {
+    HAPerfThreadBuffer *buffer = pthread_getspecific(_traceBufferKey);
+    if (buffer) return buffer;
+
+    pthread_mutex_lock(&_traceBuffersLock);
+    for (HAPerfThreadBuffer *b = _traceBuffers; b; b = b->next) {
+        if (!atomic_load_explicit(&b->inUse, memory_order_acquire)) {
+            buffer = b;
+            break;
+        }
+    }
+    if (!buffer) {
+        buffer = calloc(1, sizeof(HAPerfThreadBuffer) + _traceBufferCapacity * sizeof(HAPerfEvent));
+        if (buffer) {
+            buffer->capacity = _traceBufferCapacity;
+            buffer->next = _traceBuffers;
+            _traceBuffers = buffer;
+        }
+    }
+    if (buffer) {
+        buffer->threadId = pthread_mach_thread_np(pthread_self());
+        buffer->isMain = pthread_main_np() != 0;
+        atomic_store_explicit(&buffer->inUse, true, memory_order_release);
+    }
+    pthread_mutex_unlock(&_traceBuffersLock);
+
+    if (buffer) pthread_setspecific(_traceBufferKey, buffer);
+    return buffer;
+}
+
+static void HAPerfRecord(const HAPerfEvent *event) {
+    HAPerfThreadBuffer *buffer = HAPerfCurrentThreadBuffer();
+    if (!buffer) return;
+    uint64_t index = atomic_load_explicit(&buffer->writeIndex, memory_order_relaxed);
+    buffer->events[index % buffer->capacity] = *event;
+    atomic_store_explicit(&buffer->writeIndex, index + 1, memory_order_release);
+}
+
+static inline uint32_t HAPerfCurrentThreadId(void) {
+    return pthread_mach_thread_np(pthread_self());
+}
+
+HAPerfSpan HAPerfSpanBegin(HAPerfCategory category, const char *name, const char *detail) {
+    HAPerfSpan span = {0};
+    if (!atomic_load_explicit(&_tracingEnabled, memory_order_relaxed)) return span;
+    span.spanId = atomic_fetch_add_explicit(&_nextSpanId, 1, memory_order_relaxed);
+    span.startTime = mach_absolute_time();
+    span.name = name;
+    span.detail = detail;
+    span.threadId = HAPerfCurrentThreadId();
+    span.category = category;
+    return span;
+}
+
+double HAPerfSpanEnd(HAPerfSpan span) {
+    if (span.spanId == 0) return 0;
+    uint64_t now = mach_absolute_time();
+    uint64_t duration = now - span.startTime;
+    // Spans that straddle -stop are dropped, but the caller still gets its timing
+    if (atomic_load_explicit(&_tracingEnabled, memory_order_relaxed)) {
+        HAPerfEvent event = {
+            .start = span.startTime,
+            .duration = duration,
+            .name = span.name,
+            .detail = span.detail,
+            .spanId = span.spanId,
+            .threadId = span.threadId,
+            .endThreadId = HAPerfCurrentThreadId(),
+            .phase = 'X',
+            .category = span.category,
+        };
+        HAPerfRecord(&event);
+    }
+    return (double)duration * _traceTimebase.numer / _traceTimebase.denom / 1e6;
+}
+
+void HAPerfInstant(HAPerfCategory category, const char *name, const char *detail) {
+    if (!atomic_load_explicit(&_tracingEnabled, memory_order_relaxed)) return;
+    uint32_t tid = HAPerfCurrentThreadId();
+    HAPerfEvent event = {
+        .start = mach_absolute_time(),
+        .name = name,
+        .detail = detail,
+        .threadId = tid,
+        .endThreadId = tid,
+        .phase = 'i',
+        .category = category,
+    };
+    HAPerfRecord(&event);
+}
+
+void HAPerfCounter(const char *name, double value) {
+    if (!atomic_load_explicit(&_tracingEnabled, memory_order_relaxed)) return;
+    uint32_t tid = HAPerfCurrentThreadId();
+    HAPerfEvent event = {
+        .start = mach_absolute_time(),
+        .name = name,
+        .value = value,
+        .threadId = tid,
+        .endThreadId = tid,
+        .phase = 'C',
+        .category = HAPerfCategoryApp,
+    };
+    HAPerfRecord(&event);
+}
+
+/// Copy every exportable event out of the thread buffers.
+static NSData *HAPerfSnapshotEvents(uint64_t since, NSMutableDictionary<NSNumber *, NSString *> *threadNames) {
+    NSMutableData *out = [NSMutableData data];
+    pthread_mutex_lock(&_traceBuffersLock);
+    for (HAPerfThreadBuffer *b = _traceBuffers; b; b = b->next) {
+        if (b->isMain) threadNames[@(b->threadId)] = @"main";
+        uint64_t end = atomic_load_explicit(&b->writeIndex, memory_order_acquire);
+        uint64_t begin = (end > b->capacity) ? end - b->capacity : 0;
+        NSUInteger offset = out.length;
+        for (uint64_t i = begin; i < end; i++) {
+            HAPerfEvent event = b->events[i % b->capacity];
+            [out appendBytes:&event length:sizeof(event)];
+        }
+        // Events the writer overwrote while we copied are unreliable: drop
+        // them. Index `after` may be mid-write too, and it shares a slot
+        // with index `after - capacity`, so that one goes as well.
+        uint64_t after = atomic_load_explicit(&b->writeIndex, memory_order_acquire);
+        uint64_t firstSafe = (after + 1 > b->capacity) ? after + 1 - b->capacity : 0;
+        if (firstSafe > begin) {
+            NSUInteger torn = (NSUInteger)MIN(firstSafe - begin, end - begin);
+            [out replaceBytesInRange:NSMakeRange(offset, torn * sizeof(HAPerfEvent)) withBytes:NULL length:0];
+        }
+    }
+    pthread_mutex_unlock(&_traceBuffersLock);
+
+    // Drop events from before the current session
+    NSMutableData *filtered = [NSMutableData dataWithCapacity:out.length];
+    const HAPerfEvent *events = out.bytes;
+    NSUInteger count = out.length / sizeof(HAPerfEvent);
+    for (NSUInteger i = 0; i < count; i++) {
+        if (events[i].start >= since) [filtered appendBytes:&events[i] length:sizeof(HAPerfEvent)];
+    }
+    return filtered;
+}
+
+/// Append the UTF-8 bytes [start, end) of a trace string to json.
+static void HAPerfAppendUTF8Run(NSMutableString *json, const char *start, const char *end) {
+    if (end <= start) return;
+    NSString *run = [[NSString alloc] initWithBytes:start length:(NSUInteger)(end - start)
+                                           encoding:NSUTF8StringEncoding];
+    // A name cut mid-character is not valid UTF-8; keep what can be shown
+    if (!run) run = [[NSString alloc] initWithBytes:start length:(NSUInteger)(end - start)
+                                           encoding:NSISOLatin1StringEncoding];
+    if (run) [json appendString:run];
+}
+
+/// Append s (UTF-8) as a JSON string literal. Quotes, backslashes and
+/// control characters are escaped; everything else is copied in runs.
+static void HAPerfAppendJSONString(NSMutableString *json, const char *s) {
+    [json appendString:@"\""];
+    if (s) {
+        const char *run = s;
+        const char *c = s;
+        for (; *c; c++) {
+            unsigned char ch = (unsigned char)*c;
+            if (ch != '"' && ch != '\\' && ch >= 0x20) continue;
+            HAPerfAppendUTF8Run(json, run, c);
+            if (ch == '"' || ch == '\\') [json appendFormat:@"\\%c", ch];
+            else [json appendFormat:@"\\u%04x", ch];
+            run = c + 1;
+        }
+        HAPerfAppendUTF8Run(json, run, c);
+    }
+    [json appendString:@"\""];
+}
+
 @interface HAPerfMonitor ()
 @property (nonatomic, strong) CADisplayLink *displayLink;
 @property (nonatomic, strong) NSTimer *flushTimer;
@@ -27,18 +273,27 @@ static const NSTimeInterval kFlushInterval = 10.0;
     NSUInteger _frameCount; // total frames since last flush
     CFTimeInterval _lastFrameTime;
 
-    // Rebuild timing
-    CFTimeInterval _rebuildStart;
+    // Rebuild timing (stack so nested brackets don't clobber each other)
+    HAPerfSpan _rebuildSpans[kSpanStackDepth];
+    NSUInteger _rebuildDepth;
     double _lastRebuildMs; // most recent rebuild duration
 
     // Cell timing
-    CFTimeInterval _cellStart;
-    NSString *_cellType;
+    HAPerfSpan _cellSpans[kSpanStackDepth];
+    NSUInteger _cellDepth;
     double _cellTotalMs;
     NSUInteger _cellCount;
     double _cellMaxMs;
     NSString *_cellMaxType;
 
+    // Hitch attribution (main thread only; fixed storage, no allocations)
+    CFTimeInterval _expectedFrameInterval;
+    HAHitchCause _hitchCauses[kHitchCauseSlots];
+    NSUInteger _hitchCauseCount;
+    NSUInteger _hitchCount;
+    NSUInteger _unattributedHitches;
+    NSUInteger _hitchSerial;
+
     BOOL _headerWritten;
 }
 
@@ -51,11 +306,23 @@ static const NSTimeInterval kFlushInterval = 10.0;
     return instance;
 }
 
++ (void)initialize {
+    if (self != [HAPerfMonitor class]) return;
+    mach_timebase_info(&_traceTimebase);
+    pthread_key_create(&_traceBufferKey, HAPerfThreadBufferRelease);
+    // Spans are no-ops until tracing starts, so this costs nothing before then
+    [HALog setFlushTracer:^(dispatch_block_t flush) {
+        HAPerfScopedSpan(HAPerfCategoryLog, "log.flush", NULL);
+        flush();
+    }];
+}
+
 - (instancetype)init {
     self = [super init];
     if (self) {
         [self detectDevice];
         [self resolveLogPath];
+        if (self.isLightweight) _traceBufferCapacity = 1024;
     }
     return self;
 }
@@ -102,8 +369,16 @@ static const NSTimeInterval kFlushInterval = 10.0;
     _cellCount = 0;
     _cellMaxMs = 0;
     _cellMaxType = nil;
+    _rebuildDepth = 0;
+    _cellDepth = 0;
+    _expectedFrameInterval = 0;
+    [self resetHitches];
     _headerWritten = NO;
 
+    // Begin a new trace session
+    _traceEpoch = mach_absolute_time();
+    atomic_store(&_tracingEnabled, true);
+
     // Open log file (truncate on fresh start)
     [[NSFileManager defaultManager] createFileAtPath:self.logPath contents:nil attributes:nil];
     self.logHandle = [NSFileHandle fileHandleForWritingAtPath:self.logPath];
@@ -129,6 +404,12 @@ static const NSTimeInterval kFlushInterval = 10.0;
 }
 
 - (void)stop {
+    if (self.displayLink) {
+        // Keep the session's trace for pulling off the device
+        [self writeTraceWithCompletion:nil];
+    }
+    atomic_store(&_tracingEnabled, false);
+
     [self.displayLink invalidate];
     self.displayLink = nil;
     [self.flushTimer invalidate];
@@ -150,9 +431,10 @@ static const NSTimeInterval kFlushInterval = 10.0;
             double fpsMin = (maxInterval > 0) ? (1.0 / maxInterval) : 0;
             double cellAvgMs = (_cellCount > 0) ? (_cellTotalMs / _cellCount) : 0;
             NSTimeInterval ts = [[NSDate date] timeIntervalSince1970];
-            NSString *line = [NSString stringWithFormat:@"%.0f,%.1f,%.1f,%.1f,%.1f,%.1f,%.2f,%.2f,%@\n",
+            NSString *line = [NSString stringWithFormat:@"%.0f,%.1f,%.1f,%.1f,%.1f,%.1f,%.2f,%.2f,%@,%lu,%@\n",
                 ts, fpsAvg, fpsMin, fpsMin, [self residentMemoryMB],
-                _lastRebuildMs, cellAvgMs, _cellMaxMs, _cellMaxType ?: @"-"];
+                _lastRebuildMs, cellAvgMs, _cellMaxMs, _cellMaxType ?: @"-",
+                (unsigned long)_hitchCount, [self hitchCauseSummary]];
             [self.logHandle writeData:[line dataUsingEncoding:NSUTF8StringEncoding]];
             [self.logHandle synchronizeFile];
         }
@@ -168,10 +450,15 @@ static const NSTimeInterval kFlushInterval = 10.0;
     _cellCount = 0;
     _cellMaxMs = 0;
     _cellMaxType = nil;
+    [self resetHitches];
 
     HALogI(@"perf", @"Stopped — log at %@", self.logPath);
 }
 
+- (BOOL)isRunning {
+    return self.displayLink != nil;
+}
+
 #pragma mark - Header
 
 - (void)writeHeader {
@@ -187,8 +474,9 @@ static const NSTimeInterval kFlushInterval = 10.0;
     NSString *startTime = [fmt stringFromDate:[NSDate date]];
 
     NSString *header = [NSString stringWithFormat:
-        @"# HAPerfMonitor v1 | device=%@ | iOS=%@ | scale=%.0fx | started=%@\n"
-        @"# ts,fps_avg,fps_min,fps_p1,mem_mb,rebuild_ms,cell_avg_ms,cell_max_ms,cell_max_type\n",
+        @"# HAPerfMonitor v2 | device=%@ | iOS=%@ | scale=%.0fx | started=%@\n"
+        @"# ts,fps_avg,fps_min,fps_p1,mem_mb,rebuild_ms,cell_avg_ms,cell_max_ms,cell_max_type,hitches,hitch_causes\n"
+        @"# hitch_causes: span[:detail]=hitches/overlap_ms;... (a hitch credits every span it overlapped)\n",
         self.deviceModel ?: @"unknown", iosVersion, scale, startTime];
 
     [self.logHandle writeData:[header dataUsingEncoding:NSUTF8StringEncoding]];
@@ -198,45 +486,252 @@ static const NSTimeInterval kFlushInterval = 10.0;
 
 - (void)displayLinkFired:(CADisplayLink *)link {
     CFTimeInterval now = link.timestamp;
+    if (_expectedFrameInterval <= 0) {
+        _expectedFrameInterval = link.duration * MAX(link.frameInterval, 1);
+    }
     if (_lastFrameTime > 0) {
-        _frameTimes[_frameWriteIndex % kFrameRingSize] = now - _lastFrameTime;
+        CFTimeInterval dt = now - _lastFrameTime;
+        _frameTimes[_frameWriteIndex % kFrameRingSize] = dt;
         _frameWriteIndex++;
         _frameCount++;
+        if (_expectedFrameInterval > 0 && dt > _expectedFrameInterval * kHitchThreshold) {
+            [self attributeHitchFrom:_lastFrameTime to:now];
+        }
     }
     _lastFrameTime = now;
 }
 
+#pragma mark - Hitch Attribution
+
+/// Credit every main-thread span that overlapped start...end (CACurrentMediaTime
+/// seconds, same clock as mach_absolute_time) to the hitch histogram.
+- (void)attributeHitchFrom:(CFTimeInterval)start to:(CFTimeInterval)end {
+    _hitchCount++;
+    _hitchSerial++;
+
+    HAPerfThreadBuffer *buffer = HAPerfCurrentThreadBuffer();
+    if (!buffer) {
+        _unattributedHitches++;
+        return;
+    }
+    double ticksPerSecond = 1e9 * _traceTimebase.denom / _traceTimebase.numer;
+    uint64_t windowStart = (uint64_t)(start * ticksPerSecond);
+    uint64_t windowEnd = (uint64_t)(end * ticksPerSecond);
+    double msPerTick = (double)_traceTimebase.numer / _traceTimebase.denom / 1e6;
+
+    // Events are appended as spans end, so walking backwards visits them in
+    // descending end time and can stop at the first one ending before the frame.
+    BOOL attributed = NO;
+    uint64_t writeIndex = atomic_load_explicit(&buffer->writeIndex, memory_order_relaxed);
+    uint64_t oldest = (writeIndex > buffer->capacity) ? writeIndex - buffer->capacity : 0;
+    for (uint64_t i = writeIndex; i > oldest; i--) {
+        const HAPerfEvent *e = &buffer->events[(i - 1) % buffer->capacity];
+        if (e->phase != 'X') continue;
+        uint64_t eventEnd = e->start + e->duration;
+        if (eventEnd < windowStart) break;
+        if (e->start > windowEnd) continue;
+        uint64_t overlap = MIN(eventEnd, windowEnd) - MAX(e->start, windowStart);
+        [self creditHitchCause:e->name detail:e->detail overlapMs:overlap * msPerTick];
+        attributed = YES;
+    }
+    if (!attributed) _unattributedHitches++;
+}
+
+- (void)creditHitchCause:(const char *)name detail:(const char *)detail overlapMs:(double)ms {
+    HAHitchCause *cause = NULL;
+    for (NSUInteger i = 0; i < _hitchCauseCount; i++) {
+        if (_hitchCauses[i].name == name && _hitchCauses[i].detail == detail) {
+            cause = &_hitchCauses[i];
+            break;
+        }
+    }
+    if (!cause) {
+        if (_hitchCauseCount < kHitchCauseSlots - 1) {
+            cause = &_hitchCauses[_hitchCauseCount++];
+            *cause = (HAHitchCause){ .name = name, .detail = detail };
+        } else {
+            // Last slot collects everything that didn't get its own
+            cause = &_hitchCauses[kHitchCauseSlots - 1];
+            if (_hitchCauseCount < kHitchCauseSlots) {
+                *cause = (HAHitchCause){ .name = "other", .detail = NULL };
+                _hitchCauseCount = kHitchCauseSlots;
+            }
+        }
+    }
+    cause->overlapMs += ms;
+    // Nested spans of the same kind (e.g. a cell configured inside a rebuild
+    // of another cell) count once per hitch
+    if (cause->lastHitch != _hitchSerial) {
+        cause->lastHitch = _hitchSerial;
+        cause->hitches++;
+    }
+}
+
+/// Top causes by hitch count as "name[:detail]=hitches/ms;..." ("-" if none).
+/// CSV-safe: span names and class names contain no commas.
+- (NSString *)hitchCauseSummary {
+    if (_hitchCount == 0) return @"-";
+
+    NSUInteger order[kHitchCauseSlots];
+    for (NSUInteger i = 0; i < _hitchCauseCount; i++) order[i] = i;
+    for (NSUInteger i = 1; i < _hitchCauseCount; i++) {
+        NSUInteger key = order[i];
+        NSInteger j = (NSInteger)i - 1;
+        while (j >= 0 && _hitchCauses[order[j]].hitches < _hitchCauses[key].hitches) {
+            order[j + 1] = order[j];
+            j--;
+        }
+        order[j + 1] = key;
+    }
+
+    NSMutableString *summary = [NSMutableString string];
+    for (NSUInteger k = 0; k < MIN(_hitchCauseCount, kHitchCausesReported); k++) {
+        const HAHitchCause *c = &_hitchCauses[order[k]];
+        if (summary.length > 0) [summary appendString:@";"];
+        [summary appendFormat:@"%s%s%s=%lu/%.1f", c->name ?: "?", c->detail ? ":" : "", c->detail ?: "",
+            (unsigned long)c->hitches, c->overlapMs];
+    }
+    if (_unattributedHitches > 0) {
+        if (summary.length > 0) [summary appendString:@";"];
+        [summary appendFormat:@"unattributed=%lu", (unsigned long)_unattributedHitches];
+    }
+    return summary;
+}
+
+- (void)resetHitches {
+    _hitchCauseCount = 0;
+    _hitchCount = 0;
+    _unattributedHitches = 0;
+}
+
 #pragma mark - Timing Marks
 
 - (void)markRebuildStart {
-    _rebuildStart = CACurrentMediaTime();
+    if (_rebuildDepth < kSpanStackDepth) {
+        _rebuildSpans[_rebuildDepth] = HAPerfSpanBegin(HAPerfCategoryRebuild, "rebuild", NULL);
+    }
+    _rebuildDepth++;
 }
 
 - (void)markRebuildEnd {
-    if (_rebuildStart > 0) {
-        _lastRebuildMs = (CACurrentMediaTime() - _rebuildStart) * 1000.0;
-        _rebuildStart = 0;
+    if (_rebuildDepth == 0) return;
+    _rebuildDepth--;
+    if (_rebuildDepth < kSpanStackDepth) {
+        double ms = HAPerfSpanEnd(_rebuildSpans[_rebuildDepth]);
+        if (_rebuildSpans[_rebuildDepth].spanId != 0) _lastRebuildMs = ms;
     }
 }
 
-- (void)markCellStart:(NSString *)cellType {
-    _cellStart = CACurrentMediaTime();
-    _cellType = cellType;
+- (void)markCellStart:(Class)cellClass {
+    if (_cellDepth < kSpanStackDepth) {
+        _cellSpans[_cellDepth] = HAPerfSpanBegin(HAPerfCategoryCell, "cell.configure",
+                                                 cellClass ? class_getName(cellClass) : NULL);
+    }
+    _cellDepth++;
 }
 
 - (void)markCellEnd {
-    if (_cellStart > 0) {
-        double ms = (CACurrentMediaTime() - _cellStart) * 1000.0;
-        _cellTotalMs += ms;
-        _cellCount++;
-        if (ms > _cellMaxMs) {
-            _cellMaxMs = ms;
-            _cellMaxType = _cellType;
-        }
-        _cellStart = 0;
+    if (_cellDepth == 0) return;
+    _cellDepth--;
+    if (_cellDepth >= kSpanStackDepth) return;
+    HAPerfSpan span = _cellSpans[_cellDepth];
+    if (span.spanId == 0) return;
+    double ms = HAPerfSpanEnd(span);
+    _cellTotalMs += ms;
+    _cellCount++;
+    if (ms > _cellMaxMs) {
+        _cellMaxMs = ms;
+        _cellMaxType = span.detail ? @(span.detail) : nil;
     }
 }
 
+#pragma mark - Trace Export
+
+- (void)writeTraceWithCompletion:(void (^)(NSString *path))completion {
+    NSMutableDictionary<NSNumber *, NSString *> *threadNames = [NSMutableDictionary dictionary];
+    uint64_t epoch = _traceEpoch;
+    NSData *snapshot = HAPerfSnapshotEvents(epoch, threadNames);
+    NSString *path = [[self.logPath stringByDeletingLastPathComponent] stringByAppendingPathComponent:@"trace.json"];
+    NSString *device = self.deviceModel ?: @"unknown";
+    NSString *iosVersion = [[UIDevice currentDevice] systemVersion];
+
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        const HAPerfEvent *events = snapshot.bytes;
+        NSUInteger count = snapshot.length / sizeof(HAPerfEvent);
+        double usPerTick = (double)_traceTimebase.numer / _traceTimebase.denom / 1e3;
+
+        NSMutableString *json = [NSMutableString stringWithCapacity:count * 120 + 256];
+        [json appendFormat:@"{\"displayTimeUnit\":\"ms\",\"otherData\":{\"device\":\"%@\",\"ios\":\"%@\"},\"traceEvents\":[",
+            device, iosVersion];
+        BOOL first = YES;
+        for (NSNumber *tid in threadNames) {
+            [json appendFormat:@"%@{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%@,\"args\":{\"name\":\"%@\"}}",
+                first ? @"" : @",", tid, threadNames[tid]];
+            first = NO;
+        }
+
+        for (NSUInteger i = 0; i < count; i++) {
+            const HAPerfEvent *e = &events[i];
+            double ts = (double)(e->start - epoch) * usPerTick;
+            const char *cat = _categoryNames[MIN(e->category, (uint8_t)HAPerfCategoryApp)];
+            if (!first) [json appendString:@","];
+            first = NO;
+
+            if (e->phase == 'X' && e->threadId != e->endThreadId) {
+                // Began and ended on different threads: async begin/end pair
+                double endTs = ts + (double)e->duration * usPerTick;
+                for (int half = 0; half < 2; half++) {
+                    if (half) [json appendString:@","];
+                    [json appendString:@"{\"name\":"];
+                    HAPerfAppendJSONString(json, e->name);
+                    [json appendFormat:@",\"cat\":\"%s\",\"ph\":\"%c\",\"id\":%llu,\"ts\":%.1f,\"pid\":1,\"tid\":%u",
+                        cat, half ? 'e' : 'b', (unsigned long long)e->spanId,
+                        half ? endTs : ts, half ? e->endThreadId : e->threadId];
+                    if (!half && e->detail) {
+                        [json appendString:@",\"args\":{\"detail\":"];
+                        HAPerfAppendJSONString(json, e->detail);
+                        [json appendString:@"}"];
+                    }
+                    [json appendString:@"}"];
+                }
+                continue;
+            }
+
+            [json appendString:@"{\"name\":"];
+            HAPerfAppendJSONString(json, e->name);
+            [json appendFormat:@",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%.1f,\"pid\":1,\"tid\":%u",
+                cat, e->phase, ts, e->threadId];
+            if (e->phase == 'X') {
+                [json appendFormat:@",\"dur\":%.1f", (double)e->duration * usPerTick];
+            } else if (e->phase == 'i') {
+                [json appendString:@",\"s\":\"t\""];
+            }
+            if (e->phase == 'C') {
+                [json appendFormat:@",\"args\":{\"value\":%g}", e->value];
+            } else if (e->detail) {
+                [json appendString:@",\"args\":{\"detail\":"];
+                HAPerfAppendJSONString(json, e->detail);
+                [json appendString:@"}"];
+            }
+            [json appendString:@"}"];
+        }
+        [json appendString:@"]}\n"];
+
+        NSError *error = nil;
+        BOOL ok = [json writeToFile:path atomically:YES encoding:NSUTF8StringEncoding error:&error];
+        if (ok) {
+            HALogI(@"perf", @"Wrote %lu trace events to %@", (unsigned long)count, path);
+        } else {
+            HALogW(@"perf", @"Failed to write trace: %@", error.localizedDescription);
+        }
+        if (completion) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completion(ok ? path : nil);
+            });
+        }
+    });
+}
+
 #pragma mark - Flush
 
 - (void)flush {
@@ -257,6 +752,12 @@ static const NSTimeInterval kFlushInterval = 10.0;
     NSUInteger cellCount = _cellCount;
     double cellMax = _cellMaxMs;
     NSString *cellType = _cellMaxType ?: @"-";
+    NSUInteger hitches = _hitchCount;
+    NSString *hitchCauses = [self hitchCauseSummary];
+    if (hitches > 0) {
+        HALogD(@"perf", @"%lu hitches: %@", (unsigned long)hitches, hitchCauses);
+    }
+    [self resetHitches];
 
     // Reset counters immediately (main thread)
     _frameWriteIndex = 0;
@@ -299,8 +800,9 @@ static const NSTimeInterval kFlushInterval = 10.0;
         double cellAvgMs = (cellCount > 0) ? (cellTotal / cellCount) : 0;
         NSTimeInterval ts = [[NSDate date] timeIntervalSince1970];
 
-        NSString *line = [NSString stringWithFormat:@"%.0f,%.1f,%.1f,%.1f,%.1f,%.1f,%.2f,%.2f,%@\n",
-            ts, fpsAvg, fpsMin, fpsP1, memMB, rebuildMs, cellAvgMs, cellMax, cellType];
+        NSString *line = [NSString stringWithFormat:@"%.0f,%.1f,%.1f,%.1f,%.1f,%.1f,%.2f,%.2f,%@,%lu,%@\n",
+            ts, fpsAvg, fpsMin, fpsP1, memMB, rebuildMs, cellAvgMs, cellMax, cellType,
+            (unsigned long)hitches, hitchCauses];
         @synchronized(handle) {
             [handle writeData:[line dataUsingEncoding:NSUTF8StringEncoding]];
             [handle synchronizeFile];
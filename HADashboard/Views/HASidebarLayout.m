@@ -1,4 +1,5 @@
 #import "HASidebarLayout.h"
+#import "HAPerfMonitor.h"
 
 /// HA sidebar layout constants
 static const CGFloat kSidebarCollapseWidth = 760.0;
@@ -24,6 +25,7 @@ static const CGFloat kContentPadding = 4.0;  // top/side padding
 }
 
 - (void)prepareLayout {
+    HAPerfScopedSpan(HAPerfCategoryLayout, "layout.prepare", "HASidebarLayout");
     [super prepareLayout];
 
     [self.itemAttributes removeAllObjects];
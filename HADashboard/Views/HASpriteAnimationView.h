@@ -0,0 +1,19 @@
+#import <UIKit/UIKit.h>
+
+@class HAWeatherIconAtlas;
+
+/// Plays a pre-rasterized HAWeatherIconAtlas by animating the layer's
+/// contentsRect with a discrete keyframe animation. The animation runs in the
+/// render server, so a looping icon costs no main-thread work per frame.
+/// The animation is only attached while the view is in a window.
+@interface HASpriteAnimationView : UIView
+
+/// Setting an atlas shows its first frame and restarts playback if animating.
+@property (nonatomic, strong) HAWeatherIconAtlas *atlas;
+
+@property (nonatomic, readonly, getter=isAnimating) BOOL animating;
+
+- (void)startAnimating;
+- (void)stopAnimating;
+
+@end
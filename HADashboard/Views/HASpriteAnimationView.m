@@ -0,0 +1,69 @@
+#import "HASpriteAnimationView.h"
+#import "HAWeatherIconAtlas.h"
+
+static NSString *const kSpriteAnimationKey = @"spriteFrames";
+
+@interface HASpriteAnimationView ()
+@property (nonatomic, readwrite, getter=isAnimating) BOOL animating;
+@end
+
+@implementation HASpriteAnimationView
+
+- (instancetype)initWithFrame:(CGRect)frame {
+    self = [super initWithFrame:frame];
+    if (self) {
+        self.userInteractionEnabled = NO;
+        self.layer.contentsGravity = kCAGravityResizeAspect;
+    }
+    return self;
+}
+
+- (void)setAtlas:(HAWeatherIconAtlas *)atlas {
+    if (_atlas == atlas) return;
+    _atlas = atlas;
+
+    [self.layer removeAnimationForKey:kSpriteAnimationKey];
+    [CATransaction begin];
+    [CATransaction setDisableActions:YES];
+    self.layer.contents = (__bridge id)atlas.image.CGImage;
+    self.layer.contentsScale = atlas.image.scale ?: [UIScreen mainScreen].scale;
+    self.layer.contentsRect = atlas ? [atlas contentsRectForFrame:0] : CGRectMake(0, 0, 1, 1);
+    [CATransaction commit];
+
+    [self updateAnimation];
+}
+
+- (void)startAnimating {
+    self.animating = YES;
+    [self updateAnimation];
+}
+
+- (void)stopAnimating {
+    self.animating = NO;
+    [self updateAnimation];
+}
+
+- (void)didMoveToWindow {
+    [super didMoveToWindow];
+    [self updateAnimation];
+}
+
+- (void)updateAnimation {
+    BOOL shouldRun = self.animating && self.window && self.atlas.frameCount > 1;
+    if (!shouldRun) {
+        [self.layer removeAnimationForKey:kSpriteAnimationKey];
+        return;
+    }
+    if ([self.layer animationForKey:kSpriteAnimationKey]) return;
+
+    CAKeyframeAnimation *anim = [CAKeyframeAnimation animationWithKeyPath:@"contentsRect"];
+    anim.values = self.atlas.contentsRectKeyframes;
+    anim.calculationMode = kCAAnimationDiscrete;
+    anim.duration = self.atlas.duration;
+    anim.repeatCount = HUGE_VALF;
+    // Survive app backgrounding — otherwise Core Animation drops it on resume
+    anim.removedOnCompletion = NO;
+    [self.layer addAnimation:anim forKey:kSpriteAnimationKey];
+}
+
+@end
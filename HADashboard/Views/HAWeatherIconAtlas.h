@@ -0,0 +1,45 @@
+#import <UIKit/UIKit.h>
+
+/// Pre-rasterized sprite sheet for one animated weather icon.
+///
+/// The bundled WeatherIcons/*.json Lottie animations are rendered once per
+/// icon and pixel size into a row-major grid of frames, written to
+/// Library/Caches as PNG + JSON metadata, and shared in memory so every card
+/// showing the same condition uses a single decoded texture. Playback is done
+/// by HASpriteAnimationView stepping a layer's contentsRect, which runs in the
+/// render server with no per-frame work on the main thread.
+///
+/// All class methods must be called on the main thread.
+@interface HAWeatherIconAtlas : NSObject
+
+@property (nonatomic, copy, readonly) NSString *iconName;
+@property (nonatomic, strong, readonly) UIImage *image;
+@property (nonatomic, assign, readonly) NSUInteger frameCount;
+@property (nonatomic, assign, readonly) NSUInteger columns;
+/// Loop duration in seconds (matches the source animation at speed 1).
+@property (nonatomic, assign, readonly) NSTimeInterval duration;
+
+/// contentsRect (unit coordinates) for each frame, in playback order.
+@property (nonatomic, copy, readonly) NSArray<NSValue *> *contentsRectKeyframes;
+
+/// contentsRect (unit coordinates) of one frame's grid cell, inset half a
+/// pixel so linear filtering never samples the neighbouring frame.
+- (CGRect)contentsRectForFrame:(NSUInteger)frame;
+
+/// Memory-only lookup. Returns nil if the atlas has not been loaded yet.
++ (instancetype)cachedAtlasForIconName:(NSString *)iconName pointSize:(CGFloat)pointSize;
+
+/// Load from memory, then disk, and finally render from the bundled Lottie JSON.
+/// Rendering is spread over several run loop passes to avoid a main-thread hitch.
+/// Concurrent requests for the same icon/size share one load.
+/// Completion runs on the main queue; atlas is nil if the icon has no animation.
++ (void)loadAtlasForIconName:(NSString *)iconName
+                   pointSize:(CGFloat)pointSize
+                  completion:(void (^)(HAWeatherIconAtlas *atlas))completion;
+
+/// Make sure atlases for all given icons exist on disk, rendering missing ones
+/// one at a time. Intended to run once after launch so later condition changes
+/// never hit the Lottie renderer.
++ (void)prewarmIconNames:(NSArray<NSString *> *)iconNames pointSize:(CGFloat)pointSize;
+
+@end
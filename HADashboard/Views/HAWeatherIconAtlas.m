@@ -0,0 +1,452 @@
+#import "HAWeatherIconAtlas.h"
+#import "HALog.h"
+#import "LOTAnimationView.h"
+
+/// Playback rate of the rasterized frames. Weather icons are slow-moving
+/// (drifting clouds, rotating sun) so 12 fps reads as smooth.
+static const NSUInteger kAtlasFrameRate = 12;
+/// Cap the render scale at 2x — 3x phones gain nothing visible at icon size
+/// but would more than double the texture size.
+static const CGFloat kAtlasMaxScale = 2.0;
+/// Largest texture dimension supported by every GPU we ship to (A5).
+static const size_t kAtlasMaxDimension = 2048;
+/// Frames rendered per run loop pass while building an atlas.
+static const NSUInteger kAtlasFramesPerPass = 4;
+/// Bump when the on-disk layout changes so stale atlases are re-rendered.
+static const NSInteger kAtlasFormatVersion = 1;
+/// Memory budget for decoded atlases shared between cells.
+static const NSUInteger kAtlasMemoryLimit = 24 * 1024 * 1024;
+
+@interface HAWeatherIconAtlas ()
+@property (nonatomic, copy, readwrite) NSString *iconName;
+@property (nonatomic, strong, readwrite) UIImage *image;
+@property (nonatomic, assign, readwrite) NSUInteger frameCount;
+@property (nonatomic, assign, readwrite) NSUInteger columns;
+@property (nonatomic, assign, readwrite) NSTimeInterval duration;
+@property (nonatomic, copy, readwrite) NSArray<NSValue *> *contentsRectKeyframes;
++ (NSUInteger)gridColumnsForFrameCount:(NSUInteger *)frameCount cellPixels:(size_t)cellPx;
+@end
+
+#pragma mark - Render Job
+
+/// Renders a Lottie animation into an atlas bitmap a few frames at a time on
+/// the main run loop (Lottie's layer tree is UIKit-bound and must stay on main).
+@interface HAWeatherAtlasRenderJob : NSObject
+- (instancetype)initWithIconName:(NSString *)iconName jsonPath:(NSString *)jsonPath
+                       pointSize:(CGFloat)pointSize scale:(CGFloat)scale;
+- (void)startWithCompletion:(void (^)(HAWeatherIconAtlas *atlas))completion;
+@end
+
+@implementation HAWeatherAtlasRenderJob {
+    NSString *_iconName;
+    NSString *_jsonPath;
+    CGFloat _pointSize;
+    CGFloat _scale;
+    LOTAnimationView *_animationView;
+    CGContextRef _context;
+    NSUInteger _frameCount;
+    NSUInteger _columns;
+    NSUInteger _nextFrame;
+    NSTimeInterval _duration;
+    void (^_completion)(HAWeatherIconAtlas *);
+}
+
+- (instancetype)initWithIconName:(NSString *)iconName jsonPath:(NSString *)jsonPath
+                       pointSize:(CGFloat)pointSize scale:(CGFloat)scale {
+    self = [super init];
+    if (self) {
+        _iconName = [iconName copy];
+        _jsonPath = [jsonPath copy];
+        _pointSize = pointSize;
+        _scale = scale;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    if (_context) CGContextRelease(_context);
+}
+
+- (void)startWithCompletion:(void (^)(HAWeatherIconAtlas *))completion {
+    _completion = [completion copy];
+
+    _animationView = [LOTAnimationView animationWithFilePath:_jsonPath];
+    _animationView.frame = CGRectMake(0, 0, _pointSize, _pointSize);
+    _animationView.contentMode = UIViewContentModeScaleAspectFit;
+    [_animationView layoutIfNeeded];
+
+    _duration = _animationView.animationDuration;
+    NSUInteger frames = (_duration > 0) ? (NSUInteger)llround(_duration * kAtlasFrameRate) : 1;
+    if (frames < 1) frames = 1;
+
+    size_t cellPx = (size_t)ceil(_pointSize * _scale);
+    NSUInteger columns = [HAWeatherIconAtlas gridColumnsForFrameCount:&frames cellPixels:cellPx];
+    NSUInteger rows = (frames + columns - 1) / columns;
+
+    _frameCount = frames;
+    _columns = columns;
+    _nextFrame = 0;
+
+    size_t width = columns * cellPx;
+    size_t height = rows * cellPx;
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    _context = CGBitmapContextCreate(NULL, width, height, 8, 0, colorSpace,
+        kCGImageAlphaPremultipliedFirst | kCGBitmapByteOrder32Little);
+    CGColorSpaceRelease(colorSpace);
+    if (!_context) {
+        HALogE(@"weather", @"Atlas context failed for %@ (%zux%zu)", _iconName, width, height);
+        [self finishWithAtlas:nil];
+        return;
+    }
+
+    // Match UIKit's flipped, point-based coordinate space so renderInContext: draws upright
+    CGContextTranslateCTM(_context, 0, height);
+    CGContextScaleCTM(_context, _scale, -_scale);
+
+    [self renderNextPass];
+}
+
+- (void)renderNextPass {
+    CGFloat cellPt = ceil(_pointSize * _scale) / _scale;
+    NSUInteger end = MIN(_nextFrame + kAtlasFramesPerPass, _frameCount);
+
+    for (NSUInteger i = _nextFrame; i < end; i++) {
+        [CATransaction begin];
+        [CATransaction setDisableActions:YES];
+        _animationView.animationProgress = (CGFloat)i / (CGFloat)_frameCount;
+        [_animationView forceDrawingUpdate];
+        [CATransaction commit];
+
+        NSUInteger col = i % _columns;
+        NSUInteger row = i / _columns;
+        CGContextSaveGState(_context);
+        CGContextTranslateCTM(_context, col * cellPt, row * cellPt);
+        CGContextClipToRect(_context, CGRectMake(0, 0, _pointSize, _pointSize));
+        [_animationView.layer renderInContext:_context];
+        CGContextRestoreGState(_context);
+    }
+    _nextFrame = end;
+
+    if (_nextFrame < _frameCount) {
+        // Yield to the run loop between passes (default mode only, so
+        // rendering pauses while the user is actively scrolling).
+        [self performSelector:@selector(renderNextPass) withObject:nil afterDelay:0];
+        return;
+    }
+
+    CGImageRef cgImage = CGBitmapContextCreateImage(_context);
+    HAWeatherIconAtlas *atlas = nil;
+    if (cgImage) {
+        atlas = [[HAWeatherIconAtlas alloc] init];
+        atlas.iconName = _iconName;
+        atlas.image = [UIImage imageWithCGImage:cgImage scale:_scale orientation:UIImageOrientationUp];
+        atlas.frameCount = _frameCount;
+        atlas.columns = _columns;
+        atlas.duration = _duration > 0 ? _duration : 1.0;
+        CGImageRelease(cgImage);
+    }
+    _animationView = nil;
+    [self finishWithAtlas:atlas];
+}
+
+- (void)finishWithAtlas:(HAWeatherIconAtlas *)atlas {
+    void (^completion)(HAWeatherIconAtlas *) = _completion;
+    _completion = nil;
+    if (completion) completion(atlas);
+}
+
+@end
+
+#pragma mark - Atlas
+
+@implementation HAWeatherIconAtlas
+
++ (NSCache *)memoryCache {
+    static NSCache *cache = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        cache = [[NSCache alloc] init];
+        cache.totalCostLimit = kAtlasMemoryLimit;
+    });
+    return cache;
+}
+
+/// key → array of completion blocks waiting on an in-flight load. Main thread only.
++ (NSMutableDictionary<NSString *, NSMutableArray *> *)pendingLoads {
+    static NSMutableDictionary *pending = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        pending = [NSMutableDictionary dictionary];
+    });
+    return pending;
+}
+
++ (dispatch_queue_t)ioQueue {
+    static dispatch_queue_t queue = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        queue = dispatch_queue_create("com.hadashboard.weatheratlas.io", DISPATCH_QUEUE_SERIAL);
+    });
+    return queue;
+}
+
++ (CGFloat)renderScale {
+    return MIN([UIScreen mainScreen].scale, kAtlasMaxScale);
+}
+
++ (NSString *)keyForIconName:(NSString *)iconName pointSize:(CGFloat)pointSize {
+    return [NSString stringWithFormat:@"%@@%.0fpx-v%ld", iconName,
+            ceil(pointSize * [self renderScale]), (long)kAtlasFormatVersion];
+}
+
++ (NSString *)cacheDirectory {
+    static NSString *dir = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSString *caches = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) firstObject];
+        dir = [caches stringByAppendingPathComponent:@"HAWeatherAtlas"];
+        [[NSFileManager defaultManager] createDirectoryAtPath:dir withIntermediateDirectories:YES attributes:nil error:nil];
+    });
+    return dir;
+}
+
+#pragma mark - Geometry
+
+/// Square-ish grid; drops frames (not resolution) if the grid would exceed
+/// the texture limit. Clamps *frameCount in place.
++ (NSUInteger)gridColumnsForFrameCount:(NSUInteger *)frameCount cellPixels:(size_t)cellPx {
+    NSUInteger maxColumns = MAX((NSUInteger)1, kAtlasMaxDimension / MAX(cellPx, (size_t)1));
+    NSUInteger frames = MIN(MAX(*frameCount, (NSUInteger)1), maxColumns * maxColumns);
+    *frameCount = frames;
+    return (NSUInteger)ceil(sqrt((double)frames));
+}
+
+- (CGRect)contentsRectForFrame:(NSUInteger)frame {
+    NSUInteger rows = (self.frameCount + self.columns - 1) / self.columns;
+    CGFloat w = 1.0 / self.columns;
+    CGFloat h = 1.0 / rows;
+    CGRect rect = CGRectMake((frame % self.columns) * w, (frame / self.columns) * h, w, h);
+
+    // Inset half a pixel so linear filtering never samples the neighbouring frame
+    CGImageRef cg = self.image.CGImage;
+    if (cg) {
+        rect = CGRectInset(rect, 0.5 / CGImageGetWidth(cg), 0.5 / CGImageGetHeight(cg));
+    }
+    return rect;
+}
+
+- (NSArray<NSValue *> *)contentsRectKeyframes {
+    if (!_contentsRectKeyframes) {
+        NSMutableArray *values = [NSMutableArray arrayWithCapacity:self.frameCount];
+        for (NSUInteger i = 0; i < self.frameCount; i++) {
+            [values addObject:[NSValue valueWithCGRect:[self contentsRectForFrame:i]]];
+        }
+        _contentsRectKeyframes = [values copy];
+    }
+    return _contentsRectKeyframes;
+}
+
+#pragma mark - Loading
+
++ (instancetype)cachedAtlasForIconName:(NSString *)iconName pointSize:(CGFloat)pointSize {
+    if (iconName.length == 0 || pointSize <= 0) return nil;
+    return [[self memoryCache] objectForKey:[self keyForIconName:iconName pointSize:pointSize]];
+}
+
++ (void)loadAtlasForIconName:(NSString *)iconName
+                   pointSize:(CGFloat)pointSize
+                  completion:(void (^)(HAWeatherIconAtlas *))completion {
+    if (iconName.length == 0 || pointSize <= 0) {
+        if (completion) completion(nil);
+        return;
+    }
+
+    NSString *key = [self keyForIconName:iconName pointSize:pointSize];
+    HAWeatherIconAtlas *cached = [[self memoryCache] objectForKey:key];
+    if (cached) {
+        if (completion) completion(cached);
+        return;
+    }
+
+    NSMutableArray *waiters = [self pendingLoads][key];
+    if (waiters) {
+        if (completion) [waiters addObject:[completion copy]];
+        return;
+    }
+    waiters = [NSMutableArray array];
+    if (completion) [waiters addObject:[completion copy]];
+    [self pendingLoads][key] = waiters;
+
+    [self resolveAtlasForIconName:iconName key:key pointSize:pointSize keepDecoded:YES completion:^(HAWeatherIconAtlas *atlas) {
+        [self finishLoadForKey:key atlas:atlas];
+    }];
+}
+
+/// Cache atlas and hand it to everyone waiting on key.
++ (void)finishLoadForKey:(NSString *)key atlas:(HAWeatherIconAtlas *)atlas {
+    if (atlas) {
+        CGImageRef cg = atlas.image.CGImage;
+        NSUInteger cost = cg ? CGImageGetBytesPerRow(cg) * CGImageGetHeight(cg) : 0;
+        [[self memoryCache] setObject:atlas forKey:key cost:cost];
+    }
+    NSArray *blocks = [self pendingLoads][key];
+    [[self pendingLoads] removeObjectForKey:key];
+    for (void (^block)(HAWeatherIconAtlas *) in blocks) {
+        block(atlas);
+    }
+}
+
+/// Disk → render fallback chain. When keepDecoded is NO (prewarm), a disk hit
+/// only checks that the files exist and returns nil without decoding; a
+/// fresh render is still returned.
++ (void)resolveAtlasForIconName:(NSString *)iconName
+                            key:(NSString *)key
+                      pointSize:(CGFloat)pointSize
+                    keepDecoded:(BOOL)keepDecoded
+                     completion:(void (^)(HAWeatherIconAtlas *atlas))completion {
+    NSString *basePath = [[self cacheDirectory] stringByAppendingPathComponent:key];
+    CGFloat scale = [self renderScale];
+
+    dispatch_async([self ioQueue], ^{
+        HAWeatherIconAtlas *diskAtlas = nil;
+        BOOL onDisk = NO;
+        if (keepDecoded) {
+            diskAtlas = [self readAtlasAtBasePath:basePath iconName:iconName scale:scale];
+            onDisk = (diskAtlas != nil);
+        } else {
+            NSFileManager *fm = [NSFileManager defaultManager];
+            onDisk = [fm fileExistsAtPath:[basePath stringByAppendingPathExtension:@"png"]] &&
+                     [fm fileExistsAtPath:[basePath stringByAppendingPathExtension:@"json"]];
+        }
+
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if (onDisk) {
+                completion(diskAtlas);
+                return;
+            }
+
+            NSString *jsonPath = [[NSBundle mainBundle] pathForResource:iconName ofType:@"json"];
+            if (!jsonPath) {
+                completion(nil);
+                return;
+            }
+
+            CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+            HAWeatherAtlasRenderJob *job = [[HAWeatherAtlasRenderJob alloc] initWithIconName:iconName
+                jsonPath:jsonPath pointSize:pointSize scale:scale];
+            [job startWithCompletion:^(HAWeatherIconAtlas *atlas) {
+                // The job retains itself through the pending performSelector until this fires
+                (void)job;
+                if (atlas) {
+                    HALogD(@"weather", @"Rendered atlas %@ (%lu frames) in %.0fms", key,
+                           (unsigned long)atlas.frameCount, (CFAbsoluteTimeGetCurrent() - start) * 1000.0);
+                    [self writeAtlas:atlas toBasePath:basePath];
+                }
+                completion(atlas);
+            }];
+        });
+    });
+}
+
++ (HAWeatherIconAtlas *)readAtlasAtBasePath:(NSString *)basePath iconName:(NSString *)iconName scale:(CGFloat)scale {
+    NSData *metaData = [NSData dataWithContentsOfFile:[basePath stringByAppendingPathExtension:@"json"]];
+    if (!metaData) return nil;
+    NSDictionary *meta = [NSJSONSerialization JSONObjectWithData:metaData options:0 error:nil];
+    if (![meta isKindOfClass:[NSDictionary class]]) return nil;
+    if ([meta[@"version"] integerValue] != kAtlasFormatVersion) return nil;
+
+    NSUInteger frames = [meta[@"frames"] unsignedIntegerValue];
+    NSUInteger columns = [meta[@"columns"] unsignedIntegerValue];
+    if (frames == 0 || columns == 0) return nil;
+
+    UIImage *png = [UIImage imageWithContentsOfFile:[basePath stringByAppendingPathExtension:@"png"]];
+    CGImageRef source = png.CGImage;
+    if (!source) return nil;
+
+    // Force decode here on the IO queue so the first composite on main doesn't pay for it
+    size_t width = CGImageGetWidth(source);
+    size_t height = CGImageGetHeight(source);
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGContextRef ctx = CGBitmapContextCreate(NULL, width, height, 8, 0, colorSpace,
+        kCGImageAlphaPremultipliedFirst | kCGBitmapByteOrder32Little);
+    CGColorSpaceRelease(colorSpace);
+    if (!ctx) return nil;
+    CGContextDrawImage(ctx, CGRectMake(0, 0, width, height), source);
+    CGImageRef decoded = CGBitmapContextCreateImage(ctx);
+    CGContextRelease(ctx);
+    if (!decoded) return nil;
+
+    HAWeatherIconAtlas *atlas = [[HAWeatherIconAtlas alloc] init];
+    atlas.iconName = iconName;
+    atlas.image = [UIImage imageWithCGImage:decoded scale:scale orientation:UIImageOrientationUp];
+    atlas.frameCount = frames;
+    atlas.columns = columns;
+    atlas.duration = [meta[@"duration"] doubleValue] > 0 ? [meta[@"duration"] doubleValue] : 1.0;
+    CGImageRelease(decoded);
+    return atlas;
+}
+
++ (void)writeAtlas:(HAWeatherIconAtlas *)atlas toBasePath:(NSString *)basePath {
+    UIImage *image = atlas.image;
+    NSDictionary *meta = @{
+        @"version":  @(kAtlasFormatVersion),
+        @"frames":   @(atlas.frameCount),
+        @"columns":  @(atlas.columns),
+        @"duration": @(atlas.duration),
+    };
+    dispatch_async([self ioQueue], ^{
+        NSData *png = UIImagePNGRepresentation(image);
+        NSData *metaData = [NSJSONSerialization dataWithJSONObject:meta options:0 error:nil];
+        if (!png || !metaData) return;
+        // Image first: metadata is the commit marker readers check for
+        if (![png writeToFile:[basePath stringByAppendingPathExtension:@"png"] atomically:YES] ||
+            ![metaData writeToFile:[basePath stringByAppendingPathExtension:@"json"] atomically:YES]) {
+            HALogW(@"weather", @"Failed to write atlas %@", basePath.lastPathComponent);
+        }
+    });
+}
+
+#pragma mark - Prewarm
+
++ (void)prewarmIconNames:(NSArray<NSString *> *)iconNames pointSize:(CGFloat)pointSize {
+    NSMutableArray *queue = [NSMutableArray array];
+    for (NSString *name in iconNames) {
+        if (![queue containsObject:name]) [queue addObject:name];
+    }
+    [self prewarmNextFromQueue:queue pointSize:pointSize];
+}
+
++ (void)prewarmNextFromQueue:(NSMutableArray<NSString *> *)queue pointSize:(CGFloat)pointSize {
+    if (queue.count == 0) return;
+    NSString *iconName = queue.firstObject;
+    [queue removeObjectAtIndex:0];
+
+    // Already in memory, or being loaded or prewarmed: don't render it twice
+    NSString *key = [self keyForIconName:iconName pointSize:pointSize];
+    if ([[self memoryCache] objectForKey:key] || [self pendingLoads][key]) {
+        [self prewarmNextFromQueue:queue pointSize:pointSize];
+        return;
+    }
+
+    // Registered as a pending load so a cell asking meanwhile joins this
+    // render instead of starting its own
+    [self pendingLoads][key] = [NSMutableArray array];
+    [self resolveAtlasForIconName:iconName key:key pointSize:pointSize keepDecoded:NO completion:^(HAWeatherIconAtlas *atlas) {
+        NSArray *waiters = [self pendingLoads][key];
+        if (waiters.count == 0) {
+            // Nobody is showing it yet: leave it on disk, not in memory
+            [[self pendingLoads] removeObjectForKey:key];
+        } else if (atlas) {
+            [self finishLoadForKey:key atlas:atlas];
+        } else {
+            // Found on disk, not decoded: load it properly for the waiters
+            [[self pendingLoads] removeObjectForKey:key];
+            for (void (^block)(HAWeatherIconAtlas *) in waiters) {
+                [self loadAtlasForIconName:iconName pointSize:pointSize completion:block];
+            }
+        }
+        [self prewarmNextFromQueue:queue pointSize:pointSize];
+    }];
+}
+
+@end
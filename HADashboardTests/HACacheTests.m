@@ -2,6 +2,7 @@
 #import "HACacheManager.h"
 #import "HAEntityStateCache.h"
 #import "HADashboardConfigCache.h"
+#import "HARegistryCache.h"
 #import "HAEntity.h"
 
 #pragma mark - HACacheManager Tests
@@ -403,3 +404,82 @@
 }
 
 @end
+
+#pragma mark - HARegistryCache Tests
+
+@interface HARegistryCacheTests : XCTestCase
+@end
+
+@implementation HARegistryCacheTests
+
+- (void)setUp {
+    [super setUp];
+    [HACacheManager sharedManager].serverURL = @"http://registry-cache-test.local:8123";
+}
+
+- (void)tearDown {
+    [[HACacheManager sharedManager] clearAllCaches];
+    [super tearDown];
+}
+
+- (void)waitForPendingWrites {
+    // Writes are serialized, so a later write completing means earlier ones have too
+    XCTestExpectation *exp = [self expectationWithDescription:@"writes flushed"];
+    [[HACacheManager sharedManager] writeJSON:@{} toFile:@"write-barrier.json" completion:^(BOOL success) {
+        [exp fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+}
+
+- (NSDictionary *)sampleSnapshot {
+    return @{
+        @"areas": @[@{@"area_id": @"kitchen", @"name": @"Kitchen"}],
+        @"device_areas": @{@"dev1": @"kitchen"},
+        @"entities": @[@{@"entity_id": @"light.kitchen", @"device_id": @"dev1"}],
+        @"entity_areas": @{@"light.kitchen": @"kitchen"},
+    };
+}
+
+- (void)testSaveAndLoadRoundTrip {
+    HARegistryCache *cache = [HARegistryCache sharedCache];
+    [cache saveRegistries:[self sampleSnapshot]];
+    [self waitForPendingWrites];
+
+    NSDictionary *loaded = [cache loadCachedRegistries];
+    XCTAssertEqualObjects(loaded[@"entity_areas"][@"light.kitchen"], @"kitchen");
+    XCTAssertEqualObjects(loaded[@"device_areas"][@"dev1"], @"kitchen");
+}
+
+- (void)testIncompleteSnapshotIsIgnored {
+    HARegistryCache *cache = [HARegistryCache sharedCache];
+    [cache saveRegistries:@{@"areas": @[]}];
+    [self waitForPendingWrites];
+    XCTAssertNil([cache loadCachedRegistries]);
+}
+
+- (void)testChangeDetectionSurvivesReload {
+    HARegistryCache *cache = [HARegistryCache sharedCache];
+    NSArray *areas = @[@{@"area_id": @"kitchen", @"name": @"Kitchen"}];
+    XCTAssertTrue([cache registryResult:areas changedForKey:HARegistryKeyArea]);
+    XCTAssertFalse([cache registryResult:areas changedForKey:HARegistryKeyArea]);
+
+    // Hashes are persisted with the snapshot
+    [cache saveRegistries:[self sampleSnapshot]];
+    [self waitForPendingWrites];
+    [cache loadCachedRegistries];
+    XCTAssertFalse([cache registryResult:areas changedForKey:HARegistryKeyArea]);
+
+    NSArray *renamed = @[@{@"area_id": @"kitchen", @"name": @"Cocina"}];
+    XCTAssertTrue([cache registryResult:renamed changedForKey:HARegistryKeyArea]);
+}
+
+- (void)testTrimmedEntityRegistryKeepsOnlyUsedFields {
+    NSArray *trimmed = [HARegistryCache trimmedEntityRegistry:@[
+        @{@"entity_id": @"sensor.x", @"area_id": [NSNull null], @"hidden_by": @"user",
+          @"original_name": @"X", @"unique_id": @"abc", @"options": @{@"sensor": @{}}},
+    ]];
+    XCTAssertEqual(trimmed.count, 1u);
+    XCTAssertEqualObjects(trimmed[0], (@{@"entity_id": @"sensor.x", @"hidden_by": @"user"}));
+}
+
+@end
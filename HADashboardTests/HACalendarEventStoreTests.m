@@ -0,0 +1,158 @@
+#import <XCTest/XCTest.h>
+#import "HACalendarEventStore.h"
+
+@interface HACalendarEventStore (Testing)
+- (BOOL)storeRawEvents:(NSArray *)rawEvents forCalendar:(NSString *)entityId
+                 start:(NSTimeInterval)start end:(NSTimeInterval)end;
+- (void)refreshStaleRanges;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, id> *ranges;
+@end
+
+@interface HACalendarEventStoreTests : XCTestCase
+@end
+
+@implementation HACalendarEventStoreTests
+
+- (void)tearDown {
+    [[HACalendarEventStore sharedStore] clearCache];
+    [super tearDown];
+}
+
+/// 2026-10-01T00:00:00Z
+static const NSTimeInterval kOctober = 1790812800.0;
+
+- (NSDictionary *)eventAt:(NSTimeInterval)start hours:(NSTimeInterval)hours summary:(NSString *)summary {
+    NSDateFormatter *fmt = [[NSDateFormatter alloc] init];
+    fmt.dateFormat = @"yyyy-MM-dd'T'HH:mm:ssZZZZZ";
+    fmt.timeZone = [NSTimeZone timeZoneWithAbbreviation:@"UTC"];
+    fmt.locale = [[NSLocale alloc] initWithLocaleIdentifier:@"en_US_POSIX"];
+    return @{
+        @"summary": summary,
+        @"start": @{@"dateTime": [fmt stringFromDate:[NSDate dateWithTimeIntervalSince1970:start]]},
+        @"end": @{@"dateTime": [fmt stringFromDate:[NSDate dateWithTimeIntervalSince1970:start + hours * 3600.0]]},
+    };
+}
+
+#pragma mark - Parsing
+
+- (void)testParsesTimedAndAllDayEvents {
+    NSArray<HACalendarEvent *> *events = [HACalendarEventStore eventsFromResponse:@[
+        @{@"summary": @"Holiday", @"start": @{@"date": @"2026-10-20"}, @"end": @{@"date": @"2026-10-21"}},
+        @{@"summary": @"Dentist", @"start": @{@"dateTime": @"2026-10-19T09:00:00+00:00"},
+          @"end": @{@"dateTime": @"2026-10-19T10:00:00+00:00"}, @"location": @"Main St"},
+        @{@"start": @"2026-10-22T12:00:00+00:00", @"end": @"2026-10-22T13:00:00+00:00"},
+        @{@"summary": @"No start"},
+        [NSNull null],
+    ] entityId:@"calendar.home"];
+
+    XCTAssertEqual(events.count, 3u);
+    XCTAssertEqualObjects(events[0].summary, @"Dentist");
+    XCTAssertEqualObjects(events[0].location, @"Main St");
+    XCTAssertFalse(events[0].allDay);
+    XCTAssertEqualObjects(events[1].summary, @"Holiday");
+    XCTAssertTrue(events[1].allDay);
+    XCTAssertNotNil(events[1].endDate);
+    XCTAssertEqualObjects(events[2].summary, @"(No title)");
+    XCTAssertEqualObjects(events[2].entityId, @"calendar.home");
+}
+
+- (void)testParsesNonArrayResponse {
+    XCTAssertEqual([HACalendarEventStore eventsFromResponse:(NSArray *)@{} entityId:@"calendar.home"].count, 0u);
+    XCTAssertEqual([HACalendarEventStore eventsFromResponse:nil entityId:@"calendar.home"].count, 0u);
+}
+
+#pragma mark - Cache
+
+- (void)testMergesCalendarsByStart {
+    HACalendarEventStore *store = [HACalendarEventStore sharedStore];
+    NSTimeInterval end = kOctober + 31 * 86400.0;
+    [store storeRawEvents:@[[self eventAt:kOctober + 86400.0 hours:1 summary:@"A1"],
+                            [self eventAt:kOctober + 3 * 86400.0 hours:1 summary:@"A2"]]
+              forCalendar:@"calendar.a" start:kOctober end:end];
+    [store storeRawEvents:@[[self eventAt:kOctober + 2 * 86400.0 hours:1 summary:@"B1"]]
+              forCalendar:@"calendar.b" start:kOctober end:end];
+
+    NSArray<HACalendarEvent *> *events = [store cachedEventsForCalendars:@[@"calendar.a", @"calendar.b"]
+                                                               startDate:[NSDate dateWithTimeIntervalSince1970:kOctober]
+                                                                 endDate:[NSDate dateWithTimeIntervalSince1970:end]];
+    XCTAssertEqualObjects([events valueForKey:@"summary"], (@[@"A1", @"B1", @"A2"]));
+    XCTAssertEqualObjects(events[1].entityId, @"calendar.b");
+}
+
+- (void)testMissingCalendarIsNotServedPartially {
+    HACalendarEventStore *store = [HACalendarEventStore sharedStore];
+    NSTimeInterval end = kOctober + 7 * 86400.0;
+    [store storeRawEvents:@[] forCalendar:@"calendar.a" start:kOctober end:end];
+
+    NSDate *startDate = [NSDate dateWithTimeIntervalSince1970:kOctober];
+    NSDate *endDate = [NSDate dateWithTimeIntervalSince1970:end];
+    XCTAssertNotNil([store cachedEventsForCalendars:@[@"calendar.a"] startDate:startDate endDate:endDate]);
+    XCTAssertNil([store cachedEventsForCalendars:@[@"calendar.a", @"calendar.b"] startDate:startDate endDate:endDate]);
+}
+
+- (void)testWeekIsServedFromCachedMonth {
+    HACalendarEventStore *store = [HACalendarEventStore sharedStore];
+    [store storeRawEvents:@[[self eventAt:kOctober + 86400.0 hours:1 summary:@"Before"],
+                            [self eventAt:kOctober + 9 * 86400.0 - 3600.0 hours:3 summary:@"Overlapping"],
+                            [self eventAt:kOctober + 10 * 86400.0 hours:1 summary:@"Inside"],
+                            [self eventAt:kOctober + 20 * 86400.0 hours:1 summary:@"After"]]
+              forCalendar:@"calendar.a" start:kOctober end:kOctober + 31 * 86400.0];
+
+    NSArray<HACalendarEvent *> *events = [store cachedEventsForCalendars:@[@"calendar.a"]
+                                                               startDate:[NSDate dateWithTimeIntervalSince1970:kOctober + 9 * 86400.0]
+                                                                 endDate:[NSDate dateWithTimeIntervalSince1970:kOctober + 16 * 86400.0]];
+    XCTAssertEqualObjects([events valueForKey:@"summary"], (@[@"Overlapping", @"Inside"]));
+    XCTAssertNil([store cachedEventsForCalendars:@[@"calendar.a"]
+                                       startDate:[NSDate dateWithTimeIntervalSince1970:kOctober + 28 * 86400.0]
+                                         endDate:[NSDate dateWithTimeIntervalSince1970:kOctober + 35 * 86400.0]]);
+}
+
+- (void)testRefreshReportsOnlyChanges {
+    HACalendarEventStore *store = [HACalendarEventStore sharedStore];
+    NSArray *raw = @[[self eventAt:kOctober hours:1 summary:@"A"]];
+    NSTimeInterval end = kOctober + 7 * 86400.0;
+    XCTAssertFalse([store storeRawEvents:raw forCalendar:@"calendar.a" start:kOctober end:end]);
+
+    NSDate *startDate = [NSDate dateWithTimeIntervalSince1970:kOctober];
+    NSDate *endDate = [NSDate dateWithTimeIntervalSince1970:end];
+    NSArray *before = [store cachedEventsForCalendars:@[@"calendar.a"] startDate:startDate endDate:endDate];
+    XCTAssertFalse([store storeRawEvents:[raw copy] forCalendar:@"calendar.a" start:kOctober end:end]);
+    // Unchanged refresh keeps the same event objects
+    XCTAssertEqualObjects([store cachedEventsForCalendars:@[@"calendar.a"] startDate:startDate endDate:endDate], before);
+
+    NSArray *changed = [raw arrayByAddingObject:[self eventAt:kOctober + 86400.0 hours:1 summary:@"B"]];
+    XCTAssertTrue([store storeRawEvents:changed forCalendar:@"calendar.a" start:kOctober end:end]);
+}
+
+#pragma mark - Expiry
+
+- (void)ageRangesOfStore:(HACalendarEventStore *)store {
+    NSTimeInterval longAgo = [[NSDate date] timeIntervalSince1970] - 3600.0;
+    for (id range in store.ranges.allValues) {
+        [range setValue:@(longAgo) forKey:@"usedAt"];
+    }
+}
+
+- (void)testShownRangeIsKeptPastIdleExpiry {
+    HACalendarEventStore *store = [HACalendarEventStore sharedStore];
+    NSTimeInterval end = kOctober + 31 * 86400.0;
+    [store storeRawEvents:@[[self eventAt:kOctober + 86400.0 hours:1 summary:@"A1"]]
+              forCalendar:@"calendar.a" start:kOctober end:end];
+    NSObject *card = [[NSObject alloc] init];
+    // A week inside the cached month keeps the month alive
+    [store registerInterestInCalendars:@[@"calendar.a"]
+                             startDate:[NSDate dateWithTimeIntervalSince1970:kOctober + 7 * 86400.0]
+                               endDate:[NSDate dateWithTimeIntervalSince1970:kOctober + 14 * 86400.0]
+                              forOwner:card];
+
+    [self ageRangesOfStore:store];
+    [store refreshStaleRanges];
+    XCTAssertEqual(store.ranges.count, 1u);
+
+    [store unregisterInterestForOwner:card];
+    [self ageRangesOfStore:store];
+    [store refreshStaleRanges];
+    XCTAssertEqual(store.ranges.count, 0u);
+}
+
+@end
@@ -0,0 +1,138 @@
+#import <XCTest/XCTest.h>
+#import "HACommandQueue.h"
+
+@interface HACommandQueueTests : XCTestCase
+@property (nonatomic, strong) HACommandQueue *queue;
+@property (nonatomic, strong) NSMutableArray<NSDictionary *> *sent;
+@property (nonatomic, assign) NSInteger nextId;
+@end
+
+@implementation HACommandQueueTests
+
+- (void)setUp {
+    [super setUp];
+    self.queue = [[HACommandQueue alloc] init];
+    self.sent = [NSMutableArray array];
+    self.nextId = 1;
+    __weak typeof(self) weakSelf = self;
+    self.queue.sendBlock = ^NSInteger(NSDictionary *command) {
+        NSMutableDictionary *msg = [command mutableCopy];
+        msg[@"id"] = @(weakSelf.nextId);
+        [weakSelf.sent addObject:msg];
+        return weakSelf.nextId++;
+    };
+}
+
+- (NSDictionary *)resultForId:(NSInteger)msgId {
+    return @{@"id": @(msgId), @"type": @"result", @"success": @YES, @"result": @"ok"};
+}
+
+#pragma mark - Completion
+
+- (void)testResultDeliveredToCompletion {
+    __block id received = nil;
+    [self.queue enqueueCommand:@{@"type": @"a"} priority:HACommandPriorityNormal timeout:0
+                    completion:^(id result, NSError *error) { received = result; }];
+    XCTAssertEqual(self.sent.count, 1u);
+    XCTAssertTrue([self.queue handleResultMessage:[self resultForId:1]]);
+    XCTAssertEqualObjects(received, @"ok");
+    XCTAssertEqual(self.queue.inFlightCount, 0u);
+}
+
+- (void)testUnknownResultNotHandled {
+    XCTAssertFalse([self.queue handleResultMessage:[self resultForId:42]]);
+}
+
+- (void)testServerErrorMapped {
+    __block NSError *received = nil;
+    [self.queue enqueueCommand:@{@"type": @"a"} priority:HACommandPriorityNormal timeout:0
+                    completion:^(id result, NSError *error) { received = error; }];
+    [self.queue handleResultMessage:@{@"id": @1, @"type": @"result", @"success": @NO,
+                                      @"error": @{@"code": @"not_found", @"message": @"Nope"}}];
+    XCTAssertEqual(received.code, HACommandErrorServer);
+    XCTAssertEqualObjects(received.localizedDescription, @"Nope");
+}
+
+- (void)testCancelledCommandNeverCompletes {
+    __block BOOL called = NO;
+    HACommandToken *token = [self.queue enqueueCommand:@{@"type": @"a"} priority:HACommandPriorityNormal timeout:0
+                                            completion:^(id result, NSError *error) { called = YES; }];
+    [token cancel];
+    XCTAssertTrue(token.isCancelled);
+    [self.queue handleResultMessage:[self resultForId:1]];
+    XCTAssertFalse(called);
+}
+
+- (void)testFailAllFailsQueuedAndInFlight {
+    self.queue.maxInFlight = 1;
+    __block NSInteger failures = 0;
+    for (NSInteger i = 0; i < 3; i++) {
+        [self.queue enqueueCommand:@{@"type": @"a"} priority:HACommandPriorityNormal timeout:0
+                        completion:^(id result, NSError *error) {
+            if (error.code == HACommandErrorDisconnected) failures++;
+        }];
+    }
+    XCTAssertEqual(self.queue.inFlightCount, 1u);
+    XCTAssertEqual(self.queue.queuedCount, 2u);
+    [self.queue failAllWithError:[NSError errorWithDomain:@"HAConnectionManager" code:HACommandErrorDisconnected userInfo:nil]];
+    XCTAssertEqual(failures, 3);
+    XCTAssertEqual(self.queue.inFlightCount, 0u);
+    XCTAssertEqual(self.queue.queuedCount, 0u);
+}
+
+- (void)testSendFailureReportsNotConnected {
+    self.queue.sendBlock = ^NSInteger(NSDictionary *command) { return -1; };
+    __block NSError *received = nil;
+    [self.queue enqueueCommand:@{@"type": @"a"} priority:HACommandPriorityNormal timeout:0
+                    completion:^(id result, NSError *error) { received = error; }];
+    XCTAssertEqual(received.code, HACommandErrorNotConnected);
+}
+
+#pragma mark - Back-pressure
+
+- (void)testBulkLimitedAndUserActionsBypassLimits {
+    self.queue.maxInFlight = 2;
+    self.queue.maxBulkInFlight = 1;
+    [self.queue enqueueCommand:@{@"type": @"bulk1"} priority:HACommandPriorityBulk timeout:0 completion:nil];
+    [self.queue enqueueCommand:@{@"type": @"bulk2"} priority:HACommandPriorityBulk timeout:0 completion:nil];
+    XCTAssertEqual(self.sent.count, 1u);
+
+    [self.queue enqueueCommand:@{@"type": @"normal"} priority:HACommandPriorityNormal timeout:0 completion:nil];
+    XCTAssertEqual(self.sent.count, 2u);
+
+    // At the overall limit, but a tap still goes out immediately
+    [self.queue enqueueCommand:@{@"type": @"tap"} priority:HACommandPriorityUserAction timeout:0 completion:nil];
+    XCTAssertEqualObjects(self.sent.lastObject[@"type"], @"tap");
+
+    // Finishing the first bulk fetch releases the second
+    [self.queue handleResultMessage:[self resultForId:1]];
+    [self.queue handleResultMessage:[self resultForId:2]];
+    [self.queue handleResultMessage:[self resultForId:3]];
+    XCTAssertEqualObjects(self.sent.lastObject[@"type"], @"bulk2");
+}
+
+- (void)testHigherPriorityDrainsFirst {
+    self.queue.maxInFlight = 1;
+    [self.queue enqueueCommand:@{@"type": @"first"} priority:HACommandPriorityNormal timeout:0 completion:nil];
+    [self.queue enqueueCommand:@{@"type": @"bulk"} priority:HACommandPriorityBulk timeout:0 completion:nil];
+    [self.queue enqueueCommand:@{@"type": @"normal"} priority:HACommandPriorityNormal timeout:0 completion:nil];
+    [self.queue handleResultMessage:[self resultForId:1]];
+    XCTAssertEqualObjects(self.sent.lastObject[@"type"], @"normal");
+}
+
+#pragma mark - Deadlines
+
+- (void)testTimeoutFailsCommand {
+    XCTestExpectation *exp = [self expectationWithDescription:@"timeout"];
+    [self.queue enqueueCommand:@{@"type": @"slow"} priority:HACommandPriorityNormal timeout:0.1
+                    completion:^(id result, NSError *error) {
+        XCTAssertEqual(error.code, HACommandErrorTimedOut);
+        [exp fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:2.0 handler:nil];
+    XCTAssertEqual(self.queue.inFlightCount, 0u);
+    // A late result is no longer ours
+    XCTAssertFalse([self.queue handleResultMessage:[self resultForId:1]]);
+}
+
+@end
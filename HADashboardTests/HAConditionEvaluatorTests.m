@@ -0,0 +1,108 @@
+#import <XCTest/XCTest.h>
+#import "HAConditionEvaluator.h"
+#import "HAEntity.h"
+
+@interface HAConditionEvaluatorTests : XCTestCase
+@property (nonatomic, strong) NSDictionary<NSString *, HAEntity *> *entities;
+@end
+
+@implementation HAConditionEvaluatorTests
+
+- (void)setUp {
+    [super setUp];
+    NSMutableDictionary *entities = [NSMutableDictionary dictionary];
+    NSDictionary *states = @{
+        @"light.kitchen": @"on",
+        @"switch.fan": @"off",
+        @"sensor.power": @"250.5",
+        @"input_boolean.guest": @"true",
+    };
+    [states enumerateKeysAndObjectsUsingBlock:^(NSString *entityId, NSString *state, BOOL *stop) {
+        entities[entityId] = [[HAEntity alloc] initWithDictionary:@{
+            @"entity_id": entityId, @"state": state, @"attributes": @{}
+        }];
+    }];
+    self.entities = entities;
+}
+
+- (BOOL)evaluate:(NSDictionary *)condition width:(CGFloat)width {
+    return [HAConditionEvaluator evaluateCondition:condition entities:self.entities screenWidth:width];
+}
+
+- (BOOL)evaluate:(NSDictionary *)condition {
+    return [self evaluate:condition width:1024];
+}
+
+#pragma mark - State
+
+- (void)testStateMatchesAndDefaultsToStateCondition {
+    XCTAssertTrue([self evaluate:@{@"condition": @"state", @"entity": @"light.kitchen", @"state": @"on"}]);
+    XCTAssertTrue([self evaluate:@{@"entity": @"light.kitchen", @"state": @"on"}]);
+    XCTAssertFalse([self evaluate:@{@"entity": @"switch.fan", @"state": @"on"}]);
+}
+
+- (void)testStateListAndStateNot {
+    XCTAssertTrue([self evaluate:@{@"entity": @"switch.fan", @"state": @[@"on", @"off"]}]);
+    XCTAssertFalse([self evaluate:@{@"entity": @"switch.fan", @"state_not": @[@"off", @"unavailable"]}]);
+    XCTAssertTrue([self evaluate:@{@"entity": @"light.kitchen", @"state_not": @"off"}]);
+}
+
+- (void)testBooleanSpellingsAreNormalized {
+    XCTAssertTrue([self evaluate:@{@"entity": @"input_boolean.guest", @"state": @"on"}]);
+    XCTAssertTrue([self evaluate:@{@"entity": @"light.kitchen", @"state": @YES}]);
+    XCTAssertEqualObjects([HAConditionEvaluator normalizedState:@0], @"off");
+    XCTAssertEqualObjects([HAConditionEvaluator normalizedState:nil], @"");
+}
+
+- (void)testMissingEntityFailsStateButPassesWithoutEntityId {
+    XCTAssertFalse([self evaluate:@{@"entity": @"light.missing", @"state": @"on"}]);
+    XCTAssertTrue([self evaluate:@{@"condition": @"state", @"state": @"on"}]);
+}
+
+#pragma mark - Numeric
+
+- (void)testNumericStateBoundsAreExclusive {
+    XCTAssertTrue([self evaluate:@{@"condition": @"numeric_state", @"entity": @"sensor.power", @"above": @250, @"below": @300}]);
+    XCTAssertFalse([self evaluate:@{@"condition": @"numeric_state", @"entity": @"sensor.power", @"above": @250.5}]);
+    XCTAssertFalse([self evaluate:@{@"condition": @"numeric_state", @"entity": @"sensor.missing", @"below": @10}]);
+}
+
+#pragma mark - Logic
+
+- (void)testAndOrNot {
+    NSDictionary *on = @{@"entity": @"light.kitchen", @"state": @"on"};
+    NSDictionary *off = @{@"entity": @"light.kitchen", @"state": @"off"};
+    XCTAssertTrue([self evaluate:@{@"condition": @"and", @"conditions": @[on, on]}]);
+    XCTAssertFalse([self evaluate:@{@"condition": @"and", @"conditions": @[on, off]}]);
+    XCTAssertTrue([self evaluate:@{@"condition": @"or", @"conditions": @[off, on]}]);
+    XCTAssertFalse([self evaluate:@{@"condition": @"or", @"conditions": @[off]}]);
+    XCTAssertTrue([self evaluate:@{@"condition": @"or", @"conditions": @[]}]);
+    XCTAssertTrue([self evaluate:@{@"condition": @"not", @"conditions": @[off]}]);
+    XCTAssertFalse([self evaluate:@{@"condition": @"not", @"conditions": @[off, on]}]);
+}
+
+- (void)testEvaluateConditionsRequiresAll {
+    NSArray *conditions = @[@{@"entity": @"light.kitchen", @"state": @"on"},
+                            @{@"entity": @"switch.fan", @"state": @"on"}];
+    XCTAssertFalse([HAConditionEvaluator evaluateConditions:conditions entities:self.entities screenWidth:1024]);
+    XCTAssertTrue([HAConditionEvaluator evaluateConditions:nil entities:self.entities screenWidth:1024]);
+}
+
+#pragma mark - Screen / Other
+
+- (void)testScreenMediaQueryUsesGivenWidth {
+    NSDictionary *tablet = @{@"condition": @"screen", @"media_query": @"(min-width: 768px)"};
+    NSDictionary *narrow = @{@"condition": @"screen", @"media_query": @"(min-width: 0px) and (max-width: 767px)"};
+    XCTAssertTrue([self evaluate:tablet width:1024]);
+    XCTAssertFalse([self evaluate:tablet width:375]);
+    XCTAssertTrue([self evaluate:narrow width:375]);
+    XCTAssertFalse([self evaluate:narrow width:1024]);
+}
+
+- (void)testUserUnknownAndMalformedConditionsPass {
+    XCTAssertTrue([self evaluate:@{@"condition": @"user", @"users": @[@"abc"]}]);
+    XCTAssertTrue([self evaluate:@{@"condition": @"time", @"after": @"08:00"}]);
+    XCTAssertTrue([self evaluate:(NSDictionary *)@"not a dict"]);
+}
+
+@end
@@ -0,0 +1,305 @@
+#import <XCTest/XCTest.h>
+#import "HAConnectionManager.h"
+#import "HAAPIClient.h"
+#import "HAWebSocketClient.h"
+#import "HAAuthManager.h"
+#import "HACacheManager.h"
+#import "HADashboardConfigCache.h"
+#import "HALovelaceParser.h"
+#import "HAEntity.h"
+
+// -----------------------------------------------------------------------
+// Expose private properties for testing.
+// -----------------------------------------------------------------------
+
+@interface HAConnectionManager (TestAccess)
+@property (nonatomic, strong) HAAPIClient *apiClient;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, HAEntity *> *entityStore;
+@property (nonatomic, copy) NSDictionary *pendingStrategyConfig;
+@property (nonatomic, assign) BOOL deliveredAllStates;
+@property (nonatomic, assign) BOOL registriesStale;
+@property (nonatomic, strong) NSDate *registriesFetchedAt;
+@property (nonatomic, copy) NSString *parsedLovelaceKey;
+@property (nonatomic, assign) NSInteger lovelaceMessageId;
+@property (nonatomic, copy) NSString *lovelaceRequestedPath;
+- (void)fetchAllStatesWithCompletion:(void (^)(void))completion;
+- (void)setRegistriesLoaded:(BOOL)registriesLoaded;
+- (BOOL)canReuseRegistries;
+- (void)webSocketClient:(HAWebSocketClient *)client didReceiveMessage:(NSDictionary *)message;
+@end
+
+/// Answers getStates synchronously with a canned response.
+@interface HAStubStatesAPIClient : HAAPIClient
+@property (nonatomic, copy) NSArray *states;
+@end
+
+@implementation HAStubStatesAPIClient
+- (void)getStatesWithCompletion:(HAAPIResponseBlock)completion {
+    completion(self.states, nil);
+}
+@end
+
+/// Records what the connection manager delivers.
+@interface HAResumeDelegateRecorder : NSObject <HAConnectionManagerDelegate>
+@property (nonatomic, strong) NSMutableArray<NSString *> *updatedEntityIds;
+@property (nonatomic, assign) NSUInteger allStatesCount;
+@property (nonatomic, assign) NSUInteger lovelaceCount;
+@end
+
+@implementation HAResumeDelegateRecorder
+- (instancetype)init {
+    self = [super init];
+    if (self) _updatedEntityIds = [NSMutableArray array];
+    return self;
+}
+- (void)connectionManager:(HAConnectionManager *)manager didUpdateEntity:(HAEntity *)entity {
+    [self.updatedEntityIds addObject:entity.entityId];
+}
+- (void)connectionManager:(HAConnectionManager *)manager didReceiveAllStates:(NSDictionary *)entities {
+    self.allStatesCount++;
+}
+- (void)connectionManager:(HAConnectionManager *)manager didReceiveLovelaceDashboard:(HALovelaceDashboard *)dashboard {
+    self.lovelaceCount++;
+}
+@end
+
+// -----------------------------------------------------------------------
+// HAConnectionResumeTests
+//
+// After a dropped connection the REST states response is reconciled
+// against the entity store: unchanged entities stay silent, a handful of
+// changes are delivered per entity, and anything larger (or a change in
+// which entities exist) falls back to a full didReceiveAllStates rebuild.
+// Registries and the parsed Lovelace dashboard are reused when unchanged.
+// -----------------------------------------------------------------------
+
+@interface HAConnectionResumeTests : XCTestCase
+@property (nonatomic, strong) HAStubStatesAPIClient *stubClient;
+@property (nonatomic, strong) HAResumeDelegateRecorder *recorder;
+@property (nonatomic, weak) id<HAConnectionManagerDelegate> savedDelegate;
+@property (nonatomic, strong) HAAPIClient *savedAPIClient;
+@property (nonatomic, copy) NSString *savedServerURL;
+@property (nonatomic, assign) NSUInteger entityNotificationCount;
+@end
+
+@implementation HAConnectionResumeTests
+
+- (void)setUp {
+    [super setUp];
+    HAConnectionManager *conn = [HAConnectionManager sharedManager];
+    self.savedDelegate = conn.delegate;
+    self.savedAPIClient = conn.apiClient;
+    self.savedServerURL = [HACacheManager sharedManager].serverURL;
+    [HACacheManager sharedManager].serverURL = @"http://connection-resume.test:8123";
+    [[HADashboardConfigCache sharedCache] clearCacheForDashboard:[HAAuthManager sharedManager].selectedDashboardPath];
+
+    [conn clearEntityStore];
+    self.recorder = [[HAResumeDelegateRecorder alloc] init];
+    conn.delegate = self.recorder;
+    self.stubClient = [[HAStubStatesAPIClient alloc] initWithBaseURL:[NSURL URLWithString:@"http://connection-resume.test:8123"]
+                                                               token:@"test"];
+    conn.apiClient = self.stubClient;
+    conn.pendingStrategyConfig = nil;
+    conn.deliveredAllStates = NO;
+    [conn setRegistriesLoaded:NO];
+
+    [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(entityDidUpdate:)
+                                                 name:HAConnectionManagerEntityDidUpdateNotification object:conn];
+}
+
+- (void)tearDown {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    HAConnectionManager *conn = [HAConnectionManager sharedManager];
+    [conn clearEntityStore];
+    conn.deliveredAllStates = NO;
+    conn.registriesStale = NO;
+    conn.registriesFetchedAt = nil;
+    conn.delegate = self.savedDelegate;
+    conn.apiClient = self.savedAPIClient;
+    [[HADashboardConfigCache sharedCache] clearCacheForDashboard:[HAAuthManager sharedManager].selectedDashboardPath];
+    [HACacheManager sharedManager].serverURL = self.savedServerURL;
+    [super tearDown];
+}
+
+- (void)entityDidUpdate:(NSNotification *)notification {
+    self.entityNotificationCount++;
+}
+
+#pragma mark - Helpers
+
+- (NSDictionary *)sensor:(NSUInteger)index state:(NSString *)state updated:(NSString *)lastUpdated {
+    return @{
+        @"entity_id": [NSString stringWithFormat:@"sensor.t_%lu", (unsigned long)index],
+        @"state": state,
+        @"attributes": @{},
+        @"last_changed": lastUpdated,
+        @"last_updated": lastUpdated,
+    };
+}
+
+- (NSMutableArray<NSDictionary *> *)sensorStates:(NSUInteger)count {
+    NSMutableArray *states = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        [states addObject:[self sensor:i state:@"20" updated:@"2026-03-17T02:41:00+00:00"]];
+    }
+    return states;
+}
+
+/// Deliver the first snapshot as a fresh launch would, then reset the recorder.
+- (void)connectWithStates:(NSArray *)states {
+    self.stubClient.states = states;
+    [[HAConnectionManager sharedManager] fetchAllStatesWithCompletion:nil];
+    XCTAssertEqual(self.recorder.allStatesCount, 1u);
+    self.recorder.allStatesCount = 0;
+    [self.recorder.updatedEntityIds removeAllObjects];
+    self.entityNotificationCount = 0;
+}
+
+- (void)resumeWithStates:(NSArray *)states {
+    self.stubClient.states = states;
+    [[HAConnectionManager sharedManager] fetchAllStatesWithCompletion:nil];
+}
+
+#pragma mark - States reconcile
+
+- (void)testUnchangedStatesAreSilent {
+    [self connectWithStates:[self sensorStates:5]];
+    [self resumeWithStates:[self sensorStates:5]];
+
+    XCTAssertEqual(self.recorder.allStatesCount, 0u);
+    XCTAssertEqual(self.recorder.updatedEntityIds.count, 0u);
+    XCTAssertEqual(self.entityNotificationCount, 0u);
+}
+
+- (void)testChangedEntityIsDeliveredOnItsOwn {
+    NSMutableArray *states = [self sensorStates:5];
+    [self connectWithStates:states];
+    HAEntity *before = [HAConnectionManager sharedManager].entityStore[@"sensor.t_2"];
+
+    states[2] = [self sensor:2 state:@"21" updated:@"2026-03-17T02:45:00+00:00"];
+    [self resumeWithStates:states];
+
+    XCTAssertEqual(self.recorder.allStatesCount, 0u);
+    XCTAssertEqualObjects(self.recorder.updatedEntityIds, @[@"sensor.t_2"]);
+    XCTAssertEqual(self.entityNotificationCount, 1u);
+    HAEntity *after = [HAConnectionManager sharedManager].entityStore[@"sensor.t_2"];
+    XCTAssertEqual(after, before, @"existing entities are updated in place");
+    XCTAssertEqualObjects(after.state, @"21");
+}
+
+- (void)testNewEntityFallsBackToFullRebuild {
+    NSMutableArray *states = [self sensorStates:5];
+    [self connectWithStates:states];
+
+    [states addObject:[self sensor:5 state:@"20" updated:@"2026-03-17T02:45:00+00:00"]];
+    [self resumeWithStates:states];
+
+    XCTAssertEqual(self.recorder.allStatesCount, 1u);
+    XCTAssertEqual(self.recorder.updatedEntityIds.count, 0u);
+    XCTAssertNotNil([HAConnectionManager sharedManager].entityStore[@"sensor.t_5"]);
+}
+
+- (void)testMissingEntityIsRemoved {
+    NSMutableArray *states = [self sensorStates:5];
+    [self connectWithStates:states];
+
+    [states removeLastObject];
+    [self resumeWithStates:states];
+
+    XCTAssertNil([HAConnectionManager sharedManager].entityStore[@"sensor.t_4"]);
+    XCTAssertEqual([HAConnectionManager sharedManager].entityStore.count, 4u);
+    XCTAssertEqual(self.recorder.allStatesCount, 1u);
+}
+
+- (void)testManyChangesFallBackToFullRebuild {
+    NSMutableArray *states = [self sensorStates:60];
+    [self connectWithStates:states];
+
+    for (NSUInteger i = 0; i < 51; i++) {
+        states[i] = [self sensor:i state:@"21" updated:@"2026-03-17T02:45:00+00:00"];
+    }
+    [self resumeWithStates:states];
+
+    XCTAssertEqual(self.recorder.allStatesCount, 1u);
+    XCTAssertEqual(self.recorder.updatedEntityIds.count, 0u);
+    XCTAssertEqual(self.entityNotificationCount, 0u);
+}
+
+- (void)testFiftyChangesStayIncremental {
+    NSMutableArray *states = [self sensorStates:60];
+    [self connectWithStates:states];
+
+    for (NSUInteger i = 0; i < 50; i++) {
+        states[i] = [self sensor:i state:@"21" updated:@"2026-03-17T02:45:00+00:00"];
+    }
+    [self resumeWithStates:states];
+
+    XCTAssertEqual(self.recorder.allStatesCount, 0u);
+    XCTAssertEqual(self.recorder.updatedEntityIds.count, 50u);
+}
+
+#pragma mark - Registries
+
+- (void)testRegistriesAreReusedWhileFresh {
+    HAConnectionManager *conn = [HAConnectionManager sharedManager];
+    [conn setRegistriesLoaded:YES];
+    conn.registriesStale = NO;
+    conn.registriesFetchedAt = [NSDate dateWithTimeIntervalSinceNow:-60];
+    XCTAssertTrue([conn canReuseRegistries]);
+
+    conn.registriesStale = YES;
+    XCTAssertFalse([conn canReuseRegistries], @"a *_registry_updated event forces a refetch");
+
+    conn.registriesStale = NO;
+    conn.registriesFetchedAt = [NSDate dateWithTimeIntervalSinceNow:-15 * 60 - 1];
+    XCTAssertFalse([conn canReuseRegistries], @"registries older than 15 minutes are refetched");
+
+    conn.registriesFetchedAt = nil;
+    XCTAssertFalse([conn canReuseRegistries]);
+
+    conn.registriesFetchedAt = [NSDate date];
+    [conn setRegistriesLoaded:NO];
+    XCTAssertFalse([conn canReuseRegistries]);
+}
+
+#pragma mark - Lovelace
+
+- (void)deliverLovelaceConfig:(NSDictionary *)config messageId:(NSInteger)messageId {
+    HAConnectionManager *conn = [HAConnectionManager sharedManager];
+    conn.lovelaceMessageId = messageId;
+    conn.lovelaceRequestedPath = [HAAuthManager sharedManager].selectedDashboardPath;
+    [conn webSocketClient:nil didReceiveMessage:@{@"type": @"result", @"id": @(messageId),
+                                                  @"success": @YES, @"result": config}];
+}
+
+- (void)testUnchangedLovelaceConfigIsNotReparsed {
+    HAConnectionManager *conn = [HAConnectionManager sharedManager];
+    NSDictionary *config = @{@"views": @[@{@"title": @"Home", @"cards": @[@{@"type": @"tile", @"entity": @"sensor.t_0"}]}]};
+
+    [self deliverLovelaceConfig:config messageId:9001];
+    XCTAssertEqual(self.recorder.lovelaceCount, 1u);
+    HALovelaceDashboard *parsed = conn.lovelaceDashboard;
+    XCTAssertNotNil(parsed);
+    XCTAssertEqualObjects(conn.parsedLovelaceKey, [HAAuthManager sharedManager].selectedDashboardPath ?: @"");
+
+    [self deliverLovelaceConfig:config messageId:9002];
+    XCTAssertEqual(self.recorder.lovelaceCount, 1u);
+    XCTAssertEqual(conn.lovelaceDashboard, parsed);
+
+    NSDictionary *edited = @{@"views": @[@{@"title": @"Home", @"cards": @[@{@"type": @"tile", @"entity": @"sensor.t_1"}]}]};
+    [self deliverLovelaceConfig:edited messageId:9003];
+    XCTAssertEqual(self.recorder.lovelaceCount, 2u);
+    XCTAssertNotEqual(conn.lovelaceDashboard, parsed);
+}
+
+- (void)testLovelaceConfigIsReparsedWithoutParsedKey {
+    HAConnectionManager *conn = [HAConnectionManager sharedManager];
+    NSDictionary *config = @{@"views": @[@{@"title": @"Home", @"cards": @[]}]};
+
+    [self deliverLovelaceConfig:config messageId:9011];
+    conn.parsedLovelaceKey = nil; // e.g. a strategy dashboard was shown in between
+    [self deliverLovelaceConfig:config messageId:9012];
+    XCTAssertEqual(self.recorder.lovelaceCount, 2u);
+}
+
+@end
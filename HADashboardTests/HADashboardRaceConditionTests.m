@@ -3,6 +3,10 @@
 #import "HAConnectionManager.h"
 #import "HALovelaceParser.h"
 #import "HAEntity.h"
+#import "HACacheManager.h"
+#import "HADashboardConfig.h"
+#import "HADashboardConfigCache.h"
+#import "HAAuthManager.h"
 
 // -----------------------------------------------------------------------
 // Expose private properties for testing.
@@ -14,9 +18,12 @@
 @property (nonatomic, assign) BOOL lovelaceFetchDone;
 @property (nonatomic, strong) HALovelaceDashboard *lovelaceDashboard;
 @property (nonatomic, strong) UICollectionView *collectionView;
+@property (nonatomic, strong) HADashboardConfig *dashboardConfig;
+@property (nonatomic, assign) NSUInteger selectedViewIndex;
 
 - (void)rebuildDashboard;
 - (void)showLoading:(BOOL)loading message:(NSString *)message;
+- (void)connectionManager:(HAConnectionManager *)manager didReceiveLovelaceDashboard:(HALovelaceDashboard *)dashboard;
 @end
 
 @interface HAConnectionManager (TestAccess)
@@ -200,4 +207,72 @@
                    @"Workaround path (cached dashboard from Settings visit) should render.");
 }
 
+#pragma mark - Dashboard Switching
+
+- (HALovelaceDashboard *)twoViewDashboardWithSecondCardType:(NSString *)type firstTitle:(NSString *)title {
+    return [HALovelaceParser parseDashboardFromDictionary:@{
+        @"views": @[
+            @{@"title": title, @"cards": @[@{@"type": @"entities", @"entities": @[@"light.test_0"]}]},
+            @{@"title": @"Other", @"cards": @[@{@"type": type, @"entity": @"light.test_1"}]},
+        ]
+    }];
+}
+
+- (void)testViewLayoutEquality {
+    HALovelaceDashboard *a = [self twoViewDashboardWithSecondCardType:@"tile" firstTitle:@"Home"];
+    HALovelaceDashboard *b = [self twoViewDashboardWithSecondCardType:@"button" firstTitle:@"Renamed"];
+    XCTAssertTrue([a.views[0] isLayoutEqualToView:b.views[0]], @"Title alone doesn't change the layout");
+    XCTAssertFalse([a.views[1] isLayoutEqualToView:b.views[1]]);
+    XCTAssertFalse([a.views[0] isLayoutEqualToView:nil]);
+}
+
+/// A revalidated config that only touches another view keeps the visible layout.
+- (void)testRevalidationOutsideVisibleViewSkipsRebuild {
+    [self populateEntityStore:2];
+    HAConnectionManager *conn = [HAConnectionManager sharedManager];
+    self.dashVC.statesLoaded = YES;
+
+    [self.dashVC connectionManager:conn didReceiveLovelaceDashboard:[self twoViewDashboardWithSecondCardType:@"tile" firstTitle:@"Home"]];
+    HADashboardConfig *shown = self.dashVC.dashboardConfig;
+    XCTAssertNotNil(shown);
+
+    [self.dashVC connectionManager:conn didReceiveLovelaceDashboard:[self twoViewDashboardWithSecondCardType:@"button" firstTitle:@"Home"]];
+    XCTAssertEqual(self.dashVC.dashboardConfig, shown, @"Visible view unchanged: no rebuild");
+    XCTAssertEqualObjects([self.dashVC.lovelaceDashboard viewAtIndex:1].rawCards[0][@"type"], @"button");
+
+    self.dashVC.selectedViewIndex = 1;
+    [self.dashVC rebuildDashboard];
+    shown = self.dashVC.dashboardConfig;
+    [self.dashVC connectionManager:conn didReceiveLovelaceDashboard:[self twoViewDashboardWithSecondCardType:@"tile" firstTitle:@"Home"]];
+    XCTAssertNotEqual(self.dashVC.dashboardConfig, shown, @"Visible view changed: rebuilt");
+    XCTAssertEqual(self.dashVC.selectedViewIndex, 1u, @"Refresh keeps the selected view");
+}
+
+/// Switching to a dashboard with a cached config delivers it synchronously.
+- (void)testSwitchDeliversCachedConfigImmediately {
+    HAAuthManager *auth = [HAAuthManager sharedManager];
+    if (auth.isDemoMode) return;
+    [HACacheManager sharedManager].serverURL = @"http://switch-test.local:8123";
+    NSDictionary *config = @{@"views": @[@{@"title": @"Cached", @"cards": @[]}]};
+    HADashboardConfigCache *cache = [HADashboardConfigCache sharedCache];
+    [cache cacheConfig:config forDashboard:@"switch-test"];
+
+    XCTestExpectation *written = [self expectationWithDescription:@"write"];
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(1.0 * NSEC_PER_SEC)),
+                   dispatch_get_main_queue(), ^{ [written fulfill]; });
+    [self waitForExpectationsWithTimeout:3 handler:nil];
+
+    __block HALovelaceDashboard *delivered = nil;
+    id observer = [[NSNotificationCenter defaultCenter]
+        addObserverForName:HAConnectionManagerDidReceiveLovelaceNotification object:nil queue:nil
+                usingBlock:^(NSNotification *note) { delivered = note.userInfo[@"dashboard"]; }];
+    BOOL shown = [[HAConnectionManager sharedManager] switchToLovelaceDashboard:@"switch-test"];
+    [[NSNotificationCenter defaultCenter] removeObserver:observer];
+
+    XCTAssertTrue(shown);
+    XCTAssertEqualObjects(delivered.views.firstObject.title, @"Cached");
+    XCTAssertFalse([[HAConnectionManager sharedManager] switchToLovelaceDashboard:@"never-cached"]);
+    [[HACacheManager sharedManager] clearAllCaches];
+}
+
 @end
@@ -0,0 +1,82 @@
+#import <XCTest/XCTest.h>
+#import "HADashboardViewStateCache.h"
+
+@interface HADashboardViewStateCacheTests : XCTestCase
+@end
+
+@implementation HADashboardViewStateCacheTests
+
+- (HADashboardViewState *)stateForView:(NSUInteger)viewIndex {
+    HADashboardViewState *state = [[HADashboardViewState alloc] init];
+    state.viewIndex = viewIndex;
+    state.width = 768;
+    state.entityToIndexPaths = @{
+        @"light.kitchen": @[[NSIndexPath indexPathForItem:0 inSection:0]],
+        @"sensor.power": @[[NSIndexPath indexPathForItem:1 inSection:0]],
+    };
+    state.conditionEntityIds = [NSSet setWithObject:@"input_boolean.guest_mode"];
+    return state;
+}
+
+#pragma mark - LRU
+
+- (void)testEvictsLeastRecentlyUsed {
+    HADashboardViewStateCache *cache = [[HADashboardViewStateCache alloc] initWithCapacity:2];
+    [cache storeState:[self stateForView:0]];
+    [cache storeState:[self stateForView:1]];
+    XCTAssertNotNil([cache stateForViewIndex:0 width:768]); // 0 is now most recent
+    [cache storeState:[self stateForView:2]];
+
+    XCTAssertEqual(cache.count, 2u);
+    XCTAssertNil([cache stateForViewIndex:1 width:768]);
+    XCTAssertNotNil([cache stateForViewIndex:0 width:768]);
+    XCTAssertNotNil([cache stateForViewIndex:2 width:768]);
+}
+
+- (void)testStoringSameViewReplacesIt {
+    HADashboardViewStateCache *cache = [[HADashboardViewStateCache alloc] initWithCapacity:2];
+    [cache storeState:[self stateForView:0]];
+    HADashboardViewState *newer = [self stateForView:0];
+    [cache storeState:newer];
+    XCTAssertEqual(cache.count, 1u);
+    XCTAssertEqual([cache stateForViewIndex:0 width:768], newer);
+}
+
+- (void)testWidthChangeMisses {
+    HADashboardViewStateCache *cache = [[HADashboardViewStateCache alloc] initWithCapacity:2];
+    [cache storeState:[self stateForView:0]];
+    XCTAssertNil([cache stateForViewIndex:0 width:1024]);
+    XCTAssertEqual(cache.count, 0u, @"A state built for another width is dropped");
+}
+
+#pragma mark - Entity Updates
+
+- (void)testConditionEntityMarksDirty {
+    HADashboardViewStateCache *cache = [[HADashboardViewStateCache alloc] initWithCapacity:2];
+    [cache storeState:[self stateForView:0]];
+    [cache entityDidUpdate:@"light.kitchen"];
+    XCTAssertNotNil([cache stateForViewIndex:0 width:768], @"Plain entity updates keep the state");
+
+    [cache entityDidUpdate:@"input_boolean.guest_mode"];
+    XCTAssertNil([cache stateForViewIndex:0 width:768], @"Visibility may have changed: rebuild");
+}
+
+- (void)testEntityUpdateForgetsItsHeights {
+    HADashboardViewState *state = [self stateForView:0];
+    NSIndexPath *kitchen = [NSIndexPath indexPathForItem:0 inSection:0];
+    NSIndexPath *power = [NSIndexPath indexPathForItem:1 inSection:0];
+    [state setHeight:120 forItemAtIndexPath:kitchen itemWidth:300];
+    [state setHeight:140 forItemAtIndexPath:kitchen itemWidth:400];
+    [state setHeight:90 forItemAtIndexPath:power itemWidth:300];
+    XCTAssertEqual([state heightForItemAtIndexPath:kitchen itemWidth:400], 140);
+
+    [state entityDidUpdate:@"light.kitchen"];
+    XCTAssertEqual([state heightForItemAtIndexPath:kitchen itemWidth:300], 0);
+    XCTAssertEqual([state heightForItemAtIndexPath:kitchen itemWidth:400], 0);
+    XCTAssertEqual([state heightForItemAtIndexPath:power itemWidth:300], 90);
+
+    [state removeAllHeights];
+    XCTAssertEqual([state heightForItemAtIndexPath:power itemWidth:300], 0);
+}
+
+@end
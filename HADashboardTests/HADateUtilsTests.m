@@ -0,0 +1,57 @@
+#import <XCTest/XCTest.h>
+#import "HADateUtils.h"
+
+@interface HADateUtilsTests : XCTestCase
+@end
+
+@implementation HADateUtilsTests
+
+- (NSTimeInterval)timeFrom:(NSString *)string {
+    NSTimeInterval time = -1;
+    XCTAssertTrue([HADateUtils getTimeInterval:&time fromISO8601String:string], @"%@", string);
+    return time;
+}
+
+#pragma mark - Fast path
+
+- (void)testHATimestampWithMicroseconds {
+    XCTAssertEqualWithAccuracy([self timeFrom:@"2026-10-19T08:15:42.123456+00:00"], 1792397742.123456, 1e-6);
+}
+
+- (void)testFractionsAndOffsets {
+    XCTAssertEqual([self timeFrom:@"1970-01-01T00:00:00Z"], 0);
+    XCTAssertEqualWithAccuracy([self timeFrom:@"2000-03-01T00:00:00.5Z"], 951868800.5, 1e-9);
+    XCTAssertEqualWithAccuracy([self timeFrom:@"2026-10-19T08:15:42.123+00:00"], 1792397742.123, 1e-6);
+    XCTAssertEqual([self timeFrom:@"2024-02-29T12:00:00-05:30"], 1709227800);
+    XCTAssertEqual([self timeFrom:@"2026-10-19 08:15:42+0200"], 1792390542);
+}
+
+- (void)testDateMatchesTimeInterval {
+    NSDate *date = [HADateUtils dateFromISO8601String:@"2026-10-19T08:15:42+00:00"];
+    XCTAssertEqual([date timeIntervalSince1970], 1792397742);
+}
+
+#pragma mark - Rejection and fallback
+
+- (void)testInvalidDatesAreRejected {
+    NSTimeInterval time = -1;
+    XCTAssertFalse([HADateUtils getTimeInterval:&time fromISO8601String:@"2023-02-29T12:00:00Z"]);
+    XCTAssertFalse([HADateUtils getTimeInterval:&time fromISO8601String:@"2026-13-01T00:00:00Z"]);
+    XCTAssertFalse([HADateUtils getTimeInterval:&time fromISO8601String:@"2026-10-19T08:15:42.+00:00"]);
+    XCTAssertFalse([HADateUtils getTimeInterval:&time fromISO8601String:@"unknown"]);
+    XCTAssertFalse([HADateUtils getTimeInterval:&time fromISO8601String:@""]);
+    XCTAssertFalse([HADateUtils getTimeInterval:&time fromISO8601String:(NSString *)@42]);
+    XCTAssertEqual(time, -1);
+    XCTAssertNil([HADateUtils dateFromISO8601String:nil]);
+}
+
+- (void)testTimestampWithoutTimezoneIsLocalTime {
+    NSDate *date = [HADateUtils dateFromISO8601String:@"2026-10-19T08:15:42"];
+    XCTAssertNotNil(date);
+    NSDateComponents *components = [[NSCalendar currentCalendar] components:NSCalendarUnitHour | NSCalendarUnitMinute
+                                                                   fromDate:date];
+    XCTAssertEqual(components.hour, 8);
+    XCTAssertEqual(components.minute, 15);
+}
+
+@end
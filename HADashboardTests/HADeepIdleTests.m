@@ -0,0 +1,99 @@
+#import <XCTest/XCTest.h>
+#import "HAProximityWakeController.h"
+#import "HAConnectionManager.h"
+#import "HAEntity.h"
+
+@interface HADeepIdleTests : XCTestCase
+@end
+
+@implementation HADeepIdleTests
+
+- (HAEntity *)entity:(NSString *)entityId state:(NSString *)state deviceClass:(NSString *)deviceClass {
+    NSDictionary *attributes = deviceClass ? @{@"device_class": deviceClass} : @{};
+    return [[HAEntity alloc] initWithDictionary:@{
+        @"entity_id": entityId, @"state": state, @"attributes": attributes
+    }];
+}
+
+#pragma mark - Wake Entities
+
+- (void)testWakeRelevantDomains {
+    XCTAssertTrue([HAProximityWakeController isWakeRelevantEntity:
+                   [self entity:@"alarm_control_panel.home" state:@"disarmed" deviceClass:nil]]);
+    XCTAssertTrue([HAProximityWakeController isWakeRelevantEntity:
+                   [self entity:@"lock.front_door" state:@"locked" deviceClass:nil]]);
+    XCTAssertTrue([HAProximityWakeController isWakeRelevantEntity:
+                   [self entity:@"event.doorbell" state:@"2026-01-01T00:00:00+00:00" deviceClass:@"doorbell"]]);
+    XCTAssertFalse([HAProximityWakeController isWakeRelevantEntity:
+                    [self entity:@"sensor.power" state:@"250" deviceClass:@"power"]]);
+    XCTAssertFalse([HAProximityWakeController isWakeRelevantEntity:
+                    [self entity:@"light.kitchen" state:@"on" deviceClass:nil]]);
+}
+
+- (void)testBinarySensorsByDeviceClass {
+    XCTAssertTrue([HAProximityWakeController isWakeRelevantEntity:
+                   [self entity:@"binary_sensor.hall_motion" state:@"off" deviceClass:@"motion"]]);
+    XCTAssertTrue([HAProximityWakeController isWakeRelevantEntity:
+                   [self entity:@"binary_sensor.smoke" state:@"off" deviceClass:@"smoke"]]);
+    XCTAssertFalse([HAProximityWakeController isWakeRelevantEntity:
+                    [self entity:@"binary_sensor.battery_low" state:@"off" deviceClass:@"battery"]]);
+    XCTAssertFalse([HAProximityWakeController isWakeRelevantEntity:
+                    [self entity:@"binary_sensor.update" state:@"off" deviceClass:nil]]);
+}
+
+- (void)testOnlyActivatingChangesWakeTheScreen {
+    XCTAssertTrue([HAProximityWakeController entityStateShouldWakeScreen:
+                   [self entity:@"binary_sensor.hall_motion" state:@"on" deviceClass:@"motion"]]);
+    XCTAssertFalse([HAProximityWakeController entityStateShouldWakeScreen:
+                    [self entity:@"binary_sensor.hall_motion" state:@"off" deviceClass:@"motion"]]);
+    XCTAssertFalse([HAProximityWakeController entityStateShouldWakeScreen:
+                    [self entity:@"lock.front_door" state:@"unavailable" deviceClass:nil]]);
+    XCTAssertTrue([HAProximityWakeController entityStateShouldWakeScreen:
+                   [self entity:@"lock.front_door" state:@"unlocked" deviceClass:nil]]);
+}
+
+- (void)testLocksAndAlarmsWakeOnlyOnAttentionStates {
+    XCTAssertTrue([HAProximityWakeController entityStateShouldWakeScreen:
+                   [self entity:@"lock.front_door" state:@"jammed" deviceClass:nil]]);
+    XCTAssertFalse([HAProximityWakeController entityStateShouldWakeScreen:
+                    [self entity:@"lock.front_door" state:@"locked" deviceClass:nil]]);
+    XCTAssertTrue([HAProximityWakeController entityStateShouldWakeScreen:
+                   [self entity:@"alarm_control_panel.home" state:@"triggered" deviceClass:nil]]);
+    XCTAssertTrue([HAProximityWakeController entityStateShouldWakeScreen:
+                   [self entity:@"alarm_control_panel.home" state:@"pending" deviceClass:nil]]);
+    XCTAssertFalse([HAProximityWakeController entityStateShouldWakeScreen:
+                    [self entity:@"alarm_control_panel.home" state:@"disarmed" deviceClass:nil]]);
+    XCTAssertFalse([HAProximityWakeController entityStateShouldWakeScreen:
+                    [self entity:@"alarm_control_panel.home" state:@"armed_away" deviceClass:nil]]);
+}
+
+#pragma mark - Connection
+
+- (void)testEnterAndExitWhileDisconnected {
+    HAConnectionManager *conn = [HAConnectionManager sharedManager];
+    XCTAssertFalse(conn.isDeepIdle);
+
+    [conn enterDeepIdleWithWakeEntityIds:[NSSet setWithObject:@"lock.front_door"]];
+    XCTAssertTrue(conn.isDeepIdle);
+    // Retargeting while idle stays idle
+    [conn enterDeepIdleWithWakeEntityIds:[NSSet set]];
+    XCTAssertTrue(conn.isDeepIdle);
+
+    XCTestExpectation *exited = [self expectationWithDescription:@"exit completion"];
+    [conn exitDeepIdleWithCompletion:^{
+        XCTAssertTrue([NSThread isMainThread]);
+        [exited fulfill];
+    }];
+    XCTAssertFalse(conn.isDeepIdle);
+    [self waitForExpectationsWithTimeout:2.0 handler:nil];
+}
+
+- (void)testExitWhenNotIdleStillCompletes {
+    XCTestExpectation *exited = [self expectationWithDescription:@"exit completion"];
+    [[HAConnectionManager sharedManager] exitDeepIdleWithCompletion:^{
+        [exited fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:2.0 handler:nil];
+}
+
+@end
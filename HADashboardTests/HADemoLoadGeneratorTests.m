@@ -0,0 +1,73 @@
+#import <XCTest/XCTest.h>
+#import "HADemoLoadGenerator.h"
+
+@interface HADemoLoadGeneratorTests : XCTestCase
+@end
+
+@implementation HADemoLoadGeneratorTests
+
+- (HADemoLoadProfile *)profile {
+    HADemoLoadProfile *profile = [HADemoLoadProfile defaultProfile];
+    profile.entityCount = 200;
+    profile.viewCount = 4;
+    profile.cardsPerView = 25;
+    profile.seed = 42;
+    return profile;
+}
+
+- (void)testInitialStatesCoverEveryEntity {
+    HADemoLoadGenerator *gen = [[HADemoLoadGenerator alloc] initWithProfile:[self profile]];
+    NSDictionary *states = [gen initialStates];
+    XCTAssertEqual(states.count, 200u);
+    NSDictionary *state = states[@"sensor.stress_0000"];
+    XCTAssertEqualObjects(state[@"entity_id"], @"sensor.stress_0000");
+    XCTAssertNotNil(state[@"attributes"][@"unit_of_measurement"]);
+}
+
+- (void)testLovelaceConfigHasRequestedShape {
+    HADemoLoadGenerator *gen = [[HADemoLoadGenerator alloc] initWithProfile:[self profile]];
+    NSDictionary *config = [gen lovelaceConfig];
+    NSArray *views = config[@"views"];
+    XCTAssertEqual(views.count, 4u);
+    NSMutableSet *types = [NSMutableSet set];
+    for (NSDictionary *view in views) {
+        XCTAssertEqual([view[@"cards"] count], 25u);
+        for (NSDictionary *card in view[@"cards"]) [types addObject:card[@"type"]];
+    }
+    XCTAssertTrue([types containsObject:@"tile"]);
+    XCTAssertTrue([types containsObject:@"entities"]);
+    XCTAssertTrue([types containsObject:@"thermostat"]);
+}
+
+- (void)testMessagesMatchStateChangedFormatAndAreDeterministic {
+    HADemoLoadGenerator *a = [[HADemoLoadGenerator alloc] initWithProfile:[self profile]];
+    HADemoLoadGenerator *b = [[HADemoLoadGenerator alloc] initWithProfile:[self profile]];
+    for (int n = 0; n < 50; n++) {
+        NSDictionary *ma = [a nextStateChangedMessage];
+        NSDictionary *mb = [b nextStateChangedMessage];
+        XCTAssertEqualObjects(ma[@"type"], @"event");
+        XCTAssertEqualObjects(ma[@"event"][@"event_type"], @"state_changed");
+        NSDictionary *data = ma[@"event"][@"data"];
+        XCTAssertEqualObjects(data[@"new_state"][@"entity_id"], data[@"entity_id"]);
+        XCTAssertNotNil(data[@"old_state"]);
+        XCTAssertEqualObjects(data[@"entity_id"], mb[@"event"][@"data"][@"entity_id"]);
+        XCTAssertEqualObjects(data[@"new_state"][@"state"], mb[@"event"][@"data"][@"new_state"][@"state"]);
+    }
+}
+
+- (void)testStreamDeliversAtConfiguredRate {
+    HADemoLoadProfile *profile = [self profile];
+    profile.updatesPerSecond = 100;
+    HADemoLoadGenerator *gen = [[HADemoLoadGenerator alloc] initWithProfile:profile];
+    __block NSUInteger received = 0;
+    [gen startWithMessageHandler:^(NSDictionary *message) {
+        received++;
+    }];
+    [[NSRunLoop mainRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:1.0]];
+    [gen stop];
+    XCTAssertGreaterThan(received, 60u);
+    XCTAssertLessThan(received, 140u);
+    XCTAssertEqual(gen.deliveredCount, received);
+}
+
+@end
@@ -0,0 +1,285 @@
+#import <XCTest/XCTest.h>
+#import "HAAuthManager.h"
+#import "HAAPIClient.h"
+#import "HACacheManager.h"
+#import "HAConnectionManager.h"
+#import "HADashboardViewController.h"
+#import "HAHistoryManager.h"
+#import "HAMJPEGStreamParser.h"
+#import "HAStatisticsManager.h"
+
+// -----------------------------------------------------------------------
+// End-to-end performance against the local Home Assistant stand-in
+// (scripts/ha-standin.mjs). Everything runs through the real networking
+// stack: SocketRocket, NSURLSession, parsing, entity store, dashboard.
+//
+// Skipped unless HA_STANDIN_URL is set in the test environment.
+// scripts/test-performance.sh starts the stand-in and passes it in;
+// stand-in flags after the script name (e.g. --latency 40) shape the link.
+// -----------------------------------------------------------------------
+
+static NSString *const kDefaultStandinToken = @"standin-token";
+static const NSTimeInterval kStandinTimeout = 30.0;
+static const NSUInteger kBurstSize = 1000;
+static const NSUInteger kHistoryEntityLimit = 8;
+static const NSUInteger kCameraFrameCount = 10;
+
+@interface HADashboardViewController (PerfTestAccess)
+@property (nonatomic, strong) UICollectionView *collectionView;
+@end
+
+@interface HAEndToEndPerformanceTests : XCTestCase
+@property (nonatomic, copy) NSString *standinURL;
+@property (nonatomic, copy) NSString *standinToken;
+@property (nonatomic, strong) UIWindow *window;
+@end
+
+@implementation HAEndToEndPerformanceTests
+
+- (void)setUp {
+    [super setUp];
+    NSDictionary *env = [NSProcessInfo processInfo].environment;
+    self.standinURL = env[@"HA_STANDIN_URL"];
+    self.standinToken = env[@"HA_STANDIN_TOKEN"] ?: kDefaultStandinToken;
+    XCTSkipUnless(self.standinURL.length > 0, @"HA_STANDIN_URL not set — run scripts/test-performance.sh");
+
+    HAAuthManager *auth = [HAAuthManager sharedManager];
+    [auth setDemoMode:NO];
+    [auth saveSelectedDashboardPath:nil];
+    [auth saveServerURL:self.standinURL token:self.standinToken];
+    [self resetClientState];
+}
+
+- (void)tearDown {
+    [self closeDashboard];
+    [self resetClientState];
+    [[HAAuthManager sharedManager] clearCredentials];
+    [super tearDown];
+}
+
+#pragma mark - Helpers
+
+/// Cold start: no socket, nothing in memory, nothing on disk.
+- (void)resetClientState {
+    HAConnectionManager *conn = [HAConnectionManager sharedManager];
+    [conn disconnect];
+    [conn clearEntityStore];
+    [[HAHistoryManager sharedManager] clearCache];
+    [[HAStatisticsManager sharedManager] clearCache];
+    [[HACacheManager sharedManager] clearAllCaches];
+}
+
+/// Run the main run loop until condition holds. NO on timeout.
+- (BOOL)runUntil:(BOOL (^)(void))condition timeout:(NSTimeInterval)timeout {
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:timeout];
+    while (!condition()) {
+        if (deadline.timeIntervalSinceNow <= 0) return NO;
+        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode
+                                 beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.005]];
+    }
+    return YES;
+}
+
+/// Put a fresh dashboard on screen (which connects) and wait for its first
+/// cells. Returns the dashboard, or nil if nothing rendered in time.
+- (HADashboardViewController *)presentDashboardAndWaitForFirstRender {
+    HADashboardViewController *dashboard = [[HADashboardViewController alloc] init];
+    self.window = [[UIWindow alloc] initWithFrame:CGRectMake(0, 0, 1024, 768)];
+    self.window.rootViewController = [[UINavigationController alloc] initWithRootViewController:dashboard];
+    [self.window makeKeyAndVisible];
+
+    BOOL rendered = [self runUntil:^BOOL{
+        UICollectionView *collectionView = dashboard.collectionView;
+        return !collectionView.hidden && collectionView.visibleCells.count > 0;
+    } timeout:kStandinTimeout];
+    return rendered ? dashboard : nil;
+}
+
+- (void)closeDashboard {
+    self.window.hidden = YES;
+    self.window.rootViewController = nil;
+    self.window = nil;
+}
+
+/// Entity states straight from the stand-in's /api/states.
+- (NSArray<NSDictionary *> *)fetchStates {
+    HAAPIClient *client = [[HAAPIClient alloc] initWithBaseURL:[HAAuthManager sharedManager].restBaseURL
+                                                         token:self.standinToken];
+    __block NSArray *states = nil;
+    __block BOOL done = NO;
+    [client getStatesWithCompletion:^(id response, NSError *error) {
+        XCTAssertNil(error);
+        if ([response isKindOfClass:[NSArray class]]) states = response;
+        done = YES;
+    }];
+    XCTAssertTrue([self runUntil:^BOOL{ return done; } timeout:kStandinTimeout]);
+    return states ?: @[];
+}
+
+- (NSArray<NSString *> *)entityIdsWithPrefix:(NSString *)prefix numeric:(BOOL)numeric limit:(NSUInteger)limit {
+    NSMutableArray<NSString *> *ids = [NSMutableArray array];
+    NSCharacterSet *nonNumeric = [[NSCharacterSet characterSetWithCharactersInString:@"-.0123456789"] invertedSet];
+    for (NSDictionary *state in [self fetchStates]) {
+        NSString *entityId = state[@"entity_id"];
+        NSString *value = state[@"state"];
+        if (![entityId isKindOfClass:[NSString class]] || ![entityId hasPrefix:prefix]) continue;
+        if (numeric && (![value isKindOfClass:[NSString class]] || value.length == 0 ||
+                        [value rangeOfCharacterFromSet:nonNumeric].location != NSNotFound)) continue;
+        [ids addObject:entityId];
+        if (ids.count == limit) break;
+    }
+    return ids;
+}
+
+#pragma mark - Connect to First Render
+
+/// Dashboard appears with an empty cache → WebSocket auth → lovelace/config
+/// and /api/states → first cells on screen.
+- (void)testConnectToFirstRender {
+    [self measureMetrics:@[XCTPerformanceMetric_WallClockTime] automaticallyStartMeasuring:NO forBlock:^{
+        [self closeDashboard];
+        [self resetClientState];
+
+        [self startMeasuring];
+        HADashboardViewController *dashboard = [self presentDashboardAndWaitForFirstRender];
+        [self stopMeasuring];
+
+        XCTAssertNotNil(dashboard, @"Dashboard did not render within %.0f s", kStandinTimeout);
+    }];
+}
+
+#pragma mark - Update Throughput
+
+/// The stand-in sends kBurstSize state_changed events back to back, then
+/// the result. Results and events share the socket, so by the time the
+/// result arrives every event has been applied to the store and the
+/// on-screen dashboard.
+- (void)testStateUpdateThroughput {
+    XCTAssertNotNil([self presentDashboardAndWaitForFirstRender]);
+    HAConnectionManager *conn = [HAConnectionManager sharedManager];
+
+    [self measureBlock:^{
+        __block NSUInteger updates = 0;
+        __block BOOL acknowledged = NO;
+        id observer = [[NSNotificationCenter defaultCenter]
+            addObserverForName:HAConnectionManagerEntityDidUpdateNotification
+                        object:conn
+                         queue:nil
+                    usingBlock:^(NSNotification *note) {
+            updates++;
+        }];
+
+        [conn sendCommand:@{@"type": @"standin/burst", @"count": @(kBurstSize)}
+                 priority:HACommandPriorityNormal
+                  timeout:kStandinTimeout
+               completion:^(id result, NSError *error) {
+            XCTAssertNil(error);
+            acknowledged = YES;
+        }];
+        XCTAssertTrue([self runUntil:^BOOL{ return acknowledged; } timeout:kStandinTimeout]);
+        // Let the coalesced cell reloads for the burst land
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.05]];
+
+        [[NSNotificationCenter defaultCenter] removeObserver:observer];
+        XCTAssertEqual(updates, kBurstSize);
+    }];
+}
+
+#pragma mark - History Load
+
+/// A week of history for several sensors at once, as a screen of graph
+/// cards would request it. The history cache is cleared every iteration.
+- (void)testHistoryLoad {
+    NSArray<NSString *> *sensors = [self entityIdsWithPrefix:@"sensor." numeric:YES limit:kHistoryEntityLimit];
+    XCTAssertGreaterThan(sensors.count, 0u, @"Stand-in has no numeric sensors");
+    NSDate *end = [NSDate date];
+    NSDate *start = [end dateByAddingTimeInterval:-7 * 86400];
+
+    [self measureBlock:^{
+        HAHistoryManager *history = [HAHistoryManager sharedManager];
+        [history clearCache];
+
+        __block NSUInteger pending = sensors.count;
+        __block NSUInteger points = 0;
+        for (NSString *entityId in sensors) {
+            [history fetchHistoryForEntityId:entityId
+                                   startDate:start
+                                     endDate:end
+                                   maxPoints:500
+                                  completion:^(NSArray *result, NSError *error) {
+                XCTAssertNil(error, @"%@", entityId);
+                points += result.count;
+                pending--;
+            }];
+        }
+        XCTAssertTrue([self runUntil:^BOOL{ return pending == 0; } timeout:kStandinTimeout]);
+        XCTAssertGreaterThan(points, 0u);
+    }];
+}
+
+#pragma mark - Statistics Load
+
+/// The same sensors over 30 days as hourly long-term statistics, as a
+/// statistics-graph card requests them: one WebSocket command, cache cleared
+/// every iteration. Compare with testHistoryLoad's one week of raw history.
+- (void)testStatisticsLoad {
+    XCTAssertNotNil([self presentDashboardAndWaitForFirstRender]);
+    NSArray<NSString *> *sensors = [self entityIdsWithPrefix:@"sensor." numeric:YES limit:kHistoryEntityLimit];
+    XCTAssertGreaterThan(sensors.count, 0u, @"Stand-in has no numeric sensors");
+    NSDate *end = [NSDate date];
+    NSDate *start = [end dateByAddingTimeInterval:-30 * 86400];
+
+    [self measureBlock:^{
+        HAStatisticsManager *statistics = [HAStatisticsManager sharedManager];
+        [statistics clearCache];
+
+        __block BOOL done = NO;
+        __block NSUInteger rows = 0;
+        [statistics fetchStatisticsForIds:sensors
+                                startDate:start
+                                  endDate:end
+                                   period:HAStatisticsPeriodHour
+                                    types:@[HAStatisticTypeMean]
+                               completion:^(NSDictionary *result, NSError *error) {
+            XCTAssertNil(error);
+            for (NSArray *series in result.allValues) rows += series.count;
+            done = YES;
+        }];
+        XCTAssertTrue([self runUntil:^BOOL{ return done; } timeout:kStandinTimeout]);
+        XCTAssertGreaterThan(rows, 0u);
+    }];
+}
+
+#pragma mark - Camera Stream
+
+/// Time from opening camera_proxy_stream to kCameraFrameCount decoded
+/// frames. Bounded below by the stand-in's --camera-fps.
+- (void)testCameraStreamFrames {
+    NSString *camera = [self entityIdsWithPrefix:@"camera." numeric:NO limit:1].firstObject;
+    XCTAssertNotNil(camera, @"Stand-in has no camera");
+    if (!camera) return;
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"%@/api/camera_proxy_stream/%@",
+                                       [HAAuthManager sharedManager].serverURL, camera]];
+
+    [self measureBlock:^{
+        HAMJPEGStreamParser *parser = [[HAMJPEGStreamParser alloc] init];
+        __block NSUInteger frames = 0;
+        __block NSError *streamError = nil;
+        parser.frameHandler = ^(UIImage *frame) {
+            frames++;
+        };
+        parser.errorHandler = ^(NSError *error) {
+            streamError = error;
+        };
+        [parser startWithURL:url authToken:self.standinToken];
+        BOOL received = [self runUntil:^BOOL{
+            return frames >= kCameraFrameCount || streamError != nil;
+        } timeout:kStandinTimeout];
+        [parser stop];
+
+        XCTAssertNil(streamError);
+        XCTAssertTrue(received);
+    }];
+}
+
+@end
@@ -0,0 +1,78 @@
+#import <XCTest/XCTest.h>
+#import "HAEntityCellFactory.h"
+#import "HADashboardConfig.h"
+#import "HAEntity.h"
+#import "HATileEntityCell.h"
+#import "HAEntitiesCardCell.h"
+#import "HAClimateEntityCell.h"
+#import "HABaseEntityCell.h"
+
+@interface HAEntityCellFactoryTests : XCTestCase
+@end
+
+@implementation HAEntityCellFactoryTests
+
+- (HAEntity *)entityWithId:(NSString *)entityId {
+    return [[HAEntity alloc] initWithDictionary:@{@"entity_id": entityId, @"state": @"on", @"attributes": @{}}];
+}
+
+- (HADashboardConfigItem *)itemWithEntityId:(NSString *)entityId cardType:(NSString *)cardType {
+    HADashboardConfigItem *item = [[HADashboardConfigItem alloc] init];
+    item.entityId = entityId;
+    item.cardType = cardType;
+    return item;
+}
+
+- (void)testDescriptorMatchesReuseIdentifier {
+    HAEntity *entity = [self entityWithId:@"light.kitchen"];
+    HADashboardConfigItem *item = [self itemWithEntityId:@"light.kitchen" cardType:@"tile"];
+    HACellDescriptor *descriptor = [HAEntityCellFactory descriptorForItem:item entity:entity];
+
+    XCTAssertEqualObjects(descriptor.reuseIdentifier, [HAEntityCellFactory reuseIdentifierForEntity:entity cardType:@"tile"]);
+    XCTAssertEqual(descriptor.cellClass, [HATileEntityCell class]);
+    XCTAssertEqual(descriptor.heightStrategy, HACellHeightStrategyTile);
+    XCTAssertEqualObjects(descriptor.entityIds, @[@"light.kitchen"]);
+    XCTAssertTrue(descriptor.liveUpdating);
+}
+
+- (void)testDescriptorIsStoredUntilConfigChanges {
+    HAEntity *entity = [self entityWithId:@"climate.hall"];
+    HADashboardConfigItem *item = [self itemWithEntityId:@"climate.hall" cardType:nil];
+    HACellDescriptor *descriptor = [HAEntityCellFactory descriptorForItem:item entity:entity];
+    XCTAssertEqual(descriptor.cellClass, [HAClimateEntityCell class]);
+    XCTAssertEqual([HAEntityCellFactory descriptorForItem:item entity:entity], descriptor);
+
+    item.cardType = @"entities";
+    HACellDescriptor *changed = [HAEntityCellFactory descriptorForItem:item entity:entity];
+    XCTAssertNotEqual(changed, descriptor);
+    XCTAssertEqual(changed.cellClass, [HAEntitiesCardCell class]);
+    XCTAssertEqual(changed.heightStrategy, HACellHeightStrategyEntities);
+
+    item.customProperties = @{@"compact": @YES};
+    XCTAssertEqual([HAEntityCellFactory descriptorForItem:item entity:entity].heightStrategy, HACellHeightStrategyCompact);
+}
+
+- (void)testDescriptorIsResolvedAgainWhenEntityArrives {
+    HADashboardConfigItem *item = [self itemWithEntityId:@"climate.hall" cardType:nil];
+    HACellDescriptor *missing = [HAEntityCellFactory descriptorForItem:item entity:nil];
+    XCTAssertEqual(missing.cellClass, [HABaseEntityCell class]);
+    XCTAssertFalse(missing.resolvedWithEntity);
+
+    HACellDescriptor *resolved = [HAEntityCellFactory descriptorForItem:item entity:[self entityWithId:@"climate.hall"]];
+    XCTAssertEqual(resolved.cellClass, [HAClimateEntityCell class]);
+    XCTAssertTrue(resolved.resolvedWithEntity);
+}
+
+- (void)testCompositeDescriptorCollectsSectionEntities {
+    HADashboardConfigSection *section = [[HADashboardConfigSection alloc] init];
+    section.entityIds = @[@"light.sofa", @"light.ceiling"];
+    HADashboardConfigItem *item = [self itemWithEntityId:@"light.sofa" cardType:@"entities"];
+    item.entitiesSection = section;
+    HACellDescriptor *descriptor = [HAEntityCellFactory descriptorForItem:item entity:[self entityWithId:@"light.sofa"]];
+    XCTAssertEqualObjects(descriptor.entityIds, (@[@"light.sofa", @"light.ceiling"]));
+
+    HADashboardConfigItem *heading = [self itemWithEntityId:nil cardType:@"heading"];
+    XCTAssertFalse([HAEntityCellFactory descriptorForItem:heading entity:nil].liveUpdating);
+}
+
+@end
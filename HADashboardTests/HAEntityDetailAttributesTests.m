@@ -0,0 +1,86 @@
+#import <XCTest/XCTest.h>
+#import "HAEntityDetailViewController.h"
+#import "HAAttributeRowView.h"
+#import "HAConnectionManager.h"
+#import "HAEntity.h"
+
+@interface HAEntityDetailViewController (TestAccess)
+@property (nonatomic, strong) UIStackView *attributesStack;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, HAAttributeRowView *> *attributeRows;
+- (void)entityDidUpdate:(NSNotification *)notification;
+- (void)showAllAttributesTapped;
+@end
+
+@interface HAEntityDetailAttributesTests : XCTestCase
+@end
+
+@implementation HAEntityDetailAttributesTests
+
+- (HAEntity *)sensorWithAttributes:(NSDictionary *)attributes {
+    return [[HAEntity alloc] initWithDictionary:@{@"entity_id": @"sensor.outdoor", @"state": @"12.5", @"attributes": attributes}];
+}
+
+- (HAEntityDetailViewController *)detailForEntity:(HAEntity *)entity {
+    HAEntityDetailViewController *vc = [[HAEntityDetailViewController alloc] init];
+    vc.entity = entity;
+    vc.view.frame = CGRectMake(0, 0, 375, 500);
+    return vc;
+}
+
+- (void)sendUpdate:(HAEntity *)entity to:(HAEntityDetailViewController *)vc {
+    [vc entityDidUpdate:[NSNotification notificationWithName:HAConnectionManagerEntityDidUpdateNotification
+                                                      object:nil
+                                                    userInfo:@{@"entity": entity}]];
+}
+
+- (NSArray<NSString *> *)rowKeysOf:(HAEntityDetailViewController *)vc {
+    NSMutableArray *keys = [NSMutableArray array];
+    for (UIView *view in vc.attributesStack.arrangedSubviews) {
+        NSArray *matching = [vc.attributeRows allKeysForObject:view];
+        if (matching.count > 0) [keys addObject:matching.firstObject];
+    }
+    return keys;
+}
+
+- (void)testUnchangedRowsAreKeptAcrossUpdates {
+    HAEntityDetailViewController *vc = [self detailForEntity:[self sensorWithAttributes:@{
+        @"humidity": @61, @"pressure": @1013, @"friendly_name": @"Outdoor"}]];
+    XCTAssertEqualObjects([self rowKeysOf:vc], (@[@"humidity", @"pressure"]));
+    HAAttributeRowView *humidity = vc.attributeRows[@"humidity"];
+    HAAttributeRowView *pressure = vc.attributeRows[@"pressure"];
+
+    [self sendUpdate:[self sensorWithAttributes:@{@"humidity": @62, @"pressure": @1013, @"friendly_name": @"Outdoor"}] to:vc];
+    XCTAssertEqual(vc.attributeRows[@"humidity"], humidity);
+    XCTAssertEqual(vc.attributeRows[@"pressure"], pressure);
+    XCTAssertEqualObjects([self rowKeysOf:vc], (@[@"humidity", @"pressure"]));
+}
+
+- (void)testAddedAndRemovedKeysKeepSortedOrder {
+    HAEntityDetailViewController *vc = [self detailForEntity:[self sensorWithAttributes:@{
+        @"humidity": @61, @"pressure": @1013}]];
+    HAAttributeRowView *pressure = vc.attributeRows[@"pressure"];
+
+    [self sendUpdate:[self sensorWithAttributes:@{@"dew_point": @4, @"pressure": @1012, @"attribution": @"Data by KNMI"}] to:vc];
+    XCTAssertEqualObjects([self rowKeysOf:vc], (@[@"dew_point", @"pressure"]));
+    XCTAssertEqual(vc.attributeRows[@"pressure"], pressure);
+    XCTAssertNil(vc.attributeRows[@"humidity"]);
+    XCTAssertTrue([vc.attributesStack.arrangedSubviews.lastObject isKindOfClass:[UILabel class]]);
+}
+
+- (void)testLongAttributeListsStartCollapsed {
+    NSMutableDictionary *attributes = [NSMutableDictionary dictionary];
+    for (NSUInteger i = 0; i < 40; i++) {
+        attributes[[NSString stringWithFormat:@"zone_%02lu", (unsigned long)i]] = @(i);
+    }
+    HAEntityDetailViewController *vc = [self detailForEntity:[self sensorWithAttributes:attributes]];
+    XCTAssertEqual(vc.attributeRows.count, 20u);
+    XCTAssertNil(vc.attributeRows[@"zone_20"]);
+    XCTAssertTrue([vc.attributesStack.arrangedSubviews.lastObject isKindOfClass:[UIButton class]]);
+
+    [vc showAllAttributesTapped];
+    XCTAssertEqual(vc.attributeRows.count, 40u);
+    XCTAssertEqualObjects([self rowKeysOf:vc].lastObject, @"zone_39");
+    XCTAssertFalse([vc.attributesStack.arrangedSubviews.lastObject isKindOfClass:[UIButton class]]);
+}
+
+@end
@@ -0,0 +1,143 @@
+#import <XCTest/XCTest.h>
+#import "HAGraphSeries.h"
+
+@interface HAGraphSeriesTests : XCTestCase
+@end
+
+@implementation HAGraphSeriesTests
+
+- (NSArray<NSDictionary *> *)pointsWithCount:(NSUInteger)count start:(double)start step:(double)step {
+    NSMutableArray *points = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        [points addObject:@{@"timestamp": @(start + i * step), @"value": @(sin(i * 0.1) * 10.0)}];
+    }
+    return points;
+}
+
+#pragma mark - Packing
+
+- (void)testPackingDropsInvalidAndSorts {
+    HAGraphSeries *series = [[HAGraphSeries alloc] initWithPoints:@[
+        @{@"timestamp": @30, @"value": @3},
+        @{@"timestamp": @10, @"value": @1},
+        @{@"timestamp": @20, @"value": [NSNull null]},
+        @"garbage",
+        @{@"timestamp": @20, @"value": @(NAN)},
+        @{@"timestamp": @20, @"value": @2},
+    ]];
+    XCTAssertEqual(series.count, 3u);
+    XCTAssertEqual(series.timestamps[0], 10.0);
+    XCTAssertEqual(series.timestamps[1], 20.0);
+    XCTAssertEqual(series.timestamps[2], 30.0);
+    XCTAssertEqual(series.values[1], 2.0);
+    XCTAssertEqual(series.minTime, 10.0);
+    XCTAssertEqual(series.maxTime, 30.0);
+    XCTAssertEqual(series.minValue, 1.0);
+    XCTAssertEqual(series.maxValue, 3.0);
+}
+
+- (void)testEmptySeries {
+    HAGraphSeries *series = [[HAGraphSeries alloc] initWithPoints:nil];
+    XCTAssertEqual(series.count, 0u);
+    XCTAssertTrue(isnan([series valueAtTime:5]));
+    XCTAssertEqual([series indexRangeFromTime:0 toTime:100].length, 0u);
+}
+
+#pragma mark - Search
+
+- (void)testIndexRangeIsInclusive {
+    HAGraphSeries *series = [[HAGraphSeries alloc] initWithPoints:[self pointsWithCount:100 start:1000 step:10]];
+    NSRange range = [series indexRangeFromTime:1100 toTime:1200];
+    XCTAssertEqual(range.location, 10u);
+    XCTAssertEqual(range.length, 11u);
+
+    range = [series indexRangeFromTime:1101 toTime:1109];
+    XCTAssertEqual(range.length, 0u);
+
+    range = [series indexRangeFromTime:0 toTime:5000];
+    XCTAssertEqual(range.location, 0u);
+    XCTAssertEqual(range.length, 100u);
+}
+
+- (void)testValueAtTimeInterpolatesAndClamps {
+    HAGraphSeries *series = [[HAGraphSeries alloc] initWithPoints:@[
+        @{@"timestamp": @0, @"value": @0},
+        @{@"timestamp": @10, @"value": @100},
+        @{@"timestamp": @20, @"value": @50},
+    ]];
+    XCTAssertEqualWithAccuracy([series valueAtTime:5], 50.0, 0.0001);
+    XCTAssertEqualWithAccuracy([series valueAtTime:15], 75.0, 0.0001);
+    XCTAssertEqual([series valueAtTime:10], 100.0);
+    XCTAssertEqual([series valueAtTime:-5], 0.0);
+    XCTAssertEqual([series valueAtTime:99], 50.0);
+}
+
+#pragma mark - Decimation
+
+- (void)testDecimationBoundsOutputAndKeepsExtremes {
+    NSUInteger count = 20000;
+    NSMutableArray *points = [NSMutableArray arrayWithArray:[self pointsWithCount:count start:0 step:1]];
+    points[12345] = @{@"timestamp": @12345, @"value": @1000};
+    points[777] = @{@"timestamp": @777, @"value": @-1000};
+    HAGraphSeries *series = [[HAGraphSeries alloc] initWithPoints:points];
+
+    NSUInteger columns = 300;
+    NSUInteger *indices = malloc([HAGraphSeries maxDecimatedCountForColumns:columns] * sizeof(NSUInteger));
+    NSUInteger n = [series decimateRange:NSMakeRange(0, count) fromTime:0 toTime:count - 1 columns:columns intoIndices:indices];
+
+    XCTAssertLessThanOrEqual(n, [HAGraphSeries maxDecimatedCountForColumns:columns]);
+    XCTAssertEqual(indices[0], 0u);
+    XCTAssertEqual(indices[n - 1], count - 1);
+
+    BOOL sawMax = NO, sawMin = NO;
+    for (NSUInteger k = 0; k < n; k++) {
+        if (k > 0) XCTAssertGreaterThan(indices[k], indices[k - 1]);
+        if (indices[k] == 12345) sawMax = YES;
+        if (indices[k] == 777) sawMin = YES;
+    }
+    XCTAssertTrue(sawMax);
+    XCTAssertTrue(sawMin);
+    free(indices);
+}
+
+- (void)testSparseDataIsNotDecimated {
+    HAGraphSeries *series = [[HAGraphSeries alloc] initWithPoints:[self pointsWithCount:50 start:0 step:60]];
+    NSUInteger columns = 600;
+    NSUInteger *indices = malloc([HAGraphSeries maxDecimatedCountForColumns:columns] * sizeof(NSUInteger));
+    NSUInteger n = [series decimateRange:NSMakeRange(0, 50) fromTime:0 toTime:49 * 60 columns:columns intoIndices:indices];
+    XCTAssertEqual(n, 50u);
+    free(indices);
+}
+
+#pragma mark - Timeline tracks
+
+- (void)testTimelineSegmentLookup {
+    HAGraphTimelineTrack *track = [[HAGraphTimelineTrack alloc] initWithSegments:@[
+        @{@"state": @"on", @"start": @0, @"end": @100},
+        @{@"state": @"off", @"start": @100, @"end": @250},
+        @{@"state": @"on", @"start": @300, @"end": @400},
+    ]];
+    XCTAssertEqual(track.count, 3u);
+    XCTAssertEqual([track indexOfSegmentAtTime:50], 0u);
+    XCTAssertEqual([track indexOfSegmentAtTime:399], 2u);
+    // Touching segments: the later one wins
+    XCTAssertEqual([track indexOfSegmentAtTime:100], 1u);
+    // Gaps and out of range
+    XCTAssertEqual([track indexOfSegmentAtTime:275], NSNotFound);
+    XCTAssertEqual([track indexOfSegmentAtTime:-1], NSNotFound);
+    XCTAssertEqual([track indexOfSegmentAtTime:401], NSNotFound);
+}
+
+- (void)testTimelineTrackSortsAndDropsMalformed {
+    HAGraphTimelineTrack *track = [[HAGraphTimelineTrack alloc] initWithSegments:@[
+        @{@"state": @"b", @"start": @200, @"end": @300},
+        @{@"state": @"bad", @"start": @"x", @"end": @50},
+        @{@"state": @"a", @"start": @0, @"end": @200},
+    ]];
+    XCTAssertEqual(track.count, 2u);
+    XCTAssertEqualObjects(track.states, (@[@"a", @"b"]));
+    XCTAssertEqual(track.minTime, 0.0);
+    XCTAssertEqual(track.maxTime, 300.0);
+}
+
+@end
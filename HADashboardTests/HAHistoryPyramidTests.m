@@ -0,0 +1,102 @@
+#import <XCTest/XCTest.h>
+#import "HAHistoryPyramid.h"
+
+@interface HAHistoryPyramidTests : XCTestCase
+@end
+
+@implementation HAHistoryPyramidTests
+
+/// One point every `step` seconds in [start, end), value = seconds since start.
+- (NSArray<NSDictionary *> *)pointsFrom:(double)start to:(double)end step:(double)step {
+    NSMutableArray *points = [NSMutableArray array];
+    for (double t = start; t < end; t += step) {
+        [points addObject:@{@"timestamp": @(t), @"value": @(t - start)}];
+    }
+    return points;
+}
+
+#pragma mark - Coverage
+
+- (void)testMissingRangesAfterPartialFetch {
+    HAHistoryPyramid *pyramid = [[HAHistoryPyramid alloc] initWithEntityId:@"sensor.temp"];
+    [pyramid addRawPoints:[self pointsFrom:1000 to:2000 step:10] fromTime:1000 toTime:2000];
+    [pyramid addRawPoints:[self pointsFrom:3000 to:4000 step:10] fromTime:3000 toTime:4000];
+
+    NSArray *missing = [pyramid missingRangesFromTime:0 toTime:5000];
+    XCTAssertEqual(missing.count, 3u);
+    XCTAssertEqualObjects(missing[0], (@[@0, @1000]));
+    XCTAssertEqualObjects(missing[1], (@[@2000, @3000]));
+    XCTAssertEqualObjects(missing[2], (@[@4000, @5000]));
+
+    XCTAssertTrue([pyramid coversFromTime:1200 toTime:1800]);
+    XCTAssertFalse([pyramid coversFromTime:1500 toTime:3500]);
+}
+
+- (void)testAdjacentFetchesMergeCoverage {
+    HAHistoryPyramid *pyramid = [[HAHistoryPyramid alloc] initWithEntityId:@"sensor.temp"];
+    [pyramid addRawPoints:[self pointsFrom:0 to:100 step:10] fromTime:0 toTime:100];
+    [pyramid addRawPoints:[self pointsFrom:100 to:200 step:10] fromTime:100 toTime:200];
+    XCTAssertTrue([pyramid coversFromTime:0 toTime:200]);
+    XCTAssertEqual(pyramid.rawCount, 20u);
+}
+
+- (void)testRefetchReplacesPointsInSpan {
+    HAHistoryPyramid *pyramid = [[HAHistoryPyramid alloc] initWithEntityId:@"sensor.temp"];
+    [pyramid addRawPoints:[self pointsFrom:0 to:100 step:10] fromTime:0 toTime:100];
+    [pyramid addRawPoints:@[@{@"timestamp": @50, @"value": @-1}] fromTime:40 toTime:60];
+    NSArray *points = [pyramid pointsFromTime:0 toTime:100 maxPoints:100];
+    // 40 and 60 were inside the refetched span and are gone; 50 was replaced
+    XCTAssertEqual(points.count, 8u);
+    XCTAssertEqualObjects(points[4][@"value"], @-1);
+}
+
+#pragma mark - Levels
+
+- (void)testRawReturnedWhenWithinBudget {
+    HAHistoryPyramid *pyramid = [[HAHistoryPyramid alloc] initWithEntityId:@"sensor.temp"];
+    [pyramid addRawPoints:[self pointsFrom:0 to:600 step:10] fromTime:0 toTime:600];
+    NSArray *points = [pyramid pointsFromTime:100 toTime:200 maxPoints:300];
+    // 100...200 inclusive plus one neighbour on each side
+    XCTAssertEqual(points.count, 13u);
+    XCTAssertEqualObjects(points.firstObject[@"timestamp"], @90);
+    XCTAssertEqualObjects(points.lastObject[@"timestamp"], @210);
+}
+
+- (void)testCoarseLevelKeepsExtremes {
+    HAHistoryPyramid *pyramid = [[HAHistoryPyramid alloc] initWithEntityId:@"sensor.temp"];
+    NSMutableArray *points = [[self pointsFrom:0 to:86400 step:5] mutableCopy];
+    points[1000] = @{@"timestamp": @5000, @"value": @1e6};
+    [pyramid addRawPoints:points fromTime:0 toTime:86400];
+
+    NSArray *coarse = [pyramid pointsFromTime:0 toTime:86400 maxPoints:100];
+    XCTAssertLessThanOrEqual(coarse.count, 102u);
+    double maxSeen = -HUGE_VAL, lastT = -HUGE_VAL;
+    for (NSDictionary *pt in coarse) {
+        double t = [pt[@"timestamp"] doubleValue];
+        XCTAssertGreaterThanOrEqual(t, lastT);
+        lastT = t;
+        maxSeen = MAX(maxSeen, [pt[@"value"] doubleValue]);
+    }
+    XCTAssertEqual(maxSeen, 1e6);
+}
+
+- (void)testFocusWindowGetsDetailAndContextSpansRange {
+    HAHistoryPyramid *pyramid = [[HAHistoryPyramid alloc] initWithEntityId:@"sensor.temp"];
+    [pyramid addRawPoints:[self pointsFrom:0 to:86400 step:10] fromTime:0 toTime:86400];
+
+    NSArray *points = [pyramid pointsFromTime:0 toTime:86400 focusStart:40000 focusEnd:40600 maxPoints:300];
+    NSUInteger inFocus = 0;
+    double lastT = -HUGE_VAL;
+    for (NSDictionary *pt in points) {
+        double t = [pt[@"timestamp"] doubleValue];
+        XCTAssertGreaterThan(t, lastT);
+        lastT = t;
+        if (t >= 40000 && t <= 40600) inFocus++;
+    }
+    // Every raw point in the focus window, coarse context on either side
+    XCTAssertEqual(inFocus, 61u);
+    XCTAssertLessThan([points.firstObject[@"timestamp"] doubleValue], 3600);
+    XCTAssertGreaterThan([points.lastObject[@"timestamp"] doubleValue], 82800);
+}
+
+@end
@@ -0,0 +1,51 @@
+#import <XCTest/XCTest.h>
+#import "HALog.h"
+
+@interface HALogTests : XCTestCase
+@end
+
+@implementation HALogTests
+
+- (NSString *)logContents {
+    return [NSString stringWithContentsOfFile:[HALog currentLogFilePath]
+                                     encoding:NSUTF8StringEncoding
+                                        error:nil] ?: @"";
+}
+
+- (void)testFlushWritesQueuedLines {
+    NSString *marker = [NSUUID UUID].UUIDString;
+    HALogI(@"test", @"queued %@", marker);
+    [HALog flush];
+    XCTAssertTrue([[self logContents] containsString:marker]);
+}
+
+- (void)testErrorIsWrittenBeforeReturning {
+    NSString *marker = [NSUUID UUID].UUIDString;
+    HALogE(@"test", @"error %@", marker);
+    XCTAssertTrue([[self logContents] containsString:marker]);
+}
+
+- (void)testLinesFromOneThreadKeepTheirOrder {
+    NSString *marker = [NSUUID UUID].UUIDString;
+    dispatch_group_t group = dispatch_group_create();
+    for (int t = 0; t < 4; t++) {
+        dispatch_group_async(group, dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^{
+            for (int i = 0; i < 100; i++) {
+                HALogI(@"test", @"%@ t%d #%03d", marker, t, i);
+            }
+        });
+    }
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    [HALog flush];
+
+    NSString *contents = [self logContents];
+    for (int t = 0; t < 4; t++) {
+        NSRange first = [contents rangeOfString:[NSString stringWithFormat:@"%@ t%d #000", marker, t]];
+        NSRange last = [contents rangeOfString:[NSString stringWithFormat:@"%@ t%d #099", marker, t]];
+        XCTAssertNotEqual(first.location, NSNotFound);
+        XCTAssertNotEqual(last.location, NSNotFound);
+        XCTAssertLessThan(first.location, last.location);
+    }
+}
+
+@end
@@ -0,0 +1,155 @@
+#import <XCTest/XCTest.h>
+#import "HALovelaceParser.h"
+#import "HADashboardConfig.h"
+
+@interface HALovelaceArchiveTests : XCTestCase
+@end
+
+@implementation HALovelaceArchiveTests
+
+- (NSDictionary *)rawConfig {
+    return @{
+        @"title": @"Home",
+        @"views": @[
+            @{@"title": @"Overview", @"path": @"overview", @"cards": @[
+                @{@"type": @"tile", @"entity": @"light.kitchen"},
+                @{@"type": @"custom:mini-graph-card", @"name": @"Climate",
+                  @"entities": @[@"sensor.temperature", @"sensor.humidity"]},
+                @{@"type": @"vertical-stack", @"cards": @[
+                    @{@"type": @"heading", @"heading": @"Doors"},
+                    @{@"type": @"entity", @"entity": @"binary_sensor.front_door"},
+                ]},
+            ]},
+            @{@"title": @"Rooms", @"max_columns": @3, @"sections": @[
+                @{@"title": @"Living", @"cards": @[
+                    @{@"type": @"entities", @"title": @"Lights",
+                      @"entities": @[@"light.sofa", @"light.ceiling"]},
+                    @{@"type": @"glance", @"entities": @[@"sensor.co2"]},
+                ]},
+            ]},
+        ]
+    };
+}
+
+/// Comparable summary of a config: card types, entities and spans per section
+- (NSArray *)summaryOfConfig:(HADashboardConfig *)config {
+    NSMutableArray *summary = [NSMutableArray array];
+    for (HADashboardConfigSection *section in config.sections) {
+        NSMutableArray *items = [NSMutableArray array];
+        for (HADashboardConfigItem *item in section.items) {
+            [items addObject:@[item.cardType ?: @"", item.entityId ?: @"", @(item.columnSpan),
+                               item.entitiesSection.entityIds ?: @[], item.customProperties ?: @{}]];
+        }
+        [summary addObject:@[section.title ?: @"", section.cardType ?: @"", section.entityIds ?: @[], items]];
+    }
+    return summary;
+}
+
+#pragma mark - Card dispatch
+
+- (void)testCustomCardTypesResolveBySubstring {
+    HALovelaceDashboard *dashboard = [HALovelaceParser parseDashboardFromDictionary:[self rawConfig]];
+    HADashboardConfig *config = [HALovelaceParser dashboardConfigFromView:dashboard.views[0] columns:3];
+    HADashboardConfigSection *graph = config.sections[1];
+    XCTAssertEqualObjects(graph.items.firstObject.cardType, @"graph");
+    XCTAssertEqualObjects(graph.title, @"Climate");
+    XCTAssertEqualObjects(graph.entityIds, (@[@"sensor.temperature", @"sensor.humidity"]));
+}
+
+#pragma mark - Config archive
+
+- (void)testConfigArchiveRoundTrips {
+    HALovelaceDashboard *dashboard = [HALovelaceParser parseDashboardFromDictionary:[self rawConfig]];
+    for (HALovelaceView *view in dashboard.views) {
+        HADashboardConfig *config = [HALovelaceParser dashboardConfigFromView:view columns:3];
+        NSDictionary *archive = [config archiveDictionary];
+        XCTAssertTrue([NSJSONSerialization isValidJSONObject:archive]);
+        HADashboardConfig *decoded = [HADashboardConfig configFromArchiveDictionary:archive];
+        XCTAssertEqualObjects([self summaryOfConfig:decoded], [self summaryOfConfig:config]);
+        XCTAssertEqual(decoded.items.count, config.items.count);
+    }
+}
+
+- (void)testConfigArchiveKeepsSharedObjectsShared {
+    HADashboardConfigSection *section = [[HADashboardConfigSection alloc] init];
+    section.entityIds = @[@"light.a", @"light.b"];
+    HADashboardConfigItem *item = [[HADashboardConfigItem alloc] init];
+    item.cardType = @"entities";
+    item.entitiesSection = section;
+    section.items = @[item];
+    HADashboardConfig *config = [[HADashboardConfig alloc] init];
+    config.sections = @[section];
+    config.items = @[item];
+
+    HADashboardConfig *decoded = [HADashboardConfig configFromArchiveDictionary:[config archiveDictionary]];
+    XCTAssertEqual(decoded.items.firstObject, decoded.sections.firstObject.items.firstObject);
+    XCTAssertEqual(decoded.items.firstObject.entitiesSection, decoded.sections.firstObject);
+}
+
+- (void)testMalformedConfigArchiveIsRejected {
+    XCTAssertNil([HADashboardConfig configFromArchiveDictionary:(NSDictionary *)@"config"]);
+    XCTAssertNil([HADashboardConfig configFromArchiveDictionary:@{@"sections": @[@4], @"items": @[]}]);
+}
+
+#pragma mark - Dashboard archive
+
+- (void)testArchivedDashboardSkipsRawConfigForInterpretedViews {
+    HALovelaceDashboard *dashboard = [HALovelaceParser parseDashboardFromDictionary:[self rawConfig]];
+    HADashboardConfig *original = [HALovelaceParser dashboardConfigFromView:dashboard.views[1] columns:3];
+    XCTAssertTrue([dashboard.views[1] hasConfigForColumns:3]);
+    XCTAssertFalse([dashboard.views[1] hasConfigForColumns:4]);
+
+    NSDictionary *archive = [dashboard archiveDictionary];
+    XCTAssertTrue([NSJSONSerialization isValidJSONObject:archive]);
+    __block NSUInteger loads = 0;
+    HALovelaceDashboard *restored = [[HALovelaceDashboard alloc] initWithArchiveDictionary:archive rawConfigLoader:^NSDictionary *{
+        loads++;
+        return [self rawConfig];
+    }];
+
+    XCTAssertEqualObjects(restored.title, @"Home");
+    XCTAssertEqualObjects([restored.views valueForKey:@"title"], (@[@"Overview", @"Rooms"]));
+    XCTAssertEqualObjects(restored.views[1].viewType, @"sections");
+    XCTAssertEqual(restored.views[1].maxColumns, 3);
+
+    HADashboardConfig *first = [HALovelaceParser dashboardConfigFromView:restored.views[1] columns:3];
+    HADashboardConfig *second = [HALovelaceParser dashboardConfigFromView:restored.views[1] columns:3];
+    XCTAssertEqual(loads, 0u);
+    XCTAssertEqualObjects([self summaryOfConfig:first], [self summaryOfConfig:original]);
+    XCTAssertNotEqual(first.sections.firstObject, second.sections.firstObject, @"callers rearrange configs, so each call is a new graph");
+
+    // A view not interpreted before needs its cards: loaded once for all views
+    HADashboardConfig *overview = [HALovelaceParser dashboardConfigFromView:restored.views[0] columns:3];
+    XCTAssertEqualObjects([self summaryOfConfig:overview],
+                          [self summaryOfConfig:[HALovelaceParser dashboardConfigFromView:dashboard.views[0] columns:3]]);
+    XCTAssertTrue([restored.views[1] isLayoutEqualToView:dashboard.views[1]]);
+    XCTAssertEqual(loads, 1u);
+}
+
+- (void)testArchivedViewWithoutRawConfigComparesInterpretedLayout {
+    HALovelaceDashboard *dashboard = [HALovelaceParser parseDashboardFromDictionary:[self rawConfig]];
+    [HALovelaceParser dashboardConfigFromView:dashboard.views[1] columns:3];
+    // The cached config moved on before the previous dashboard read its cards
+    HALovelaceDashboard *restored = [[HALovelaceDashboard alloc] initWithArchiveDictionary:[dashboard archiveDictionary]
+                                                                          rawConfigLoader:^NSDictionary *{ return nil; }];
+
+    HALovelaceDashboard *same = [HALovelaceParser parseDashboardFromDictionary:[self rawConfig]];
+    XCTAssertTrue([restored.views[1] isLayoutEqualToView:same.views[1]]);
+
+    NSMutableDictionary *emptied = [[self rawConfig] mutableCopy];
+    NSMutableDictionary *rooms = [emptied[@"views"][1] mutableCopy];
+    rooms[@"sections"] = @[];
+    emptied[@"views"] = @[emptied[@"views"][0], rooms];
+    HALovelaceDashboard *edited = [HALovelaceParser parseDashboardFromDictionary:emptied];
+    XCTAssertFalse([restored.views[1] isLayoutEqualToView:edited.views[1]], @"a failed load is not an empty view");
+
+    // Never interpreted and no cards to compare: treated as changed
+    XCTAssertFalse([restored.views[0] isLayoutEqualToView:same.views[0]]);
+}
+
+- (void)testMalformedDashboardArchiveIsRejected {
+    XCTAssertNil([[HALovelaceDashboard alloc] initWithArchiveDictionary:@{} rawConfigLoader:nil]);
+    XCTAssertNil([[HALovelaceDashboard alloc] initWithArchiveDictionary:@{@"views": @[@"x"]} rawConfigLoader:nil]);
+}
+
+@end
@@ -1,5 +1,6 @@
 #import <XCTest/XCTest.h>
 #import "HAMJPEGStreamParser.h"
+#import "HAMJPEGFrameScanner.h"
 #import "HAEntity.h"
 
 #pragma mark - HAMJPEGStreamParser Test Access
@@ -140,6 +141,70 @@
 
 @end
 
+#pragma mark - Frame Scanner Tests
+
+@interface HAMJPEGFrameScannerTests : XCTestCase
+@end
+
+@implementation HAMJPEGFrameScannerTests
+
+- (NSData *)delimiter {
+    return [HAMJPEGFrameScanner delimiterForContentType:@"multipart/x-mixed-replace; boundary=frame"];
+}
+
+- (NSData *)dataFromString:(NSString *)string {
+    return [string dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+- (void)testConsumesAllCompletePartsAndKeepsTail {
+    NSMutableData *buffer = [[self dataFromString:@"one\r\n--frame\r\ntwo\r\n--frame\r\nthr"] mutableCopy];
+    NSUInteger scanOffset = 0;
+    NSArray<NSData *> *parts = [HAMJPEGFrameScanner consumePartsFromBuffer:buffer
+                                                                 delimiter:[self delimiter]
+                                                                scanOffset:&scanOffset];
+    XCTAssertEqual(parts.count, 2u);
+    XCTAssertEqualObjects(parts[0], [self dataFromString:@"one"]);
+    XCTAssertEqualObjects(parts[1], [self dataFromString:@"two"]);
+    XCTAssertEqualObjects(buffer, [self dataFromString:@"thr"]);
+}
+
+- (void)testDelimiterSplitAcrossPackets {
+    // The boundary arrives in two pieces; the resumed scan must still find it
+    NSMutableData *buffer = [[self dataFromString:@"frame-one\r\n--fr"] mutableCopy];
+    NSUInteger scanOffset = 0;
+    NSArray<NSData *> *parts = [HAMJPEGFrameScanner consumePartsFromBuffer:buffer
+                                                                 delimiter:[self delimiter]
+                                                                scanOffset:&scanOffset];
+    XCTAssertEqual(parts.count, 0u);
+    XCTAssertLessThan(scanOffset, buffer.length);
+
+    [buffer appendData:[self dataFromString:@"ame\r\nnext"]];
+    parts = [HAMJPEGFrameScanner consumePartsFromBuffer:buffer
+                                              delimiter:[self delimiter]
+                                             scanOffset:&scanOffset];
+    XCTAssertEqual(parts.count, 1u);
+    XCTAssertEqualObjects(parts.firstObject, [self dataFromString:@"frame-one"]);
+    XCTAssertEqualObjects(buffer, [self dataFromString:@"next"]);
+}
+
+- (void)testJPEGDataFromPartSkipsHeaders {
+    NSMutableData *part = [[self dataFromString:@"Content-Type: image/jpeg\r\n\r\n"] mutableCopy];
+    NSMutableData *jpeg = [NSMutableData dataWithLength:200];
+    uint8_t *bytes = jpeg.mutableBytes;
+    bytes[0] = 0xFF;
+    bytes[1] = 0xD8;
+    [part appendData:jpeg];
+    XCTAssertEqualObjects([HAMJPEGFrameScanner JPEGDataFromPart:part], jpeg);
+}
+
+- (void)testJPEGDataFromPartRejectsTinyOrMissingImage {
+    uint8_t tiny[] = {0x00, 0xFF, 0x00, 0xFF, 0xD8, 0xFF, 0xE0, 0x00, 0x02, 0xFF, 0xD9};
+    XCTAssertNil([HAMJPEGFrameScanner JPEGDataFromPart:[NSData dataWithBytes:tiny length:sizeof(tiny)]]);
+    XCTAssertNil([HAMJPEGFrameScanner JPEGDataFromPart:[NSMutableData dataWithLength:500]]);
+}
+
+@end
+
 #pragma mark - Camera Entity Tests
 
 @interface HACameraStreamPathTests : XCTestCase
@@ -0,0 +1,75 @@
+#import <XCTest/XCTest.h>
+#import "HAMapCardCell.h"
+
+@interface HAMapCardCellTests : XCTestCase
+@end
+
+@implementation HAMapCardCellTests
+
+- (NSArray<NSDictionary *> *)pinsAt:(CLLocationCoordinate2D)coord count:(NSUInteger)count spacing:(double)spacing {
+    NSMutableArray *pins = [NSMutableArray array];
+    for (NSUInteger i = 0; i < count; i++) {
+        [pins addObject:@{@"key": [NSString stringWithFormat:@"device_tracker.t%lu", (unsigned long)i],
+                          @"latitude": @(coord.latitude + i * spacing),
+                          @"longitude": @(coord.longitude),
+                          @"title": [NSString stringWithFormat:@"T%lu", (unsigned long)i]}];
+    }
+    return pins;
+}
+
+- (MKCoordinateRegion)regionAt:(CLLocationCoordinate2D)coord {
+    return MKCoordinateRegionMake(coord, MKCoordinateSpanMake(0.02, 0.02));
+}
+
+#pragma mark - Clustering
+
+- (void)testFewPinsAreNotClustered {
+    CLLocationCoordinate2D home = CLLocationCoordinate2DMake(52.37, 4.89);
+    NSArray *markers = [HAMapCardCell markersForPins:[self pinsAt:home count:3 spacing:0]
+                                              region:[self regionAt:home]
+                                             mapSize:CGSizeMake(300, 300)];
+    XCTAssertEqual(markers.count, 3u);
+    XCTAssertEqualObjects([markers valueForKey:@"key"],
+                          (@[@"device_tracker.t0", @"device_tracker.t1", @"device_tracker.t2"]));
+    XCTAssertEqualObjects(markers[0][@"count"], @1);
+}
+
+- (void)testNearbyPinsClusterAboveThreshold {
+    CLLocationCoordinate2D home = CLLocationCoordinate2DMake(52.37, 4.89);
+    // 10 trackers within a few metres, 300pt map over 0.02 degrees: one cell
+    NSArray *markers = [HAMapCardCell markersForPins:[self pinsAt:home count:10 spacing:0.00001]
+                                              region:[self regionAt:home]
+                                             mapSize:CGSizeMake(300, 300)];
+    XCTAssertEqual(markers.count, 1u);
+    XCTAssertEqualObjects(markers[0][@"count"], @10);
+    XCTAssertEqualObjects(markers[0][@"key"], @"cluster:device_tracker.t0");
+}
+
+- (void)testDistantPinsStaySeparateAboveThreshold {
+    CLLocationCoordinate2D home = CLLocationCoordinate2DMake(52.37, 4.89);
+    // 0.01 degrees apart is ~150pt on this map: every pin gets its own cell
+    NSArray *markers = [HAMapCardCell markersForPins:[self pinsAt:home count:10 spacing:0.01]
+                                              region:[self regionAt:home]
+                                             mapSize:CGSizeMake(300, 300)];
+    XCTAssertEqual(markers.count, 10u);
+    XCTAssertEqualObjects([[markers valueForKey:@"count"] valueForKeyPath:@"@max.integerValue"], @1);
+}
+
+#pragma mark - Region
+
+- (void)testSmallMoveKeepsRegion {
+    MKCoordinateRegion current = [self regionAt:CLLocationCoordinate2DMake(52.37, 4.89)];
+    MKCoordinateRegion moved = [self regionAt:CLLocationCoordinate2DMake(52.37005, 4.89)];
+    XCTAssertFalse([HAMapCardCell region:current needsUpdateForRegion:moved]);
+}
+
+- (void)testLargeMoveOrZoomUpdatesRegion {
+    MKCoordinateRegion current = [self regionAt:CLLocationCoordinate2DMake(52.37, 4.89)];
+    XCTAssertTrue([HAMapCardCell region:current needsUpdateForRegion:[self regionAt:CLLocationCoordinate2DMake(52.38, 4.89)]]);
+
+    MKCoordinateRegion zoomed = current;
+    zoomed.span = MKCoordinateSpanMake(0.01, 0.01);
+    XCTAssertTrue([HAMapCardCell region:current needsUpdateForRegion:zoomed]);
+}
+
+@end
@@ -0,0 +1,106 @@
+#import <XCTest/XCTest.h>
+#import "HAPerfMonitor.h"
+#import <UIKit/UIKit.h>
+
+@interface HAPerfMonitorTests : XCTestCase
+@end
+
+@implementation HAPerfMonitorTests
+
+- (void)tearDown {
+    [[HAPerfMonitor sharedMonitor] stop];
+    [super tearDown];
+}
+
+- (NSArray<NSDictionary *> *)writeTraceEvents {
+    XCTestExpectation *done = [self expectationWithDescription:@"trace written"];
+    __block NSString *path = nil;
+    [[HAPerfMonitor sharedMonitor] writeTraceWithCompletion:^(NSString *tracePath) {
+        path = tracePath;
+        [done fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+    XCTAssertNotNil(path);
+
+    NSData *data = [NSData dataWithContentsOfFile:path];
+    NSDictionary *trace = [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
+    XCTAssertTrue([trace[@"traceEvents"] isKindOfClass:[NSArray class]]);
+    return trace[@"traceEvents"];
+}
+
+- (NSArray<NSDictionary *> *)events:(NSArray<NSDictionary *> *)events named:(NSString *)name {
+    return [events filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"name == %@", name]];
+}
+
+- (void)testSpansAreIgnoredWhileStopped {
+    HAPerfSpan span = HAPerfSpanBegin(HAPerfCategoryApp, "test.stopped", NULL);
+    XCTAssertEqual(span.spanId, 0u);
+    XCTAssertEqual(HAPerfSpanEnd(span), 0.0);
+}
+
+- (void)testNestedRebuildSpansAreBothRecorded {
+    HAPerfMonitor *monitor = [HAPerfMonitor sharedMonitor];
+    [monitor start];
+    [monitor markRebuildStart];
+    [monitor markRebuildStart];
+    [monitor markRebuildEnd];
+    [monitor markRebuildEnd];
+
+    NSArray *rebuilds = [self events:[self writeTraceEvents] named:@"rebuild"];
+    XCTAssertEqual(rebuilds.count, 2u);
+    for (NSDictionary *e in rebuilds) {
+        XCTAssertEqualObjects(e[@"ph"], @"X");
+        XCTAssertEqualObjects(e[@"cat"], @"rebuild");
+    }
+}
+
+- (void)testCrossThreadSpanExportsAsyncPair {
+    [[HAPerfMonitor sharedMonitor] start];
+    HAPerfSpan span = HAPerfSpanBegin(HAPerfCategoryNetwork, "test.handoff", "detail");
+    XCTestExpectation *ended = [self expectationWithDescription:@"ended"];
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^{
+        HAPerfSpanEnd(span);
+        [ended fulfill];
+    });
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+    HAPerfInstant(HAPerfCategoryApp, "test.instant", NULL);
+    HAPerfCounter("test.counter", 42);
+
+    NSArray *events = [self writeTraceEvents];
+    NSArray *handoff = [self events:events named:@"test.handoff"];
+    XCTAssertEqual(handoff.count, 2u);
+    XCTAssertEqualObjects([handoff valueForKey:@"ph"], (@[@"b", @"e"]));
+    XCTAssertEqualObjects(handoff[0][@"id"], handoff[1][@"id"]);
+    XCTAssertEqualObjects(handoff[0][@"args"][@"detail"], @"detail");
+
+    XCTAssertEqual([self events:events named:@"test.instant"].count, 1u);
+    NSDictionary *counter = [self events:events named:@"test.counter"].firstObject;
+    XCTAssertEqualObjects(counter[@"args"][@"value"], @42);
+}
+
+- (void)testNonASCIIDetailSurvivesExport {
+    [[HAPerfMonitor sharedMonitor] start];
+    HAPerfSpan span = HAPerfSpanBegin(HAPerfCategoryApp, "test.utf8", "K\u00fcche \"3\u00b0C\"");
+    HAPerfSpanEnd(span);
+
+    NSDictionary *event = [self events:[self writeTraceEvents] named:@"test.utf8"].firstObject;
+    XCTAssertEqualObjects(event[@"args"][@"detail"], @"K\u00fcche \"3\u00b0C\"");
+}
+
+- (void)testHitchIsAttributedToOverlappingSpans {
+    HAPerfMonitor *monitor = [HAPerfMonitor sharedMonitor];
+    [monitor start];
+
+    // Let a few frames through, then block the main thread inside a span
+    [[NSRunLoop mainRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.2]];
+    [monitor markCellStart:[UIView class]];
+    usleep(200 * 1000);
+    [monitor markCellEnd];
+    [[NSRunLoop mainRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.2]];
+
+    NSString *summary = [monitor valueForKey:@"hitchCauseSummary"];
+    [monitor stop];
+    XCTAssertTrue([summary containsString:@"cell.configure:UIView="], @"%@", summary);
+}
+
+@end
@@ -0,0 +1,53 @@
+#import <XCTest/XCTest.h>
+#import "HARegistryCache.h"
+#import "HACacheManager.h"
+
+@interface HARegistryCacheTests : XCTestCase
+@property (nonatomic, copy) NSString *savedServerURL;
+@end
+
+@implementation HARegistryCacheTests
+
+- (void)setUp {
+    [super setUp];
+    self.savedServerURL = [HACacheManager sharedManager].serverURL;
+    // A fresh server per test, so no snapshot from an earlier run is read back
+    [HACacheManager sharedManager].serverURL =
+        [NSString stringWithFormat:@"http://%@.registry-cache.test:8123", [NSUUID UUID].UUIDString];
+}
+
+- (void)tearDown {
+    [[HACacheManager sharedManager] deleteCacheFile:@"registries.json"];
+    [HACacheManager sharedManager].serverURL = self.savedServerURL;
+    [super tearDown];
+}
+
+- (NSDictionary *)snapshotWithAreas:(NSArray *)areas {
+    return @{@"areas": areas, @"device_areas": @{}, @"entities": @[], @"entity_areas": @{}};
+}
+
+- (void)testUnchangedResultAfterSaveIsNotReported {
+    HARegistryCache *cache = [HARegistryCache sharedCache];
+    NSArray *areas = @[@{@"area_id": @"kitchen", @"name": @"Kitchen"}];
+    XCTAssertTrue([cache registryResult:areas changedForKey:HARegistryKeyArea]);
+    [cache saveRegistries:[self snapshotWithAreas:areas]];
+    XCTAssertFalse([cache registryResult:areas changedForKey:HARegistryKeyArea]);
+}
+
+- (void)testChangeStaysReportedUntilSnapshotIsSaved {
+    HARegistryCache *cache = [HARegistryCache sharedCache];
+    NSArray *areas = @[@{@"area_id": @"kitchen", @"name": @"Kitchen"}];
+    [cache registryResult:areas changedForKey:HARegistryKeyArea];
+    [cache saveRegistries:[self snapshotWithAreas:areas]];
+
+    // Refresh interrupted after the area result: nothing was saved
+    NSArray *renamed = @[@{@"area_id": @"kitchen", @"name": @"Kitchen & Dining"}];
+    XCTAssertTrue([cache registryResult:renamed changedForKey:HARegistryKeyArea]);
+
+    // The refetch after reconnecting must still see the change
+    XCTAssertTrue([cache registryResult:renamed changedForKey:HARegistryKeyArea]);
+    [cache saveRegistries:[self snapshotWithAreas:renamed]];
+    XCTAssertFalse([cache registryResult:renamed changedForKey:HARegistryKeyArea]);
+}
+
+@end
@@ -0,0 +1,164 @@
+#import <XCTest/XCTest.h>
+#import "HAServiceCallQueue.h"
+#import "HAOptimisticStateLedger.h"
+#import "HACacheManager.h"
+#import "HAEntity.h"
+
+@interface HAServiceCallQueueTests : XCTestCase
+@property (nonatomic, copy) NSString *savedServerURL;
+@end
+
+@implementation HAServiceCallQueueTests
+
+- (void)setUp {
+    [super setUp];
+    self.savedServerURL = [HACacheManager sharedManager].serverURL;
+    [HACacheManager sharedManager].serverURL = @"http://service-call-queue.test:8123";
+    [[HAServiceCallQueue sharedQueue] dequeueAllCalls];
+}
+
+- (void)tearDown {
+    [[HAServiceCallQueue sharedQueue] dequeueAllCalls];
+    [HACacheManager sharedManager].serverURL = self.savedServerURL;
+    [super tearDown];
+}
+
+- (HAServiceCall *)call:(NSString *)service entity:(NSString *)entityId data:(NSDictionary *)data {
+    NSString *domain = [entityId componentsSeparatedByString:@"."].firstObject;
+    return [[HAServiceCall alloc] initWithDomain:domain service:service serviceData:data entityId:entityId];
+}
+
+#pragma mark - Coalescing
+
+- (void)testRepeatedSetValueCoalescesToLatest {
+    HAServiceCallQueue *queue = [HAServiceCallQueue sharedQueue];
+    for (NSInteger pct = 10; pct <= 50; pct += 10) {
+        [queue enqueueCall:[self call:@"turn_on" entity:@"light.kitchen" data:@{@"brightness_pct": @(pct)}]];
+    }
+    NSArray<HAServiceCall *> *calls = [queue dequeueAllCalls];
+    XCTAssertEqual(calls.count, 1u);
+    XCTAssertEqualObjects(calls.firstObject.serviceData[@"brightness_pct"], @50);
+}
+
+- (void)testCoalescedCallMovesToEnd {
+    HAServiceCallQueue *queue = [HAServiceCallQueue sharedQueue];
+    [queue enqueueCall:[self call:@"turn_on" entity:@"light.kitchen" data:nil]];
+    [queue enqueueCall:[self call:@"turn_off" entity:@"light.kitchen" data:nil]];
+    [queue enqueueCall:[self call:@"turn_on" entity:@"light.kitchen" data:nil]];
+    NSArray<HAServiceCall *> *calls = [queue dequeueAllCalls];
+    XCTAssertEqual(calls.count, 2u);
+    XCTAssertEqualObjects(calls.lastObject.service, @"turn_on");
+}
+
+- (void)testTogglesAreNotCoalesced {
+    HAServiceCallQueue *queue = [HAServiceCallQueue sharedQueue];
+    [queue enqueueCall:[self call:@"toggle" entity:@"switch.fan" data:nil]];
+    [queue enqueueCall:[self call:@"toggle" entity:@"switch.fan" data:nil]];
+    XCTAssertEqual(queue.count, 2u);
+    XCTAssertFalse([self call:@"toggle" entity:@"switch.fan" data:nil].isIdempotent);
+    XCTAssertNil([self call:@"toggle" entity:@"switch.fan" data:nil].coalescingKey);
+}
+
+- (void)testDifferentParametersAreNotCoalesced {
+    HAServiceCallQueue *queue = [HAServiceCallQueue sharedQueue];
+    [queue enqueueCall:[self call:@"turn_on" entity:@"light.kitchen" data:@{@"entity_id": @"light.kitchen", @"brightness": @80}]];
+    [queue enqueueCall:[self call:@"turn_on" entity:@"light.kitchen" data:@{@"entity_id": @"light.kitchen", @"rgb_color": @[@255, @0, @0]}]];
+    NSArray<HAServiceCall *> *calls = [queue dequeueAllCalls];
+    XCTAssertEqual(calls.count, 2u);
+    XCTAssertEqualObjects(calls.firstObject.serviceData[@"brightness"], @80);
+    XCTAssertEqualObjects(calls.lastObject.serviceData[@"rgb_color"], (@[@255, @0, @0]));
+}
+
+- (void)testRelativeStepsAndScriptRunsAreKept {
+    HAServiceCallQueue *queue = [HAServiceCallQueue sharedQueue];
+    [queue enqueueCall:[self call:@"turn_on" entity:@"light.kitchen" data:@{@"brightness_step_pct": @10}]];
+    [queue enqueueCall:[self call:@"turn_on" entity:@"light.kitchen" data:@{@"brightness_step_pct": @10}]];
+    [queue enqueueCall:[self call:@"turn_on" entity:@"script.good_night" data:nil]];
+    [queue enqueueCall:[self call:@"turn_on" entity:@"script.good_night" data:nil]];
+    XCTAssertEqual(queue.count, 4u);
+    XCTAssertFalse([self call:@"turn_on" entity:@"light.kitchen" data:@{@"brightness_step": @-20}].isIdempotent);
+    XCTAssertNil([self call:@"turn_on" entity:@"script.good_night" data:nil].coalescingKey);
+}
+
+- (void)testDequeueEmptiesQueue {
+    HAServiceCallQueue *queue = [HAServiceCallQueue sharedQueue];
+    [queue enqueueCall:[self call:@"lock" entity:@"lock.front_door" data:nil]];
+    XCTAssertEqual([queue dequeueAllCalls].count, 1u);
+    XCTAssertEqual(queue.count, 0u);
+}
+
+#pragma mark - Optimistic ledger
+
+- (HAEntity *)lightWithState:(NSString *)state {
+    return [[HAEntity alloc] initWithDictionary:@{
+        @"entity_id": @"light.kitchen",
+        @"state": state,
+        @"attributes": @{@"brightness": @128},
+    }];
+}
+
+- (void)testRollbackRestoresFirstSnapshot {
+    HAOptimisticStateLedger *ledger = [[HAOptimisticStateLedger alloc] init];
+    __block NSString *revertedState = nil;
+    __block NSDictionary *revertedAttrs = nil;
+    ledger.revertHandler = ^(NSString *entityId, NSString *state, NSDictionary *attributes) {
+        revertedState = state;
+        revertedAttrs = attributes;
+    };
+
+    HAEntity *light = [self lightWithState:@"off"];
+    [ledger recordEntity:light];
+    [light applyOptimisticState:@"on" attributeOverrides:@{@"brightness": @255}];
+    // A second optimistic update must not replace the confirmed snapshot
+    [ledger recordEntity:light];
+
+    [ledger rollbackEntityId:@"light.kitchen"];
+    XCTAssertEqualObjects(revertedState, @"off");
+    XCTAssertEqualObjects(revertedAttrs[@"brightness"], @128);
+    XCTAssertFalse([ledger hasPendingEntityId:@"light.kitchen"]);
+}
+
+- (void)testConfirmedEntityIsNotReverted {
+    HAOptimisticStateLedger *ledger = [[HAOptimisticStateLedger alloc] init];
+    ledger.confirmationTimeout = 0.05;
+    __block BOOL reverted = NO;
+    ledger.revertHandler = ^(NSString *entityId, NSString *state, NSDictionary *attributes) { reverted = YES; };
+
+    [ledger recordEntity:[self lightWithState:@"off"]];
+    [ledger armEntityId:@"light.kitchen"];
+    [ledger confirmEntityId:@"light.kitchen"];
+
+    [[NSRunLoop mainRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.2]];
+    XCTAssertFalse(reverted);
+}
+
+- (void)testUnconfirmedEntityRevertsAfterDeadline {
+    HAOptimisticStateLedger *ledger = [[HAOptimisticStateLedger alloc] init];
+    ledger.confirmationTimeout = 0.05;
+    XCTestExpectation *exp = [self expectationWithDescription:@"revert"];
+    ledger.revertHandler = ^(NSString *entityId, NSString *state, NSDictionary *attributes) {
+        XCTAssertEqualObjects(state, @"off");
+        [exp fulfill];
+    };
+
+    [ledger recordEntity:[self lightWithState:@"off"]];
+    [ledger armEntityId:@"light.kitchen"];
+    [self waitForExpectationsWithTimeout:2.0 handler:nil];
+}
+
+- (void)testDisarmedEntityHoldsOptimisticState {
+    HAOptimisticStateLedger *ledger = [[HAOptimisticStateLedger alloc] init];
+    ledger.confirmationTimeout = 0.05;
+    __block BOOL reverted = NO;
+    ledger.revertHandler = ^(NSString *entityId, NSString *state, NSDictionary *attributes) { reverted = YES; };
+
+    [ledger recordEntity:[self lightWithState:@"off"]];
+    [ledger armEntityId:@"light.kitchen"];
+    [ledger disarmEntityId:@"light.kitchen"];
+
+    [[NSRunLoop mainRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.2]];
+    XCTAssertFalse(reverted);
+    XCTAssertTrue([ledger hasPendingEntityId:@"light.kitchen"]);
+}
+
+@end
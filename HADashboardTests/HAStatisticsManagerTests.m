@@ -0,0 +1,162 @@
+#import <XCTest/XCTest.h>
+#import "HAStatisticsManager.h"
+#import "HACacheManager.h"
+
+@interface HAStatisticsManager (TestAccess)
+- (void)checkServer;
+- (NSDictionary *)seriesForKey:(NSString *)key;
+- (void)mergeRows:(NSArray<NSDictionary *> *)rows
+ intoSeriesForKey:(NSString *)key
+         fromTime:(NSTimeInterval)fetchStart
+        fetchedAt:(NSTimeInterval)fetchedAt;
+@end
+
+@interface HAStatisticsManagerTests : XCTestCase
+@end
+
+@implementation HAStatisticsManagerTests
+
+#pragma mark - Result Rows
+
+- (void)testRowsFromMillisecondAndISOTimestamps {
+    NSArray *rows = [HAStatisticsManager rowsFromResultRows:@[
+        @{@"start": @(1700000000000.0), @"end": @(1700003600000.0), @"mean": @(21.5), @"min": @(20), @"max": @(23)},
+        @{@"start": @"2023-11-14T23:13:20+00:00", @"end": @"2023-11-15T00:13:20+00:00", @"mean": @(22)},
+        @{@"end": @(1700007200000.0), @"mean": @(1)},        // no start: dropped
+        @{@"start": @(1700010800000.0), @"mean": [NSNull null]},
+    ]];
+    XCTAssertEqual(rows.count, 3u);
+    XCTAssertEqualWithAccuracy([rows[0][@"start"] doubleValue], 1700000000.0, 0.001);
+    XCTAssertEqualWithAccuracy([rows[0][@"end"] doubleValue], 1700003600.0, 0.001);
+    XCTAssertEqualObjects(rows[0][@"mean"], @(21.5));
+    XCTAssertEqualWithAccuracy([rows[1][@"start"] doubleValue], 1700003600.0, 0.001);
+    XCTAssertNil(rows[2][@"mean"]);
+    XCTAssertEqualObjects(rows[2][@"end"], rows[2][@"start"]);
+}
+
+- (void)testRowsFromBadInput {
+    XCTAssertEqual([HAStatisticsManager rowsFromResultRows:nil].count, 0u);
+    XCTAssertEqual([HAStatisticsManager rowsFromResultRows:@{}].count, 0u);
+}
+
+#pragma mark - Points
+
+- (void)testPointsPreferMeanThenStateThenSum {
+    NSArray *rows = @[
+        @{@"start": @100, @"end": @200, @"mean": @1, @"state": @9},
+        @{@"start": @200, @"end": @300, @"state": @2, @"sum": @8},
+        @{@"start": @300, @"end": @400, @"sum": @3},
+        @{@"start": @400, @"end": @500},
+    ];
+    NSArray *points = [HAStatisticsManager pointsFromRows:rows types:nil];
+    XCTAssertEqual(points.count, 3u);
+    XCTAssertEqualObjects([points valueForKey:@"value"], (@[@1, @2, @3]));
+    XCTAssertEqualObjects([points valueForKey:@"timestamp"], (@[@100, @200, @300]));
+
+    NSArray *changes = [HAStatisticsManager pointsFromRows:@[@{@"start": @0, @"change": @5, @"mean": @1}]
+                                                     types:@[HAStatisticTypeChange]];
+    XCTAssertEqualObjects(changes.firstObject[@"value"], @5);
+}
+
+#pragma mark - Aggregation
+
+- (void)testAggregateValues {
+    NSArray *rows = @[
+        @{@"start": @0, @"mean": @10, @"min": @5, @"max": @12, @"change": @1.5, @"state": @100},
+        @{@"start": @1, @"mean": @20, @"min": @2, @"max": @30, @"change": @2.5, @"state": @102.5},
+        @{@"start": @2},
+    ];
+    XCTAssertEqualObjects([HAStatisticsManager aggregateValueOfType:HAStatisticTypeMean rows:rows], @15);
+    XCTAssertEqualObjects([HAStatisticsManager aggregateValueOfType:HAStatisticTypeMin rows:rows], @2);
+    XCTAssertEqualObjects([HAStatisticsManager aggregateValueOfType:HAStatisticTypeMax rows:rows], @30);
+    XCTAssertEqualObjects([HAStatisticsManager aggregateValueOfType:HAStatisticTypeChange rows:rows], @4);
+    XCTAssertEqualObjects([HAStatisticsManager aggregateValueOfType:HAStatisticTypeState rows:rows], @102.5);
+    XCTAssertNil([HAStatisticsManager aggregateValueOfType:HAStatisticTypeSum rows:rows]);
+    XCTAssertNil([HAStatisticsManager aggregateValueOfType:HAStatisticTypeMean rows:@[]]);
+}
+
+- (void)testRowsFromPointsBucketsByPeriod {
+    NSArray *points = @[
+        @{@"timestamp": @(3600 * 10 + 60), @"value": @4},
+        @{@"timestamp": @(3600 * 10 + 120), @"value": @8},
+        @{@"timestamp": @(3600 * 11 + 60), @"value": @10},
+    ];
+    NSArray *rows = [HAStatisticsManager rowsFromPoints:points period:HAStatisticsPeriodHour];
+    XCTAssertEqual(rows.count, 2u);
+    XCTAssertEqualObjects(rows[0][@"start"], @(3600 * 10));
+    XCTAssertEqualObjects(rows[0][@"end"], @(3600 * 11));
+    XCTAssertEqualObjects(rows[0][@"mean"], @6);
+    XCTAssertEqualObjects(rows[0][@"min"], @4);
+    XCTAssertEqualObjects(rows[0][@"max"], @8);
+    XCTAssertEqualObjects(rows[0][@"change"], @4);
+    XCTAssertEqualObjects(rows[1][@"state"], @10);
+    XCTAssertEqualObjects(rows[1][@"change"], @2);
+}
+
+#pragma mark - Periods
+
+- (void)testPeriodStrings {
+    XCTAssertEqual([HAStatisticsManager periodFromString:@"5minute" defaultPeriod:HAStatisticsPeriodDay], HAStatisticsPeriodFiveMinute);
+    XCTAssertEqual([HAStatisticsManager periodFromString:@"month" defaultPeriod:HAStatisticsPeriodDay], HAStatisticsPeriodMonth);
+    XCTAssertEqual([HAStatisticsManager periodFromString:@"fortnight" defaultPeriod:HAStatisticsPeriodDay], HAStatisticsPeriodDay);
+    XCTAssertEqual([HAStatisticsManager periodFromString:nil defaultPeriod:HAStatisticsPeriodHour], HAStatisticsPeriodHour);
+    XCTAssertEqualObjects([HAStatisticsManager stringFromPeriod:HAStatisticsPeriodWeek], @"week");
+}
+
+- (void)testPeriodForDuration {
+    XCTAssertEqual([HAStatisticsManager periodForDuration:86400 maxBuckets:800], HAStatisticsPeriodFiveMinute);
+    XCTAssertEqual([HAStatisticsManager periodForDuration:30 * 86400 maxBuckets:800], HAStatisticsPeriodHour);
+    XCTAssertEqual([HAStatisticsManager periodForDuration:365 * 86400 maxBuckets:800], HAStatisticsPeriodDay);
+    XCTAssertEqual([HAStatisticsManager periodForDuration:31 * 86400 maxBuckets:400], HAStatisticsPeriodDay);
+}
+
+- (void)testCalendarPeriodRange {
+    NSCalendar *calendar = [NSCalendar currentCalendar];
+    NSDate *now = [NSDate date];
+    NSDate *start = nil, *end = nil;
+
+    [HAStatisticsManager getStartDate:&start endDate:&end forPeriodConfig:nil now:now];
+    XCTAssertEqualObjects(start, [calendar startOfDayForDate:now]);
+    XCTAssertTrue([end timeIntervalSinceDate:now] > 0);
+
+    [HAStatisticsManager getStartDate:&start endDate:&end
+                      forPeriodConfig:@{@"calendar": @{@"period": @"day", @"offset": @(-1)}} now:now];
+    XCTAssertEqualObjects(end, [calendar startOfDayForDate:now]);
+}
+
+- (void)testRollingWindowRange {
+    NSDate *now = [NSDate dateWithTimeIntervalSince1970:1700000000];
+    NSDate *start = nil, *end = nil;
+    [HAStatisticsManager getStartDate:&start endDate:&end forPeriodConfig:@{
+        @"rolling_window": @{@"duration": @{@"hours": @6}, @"offset": @{@"minutes": @(-30)}}
+    } now:now];
+    XCTAssertEqualWithAccuracy([end timeIntervalSince1970], 1700000000 - 1800, 0.001);
+    XCTAssertEqualWithAccuracy([end timeIntervalSinceDate:start], 6 * 3600, 0.001);
+}
+
+#pragma mark - Cache
+
+- (void)testServerSwitchDropsMemoryCache {
+    HAStatisticsManager *mgr = [HAStatisticsManager sharedManager];
+    HACacheManager *cache = [HACacheManager sharedManager];
+    NSString *savedServerURL = cache.serverURL;
+    NSString *key = @"sensor.energy_hour_mean";
+
+    cache.serverURL = @"http://statistics-a.test:8123";
+    [mgr checkServer];
+    [mgr mergeRows:@[@{@"start": @100, @"end": @3700, @"mean": @1}] intoSeriesForKey:key fromTime:100 fetchedAt:3700];
+    XCTAssertNotNil([mgr seriesForKey:key]);
+
+    cache.serverURL = @"http://statistics-b.test:8123";
+    [mgr checkServer];
+    XCTAssertNil([mgr seriesForKey:key], @"server A's rows must not answer for server B");
+
+    [mgr clearCache];
+    cache.serverURL = @"http://statistics-a.test:8123";
+    [mgr checkServer];
+    [mgr clearCache];
+    cache.serverURL = savedServerURL;
+    [mgr checkServer];
+}
+
+@end
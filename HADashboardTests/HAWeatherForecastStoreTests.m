@@ -0,0 +1,55 @@
+#import <XCTest/XCTest.h>
+#import "HAWeatherForecastStore.h"
+#import "HAEntity.h"
+
+@interface HAWeatherForecastStoreTests : XCTestCase
+@end
+
+@implementation HAWeatherForecastStoreTests
+
+- (void)tearDown {
+    [[HAWeatherForecastStore sharedStore] reset];
+    [super tearDown];
+}
+
+#pragma mark - Parsing
+
+- (void)testForecastFromEvent {
+    NSArray *forecast = [HAWeatherForecastStore forecastFromEventData:@{
+        @"type": @"daily",
+        @"forecast": @[
+            @{@"datetime": @"2026-10-20T00:00:00+00:00", @"condition": @"sunny", @"temperature": @18},
+            [NSNull null],
+            @{@"datetime": @"2026-10-21T00:00:00+00:00", @"condition": @"rainy", @"temperature": @12},
+        ]
+    }];
+    XCTAssertEqual(forecast.count, 2u);
+    XCTAssertEqualObjects(forecast[1][@"condition"], @"rainy");
+}
+
+- (void)testForecastFromEmptyEvent {
+    // An unavailable entity sends forecast: null
+    XCTAssertNil([HAWeatherForecastStore forecastFromEventData:@{@"type": @"daily", @"forecast": [NSNull null]}]);
+    XCTAssertNil([HAWeatherForecastStore forecastFromEventData:@{@"forecast": @[]}]);
+    XCTAssertNil([HAWeatherForecastStore forecastFromEventData:nil]);
+}
+
+#pragma mark - Lookup
+
+- (void)testLegacyAttributeForecastIsReturnedDirectly {
+    NSArray *legacy = @[@{@"datetime": @"2026-10-20T00:00:00+00:00", @"condition": @"cloudy"}];
+    HAEntity *entity = [[HAEntity alloc] initWithDictionary:@{
+        @"entity_id": @"weather.home", @"state": @"cloudy", @"attributes": @{@"forecast": legacy}
+    }];
+    XCTAssertEqualObjects([[HAWeatherForecastStore sharedStore] forecastForEntity:entity type:HAWeatherForecastTypeDaily], legacy);
+}
+
+- (void)testLookupWithoutDataReturnsNil {
+    HAEntity *entity = [[HAEntity alloc] initWithDictionary:@{
+        @"entity_id": @"weather.nowhere", @"state": @"sunny", @"attributes": @{}
+    }];
+    XCTAssertNil([[HAWeatherForecastStore sharedStore] forecastForEntity:entity type:HAWeatherForecastTypeHourly]);
+    XCTAssertNil([[HAWeatherForecastStore sharedStore] forecastForEntity:nil type:HAWeatherForecastTypeDaily]);
+}
+
+@end
@@ -0,0 +1,102 @@
+#import <XCTest/XCTest.h>
+#import "HAWeatherIconAtlas.h"
+
+@interface HAWeatherIconAtlas (TestAccess)
+@property (nonatomic, copy, readwrite) NSString *iconName;
+@property (nonatomic, strong, readwrite) UIImage *image;
+@property (nonatomic, assign, readwrite) NSUInteger frameCount;
+@property (nonatomic, assign, readwrite) NSUInteger columns;
++ (NSCache *)memoryCache;
++ (NSString *)keyForIconName:(NSString *)iconName pointSize:(CGFloat)pointSize;
++ (NSUInteger)gridColumnsForFrameCount:(NSUInteger *)frameCount cellPixels:(size_t)cellPx;
+@end
+
+@interface HAWeatherIconAtlasTests : XCTestCase
+@end
+
+@implementation HAWeatherIconAtlasTests
+
+- (HAWeatherIconAtlas *)atlasWithFrames:(NSUInteger)frames columns:(NSUInteger)columns {
+    HAWeatherIconAtlas *atlas = [[HAWeatherIconAtlas alloc] init];
+    atlas.iconName = @"test-icon";
+    atlas.frameCount = frames;
+    atlas.columns = columns;
+    return atlas;
+}
+
+#pragma mark - Grid
+
+- (void)testGridIsSquareish {
+    NSUInteger frames = 24;
+    XCTAssertEqual([HAWeatherIconAtlas gridColumnsForFrameCount:&frames cellPixels:112], 5u);
+    XCTAssertEqual(frames, 24u);
+
+    frames = 0;
+    XCTAssertEqual([HAWeatherIconAtlas gridColumnsForFrameCount:&frames cellPixels:112], 1u);
+    XCTAssertEqual(frames, 1u);
+}
+
+- (void)testGridDropsFramesToFitTextureLimit {
+    // 512px cells: at most 4x4 in a 2048px texture
+    NSUInteger frames = 36;
+    XCTAssertEqual([HAWeatherIconAtlas gridColumnsForFrameCount:&frames cellPixels:512], 4u);
+    XCTAssertEqual(frames, 16u);
+}
+
+#pragma mark - Keyframes
+
+- (void)testKeyframesTileUnitSquare {
+    HAWeatherIconAtlas *atlas = [self atlasWithFrames:10 columns:4];
+    NSArray<NSValue *> *keyframes = atlas.contentsRectKeyframes;
+    XCTAssertEqual(keyframes.count, 10u);
+
+    for (NSUInteger i = 0; i < keyframes.count; i++) {
+        CGRect rect = keyframes[i].CGRectValue;
+        XCTAssertEqualWithAccuracy(rect.size.width, 0.25, 1e-9);
+        XCTAssertEqualWithAccuracy(rect.size.height, 1.0 / 3.0, 1e-9);
+        XCTAssertEqualWithAccuracy(rect.origin.x, (i % 4) * 0.25, 1e-9);
+        XCTAssertEqualWithAccuracy(rect.origin.y, (i / 4) / 3.0, 1e-9);
+    }
+    // First row spans the full width, first column the full height
+    XCTAssertEqualWithAccuracy(CGRectGetMaxX(keyframes[3].CGRectValue), 1.0, 1e-9);
+    XCTAssertEqualWithAccuracy(CGRectGetMaxY(keyframes[8].CGRectValue), 1.0, 1e-9);
+}
+
+- (void)testKeyframesAreInsetHalfAPixel {
+    HAWeatherIconAtlas *atlas = [self atlasWithFrames:4 columns:2];
+    UIGraphicsBeginImageContextWithOptions(CGSizeMake(200, 200), NO, 1.0);
+    atlas.image = UIGraphicsGetImageFromCurrentImageContext();
+    UIGraphicsEndImageContext();
+
+    CGRect rect = [atlas contentsRectForFrame:3];
+    XCTAssertEqualWithAccuracy(rect.origin.x, 0.5 + 0.5 / 200.0, 1e-9);
+    XCTAssertEqualWithAccuracy(rect.size.width, 0.5 - 1.0 / 200.0, 1e-9);
+    XCTAssertEqualObjects(atlas.contentsRectKeyframes.firstObject,
+                          [NSValue valueWithCGRect:[atlas contentsRectForFrame:0]]);
+}
+
+#pragma mark - Memory cache
+
+- (void)testCachedAtlasIsKeyedByIconAndSize {
+    HAWeatherIconAtlas *atlas = [self atlasWithFrames:4 columns:2];
+    NSString *key = [HAWeatherIconAtlas keyForIconName:@"test-icon" pointSize:56];
+    [[HAWeatherIconAtlas memoryCache] setObject:atlas forKey:key];
+
+    XCTAssertEqual([HAWeatherIconAtlas cachedAtlasForIconName:@"test-icon" pointSize:56], atlas);
+    XCTAssertNil([HAWeatherIconAtlas cachedAtlasForIconName:@"other-icon" pointSize:56]);
+    XCTAssertNil([HAWeatherIconAtlas cachedAtlasForIconName:@"test-icon" pointSize:80]);
+    XCTAssertNil([HAWeatherIconAtlas cachedAtlasForIconName:@"" pointSize:56]);
+    XCTAssertNil([HAWeatherIconAtlas cachedAtlasForIconName:@"test-icon" pointSize:0]);
+
+    [[HAWeatherIconAtlas memoryCache] removeObjectForKey:key];
+    XCTAssertNil([HAWeatherIconAtlas cachedAtlasForIconName:@"test-icon" pointSize:56]);
+}
+
+- (void)testKeysShareRoundedPixelSize {
+    XCTAssertEqualObjects([HAWeatherIconAtlas keyForIconName:@"sunny" pointSize:56],
+                          [HAWeatherIconAtlas keyForIconName:@"sunny" pointSize:55.9]);
+    XCTAssertNotEqualObjects([HAWeatherIconAtlas keyForIconName:@"sunny" pointSize:56],
+                             [HAWeatherIconAtlas keyForIconName:@"rainy" pointSize:56]);
+}
+
+@end
@@ -0,0 +1,67 @@
+#!/bin/bash
+set -euo pipefail
+
+# Core Micro-benchmarks
+# Builds the Foundation-only core (Lovelace parser, strategy resolver, entity
+# model, history parser, MJPEG framing, date parsing, condition evaluation)
+# with Benchmarks/HACoreBenchmark.m and runs it. No simulator or device needed.
+#   macOS: Xcode command line tools
+#   Linux: clang, GNUstep Base built against libobjc2 (gnustep-2.0 runtime),
+#          and libdispatch — e.g. Debian/Ubuntu gnustep-base-dev + libdispatch-dev
+# Usage:
+#   scripts/bench-core.sh                                  # Run all benchmarks
+#   scripts/bench-core.sh --filter history                 # Only matching names
+#   scripts/bench-core.sh --json Benchmarks/.build/base.json
+#   scripts/bench-core.sh --baseline Benchmarks/.build/base.json --tolerance 0.15
+#                                                          # Exit 1 on regression
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+
+cd "$PROJECT_DIR"
+
+BUILD_DIR="Benchmarks/.build"
+BINARY="$BUILD_DIR/bench-core"
+
+SOURCES=(
+    Benchmarks/HACoreBenchmark.m
+    Benchmarks/HABenchmarkLog.m
+    HADashboard/Models/HAConditionEvaluator.m
+    HADashboard/Models/HADashboardConfig.m
+    HADashboard/Models/HAEntity.m
+    HADashboard/Models/HAEntityAttributes.m
+    HADashboard/Models/HAFloor.m
+    HADashboard/Models/HALovelaceParser.m
+    HADashboard/Models/HAStrategyResolver.m
+    HADashboard/Networking/HADateUtils.m
+    HADashboard/Networking/HAHistoryParser.m
+    HADashboard/Networking/HAMJPEGFrameScanner.m
+)
+SOURCES+=(HADashboard/Models/Categories/HAEntity+*.m)
+
+INCLUDES=(
+    -IHADashboard/Models
+    -IHADashboard/Models/Categories
+    -IHADashboard/Networking
+    -IHADashboard/Logging
+)
+
+mkdir -p "$BUILD_DIR"
+
+echo "🔨 Building core benchmarks..."
+if [[ "$(uname)" == "Darwin" ]]; then
+    xcrun clang -fobjc-arc -O2 -Wall "${INCLUDES[@]}" "${SOURCES[@]}" \
+        -framework Foundation -o "$BINARY"
+else
+    if ! command -v gnustep-config &>/dev/null; then
+        echo "❌ gnustep-config not found — install GNUstep Base (libobjc2 runtime) and libdispatch"
+        exit 1
+    fi
+    # shellcheck disable=SC2046
+    clang -fobjc-arc -fblocks -fobjc-runtime=gnustep-2.0 -O2 -Wall \
+        $(gnustep-config --objc-flags) "${INCLUDES[@]}" "${SOURCES[@]}" \
+        $(gnustep-config --base-libs) -ldispatch -o "$BINARY"
+fi
+
+echo "⏱  Running..."
+"$BINARY" "$@"
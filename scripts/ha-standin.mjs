@@ -0,0 +1,828 @@
+#!/usr/bin/env node
+/**
+ * Local Home Assistant stand-in for end-to-end performance tests.
+ *
+ * Speaks enough of the HA WebSocket API (auth, subscribe_events, results,
+ * state_changed events, recorder/statistics_during_period) and REST API (/api/states, /api/history/period,
+ * /api/camera_proxy, /api/camera_proxy_stream) for the app to connect and
+ * render a dashboard, with configurable latency and throughput so runs are
+ * repeatable. Data comes from recorded fixtures, or is synthesized when a
+ * fixture is missing.
+ *
+ * Usage:
+ *   node scripts/ha-standin.mjs [serve options]
+ *   node scripts/ha-standin.mjs record --url http://homeassistant.local:8123 --token TOKEN
+ *
+ * Serve options:
+ *   --port 8124           listen port
+ *   --host 0.0.0.0        listen address
+ *   --token standin-token access token clients must send ("any" accepts all)
+ *   --fixtures DIR        fixture directory (default scripts/fixtures/standin)
+ *   --latency 0           ms added before every HTTP response and WS result
+ *   --jitter 0            up to this many ms added on top of --latency, at random
+ *   --bandwidth 0         response throughput cap in kbit/s (0 = unlimited)
+ *   --rate 0              background state_changed events per second
+ *   --camera-fps 10       MJPEG frame rate for camera_proxy_stream
+ *   --entities 200        synthetic entity count when there is no states.json
+ *   --history-step 60     seconds between synthetic history points
+ *   --seed 1              seed for synthetic data and --rate events
+ *
+ * Record options:
+ *   --url, --token        the real Home Assistant to copy
+ *   --fixtures DIR        where to write (default scripts/fixtures/standin)
+ *   --history-hours 24    history window to record per sensor
+ *   --history-limit 20    numeric sensors to record history for
+ *   --camera-frames 5     snapshots to record per camera
+ *
+ * Fixture layout (all optional):
+ *   meta.json                     { recorded_at } — history is shifted so it ends now
+ *   states.json                   /api/states response
+ *   lovelace.json                 lovelace/config result for the default dashboard
+ *   lovelace-<url_path>.json      lovelace/config result for other dashboards
+ *   panels.json                   get_panels result
+ *   area_registry.json, device_registry.json, entity_registry.json, floor_registry.json
+ *   history/<entity_id>.json      /api/history/period response for one entity
+ *   camera/<entity_id>/*.jpg      frames, cycled by camera_proxy(_stream)
+ *
+ * Test-only WebSocket commands:
+ *   { type: "standin/burst", count: N }  send N state_changed events back to
+ *                                        back, then the result { count }
+ *   { type: "standin/stats" }            request and event counters
+ */
+import http from 'http';
+import { readFile, readdir, mkdir, writeFile } from 'fs/promises';
+import path from 'path';
+import { fileURLToPath } from 'url';
+import { WebSocketServer, WebSocket } from 'ws';
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url));
+
+const HA_VERSION = '2024.10.0';
+
+// ── Arguments ──────────────────────────────────────────────────────────
+
+const argv = process.argv.slice(2);
+const MODE = argv[0] === 'record' ? 'record' : 'serve';
+
+function arg(name, fallback) {
+  const i = argv.indexOf(`--${name}`);
+  return i >= 0 && i + 1 < argv.length ? argv[i + 1] : fallback;
+}
+function numArg(name, fallback) {
+  const value = Number(arg(name, fallback));
+  return Number.isFinite(value) ? value : fallback;
+}
+
+const FIXTURES = path.resolve(arg('fixtures', path.join(__dirname, 'fixtures', 'standin')));
+
+// ── Deterministic RNG (xorshift32) ─────────────────────────────────────
+
+function makeRandom(seed) {
+  let s = (seed >>> 0) || 1;
+  return () => {
+    s ^= s << 13; s >>>= 0;
+    s ^= s >>> 17;
+    s ^= s << 5; s >>>= 0;
+    return s / 4294967296;
+  };
+}
+
+// ── Synthetic JPEG ─────────────────────────────────────────────────────
+//
+// Baseline greyscale JPEG where every 8x8 block is flat, so only DC
+// coefficients are coded. Good enough to exercise the MJPEG parser and
+// image decode without an image library.
+
+function huffmanCodes(counts, symbols) {
+  const table = new Map();
+  let code = 0, k = 0;
+  for (let len = 1; len <= 16; len++) {
+    for (let i = 0; i < counts[len - 1]; i++) {
+      table.set(symbols[k++], { code, len });
+      code++;
+    }
+    code <<= 1;
+  }
+  return table;
+}
+
+const DC_COUNTS = [0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0];
+const DC_SYMBOLS = [0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11];
+// Standard luminance AC table (JPEG spec K.3); only EOB is ever coded
+const AC_COUNTS = [0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d];
+const AC_SYMBOLS = [
+  0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+  0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+  0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+  0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+  0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+  0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+  0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+  0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+  0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+  0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+  0xf9, 0xfa,
+];
+const DC_TABLE = huffmanCodes(DC_COUNTS, DC_SYMBOLS);
+const AC_TABLE = huffmanCodes(AC_COUNTS, AC_SYMBOLS);
+
+function encodeGreyJPEG(width, height, shadeAt) {
+  const bytes = [];
+  const u16 = (v) => bytes.push((v >> 8) & 0xff, v & 0xff);
+
+  bytes.push(0xff, 0xd8);                                       // SOI
+  bytes.push(0xff, 0xdb); u16(67); bytes.push(0);               // DQT, table 0
+  for (let i = 0; i < 64; i++) bytes.push(8);
+  bytes.push(0xff, 0xc0); u16(11); bytes.push(8);               // SOF0
+  u16(height); u16(width); bytes.push(1, 1, 0x11, 0);
+  for (const [cls, counts, symbols] of [[0x00, DC_COUNTS, DC_SYMBOLS], [0x10, AC_COUNTS, AC_SYMBOLS]]) {
+    bytes.push(0xff, 0xc4); u16(3 + 16 + symbols.length); bytes.push(cls);
+    bytes.push(...counts, ...symbols);
+  }
+  bytes.push(0xff, 0xda); u16(8); bytes.push(1, 1, 0x00, 0, 63, 0); // SOS
+
+  let acc = 0, nbits = 0;
+  const put = (code, len) => {
+    for (let i = len - 1; i >= 0; i--) {
+      acc = (acc << 1) | ((code >> i) & 1);
+      if (++nbits === 8) {
+        bytes.push(acc);
+        if (acc === 0xff) bytes.push(0x00);
+        acc = 0; nbits = 0;
+      }
+    }
+  };
+
+  // A flat block of level-shifted value s has DC coefficient 8s; with a
+  // quantizer of 8 the coded DC is just s.
+  let prev = 0;
+  const eob = AC_TABLE.get(0x00);
+  for (let by = 0; by < Math.ceil(height / 8); by++) {
+    for (let bx = 0; bx < Math.ceil(width / 8); bx++) {
+      const dc = Math.max(0, Math.min(255, Math.round(shadeAt(bx, by)))) - 128;
+      const diff = dc - prev;
+      prev = dc;
+      const mag = Math.abs(diff);
+      const size = mag === 0 ? 0 : 32 - Math.clz32(mag);
+      const h = DC_TABLE.get(size);
+      put(h.code, h.len);
+      if (size > 0) put(diff > 0 ? diff : diff + (1 << size) - 1, size);
+      put(eob.code, eob.len);
+    }
+  }
+  if (nbits > 0) put((1 << (8 - nbits)) - 1, 8 - nbits);
+  bytes.push(0xff, 0xd9);                                       // EOI
+  return Buffer.from(bytes);
+}
+
+function syntheticFrames(count) {
+  const frames = [];
+  for (let f = 0; f < count; f++) {
+    frames.push(encodeGreyJPEG(640, 360, (bx, by) => 64 + ((bx * 3 + by * 5 + f * 4) % 128)));
+  }
+  return frames;
+}
+
+// ── Fixtures ───────────────────────────────────────────────────────────
+
+async function readJSON(name) {
+  try {
+    return JSON.parse(await readFile(path.join(FIXTURES, name), 'utf8'));
+  } catch {
+    return undefined;
+  }
+}
+
+function isoTime(ms) {
+  return new Date(ms).toISOString().replace('Z', '+00:00');
+}
+
+function syntheticStates(count, random) {
+  const now = isoTime(Date.now());
+  const states = [];
+  const push = (entity_id, state, attributes) =>
+    states.push({ entity_id, state, attributes, last_changed: now, last_updated: now, context: { id: `standin-${states.length}` } });
+
+  for (let i = 0; i < count; i++) {
+    switch (i % 5) {
+      case 0:
+        push(`sensor.standin_temperature_${i}`, (18 + random() * 8).toFixed(1),
+             { unit_of_measurement: '°C', device_class: 'temperature', state_class: 'measurement', friendly_name: `Temperature ${i}` });
+        break;
+      case 1:
+        push(`light.standin_light_${i}`, random() < 0.5 ? 'on' : 'off',
+             { brightness: Math.floor(random() * 255), supported_color_modes: ['brightness'], friendly_name: `Light ${i}` });
+        break;
+      case 2:
+        push(`switch.standin_switch_${i}`, random() < 0.5 ? 'on' : 'off', { friendly_name: `Switch ${i}` });
+        break;
+      case 3:
+        push(`binary_sensor.standin_motion_${i}`, random() < 0.2 ? 'on' : 'off',
+             { device_class: 'motion', friendly_name: `Motion ${i}` });
+        break;
+      default:
+        push(`sensor.standin_power_${i}`, (random() * 2000).toFixed(0),
+             { unit_of_measurement: 'W', device_class: 'power', state_class: 'measurement', friendly_name: `Power ${i}` });
+    }
+  }
+  push('camera.standin_camera', 'idle', { friendly_name: 'Stand-in Camera', access_token: 'standin', entity_picture: '/api/camera_proxy/camera.standin_camera' });
+  return states;
+}
+
+function syntheticLovelace(states) {
+  const ids = (prefix) => states.map((s) => s.entity_id).filter((id) => id.startsWith(prefix));
+  const cards = [];
+  const sensors = ids('sensor.');
+  for (let i = 0; i < Math.min(sensors.length, 4); i++) {
+    cards.push({ type: 'history-graph', hours_to_show: 24, entities: [sensors[i]] });
+  }
+  const controls = [...ids('light.'), ...ids('switch.')];
+  for (let i = 0; i < controls.length; i += 6) {
+    cards.push({ type: 'entities', entities: controls.slice(i, i + 6) });
+  }
+  for (const id of ids('binary_sensor.').slice(0, 12)) cards.push({ type: 'tile', entity: id });
+  for (const id of sensors.slice(4, 16)) cards.push({ type: 'sensor', entity: id, graph: 'line' });
+  cards.push({ type: 'glance', entities: sensors.slice(16, 24) });
+  for (const id of ids('camera.')) cards.push({ type: 'picture-entity', entity: id, camera_view: 'live' });
+  return { title: 'Stand-in', views: [{ title: 'Stand-in', path: 'standin', cards }] };
+}
+
+const DEFAULT_PANELS = {
+  lovelace: { component_name: 'lovelace', icon: null, title: null, config: { mode: 'storage' }, url_path: 'lovelace', require_admin: false },
+};
+
+async function loadFixtures(options) {
+  const random = makeRandom(options.seed);
+  const meta = (await readJSON('meta.json')) || {};
+  const states = (await readJSON('states.json')) || syntheticStates(options.entities, random);
+
+  const dashboards = new Map();
+  dashboards.set(null, (await readJSON('lovelace.json')) || syntheticLovelace(states));
+  try {
+    for (const name of await readdir(FIXTURES)) {
+      const m = name.match(/^lovelace-(.+)\.json$/);
+      if (m) dashboards.set(m[1], await readJSON(name));
+    }
+  } catch { /* no fixture directory */ }
+
+  const registries = {};
+  for (const kind of ['area', 'device', 'entity', 'floor']) {
+    registries[kind] = (await readJSON(`${kind}_registry.json`)) || [];
+  }
+
+  return {
+    states: new Map(states.map((s) => [s.entity_id, s])),
+    dashboards,
+    panels: (await readJSON('panels.json')) || DEFAULT_PANELS,
+    registries,
+    // Recorded times are moved forward so recorded history ends now
+    timeShift: meta.recorded_at ? Date.now() - Date.parse(meta.recorded_at) : 0,
+    history: new Map(),
+    frames: new Map(),
+    syntheticFrames: null,
+  };
+}
+
+async function historyFor(store, entityId) {
+  if (store.history.has(entityId)) return store.history.get(entityId);
+  const recorded = await readJSON(path.join('history', `${entityId}.json`));
+  let rows = null;
+  if (Array.isArray(recorded) && Array.isArray(recorded[0])) {
+    rows = recorded[0]
+      .filter((row) => row.last_changed || row.last_updated)
+      .map((row) => ({ state: row.state, time: Date.parse(row.last_changed || row.last_updated) + store.timeShift }));
+  }
+  store.history.set(entityId, rows);
+  return rows;
+}
+
+async function framesFor(store, entityId) {
+  if (store.frames.has(entityId)) return store.frames.get(entityId);
+  let frames = [];
+  const dir = path.join(FIXTURES, 'camera', entityId);
+  try {
+    for (const name of (await readdir(dir)).sort()) {
+      if (/\.jpe?g$/i.test(name)) frames.push(await readFile(path.join(dir, name)));
+    }
+  } catch { /* not recorded */ }
+  if (frames.length === 0) {
+    store.syntheticFrames ||= syntheticFrames(30);
+    frames = store.syntheticFrames;
+  }
+  store.frames.set(entityId, frames);
+  return frames;
+}
+
+// ── Server ─────────────────────────────────────────────────────────────
+
+async function serve() {
+  const options = {
+    port: numArg('port', 8124),
+    host: arg('host', '0.0.0.0'),
+    token: arg('token', 'standin-token'),
+    latency: numArg('latency', 0),
+    jitter: numArg('jitter', 0),
+    bandwidth: numArg('bandwidth', 0),
+    rate: numArg('rate', 0),
+    cameraFps: numArg('camera-fps', 10),
+    entities: numArg('entities', 200),
+    historyStep: Math.max(1, numArg('history-step', 60)),
+    seed: numArg('seed', 1),
+  };
+  const store = await loadFixtures(options);
+  const random = makeRandom(options.seed + 1);
+  const stats = { http: 0, ws_commands: 0, events: 0, frames: 0, bytes: 0 };
+
+  const sleep = (ms) => new Promise((resolve) => setTimeout(resolve, ms));
+  const delay = () => sleep(options.latency + (options.jitter > 0 ? random() * options.jitter : 0));
+  // Time a payload of this size takes at --bandwidth
+  const transferMs = (bytes) => (options.bandwidth > 0 ? (bytes * 8) / options.bandwidth : 0);
+
+  const authorized = (token) => options.token === 'any' || token === options.token;
+
+  // ── State changes ──
+
+  const sockets = new Set();
+  let contextCounter = 0;
+
+  function nextState(entity) {
+    const id = entity.entity_id;
+    if (id.startsWith('sensor.') && Number.isFinite(Number(entity.state))) {
+      const value = Number(entity.state) + (random() - 0.5) * 2;
+      return value.toFixed(entity.state.includes('.') ? 1 : 0);
+    }
+    if (entity.state === 'on') return 'off';
+    if (entity.state === 'off') return 'on';
+    return entity.state;
+  }
+
+  function changeState(entityId, state, attributes) {
+    const old = store.states.get(entityId);
+    if (!old) return null;
+    const now = isoTime(Date.now());
+    const updated = {
+      ...old,
+      state,
+      attributes: attributes ? { ...old.attributes, ...attributes } : old.attributes,
+      last_changed: state !== old.state ? now : old.last_changed,
+      last_updated: now,
+      context: { id: `standin-ctx-${++contextCounter}`, parent_id: null, user_id: null },
+    };
+    store.states.set(entityId, updated);
+    const event = {
+      event_type: 'state_changed',
+      data: { entity_id: entityId, old_state: old, new_state: updated },
+      origin: 'LOCAL',
+      time_fired: now,
+      context: updated.context,
+    };
+    for (const socket of sockets) socket.sendEvent('state_changed', event);
+    return updated;
+  }
+
+  const changeable = () => [...store.states.values()].filter((s) => !s.entity_id.startsWith('camera.'));
+
+  function randomChange() {
+    const candidates = changeable();
+    if (candidates.length === 0) return;
+    const entity = candidates[Math.floor(random() * candidates.length)];
+    changeState(entity.entity_id, nextState(entity));
+  }
+
+  if (options.rate > 0) {
+    // Tick at up to 50 Hz and carry the fractional remainder
+    const tickMs = Math.max(20, 1000 / options.rate);
+    let owed = 0;
+    setInterval(() => {
+      owed += (options.rate * tickMs) / 1000;
+      for (; owed >= 1; owed--) randomChange();
+    }, tickMs);
+  }
+
+  function callService(domain, service, data = {}) {
+    const ids = [].concat(data.entity_id || []);
+    const changed = [];
+    for (const id of ids) {
+      const entity = store.states.get(id);
+      if (!entity) continue;
+      let state = entity.state;
+      if (service === 'turn_on') state = 'on';
+      else if (service === 'turn_off') state = 'off';
+      else if (service === 'toggle') state = entity.state === 'on' ? 'off' : 'on';
+      const updated = changeState(id, state);
+      if (updated) changed.push(updated);
+    }
+    return changed;
+  }
+
+  // ── History ──
+
+  async function historyRows(entityId, start, end) {
+    const recorded = await historyFor(store, entityId);
+    if (recorded) {
+      const rows = recorded.filter((r) => r.time >= start && r.time <= end);
+      // HA includes the state in effect at the window start
+      const before = recorded.filter((r) => r.time < start).pop();
+      if (before) rows.unshift({ state: before.state, time: start });
+      return rows;
+    }
+
+    const entity = store.states.get(entityId);
+    if (!entity) return [];
+    const rows = [];
+    const numeric = Number.isFinite(Number(entity.state));
+    const base = numeric ? Number(entity.state) : 0;
+    const stepMs = options.historyStep * 1000;
+    const first = Math.ceil(start / stepMs) * stepMs;
+    for (let t = first; t <= end; t += stepMs) {
+      // Deterministic in t so overlapping requests agree
+      const phase = t / 3.6e6;
+      if (numeric) {
+        rows.push({ state: (base + Math.sin(phase) * 2 + Math.sin(phase * 7.3) * 0.3).toFixed(2), time: t });
+      } else if (Math.floor(phase * 4) % 2 === 0 || rows.length === 0) {
+        const state = Math.floor(phase * 2) % 2 === 0 ? 'on' : 'off';
+        if (rows.length === 0 || rows[rows.length - 1].state !== state) rows.push({ state, time: t });
+      }
+    }
+    return rows;
+  }
+
+  // ── Statistics ──
+
+  const PERIOD_MS = { '5minute': 3e5, hour: 3.6e6, day: 8.64e7, week: 6.048e8, month: 2.592e9 };
+
+  // Long-term statistics bucketed from the same history the REST API serves
+  async function statisticsResult(msg) {
+    const periodMs = PERIOD_MS[msg.period] || PERIOD_MS.hour;
+    const end = msg.end_time ? Date.parse(msg.end_time) : Date.now();
+    const start = Date.parse(msg.start_time);
+    const types = new Set(msg.types || ['change', 'max', 'mean', 'min', 'state', 'sum']);
+    const result = {};
+    for (const id of msg.statistic_ids || []) {
+      const buckets = new Map();
+      for (const row of await historyRows(id, start, end)) {
+        const value = Number(row.state);
+        if (!Number.isFinite(value)) continue;
+        const bucket = Math.floor(row.time / periodMs) * periodMs;
+        if (!buckets.has(bucket)) buckets.set(bucket, []);
+        buckets.get(bucket).push(value);
+      }
+      if (buckets.size === 0) continue;
+      let sum = 0;
+      result[id] = [...buckets].map(([bucket, values]) => {
+        const last = values[values.length - 1];
+        const change = last - values[0];
+        sum += change;
+        const row = { start: bucket, end: bucket + periodMs };
+        if (types.has('mean')) row.mean = values.reduce((a, v) => a + v, 0) / values.length;
+        if (types.has('min')) row.min = values.reduce((a, v) => Math.min(a, v));
+        if (types.has('max')) row.max = values.reduce((a, v) => Math.max(a, v));
+        if (types.has('state')) row.state = last;
+        if (types.has('sum')) row.sum = sum;
+        if (types.has('change')) row.change = change;
+        return row;
+      });
+    }
+    return result;
+  }
+
+  async function historyResponse(url) {
+    // The app sends naive UTC times (no offset)
+    const parseTime = (s) => Date.parse(/(Z|[+-]\d\d:?\d\d)$/i.test(s) ? s : `${s}Z`);
+    const startParam = decodeURIComponent(url.pathname.slice('/api/history/period/'.length));
+    const endParam = url.searchParams.get('end_time');
+    const end = endParam ? parseTime(endParam) : Date.now();
+    const start = startParam ? parseTime(startParam) : end - 86400000;
+    const minimal = url.searchParams.has('minimal_response');
+    const ids = (url.searchParams.get('filter_entity_id') || '').split(',').filter(Boolean);
+
+    const result = [];
+    for (const id of ids) {
+      const rows = await historyRows(id, start, end);
+      if (rows.length === 0) continue;
+      const entity = store.states.get(id);
+      const attributes = url.searchParams.has('no_attributes') ? {} : entity?.attributes || {};
+      result.push(rows.map((row, i) => {
+        const time = isoTime(row.time);
+        if (minimal && i > 0) return { state: row.state, last_changed: time };
+        return { entity_id: id, state: row.state, attributes, last_changed: time, last_updated: time };
+      }));
+    }
+    return result;
+  }
+
+  // ── HTTP ──
+
+  async function sendBody(res, status, contentType, body) {
+    const buffer = Buffer.isBuffer(body) ? body : Buffer.from(typeof body === 'string' ? body : JSON.stringify(body));
+    await delay();
+    res.writeHead(status, { 'Content-Type': contentType, 'Content-Length': buffer.length });
+    stats.bytes += buffer.length;
+    if (options.bandwidth <= 0) {
+      res.end(buffer);
+      return;
+    }
+    // Trickle out in 16 KB chunks at the configured rate
+    const chunk = 16 * 1024;
+    for (let offset = 0; offset < buffer.length; offset += chunk) {
+      const piece = buffer.subarray(offset, offset + chunk);
+      res.write(piece);
+      await sleep(transferMs(piece.length));
+      if (res.destroyed) return;
+    }
+    res.end();
+  }
+  const sendJSON = (res, status, body) => sendBody(res, status, 'application/json', body);
+
+  async function streamCamera(req, res, entityId) {
+    const frames = await framesFor(store, entityId);
+    await delay();
+    const boundary = 'frame';
+    res.writeHead(200, { 'Content-Type': `multipart/x-mixed-replace;boundary=${boundary}`, 'Cache-Control': 'no-cache' });
+    let index = 0, open = true;
+    req.on('close', () => { open = false; });
+    const intervalMs = 1000 / Math.max(0.1, options.cameraFps);
+    while (open && !res.destroyed) {
+      const frame = frames[index++ % frames.length];
+      const started = Date.now();
+      res.write(`--${boundary}\r\nContent-Type: image/jpeg\r\nContent-Length: ${frame.length}\r\n\r\n`);
+      res.write(frame);
+      res.write('\r\n');
+      stats.frames++;
+      stats.bytes += frame.length;
+      await sleep(Math.max(intervalMs - (Date.now() - started), transferMs(frame.length)));
+    }
+  }
+
+  async function handleHTTP(req, res) {
+    stats.http++;
+    const url = new URL(req.url, 'http://standin');
+    const bearer = (req.headers.authorization || '').replace(/^Bearer\s+/i, '');
+    if (url.pathname.startsWith('/api/') && !authorized(bearer)) {
+      return sendJSON(res, 401, { message: 'Unauthorized' });
+    }
+
+    const route = url.pathname;
+    if (req.method === 'GET' && (route === '/api/' || route === '/api')) {
+      return sendJSON(res, 200, { message: 'API running.' });
+    }
+    if (req.method === 'GET' && route === '/api/config') {
+      return sendJSON(res, 200, configResult());
+    }
+    if (req.method === 'GET' && route === '/api/states') {
+      return sendJSON(res, 200, [...store.states.values()]);
+    }
+    if (req.method === 'GET' && route.startsWith('/api/states/')) {
+      const entity = store.states.get(decodeURIComponent(route.slice('/api/states/'.length)));
+      return entity ? sendJSON(res, 200, entity) : sendJSON(res, 404, { message: 'Entity not found.' });
+    }
+    if (req.method === 'POST' && route.startsWith('/api/services/')) {
+      const [domain, service] = route.slice('/api/services/'.length).split('/');
+      let body = '';
+      for await (const chunk of req) body += chunk;
+      let data = {};
+      try { data = body ? JSON.parse(body) : {}; } catch { return sendJSON(res, 400, { message: 'Invalid JSON.' }); }
+      return sendJSON(res, 200, callService(domain, service, data));
+    }
+    if (req.method === 'GET' && route.startsWith('/api/history/period')) {
+      return sendJSON(res, 200, await historyResponse(url));
+    }
+    if (req.method === 'GET' && route.startsWith('/api/camera_proxy_stream/')) {
+      return streamCamera(req, res, decodeURIComponent(route.slice('/api/camera_proxy_stream/'.length)));
+    }
+    if (req.method === 'GET' && route.startsWith('/api/camera_proxy/')) {
+      const frames = await framesFor(store, decodeURIComponent(route.slice('/api/camera_proxy/'.length)));
+      return sendBody(res, 200, 'image/jpeg', frames[Math.floor(Date.now() / 1000) % frames.length]);
+    }
+    return sendJSON(res, 404, { message: 'Not found.' });
+  }
+
+  function configResult() {
+    return {
+      location_name: 'Stand-in', latitude: 51.5, longitude: -0.12, elevation: 0,
+      unit_system: { length: 'km', mass: 'g', temperature: '°C', volume: 'L' },
+      time_zone: 'UTC', version: HA_VERSION, state: 'RUNNING', components: ['lovelace', 'history', 'camera'],
+    };
+  }
+
+  // ── WebSocket ──
+
+  function commandResult(msg) {
+    switch (msg.type) {
+      case 'get_states': return [...store.states.values()];
+      case 'get_config': return configResult();
+      case 'get_panels': return store.panels;
+      case 'lovelace/dashboards/list': return [];
+      case 'config/area_registry/list': return store.registries.area;
+      case 'config/device_registry/list': return store.registries.device;
+      case 'config/entity_registry/list': return store.registries.entity;
+      case 'config/floor_registry/list': return store.registries.floor;
+      case 'call_service':
+        callService(msg.domain, msg.service, { ...(msg.service_data || {}), ...(msg.target || {}) });
+        return { context: { id: `standin-ctx-${++contextCounter}`, parent_id: null, user_id: null } };
+      case 'standin/stats': return { ...stats, sockets: sockets.size };
+      default: return undefined;
+    }
+  }
+
+  const server = http.createServer((req, res) => {
+    handleHTTP(req, res).catch((err) => {
+      console.error('HTTP error:', err);
+      if (!res.headersSent) res.writeHead(500);
+      res.end();
+    });
+  });
+
+  const wss = new WebSocketServer({ server: server, path: '/api/websocket' });
+  wss.on('connection', (ws) => {
+    let authenticated = false;
+    const subscriptions = new Map(); // id -> event_type (null = all)
+
+    // Socket sends are serialized so --latency and --bandwidth never reorder
+    let outbox = Promise.resolve();
+    const send = (payload, withLatency) => {
+      outbox = outbox.then(async () => {
+        const text = JSON.stringify(payload);
+        if (withLatency) await delay();
+        const ms = transferMs(text.length);
+        if (ms > 0) await sleep(ms);
+        if (ws.readyState === WebSocket.OPEN) {
+          ws.send(text);
+          stats.bytes += text.length;
+        }
+      });
+      return outbox;
+    };
+
+    const client = {
+      sendEvent(eventType, event) {
+        for (const [id, type] of subscriptions) {
+          if (type === null || type === eventType) {
+            stats.events++;
+            send({ id, type: 'event', event }, false);
+          }
+        }
+      },
+    };
+
+    send({ type: 'auth_required', ha_version: HA_VERSION }, true);
+
+    ws.on('message', async (raw) => {
+      let msg;
+      try { msg = JSON.parse(raw.toString()); } catch { return; }
+
+      if (!authenticated) {
+        if (msg.type !== 'auth') return;
+        if (authorized(msg.access_token)) {
+          authenticated = true;
+          sockets.add(client);
+          send({ type: 'auth_ok', ha_version: HA_VERSION }, true);
+        } else {
+          await send({ type: 'auth_invalid', message: 'Invalid access token or password' }, true);
+          ws.close();
+        }
+        return;
+      }
+
+      stats.ws_commands++;
+      const ok = (result) => send({ id: msg.id, type: 'result', success: true, result: result ?? null }, true);
+      const fail = (code, message) => send({ id: msg.id, type: 'result', success: false, error: { code, message } }, true);
+
+      switch (msg.type) {
+        case 'subscribe_events':
+          subscriptions.set(msg.id, msg.event_type || null);
+          return ok(null);
+        case 'unsubscribe_events':
+          if (!subscriptions.delete(msg.subscription)) return fail('not_found', 'Subscription not found.');
+          return ok(null);
+        case 'lovelace/config': {
+          const config = store.dashboards.get(msg.url_path || null);
+          return config ? ok(config) : fail('config_not_found', 'No config found.');
+        }
+        case 'recorder/statistics_during_period':
+          return ok(await statisticsResult(msg));
+        case 'ping':
+          return send({ id: msg.id, type: 'pong' }, true);
+        case 'standin/burst': {
+          const count = Math.max(0, Math.floor(msg.count || 0));
+          for (let i = 0; i < count; i++) randomChange();
+          return ok({ count });
+        }
+        default: {
+          const result = commandResult(msg);
+          return result === undefined ? fail('unknown_command', 'Unknown command.') : ok(result);
+        }
+      }
+    });
+
+    ws.on('close', () => sockets.delete(client));
+  });
+
+  server.listen(options.port, options.host, () => {
+    console.log(`HA stand-in listening on http://${options.host}:${options.port}`);
+    console.log(`  ${store.states.size} entities, fixtures: ${FIXTURES}`);
+    console.log(`  latency ${options.latency}±${options.jitter} ms, bandwidth ${options.bandwidth || '∞'} kbit/s, ` +
+                `${options.rate} events/s, camera ${options.cameraFps} fps`);
+  });
+}
+
+// ── Record ─────────────────────────────────────────────────────────────
+
+async function record() {
+  const baseURL = (arg('url', process.env.HA_URL) || '').replace(/\/+$/, '');
+  const token = arg('token', process.env.HA_TOKEN);
+  if (!baseURL || !token) {
+    console.error('record needs --url and --token (or HA_URL / HA_TOKEN)');
+    process.exit(1);
+  }
+  const historyHours = numArg('history-hours', 24);
+  const historyLimit = numArg('history-limit', 20);
+  const cameraFrames = numArg('camera-frames', 5);
+  const headers = { Authorization: `Bearer ${token}` };
+
+  await mkdir(FIXTURES, { recursive: true });
+  const save = (name, data) => writeFile(path.join(FIXTURES, name), JSON.stringify(data, null, 2));
+
+  console.log(`Recording ${baseURL} into ${FIXTURES}`);
+  const recordedAt = new Date();
+  const states = await (await fetch(`${baseURL}/api/states`, { headers })).json();
+  await save('states.json', states);
+  console.log(`  states.json — ${states.length} entities`);
+
+  // WebSocket-only data
+  const ws = new WebSocket(`${baseURL.replace(/^http/, 'ws')}/api/websocket`);
+  const pending = new Map();
+  let nextId = 1;
+  const command = (payload) => new Promise((resolve) => {
+    const id = nextId++;
+    pending.set(id, resolve);
+    ws.send(JSON.stringify({ id, ...payload }));
+  });
+  await new Promise((resolve, reject) => {
+    ws.on('error', reject);
+    ws.on('message', (raw) => {
+      const msg = JSON.parse(raw.toString());
+      if (msg.type === 'auth_required') ws.send(JSON.stringify({ type: 'auth', access_token: token }));
+      else if (msg.type === 'auth_ok') resolve();
+      else if (msg.type === 'auth_invalid') reject(new Error(msg.message));
+      else if (msg.type === 'result' && pending.has(msg.id)) {
+        pending.get(msg.id)(msg);
+        pending.delete(msg.id);
+      }
+    });
+  });
+
+  const saveResult = async (name, payload) => {
+    const msg = await command(payload);
+    if (msg.success) {
+      await save(name, msg.result);
+      console.log(`  ${name}`);
+    } else {
+      console.log(`  ${name} skipped: ${msg.error?.message}`);
+    }
+    return msg.result;
+  };
+  const panels = await saveResult('panels.json', { type: 'get_panels' });
+  await saveResult('lovelace.json', { type: 'lovelace/config' });
+  for (const panel of Object.values(panels || {})) {
+    if (panel.component_name === 'lovelace' && panel.url_path && panel.url_path !== 'lovelace') {
+      await saveResult(`lovelace-${panel.url_path}.json`, { type: 'lovelace/config', url_path: panel.url_path });
+    }
+  }
+  for (const kind of ['area', 'device', 'entity', 'floor']) {
+    await saveResult(`${kind}_registry.json`, { type: `config/${kind}_registry/list` });
+  }
+  ws.close();
+
+  const start = new Date(recordedAt.getTime() - historyHours * 3600000).toISOString();
+  const end = recordedAt.toISOString();
+  const numeric = states.filter((s) => s.entity_id.startsWith('sensor.') && Number.isFinite(Number(s.state)));
+  await mkdir(path.join(FIXTURES, 'history'), { recursive: true });
+  for (const entity of numeric.slice(0, historyLimit)) {
+    const url = `${baseURL}/api/history/period/${start}?end_time=${encodeURIComponent(end)}` +
+                `&filter_entity_id=${entity.entity_id}&minimal_response&no_attributes`;
+    const history = await (await fetch(url, { headers })).json();
+    await save(path.join('history', `${entity.entity_id}.json`), history);
+  }
+  console.log(`  history/ — ${Math.min(numeric.length, historyLimit)} sensors, ${historyHours} h`);
+
+  for (const camera of states.filter((s) => s.entity_id.startsWith('camera.'))) {
+    const dir = path.join(FIXTURES, 'camera', camera.entity_id);
+    await mkdir(dir, { recursive: true });
+    for (let i = 0; i < cameraFrames; i++) {
+      const resp = await fetch(`${baseURL}/api/camera_proxy/${camera.entity_id}`, { headers });
+      if (!resp.ok) break;
+      await writeFile(path.join(dir, `${String(i).padStart(3, '0')}.jpg`), Buffer.from(await resp.arrayBuffer()));
+      await new Promise((resolve) => setTimeout(resolve, 1000));
+    }
+    console.log(`  camera/${camera.entity_id}`);
+  }
+
+  await save('meta.json', { recorded_at: recordedAt.toISOString(), source: baseURL });
+  console.log('Done.');
+}
+
+(MODE === 'record' ? record() : serve()).catch((err) => {
+  console.error(err);
+  process.exit(1);
+});
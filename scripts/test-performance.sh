@@ -0,0 +1,60 @@
+#!/bin/bash
+set -euo pipefail
+
+# End-to-end Performance Tests
+# Starts the local Home Assistant stand-in (scripts/ha-standin.mjs) and runs
+# HAEndToEndPerformanceTests against it. Any arguments are passed to the
+# stand-in, so the same suite can run over a slow or lossy-looking link.
+# Usage:
+#   scripts/test-performance.sh                              # Unthrottled
+#   scripts/test-performance.sh --latency 40 --jitter 20     # Wi-Fi-ish round trips
+#   scripts/test-performance.sh --bandwidth 2000 --rate 100  # 2 Mbit/s, 100 events/s background
+#   scripts/test-performance.sh --fixtures ~/ha-fixtures     # Recorded data (see ha-standin.mjs record)
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+
+cd "$PROJECT_DIR"
+
+SCHEME="HADashboard"
+DESTINATION="platform=iOS Simulator,name=iPad (10th generation),OS=17.4"
+TEST_TARGET="HADashboardTests/HAEndToEndPerformanceTests"
+STANDIN_PORT="${STANDIN_PORT:-8124}"
+STANDIN_TOKEN="standin-token"
+
+if [[ ! -d "$SCRIPT_DIR/node_modules/ws" ]]; then
+    echo "   Installing script dependencies..."
+    (cd "$SCRIPT_DIR" && npm install --silent)
+fi
+
+echo "🏠 Starting HA stand-in on port $STANDIN_PORT..."
+node "$SCRIPT_DIR/ha-standin.mjs" --port "$STANDIN_PORT" --host 127.0.0.1 --token "$STANDIN_TOKEN" "$@" &
+STANDIN_PID=$!
+trap 'kill $STANDIN_PID 2>/dev/null || true' EXIT
+
+for _ in $(seq 1 50); do
+    if curl -s -o /dev/null -H "Authorization: Bearer $STANDIN_TOKEN" "http://127.0.0.1:$STANDIN_PORT/api/"; then
+        break
+    fi
+    sleep 0.1
+done
+
+# Regenerate project if needed
+if command -v xcodegen &>/dev/null; then
+    echo "   Regenerating Xcode project..."
+    xcodegen generate --spec project.yml --quiet 2>/dev/null || true
+fi
+
+# The simulator shares the host's loopback; TEST_RUNNER_ variables are
+# passed to the test process with the prefix stripped
+echo "⏱  Running performance tests..."
+RESULT=0
+TEST_RUNNER_HA_STANDIN_URL="http://127.0.0.1:$STANDIN_PORT" \
+TEST_RUNNER_HA_STANDIN_TOKEN="$STANDIN_TOKEN" \
+xcodebuild test \
+    -scheme "$SCHEME" \
+    -destination "$DESTINATION" \
+    -only-testing:"$TEST_TARGET" \
+    2>&1 | grep -E "Test Case|measured|error:|TEST (SUCCEEDED|FAILED)" || RESULT=$?
+
+exit $RESULT